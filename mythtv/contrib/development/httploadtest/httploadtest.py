@@ -0,0 +1,366 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# httploadtest.py - load test for the MythTV backend HTTP server
+#
+# Starts a number of concurrent keep-alive clients and reports the
+# throughput, the request latency and time to first byte, and the number of
+# backend threads and its memory use while the test runs.
+#
+# In range mode each client requests random byte ranges of a file.  For
+# example, 20 clients fetching 4MB ranges of a recording for 30 seconds:
+#
+#   httploadtest.py --host localhost --port 6544 \
+#       --path /Content/GetFile?StorageGroup=Default\&FileName=1001_20200101.ts \
+#       --clients 20 --range 4096 --time 30 --pid $(pidof mythbackend)
+#
+# In api mode each client repeats a Services API call, for example 500
+# clients listing recordings, with another 1000 connections opened first and
+# left idle:
+#
+#   httploadtest.py --mode api --path /Dvr/GetRecordedList?Count=20 \
+#       --clients 500 --idle 1000 --time 30 --pid $(pidof mythbackend)
+#
+# A few clients fetching a large response show how soon it starts to arrive,
+# and how much memory the backend needs to build it:
+#
+#   httploadtest.py --mode api --path /Guide/GetProgramGuide?Details=true \
+#       --clients 4 --gzip --time 30 --pid $(pidof mythbackend)
+#
+# In hls mode a live stream is added, and each client plays it through,
+# fetching the playlist and each segment in turn.  The time until the first
+# segment can be fetched and the backend CPU used per client are reported.
+# The CPU used by a mythtranscode process is not included in the backend's:
+#
+#   httploadtest.py --mode hls \
+#       --path /Content/AddLiveStream?StorageGroup=Default\&FileName=1001_20200101.ts \
+#       --clients 5 --time 120 --pid $(pidof mythbackend)
+#
+# Licensed under the GPL v2 or later, see COPYING for details
+
+import argparse
+import http.client
+import json
+import os
+import posixpath
+import random
+import sys
+import threading
+import time
+
+
+def backend_cpu(pid):
+    """ CPU seconds used by pid, read from /proc """
+    try:
+        with open('/proc/%d/stat' % pid) as stat:
+            fields = stat.read().rsplit(')', 1)[1].split()
+        # utime and stime, the 14th and 15th fields
+        return ((int(fields[11]) + int(fields[12]))
+                / os.sysconf('SC_CLK_TCK'))
+    except (IOError, ValueError, IndexError):
+        return None
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.errors = 0
+        self.bytes = 0
+        self.latencies = []
+        self.first_bytes = []
+
+    def add(self, nbytes, latency, first_byte=None):
+        with self.lock:
+            self.requests += 1
+            self.bytes += nbytes
+            self.latencies.append(latency)
+            if first_byte is not None:
+                self.first_bytes.append(first_byte)
+
+    def error(self):
+        with self.lock:
+            self.errors += 1
+
+
+def backend_status(pid, field):
+    """ A number from /proc/<pid>/status, e.g. Threads or VmRSS (kB) """
+    try:
+        with open('/proc/%d/status' % pid) as status:
+            for line in status:
+                if line.startswith(field + ':'):
+                    return int(line.split()[1])
+    except (IOError, ValueError):
+        pass
+    return None
+
+
+def file_size(args):
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=30)
+    conn.request('HEAD', args.path)
+    resp = conn.getresponse()
+    resp.read()
+    conn.close()
+    if resp.status != 200:
+        sys.exit('HEAD %s returned %d' % (args.path, resp.status))
+    return int(resp.getheader('Content-Length', '0'))
+
+
+def ranged_client(args, size, stats, deadline):
+    """ Fetches random ranges over one keep-alive connection """
+    length = args.range * 1024
+    conn = None
+    while time.time() < deadline:
+        if conn is None:
+            conn = http.client.HTTPConnection(args.host, args.port,
+                                              timeout=30)
+        start = random.randrange(0, max(size - length, 1))
+        end = min(start + length, size) - 1
+        began = time.time()
+        try:
+            conn.request('GET', args.path,
+                         headers={'Range': 'bytes=%d-%d' % (start, end)})
+            resp = conn.getresponse()
+            body = resp.read()
+            if resp.status != 206 or len(body) != end - start + 1:
+                stats.error()
+            else:
+                stats.add(len(body), time.time() - began)
+            if resp.will_close:
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException):
+            stats.error()
+            conn = None
+    if conn is not None:
+        conn.close()
+
+
+def api_client(args, stats, deadline):
+    """ Repeats a request over one keep-alive connection """
+    conn = None
+    while time.time() < deadline:
+        if conn is None:
+            conn = http.client.HTTPConnection(args.host, args.port,
+                                              timeout=30)
+        headers = {'Accept': args.accept}
+        if args.gzip:
+            headers['Accept-Encoding'] = 'gzip'
+        began = time.time()
+        try:
+            conn.request('GET', args.path, headers=headers)
+            resp = conn.getresponse()
+            # The body follows the header straight away when it is streamed
+            first = resp.read(1)
+            first_byte = time.time() - began
+            body = first + resp.read()
+            if resp.status != 200:
+                stats.error()
+            else:
+                stats.add(len(body), time.time() - began, first_byte)
+            if resp.will_close:
+                conn.close()
+                conn = None
+        except (OSError, http.client.HTTPException):
+            stats.error()
+            conn = None
+    if conn is not None:
+        conn.close()
+
+
+def add_live_stream(args):
+    """ Adds the stream, returns the URL of its media playlist """
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=60)
+    conn.request('GET', args.path, headers={'Accept': 'application/json'})
+    resp = conn.getresponse()
+    body = resp.read()
+    conn.close()
+    if resp.status != 200:
+        sys.exit('%s returned %d' % (args.path, resp.status))
+    info = json.loads(body.decode('utf-8'))['LiveStreamInfo']
+    url = info.get('RelativeURL') or ''
+    if not url.endswith('.m3u8'):
+        sys.exit('No playlist for stream %s: %s'
+                 % (info.get('Id'), info.get('StatusMessage')))
+    # The meta playlist lists the audio/video playlist as <base>.av.m3u8
+    return url[:-len('.m3u8')] + '.av.m3u8'
+
+
+def hls_client(args, playlist, stats, deadline, began):
+    """ Plays the stream through, one segment after another """
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=30)
+    base = posixpath.dirname(playlist)
+    fetched = 0
+    first_segment = None
+    while time.time() < deadline:
+        try:
+            conn.request('GET', playlist)
+            resp = conn.getresponse()
+            text = resp.read().decode('utf-8', 'replace')
+            if resp.status != 200:
+                # Not written yet
+                time.sleep(0.1)
+                continue
+            segments = [line for line in text.splitlines()
+                        if line and not line.startswith('#')]
+            if fetched >= len(segments):
+                if '#EXT-X-ENDLIST' in text:
+                    break
+                time.sleep(0.1)
+                continue
+            segment = segments[fetched]
+            started = time.time()
+            conn.request('GET', posixpath.join(base, segment))
+            resp = conn.getresponse()
+            body = resp.read()
+            if resp.status != 200:
+                stats.error()
+                continue
+            fetched += 1
+            if first_segment is None:
+                first_segment = time.time() - began
+            stats.add(len(body), time.time() - started, first_segment
+                      if fetched == 1 else None)
+        except (OSError, http.client.HTTPException):
+            stats.error()
+            conn.close()
+            conn = http.client.HTTPConnection(args.host, args.port,
+                                              timeout=30)
+    conn.close()
+
+
+def idle_connections(args, count):
+    """ Opens connections that send one request and then stay idle """
+    conns = []
+    for _ in range(count):
+        try:
+            conn = http.client.HTTPConnection(args.host, args.port,
+                                              timeout=30)
+            conn.request('HEAD', args.path)
+            conn.getresponse().read()
+            conns.append(conn)
+        except (OSError, http.client.HTTPException):
+            break
+    return conns
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(int(len(values) * pct / 100.0), len(values) - 1)]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Load test the MythTV backend HTTP server')
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=6544)
+    parser.add_argument('--mode', choices=('range', 'api', 'hls'),
+                        default='range',
+                        help='fetch ranges of a file, repeat a request, or '
+                             'play a live stream')
+    parser.add_argument('--path', required=True,
+                        help='URL of the file, Services API call, or '
+                             'AddLiveStream call to fetch')
+    parser.add_argument('--clients', type=int,
+                        help='concurrent connections (default 20 in range '
+                             'mode, 500 in api mode, 1 in hls mode)')
+    parser.add_argument('--idle', type=int, default=0,
+                        help='extra keep-alive connections left idle')
+    parser.add_argument('--accept', default='application/json',
+                        help='Accept header sent in api mode')
+    parser.add_argument('--gzip', action='store_true',
+                        help='ask for gzip compressed responses in api mode')
+    parser.add_argument('--range', type=int, default=4096,
+                        help='size of each range in kB (default 4096)')
+    parser.add_argument('--time', type=int, default=30,
+                        help='length of the test in seconds (default 30)')
+    parser.add_argument('--pid', type=int,
+                        help='backend process id, to report its threads '
+                             'and memory')
+    args = parser.parse_args()
+    if args.clients is None:
+        args.clients = {'range': 20, 'api': 500, 'hls': 1}[args.mode]
+
+    idle = idle_connections(args, args.idle)
+    if len(idle) < args.idle:
+        print('Only %d of %d idle connections were opened'
+              % (len(idle), args.idle))
+
+    stats = Stats()
+    cpu_start = backend_cpu(args.pid) if args.pid else None
+    if args.mode == 'hls':
+        began = time.time()
+        playlist = add_live_stream(args)
+        deadline = began + args.time
+        clients = [threading.Thread(target=hls_client,
+                                    args=(args, playlist, stats, deadline,
+                                          began))
+                   for _ in range(args.clients)]
+    elif args.mode == 'range':
+        size = file_size(args)
+        deadline = time.time() + args.time
+        clients = [threading.Thread(target=ranged_client,
+                                    args=(args, size, stats, deadline))
+                   for _ in range(args.clients)]
+    else:
+        deadline = time.time() + args.time
+        clients = [threading.Thread(target=api_client,
+                                    args=(args, stats, deadline))
+                   for _ in range(args.clients)]
+    if args.mode != 'hls':
+        began = time.time()
+    for client in clients:
+        client.start()
+
+    threads = []
+    rss = []
+    while any(client.is_alive() for client in clients):
+        if args.pid:
+            count = backend_status(args.pid, 'Threads')
+            if count is not None:
+                threads.append(count)
+            size = backend_status(args.pid, 'VmRSS')
+            if size is not None:
+                rss.append(size)
+        time.sleep(0.2)
+    for client in clients:
+        client.join()
+    elapsed = time.time() - began
+    cpu_end = backend_cpu(args.pid) if args.pid else None
+
+    # The backend closes them after its keep-alive timeout anyway
+    for conn in idle:
+        conn.close()
+
+    print('%d clients, %d requests, %d errors in %.1f s'
+          % (args.clients, stats.requests, stats.errors, elapsed))
+    print('Throughput: %.1f MB/s, %.1f requests/s'
+          % (stats.bytes / elapsed / (1024 * 1024), stats.requests / elapsed))
+    print('Latency: p50 %.1f ms, p99 %.1f ms'
+          % (percentile(stats.latencies, 50) * 1000,
+             percentile(stats.latencies, 99) * 1000))
+    if stats.first_bytes and args.mode == 'hls':
+        print('Time to first segment: min %.1f ms, max %.1f ms'
+              % (min(stats.first_bytes) * 1000,
+                 max(stats.first_bytes) * 1000))
+    elif stats.first_bytes:
+        print('Time to first byte: p50 %.1f ms, p99 %.1f ms'
+              % (percentile(stats.first_bytes, 50) * 1000,
+                 percentile(stats.first_bytes, 99) * 1000))
+    if cpu_start is not None and cpu_end is not None:
+        print('Backend CPU: %.1f s, %.1f s per client'
+              % (cpu_end - cpu_start, (cpu_end - cpu_start) / args.clients))
+    if threads:
+        print('Backend threads: min %d, max %d'
+              % (min(threads), max(threads)))
+    if rss:
+        print('Backend memory: min %.1f MB, max %.1f MB'
+              % (min(rss) / 1024.0, max(rss) / 1024.0))
+    if idle:
+        print('With %d idle connections' % len(idle))
+
+
+if __name__ == '__main__':
+    main()
@@ -35,6 +35,18 @@ extern "C" {
 #include "libswresample/swresample.h"
 }
 
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+#elif HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+static const bool s_haveNEON = have_neon(av_get_cpu_flags());
+#endif
+
 #define LOC QString("AudioConvert: ")
 
 #define ISALIGN(x) (((unsigned long)(x) & 0xf) == 0)
@@ -70,6 +82,39 @@ static inline bool sse_check()
 }
 #endif //ARCH_x86
 
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+// Check whether the SSE2 or NEON intrinsics can be used
+static inline bool simd_check()
+{
+#if (HAVE_SSE2 && ARCH_X86_64)
+    return sse_check();
+#else
+    return s_haveNEON;
+#endif
+}
+#endif
+
+#if HAVE_INTRINSICS_NEON
+// Round to nearest like lrintf() and cvtps2dq, saturating
+static inline int32x4_t neon_lrintf(float32x4_t v)
+{
+#if ARCH_AARCH64
+    return vcvtnq_s32_f32(v);
+#else
+    // ARMv7 only converts towards zero.  Adding and taking away 2^23 with
+    // the sign of v leaves no bits for a fraction, and NEON arithmetic
+    // always rounds to nearest even, so ties go to even like lrintf().
+    // From 2^23 up v is already a whole number.
+    uint32x4_t sign  = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000));
+    float32x4_t big  = vreinterpretq_f32_u32(
+        vorrq_u32(vreinterpretq_u32_f32(vdupq_n_f32(8388608.0F)), sign));
+    float32x4_t rounded = vsubq_f32(vaddq_f32(v, big), big);
+    uint32x4_t small = vcaltq_f32(v, vdupq_n_f32(8388608.0F));
+    return vcvtq_s32_f32(vbslq_f32(small, rounded, v));
+#endif
+}
+#endif
+
 #if !HAVE_LRINTF
 static av_always_inline av_const long int lrintf(float x)
 {
@@ -85,7 +130,8 @@ static inline float clipcheck(float f)
 }
 
 /*
- The SSE code processes 16 bytes at a time and leaves any remainder for the C
+ The SSE and NEON code processes 16 samples at a time and leaves any remainder
+ for the C
  */
 
 static int toFloat8(float* out, const uchar* in, int len)
@@ -146,6 +192,27 @@ static int toFloat8(float* out, const uchar* in, int len)
                           :"xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+
+        for (int l = 0; l < loops; l++)
+        {
+            int8x16_t s8 = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(in),
+                                                        vdupq_n_u8(0x80)));
+            int16x8_t lo = vmovl_s8(vget_low_s8(s8));
+            int16x8_t hi = vmovl_s8(vget_high_s8(s8));
+            vst1q_f32(out,      vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))),  scale));
+            vst1q_f32(out + 4,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))), scale));
+            vst1q_f32(out + 8,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))),  scale));
+            vst1q_f32(out + 12, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))), scale));
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (; i < len; i++)
         *out++ = (*in++ - 0x80) * f;
@@ -209,6 +276,26 @@ static int fromFloat8(uchar* out, const float* in, int len)
                           :"xmm0","xmm1","xmm2","xmm3","xmm4","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+
+        for (int l = 0; l < loops; l++)
+        {
+            int16x4_t a = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in),      scale)));
+            int16x4_t b = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 4),  scale)));
+            int16x4_t c = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 8),  scale)));
+            int16x4_t d = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 12), scale)));
+            int8x16_t s8 = vcombine_s8(vqmovn_s16(vcombine_s16(a, b)),
+                                       vqmovn_s16(vcombine_s16(c, d)));
+            vst1q_u8(out, veorq_u8(vreinterpretq_u8_s8(s8), vdupq_n_u8(0x80)));
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (;i < len; i++)
         *out++ = clip_uchar(lrintf(*in++ * f) + 0x80);
@@ -264,6 +351,25 @@ static int toFloat16(float* out, const short* in, int len)
                           :"xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+
+        for (int l = 0; l < loops; l++)
+        {
+            int16x8_t a = vld1q_s16(in);
+            int16x8_t b = vld1q_s16(in + 8);
+            vst1q_f32(out,      vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(a))),  scale));
+            vst1q_f32(out + 4,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(a))), scale));
+            vst1q_f32(out + 8,  vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(b))),  scale));
+            vst1q_f32(out + 12, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(b))), scale));
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (; i < len; i++)
         *out++ = *in++ * f;
@@ -318,6 +424,25 @@ static int fromFloat16(short* out, const float* in, int len)
                           :"xmm1","xmm2","xmm3","xmm4","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+
+        for (int l = 0; l < loops; l++)
+        {
+            int16x4_t a = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in),      scale)));
+            int16x4_t b = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 4),  scale)));
+            int16x4_t c = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 8),  scale)));
+            int16x4_t d = vqmovn_s32(neon_lrintf(vmulq_f32(vld1q_f32(in + 12), scale)));
+            vst1q_s16(out,     vcombine_s16(a, b));
+            vst1q_s16(out + 8, vcombine_s16(c, d));
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (;i < len;i++)
         *out++ = clip_short(lrintf(*in++ * f));
@@ -375,6 +500,25 @@ static int toFloat32(AudioFormat format, float* out, const int* in, int len)
                           :"xmm1","xmm2","xmm3","xmm4","xmm6","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+        int32x4_t   right = vdupq_n_s32(-shift);
+
+        for (int l = 0; l < loops; l++)
+        {
+            for (int j = 0; j < 16; j += 4)
+            {
+                int32x4_t v = vshlq_s32(vld1q_s32(in + j), right);
+                vst1q_f32(out + j, vmulq_f32(vcvtq_f32_s32(v), scale));
+            }
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (; i < len; i++)
         *out++ = (*in++ >> shift) * f;
@@ -448,6 +592,28 @@ static int fromFloat32(AudioFormat format, int* out, const float* in, int len)
                           :"xmm0","xmm1","xmm2","xmm3","xmm4","xmm5","xmm6","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t scale = vdupq_n_f32(f);
+        float32x4_t o     = vdupq_n_f32(0.99999995F);
+        float32x4_t mo    = vdupq_n_f32(-1.0F);
+        int32x4_t   left  = vdupq_n_s32(shift);
+
+        for (int l = 0; l < loops; l++)
+        {
+            for (int j = 0; j < 16; j += 4)
+            {
+                float32x4_t v = vmaxq_f32(vminq_f32(vld1q_f32(in + j), o), mo);
+                v = vmulq_f32(v, scale);
+                vst1q_s32(out + j, vshlq_s32(neon_lrintf(v), left));
+            }
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     uint range = 1<<(bits-1);
     for (; i < len; i++)
@@ -514,6 +680,22 @@ static int fromFloatFLT(float* out, const float* in, int len)
                           :"xmm1","xmm2","xmm3","xmm4","xmm6","xmm7"
                           );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && len >= 16)
+    {
+        int loops = len >> 4;
+        i = loops << 4;
+        float32x4_t o  = vdupq_n_f32(1.0F);
+        float32x4_t mo = vdupq_n_f32(-1.0F);
+
+        for (int l = 0; l < loops; l++)
+        {
+            for (int j = 0; j < 16; j += 4)
+                vst1q_f32(out + j, vmaxq_f32(vminq_f32(vld1q_f32(in + j), o), mo));
+            in  += 16;
+            out += 16;
+        }
+    }
 #endif //ARCH_x86
     for (;i < len;i++)
         *out++ = clipcheck(*in++);
@@ -730,13 +912,308 @@ void AudioConvert::MonoToStereo(void* dst, const void* src, int samples)
 {
     auto* d = (float*)dst;
     auto* s = (float*)src;
-    for (int i = 0; i < samples; i++)
+    int i = 0;
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (simd_check())
+    {
+        for (; i + 4 <= samples; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(s);
+            _mm_storeu_ps(d,     _mm_unpacklo_ps(v, v));
+            _mm_storeu_ps(d + 4, _mm_unpackhi_ps(v, v));
+            s += 4;
+            d += 8;
+        }
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (simd_check())
+    {
+        for (; i + 4 <= samples; i += 4)
+        {
+            float32x4x2_t v;
+            v.val[0] = v.val[1] = vld1q_f32(s);
+            vst2q_f32(d, v);
+            s += 4;
+            d += 8;
+        }
+    }
+#endif
+    for (; i < samples; i++)
     {
         *d++ = *s;
         *d++ = *s++;
     }
 }
 
+/*
+ The SSE and NEON code interleaves or deinterleaves 4 frames at a time of
+ 32 bit samples with an even number of channels, and 8 frames at a time of
+ 16 bit stereo samples.  They return how many frames were done, the rest is
+ left for the C.
+ */
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+static inline void transpose4x4(__m128i &r0, __m128i &r1, __m128i &r2, __m128i &r3)
+{
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t1);
+    r1 = _mm_unpackhi_epi64(t0, t1);
+    r2 = _mm_unpacklo_epi64(t2, t3);
+    r3 = _mm_unpackhi_epi64(t2, t3);
+}
+#elif HAVE_INTRINSICS_NEON
+static inline void transpose4x4(int32x4_t &r0, int32x4_t &r1, int32x4_t &r2, int32x4_t &r3)
+{
+    int32x4x2_t t01 = vtrnq_s32(r0, r1);
+    int32x4x2_t t23 = vtrnq_s32(r2, r3);
+    r0 = vcombine_s32(vget_low_s32(t01.val[0]),  vget_low_s32(t23.val[0]));
+    r1 = vcombine_s32(vget_low_s32(t01.val[1]),  vget_low_s32(t23.val[1]));
+    r2 = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+    r3 = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+}
+#endif
+
+static int interleaveSIMD(char* /*out*/, const char* const* /*inp*/,
+                          int /*channels*/, int /*frames*/)
+{
+    return 0;
+}
+
+static int interleaveSIMD(short* out, const short* const* inp,
+                          int channels, int frames)
+{
+    int i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (!simd_check() || channels != 2)
+        return 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        __m128i l = _mm_loadu_si128((const __m128i*)(inp[0] + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(inp[1] + i));
+        _mm_storeu_si128((__m128i*)out,       _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i*)(out + 8), _mm_unpackhi_epi16(l, r));
+        out += 16;
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (!simd_check() || channels != 2)
+        return 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        int16x8x2_t v;
+        v.val[0] = vld1q_s16(inp[0] + i);
+        v.val[1] = vld1q_s16(inp[1] + i);
+        vst2q_s16(out, v);
+        out += 16;
+    }
+#else
+    Q_UNUSED(out);
+    Q_UNUSED(inp);
+    Q_UNUSED(channels);
+    Q_UNUSED(frames);
+#endif
+    return i;
+}
+
+static int interleaveSIMD(int* out, const int* const* inp,
+                          int channels, int frames)
+{
+    int i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (!simd_check() || (channels & 1))
+        return 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= channels; c += 4)
+        {
+            __m128i r0 = _mm_loadu_si128((const __m128i*)(inp[c]     + i));
+            __m128i r1 = _mm_loadu_si128((const __m128i*)(inp[c + 1] + i));
+            __m128i r2 = _mm_loadu_si128((const __m128i*)(inp[c + 2] + i));
+            __m128i r3 = _mm_loadu_si128((const __m128i*)(inp[c + 3] + i));
+            transpose4x4(r0, r1, r2, r3);
+            _mm_storeu_si128((__m128i*)(out + c),                r0);
+            _mm_storeu_si128((__m128i*)(out + channels + c),     r1);
+            _mm_storeu_si128((__m128i*)(out + 2 * channels + c), r2);
+            _mm_storeu_si128((__m128i*)(out + 3 * channels + c), r3);
+        }
+        if (c < channels)
+        {
+            // last two channels
+            __m128i a  = _mm_loadu_si128((const __m128i*)(inp[c]     + i));
+            __m128i b  = _mm_loadu_si128((const __m128i*)(inp[c + 1] + i));
+            __m128i lo = _mm_unpacklo_epi32(a, b);
+            __m128i hi = _mm_unpackhi_epi32(a, b);
+            _mm_storel_epi64((__m128i*)(out + c),                lo);
+            _mm_storel_epi64((__m128i*)(out + channels + c),     _mm_unpackhi_epi64(lo, lo));
+            _mm_storel_epi64((__m128i*)(out + 2 * channels + c), hi);
+            _mm_storel_epi64((__m128i*)(out + 3 * channels + c), _mm_unpackhi_epi64(hi, hi));
+        }
+        out += 4 * channels;
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (!simd_check() || (channels & 1))
+        return 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= channels; c += 4)
+        {
+            int32x4_t r0 = vld1q_s32(inp[c]     + i);
+            int32x4_t r1 = vld1q_s32(inp[c + 1] + i);
+            int32x4_t r2 = vld1q_s32(inp[c + 2] + i);
+            int32x4_t r3 = vld1q_s32(inp[c + 3] + i);
+            transpose4x4(r0, r1, r2, r3);
+            vst1q_s32(out + c,                r0);
+            vst1q_s32(out + channels + c,     r1);
+            vst1q_s32(out + 2 * channels + c, r2);
+            vst1q_s32(out + 3 * channels + c, r3);
+        }
+        if (c < channels)
+        {
+            // last two channels
+            int32x4x2_t z = vzipq_s32(vld1q_s32(inp[c] + i),
+                                      vld1q_s32(inp[c + 1] + i));
+            vst1_s32(out + c,                vget_low_s32(z.val[0]));
+            vst1_s32(out + channels + c,     vget_high_s32(z.val[0]));
+            vst1_s32(out + 2 * channels + c, vget_low_s32(z.val[1]));
+            vst1_s32(out + 3 * channels + c, vget_high_s32(z.val[1]));
+        }
+        out += 4 * channels;
+    }
+#else
+    Q_UNUSED(out);
+    Q_UNUSED(inp);
+    Q_UNUSED(channels);
+    Q_UNUSED(frames);
+#endif
+    return i;
+}
+
+static int deinterleaveSIMD(char* const* /*outp*/, const char* /*in*/,
+                            int /*channels*/, int /*frames*/)
+{
+    return 0;
+}
+
+static int deinterleaveSIMD(short* const* outp, const short* in,
+                            int channels, int frames)
+{
+    int i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (!simd_check() || channels != 2)
+        return 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)in);
+        __m128i b = _mm_loadu_si128((const __m128i*)(in + 8));
+        // sign extend each half of the 32 bit frames, then pack them back
+        __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                                    _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        __m128i r = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+        _mm_storeu_si128((__m128i*)(outp[0] + i), l);
+        _mm_storeu_si128((__m128i*)(outp[1] + i), r);
+        in += 16;
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (!simd_check() || channels != 2)
+        return 0;
+    for (; i + 8 <= frames; i += 8)
+    {
+        int16x8x2_t v = vld2q_s16(in);
+        vst1q_s16(outp[0] + i, v.val[0]);
+        vst1q_s16(outp[1] + i, v.val[1]);
+        in += 16;
+    }
+#else
+    Q_UNUSED(outp);
+    Q_UNUSED(in);
+    Q_UNUSED(channels);
+    Q_UNUSED(frames);
+#endif
+    return i;
+}
+
+static int deinterleaveSIMD(int* const* outp, const int* in,
+                            int channels, int frames)
+{
+    int i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (!simd_check() || (channels & 1))
+        return 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= channels; c += 4)
+        {
+            __m128i r0 = _mm_loadu_si128((const __m128i*)(in + c));
+            __m128i r1 = _mm_loadu_si128((const __m128i*)(in + channels + c));
+            __m128i r2 = _mm_loadu_si128((const __m128i*)(in + 2 * channels + c));
+            __m128i r3 = _mm_loadu_si128((const __m128i*)(in + 3 * channels + c));
+            transpose4x4(r0, r1, r2, r3);
+            _mm_storeu_si128((__m128i*)(outp[c]     + i), r0);
+            _mm_storeu_si128((__m128i*)(outp[c + 1] + i), r1);
+            _mm_storeu_si128((__m128i*)(outp[c + 2] + i), r2);
+            _mm_storeu_si128((__m128i*)(outp[c + 3] + i), r3);
+        }
+        if (c < channels)
+        {
+            // last two channels
+            __m128 ab = _mm_castsi128_ps(_mm_unpacklo_epi64(
+                _mm_loadl_epi64((const __m128i*)(in + c)),
+                _mm_loadl_epi64((const __m128i*)(in + channels + c))));
+            __m128 cd = _mm_castsi128_ps(_mm_unpacklo_epi64(
+                _mm_loadl_epi64((const __m128i*)(in + 2 * channels + c)),
+                _mm_loadl_epi64((const __m128i*)(in + 3 * channels + c))));
+            _mm_storeu_ps((float*)(outp[c] + i),
+                          _mm_shuffle_ps(ab, cd, _MM_SHUFFLE(2,0,2,0)));
+            _mm_storeu_ps((float*)(outp[c + 1] + i),
+                          _mm_shuffle_ps(ab, cd, _MM_SHUFFLE(3,1,3,1)));
+        }
+        in += 4 * channels;
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (!simd_check() || (channels & 1))
+        return 0;
+    for (; i + 4 <= frames; i += 4)
+    {
+        int c = 0;
+        for (; c + 4 <= channels; c += 4)
+        {
+            int32x4_t r0 = vld1q_s32(in + c);
+            int32x4_t r1 = vld1q_s32(in + channels + c);
+            int32x4_t r2 = vld1q_s32(in + 2 * channels + c);
+            int32x4_t r3 = vld1q_s32(in + 3 * channels + c);
+            transpose4x4(r0, r1, r2, r3);
+            vst1q_s32(outp[c]     + i, r0);
+            vst1q_s32(outp[c + 1] + i, r1);
+            vst1q_s32(outp[c + 2] + i, r2);
+            vst1q_s32(outp[c + 3] + i, r3);
+        }
+        if (c < channels)
+        {
+            // last two channels
+            int32x4x2_t u = vuzpq_s32(
+                vcombine_s32(vld1_s32(in + c), vld1_s32(in + channels + c)),
+                vcombine_s32(vld1_s32(in + 2 * channels + c),
+                             vld1_s32(in + 3 * channels + c)));
+            vst1q_s32(outp[c]     + i, u.val[0]);
+            vst1q_s32(outp[c + 1] + i, u.val[1]);
+        }
+        in += 4 * channels;
+    }
+#else
+    Q_UNUSED(outp);
+    Q_UNUSED(in);
+    Q_UNUSED(channels);
+    Q_UNUSED(frames);
+#endif
+    return i;
+}
+
 template <class AudioDataType>
 void tDeinterleaveSample(AudioDataType* out, const AudioDataType* in, int channels, int frames)
 {
@@ -747,7 +1224,14 @@ void tDeinterleaveSample(AudioDataType* out, const AudioDataType* in, int channe
         outp[i] = out + (i * frames);
     }
 
-    for (int i = 0; i < frames; i++)
+    int done = deinterleaveSIMD(outp.data(), in, channels, frames);
+    in += done * channels;
+    for (int i = 0; i < channels; i++)
+    {
+        outp[i] += done;
+    }
+
+    for (int i = done; i < frames; i++)
     {
         for (int j = 0; j < channels; j++)
         {
@@ -815,7 +1299,14 @@ void tInterleaveSample(AudioDataType* out, const AudioDataType* in, int channels
         }
     }
 
-    for (int i = 0; i < frames; i++)
+    int done = interleaveSIMD(out, my_inp.data(), channels, frames);
+    out += done * channels;
+    for (int i = 0; i < channels; i++)
+    {
+        my_inp[i] += done;
+    }
+
+    for (int i = done; i < frames; i++)
     {
         for (int j = 0; j < channels; j++)
         {
@@ -475,8 +475,10 @@ bool AudioOutputALSA::OpenDevice()
             return false;
     }
 
-    // buffer 0.5s worth of samples
-    uint buffer_time = gCoreContext->GetNumSetting("ALSABufferOverride", 500) * 1000;
+    // buffer 0.5s worth of samples, or 0.1s in callback mode where we write
+    // as soon as there's room and so don't need as much
+    uint buffer_time = gCoreContext->GetNumSetting("ALSABufferOverride",
+                                                   m_useCallback ? 100 : 500) * 1000;
 
     uint period_time = 4; // aim for an interrupt every (1/4th of buffer_time)
 
@@ -626,6 +628,40 @@ void AudioOutputALSA::WriteAudio(uchar *aubuf, int size)
     }
 }
 
+/**
+ * Wait until at least a period can be written, the avail_min set in
+ * SetParameters(), and return how much can be
+ */
+int AudioOutputALSA::WaitForDevice(void)
+{
+    if (m_pcmHandle == nullptr)
+    {
+        Error("WaitForDevice() called with pcm_handle == nullptr!");
+        usleep(100ms);
+        return 0;
+    }
+
+    int err = snd_pcm_wait(m_pcmHandle, 100);
+    if (err == 0)
+        return 0;
+
+    snd_pcm_sframes_t avail = err < 0 ? err : snd_pcm_avail_update(m_pcmHandle);
+    if (avail < 0)
+    {
+        // underrun or suspended
+        VBAUDIO(QString("WaitForDevice: recovering from %1")
+                .arg(snd_strerror(static_cast<int>(avail))));
+        if ((err = snd_pcm_recover(m_pcmHandle, static_cast<int>(avail), 1)) < 0)
+        {
+            AERROR("WaitForDevice: unable to recover");
+            usleep(100ms);
+        }
+        return 0;
+    }
+
+    return avail * m_outputBytesPerFrame;
+}
+
 int AudioOutputALSA::GetBufferedOnSoundcard(void) const
 {
     if (m_pcmHandle == nullptr)
@@ -27,6 +27,8 @@ class AudioOutputALSA : public AudioOutputBase
     void WriteAudio(unsigned char *aubuf, int size) override; // AudioOutputBase
     int  GetBufferedOnSoundcard(void) const override; // AudioOutputBase
     AudioOutputSettings* GetOutputSettings(bool passthrough) override; // AudioOutputBase
+    bool CanCallback(void) const override { return true; } // AudioOutputBase
+    int  WaitForDevice(void) override; // AudioOutputBase
 
   private:
     int TryOpenDevice(int open_mode, bool try_ac3);
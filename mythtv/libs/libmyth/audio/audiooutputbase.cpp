@@ -29,12 +29,6 @@
 
 #define LOC QString("AOBase: ")
 
-// Replacing "m_audioBuffer + org_waud" with
-// "&m_audioBuffer[org_waud]" should provide bounds
-// checking with c++17 arrays.
-#define WPOS (&m_audioBuffer[org_waud])
-#define RPOS (&m_audioBuffer[m_raud])
-#define ABUF (&m_audioBuffer[0])
 #define STST soundtouch::SAMPLETYPE
 #define AOALIGN(x) (((long)&(x) + 15) & ~0xf);
 
@@ -76,6 +70,8 @@ AudioOutputBase::AudioOutputBase(const AudioSettings &settings) :
 
         VBAUDIO(QString("SRC quality = %1").arg(quality_string(m_srcQuality)));
     }
+
+    m_callbackSetting = gCoreContext->GetBoolSetting("AudioCallbackMode", false);
 }
 
 /**
@@ -105,12 +101,10 @@ AudioOutputBase::~AudioOutputBase()
     assert(m_memoryCorruptionTest0 == 0xdeadbeef);
     assert(m_memoryCorruptionTest1 == 0xdeadbeef);
     assert(m_memoryCorruptionTest2 == 0xdeadbeef);
-    assert(m_memoryCorruptionTest3 == 0xdeadbeef);
 #else
     Q_UNUSED(m_memoryCorruptionTest0);
     Q_UNUSED(m_memoryCorruptionTest1);
     Q_UNUSED(m_memoryCorruptionTest2);
-    Q_UNUSED(m_memoryCorruptionTest3);
 #endif
 }
 
@@ -301,8 +295,7 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             m_pSoundStretch = nullptr;
             VBGENERAL(QString("Cancelling time stretch"));
             m_bytesPerFrame = m_previousBpf;
-            m_waud = m_raud = 0;
-            m_resetActive.Ref();
+            m_ringBuffer.Clear();
         }
         else
         {
@@ -338,8 +331,7 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
                               AudioOutputSettings::SampleSize(FORMAT_FLT);
             m_audbufTimecode = m_audioTime = 0ms;
             m_framesBuffered = 0;
-            m_waud = m_raud = 0;
-            m_resetActive.Ref();
+            m_ringBuffer.Clear();
             m_wasPaused = m_pauseAudio;
             m_pauseAudio = true;
             m_actuallyPaused = false;
@@ -599,8 +591,7 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     QMutexLocker lock(&m_audioBufLock);
     QMutexLocker lockav(&m_avsyncLock);
 
-    m_waud = m_raud = 0;
-    m_resetActive.Clear();
+    m_ringBuffer.Clear();
     m_actuallyPaused = m_processing = m_forcedProcessing = false;
 
     m_channels               = settings.m_channels;
@@ -782,6 +773,12 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     m_sourceBitRate = -1;
     m_effDsp = m_sampleRate * 100;
 
+    // Bitstreams are written in whole fragments, they can't be padded with
+    // silence whenever the device wants more than is buffered
+    m_useCallback = m_callbackSetting && CanCallback() && !m_passthru && !m_enc;
+    if (m_useCallback)
+        VBAUDIO("Using callback mode");
+
     // Actually do the device specific open call
     if (!OpenDevice())
     {
@@ -928,16 +925,7 @@ void AudioOutputBase::Reset()
 
     m_audbufTimecode = m_audioTime = 0ms;
     m_framesBuffered = 0;
-    if (m_encoder)
-    {
-        m_waud = m_raud = 0;    // empty ring buffer
-        m_audioBuffer.fill(0);
-    }
-    else
-    {
-        m_waud = m_raud;        // empty ring buffer
-    }
-    m_resetActive.Ref();
+    m_ringBuffer.Clear();   // empty ring buffer
     m_currentSeconds = -1s;
     m_wasPaused = !m_pauseAudio;
     m_unpauseWhenReady = false;
@@ -982,9 +970,7 @@ void AudioOutputBase::SetEffDsp(int dsprate)
  */
 inline int AudioOutputBase::audiolen() const
 {
-    if (m_waud >= m_raud)
-        return m_waud - m_raud;
-    return kAudioRingBufferSize - (m_raud - m_waud);
+    return m_ringBuffer.Used();
 }
 
 /**
@@ -992,10 +978,7 @@ inline int AudioOutputBase::audiolen() const
  */
 int AudioOutputBase::audiofree() const
 {
-    return kAudioRingBufferSize - audiolen() - 1;
-    /* There is one wasted byte in the buffer. The case where m_waud = m_raud is
-       interpreted as an empty buffer, so the fullest the buffer can ever
-       be is kAudioRingBufferSize - 1. */
+    return m_ringBuffer.Free();
 }
 
 /**
@@ -1173,70 +1156,67 @@ int AudioOutputBase::GetSWVolume()
 }
 
 /**
- * Check that there's enough space in the audiobuffer to write the provided
- * number of frames
+ * Write processed audio into the audiobuffer
  *
- * If there is not enough space, set 'frames' to the number that will fit
+ * If there is not enough space, write the frames that fit and drop the rest
  *
- * Returns the number of bytes that the frames will take up
+ * Returns the number of bytes written
  */
-int AudioOutputBase::CheckFreeSpace(int &frames)
+int AudioOutputBase::WriteToBuffer(const uchar *buffer, int len)
 {
-    int bpf   = m_bytesPerFrame;
-    int len   = frames * bpf;
     int afree = audiofree();
 
-    if (len <= afree)
-        return len;
-
-    VBERROR(QString("Audio buffer overflow, %1 frames lost!")
-            .arg(frames - (afree / bpf)));
+    if (len > afree)
+    {
+        int bpf = m_encoder ? m_outputBytesPerFrame : m_bytesPerFrame;
 
-    frames = afree / bpf;
-    len = frames * bpf;
+        VBERROR(QString("Audio buffer overflow, %1 frames lost!")
+                .arg((len / bpf) - (afree / bpf)));
 
-    if (!m_srcCtx)
-        return len;
+        len = afree - (afree % bpf);
 
-    int error = src_reset(m_srcCtx);
-    if (error)
-    {
-        VBERROR(QString("Error occurred while resetting resampler: %1")
-                .arg(src_strerror(error)));
-        m_srcCtx = nullptr;
+        if (m_srcCtx)
+        {
+            int error = src_reset(m_srcCtx);
+            if (error)
+            {
+                VBERROR(QString("Error occurred while resetting resampler: %1")
+                        .arg(src_strerror(error)));
+                m_srcCtx = nullptr;
+            }
+        }
     }
 
-    return len;
+    return m_ringBuffer.Write(buffer, len);
 }
 
 /**
- * Copy frames into the audiobuffer, upmixing en route if necessary
+ * Get the DSP buffer, making sure that it can hold at least 'size' bytes
  *
- * Returns the number of frames written, which may be less than requested
+ * Only ever grows, so it stops reallocating once it has seen the largest
+ * chunk of audio.
+ */
+uchar *AudioOutputBase::DSPBuffer(int size)
+{
+    if (static_cast<size_t>(size) > m_dspBuffer.size())
+        m_dspBuffer.resize(size);
+    return m_dspBuffer.data();
+}
+
+/**
+ * Copy frames into the DSP buffer, upmixing en route if necessary
+ *
+ * Returns the number of bytes written, which may be less than provided
  * if the upmixer buffered some (or all) of them
  */
-int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud)
+int AudioOutputBase::CopyWithUpmix(char *buffer, int frames)
 {
-    int len   = CheckFreeSpace(frames);
-    int bdiff = kAudioRingBufferSize - org_waud;
-    int bpf   = m_bytesPerFrame;
-    int off   = 0;
+    int bpf = m_bytesPerFrame;
 
     if (!m_needsUpmix)
     {
-        int num  = len;
-
-        if (bdiff <= num)
-        {
-            memcpy(WPOS, buffer, bdiff);
-            num -= bdiff;
-            off = bdiff;
-            org_waud = 0;
-        }
-        if (num > 0)
-            memcpy(WPOS, buffer + off, num);
-        org_waud = (org_waud + num) % kAudioRingBufferSize;
-        return len;
+        memcpy(DSPBuffer(frames * bpf), buffer, frames * bpf);
+        return frames * bpf;
     }
 
     // Convert mono to stereo as most devices can't accept mono
@@ -1244,28 +1224,17 @@ int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud)
     {
         // we're always in the case
         // m_configuredChannels == 2 && m_sourceChannels == 1
-        int bdFrames = bdiff / bpf;
-        if (bdFrames <= frames)
-        {
-            AudioOutputUtil::MonoToStereo(WPOS, buffer, bdFrames);
-            frames -= bdFrames;
-            off = bdFrames * sizeof(float); // 1 channel of floats
-            org_waud = 0;
-        }
-        if (frames > 0)
-            AudioOutputUtil::MonoToStereo(WPOS, buffer + off, frames);
-
-        org_waud = (org_waud + frames * bpf) % kAudioRingBufferSize;
-        return len;
+        AudioOutputUtil::MonoToStereo(DSPBuffer(frames * bpf), buffer, frames);
+        return frames * bpf;
     }
 
     // Upmix to 6ch via FreeSurround
     // Calculate frame size of input
-    off =  m_processing ? sizeof(float) : AudioOutputSettings::SampleSize(m_format);
+    int off =  m_processing ? sizeof(float) : AudioOutputSettings::SampleSize(m_format);
     off *= m_sourceChannels;
 
     int i = 0;
-    len = 0;
+    int len = 0;
     while (i < frames)
     {
         i += m_upmixer->putFrames(buffer + i * off, frames - i, m_sourceChannels);
@@ -1273,27 +1242,66 @@ int AudioOutputBase::CopyWithUpmix(char *buffer, int frames, uint &org_waud)
         if (!nFrames)
             continue;
 
-        len += CheckFreeSpace(nFrames);
+        uchar *out = DSPBuffer(len + nFrames * bpf) + len;
+        m_upmixer->receiveFrames((float *)out, nFrames);
+        len += nFrames * bpf;
+    }
+    return len;
+}
 
-        int bdFrames = (kAudioRingBufferSize - org_waud) / bpf;
-        if (bdFrames < nFrames)
-        {
-            if ((org_waud % bpf) != 0)
-            {
-                VBERROR(QString("Upmixing: org_waud = %1 (bpf = %2)")
-                        .arg(org_waud)
-                        .arg(bpf));
-            }
-            m_upmixer->receiveFrames((float *)(WPOS), bdFrames);
-            nFrames -= bdFrames;
-            org_waud = 0;
-        }
-        if (nFrames > 0)
-            m_upmixer->receiveFrames((float *)(WPOS), nFrames);
+/**
+ * DSP stage: upmix, timestretch, adjust the volume of and encode a chunk
+ * of audio on its way to the audiobuffer
+ *
+ * It works on the DSP buffer rather than in place in the audiobuffer, so it
+ * never has to deal with the audiobuffer wrapping around, and the output
+ * thread only ever sees finished audio.
+ *
+ * On return 'frames' is the number of frames after upmixing and 'len' the
+ * number of bytes to write to the audiobuffer, from the returned pointer.
+ */
+const uchar *AudioOutputBase::ProcessAudio(char *buffer, int &frames, int &len,
+                                           bool music)
+{
+    int bpf     = m_bytesPerFrame;
+    bool volume = m_internalVol && SWVolume();
 
-        org_waud = (org_waud + nFrames * bpf) % kAudioRingBufferSize;
+    // Nothing to do, skip the copy
+    if (!m_needsUpmix && !m_pSoundStretch && !volume && !m_encoder)
+    {
+        len = frames * bpf;
+        return (uchar *)buffer;
     }
-    return len;
+
+    len    = CopyWithUpmix(buffer, frames);
+    frames = len / bpf;
+    if (len <= 0)
+        return nullptr;
+
+    if (m_pSoundStretch)
+    {
+        // does not change the timecode, only the number of samples
+        m_pSoundStretch->putSamples((STST *)m_dspBuffer.data(), frames);
+        int nFrames = m_pSoundStretch->numSamples();
+        nFrames = m_pSoundStretch->receiveSamples((STST *)DSPBuffer(nFrames * bpf),
+                                                  nFrames);
+        len = nFrames * bpf;
+    }
+
+    if (volume)
+    {
+        AudioOutputUtil::AdjustVolume(m_dspBuffer.data(), len, m_volume,
+                                      music, m_needsUpmix && m_upmixer);
+    }
+
+    if (m_encoder)
+    {
+        int to_get = m_encoder->Encode(m_dspBuffer.data(), len,
+                                       m_processing ? FORMAT_FLT : m_format);
+        len = m_encoder->GetFrames(DSPBuffer(to_get), to_get);
+    }
+
+    return m_dspBuffer.data();
 }
 
 /**
@@ -1341,9 +1349,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     // Don't write new samples if we're resetting the buffer or reconfiguring
     QMutexLocker lock(&m_audioBufLock);
 
-    uint org_waud = m_waud;
-    int  afree    = audiofree();
-    int  used     = kAudioRingBufferSize - afree;
+    int afree = audiofree();
+    int used  = audiolen();
 
     if (m_passthru && m_spdifEnc)
     {
@@ -1488,110 +1495,11 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
            timecode of the first - add the time in ms that the frames added
            represent */
 
-        // Copy samples into audiobuffer, with upmix if necessary
-        if ((len = CopyWithUpmix((char *)buffer, frames, org_waud)) <= 0)
-        {
-            continue;
-        }
-
-        frames = len / bpf;
+        // Run the DSP stage and queue the result for the output thread
+        const uchar *out = ProcessAudio((char *)buffer, frames, len, music);
         frames_final += frames;
-
-        int bdiff = kAudioRingBufferSize - m_waud;
-        if ((len % bpf) != 0 && bdiff < len)
-        {
-            VBERROR(QString("AddData: Corruption likely: len = %1 (bpf = %2)")
-                    .arg(len)
-                    .arg(bpf));
-        }
-        if ((bdiff % bpf) != 0 && bdiff < len)
-        {
-            VBERROR(QString("AddData: Corruption likely: bdiff = %1 (bpf = %2)")
-                    .arg(bdiff)
-                    .arg(bpf));
-        }
-
-        if (m_pSoundStretch)
-        {
-            // does not change the timecode, only the number of samples
-            org_waud     = m_waud;
-            int bdFrames = bdiff / bpf;
-
-            if (bdiff < len)
-            {
-                m_pSoundStretch->putSamples((STST *)(WPOS), bdFrames);
-                m_pSoundStretch->putSamples((STST *)ABUF, (len - bdiff) / bpf);
-            }
-            else
-                m_pSoundStretch->putSamples((STST *)(WPOS), frames);
-
-            int nFrames = m_pSoundStretch->numSamples();
-            if (nFrames > frames)
-                CheckFreeSpace(nFrames);
-
-            len = nFrames * bpf;
-
-            if (nFrames > bdFrames)
-            {
-                nFrames -= m_pSoundStretch->receiveSamples((STST *)(WPOS),
-                                                         bdFrames);
-                org_waud = 0;
-            }
-            if (nFrames > 0)
-                nFrames = m_pSoundStretch->receiveSamples((STST *)(WPOS),
-                                                        nFrames);
-
-            org_waud = (org_waud + nFrames * bpf) % kAudioRingBufferSize;
-        }
-
-        if (m_internalVol && SWVolume())
-        {
-            org_waud    = m_waud;
-            int num     = len;
-
-            if (bdiff <= num)
-            {
-                AudioOutputUtil::AdjustVolume(WPOS, bdiff, m_volume,
-                                              music, m_needsUpmix && m_upmixer);
-                num -= bdiff;
-                org_waud = 0;
-            }
-            if (num > 0)
-                AudioOutputUtil::AdjustVolume(WPOS, num, m_volume,
-                                              music, m_needsUpmix && m_upmixer);
-            org_waud = (org_waud + num) % kAudioRingBufferSize;
-        }
-
-        if (m_encoder)
-        {
-            org_waud            = m_waud;
-            int to_get          = 0;
-
-            if (bdiff < len)
-            {
-                m_encoder->Encode(WPOS, bdiff, m_processing ? FORMAT_FLT : m_format);
-                to_get = m_encoder->Encode(ABUF, len - bdiff,
-                                         m_processing ? FORMAT_FLT : m_format);
-            }
-            else
-            {
-                to_get = m_encoder->Encode(WPOS, len,
-                                         m_processing ? FORMAT_FLT : m_format);
-            }
-
-            if (bdiff <= to_get)
-            {
-                m_encoder->GetFrames(WPOS, bdiff);
-                to_get -= bdiff ;
-                org_waud = 0;
-            }
-            if (to_get > 0)
-                m_encoder->GetFrames(WPOS, to_get);
-
-            org_waud = (org_waud + to_get) % kAudioRingBufferSize;
-        }
-
-        m_waud = org_waud;
+        if (len > 0)
+            WriteToBuffer(out, len);
     }
 
     SetAudiotime(frames_final, timecode);
@@ -1628,8 +1536,8 @@ void AudioOutputBase::Status()
  */
 void AudioOutputBase::GetBufferStatus(uint &fill, uint &total)
 {
-    fill  = kAudioRingBufferSize - audiofree();
-    total = kAudioRingBufferSize;
+    fill  = audiolen();
+    total = m_ringBuffer.Size();
 }
 
 /**
@@ -1698,18 +1606,19 @@ void AudioOutputBase::OutputAudioLoop(void)
 #endif
         Status();
 
-        // delay setting raud until after phys buffer is filled
+        // delay consuming the data until after the device has it,
         // so GetAudiotime will be accurate without locking
-        m_resetActive.TestAndDeref();
-        volatile uint next_raud = m_raud;
-        if (GetAudioData(fragment, m_fragmentSize, true, &next_raud))
+        uint generation    = 0;
+        uint64_t raud      = m_ringBuffer.BeginRead(generation);
+        uint64_t next_raud = raud;
+        bool got_data = GetAudioData(fragment, m_fragmentSize, true, &next_raud) > 0;
+        m_ringBuffer.EndRead();
+
+        // drop it if the buffer was reset while we were reading it
+        if (got_data && m_ringBuffer.GetGeneration() == generation)
         {
-            if (!m_resetActive.TestAndDeref())
-            {
-                WriteAudio(fragment, m_fragmentSize);
-                if (!m_resetActive.TestAndDeref())
-                    m_raud = next_raud;
-            }
+            WriteAudio(fragment, m_fragmentSize);
+            m_ringBuffer.Consume(raud, next_raud);
         }
 #ifdef AUDIOTSTESTING
         GetAudiotime();
@@ -1725,27 +1634,122 @@ void AudioOutputBase::OutputAudioLoop(void)
     dispatch(e);
 }
 
+/**
+ * Fill a buffer the device has asked for, in callback mode
+ *
+ * Never blocks: plays silence while paused and for whatever the audiobuffer
+ * can't provide. Returns the number of bytes of audio copied. As with
+ * GetAudioData(), if 'local_raud' is given the audio is only consumed once
+ * the caller passes it to m_ringBuffer.Consume().
+ */
+int AudioOutputBase::PullAudio(uchar *buffer, int size, uint64_t *local_raud)
+{
+    if (m_pauseAudio || m_killAudio)
+    {
+        if (!m_actuallyPaused)
+        {
+            VBAUDIO("PullAudio: audio paused");
+            OutputEvent e(OutputEvent::Paused);
+            dispatch(e);
+            m_wasPaused = true;
+        }
+
+        m_actuallyPaused = true;
+        m_audioTime = 0ms; // mark 'audiotime' as invalid.
+
+        memset(buffer, 0, size);
+        return 0;
+    }
+
+    if (m_wasPaused)
+    {
+        VBAUDIO("PullAudio: Play Event");
+        OutputEvent e(OutputEvent::Playing);
+        dispatch(e);
+        m_wasPaused = false;
+    }
+
+    int written_size = GetAudioData(buffer, size, false, local_raud);
+    if (size > written_size)
+    {
+        // play silence on buffer underrun
+        memset(buffer + written_size, 0, size - written_size);
+        VBAUDIOTS(QString("PullAudio: underrun, wanted %1 got %2")
+                  .arg(size).arg(written_size));
+    }
+
+    return written_size;
+}
+
+/**
+ * Run in the output thread in callback mode, wait for the device to ask
+ * for audio and give it as much as it asks for
+ *
+ * Audio goes to the device as soon as it has room rather than a fragment
+ * at a time once one is ready, so the device buffer can be kept short.
+ */
+void AudioOutputBase::CallbackAudioLoop(void)
+{
+    std::vector<uchar> buffer(std::max(m_soundcardBufferSize,
+                                       static_cast<long>(m_fragmentSize)));
+
+    while (!m_killAudio)
+    {
+        int size = std::min(WaitForDevice(), static_cast<int>(buffer.size()));
+        size -= size % m_outputBytesPerFrame;
+        if (size <= 0)
+            continue;
+
+        uint generation    = 0;
+        uint64_t raud      = m_ringBuffer.BeginRead(generation);
+        uint64_t next_raud = raud;
+        int written_size   = PullAudio(buffer.data(), size, &next_raud);
+        m_ringBuffer.EndRead();
+
+        // play silence if the buffer was reset while we were reading it
+        if (written_size && m_ringBuffer.GetGeneration() != generation)
+        {
+            memset(buffer.data(), 0, size);
+            written_size = 0;
+        }
+
+        WriteAudio(buffer.data(), size);
+
+        if (written_size)
+        {
+            m_ringBuffer.Consume(raud, next_raud);
+            Status();
+        }
+    }
+
+    VBAUDIO("CallbackAudioLoop: Stop Event");
+    OutputEvent e(OutputEvent::Stopped);
+    dispatch(e);
+}
+
 /**
  * Copy frames from the audiobuffer into the buffer provided
  *
  * If 'full_buffer' is true we copy either 'size' bytes (if available) or
  * nothing. Otherwise, we'll copy less than 'size' bytes if that's all that's
  * available. Returns the number of bytes copied.
+ *
+ * If 'local_raud' is given we read from there and leave the position after
+ * the data in it, rather than consuming the data from the audiobuffer. The
+ * caller must have started the read with m_ringBuffer.BeginRead().
  */
 int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
-                                  volatile uint *local_raud)
+                                  uint64_t *local_raud)
 {
+    uint generation = 0;
+    uint64_t raud = local_raud ? *local_raud : m_ringBuffer.BeginRead(generation);
 
-#define LRPOS (&m_audioBuffer[*local_raud])
     // re-check audioready() in case things changed.
     // for example, ClearAfterSeek() might have run
     int avail_size   = audioready();
     int frag_size    = size;
     int written_size = size;
 
-    if (local_raud == nullptr)
-        local_raud = &m_raud;
-
     if (!full_buffer && (size > avail_size))
     {
         // when full_buffer is false, return any available data
@@ -1753,15 +1757,14 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
         written_size = frag_size;
     }
 
-    if (!avail_size || (frag_size > avail_size))
-        return 0;
-
-    int bdiff = kAudioRingBufferSize - m_raud;
-
     int obytes = AudioOutputSettings::SampleSize(m_outputFormat);
 
-    if (obytes <= 0)
+    if (!avail_size || (frag_size > avail_size) || obytes <= 0)
+    {
+        if (!local_raud)
+            m_ringBuffer.EndRead();
         return 0;
+    }
 
     bool fromFloats = m_processing && !m_enc && m_outputFormat != FORMAT_FLT;
 
@@ -1770,37 +1773,40 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
         frag_size *= sizeof(float) / obytes;
 
     int off = 0;
+    uint64_t next_raud = raud;
 
-    if (bdiff <= frag_size)
+    // at most twice, if the data wraps around the end of the buffer
+    while (frag_size > 0)
     {
+        uint contiguous = 0;
+        const uint8_t *src = m_ringBuffer.ReadPointer(next_raud, contiguous);
+        int len = std::min(frag_size, static_cast<int>(contiguous));
+
         if (fromFloats)
         {
-            off = AudioOutputUtil::fromFloat(m_outputFormat, buffer,
-                                             LRPOS, bdiff);
+            off += AudioOutputUtil::fromFloat(m_outputFormat, buffer + off,
+                                              src, len);
         }
         else
         {
-            memcpy(buffer, LRPOS, bdiff);
-            off = bdiff;
+            memcpy(buffer + off, src, len);
+            off += len;
         }
 
-        frag_size -= bdiff;
-        *local_raud = 0;
+        frag_size -= len;
+        next_raud += len;
     }
-    if (frag_size > 0)
+
+    if (local_raud)
     {
-        if (fromFloats)
-        {
-            AudioOutputUtil::fromFloat(m_outputFormat, buffer + off,
-                                       LRPOS, frag_size);
-        }
-        else
-        {
-            memcpy(buffer + off, LRPOS, frag_size);
-        }
+        *local_raud = next_raud;
+    }
+    else
+    {
+        m_ringBuffer.EndRead();
+        if (!m_ringBuffer.Consume(raud, next_raud))
+            return 0;
     }
-
-    *local_raud += frag_size;
 
     // Mute individual channels through mono->stereo duplication
     MuteState mute_state = GetMuteState();
@@ -1828,7 +1834,7 @@ void AudioOutputBase::Drain()
         // Audio is paused and can't be drained, clear ringbuffer
         QMutexLocker lock(&m_audioBufLock);
 
-        m_waud = m_raud = 0;
+        m_ringBuffer.Clear();
     }
 }
 
@@ -1839,7 +1845,10 @@ void AudioOutputBase::run(void)
 {
     RunProlog();
     VBAUDIO(QString("kickoffOutputAudioLoop: pid = %1").arg(getpid()));
-    OutputAudioLoop();
+    if (m_useCallback)
+        CallbackAudioLoop();
+    else
+        OutputAudioLoop();
     VBAUDIO("kickoffOutputAudioLoop exiting");
     RunEpilog();
 }
@@ -1,6 +1,9 @@
 #ifndef AUDIOOUTPUTBASE
 #define AUDIOOUTPUTBASE
 
+// C++ headers
+#include <vector>
+
 // POSIX headers
 #include <sys/time.h> // for struct timeval
 
@@ -11,6 +14,7 @@
 
 // MythTV headers
 #include "audiooutput.h"
+#include "audioringbuffer.h"
 #include "mythlogging.h"
 #include "mthread.h"
 
@@ -31,18 +35,6 @@ class FreeSurround;
 class AudioOutputDigitalEncoder;
 struct AVCodecContext;
 
-class AsyncLooseLock
-{
-public:
-    AsyncLooseLock() = default;
-    void Clear() { m_head = m_tail = 0; }
-    void Ref() { m_head++; }
-    bool TestAndDeref() { bool r = false; if ((r=(m_head != m_tail))) m_tail++; return r; }
-private:
-    int m_head {0};
-    int m_tail {0};
-};
-
 // Forward declaration of SPDIF encoder
 class SPDIFEncoder;
 
@@ -139,6 +131,18 @@ class AudioOutputBase : public AudioOutput, public MThread
     // Default implementation only supports 2ch s16le at 48kHz
     virtual AudioOutputSettings* GetOutputSettings(bool /*digital*/)
         { return new AudioOutputSettings; }
+    /**
+     * Return true if the device can ask for audio when it wants it rather
+     * than have it written as soon as there's a fragment ready. A device
+     * run from the output thread implements WaitForDevice(), others pull
+     * from their own callbacks with PullAudio().
+     */
+    virtual bool CanCallback(void) const { return false; }
+    /**
+     * Block until the device wants more audio, for at most 100ms. Return
+     * the number of bytes it can take, or 0 if it can't take any yet.
+     */
+    virtual int  WaitForDevice(void) { return 0; }
     // You need to call this from any implementation in the dtor.
     void KillAudio(void);
 
@@ -147,14 +151,14 @@ class AudioOutputBase : public AudioOutput, public MThread
     virtual void StopOutputThread(void);
 
     int GetAudioData(uchar *buffer, int buf_size, bool full_buffer,
-                     volatile uint *local_raud = nullptr);
+                     uint64_t *local_raud = nullptr);
+    int PullAudio(uchar *buffer, int size, uint64_t *local_raud = nullptr);
 
     void OutputAudioLoop(void);
+    void CallbackAudioLoop(void);
 
     void run() override; // MThread
 
-    int CheckFreeSpace(int &frames);
-
     inline int audiolen() const; // number of valid bytes in audio buffer
     int audiofree() const;       // number of free bytes in audio buffer
     int audioready() const;      // number of bytes ready to be written
@@ -193,6 +197,8 @@ class AudioOutputBase : public AudioOutput, public MThread
     AudioOutputSource m_source;
 
     bool              m_killAudio                  {false};
+    /// The device pulls audio in callback mode, see CanCallback()
+    bool              m_useCallback                {false};
 
     bool              m_pauseAudio                 {false};
     bool              m_actuallyPaused             {false};
@@ -218,7 +224,10 @@ class AudioOutputBase : public AudioOutput, public MThread
     bool SetupPassthrough(AVCodecID codec, int codec_profile,
                           int &samplerate_tmp, int &channels_tmp);
     AudioOutputSettings* OutputSettings(bool digital = true);
-    int CopyWithUpmix(char *buffer, int frames, uint &org_waud);
+    int CopyWithUpmix(char *buffer, int frames);
+    const uchar *ProcessAudio(char *buffer, int &frames, int &len, bool music);
+    uchar *DSPBuffer(int size);
+    int WriteToBuffer(const uchar *buffer, int len);
     void SetAudiotime(int frames, std::chrono::milliseconds timecode);
     AudioOutputSettings       *m_outputSettingsRaw         {nullptr};
     AudioOutputSettings       *m_outputSettings            {nullptr};
@@ -245,6 +254,7 @@ class AudioOutputBase : public AudioOutput, public MThread
     int64_t           m_framesBuffered            {0};
 
     bool              m_audioThreadExists         {false};
+    bool              m_callbackSetting           {false};
 
     /**
      *  Writes to the audiobuffer, reconfigures and audiobuffer resets can only
@@ -263,16 +273,10 @@ class AudioOutputBase : public AudioOutput, public MThread
      */
     std::chrono::milliseconds m_audioTime                 {0ms};
 
-    /**
-     * Audio circular buffer
-     */
-    volatile uint     m_raud                              {0}; // read position
-    volatile uint     m_waud                              {0}; // write position
     /**
      * timecode of audio most recently placed into buffer
      */
     std::chrono::milliseconds m_audbufTimecode            {0ms};
-    AsyncLooseLock    m_resetActive;
 
     QMutex            m_killAudioLock                     {QMutex::NonRecursive};
 
@@ -289,10 +293,14 @@ class AudioOutputBase : public AudioOutput, public MThread
     int               m_kAudioSRCOutputSize               {0};
     uint              m_memoryCorruptionTest2             {0xdeadbeef};;
     /**
-     * main audio buffer
+     * DSP stage: holds each chunk of audio while it is upmixed, stretched,
+     * volume adjusted and encoded, before it goes into the main buffer
+     */
+    std::vector<uchar> m_dspBuffer;
+    /**
+     * main audio buffer, lock-free between AddData() and the output thread
      */
-    std::array<uchar,kAudioRingBufferSize> m_audioBuffer  {0};
-    uint              m_memoryCorruptionTest3             {0xdeadbeef};;
+    AudioRingBuffer   m_ringBuffer                        {kAudioRingBufferSize};
     bool              m_configureSucceeded                {false};
     std::chrono::milliseconds m_lengthLastData            {0ms};
 
@@ -16,10 +16,29 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <array>
+#include <cstring>
+
+#include "mythconfig.h"
 #include "audiooutputbase.h"
 #include "audiooutputdownmix.h"
 
-#include <cstring>
+extern "C" {
+#include "libavutil/cpu.h"
+}
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
+#elif HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+static const bool s_haveSIMD = have_neon(av_get_cpu_flags());
+#endif
 
 #define LOC QString("Downmixer: ")
 
@@ -166,6 +185,104 @@ static const std::array<six_speaker_set,3> s51_matrix
     }}
 }};
 
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+/*
+ The SIMD code keeps a row of the matrix, the contribution of one input channel
+ to each output channel, in a vector.  Each input sample is broadcast and
+ multiplied by its row, so the output channels are summed in parallel, in the
+ same order as the C.  For stereo, two frames are mixed at a time.
+ Returns how many frames were done, the rest is left for the C.
+ */
+static int DownmixStereoSIMD(int channels_in, float *dst, const float *src,
+                             int frames)
+{
+    const two_speaker_set &matrix = stereo_matrix[channels_in - 1];
+    std::array<std::array<float,4>,8> rows {};
+    int n = 0;
+
+    for (int j = 0; j < channels_in; j++)
+        rows[j] = { matrix[j][0], matrix[j][1], matrix[j][0], matrix[j][1] };
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+    for (; n + 2 <= frames; n += 2)
+    {
+        __m128 acc = _mm_setzero_ps();
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 in = _mm_shuffle_ps(_mm_load_ss(src + j),
+                                       _mm_load_ss(src + channels_in + j),
+                                       _MM_SHUFFLE(0,0,0,0));
+            acc = _mm_add_ps(acc, _mm_mul_ps(in, _mm_loadu_ps(rows[j].data())));
+        }
+        _mm_storeu_ps(dst, acc);
+        src += 2 * channels_in;
+        dst += 4;
+    }
+#else
+    for (; n + 2 <= frames; n += 2)
+    {
+        float32x4_t acc = vdupq_n_f32(0.0F);
+        for (int j = 0; j < channels_in; j++)
+        {
+            float32x4_t in = vcombine_f32(vdup_n_f32(src[j]),
+                                          vdup_n_f32(src[channels_in + j]));
+            acc = vaddq_f32(acc, vmulq_f32(in, vld1q_f32(rows[j].data())));
+        }
+        vst1q_f32(dst, acc);
+        src += 2 * channels_in;
+        dst += 4;
+    }
+#endif
+    return n;
+}
+
+static int Downmix51SIMD(int channels_in, float *dst, const float *src,
+                         int frames)
+{
+    const six_speaker_set &matrix = s51_matrix[channels_in - 6];
+    int n = 0;
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+    // the last two outputs of each row, padded to a whole vector
+    std::array<std::array<float,4>,8> hi {};
+    for (int j = 0; j < channels_in; j++)
+        hi[j] = { matrix[j][4], matrix[j][5], 0.0F, 0.0F };
+
+    for (; n < frames; n++)
+    {
+        __m128 acclo = _mm_setzero_ps();
+        __m128 acchi = _mm_setzero_ps();
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 in = _mm_set1_ps(src[j]);
+            acclo = _mm_add_ps(acclo, _mm_mul_ps(in, _mm_loadu_ps(&matrix[j][0])));
+            acchi = _mm_add_ps(acchi, _mm_mul_ps(in, _mm_loadu_ps(hi[j].data())));
+        }
+        _mm_storeu_ps(dst, acclo);
+        _mm_storel_pi((__m64 *)(dst + 4), acchi);
+        src += channels_in;
+        dst += 6;
+    }
+#else
+    for (; n < frames; n++)
+    {
+        float32x4_t acclo = vdupq_n_f32(0.0F);
+        float32x2_t acchi = vdup_n_f32(0.0F);
+        for (int j = 0; j < channels_in; j++)
+        {
+            acclo = vaddq_f32(acclo, vmulq_n_f32(vld1q_f32(&matrix[j][0]), src[j]));
+            acchi = vadd_f32(acchi, vmul_n_f32(vld1_f32(&matrix[j][4]), src[j]));
+        }
+        vst1q_f32(dst, acclo);
+        vst1_f32(dst + 4, acchi);
+        src += channels_in;
+        dst += 6;
+    }
+#endif
+    return n;
+}
+#endif
+
 int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
                                       float *dst, const float *src, int frames)
 {
@@ -177,7 +294,16 @@ int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
     if (channels_out == 2)
     {
         int index = channels_in - 1;
-        for (int n=0; n < frames; n++)
+        int n = 0;
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            n = DownmixStereoSIMD(channels_in, dst, src, frames);
+            src += n * channels_in;
+            dst += n * channels_out;
+        }
+#endif
+        for (; n < frames; n++)
         {
             for (int i=0; i < channels_out; i++)
             {
@@ -192,7 +318,16 @@ int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
     else if (channels_out == 6)
     {
         int index = channels_in - 6;
-        for (int n=0; n < frames; n++)
+        int n = 0;
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+        if (s_haveSIMD)
+        {
+            n = Downmix51SIMD(channels_in, dst, src, frames);
+            src += n * channels_in;
+            dst += n * channels_out;
+        }
+#endif
+        for (; n < frames; n++)
         {
             for (int i=0; i < channels_out; i++)
             {
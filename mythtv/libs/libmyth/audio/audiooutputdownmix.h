@@ -1,7 +1,9 @@
 #ifndef AUDIOOUTPUTDOWNMIX
 #define AUDIOOUTPUTDOWNMIX
 
-class AudioOutputDownmix
+#include "mythexp.h"
+
+class MPUBLIC AudioOutputDownmix
 {
 public:
     static int DownmixFrames(int channels_in, int  channels_out,
@@ -1,8 +1,10 @@
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <thread>
 #include <fcntl.h>
 #include <iostream>
 #include <sys/time.h>
@@ -36,12 +38,27 @@ AudioOutputNULL::~AudioOutputNULL()
 
 bool AudioOutputNULL::OpenDevice()
 {
-    LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, will fail.");
+    m_realtime = m_mainDevice.endsWith(":realtime", Qt::CaseInsensitive);
+    m_drainTime = 0;
 
-    m_fragmentSize = NULLAUDIO_OUTPUT_BUFFER_SIZE / 2;
-    m_soundcardBufferSize = NULLAUDIO_OUTPUT_BUFFER_SIZE;
+    if (!m_realtime)
+    {
+        LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, will fail.");
+
+        m_fragmentSize = NULLAUDIO_OUTPUT_BUFFER_SIZE / 2;
+        m_soundcardBufferSize = NULLAUDIO_OUTPUT_BUFFER_SIZE;
+
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, "Opening NULL audio device, playing in real time.");
+
+    // 10ms fragments, whole frames
+    m_fragmentSize = (m_sampleRate / 100) * m_outputBytesPerFrame;
+    m_soundcardBufferSize = NULLAUDIO_OUTPUT_BUFFER_SIZE -
+        (NULLAUDIO_OUTPUT_BUFFER_SIZE % m_outputBytesPerFrame);
 
-    return false;
+    return true;
 }
 
 void AudioOutputNULL::CloseDevice()
@@ -76,8 +93,56 @@ AudioOutputSettings* AudioOutputNULL::GetOutputSettings(bool /*digital*/)
 }
 
 
+std::chrono::nanoseconds AudioOutputNULL::BytesToTime(int bytes) const
+{
+    return std::chrono::nanoseconds(
+        (static_cast<int64_t>(bytes) * 1000000000) /
+        (static_cast<int64_t>(m_outputBytesPerFrame) * m_sampleRate));
+}
+
+/**
+ * Get the number of bytes the pretend sound card has still to play
+ */
+int AudioOutputNULL::RealtimeBuffered(void) const
+{
+    int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+    int64_t left = m_drainTime - now;
+    if (left <= 0)
+        return 0;
+    int64_t frames = (left * m_sampleRate) / 1000000000;
+    return static_cast<int>(frames * m_outputBytesPerFrame);
+}
+
+/**
+ * Sleep until the pretend sound card has room for a fragment, and return
+ * how much room it has
+ */
+int AudioOutputNULL::WaitForDevice(void)
+{
+    int space = m_soundcardBufferSize - RealtimeBuffered();
+    if (space < m_fragmentSize)
+    {
+        std::this_thread::sleep_for(BytesToTime(m_fragmentSize - space));
+        space = m_soundcardBufferSize - RealtimeBuffered();
+    }
+    return space;
+}
+
 void AudioOutputNULL::WriteAudio(unsigned char* aubuf, int size)
 {
+    if (m_realtime)
+    {
+        // block while the pretend sound card is full, as a real one would
+        int space = m_soundcardBufferSize - RealtimeBuffered();
+        if (space < size)
+            std::this_thread::sleep_for(BytesToTime(size - space));
+
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        int64_t start = std::max(now, static_cast<int64_t>(m_drainTime));
+        m_drainTime = start + BytesToTime(size).count();
+        return;
+    }
+
     if (m_bufferOutputDataForUse)
     {
         if (size + m_pcmOutputBuffer.size() > NULLAUDIO_OUTPUT_BUFFER_SIZE)
@@ -113,6 +178,8 @@ int AudioOutputNULL::readOutputData(unsigned char *read_buffer, size_t max_lengt
 
 void AudioOutputNULL::Reset()
 {
+    // a sound card reset drops what it was playing
+    m_drainTime = 0;
     if (m_bufferOutputDataForUse)
     {
         m_pcmOutputBufferMutex.lock();
@@ -124,6 +191,9 @@ void AudioOutputNULL::Reset()
 
 int AudioOutputNULL::GetBufferedOnSoundcard(void) const
 {
+    if (m_realtime)
+        return RealtimeBuffered();
+
     if (m_bufferOutputDataForUse)
         return m_pcmOutputBuffer.size();
 
@@ -1,6 +1,10 @@
 #ifndef AUDIOOUTPUTNULL
 #define AUDIOOUTPUTNULL
 
+// C++ headers
+#include <atomic>
+#include <chrono>
+
 #include "audiooutputbase.h"
 
 #define NULLAUDIO_OUTPUT_BUFFER_SIZE 32768
@@ -16,6 +20,11 @@
     it will maintain a small buffer and will not let anymore audio data be
     decoded until something pulls the data off (via readOutputData()). 
 
+    Opened as "NULL:realtime" it pretends to be a sound card instead,
+    playing audio at its sample rate through a buffer of
+    NULLAUDIO_OUTPUT_BUFFER_SIZE bytes, so it can stand in for one where
+    there is none.
+
 */
 
 class AudioOutputNULL : public AudioOutputBase
@@ -41,9 +50,18 @@ class AudioOutputNULL : public AudioOutputBase
     void CloseDevice(void) override; // AudioOutputBase
     void WriteAudio(unsigned char *aubuf, int size) override; // AudioOutputBase
     int  GetBufferedOnSoundcard(void) const override; // AudioOutputBase
+    bool CanCallback(void) const override { return m_realtime; } // AudioOutputBase
+    int  WaitForDevice(void) override; // AudioOutputBase
     AudioOutputSettings* GetOutputSettings(bool digital) override; // AudioOutputBase
 
   private:
+    std::chrono::nanoseconds BytesToTime(int bytes) const;
+    int  RealtimeBuffered(void) const;
+
+    bool          m_realtime             {false};
+    // when the audio written to the pretend sound card will have played
+    std::atomic<int64_t> m_drainTime     {0};
+
     QMutex        m_pcmOutputBufferMutex {QMutex::NonRecursive};
     std::vector<unsigned char> m_pcmOutputBuffer {0};
 };
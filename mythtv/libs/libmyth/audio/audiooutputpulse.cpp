@@ -279,6 +279,50 @@ void AudioOutputPulseAudio::WriteAudio(uchar *aubuf, int size)
                              .arg(sstate,0,16));
 }
 
+/**
+ * In callback mode, wait for WriteCallback() to say that the stream wants
+ * more audio
+ *
+ * Gives up after 100ms, as ALSA's snd_pcm_wait() does, so that a stream that
+ * stalls or is corked can't hold up the output thread for good.
+ */
+int AudioOutputPulseAudio::WaitForDevice(void)
+{
+    pa_threaded_mainloop_lock(m_mainloop);
+
+    size_t writable = pa_stream_writable_size(m_pstream);
+    if (writable == 0 && !m_killAudio)
+    {
+        pa_time_event *timeout =
+            pa_context_rttime_new(m_pcontext, pa_rtclock_now() + (100 * PA_USEC_PER_MSEC),
+                                  WaitTimeoutCallback, this);
+        pa_threaded_mainloop_wait(m_mainloop);
+        if (timeout)
+            pa_threaded_mainloop_get_api(m_mainloop)->time_free(timeout);
+        writable = pa_stream_writable_size(m_pstream);
+    }
+
+    pa_threaded_mainloop_unlock(m_mainloop);
+
+    // (size_t)-1 on error
+    return writable == static_cast<size_t>(-1) ? 0 : static_cast<int>(writable);
+}
+
+/**
+ * Wake the output thread if it is waiting in WaitForDevice(), there is no
+ * telling when the stream would next ask for audio
+ */
+void AudioOutputPulseAudio::StopOutputThread(void)
+{
+    if (m_useCallback && m_mainloop)
+    {
+        pa_threaded_mainloop_lock(m_mainloop);
+        pa_threaded_mainloop_signal(m_mainloop, 0);
+        pa_threaded_mainloop_unlock(m_mainloop);
+    }
+    AudioOutputBase::StopOutputThread();
+}
+
 int AudioOutputPulseAudio::GetBufferedOnSoundcard(void) const
 {
     pa_usec_t latency = 0;
@@ -532,7 +576,8 @@ bool AudioOutputPulseAudio::ConnectPlaybackStream(void)
     m_bufferSettings.maxlength   = UINT32_MAX;
     m_bufferSettings.tlength     = m_fragmentSize * 4;
     m_bufferSettings.prebuf      = UINT32_MAX;
-    m_bufferSettings.minreq      = UINT32_MAX;
+    // in callback mode ask to be called for a fragment at a time
+    m_bufferSettings.minreq      = m_useCallback ? m_fragmentSize : UINT32_MAX;
     m_bufferSettings.fragsize    = UINT32_MAX;
 
     int flags = PA_STREAM_INTERPOLATE_TIMING
@@ -640,6 +685,15 @@ void AudioOutputPulseAudio::WriteCallback(pa_stream */*s*/, size_t /*size*/, voi
     pa_threaded_mainloop_signal(audoutP->m_mainloop, 0);
 }
 
+void AudioOutputPulseAudio::WaitTimeoutCallback(pa_mainloop_api */*api*/,
+                                                pa_time_event */*e*/,
+                                                const struct timeval */*tv*/,
+                                                void *arg)
+{
+    auto *audoutP = static_cast<AudioOutputPulseAudio*>(arg);
+    pa_threaded_mainloop_signal(audoutP->m_mainloop, 0);
+}
+
 void AudioOutputPulseAudio::BufferFlowCallback(pa_stream */*s*/, void *tag)
 {
     VBERROR(QString("stream buffer %1 flow").arg((char*)tag));
@@ -40,6 +40,9 @@ class AudioOutputPulseAudio : public AudioOutputBase
     void CloseDevice(void) override; // AudioOutputBase
     void WriteAudio(unsigned char *aubuf, int size) override; // AudioOutputBase
     int GetBufferedOnSoundcard(void) const override; // AudioOutputBase
+    bool CanCallback(void) const override { return true; } // AudioOutputBase
+    int  WaitForDevice(void) override; // AudioOutputBase
+    void StopOutputThread(void) override; // AudioOutputBase
 
   private:
     QString ChooseHost(void);
@@ -52,6 +55,8 @@ class AudioOutputPulseAudio : public AudioOutputBase
     static void StreamStateCallback(pa_stream *s, void *arg);
     static void OpCompletionCallback(pa_context *c, int ok, void *arg);
     static void WriteCallback(pa_stream *s, size_t size, void *arg);
+    static void WaitTimeoutCallback(pa_mainloop_api *api, pa_time_event *e,
+                                    const struct timeval *tv, void *arg);
     static void BufferFlowCallback(pa_stream *s, void *tag);
     static void ServerInfoCallback(pa_context *context,
                                    const pa_server_info *inf, void *arg);
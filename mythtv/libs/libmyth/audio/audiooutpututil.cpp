@@ -14,6 +14,18 @@ extern "C" {
 }
 #include "pink.h"
 
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+#elif HAVE_INTRINSICS_NEON
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+#include <arm_neon.h>
+static const bool s_haveNEON = have_neon(av_get_cpu_flags());
+#endif
+
 #define LOC QString("AOUtil: ")
 
 #define ISALIGN(x) (((unsigned long)(x) & 0xf) == 0)
@@ -151,6 +163,22 @@ void AudioOutputUtil::AdjustVolume(void *buf, int len, int volume,
             :"xmm0","xmm1","xmm2","xmm3","xmm4"
         );
     }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveNEON && samples >= 16)
+    {
+        int loops = samples >> 4;
+        i = loops << 4;
+        float32x4_t gain = vdupq_n_f32(g);
+
+        for (int l = 0; l < loops; l++)
+        {
+            vst1q_f32(fptr,      vmulq_f32(vld1q_f32(fptr),      gain));
+            vst1q_f32(fptr + 4,  vmulq_f32(vld1q_f32(fptr + 4),  gain));
+            vst1q_f32(fptr + 8,  vmulq_f32(vld1q_f32(fptr + 8),  gain));
+            vst1q_f32(fptr + 12, vmulq_f32(vld1q_f32(fptr + 12), gain));
+            fptr += 16;
+        }
+    }
 #endif //ARCH_X86
     for (; i < samples; i++)
         *fptr++ *= g;
@@ -170,6 +198,77 @@ void tMuteChannel(AudioDataType *buffer, int channels, int ch, int frames)
     }
 }
 
+/*
+ The SSE and NEON code mutes 8 frames of 16 bit or 4 frames of 32 bit stereo
+ samples at a time and returns how many frames were done, the rest is left for
+ the C
+ */
+static int MuteChannelSIMD(int obits, int channels, int ch,
+                           void *buffer, int frames)
+{
+    int i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (!sse_check() || channels != 2 || (obits != 16 && obits != 32))
+        return 0;
+
+    auto *ptr = (__m128i *)buffer;
+    int step = obits == 16 ? 4 : 2;
+    for (; i + step <= frames; i += step, ptr++)
+    {
+        __m128i v = _mm_loadu_si128(ptr);
+        if (obits == 16)
+        {
+            // copy the other channel of each frame over this one
+            if (ch == 0)
+                v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3,3,1,1)),
+                                        _MM_SHUFFLE(3,3,1,1));
+            else
+                v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,2,0,0)),
+                                        _MM_SHUFFLE(2,2,0,0));
+        }
+        else
+        {
+            if (ch == 0)
+                v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3,3,1,1));
+            else
+                v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2,2,0,0));
+        }
+        _mm_storeu_si128(ptr, v);
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (!s_haveNEON || channels != 2 || (obits != 16 && obits != 32))
+        return 0;
+
+    if (obits == 16)
+    {
+        auto *ptr = (int16_t *)buffer;
+        for (; i + 8 <= frames; i += 8, ptr += 16)
+        {
+            int16x8x2_t v = vld2q_s16(ptr);
+            v.val[ch] = v.val[1 - ch];
+            vst2q_s16(ptr, v);
+        }
+    }
+    else
+    {
+        auto *ptr = (int32_t *)buffer;
+        for (; i + 4 <= frames; i += 4, ptr += 8)
+        {
+            int32x4x2_t v = vld2q_s32(ptr);
+            v.val[ch] = v.val[1 - ch];
+            vst2q_s32(ptr, v);
+        }
+    }
+#else
+    Q_UNUSED(obits);
+    Q_UNUSED(channels);
+    Q_UNUSED(ch);
+    Q_UNUSED(buffer);
+    Q_UNUSED(frames);
+#endif
+    return i;
+}
+
 /**
  * Mute individual channels through mono->stereo duplication
  *
@@ -180,6 +279,10 @@ void AudioOutputUtil::MuteChannel(int obits, int channels, int ch,
                                   void *buffer, int bytes)
 {
     int frames = bytes / ((obits >> 3) * channels);
+    int done   = MuteChannelSIMD(obits, channels, ch, buffer, frames);
+
+    frames -= done;
+    buffer = (char *)buffer + (done * (obits >> 3) * channels);
 
     if (obits == 8)
         tMuteChannel((uchar *)buffer, channels, ch, frames);
@@ -0,0 +1,120 @@
+// C++ headers
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+// MythTV headers
+#include "audioringbuffer.h"
+
+AudioRingBuffer::AudioRingBuffer(uint Size)
+  : m_size(Size),
+    m_buffer(Size)
+{
+}
+
+/**
+ * Get the number of bytes waiting to be read
+ */
+uint AudioRingBuffer::Used(void) const
+{
+    // Load the write position first. Clear() moves the read position before
+    // the write position, so if we see its new write position we see its
+    // new read position too, and never more than Size() bytes.
+    uint64_t write = m_write.load(std::memory_order_acquire);
+    uint64_t read  = m_read.load(std::memory_order_acquire);
+    return write > read ? static_cast<uint>(write - read) : 0;
+}
+
+/**
+ * Copy up to Length bytes into the buffer and make them available to the
+ * reader
+ *
+ * Returns the number of bytes written, which is less than Length if the
+ * buffer is full.
+ */
+uint AudioRingBuffer::Write(const void *Data, uint Length)
+{
+    uint64_t write = m_write.load(std::memory_order_relaxed);
+    Length = std::min(Length, Free());
+
+    const auto *data = static_cast<const uint8_t *>(Data);
+    uint offset = write % m_size;
+    uint first  = std::min(Length, m_size - offset);
+    memcpy(&m_buffer[offset], data, first);
+    if (first < Length)
+        memcpy(m_buffer.data(), data + first, Length - first);
+
+    m_write.store(write + Length, std::memory_order_release);
+    return Length;
+}
+
+/**
+ * Throw away everything waiting to be read
+ *
+ * The next write goes to the start of the buffer, so that whole frames
+ * never wrap around its end however the frame size has changed.
+ */
+void AudioRingBuffer::Clear(void)
+{
+    m_generation.fetch_add(1);
+
+    uint64_t write = m_write.load(std::memory_order_relaxed);
+    uint64_t next  = ((write + m_size - 1) / m_size) * m_size;
+    m_read.store(next);
+    m_write.store(next);
+
+    // A read that began before the new positions were visible may still be
+    // copying from the old ones. Wait for that read to end, not for the
+    // reader to be idle, so a busy reader can't hold the writer up. Reads
+    // are a copy of one fragment, and the next write can't land on it.
+    uint reads = m_reads.load();
+    if (reads & 1)
+    {
+        while (m_reads.load() == reads)
+            std::this_thread::yield();
+    }
+}
+
+/**
+ * Start copying audio out, returning the position to read from and in
+ * Generation the buffer's generation
+ *
+ * Call EndRead() once done with the data ReadPointer() gave. If
+ * GetGeneration() no longer matches Generation, the buffer was cleared
+ * after the read began.
+ */
+uint64_t AudioRingBuffer::BeginRead(uint &Generation)
+{
+    // Sequentially consistent, so that either Clear() sees this read and
+    // waits for it, or we see the generation and positions it left
+    m_reads.fetch_add(1);
+    Generation = m_generation.load();
+    return m_read.load();
+}
+
+/**
+ * Get a pointer to the data at Position, and in Contiguous the number of
+ * bytes from there to the end of the buffer
+ *
+ * The data that wraps around continues at the start of the buffer, i.e. at
+ * ReadPointer(Position + Contiguous).
+ */
+const uint8_t *AudioRingBuffer::ReadPointer(uint64_t Position,
+                                            uint &Contiguous) const
+{
+    uint offset = Position % m_size;
+    Contiguous = m_size - offset;
+    return &m_buffer[offset];
+}
+
+/**
+ * Free the space between From and To once the reader is done with it
+ *
+ * Returns false, without freeing anything, if the buffer was cleared after
+ * From was read.
+ */
+bool AudioRingBuffer::Consume(uint64_t From, uint64_t To)
+{
+    return m_read.compare_exchange_strong(From, To, std::memory_order_release,
+                                          std::memory_order_relaxed);
+}
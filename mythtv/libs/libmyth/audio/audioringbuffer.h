@@ -0,0 +1,69 @@
+#ifndef AUDIORINGBUFFER_H_
+#define AUDIORINGBUFFER_H_
+
+// C++ headers
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// MythTV headers
+#include "mythexp.h"
+
+/** \class AudioRingBuffer
+ *  \brief Lock-free ring buffer between one writer and one reader thread
+ *
+ *  The decoder side writes audio with Write() and may empty the buffer with
+ *  Clear(). The output side reads at ReadPosition() with ReadPointer() and
+ *  only consumes what it read with Consume() once the audio is on the
+ *  device, so that audio in flight is still counted as buffered.
+ *
+ *  Positions only ever increase, the offset into the buffer is the position
+ *  modulo its size. A Clear() moves both positions on to the start of the
+ *  buffer's next lap, so a reader still holding an old position can tell
+ *  that what it read was thrown away: its Consume() fails.
+ *
+ *  The reader copies audio out between BeginRead() and EndRead(). Clear()
+ *  waits for a copy in progress to finish, so that the writer can't start
+ *  overwriting the data being copied, and moves the generation on. A reader
+ *  whose generation has changed since BeginRead() copied audio that was
+ *  thrown away and mustn't play it.
+ *
+ *  Callers writing from more than one thread (e.g. AddData() and Reset())
+ *  must serialise those writes themselves.
+ */
+class MPUBLIC AudioRingBuffer
+{
+  public:
+    explicit AudioRingBuffer(uint Size);
+
+    uint     Size(void) const { return m_size; }
+    uint     Used(void) const;
+    uint     Free(void) const { return m_size - Used(); }
+
+    // Writer
+    uint     Write(const void *Data, uint Length);
+    void     Clear(void);
+
+    // Reader
+    uint64_t ReadPosition(void) const
+        { return m_read.load(std::memory_order_acquire); }
+    uint64_t BeginRead(uint &Generation);
+    void     EndRead(void)
+        { m_reads.fetch_add(1, std::memory_order_release); }
+    uint     GetGeneration(void) const
+        { return m_generation.load(std::memory_order_acquire); }
+    const uint8_t *ReadPointer(uint64_t Position, uint &Contiguous) const;
+    bool     Consume(uint64_t From, uint64_t To);
+
+  private:
+    Q_DISABLE_COPY(AudioRingBuffer)
+
+    uint                  m_size;
+    std::vector<uint8_t>  m_buffer;
+    std::atomic<uint64_t> m_read  {0};
+    std::atomic<uint64_t> m_write {0};
+    std::atomic<uint>     m_generation {0};
+    std::atomic<uint>     m_reads      {0}; ///< odd while reading
+};
+
+#endif
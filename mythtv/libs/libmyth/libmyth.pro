@@ -34,7 +34,7 @@ HEADERS += audio/audioconvert.h
 HEADERS += audio/audiooutputdigitalencoder.h audio/spdifencoder.h
 HEADERS += audio/audiosettings.h audio/audiooutputsettings.h audio/pink.h
 HEADERS += audio/volumebase.h audio/eldutils.h
-HEADERS += audio/audiooutputgraph.h
+HEADERS += audio/audiooutputgraph.h audio/audioringbuffer.h
 HEADERS += backendselect.h dbsettings.h
 HEADERS += langsettings.h
 HEADERS +=
@@ -58,7 +58,7 @@ SOURCES += audio/audiooutput.cpp audio/audiooutputbase.cpp
 SOURCES += audio/spdifencoder.cpp audio/audiooutputdigitalencoder.cpp
 SOURCES += audio/audiooutputnull.cpp
 SOURCES += audio/audiooutpututil.cpp audio/audiooutputdownmix.cpp
-SOURCES += audio/audioconvert.cpp
+SOURCES += audio/audioconvert.cpp audio/audioringbuffer.cpp
 SOURCES += audio/audiosettings.cpp audio/audiooutputsettings.cpp audio/pink.cpp
 SOURCES += audio/volumebase.cpp audio/eldutils.cpp
 SOURCES += audio/audiooutputgraph.cpp
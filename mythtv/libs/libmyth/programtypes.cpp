@@ -90,6 +90,7 @@ QString SkipTypeToString(int flags)
     bool logo  = (COMM_DETECT_LOGO  & flags) != 0;
     bool exp   = (COMM_DETECT_2     & flags) != 0;
     bool prePst= (COMM_DETECT_PREPOSTROLL & flags) != 0;
+    bool keyfrm= (COMM_DETECT_KEYFRAME & flags) != 0;
 
     if (blank && scene && logo)
         ret = QObject::tr("All Available Methods");
@@ -110,6 +111,8 @@ QString SkipTypeToString(int flags)
         ret = QObject::tr("Experimental") + ": " + ret;
     else if(prePst)
         ret = QObject::tr("Pre & Post Roll") + ": " + ret;
+    else if(keyfrm)
+        ret = QObject::tr("Keyframes Only") + ": " + ret;
 
     return ret;
 }
@@ -125,6 +128,8 @@ deque<int> GetPreferredSkipTypeCombinations(void)
     tmp.push_back(COMM_DETECT_2 | COMM_DETECT_BLANK | COMM_DETECT_LOGO);
     tmp.push_back(COMM_DETECT_PREPOSTROLL | COMM_DETECT_BLANK |
                   COMM_DETECT_SCENE);
+    tmp.push_back(COMM_DETECT_KEYFRAME | COMM_DETECT_BLANK |
+                  COMM_DETECT_SCENE | COMM_DETECT_LOGO);
     return tmp;
 }
 
@@ -112,7 +112,14 @@ enum SkipType {
     COMM_DETECT_PREPOSTROLL = 0x00000200,
     COMM_DETECT_PREPOSTROLL_ALL = (COMM_DETECT_PREPOSTROLL
                                    | COMM_DETECT_BLANKS
-                                   | COMM_DETECT_SCENE)
+                                   | COMM_DETECT_SCENE),
+
+    /* Only decode keyframes, and use audio levels to find break edges. */
+    COMM_DETECT_KEYFRAME    = 0x00000400,
+    COMM_DETECT_KEYFRAME_ALL = (COMM_DETECT_KEYFRAME
+                                | COMM_DETECT_BLANKS
+                                | COMM_DETECT_SCENE
+                                | COMM_DETECT_LOGO)
 };
 
 MPUBLIC QString SkipTypeToString(int flags);
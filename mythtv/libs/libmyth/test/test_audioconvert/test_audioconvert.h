@@ -18,6 +18,9 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <cmath>
+#include <vector>
+
 #include <QtTest/QtTest>
 
 #include "mythcorecontext.h"
@@ -532,6 +535,35 @@ class TestAudioConvert: public QObject
         av_free(arrayf1);
     }
 
+    static void FloatS16Ties_data(void)
+    {
+        QTest::addColumn<int>("SAMPLES");
+        QTest::newRow("Use accelerated code") << 32;
+        QTest::newRow("Use C code") << 9;
+    }
+
+    // samples halfway between two values round to even, like lrintf()
+    static void FloatS16Ties(void)
+    {
+        QFETCH(int, SAMPLES);
+
+        auto *arrays1 = (int16_t*)av_malloc(SAMPLES * ISIZEOF(int16_t));
+        auto *arrayf1 = (float*)av_malloc(SAMPLES * ISIZEOF(float));
+
+        for (int i = 0; i < SAMPLES; i++)
+            arrayf1[i] = ((i - (SAMPLES / 2)) + 0.5F) / 32768.0F;
+
+        AudioConvert::fromFloat(FORMAT_S16, arrays1, arrayf1, SAMPLES * ISIZEOF(float));
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            auto expected = (int16_t)lrintf((i - (SAMPLES / 2)) + 0.5F);
+            QCOMPARE(arrays1[i], expected);
+        }
+
+        av_free(arrays1);
+        av_free(arrayf1);
+    }
+
     static void FloatU8ClipTest3_data(void)
     {
         QTest::addColumn<int>("OFFSET");
@@ -587,4 +619,141 @@ class TestAudioConvert: public QObject
         av_free(arrays2);
         av_free(arrayf1);
     }
+
+    static void Interleave_data(void)
+    {
+        QTest::addColumn<int>("FORMAT");
+        QTest::addColumn<int>("CHANNELS");
+        QTest::addColumn<int>("FRAMES");
+        // odd frame counts leave a tail for the C code after the SIMD loop
+        QTest::newRow("S16 stereo")   << (int)FORMAT_S16 << 2 << 1001;
+        QTest::newRow("S16 5.1")      << (int)FORMAT_S16 << 6 << 1001;
+        QTest::newRow("S32 stereo")   << (int)FORMAT_S32 << 2 << 1001;
+        QTest::newRow("S32 3.0")      << (int)FORMAT_S32 << 3 << 1001;
+        QTest::newRow("S32 5.1")      << (int)FORMAT_S32 << 6 << 1001;
+        QTest::newRow("FLT 7.1")      << (int)FORMAT_FLT << 8 << 1001;
+        QTest::newRow("FLT 7.1 tiny") << (int)FORMAT_FLT << 8 << 3;
+        QTest::newRow("U8 stereo")    << (int)FORMAT_U8  << 2 << 1001;
+    }
+
+    // test planar -> interleaved -> planar is lossless and in the right order
+    static void Interleave(void)
+    {
+        QFETCH(int, FORMAT);
+        QFETCH(int, CHANNELS);
+        QFETCH(int, FRAMES);
+
+        auto format     = (AudioFormat)FORMAT;
+        int  samplesize = AudioOutputSettings::SampleSize(format);
+        int  SIZEARRAY  = CHANNELS * FRAMES * samplesize;
+        auto *planar1   = (uint8_t*)av_malloc(SIZEARRAY);
+        auto *planar2   = (uint8_t*)av_malloc(SIZEARRAY);
+        auto *packed    = (uint8_t*)av_malloc(SIZEARRAY);
+
+        for (int i = 0; i < SIZEARRAY; i++)
+        {
+            planar1[i] = (uint8_t)((i * 7) + (i / 251));
+        }
+
+        AudioConvert::InterleaveSamples(format, CHANNELS, packed, planar1, SIZEARRAY);
+        for (int f = 0; f < FRAMES; f++)
+        {
+            for (int c = 0; c < CHANNELS; c++)
+            {
+                const uint8_t *expected = planar1 + (((c * FRAMES) + f) * samplesize);
+                const uint8_t *actual   = packed + (((f * CHANNELS) + c) * samplesize);
+                QVERIFY(memcmp(expected, actual, samplesize) == 0);
+            }
+        }
+
+        AudioConvert::DeinterleaveSamples(format, CHANNELS, planar2, packed, SIZEARRAY);
+        QVERIFY(memcmp(planar1, planar2, SIZEARRAY) == 0);
+
+        av_free(planar1);
+        av_free(planar2);
+        av_free(packed);
+    }
+
+    // test mono -> stereo duplicates every sample, including the tail
+    static void MonoToStereo(void)
+    {
+        constexpr int SAMPLES = 1003;
+        std::vector<float> mono(SAMPLES);
+        std::vector<float> stereo(SAMPLES * 2);
+
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            mono[i] = (float)i / SAMPLES;
+        }
+
+        AudioConvert::MonoToStereo(stereo.data(), mono.data(), SAMPLES);
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            QCOMPARE(stereo[(i * 2)    ], mono[i]);
+            QCOMPARE(stereo[(i * 2) + 1], mono[i]);
+        }
+    }
+
+    static void ConvertSpeed_data(void)
+    {
+        QTest::addColumn<int>("FORMAT");
+        QTest::newRow("U8")  << (int)FORMAT_U8;
+        QTest::newRow("S16") << (int)FORMAT_S16;
+        QTest::newRow("S24") << (int)FORMAT_S24;
+        QTest::newRow("S32") << (int)FORMAT_S32;
+        QTest::newRow("FLT") << (int)FORMAT_FLT;
+    }
+
+    // one second of 7.1 48kHz audio to float and back
+    static void ConvertSpeed(void)
+    {
+        QFETCH(int, FORMAT);
+
+        auto format     = (AudioFormat)FORMAT;
+        int  SAMPLES    = 48000 * 8;
+        int  samplesize = AudioOutputSettings::SampleSize(format);
+        auto *arrayi    = (uint8_t*)av_mallocz(SAMPLES * samplesize);
+        auto *arrayf    = (float*)av_malloc(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioConvert::toFloat(format, arrayf, arrayi, SAMPLES * samplesize);
+            AudioConvert::fromFloat(format, arrayi, arrayf, SAMPLES * ISIZEOF(float));
+        }
+
+        av_free(arrayi);
+        av_free(arrayf);
+    }
+
+    static void InterleaveSpeed_data(void)
+    {
+        QTest::addColumn<int>("FORMAT");
+        QTest::addColumn<int>("CHANNELS");
+        QTest::newRow("S16 stereo") << (int)FORMAT_S16 << 2;
+        QTest::newRow("S16 7.1")    << (int)FORMAT_S16 << 8;
+        QTest::newRow("FLT stereo") << (int)FORMAT_FLT << 2;
+        QTest::newRow("FLT 5.1")    << (int)FORMAT_FLT << 6;
+        QTest::newRow("FLT 7.1")    << (int)FORMAT_FLT << 8;
+    }
+
+    // one second of 48kHz audio to planar and back
+    static void InterleaveSpeed(void)
+    {
+        QFETCH(int, FORMAT);
+        QFETCH(int, CHANNELS);
+
+        auto format    = (AudioFormat)FORMAT;
+        int  SIZEARRAY = 48000 * CHANNELS * AudioOutputSettings::SampleSize(format);
+        auto *planar   = (uint8_t*)av_mallocz(SIZEARRAY);
+        auto *packed   = (uint8_t*)av_mallocz(SIZEARRAY);
+
+        QBENCHMARK
+        {
+            AudioConvert::DeinterleaveSamples(format, CHANNELS, planar, packed, SIZEARRAY);
+            AudioConvert::InterleaveSamples(format, CHANNELS, packed, planar, SIZEARRAY);
+        }
+
+        av_free(planar);
+        av_free(packed);
+    }
 };
@@ -0,0 +1,314 @@
+/*
+ *  Class TestAudioRingBuffer
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "mythcorecontext.h"
+#include "audiooutput.h"
+#include "audioringbuffer.h"
+
+using namespace std::chrono_literals;
+
+class TestAudioRingBuffer: public QObject
+{
+    Q_OBJECT
+
+    // read everything waiting in the buffer, without consuming it
+    static std::vector<uint8_t> Peek(const AudioRingBuffer &Buffer)
+    {
+        std::vector<uint8_t> data;
+        uint64_t position = Buffer.ReadPosition();
+        uint left = Buffer.Used();
+        while (left > 0)
+        {
+            uint contiguous = 0;
+            const uint8_t *src = Buffer.ReadPointer(position, contiguous);
+            uint len = std::min(left, contiguous);
+            data.insert(data.end(), src, src + len);
+            position += len;
+            left -= len;
+        }
+        return data;
+    }
+
+  private slots:
+    // called at the beginning of these sets of tests
+    static void initTestCase(void)
+    {
+        gCoreContext = new MythCoreContext("bin_version", nullptr);
+    }
+
+    // data wrapping around the end of the buffer reads back in order
+    static void Wrap(void)
+    {
+        AudioRingBuffer buffer(100);
+        std::vector<uint8_t> data(70);
+        for (uint i = 0; i < data.size(); i++)
+            data[i] = static_cast<uint8_t>(i);
+
+        QCOMPARE(buffer.Write(data.data(), 70), 70U);
+        QVERIFY(buffer.Consume(0, 70));
+        QCOMPARE(buffer.Write(data.data(), 60), 60U);
+        QCOMPARE(buffer.Used(), 60U);
+
+        uint contiguous = 0;
+        buffer.ReadPointer(buffer.ReadPosition(), contiguous);
+        QCOMPARE(contiguous, 30U);
+
+        std::vector<uint8_t> read = Peek(buffer);
+        QVERIFY(read == std::vector<uint8_t>(data.begin(), data.begin() + 60));
+    }
+
+    // writes never overwrite data still waiting to be read
+    static void Full(void)
+    {
+        AudioRingBuffer buffer(100);
+        std::vector<uint8_t> data(80, 1);
+
+        QCOMPARE(buffer.Write(data.data(), 80), 80U);
+        QCOMPARE(buffer.Write(data.data(), 80), 20U);
+        QCOMPARE(buffer.Free(), 0U);
+        QCOMPARE(buffer.Write(data.data(), 80), 0U);
+    }
+
+    // a clear empties the buffer and the next write starts at its start
+    static void Clear(void)
+    {
+        AudioRingBuffer buffer(100);
+        std::vector<uint8_t> data(30, 1);
+
+        buffer.Write(data.data(), 30);
+        buffer.Clear();
+        QCOMPARE(buffer.Used(), 0U);
+        QCOMPARE(buffer.ReadPosition(), static_cast<uint64_t>(100));
+
+        uint contiguous = 0;
+        buffer.ReadPointer(buffer.ReadPosition(), contiguous);
+        QCOMPARE(contiguous, 100U);
+
+        // clearing an empty buffer at the start of a lap goes nowhere
+        buffer.Clear();
+        QCOMPARE(buffer.ReadPosition(), static_cast<uint64_t>(100));
+    }
+
+    // audio read before a clear can't be consumed after it
+    static void ConsumeAfterClear(void)
+    {
+        AudioRingBuffer buffer(100);
+        std::vector<uint8_t> data(10, 1);
+
+        buffer.Write(data.data(), 10);
+        uint64_t position = buffer.ReadPosition();
+        buffer.Clear();
+        buffer.Write(data.data(), 10);
+
+        QVERIFY(!buffer.Consume(position, position + 10));
+        QCOMPARE(buffer.Used(), 10U);
+    }
+
+    // one thread writing a count while another reads it back
+    static void Threaded(void)
+    {
+        static constexpr uint32_t kCount { 1000000 };
+        AudioRingBuffer buffer(4096 - 4);
+
+        std::thread writer([&buffer]()
+        {
+            uint32_t next = 0;
+            while (next < kCount)
+            {
+                std::array<uint32_t,97> values {};
+                uint count = std::min(static_cast<uint32_t>(values.size()),
+                                      kCount - next);
+                for (uint i = 0; i < count; i++)
+                    values[i] = next + i;
+                if (buffer.Free() < count * sizeof(uint32_t))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                buffer.Write(values.data(), count * sizeof(uint32_t));
+                next += count;
+            }
+        });
+
+        uint32_t expected = 0;
+        uint32_t bad = 0;
+        while (expected < kCount)
+        {
+            uint used = buffer.Used();
+            used -= used % sizeof(uint32_t);
+            if (used == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            uint64_t position = buffer.ReadPosition();
+            for (uint i = 0; i < used; i += sizeof(uint32_t))
+            {
+                uint32_t value = 0;
+                auto *dst = reinterpret_cast<uint8_t*>(&value);
+                for (uint b = 0; b < sizeof(uint32_t); b++)
+                {
+                    uint contiguous = 0;
+                    dst[b] = *buffer.ReadPointer(position + i + b, contiguous);
+                }
+                if (value != expected++)
+                    bad++;
+            }
+            if (!buffer.Consume(position, position + used))
+                bad++;
+        }
+
+        writer.join();
+        QCOMPARE(bad, 0U);
+        QCOMPARE(buffer.Used(), 0U);
+    }
+
+    // a clear while the reader is copying can't let the writer overwrite
+    // what it copies, and the reader can tell that it was cleared
+    static void ClearWhileReading(void)
+    {
+        static constexpr uint kClears { 2000 };
+        AudioRingBuffer buffer(256);
+        std::atomic<bool> done { false };
+
+        // every byte written between two clears is the number of clears.
+        // Half the time the writer waits for the reader to take the data
+        // first, otherwise it clears while the reader may be copying.
+        std::thread writer([&buffer, &done]()
+        {
+            std::array<uint8_t,128> block {};
+            for (uint clears = 0; clears < kClears; clears++)
+            {
+                block.fill(static_cast<uint8_t>(buffer.GetGeneration()));
+                buffer.Write(block.data(), block.size());
+                while ((clears % 2) == 0 && buffer.Used() > 0)
+                    std::this_thread::yield();
+                buffer.Clear();
+            }
+            done = true;
+        });
+
+        uint bad = 0;
+        uint reads = 0;
+        while (!done)
+        {
+            uint generation = 0;
+            uint64_t position = buffer.BeginRead(generation);
+            uint used = buffer.Used();
+            std::vector<uint8_t> data(used);
+            for (uint i = 0; i < used; i++)
+            {
+                uint contiguous = 0;
+                data[i] = *buffer.ReadPointer(position + i, contiguous);
+            }
+            buffer.EndRead();
+
+            if (data.empty() || buffer.GetGeneration() != generation)
+                continue;
+            reads++;
+            for (uint8_t value : data)
+            {
+                if (value != static_cast<uint8_t>(generation))
+                    bad++;
+            }
+            buffer.Consume(position, position + used);
+        }
+
+        writer.join();
+        QCOMPARE(bad, 0U);
+        QVERIFY(reads >= kClears / 2);
+    }
+
+    static void AVSync_data(void)
+    {
+        QTest::addColumn<bool>("USECALLBACK");
+        QTest::newRow("Push") << false;
+        QTest::newRow("Callback") << true;
+    }
+
+    // play audio in real time through the NULL device, the audio clock the
+    // video is timed against must keep step with the wall clock.  The
+    // jitter is logged to compare the modes; the clock is sampled between
+    // 5ms sleeps on a shared machine, so only a clock that stalls or jumps
+    // by a large part of the 200ms buffered fails.
+    static void AVSync(void)
+    {
+        QFETCH(bool, USECALLBACK);
+
+        gCoreContext->OverrideSettingForSession("AudioCallbackMode",
+                                                USECALLBACK ? "1" : "0");
+        AudioOutput *audio =
+            AudioOutput::OpenAudio("NULL:realtime", "", FORMAT_S16, 2,
+                                   AV_CODEC_ID_NONE, 48000, AUDIOOUTPUT_VIDEO,
+                                   false, false);
+        gCoreContext->ClearOverrideSettingForSession("AudioCallbackMode");
+        QVERIFY(audio != nullptr);
+        QVERIFY2(audio->GetError().isEmpty(), qPrintable(audio->GetError()));
+
+        // 10ms at a time, kept 200ms ahead of the wall clock
+        static constexpr int kFrames { 480 };
+        std::vector<int16_t> silence(static_cast<size_t>(kFrames) * 2, 0);
+        std::chrono::milliseconds fed = 0ms;
+        std::vector<double> offsets;
+        QElapsedTimer timer;
+        timer.start();
+
+        while (timer.elapsed() < 2000)
+        {
+            auto now = std::chrono::milliseconds(timer.elapsed());
+            while (fed < now + 200ms)
+            {
+                audio->AddFrames(silence.data(), kFrames, fed);
+                fed += 10ms;
+            }
+
+            // give it half a second to settle
+            std::chrono::milliseconds audiotime = audio->GetAudiotime();
+            if (now > 500ms && audiotime > 0ms)
+                offsets.push_back(static_cast<double>((audiotime - now).count()));
+
+            std::this_thread::sleep_for(5ms);
+        }
+        delete audio;
+
+        QVERIFY(offsets.size() > 100);
+        double mean = 0.0;
+        for (double offset : offsets)
+            mean += offset;
+        mean /= offsets.size();
+        double variance = 0.0;
+        for (double offset : offsets)
+            variance += (offset - mean) * (offset - mean);
+        double jitter = std::sqrt(variance / offsets.size());
+
+        qDebug() << (USECALLBACK ? "callback" : "push") << "mode: audio clock"
+                 << mean << "ms from the wall clock, jitter" << jitter << "ms";
+        QVERIFY2(jitter < 50.0, qPrintable(QString("jitter %1ms").arg(jitter)));
+    }
+};
@@ -19,11 +19,13 @@
  */
 
 #include <array>
+#include <vector>
 
 #include <QtTest/QtTest>
 
 #include "mythcorecontext.h"
 #include "audiooutpututil.h"
+#include "audiooutputdownmix.h"
 #include "pink.h"
 
 #define SSEALIGN 16     // for 16 bytes memory alignment
@@ -976,4 +978,175 @@ class TestAudioUtils: public QObject
         QCOMPARE(output[1022], expected_end[14]);
         QCOMPARE(output[1023], expected_end[15]);
     }
+
+    static void AdjustVolume_data(void)
+    {
+        QTest::addColumn<int>("SAMPLES");
+        QTest::newRow("Full buffer") << 4099;
+        QTest::newRow("C code only") << 7;
+    }
+
+    // test the volume is applied to every sample, including the tail
+    static void AdjustVolume(void)
+    {
+        QFETCH(int, SAMPLES);
+
+        auto *arrayf = (float*)av_malloc(SAMPLES * ISIZEOF(float));
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            arrayf[i] = (float)(i - (SAMPLES / 2)) / SAMPLES;
+        }
+
+        // 50% gives a gain of 0.25, which multiplies exactly
+        AudioOutputUtil::AdjustVolume(arrayf, SAMPLES * ISIZEOF(float), 50, false, false);
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            QCOMPARE(arrayf[i], ((float)(i - (SAMPLES / 2)) / SAMPLES) * 0.25F);
+        }
+
+        av_free(arrayf);
+    }
+
+    static void MuteChannel_data(void)
+    {
+        QTest::addColumn<int>("BITS");
+        QTest::addColumn<int>("CHANNEL");
+        QTest::newRow("S16 left")  << 16 << 0;
+        QTest::newRow("S16 right") << 16 << 1;
+        QTest::newRow("S32 left")  << 32 << 0;
+        QTest::newRow("S32 right") << 32 << 1;
+        QTest::newRow("U8 left")   << 8  << 0;
+    }
+
+    // test the muted channel is replaced by the other one in every frame
+    static void MuteChannel(void)
+    {
+        QFETCH(int, BITS);
+        QFETCH(int, CHANNEL);
+
+        constexpr int FRAMES = 1001;
+        std::vector<int32_t> left(FRAMES);
+        std::vector<int32_t> right(FRAMES);
+        std::vector<uint8_t> buffer(FRAMES * 2 * (BITS / 8));
+        auto *s8  = buffer.data();
+        auto *s16 = reinterpret_cast<int16_t*>(buffer.data());
+        auto *s32 = reinterpret_cast<int32_t*>(buffer.data());
+
+        for (int i = 0; i < FRAMES; i++)
+        {
+            left[i]  = (BITS == 8) ? (i & 0x7f)        : i;
+            right[i] = (BITS == 8) ? (0x80 | (i & 0x7f)) : -i - 1;
+            if (BITS == 8)
+            {
+                s8[(i * 2)]      = left[i];
+                s8[(i * 2) + 1]  = right[i];
+            }
+            else if (BITS == 16)
+            {
+                s16[(i * 2)]     = left[i];
+                s16[(i * 2) + 1] = right[i];
+            }
+            else
+            {
+                s32[(i * 2)]     = left[i];
+                s32[(i * 2) + 1] = right[i];
+            }
+        }
+
+        AudioOutputUtil::MuteChannel(BITS, 2, CHANNEL, buffer.data(), buffer.size());
+
+        const std::vector<int32_t> &kept = CHANNEL ? left : right;
+        for (int i = 0; i < FRAMES; i++)
+        {
+            for (int c = 0; c < 2; c++)
+            {
+                int32_t actual = (BITS == 8)  ? s8[(i * 2) + c]  :
+                                 (BITS == 16) ? s16[(i * 2) + c] :
+                                                s32[(i * 2) + c];
+                QCOMPARE(actual, kept[i]);
+            }
+        }
+    }
+
+    // test a 5.1 and a 7.1 downmix against the matrix coefficients
+    static void DownmixFrames(void)
+    {
+        constexpr float m3db      = 0.7071067811865476F;
+        constexpr float sqrt_2_3  = 0.816496580927726F;
+        constexpr float msqrt_1_3 = -0.577350269189626F;
+        constexpr int FRAMES = 1001;
+        std::vector<float> src(FRAMES * 8);
+        std::vector<float> dst(FRAMES * 6);
+
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            src[i] = (float)((i * 37) % 101) / 101.0F - 0.5F;
+        }
+
+        // 5.1 -> stereo: L R C LFE LS RS
+        QCOMPARE(AudioOutputDownmix::DownmixFrames(6, 2, dst.data(), src.data(), FRAMES), FRAMES);
+        for (int i = 0; i < FRAMES; i++)
+        {
+            const float *in = &src[i * 6];
+            float l = in[0] + (m3db * in[2]) + (sqrt_2_3 * in[4]) + (msqrt_1_3 * in[5]);
+            float r = in[1] + (m3db * in[2]) + (msqrt_1_3 * in[4]) + (sqrt_2_3 * in[5]);
+            QVERIFY(qAbs(dst[(i * 2)]     - l) < 1e-5F);
+            QVERIFY(qAbs(dst[(i * 2) + 1] - r) < 1e-5F);
+        }
+
+        // 7.1 -> 5.1: L R C LFE Rl Rr Ls Rs
+        QCOMPARE(AudioOutputDownmix::DownmixFrames(8, 6, dst.data(), src.data(), FRAMES), FRAMES);
+        for (int i = 0; i < FRAMES; i++)
+        {
+            const float *in = &src[i * 8];
+            std::array<float,6> expected {
+                in[0], in[1], in[2], in[3],
+                (m3db * in[4]) + (m3db * in[6]),
+                (m3db * in[5]) + (m3db * in[7])
+            };
+            for (int c = 0; c < 6; c++)
+            {
+                QVERIFY(qAbs(dst[(i * 6) + c] - expected[c]) < 1e-5F);
+            }
+        }
+    }
+
+    // one second of 7.1 48kHz audio
+    static void AdjustVolumeSpeed(void)
+    {
+        int SAMPLES  = 48000 * 8;
+        auto *arrayf = (float*)av_mallocz(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioOutputUtil::AdjustVolume(arrayf, SAMPLES * ISIZEOF(float), 50, false, false);
+        }
+
+        av_free(arrayf);
+    }
+
+    static void DownmixSpeed_data(void)
+    {
+        QTest::addColumn<int>("IN");
+        QTest::addColumn<int>("OUT");
+        QTest::newRow("5.1 -> stereo") << 6 << 2;
+        QTest::newRow("7.1 -> stereo") << 8 << 2;
+        QTest::newRow("7.1 -> 5.1")    << 8 << 6;
+    }
+
+    // one second of 48kHz audio
+    static void DownmixSpeed(void)
+    {
+        QFETCH(int, IN);
+        QFETCH(int, OUT);
+
+        int FRAMES = 48000;
+        std::vector<float> src(FRAMES * IN);
+        std::vector<float> dst(FRAMES * OUT);
+
+        QBENCHMARK
+        {
+            AudioOutputDownmix::DownmixFrames(IN, OUT, dst.data(), src.data(), FRAMES);
+        }
+    }
 };
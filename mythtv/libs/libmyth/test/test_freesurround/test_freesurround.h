@@ -0,0 +1,200 @@
+/*
+ *  Class TestFreeSurround
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include <QtTest/QtTest>
+
+#include "freesurround.h"
+
+struct SurroundSample
+{
+    uint                 m_frame;
+    std::array<float,6>  m_value; // L R C LFE LS RS
+};
+
+// Output of the decoder before it was vectorized, for the signal below:
+// Upmix() of six blocks through the complex FFT el_processor.cpp, sampled
+// every 1237 frames from the end of the first block, with the RMS of each
+// channel after that block.  The polynomial trig functions it now uses
+// keep it within 1e-4 of these.
+static const std::array<SurroundSample,16> kLinearReference
+{{
+    {  4096, {  0.0548401810F,  0.1250639409F,  0.0231152494F,  0.0097463969F, -0.0334437825F,  0.0401701555F } },
+    {  5333, {  0.1335244775F,  0.1774352193F,  0.1072083935F, -0.0020021177F,  0.2189735323F,  0.0313183740F } },
+    {  6570, { -0.0973992646F, -0.3510659039F, -0.1141602248F,  0.0005691618F,  0.0693558604F, -0.0558053032F } },
+    {  7807, { -0.0566554144F,  0.1354945749F,  0.0141925067F,  0.0000573811F, -0.1633910835F,  0.0186898671F } },
+    {  9044, {  0.1940199435F,  0.2405704260F,  0.0998147577F,  0.0000436861F, -0.1276383102F,  0.0396057256F } },
+    { 10281, { -0.2324790359F, -0.3578693569F, -0.1206353903F, -0.0001153308F,  0.0435438417F, -0.0564262308F } },
+    { 11518, {  0.1320655346F,  0.0797734633F,  0.0283669699F,  0.0000861732F,  0.2187419236F,  0.0126668550F } },
+    { 12755, {  0.0444203727F,  0.2858402133F,  0.0905531645F, -0.0000220793F,  0.0202829689F,  0.0445906967F } },
+    { 13992, { -0.1144312620F, -0.3336105347F, -0.1236761436F, -0.0000737395F, -0.2218203396F, -0.0536500290F } },
+    { 15229, {  0.0050212364F,  0.0172676556F,  0.0402980074F,  0.0001190946F, -0.0915765911F,  0.0058166590F } },
+    { 16466, {  0.1338373721F,  0.3041622639F,  0.0805343464F, -0.0000469252F,  0.1769552827F,  0.0460202731F } },
+    { 17703, { -0.1485220939F, -0.2811772823F, -0.1259683073F, -0.0000237249F,  0.1350842118F, -0.0471236445F } },
+    { 18940, {  0.0368664972F, -0.0403356440F,  0.0527411923F,  0.0001090892F, -0.0683130324F, -0.0004445224F } },
+    { 20177, {  0.1253910810F,  0.2908880413F,  0.0698776618F, -0.0000901801F, -0.1783696562F,  0.0433479808F } },
+    { 21414, { -0.2336805165F, -0.2090629786F, -0.1268945485F,  0.0000224044F, -0.0544864573F, -0.0379488878F } },
+    { 22651, {  0.1790205836F, -0.0818783864F,  0.0652754530F,  0.0000668635F,  0.2233636379F, -0.0047069909F } }
+}};
+static const std::array<float,6> kLinearRMS { 0.131237F, 0.186489F, 0.089132F, 0.001399F, 0.146963F, 0.029644F };
+
+static const std::array<SurroundSample,16> kSimpleReference
+{{
+    {  4096, {  0.0470892303F,  0.0844635144F,  0.0363037586F,  0.0097463969F, -0.0228159670F, -0.0410197452F } },
+    {  5333, {  0.0302201845F,  0.0805634931F,  0.2015377283F, -0.0020021177F,  0.2454132438F, -0.0522142202F } },
+    {  6570, { -0.0113822175F, -0.2336849868F, -0.2144985944F,  0.0005691618F,  0.0572410747F,  0.0929513574F } },
+    {  7807, { -0.0509794615F,  0.1132159457F,  0.0261378754F,  0.0000573811F, -0.1743469238F, -0.0315880068F } },
+    {  9044, {  0.1128861159F,  0.1453886926F,  0.1870304793F,  0.0000436861F, -0.1121071130F, -0.0663927794F } },
+    { 10281, { -0.1274671108F, -0.2375572026F, -0.2249643058F, -0.0001153308F,  0.0202724449F,  0.0948513597F } },
+    { 11518, {  0.0861170217F,  0.0522001982F,  0.0520673841F,  0.0000861732F,  0.2405143976F, -0.0212874487F } },
+    { 12755, { -0.0270742346F,  0.1939552426F,  0.1696212590F, -0.0000220793F,  0.0292223692F, -0.0750663951F } },
+    { 13992, { -0.0001277990F, -0.2125387788F, -0.2323316336F, -0.0000737395F, -0.2471771389F,  0.0901153088F } },
+    { 15229, { -0.0194230899F, -0.0149959810F,  0.0772955418F,  0.0001190946F, -0.0930574834F, -0.0094844224F } },
+    { 16466, {  0.0528858900F,  0.2185947299F,  0.1501900703F, -0.0000469252F,  0.1998741925F, -0.0776679963F } },
+    { 17703, { -0.0517347530F, -0.1628403962F, -0.2369152904F, -0.0000237249F,  0.1225216389F,  0.0790013745F } },
+    { 18940, { -0.0014344282F, -0.0773563758F,  0.1016040593F,  0.0001090892F, -0.0655352026F,  0.0013105385F } },
+    { 20177, {  0.0749131143F,  0.2149218023F,  0.1289325356F, -0.0000901801F, -0.1725978106F, -0.0732047707F } },
+    { 21414, { -0.1161711290F, -0.0961771011F, -0.2386452556F,  0.0000224044F, -0.0822635368F,  0.0633430928F } },
+    { 22651, {  0.0996885151F, -0.1245816201F,  0.1247065365F,  0.0000668635F,  0.2509334087F,  0.0087023219F } }
+}};
+static const std::array<float,6> kSimpleRMS { 0.065804F, 0.138324F, 0.168633F, 0.001399F, 0.157387F, 0.049618F };
+
+class TestFreeSurround: public QObject
+{
+    Q_OBJECT
+
+    static constexpr uint  kRate      { 48000 };
+    static constexpr float kTolerance { 1e-4F };
+
+    // a tone in both channels, one panned left and one in each channel
+    static void Generate(std::vector<float> &Input, uint Frames)
+    {
+        Input.resize(static_cast<size_t>(Frames) * 2);
+        for (uint i = 0; i < Frames; i++)
+        {
+            double t = static_cast<double>(i) / kRate;
+            double common = 0.3 * sin(2 * M_PI * 440 * t);
+            double panned = 0.2 * sin(2 * M_PI * 1250 * t);
+            Input[(i * 2)]     = static_cast<float>(common + panned + (0.1 * sin(2 * M_PI * 60 * t)));
+            Input[(i * 2) + 1] = static_cast<float>(common - (0.5 * panned) +
+                                                    (0.25 * sin((2 * M_PI * 3000 * t) + 1.0)));
+        }
+    }
+
+    static std::vector<float> Upmix(bool MovieMode, FreeSurround::SurroundMode Mode,
+                                    uint Frames)
+    {
+        FreeSurround surround(kRate, MovieMode, Mode);
+        std::vector<float> input;
+        std::vector<float> output(static_cast<size_t>(Frames) * 6);
+        Generate(input, Frames);
+
+        uint in  = 0;
+        uint out = 0;
+        while (in < Frames)
+        {
+            in  += surround.putFrames(&input[static_cast<size_t>(in) * 2], Frames - in, 2);
+            out += surround.receiveFrames(&output[static_cast<size_t>(out) * 6], Frames - out);
+        }
+        output.resize(static_cast<size_t>(out) * 6);
+        return output;
+    }
+
+    static void Compare(const std::vector<float> &Output,
+                        const std::array<SurroundSample,16> &Reference,
+                        const std::array<float,6> &RMS)
+    {
+        uint frames = Output.size() / 6;
+        QCOMPARE(frames, FreeSurround::framesPerBlock() * 6);
+
+        for (const auto & sample : Reference)
+        {
+            for (uint c = 0; c < 6; c++)
+            {
+                float value = Output[(sample.m_frame * 6) + c];
+                QVERIFY2(std::fabs(value - sample.m_value[c]) < kTolerance,
+                         qPrintable(QString("frame %1 channel %2: %3 expected %4")
+                                    .arg(sample.m_frame).arg(c)
+                                    .arg(value).arg(sample.m_value[c])));
+            }
+        }
+
+        // the first block out is the decoder's latency
+        for (uint c = 0; c < 6; c++)
+        {
+            double sum = 0.0;
+            for (uint f = FreeSurround::framesPerBlock(); f < frames; f++)
+                sum += static_cast<double>(Output[(f * 6) + c]) * Output[(f * 6) + c];
+            double rms = sqrt(sum / (frames - FreeSurround::framesPerBlock()));
+            QVERIFY2(std::fabs(rms - RMS[c]) < RMS[c] * 0.01,
+                     qPrintable(QString("channel %1: rms %2 expected %3")
+                                .arg(c).arg(rms).arg(RMS[c])));
+        }
+    }
+
+  private slots:
+    // test the linear steering against the reference output
+    static void LinearSteering(void)
+    {
+        std::vector<float> output =
+            Upmix(false, FreeSurround::SurroundModeActiveLinear,
+                  FreeSurround::framesPerBlock() * 6);
+        Compare(output, kLinearReference, kLinearRMS);
+    }
+
+    // test the simple steering, with the movie mode's phase shift, against
+    // the reference output
+    static void SimpleSteering(void)
+    {
+        std::vector<float> output =
+            Upmix(true, FreeSurround::SurroundModeActiveSimple,
+                  FreeSurround::framesPerBlock() * 6);
+        Compare(output, kSimpleReference, kSimpleRMS);
+    }
+
+    // a decoder reusing the FFT plans of a deleted one gives the same output
+    static void PlanReuse(void)
+    {
+        std::vector<float> first =
+            Upmix(false, FreeSurround::SurroundModeActiveLinear,
+                  FreeSurround::framesPerBlock() * 3);
+        std::vector<float> second =
+            Upmix(false, FreeSurround::SurroundModeActiveLinear,
+                  FreeSurround::framesPerBlock() * 3);
+        QVERIFY(first == second);
+    }
+
+    // one block of stereo in and 5.1 out
+    static void UpmixSpeed(void)
+    {
+        FreeSurround surround(kRate, false, FreeSurround::SurroundModeActiveLinear);
+        uint frames = FreeSurround::framesPerBlock();
+        std::vector<float> input;
+        std::vector<float> output(static_cast<size_t>(frames) * 6);
+        Generate(input, frames);
+
+        QBENCHMARK
+        {
+            surround.putFrames(input.data(), frames, 2);
+            surround.receiveFrames(output.data(), frames);
+        }
+    }
+};
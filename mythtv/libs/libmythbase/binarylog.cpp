@@ -0,0 +1,126 @@
+#include <QDateTime>
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+#include "binarylog.h"
+#include "mythlogging.h"
+
+/// \brief  Read the whole file and check its header.  The file can still be
+///         open for writing, only the part the header marks as in use is
+///         decoded.
+BinaryLogReader::BinaryLogReader(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    m_data = file.readAll();
+
+    if (m_data.size() < BinaryLog::kHeaderSize ||
+        memcmp(m_data.constData(), BinaryLog::kMagic,
+               sizeof(BinaryLog::kMagic)) != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("%1 is not a binary log").arg(filename));
+        return;
+    }
+
+    const char *data = m_data.constData();
+    auto version = qFromLittleEndian<uint32_t>(data + 8);
+    if (version != BinaryLog::kVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("%1 is binary log version %2, only version %3 is known")
+            .arg(filename).arg(version).arg(BinaryLog::kVersion));
+        return;
+    }
+
+    m_pid = static_cast<int>(qFromLittleEndian<uint32_t>(data + 12));
+    auto used = qFromLittleEndian<uint64_t>(data + BinaryLog::kUsedOffset);
+    m_used = static_cast<int>(std::min<uint64_t>(used, m_data.size()));
+    m_appName = QString::fromUtf8(data + BinaryLog::kAppNameOffset,
+                                  static_cast<int>(strnlen(
+                                      data + BinaryLog::kAppNameOffset,
+                                      BinaryLog::kAppNameSize)));
+    m_open = true;
+}
+
+/// \brief  Get the next message, collecting the strings defined on the way.
+/// \return false at the end of the log, or if the rest of it is corrupt
+bool BinaryLogReader::Next(BinaryLogEntry &entry)
+{
+    while (m_open && m_pos + BinaryLog::kRecordHeader <= m_used)
+    {
+        const char *record = m_data.constData() + m_pos;
+        int size = qFromLittleEndian<uint16_t>(record);
+        auto type = static_cast<uint8_t>(record[2]);
+        if (size < BinaryLog::kRecordHeader || m_pos + size > m_used)
+        {
+            LOG(VB_GENERAL, LOG_WARNING,
+                QString("Corrupt binary log record at offset %1").arg(m_pos));
+            m_open = false;
+            return false;
+        }
+        m_pos += size;
+
+        if (type == BinaryLog::kString && size >= BinaryLog::kStringHeader)
+        {
+            auto id = qFromLittleEndian<uint16_t>(record + 4);
+            m_strings[id] = QString::fromUtf8(record + BinaryLog::kStringHeader,
+                                              size - BinaryLog::kStringHeader);
+        }
+        else if (type == BinaryLog::kMessage &&
+                 size >= BinaryLog::kMessageHeader)
+        {
+            entry.m_level      = static_cast<LogLevel_t>(
+                static_cast<int8_t>(record[3]));
+            entry.m_epoch      = qFromLittleEndian<int64_t>(record + 4);
+            entry.m_mask       = qFromLittleEndian<uint64_t>(record + 12);
+            entry.m_tid        = qFromLittleEndian<uint32_t>(record + 20);
+            entry.m_line       = static_cast<int>(
+                qFromLittleEndian<uint32_t>(record + 24));
+            entry.m_threadName = String(qFromLittleEndian<uint16_t>(record + 28));
+            entry.m_file       = String(qFromLittleEndian<uint16_t>(record + 30));
+            entry.m_function   = String(qFromLittleEndian<uint16_t>(record + 32));
+            entry.m_message    = QString::fromUtf8(
+                record + BinaryLog::kMessageHeader,
+                size - BinaryLog::kMessageHeader);
+            return true;
+        }
+        // Skip record types from newer writers
+    }
+    return false;
+}
+
+QString BinaryLogReader::String(uint16_t id) const
+{
+    return m_strings.value(id, "unknown");
+}
+
+/// \brief  Format a message the same way FileLogger writes it.
+QString BinaryLogReader::Format(const BinaryLogEntry &entry) const
+{
+    QString timestamp = QDateTime::fromMSecsSinceEpoch(entry.m_epoch)
+        .toString("yyyy-MM-dd HH:mm:ss.zzz");
+    QChar shortname = logLevelGetShortName(entry.m_level);
+
+    if (entry.m_tid)
+    {
+        return QString("%1 %2 [%3/%4] %5 %6:%7 (%8) - %9")
+            .arg(timestamp, shortname, QString::number(m_pid),
+                 QString::number(entry.m_tid), entry.m_threadName,
+                 entry.m_file, QString::number(entry.m_line),
+                 entry.m_function, entry.m_message);
+    }
+    return QString("%1 %2 [%3] %5 %6:%7 (%8) - %9")
+        .arg(timestamp, shortname, QString::number(m_pid),
+             entry.m_threadName, entry.m_file,
+             QString::number(entry.m_line), entry.m_function,
+             entry.m_message);
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
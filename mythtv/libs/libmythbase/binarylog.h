@@ -0,0 +1,113 @@
+#ifndef BINARYLOG_H_
+#define BINARYLOG_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include <cstdint>
+
+#include "mythbaseexp.h"
+#include "verbosedefs.h"
+
+/** \file binarylog.h
+ *  \brief The compact binary log format written by BinaryLogger.
+ *
+ *  A log is a pair of files, \<name\> being written and \<name\>.1 holding
+ *  the older messages.  When \<name\> reaches half the configured size it
+ *  replaces \<name\>.1, so both together never use more than that size.
+ *
+ *  Each file starts with a fixed size header, followed by records.  All
+ *  values are little endian.
+ *
+ *  Header (kHeaderSize bytes):
+ *  - char[8]   "MYTHBLOG"
+ *  - uint32    format version
+ *  - uint32    process id
+ *  - uint64    number of bytes in use, header included
+ *  - char[40]  application name, nul padded
+ *
+ *  Every record starts with a uint16 record size (including these four
+ *  bytes), a uint8 record type, and a uint8 log level (unused for strings).
+ *
+ *  kString records define the strings (file, function and thread names)
+ *  that messages refer to.  Each file defines its strings again, so it can
+ *  be decoded on its own:
+ *  - uint16    string id
+ *  - UTF-8     the string
+ *
+ *  kMessage records:
+ *  - int64     time in ms since the epoch
+ *  - uint64    verbose mask (VB_*)
+ *  - uint32    thread id as shown by the OS
+ *  - uint32    line number
+ *  - uint16    thread name string id
+ *  - uint16    file name string id
+ *  - uint16    function name string id
+ *  - UTF-8     the message
+ */
+namespace BinaryLog
+{
+    static constexpr char     kMagic[8]        { 'M','Y','T','H','B','L','O','G' };
+    static constexpr uint32_t kVersion         { 1 };
+    static constexpr int      kHeaderSize      { 64 };
+    static constexpr int      kAppNameOffset   { 24 };
+    static constexpr int      kAppNameSize     { 40 };
+    static constexpr int      kUsedOffset      { 16 };
+    static constexpr int      kRecordHeader    { 4 };
+    static constexpr int      kStringHeader    { kRecordHeader + 2 };
+    static constexpr int      kMessageHeader   { kRecordHeader + 30 };
+    static constexpr int      kMaxRecordSize   { UINT16_MAX };
+    static constexpr uint16_t kNoString        { UINT16_MAX };
+
+    enum RecordType : uint8_t
+    {
+        kString  = 1,
+        kMessage = 2,
+    };
+}
+
+/// \brief One message read back from a binary log
+struct BinaryLogEntry
+{
+    int64_t     m_epoch    {0};
+    uint64_t    m_mask     {0};
+    uint32_t    m_tid      {0};
+    int         m_line     {0};
+    LogLevel_t  m_level    {LOG_INFO};
+    QString     m_threadName;
+    QString     m_file;
+    QString     m_function;
+    QString     m_message;
+};
+
+/// \brief Reads the messages from one file of a binary log
+class MBASE_PUBLIC BinaryLogReader
+{
+  public:
+    explicit BinaryLogReader(const QString &filename);
+
+    bool IsOpen(void) const { return m_open; }
+    QString AppName(void) const { return m_appName; }
+    int Pid(void) const { return m_pid; }
+    bool Next(BinaryLogEntry &entry);
+
+    QString Format(const BinaryLogEntry &entry) const;
+
+  private:
+    QString String(uint16_t id) const;
+
+    QByteArray m_data;
+    int        m_pos     {BinaryLog::kHeaderSize};
+    int        m_used    {0};
+    bool       m_open    {false};
+    int        m_pid     {0};
+    QString    m_appName;
+    QHash<uint16_t, QString> m_strings;
+};
+
+#endif
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -10,6 +10,7 @@
 #include <QMap>
 #include <QRegularExpression>
 #include <QVariantMap>
+#include <algorithm>
 #include <iostream>
 
 #include "mythlogging.h"
@@ -71,18 +72,26 @@ static QHash<uint64_t, QString> logThreadHash;
 static QMutex                   logThreadTidMutex;
 static QHash<uint64_t, int64_t> logThreadTidHash;
 
-static bool                    logThreadFinished = false;
+static std::atomic<bool>       logThreadFinished {false};
 static bool                    debugRegistration = false;
 
+/// Every thread's LogRing.  Threads only ever push onto the head of the list,
+/// without locking.  Walking the list, popping records and unlinking (and
+/// freeing) rings is done with logRingsMutex held.  If both are needed,
+/// logQueueMutex is taken first.
+static std::atomic<LogRing *>  logRings {nullptr};
+static QMutex                  logRingsMutex;
+
 struct LogPropagateOpts {
     bool    m_propagate;
     int     m_quiet;
     int     m_facility;
     bool    m_dblog;
     QString m_path;
+    int     m_binlog;
 };
 
-LogPropagateOpts        logPropagateOpts {false, 0, 0, true, ""};
+LogPropagateOpts        logPropagateOpts {false, 0, 0, true, "", 0};
 QString                 logPropagateArgs;
 QStringList             logPropagateArgList;
 
@@ -123,6 +132,25 @@ void resetLogging(void)
     verboseInit();
 }
 
+/// \brief Get the thread ID of the calling thread from the OS.
+static int64_t currentThreadTid(void)
+{
+    int64_t tid = 0;
+#if defined(Q_OS_ANDROID)
+    tid = (int64_t)gettid();
+#elif defined(linux)
+    tid = syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+    long lwpid;
+    int dummy = thr_self( &lwpid );
+    (void)dummy;
+    tid = (int64_t)lwpid;
+#elif CONFIG_DARWIN
+    tid = (int64_t)mach_thread_self();
+#endif
+    return tid;
+}
+
 LoggingItem::LoggingItem(const char *_file, const char *_function,
                          int _line, LogLevel_t _level, LoggingType _type) :
         ReferenceCounter("LoggingItem", false),
@@ -134,6 +162,156 @@ LoggingItem::LoggingItem(const char *_file, const char *_function,
     setThreadTid();
 }
 
+LoggingItem::LoggingItem(LogRecord &record) :
+        ReferenceCounter("LoggingItem", false),
+        m_tid(record.m_tid), m_threadId(record.m_threadId),
+        m_mask(record.m_mask), m_line(record.m_line), m_type(record.m_type), m_level(record.m_level),
+        m_epoch(record.m_epoch),
+        m_file(record.m_file), m_function(record.m_function),
+        m_threadName(std::move(record.m_threadName)),
+        m_message(record.m_literal ? QString(record.m_literal)
+                                   : std::move(record.m_message))
+{
+}
+
+/// \brief Queue a record.  Only called by the thread owning the ring.
+/// \return false if the ring is full
+bool LogRing::push(LogRecord &record)
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= kSize)
+        return false;
+    m_records[head & (kSize - 1)] = std::move(record);
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+/// \brief Take the oldest record out.  Only called by the logging thread.
+/// \return false if the ring is empty
+bool LogRing::pop(LogRecord &record)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire))
+        return false;
+    LogRecord &slot = m_records[tail & (kSize - 1)];
+    record = std::move(slot);
+    // Release the strings here rather than in the next LOG() call
+    slot.m_threadName = QString();
+    slot.m_message = QString();
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/// \brief Owns the calling thread's LogRing, and hands it over to the
+///        logging thread when the thread exits.
+class LogRingOwner
+{
+  public:
+    ~LogRingOwner()
+    {
+        if (m_ring)
+            m_ring->m_orphaned.store(true, std::memory_order_release);
+        m_ring = nullptr;
+        m_exited = true;
+    }
+
+    LogRing *ring(void)
+    {
+        if (m_ring || m_exited)
+            return m_ring;
+
+        m_ring = new LogRing;
+        m_ring->m_threadId = (uint64_t)(QThread::currentThreadId());
+        m_ring->m_tid = currentThreadTid();
+        {
+            QMutexLocker locker(&logThreadTidMutex);
+            logThreadTidHash[m_ring->m_threadId] = m_ring->m_tid;
+        }
+
+        LogRing *head = logRings.load(std::memory_order_relaxed);
+        do
+        {
+            m_ring->m_next = head;
+        } while (!logRings.compare_exchange_weak(head, m_ring,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+        return m_ring;
+    }
+
+  private:
+    LogRing *m_ring   {nullptr};
+    bool     m_exited {false};
+};
+
+static thread_local LogRingOwner logRingOwner;
+
+/// \brief Queue a record on the calling thread's ring.  If the ring is full,
+///        the record goes onto the shared queue instead, without waiting.
+///        The logging thread takes everything out of the rings before each
+///        item it takes off the queue, so the older records in the ring are
+///        still handled first.
+/// \return The ring, or nullptr if the record has to go onto the shared queue
+///         instead, because the ring is full, earlier records are still on
+///         the queue, the thread is exiting, or there is no logging thread to
+///         empty the rings any more.
+static LogRing *logRingPush(uint64_t mask, const char *file,
+                            const char *function, int line,
+                            LogLevel_t level, LoggingType type,
+                            QString &message, const char *literal = nullptr,
+                            const QString &threadName = QString())
+{
+    if (logThreadFinished)
+        return nullptr;
+
+    LogRing *ring = logRingOwner.ring();
+    if (!ring)
+        return nullptr;
+
+    if (ring->m_spilled)
+    {
+        // Stay on the queue until the logging thread has taken everything
+        // this thread put there, so the records are handled in order.
+        QMutexLocker qLock(&logQueueMutex);
+        if (!logQueue.isEmpty())
+            return nullptr;
+        ring->m_spilled = false;
+    }
+
+    LogRecord record;
+    record.m_threadId   = ring->m_threadId;
+    record.m_tid        = ring->m_tid;
+    record.m_mask       = mask;
+    record.m_file       = file;
+    record.m_function   = function;
+    record.m_line       = line;
+    record.m_level      = level;
+    record.m_type       = type;
+    record.m_epoch      = nowAsDuration<std::chrono::milliseconds>();
+    record.m_threadName = threadName;
+    record.m_message    = std::move(message);
+    record.m_literal    = literal;
+    if (!ring->push(record))
+    {
+        ring->m_spilled = true;
+        message = std::move(record.m_message);
+        return nullptr;
+    }
+    return ring;
+}
+
+/// \brief Check whether any thread has records waiting in its ring.
+static bool logRingsEmpty(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    for (LogRing *ring = logRings.load(std::memory_order_acquire);
+         ring != nullptr; ring = ring->m_next)
+    {
+        if (!ring->isEmpty())
+            return false;
+    }
+    return true;
+}
+
 QByteArray LoggingItem::toByteArray(void)
 {
     QVariantMap variant = QJsonWrapper::qobject2qvariant(this);
@@ -182,20 +360,7 @@ void LoggingItem::setThreadTid(void)
     m_tid = logThreadTidHash.value(m_threadId, -1);
     if (m_tid == -1)
     {
-        m_tid = 0;
-
-#if defined(Q_OS_ANDROID)
-        m_tid = (int64_t)gettid();
-#elif defined(linux)
-        m_tid = syscall(SYS_gettid);
-#elif defined(__FreeBSD__)
-        long lwpid;
-        int dummy = thr_self( &lwpid );
-        (void)dummy;
-        m_tid = (int64_t)lwpid;
-#elif CONFIG_DARWIN
-        m_tid = (int64_t)mach_thread_self();
-#endif
+        m_tid = currentThreadTid();
         logThreadTidHash[m_threadId] = m_tid;
     }
 }
@@ -222,7 +387,8 @@ char LoggingItem::getLevelChar (void)
 ///        and deregistration if the VERBOSE_THREADS environment variable is
 ///        set.
 LoggerThread::LoggerThread(QString filename, bool progress, bool quiet,
-                           QString table, int facility) :
+                           QString table, int facility,
+                           int64_t binaryLogSize) :
     MThread("Logger"),
     m_waitNotEmpty(new QWaitCondition()),
     m_waitEmpty(new QWaitCondition()),
@@ -236,7 +402,7 @@ LoggerThread::LoggerThread(QString filename, bool progress, bool quiet,
         debugRegistration = true;
     }
 
-    if (!logForwardStart())
+    if (!logForwardStart(binaryLogSize))
     {
         LOG(VB_GENERAL, LOG_ERR,
             "Failed to start LogServer thread");
@@ -271,23 +437,33 @@ void LoggerThread::run(void)
 
     QMutexLocker qLock(&logQueueMutex);
 
-    while (!m_aborted || !logQueue.isEmpty())
+    while (!m_aborted || !logQueue.isEmpty() || !logRingsEmpty())
     {
         qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(nullptr, QEvent::DeferredDelete);
 
+        bool drained = drainRings();
+
         qLock.relock();
         if (logQueue.isEmpty())
         {
-            m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
+            if (!drained)
+            {
+                m_waitEmpty->wakeAll();
+                m_waitNotEmpty->wait(qLock.mutex(), 100);
+            }
             continue;
         }
 
+        // Whatever a thread put in its ring before its ring filled up and
+        // it spilled this item onto the queue goes out first.  Its later
+        // records stay on the queue until this item is off it.
+        collectRings();
         LoggingItem *item = logQueue.dequeue();
         qLock.unlock();
 
+        handleRecords();
         fillItem(item);
         handleItem(item);
         logConsole(item);
@@ -296,12 +472,15 @@ void LoggerThread::run(void)
         qLock.relock();
     }
 
-    qLock.unlock();
-
     // This must be before the timer stop below or we deadlock when the timer
     // thread tries to deregister, and we wait for it.
     logThreadFinished = true;
 
+    // Anything logged while finishing.  From now on LOG() handles messages
+    // itself.
+    handleRemaining(qLock);
+    qLock.unlock();
+
     RunEpilog();
 
     if (dieNow)
@@ -310,6 +489,114 @@ void LoggerThread::run(void)
     }
 }
 
+/// \brief  Handle what is left in the rings and on the queue on the calling
+///         thread, once the logging thread has finished.
+/// \param  qLock   Holds logQueueMutex, released while handling each item
+void LoggerThread::handleRemaining(QMutexLocker &qLock)
+{
+    qLock.unlock();
+    drainRings();
+    qLock.relock();
+
+    while (!logQueue.isEmpty())
+    {
+        LoggingItem *item = logQueue.dequeue();
+        qLock.unlock();
+        fillItem(item);
+        handleItem(item);
+        logConsole(item);
+        item->DecrRef();
+        qLock.relock();
+    }
+}
+
+/// \brief  Empty the rings of all threads, turning the records into
+///         LoggingItems and handling them in the order they were logged.
+/// \return true if anything was handled
+bool LoggerThread::drainRings(void)
+{
+    collectRings();
+    return handleRecords();
+}
+
+/// \brief  Take the records out of the rings of all threads, to be handled
+///         by handleRecords().  Rings of threads that have exited are freed
+///         once empty.  Safe to call with logQueueMutex held.
+void LoggerThread::collectRings(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    LogRing *prev = nullptr;
+    LogRing *ring = logRings.load(std::memory_order_acquire);
+    while (ring)
+    {
+        // Check before popping, so nothing pushed before exiting is missed
+        bool orphaned = ring->m_orphaned.load(std::memory_order_acquire);
+
+        LogRecord record;
+        while (ring->pop(record))
+            m_records.push_back(std::move(record));
+
+        LogRing *next = ring->m_next;
+        if (orphaned)
+        {
+            if (prev)
+            {
+                prev->m_next = next;
+                delete ring;
+                ring = next;
+                continue;
+            }
+            // New rings are pushed onto the head, so only unlink it from
+            // there if no thread got in first.
+            LogRing *expected = ring;
+            if (logRings.compare_exchange_strong(expected, next))
+            {
+                delete ring;
+                ring = next;
+                continue;
+            }
+        }
+        prev = ring;
+        ring = next;
+    }
+}
+
+/// \brief  Handle the records collectRings() took out, in the order they
+///         were logged.
+/// \return true if anything was handled
+bool LoggerThread::handleRecords(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    if (m_records.empty())
+        return false;
+
+    // Only one thread takes records out at a time, but handling them may log
+    std::vector<LogRecord> records;
+    records.swap(m_records);
+    locker.unlock();
+
+    // Each ring is in order already, merge them by time
+    std::stable_sort(records.begin(), records.end(),
+                     [](const LogRecord &a, const LogRecord &b)
+                     { return a.m_epoch < b.m_epoch; });
+
+    for (auto & rec : records)
+    {
+        LoggingItem *item = LoggingItem::create(rec);
+        fillItem(item);
+        handleItem(item);
+        logConsole(item);
+        item->DecrRef();
+    }
+
+    // Hand the space back for next time
+    records.clear();
+    locker.relock();
+    m_records.swap(records);
+
+    return true;
+}
+
 /// \brief  Handles each LoggingItem.  There is a special case for
 ///         thread registration and deregistration which are also included in
 ///         the logging queue to keep the thread names in sync with the log
@@ -493,14 +780,15 @@ bool LoggerThread::flush(int timeoutMS)
 {
     QElapsedTimer t;
     t.start();
-    while (!m_aborted && !logQueue.isEmpty() && !t.hasExpired(timeoutMS))
+    while (!m_aborted && (!logQueue.isEmpty() || !logRingsEmpty()) &&
+           !t.hasExpired(timeoutMS))
     {
         m_waitNotEmpty->wakeAll();
         int left = timeoutMS - t.elapsed();
         if (left > 0)
             m_waitEmpty->wait(&logQueueMutex, left);
     }
-    return logQueue.isEmpty();
+    return logQueue.isEmpty() && logRingsEmpty();
 }
 
 void LoggerThread::fillItem(LoggingItem *item)
@@ -534,6 +822,12 @@ LoggingItem *LoggingItem::create(const char *_file,
     return item;
 }
 
+/// \brief  Create a new LoggingItem from a record taken off a LogRing
+LoggingItem *LoggingItem::create(LogRecord &record)
+{
+    return new LoggingItem(record);
+}
+
 LoggingItem *LoggingItem::create(QByteArray &buf)
 {
     // Deserialize buffer
@@ -548,45 +842,74 @@ LoggingItem *LoggingItem::create(QByteArray &buf)
 
 /// \brief  Format and send a log message into the queue.  This is called from
 ///         the LOG() macro.  The intention is minimal blocking of the caller.
+///         While the logging thread runs, the message goes onto the calling
+///         thread's own ring without locking.  Only when the logging thread
+///         can't take it from there does it go onto the shared, locked,
+///         queue.  Once the logging thread has finished, the message is
+///         handled right here.
 /// \param  mask    Verbosity mask of the message (VB_*)
 /// \param  level   Log level of this message (LOG_* - matching syslog levels)
 /// \param  file    Filename of source code logging the message
 /// \param  line    Line number within the source of log message source
 /// \param  function    Function name of the log message source
-/// \param  message     log message
+/// \param  message     log message, unless it is a literal
+/// \param  literal     log message, if it is a string literal.  It is only
+///                     turned into a QString by the logging thread.
 void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
-                   const char *function, QString message)
+                   const char *function, QString message, const char *literal)
 {
     int type = kMessage;
     type |= (mask & VB_FLUSH) ? kFlush : 0;
     type |= (mask & VB_STDIO) ? kStandardIO : 0;
+
+#if defined( _MSC_VER ) && defined( _DEBUG )
+    OutputDebugStringA( literal ? literal : qPrintable(message) );
+    OutputDebugStringA( "\n" );
+#endif
+
+    LogRing *ring = logRingPush(mask, file, function, line, level,
+                                (LoggingType)type, message, literal);
+    if (ring)
+    {
+        // The logging thread may have finished after the check in
+        // logRingPush(), and before its last look at the rings.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (logThreadFinished)
+        {
+            QMutexLocker qLock(&logQueueMutex);
+            if (logThread)
+                logThread->handleRemaining(qLock);
+            return;
+        }
+
+        // The logging thread polls, so hurry it along before the ring fills
+        if (logThread && ring->size() == LogRing::kSize / 2)
+            logThread->m_waitNotEmpty->wakeAll();
+
+        if (type & kFlush)
+        {
+            QMutexLocker qLock(&logQueueMutex);
+            if (logThread && !logThreadFinished)
+                logThread->flush();
+        }
+        return;
+    }
+
     LoggingItem *item = LoggingItem::create(file, function, line, level,
                                             (LoggingType)type);
     if (!item)
         return;
 
-    item->m_message = std::move(message);
+    item->m_mask = mask;
+    item->m_message = literal ? QString(literal) : std::move(message);
 
     QMutexLocker qLock(&logQueueMutex);
 
-#if defined( _MSC_VER ) && defined( _DEBUG )
-        OutputDebugStringA( qPrintable(item->m_message) );
-        OutputDebugStringA( "\n" );
-#endif
-
     logQueue.enqueue(item);
 
-    if (logThread && logThreadFinished && !logThread->isRunning())
+    if (logThread && logThreadFinished)
     {
-        while (!logQueue.isEmpty())
-        {
-            item = logQueue.dequeue();
-            qLock.unlock();
-            logThread->handleItem(item);
-            logThread->logConsole(item);
-            item->DecrRef();
-            qLock.relock();
-        }
+        logThread->handleRemaining(qLock);
     }
     else if (logThread && !logThreadFinished && (type & kFlush))
     {
@@ -610,6 +933,13 @@ void logPropagateCalc(void)
     {
         logPropagateArgs += " --logpath " + logPropagateOpts.m_path;
         logPropagateArgList << "--logpath" << logPropagateOpts.m_path;
+
+        if (logPropagateOpts.m_binlog > 0)
+        {
+            QString size = QString::number(logPropagateOpts.m_binlog);
+            logPropagateArgs += " --binlog " + size;
+            logPropagateArgList << "--binlog" << size;
+        }
     }
 
     QString name = logLevelGetName(logLevel);
@@ -670,8 +1000,11 @@ bool logPropagateQuiet(void)
 ///                     processes.
 /// \param  testHarness Should always be false. Set to true when
 ///                     invoked by the testing code.
+/// \param  binlog      Size in MB of the binary log to write to logfile
+///                     instead of a text log.  0 for a text log.
 void logStart(const QString& logfile, bool progress, int quiet, int facility,
-              LogLevel_t level, bool dblog, bool propagate, bool testHarness)
+              LogLevel_t level, bool dblog, bool propagate, bool testHarness,
+              int binlog)
 {
     if (logThread && logThread->isRunning())
         return;
@@ -684,6 +1017,7 @@ void logStart(const QString& logfile, bool progress, int quiet, int facility,
     logPropagateOpts.m_quiet = quiet;
     logPropagateOpts.m_facility = facility;
     logPropagateOpts.m_dblog = dblog;
+    logPropagateOpts.m_binlog = binlog;
 
     if (propagate)
     {
@@ -699,7 +1033,10 @@ void logStart(const QString& logfile, bool progress, int quiet, int facility,
     QString table = dblog ? QString("logging") : QString("");
 
     if (!logThread)
-        logThread = new LoggerThread(logfile, progress, quiet, table, facility);
+    {
+        logThread = new LoggerThread(logfile, progress, quiet, table, facility,
+                                     static_cast<int64_t>(binlog) * 1024 * 1024);
+    }
 
     logThread->start();
 }
@@ -725,6 +1062,11 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
+    QString message;
+    if (logRingPush(0, __FILE__, __FUNCTION__, __LINE__, LOG_DEBUG,
+                    kRegistering, message, nullptr, name) != nullptr)
+        return;
+
     QMutexLocker qLock(&logQueueMutex);
 
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
@@ -744,6 +1086,11 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
+    QString message;
+    if (logRingPush(0, __FILE__, __FUNCTION__, __LINE__, LOG_DEBUG,
+                    kDeregistering, message) != nullptr)
+        return;
+
     QMutexLocker qLock(&logQueueMutex);
 
     LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
@@ -824,6 +1171,25 @@ QString logLevelGetName(LogLevel_t level)
     return (*it)->name;
 }
 
+/// \brief  Map a log level enumerated value to the single character used
+///         for it in the logs
+/// \param  level   The LogLevel_t value
+/// \return The character, '-' if the level is not valid
+char logLevelGetShortName(LogLevel_t level)
+{
+    QMutexLocker locker(&loglevelMapMutex);
+    if (!verboseInitialized)
+    {
+        locker.unlock();
+        verboseInit();
+        locker.relock();
+    }
+    LoglevelMap::iterator it = loglevelMap.find((int)level);
+    if (it == loglevelMap.end())
+        return '-';
+    return (*it)->shortname;
+}
+
 /// \brief  Add a verbose level to the verboseMap.  Done at initialization.
 /// \param  mask    verbose mask (VB_*)
 /// \param  name    name of the verbosity level
@@ -7,8 +7,11 @@
 #include <QPointer>
 #include <QCoreApplication>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <vector>
 
 #include "mythconfig.h"
 #include "mythbaseexp.h"  //  MBASE_PUBLIC , etc.
@@ -50,15 +53,66 @@ class LoggerThread;
 
 using tmType = struct tm;
 
+/// \brief A log message as queued by LOG().  This holds only what the
+///        calling thread knows, everything else (strings, thread names,
+///        timestamps) is worked out on the logging thread.
+struct LogRecord
+{
+    qulonglong          m_threadId   {UINT64_MAX};
+    qlonglong           m_tid        {-1};
+    qulonglong          m_mask       {0};
+    const char         *m_file       {nullptr};
+    const char         *m_function   {nullptr};
+    int                 m_line       {0};
+    LogLevel_t          m_level      {LOG_INFO};
+    LoggingType         m_type       {kMessage};
+    std::chrono::milliseconds m_epoch {0ms};
+    QString             m_threadName {};
+    QString             m_message    {};
+    const char         *m_literal    {nullptr}; ///< Message, if a literal
+};
+
+/// \brief Single producer, single consumer ring of LogRecords.  Each thread
+///        that logs gets its own, so LOG() neither locks nor allocates.
+///        Only the logging thread takes records out.
+class LogRing
+{
+  public:
+    static constexpr size_t kSize = 256; // must be a power of two
+
+    bool push(LogRecord &record);
+    bool pop(LogRecord &record);
+    bool isEmpty(void) const { return size() == 0; }
+    size_t size(void) const
+    {
+        return m_head.load(std::memory_order_acquire) -
+               m_tail.load(std::memory_order_acquire);
+    }
+
+    qulonglong          m_threadId {UINT64_MAX};
+    qlonglong           m_tid      {-1};
+    std::atomic<bool>   m_orphaned {false}; ///< Owning thread has exited
+    bool                m_spilled  {false}; ///< Owning thread has records on
+                                            ///  the shared queue.  Only
+                                            ///  used by the owning thread.
+    LogRing            *m_next     {nullptr};
+
+  private:
+    alignas(64) std::atomic<size_t> m_head {0}; ///< Written by the producer
+    alignas(64) std::atomic<size_t> m_tail {0}; ///< Written by the consumer
+    std::array<LogRecord, kSize> m_records;
+};
+
 /// \brief The logging items that are generated by LOG() and are sent to the
 ///        console
-class LoggingItem: public QObject, public ReferenceCounter
+class MBASE_PUBLIC LoggingItem: public QObject, public ReferenceCounter
 {
     Q_OBJECT
 
     Q_PROPERTY(int pid READ pid WRITE setPid)
     Q_PROPERTY(qlonglong tid READ tid WRITE setTid)
     Q_PROPERTY(qulonglong threadId READ threadId WRITE setThreadId)
+    Q_PROPERTY(qulonglong mask READ mask WRITE setMask)
     Q_PROPERTY(int line READ line WRITE setLine)
     Q_PROPERTY(int type READ type WRITE setType)
     Q_PROPERTY(int level READ level WRITE setLevel)
@@ -74,7 +128,8 @@ class LoggingItem: public QObject, public ReferenceCounter
 
     friend class LoggerThread;
     friend void LogPrintLine(uint64_t mask, LogLevel_t level, const char *file, int line,
-                             const char *function, QString message);
+                             const char *function, QString message,
+                             const char *literal);
 
   public:
     QString getThreadName(void);
@@ -83,6 +138,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     static LoggingItem *create(const char *_file, const char *_function, int _line, LogLevel_t _level,
                                LoggingType _type);
     static LoggingItem *create(QByteArray &buf);
+    static LoggingItem *create(LogRecord &record);
     QByteArray toByteArray(void);
     QString getTimestamp(const char *format = "yyyy-MM-dd HH:mm:ss") const;
     QString getTimestampUs(void) const { return getTimestamp("yyyy-MM-dd HH:mm:ss.zzz"); };
@@ -91,6 +147,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     int                 pid() const         { return m_pid; };
     qlonglong           tid() const         { return m_tid; };
     qulonglong          threadId() const    { return m_threadId; };
+    qulonglong          mask() const        { return m_mask; };
     int                 line() const        { return m_line; };
     int                 type() const        { return (int)m_type; };
     int                 level() const       { return (int)m_level; };
@@ -107,6 +164,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     void setPid(const int val)              { m_pid = val; };
     void setTid(const qlonglong val)        { m_tid = val; };
     void setThreadId(const qulonglong val)  { m_threadId = val; };
+    void setMask(const qulonglong val)      { m_mask = val; };
     void setLine(const int val)             { m_line = val; };
     void setType(const int val)             { m_type = (LoggingType)val; };
     void setLevel(const int val)            { m_level = (LogLevel_t)val; };
@@ -124,6 +182,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     int                 m_pid        {-1};
     qlonglong           m_tid        {-1};
     qulonglong          m_threadId   {UINT64_MAX};
+    qulonglong          m_mask       {0};
     int                 m_line       {0};
     LoggingType         m_type       {kMessage};
     LogLevel_t          m_level      {LOG_INFO};
@@ -142,6 +201,7 @@ class LoggingItem: public QObject, public ReferenceCounter
         : ReferenceCounter("LoggingItem", false) {};
     LoggingItem(const char *_file, const char *_function,
                 int _line, LogLevel_t _level, LoggingType _type);
+    explicit LoggingItem(LogRecord &record);
     Q_DISABLE_COPY(LoggingItem);
 };
 
@@ -152,10 +212,11 @@ class LoggerThread : public QObject, public MThread
     Q_OBJECT
 
     friend void LogPrintLine(uint64_t mask, LogLevel_t level, const char *file, int line,
-                             const char *function, QString message);
+                             const char *function, QString message,
+                             const char *literal);
   public:
     LoggerThread(QString filename, bool progress, bool quiet, QString table,
-                 int facility);
+                 int facility, int64_t binaryLogSize = 0);
     ~LoggerThread() override;
     void run(void) override; // MThread
     void stop(void);
@@ -164,6 +225,13 @@ class LoggerThread : public QObject, public MThread
     void fillItem(LoggingItem *item);
   private:
     Q_DISABLE_COPY(LoggerThread);
+    bool drainRings(void);
+    void collectRings(void);
+    bool handleRecords(void);
+    void handleRemaining(QMutexLocker &qLock);
+
+    std::vector<LogRecord> m_records; ///< Records taken out by collectRings().
+                                      ///  Protected by logRingsMutex
     QWaitCondition *m_waitNotEmpty {nullptr};
                                     ///< Condition variable for waiting
                                     ///  for the queue to not be empty
@@ -11,11 +11,14 @@
 #include <QMap>
 #include <QRegExp>
 #include <QSocketNotifier>
+#include <QtEndian>
+#include <algorithm>
 #include <iostream>
 
 #include "mythlogging.h"
 #include "logging.h"
 #include "loggingserver.h"
+#include "binarylog.h"
 #include "mythdb.h"
 #include "mythcorecontext.h"
 #include "dbutil.h"
@@ -37,6 +40,9 @@
 #include <fcntl.h>
 #include <cstdio>
 #include <unistd.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 #if HAVE_GETTIMEOFDAY
 #include <sys/time.h>
 #endif
@@ -58,6 +64,7 @@ static QMutex                      loggerMapMutex;
 static QMap<QString, LoggerBase *> loggerMap;
 
 LogForwardThread                   *logForwardThread = nullptr;
+static int64_t                      logBinaryLogSize = 0;
 
 using LoggerList = QList<LoggerBase *>;
 
@@ -205,6 +212,213 @@ bool FileLogger::logmsg(LoggingItem *item)
 }
 
 #ifndef _WIN32
+/// \brief BinaryLogger constructor
+/// \param filename Filename of the log.  The older half of the log is kept
+///                 in filename.1
+/// \param maxSize  Disk space in bytes to use for both files together
+BinaryLogger::BinaryLogger(const char *filename, int64_t maxSize) :
+        LoggerBase(filename),
+        m_segmentSize(std::clamp<int64_t>(maxSize / 2, 64 * 1024, INT32_MAX))
+{
+    if (open())
+    {
+        LOG(VB_GENERAL, LOG_INFO, QString("Added binary logging to %1 (%2 MB)")
+            .arg(filename).arg(maxSize / (1024 * 1024)));
+    }
+    else
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Unable to log to %1: ")
+            .arg(filename) + ENO);
+    }
+}
+
+/// \brief BinaryLogger deconstructor - close the log
+BinaryLogger::~BinaryLogger()
+{
+    if (m_map)
+    {
+        LOG(VB_GENERAL, LOG_INFO, QString("Removed binary logging to %1")
+            .arg(m_handle));
+    }
+    close();
+}
+
+BinaryLogger *BinaryLogger::create(const QString& filename, int64_t maxSize,
+                                   QMutex *mutex)
+{
+    QByteArray ba = filename.toLocal8Bit();
+    const char *file = ba.constData();
+    auto *logger =
+        qobject_cast<BinaryLogger *>(loggerMap.value(filename, nullptr));
+
+    if (logger)
+        return logger;
+
+    // Need to add a new BinaryLogger
+    mutex->unlock();
+    // inserts into loggerMap
+    logger = new BinaryLogger(file, maxSize);
+    mutex->lock();
+
+    auto *clients = new ClientList;
+    logRevClientMap.insert(logger, clients);
+    return logger;
+}
+
+/// \brief Start a new, empty, log file and write its header.  The space for
+///        the whole file is allocated up front, so running out of disk space
+///        can't fault writing to the mapped file later.
+bool BinaryLogger::open(void)
+{
+    m_strings.clear();
+    m_used = BinaryLog::kHeaderSize;
+
+    m_fd = ::open(qPrintable(m_handle), O_RDWR|O_CREAT|O_TRUNC, 0664);
+    if (m_fd == -1)
+        return false;
+
+#if defined(linux) || defined(__FreeBSD__)
+    bool sized = (posix_fallocate(m_fd, 0, m_segmentSize) == 0);
+#else
+    bool sized = (ftruncate(m_fd, m_segmentSize) == 0);
+#endif
+    void *map = MAP_FAILED;
+    if (sized)
+    {
+        map = mmap(nullptr, m_segmentSize, PROT_READ|PROT_WRITE, MAP_SHARED,
+                   m_fd, 0);
+    }
+    if (map == MAP_FAILED)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_map = static_cast<char *>(map);
+
+    QByteArray appName = QCoreApplication::applicationName().toUtf8()
+        .left(BinaryLog::kAppNameSize);
+    memset(m_map, 0, BinaryLog::kHeaderSize);
+    memcpy(m_map, BinaryLog::kMagic, sizeof(BinaryLog::kMagic));
+    qToLittleEndian<uint32_t>(BinaryLog::kVersion, m_map + 8);
+    qToLittleEndian<uint32_t>(getpid(), m_map + 12);
+    qToLittleEndian<uint64_t>(m_used, m_map + BinaryLog::kUsedOffset);
+    memcpy(m_map + BinaryLog::kAppNameOffset, appName.constData(),
+           appName.size());
+    return true;
+}
+
+/// \brief Unmap the current file, and cut off the part not used.
+void BinaryLogger::close(void)
+{
+    if (m_map)
+    {
+        munmap(m_map, m_segmentSize);
+        m_map = nullptr;
+    }
+    if (m_fd != -1)
+    {
+        if (ftruncate(m_fd, m_used) != 0)
+        {
+            // Only the header knows where the log ends then, that's fine
+        }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+/// \brief Move the current file to filename.1, replacing the older half of
+///        the log, and start a new one.  Also used after a SIGHUP.
+void BinaryLogger::reopen(void)
+{
+    close();
+    QByteArray current = m_handle.toLocal8Bit();
+    QByteArray previous = (m_handle + ".1").toLocal8Bit();
+    rename(current.constData(), previous.constData());
+    open();
+}
+
+/// \brief Get the id of a string, writing its definition at pos the first
+///        time it is used in the current file.
+uint16_t BinaryLogger::stringId(const QString &string, char *&pos)
+{
+    auto it = m_strings.constFind(string);
+    if (it != m_strings.constEnd())
+        return *it;
+
+    auto id = static_cast<uint16_t>(m_strings.size());
+    QByteArray utf8 = string.toUtf8()
+        .left(BinaryLog::kMaxRecordSize - BinaryLog::kStringHeader);
+    int size = BinaryLog::kStringHeader + utf8.size();
+    qToLittleEndian<uint16_t>(size, pos);
+    pos[2] = BinaryLog::kString;
+    pos[3] = 0;
+    qToLittleEndian<uint16_t>(id, pos + 4);
+    memcpy(pos + BinaryLog::kStringHeader, utf8.constData(), utf8.size());
+    pos += size;
+
+    m_strings.insert(string, id);
+    return id;
+}
+
+/// \brief Process a log message, appending it to the mapped log file.
+/// \param item LoggingItem containing the log message to process
+bool BinaryLogger::logmsg(LoggingItem *item)
+{
+    if (!m_map)
+        return false;
+
+    QString thread = item->threadName();
+    QString file = item->file();
+    QString function = item->function();
+    QByteArray message = item->message().toUtf8()
+        .left(BinaryLog::kMaxRecordSize - BinaryLog::kMessageHeader);
+
+    // Room for the message, and for defining all of its strings
+    int64_t needed = BinaryLog::kMessageHeader + message.size();
+    for (const auto & string : { thread, file, function })
+    {
+        if (!m_strings.contains(string))
+        {
+            needed += BinaryLog::kStringHeader +
+                std::min(string.size() * 3,
+                         BinaryLog::kMaxRecordSize - BinaryLog::kStringHeader);
+        }
+    }
+    if (m_used + needed > m_segmentSize ||
+        m_strings.size() + 3 >= BinaryLog::kNoString)
+    {
+        reopen();
+        if (!m_map)
+            return false;
+    }
+
+    char *pos = m_map + m_used;
+    uint16_t threadId = stringId(thread, pos);
+    uint16_t fileId = stringId(file, pos);
+    uint16_t functionId = stringId(function, pos);
+
+    int size = BinaryLog::kMessageHeader + message.size();
+    qToLittleEndian<uint16_t>(size, pos);
+    pos[2] = BinaryLog::kMessage;
+    pos[3] = static_cast<char>(item->level());
+    qToLittleEndian<int64_t>(item->epoch().count(), pos + 4);
+    qToLittleEndian<uint64_t>(item->mask(), pos + 12);
+    qToLittleEndian<uint32_t>(item->tid(), pos + 20);
+    qToLittleEndian<uint32_t>(item->line(), pos + 24);
+    qToLittleEndian<uint16_t>(threadId, pos + 28);
+    qToLittleEndian<uint16_t>(fileId, pos + 30);
+    qToLittleEndian<uint16_t>(functionId, pos + 32);
+    memcpy(pos + BinaryLog::kMessageHeader, message.constData(),
+           message.size());
+    pos += size;
+
+    // Only now is the message part of the log for readers
+    m_used = pos - m_map;
+    qToLittleEndian<uint64_t>(m_used, m_map + BinaryLog::kUsedOffset);
+    return true;
+}
+
 /// \brief SyslogLogger constructor \param facility Syslog facility to
 /// use in logging
 SyslogLogger::SyslogLogger(bool open) :
@@ -779,7 +993,18 @@ void LogForwardThread::forwardMessage(LogMessage *msg)
         QString logfile = item->logFile();
         if (!logfile.isEmpty())
         {
-            LoggerBase *logger = FileLogger::create(logfile, lock2.mutex());
+            LoggerBase *logger = nullptr;
+#ifndef _WIN32
+            if (logBinaryLogSize > 0)
+            {
+                logger = BinaryLogger::create(logfile, logBinaryLogSize,
+                                              lock2.mutex());
+            }
+            else
+#endif
+            {
+                logger = FileLogger::create(logfile, lock2.mutex());
+            }
 
             ClientList *clients = logRevClientMap.value(logger);
 
@@ -863,8 +1088,11 @@ void LogForwardThread::stop(void)
     m_aborted = true;
 }
 
-bool logForwardStart(void)
+/// \param binaryLogSize  Maximum size in bytes of the log file, if it is to be
+///                       written in the binary format.  0 for a text log.
+bool logForwardStart(int64_t binaryLogSize)
 {
+    logBinaryLogSize = binaryLogSize;
     logForwardThread = new LogForwardThread();
     logForwardThread->start();
 
@@ -4,6 +4,7 @@
 #include <QMutexLocker>
 #include <QSocketNotifier>
 #include <QMutex>
+#include <QHash>
 #include <QQueue>
 #include <QElapsedTimer>
 
@@ -60,6 +61,31 @@ class FileLogger : public LoggerBase
 };
 
 #ifndef _WIN32
+/// \brief Logger writing the compact binary format described in binarylog.h
+///        to a memory mapped file.  Not available in Windows.
+class MBASE_PUBLIC BinaryLogger : public LoggerBase
+{
+    Q_OBJECT
+
+  public:
+    BinaryLogger(const char *filename, int64_t maxSize);
+    ~BinaryLogger() override;
+    bool logmsg(LoggingItem *item) override; // LoggerBase
+    void reopen(void) override; // LoggerBase
+    static BinaryLogger *create(const QString& filename, int64_t maxSize,
+                                QMutex *mutex);
+  private:
+    bool open(void);
+    void close(void);
+    uint16_t stringId(const QString &string, char *&pos);
+
+    int64_t  m_segmentSize {0};       ///< size of each of the two files
+    int      m_fd          {-1};      ///< file descriptor of the current file
+    char    *m_map         {nullptr}; ///< current file mapped into memory
+    int64_t  m_used        {0};       ///< bytes used in the current file
+    QHash<QString, uint16_t> m_strings; ///< strings defined in this file
+};
+
 /// \brief Syslog-based logger (not available in Windows)
 class SyslogLogger : public LoggerBase
 {
@@ -149,7 +175,7 @@ class LogForwardThread : public QObject, public MThread
     static void handleSigHup(void);
 };
 
-MBASE_PUBLIC bool logForwardStart(void);
+MBASE_PUBLIC bool logForwardStart(int64_t binaryLogSize = 0);
 MBASE_PUBLIC void logForwardStop(void);
 MBASE_PUBLIC void logForwardMessage(const QList<QByteArray> &msg);
 
@@ -2541,6 +2541,15 @@ void MythCommandLineParser::addLogging(
         "rotators, using the HUP call to inform MythTV to reload the "
         "file", "")
                 ->SetGroup("Logging");
+    add("--binlog", "binlog", 0,
+        "Write the log file in the --logpath directory in a compact binary "
+        "format, using at most this many MB of disk space.",
+        "The binary log is written to applicationName.date.pid.mlog, with "
+        "the older half of it kept in a file with '.1' appended. It can be "
+        "read back with 'mythutil --decodelog'. This allows logging at high "
+        "verbosity without filling the disk.")
+                ->SetChildOf("logpath")
+                ->SetGroup("Logging");
     add(QStringList{"-q", "--quiet"}, "quiet", 0,
         "Don't log to the console (-q).  Don't log anywhere (-q -q)", "")
                 ->SetGroup("Logging");
@@ -2770,10 +2779,18 @@ int MythCommandLineParser::ConfigureLogging(const QString& mask, bool progress)
     QString logfile = GetLogFilePath();
     bool propagate = !logfile.isEmpty();
 
+    int binlog = toInt("binlog");
+    if (binlog > 0 && !logfile.isEmpty())
+    {
+        logfile.chop(QString(".log").size());
+        logfile += ".mlog";
+    }
+
     if (toBool("daemon"))
         quiet = std::max(quiet, 1);
 
-    logStart(logfile, progress, quiet, facility, level, dblog, propagate);
+    logStart(logfile, progress, quiet, facility, level, dblog, propagate,
+             false, binlog);
     qInstallMessageHandler([](QtMsgType /*unused*/, const QMessageLogContext& /*unused*/, const QString &Msg)
         { LOG(VB_GENERAL, LOG_INFO, "Qt: " + Msg); });
 
@@ -3,6 +3,9 @@
 // ANSI C
 #include <cstdlib>
 
+// C++
+#include <algorithm>
+
 // Qt
 #include <QCoreApplication>
 #include <QElapsedTimer>
@@ -33,6 +36,15 @@
 #endif
 
 static constexpr std::chrono::seconds kPurgeTimeout { 1h };
+// Prepared statements kept per connection for reuse
+static constexpr int kStatementCacheSize { 32 };
+// Idle connections kept per thread, the rest are closed when returned
+static constexpr int kMaxIdleConnections { 4 };
+// Distinct statements tracked by MSqlQuery::GetQueryStats()
+static constexpr int kMaxQueryStats { 500 };
+
+static QMutex                         s_queryStatsLock;
+static QHash<QString, MSqlQueryStats> s_queryStats;
 
 bool TestDatabase(const QString& dbHostName,
                   const QString& dbUserName,
@@ -72,17 +84,17 @@ bool TestDatabase(const QString& dbHostName,
     return ret;
 }
 
-MSqlDatabase::MSqlDatabase(QString name)
+MSqlDatabase::MSqlDatabase(QString name, const QString &driver)
     : m_name(std::move(name))
 {
-    if (!QSqlDatabase::isDriverAvailable("QMYSQL"))
+    if (!QSqlDatabase::isDriverAvailable(driver))
     {
-        LOG(VB_FLUSH, LOG_CRIT, "FATAL: Unable to load the QT mysql driver, is it installed?");
+        LOG(VB_FLUSH, LOG_CRIT, QString("FATAL: Unable to load the QT %1 driver, is it installed?").arg(driver));
         exit(GENERIC_EXIT_DB_ERROR); // Exits before we can process the log queue
         //return;
     }
 
-    m_db = QSqlDatabase::addDatabase("QMYSQL", m_name);
+    m_db = QSqlDatabase::addDatabase(driver, m_name);
     LOG(VB_DATABASE, LOG_INFO, "Database object created: " + m_name);
 
     if (!m_db.isValid() || m_db.isOpenError())
@@ -97,6 +109,8 @@ MSqlDatabase::MSqlDatabase(QString name)
 
 MSqlDatabase::~MSqlDatabase()
 {
+    ClearStatements();
+
     if (m_db.isOpen())
     {
         m_db.close();
@@ -244,13 +258,17 @@ bool MSqlDatabase::KickDatabase(void)
     m_lastDBKick = MythDate::current().addSecs(-60);
 
     if (!m_db.isOpen())
+    {
+        ClearStatements();
         m_db.open();
+    }
 
     return m_db.isOpen();
 }
 
 bool MSqlDatabase::Reconnect()
 {
+    ClearStatements();
     m_db.close();
     m_db.open();
 
@@ -272,6 +290,76 @@ void MSqlDatabase::InitSessionVars()
     m_db.exec("SET @@session.sql_mode=''");
 }
 
+/**
+ *  \brief Look up a statement previously prepared on this connection.
+ *
+ *  The statement is marked as in use until ReleaseStatement() is called
+ *  with the returned id, so that nested queries on the same connection
+ *  never share a result set.
+ *
+ *  \return the cached statement, or nullptr if there is no free one
+ */
+const QSqlQuery *MSqlDatabase::TakeStatement(const QString &query,
+                                             uint64_t &id)
+{
+    auto it = m_statementIndex.find(query);
+    if (it == m_statementIndex.end() || (*it)->m_inUse)
+        return nullptr;
+
+    // Move to the front, it is now the most recently used
+    m_statements.splice(m_statements.begin(), m_statements, *it);
+    (*it)->m_inUse = true;
+    id = (*it)->m_id;
+    return &(*it)->m_statement;
+}
+
+/**
+ *  \brief Keep a newly prepared statement for reuse, evicting the least
+ *         recently used statement that is not in use if the cache is full.
+ *  \return the id to pass to ReleaseStatement(), 0 if it wasn't cached
+ */
+uint64_t MSqlDatabase::StoreStatement(const QString &query,
+                                      const QSqlQuery &statement)
+{
+    if (m_statementIndex.contains(query))
+        return 0;
+
+    if (m_statements.size() >= static_cast<size_t>(kStatementCacheSize))
+    {
+        auto victim = std::find_if(m_statements.rbegin(), m_statements.rend(),
+            [](const CachedStatement &entry) { return !entry.m_inUse; });
+        if (victim == m_statements.rend())
+            return 0;
+        m_statementIndex.remove(victim->m_query);
+        m_statementIds.remove(victim->m_id);
+        m_statements.erase(std::next(victim).base());
+    }
+
+    uint64_t id = m_nextStatementId++;
+    m_statements.push_front({query, statement, id, true});
+    m_statementIndex.insert(query, m_statements.begin());
+    m_statementIds.insert(id, m_statements.begin());
+    return id;
+}
+
+void MSqlDatabase::ReleaseStatement(uint64_t id)
+{
+    auto it = m_statementIds.find(id);
+    if (it == m_statementIds.end())
+        return;
+    (*it)->m_statement.finish();
+    (*it)->m_inUse = false;
+}
+
+/// \brief Forget all cached statements, they are only valid as long as
+///        the connection stays open.
+void MSqlDatabase::ClearStatements(void)
+{
+    m_statementIds.clear();
+    m_statementIndex.clear();
+    m_statements.clear();
+}
+
 // -----------------------------------------------------------------------
 
 
@@ -323,8 +411,10 @@ MSqlDatabase *MDBManager::popConnection(bool reuse)
     }
     else
     {
-        db = list.back();
-        list.pop_back();
+        // Take the most recently used connection, it is the most likely
+        // to still be open and to have the statements we need prepared.
+        db = list.front();
+        list.pop_front();
     }
 
 #if REUSE_CONNECTION
@@ -359,14 +449,32 @@ void MDBManager::pushConnection(MSqlDatabase *db)
     }
 #endif
 
+    // Closing a connection may take a while, do it after unlocking
+    DBList surplus;
     if (db)
     {
         db->m_lastDBKick = MythDate::current();
-        m_pool[QThread::currentThread()].push_front(db);
+        DBList &list = m_pool[QThread::currentThread()];
+        list.push_front(db);
+
+        while (list.size() > kMaxIdleConnections)
+        {
+            surplus.push_back(list.takeLast());
+            --m_connCount;
+        }
     }
+    int connCount = m_connCount;
 
     m_lock.unlock();
 
+    for (MSqlDatabase *entry : qAsConst(surplus))
+    {
+        LOG(VB_DATABASE, LOG_INFO,
+            QString("Closing surplus idle DB connection, total: %1")
+            .arg(connCount));
+        delete entry;
+    }
+
     PurgeIdleConnections(true);
 }
 
@@ -476,6 +584,7 @@ void MDBManager::CloseDatabases()
     {
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + conn->m_name + "'");
+        conn->ClearStatements();
         conn->m_db.close();
         delete conn;
         m_connCount--;
@@ -488,6 +597,7 @@ void MDBManager::CloseDatabases()
         MSqlDatabase *db = slist.takeFirst();
         LOG(VB_DATABASE, LOG_INFO,
             "Closing DB connection named '" + db->m_name + "'");
+        db->ClearStatements();
         db->m_db.close();
         delete db;
 
@@ -521,6 +631,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
 
 MSqlQuery::~MSqlQuery()
 {
+    releaseStatement();
+
     if (m_returnConnection)
     {
         MDBManager *dbmanager = GetMythDB()->GetDBManager();
@@ -636,7 +748,7 @@ bool MSqlQuery::exec()
     timer.start();
 
     bool result = QSqlQuery::exec();
-    qint64 elapsed = timer.elapsed();
+    qint64 elapsed = timer.nsecsElapsed();
 
     // if the query failed with "MySQL server has gone away"
     // Close and reopen the database connection and retry the query if it
@@ -667,7 +779,7 @@ bool MSqlQuery::exec()
             bindValues(tmp);
             timer.restart();
             result = QSqlQuery::exec();
-            elapsed = timer.elapsed();
+            elapsed = timer.nsecsElapsed();
         }
         if (result)
         {
@@ -678,6 +790,11 @@ bool MSqlQuery::exec()
         }
     }
 
+    // The statement as prepared, with the placeholders rather than values
+    QString statement = lastQuery();
+    recordQueryStats(statement.isEmpty() ? m_lastPreparedQuery : statement,
+                     elapsed);
+
     if (VERBOSE_LEVEL_CHECK(VB_DATABASE, LOG_INFO))
     {
         QString str = lastQuery();
@@ -700,7 +817,7 @@ bool MSqlQuery::exec()
             LOG(VB_DATABASE, LOG_INFO,
                 QString("MSqlQuery::exec(%1) %2%3%4")
                         .arg(m_db->MSqlDatabase::GetConnectionName()).arg(str)
-                        .arg(QString(" <<<< Took %1ms").arg(QString::number(elapsed)))
+                        .arg(QString(" <<<< Took %1ms").arg(QString::number(elapsed / 1000000)))
                         .arg(isSelect() ? QString(", Returned %1 row(s)")
                                               .arg(size()) : QString()));
         }
@@ -725,6 +842,12 @@ bool MSqlQuery::exec(const QString &query)
         return false;
     }
 
+    // The statement is replaced, give back the cached one
+    releaseStatement();
+
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = QSqlQuery::exec(query);
 
     // if the query failed with "MySQL server has gone away"
@@ -735,6 +858,8 @@ bool MSqlQuery::exec(const QString &query)
         && Reconnect())
         result = QSqlQuery::exec(query);
 
+    recordQueryStats(query, timer.nsecsElapsed());
+
     LOG(VB_DATABASE, LOG_INFO,
             QString("MSqlQuery::exec(%1) %2%3")
                     .arg(m_db->MSqlDatabase::GetConnectionName()).arg(query)
@@ -813,6 +938,7 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    releaseStatement();
     m_lastPreparedQuery = query;
 
     if (!m_db->isOpen() && !Reconnect())
@@ -821,6 +947,24 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    // Statements with placeholders are usually run over and over again,
+    // reuse the one already prepared on this connection if there is one.
+    // QSqlQuery is implicitly shared, so this is only a reference.
+    bool cacheable = query.contains(':') || query.contains('?');
+    if (cacheable)
+    {
+        const QSqlQuery *cached = m_db->TakeStatement(query, m_statementId);
+        if (cached)
+        {
+            QSqlQuery::operator=(*cached);
+            // Don't let values bound by its last user leak into this query
+            MSqlBindings stale = QSqlQuery::boundValues();
+            for (auto it = stale.cbegin(); it != stale.cend(); ++it)
+                QSqlQuery::bindValue(it.key(), QVariant(), QSql::In);
+            return true;
+        }
+    }
+
     // QT docs indicate that there are significant speed ups and a reduction
     // in memory usage by enabling forward-only cursors
     //
@@ -829,6 +973,8 @@ bool MSqlQuery::prepare(const QString& query)
     setForwardOnly(true);
 
     bool ok = QSqlQuery::prepare(query);
+    if (ok && cacheable)
+        m_statementId = m_db->StoreStatement(query, *this);
 
     // if the prepare failed with "MySQL server has gone away"
     // Close and reopen the database connection and retry the query if it
@@ -892,6 +1038,8 @@ QVariant MSqlQuery::lastInsertId()
 
 bool MSqlQuery::Reconnect(void)
 {
+    // Reconnecting drops all statements cached on the connection
+    m_statementId = 0;
     if (!m_db->Reconnect())
         return false;
     if (!m_lastPreparedQuery.isEmpty())
@@ -904,6 +1052,59 @@ bool MSqlQuery::Reconnect(void)
     return true;
 }
 
+/// \brief Give the cached statement borrowed by prepare() back to the
+///        connection.  This is only called right before the statement is
+///        replaced or destroyed.  QSqlQuery::prepare() and
+///        QSqlQuery::exec(QString) stop sharing it with the cache themselves.
+void MSqlQuery::releaseStatement(void)
+{
+    if (!m_statementId)
+        return;
+    if (m_db)
+        m_db->ReleaseStatement(m_statementId);
+    m_statementId = 0;
+}
+
+void MSqlQuery::recordQueryStats(const QString &query, qint64 nsecs)
+{
+    auto elapsed = std::chrono::microseconds(nsecs / 1000);
+
+    QMutexLocker locker(&s_queryStatsLock);
+    auto it = s_queryStats.find(query);
+    if (it == s_queryStats.end())
+    {
+        // Don't let statements with literal values grow this without bound
+        QString key = (s_queryStats.size() < kMaxQueryStats) ? query : "(other)";
+        it = s_queryStats.find(key);
+        if (it == s_queryStats.end())
+        {
+            it = s_queryStats.insert(key, MSqlQueryStats());
+            it->m_query = key;
+        }
+    }
+    it->m_count++;
+    it->m_total += elapsed;
+    it->m_max = std::max(it->m_max, elapsed);
+}
+
+QList<MSqlQueryStats> MSqlQuery::GetQueryStats(void)
+{
+    s_queryStatsLock.lock();
+    QList<MSqlQueryStats> stats = s_queryStats.values();
+    s_queryStatsLock.unlock();
+
+    std::sort(stats.begin(), stats.end(),
+              [](const MSqlQueryStats &a, const MSqlQueryStats &b)
+              { return a.m_total > b.m_total; });
+    return stats;
+}
+
+void MSqlQuery::ResetQueryStats(void)
+{
+    QMutexLocker locker(&s_queryStatsLock);
+    s_queryStats.clear();
+}
+
 void MSqlAddMoreBindings(MSqlBindings &output, MSqlBindings &addfrom)
 {
     MSqlBindings::Iterator it;
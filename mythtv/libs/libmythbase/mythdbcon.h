@@ -11,8 +11,11 @@
 #include <QMutex>
 #include <QList>
 
+#include <list>
+
 #include "mythbaseexp.h"
 #include "mythdbparams.h"
+#include "mythchrono.h"
 
 #define REUSE_CONNECTION 1
 
@@ -23,12 +26,13 @@ MBASE_PUBLIC bool TestDatabase(const QString& dbHostName,
                                int     dbPort = 3306);
 
 /// \brief QSqlDatabase wrapper, used by MSqlQuery. Do not use directly.
-class MSqlDatabase
+class MBASE_PUBLIC MSqlDatabase
 {
   friend class MDBManager;
   friend class MSqlQuery;
+  friend class TestMythDBCon;
   public:
-    explicit MSqlDatabase(QString name);
+    explicit MSqlDatabase(QString name, const QString &driver = "QMYSQL");
    ~MSqlDatabase(void);
 
     bool OpenDatabase(bool skipdb = false);
@@ -42,17 +46,47 @@ class MSqlDatabase
     bool Reconnect(void);
     void InitSessionVars(void);
 
+    const QSqlQuery *TakeStatement(const QString &query, uint64_t &id);
+    uint64_t StoreStatement(const QString &query, const QSqlQuery &statement);
+    void ReleaseStatement(uint64_t id);
+    void ClearStatements(void);
+
   private:
     QString m_name;
     QSqlDatabase m_db;
     QDateTime m_lastDBKick;
     DatabaseParams m_dbparms;
+
+    /// A statement prepared on this connection, kept for reuse
+    struct CachedStatement
+    {
+        QString   m_query;
+        QSqlQuery m_statement;
+        uint64_t  m_id    {0};
+        bool      m_inUse {false};
+    };
+    using StatementList = std::list<CachedStatement>;
+    StatementList m_statements;  ///< most recently used first
+    QHash<QString, StatementList::iterator> m_statementIndex;
+    QHash<uint64_t, StatementList::iterator> m_statementIds;
+    uint64_t m_nextStatementId {1};
+};
+
+/// \brief Execution statistics of one SQL statement,
+///        see MSqlQuery::GetQueryStats()
+struct MSqlQueryStats
+{
+    QString                   m_query;
+    uint64_t                  m_count {0};
+    std::chrono::microseconds m_total {0us};
+    std::chrono::microseconds m_max   {0us};
 };
 
 /// \brief DB connection pool, used by MSqlQuery. Do not use directly.
 class MBASE_PUBLIC MDBManager
 {
   friend class MSqlQuery;
+  friend class TestMythDBCon;
   public:
     MDBManager(void) = default;
     ~MDBManager(void);
@@ -226,7 +260,17 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     /// \brief Returns dedicated connection. (Required for using temporary SQL tables.)
     static MSqlQueryInfo ChannelCon();
 
+    /// \brief Returns the execution statistics of all statements run by
+    ///        this process, slowest in total first
+    static QList<MSqlQueryStats> GetQueryStats(void);
+
+    /// \brief Forget the execution statistics collected so far
+    static void ResetQueryStats(void);
+
   private:
+    void releaseStatement(void);
+    static void recordQueryStats(const QString &query, qint64 nsecs);
+
     // Only QSql::In is supported as a param type and only named params...
     void bindValue(const QString&, const QVariant&, QSql::ParamType);
     void bindValue(int, const QVariant&, QSql::ParamType);
@@ -239,6 +283,7 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     bool          m_isConnected      {false};
     bool          m_returnConnection {false};
     QString       m_lastPreparedQuery; // holds a copy of the last prepared query
+    uint64_t      m_statementId      {0}; // cached statement in use, if any
 };
 
 #endif
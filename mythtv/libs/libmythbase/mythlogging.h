@@ -9,32 +9,51 @@
 #include "mythbaseexp.h"  //  MBASE_PUBLIC , etc.
 #include "verbosedefs.h"
 
-// Helper for checking verbose mask & level outside of LOG macro
+// Helper for checking verbose mask & level outside of LOG macro.  Per
+// component log levels are rarely used, so only look them up when set.
 #define VERBOSE_LEVEL_NONE        (verboseMask == 0)
 #define VERBOSE_LEVEL_CHECK(_MASK_, _LEVEL_) \
-    (componentLogLevel.contains(_MASK_) ?                               \
+    ((!componentLogLevel.isEmpty() && componentLogLevel.contains(_MASK_)) ? \
      (*(componentLogLevel.find(_MASK_)) >= (_LEVEL_)) :                   \
      (((verboseMask & (_MASK_)) == (_MASK_)) && logLevel >= (_LEVEL_)))
 
 #define VERBOSE please_use_LOG_instead_of_VERBOSE
 
-// This doesn't lock the calling thread other than momentarily to put
-// the log message onto a queue.
+// Whether a LOG() message is a string literal.  Those are only turned into
+// a QString by the logging thread.  Anything else, e.g. QString().arg(),
+// is still formatted by the caller.
+#if defined(__GNUC__) || defined(__clang__)
+#define LOG_IS_LITERAL(_STRING_) __builtin_constant_p(_STRING_)
+#else
+#define LOG_IS_LITERAL(_STRING_) false
+#endif
+
+// This doesn't lock the calling thread.  The log message is put onto a
+// ring of the calling thread, and handled by the logging thread.
 #define LOG(_MASK_, _LEVEL_, _QSTRING_)                                 \
     do {                                                                \
         if (VERBOSE_LEVEL_CHECK((_MASK_), (_LEVEL_)) && ((_LEVEL_)>=0)) \
         {                                                               \
             LogPrintLine(_MASK_, _LEVEL_,                               \
                          __FILE__, __LINE__, __FUNCTION__,              \
-                         _QSTRING_);                                    \
+                         LOG_IS_LITERAL(_QSTRING_) ?                    \
+                             QString() : QString(_QSTRING_),            \
+                         LOG_IS_LITERAL(_QSTRING_) ?                    \
+                             logLiteral(_QSTRING_) : nullptr);          \
         }                                                               \
     } while (false)
 
+/// The literal passed to LOG(), or nullptr if it wasn't one
+inline const char *logLiteral(const char *message) { return message; }
+template <typename T>
+inline const char *logLiteral(const T &/*message*/) { return nullptr; }
+
 /* Define the external prototype */
 MBASE_PUBLIC void LogPrintLine( uint64_t mask, LogLevel_t level,
                                 const char *file, int line,
                                 const char *function,
-                                QString message);
+                                QString message,
+                                const char *literal = nullptr);
 
 extern MBASE_PUBLIC LogLevel_t logLevel;
 extern MBASE_PUBLIC uint64_t   verboseMask;
@@ -51,7 +70,7 @@ MBASE_PUBLIC void logStart(const QString& logfile, bool progress = false,
                            int quiet = 0,
                            int facility = 0, LogLevel_t level = LOG_INFO,
                            bool dblog = true, bool propagate = false,
-                           bool testHarness = false);
+                           bool testHarness = false, int binlog = 0);
 MBASE_PUBLIC void logStop(void);
 MBASE_PUBLIC void logPropagateCalc(void);
 MBASE_PUBLIC bool logPropagateQuiet(void);
@@ -59,6 +78,7 @@ MBASE_PUBLIC bool logPropagateQuiet(void);
 MBASE_PUBLIC int  syslogGetFacility(const QString& facility);
 MBASE_PUBLIC LogLevel_t logLevelGet(const QString& level);
 MBASE_PUBLIC QString logLevelGetName(LogLevel_t level);
+MBASE_PUBLIC char logLevelGetShortName(LogLevel_t level);
 MBASE_PUBLIC int verboseArgParse(const QString& arg);
 
 /// Verbose helper function for ENO macro
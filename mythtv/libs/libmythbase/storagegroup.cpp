@@ -3,6 +3,7 @@
 #include <QUrl>
 
 #include "storagegroup.h"
+#include "storagegroupcache.h"
 #include "mythcorecontext.h"
 #include "mythdb.h"
 #include "mythlogging.h"
@@ -626,16 +627,15 @@ QString StorageGroup::FindFileDir(const QString &filename)
 {
     QString result = "";
     QFileInfo checkFile("");
+    StorageGroupCache *cache = StorageGroupCache::GetInstance();
 
     int curDir = 0;
     while (curDir < m_dirlist.size())
     {
-        QString testFile = m_dirlist[curDir] + "/" + filename;
         LOG(VB_FILE, LOG_DEBUG, LOC +
             QString("FindFileDir: Checking '%1' for '%2'")
-                .arg(m_dirlist[curDir]).arg(testFile));
-        checkFile.setFile(testFile);
-        if (checkFile.exists() || checkFile.isSymLink())
+                .arg(m_dirlist[curDir]).arg(filename));
+        if (cache->FileExists(m_dirlist[curDir], filename))
             return m_dirlist[curDir];
 
         curDir++;
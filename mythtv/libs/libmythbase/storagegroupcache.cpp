@@ -0,0 +1,383 @@
+// POSIX headers
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+// C++ headers
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <iterator>
+
+// Qt headers
+#include <QDir>
+#include <QFileInfo>
+#include <QRunnable>
+
+// MythTV headers
+#include "storagegroupcache.h"
+#include "mthreadpool.h"
+#include "mythlogging.h"
+
+#define LOC QString("SGCache: ")
+
+/// Unwatched directories are listed again after this long
+static constexpr std::chrono::milliseconds kRescanInterval { 5min };
+
+/// Files not found in unwatched directories are remembered this long
+static constexpr std::chrono::milliseconds kMissingTimeout { 5s };
+
+/// Prune expired missing files when there are more than this many
+static constexpr int kMaxMissing { 1000 };
+
+static std::chrono::milliseconds steady_now(void)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+}
+
+/// \brief Lists one directory on the global thread pool.
+class StorageGroupCacheScanner : public QRunnable
+{
+  public:
+    StorageGroupCacheScanner(StorageGroupCache *cache, QString dir)
+        : m_cache(cache), m_dir(std::move(dir)) {}
+
+    void run(void) override // QRunnable
+    {
+        m_cache->Scan(m_dir);
+    }
+
+  private:
+    StorageGroupCache *m_cache {nullptr};
+    QString            m_dir;
+};
+
+StorageGroupCache *StorageGroupCache::GetInstance(void)
+{
+    // Never deleted, lookups may still be running on other threads at exit
+    static auto *s_instance = new StorageGroupCache();
+    return s_instance;
+}
+
+StorageGroupCache::StorageGroupCache()
+{
+#ifdef __linux__
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd < 0)
+    {
+        LOG(VB_FILE, LOG_WARNING, LOC +
+            "inotify unavailable, storage directories will be rescanned" +
+            ENO);
+    }
+#endif
+}
+
+StorageGroupCache::~StorageGroupCache()
+{
+#ifdef __linux__
+    if (m_inotifyFd >= 0)
+        close(m_inotifyFd);
+#endif
+}
+
+bool StorageGroupCache::Stat(const QString &path)
+{
+    QFileInfo checkFile(path);
+    return checkFile.exists() || checkFile.isSymLink();
+}
+
+/**
+ *  \brief Checks whether filename exists in dir, the same way
+ *         StorageGroup::FindFileDir() always did.
+ */
+bool StorageGroupCache::FileExists(const QString &dir, const QString &filename)
+{
+    QString path = dir + "/" + filename;
+    if (filename.contains('/'))
+    {
+        m_misses++;
+        return Stat(path);
+    }
+
+    {
+        QMutexLocker locker(&m_lock);
+        ReadEvents();
+
+        DirIndex &index = m_dirs[dir];
+        if (!index.m_ready)
+        {
+            StartScan(dir, index);
+        }
+        else if (index.m_files.contains(filename))
+        {
+            m_hits++;
+            return true;
+        }
+        else if (index.m_trusted)
+        {
+            m_negativeHits++;
+            return false;
+        }
+        else
+        {
+            if (steady_now() - index.m_scanned > kRescanInterval)
+                StartScan(dir, index);
+
+            auto missing = index.m_missing.constFind(filename);
+            if (missing != index.m_missing.constEnd() &&
+                *missing > steady_now())
+            {
+                m_negativeHits++;
+                return false;
+            }
+        }
+    }
+
+    // Don't hold the lock while a network file system takes its time
+    m_misses++;
+    bool exists = Stat(path);
+
+    QMutexLocker locker(&m_lock);
+    auto it = m_dirs.find(dir);
+    if (it == m_dirs.end() || !it->m_ready || it->m_trusted)
+        return exists;
+
+    if (exists)
+    {
+        it->m_files.insert(filename);
+        it->m_missing.remove(filename);
+        return true;
+    }
+
+    if (it->m_missing.size() > kMaxMissing)
+    {
+        std::chrono::milliseconds now = steady_now();
+        for (auto m = it->m_missing.begin(); m != it->m_missing.end(); )
+            m = (*m <= now) ? it->m_missing.erase(m) : std::next(m);
+    }
+    it->m_missing.insert(filename, steady_now() + kMissingTimeout);
+    return false;
+}
+
+/// \brief Returns true once dir has been listed, mainly for the tests.
+bool StorageGroupCache::IsIndexed(const QString &dir)
+{
+    QMutexLocker locker(&m_lock);
+    auto it = m_dirs.constFind(dir);
+    return it != m_dirs.constEnd() && it->m_ready;
+}
+
+StorageGroupCacheStats StorageGroupCache::GetStats(void) const
+{
+    StorageGroupCacheStats stats;
+    stats.m_hits         = m_hits;
+    stats.m_negativeHits = m_negativeHits;
+    stats.m_misses       = m_misses;
+    stats.m_rescans      = m_rescans;
+    return stats;
+}
+
+/// \brief Starts listing dir in the background. Must be called with
+///        m_lock held.
+void StorageGroupCache::StartScan(const QString &dir, DirIndex &index)
+{
+    if (index.m_scanning)
+        return;
+    index.m_scanning = true;
+    index.m_pending.clear();
+
+    MThreadPool::globalInstance()->start(
+        new StorageGroupCacheScanner(this, dir), "SGCacheScan");
+}
+
+/**
+ *  \brief Lists dir and replaces its index.
+ *
+ *   The inotify watch is added before the directory is read, so no change
+ *   is missed.  Changes seen while reading are applied again afterwards.
+ */
+void StorageGroupCache::Scan(const QString &dir)
+{
+    bool trusted = false;
+    int watch = -1;
+
+#ifdef __linux__
+    // Changes made by other hosts are not reported on these
+    static constexpr std::array<long, 8> kRemoteFS {
+        0x6969,                         // NFS
+        0x517B,                         // SMB
+        static_cast<long>(0xFF534D42),  // CIFS
+        static_cast<long>(0xFE534D42),  // SMB2
+        0x65735546,                     // FUSE
+        0x73757245,                     // CODA
+        0x5346414F,                     // AFS
+        0x00C36400,                     // CEPH
+    };
+
+    struct statfs sfs {};
+    QByteArray path = dir.toLocal8Bit();
+    bool remote = true;
+    if (statfs(path.constData(), &sfs) == 0)
+    {
+        remote = std::find(kRemoteFS.cbegin(), kRemoteFS.cend(),
+                           static_cast<long>(sfs.f_type)) != kRemoteFS.cend();
+    }
+
+    if (m_inotifyFd >= 0)
+    {
+        QMutexLocker locker(&m_lock);
+        auto it = m_dirs.find(dir);
+        if (it != m_dirs.end() && it->m_watch >= 0)
+        {
+            watch = it->m_watch;
+        }
+        else
+        {
+            watch = inotify_add_watch(m_inotifyFd, path.constData(),
+                                      IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                      IN_MOVED_TO | IN_DELETE_SELF |
+                                      IN_MOVE_SELF | IN_ONLYDIR);
+            if (watch >= 0)
+                m_watches[watch] = dir;
+        }
+    }
+    trusted = (watch >= 0) && !remote;
+#endif
+
+    QDir qdir(dir);
+    QStringList entries = qdir.entryList(QDir::AllEntries | QDir::Hidden |
+                                         QDir::System | QDir::NoDotAndDotDot);
+    m_rescans++;
+
+    QMutexLocker locker(&m_lock);
+    DirIndex &index = m_dirs[dir];
+    index.m_files.clear();
+    index.m_files.reserve(entries.size());
+    for (const auto &entry : qAsConst(entries))
+        index.m_files.insert(entry);
+    index.m_missing.clear();
+    index.m_watch = watch;
+    index.m_trusted = trusted;
+    index.m_scanned = steady_now();
+
+    // Replay everything seen since the watch was added, in order
+    ReadEvents();
+    QList<QPair<QString, bool> > pending;
+    pending.swap(index.m_pending);
+    index.m_scanning = false;
+    for (const auto &change : qAsConst(pending))
+        ApplyChange(dir, change.first, change.second);
+    index.m_ready = true;
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Indexed %1 files in '%2'%3")
+            .arg(index.m_files.size()).arg(dir)
+            .arg(trusted ? "" : ", not watched"));
+}
+
+/**
+ *  \brief Applies the changes inotify has queued. Must be called with
+ *         m_lock held.
+ *
+ *   The kernel queues the event before the call that changed the directory
+ *   returns, so reading the queue here before answering a lookup means
+ *   that even a file created a moment ago is found.
+ */
+void StorageGroupCache::ReadEvents(void)
+{
+#ifdef __linux__
+    if (m_inotifyFd < 0)
+        return;
+
+    alignas(struct inotify_event) std::array<char, 4096> buffer {};
+    while (true)
+    {
+        ssize_t len = read(m_inotifyFd, buffer.data(), buffer.size());
+        if (len <= 0)
+            break;
+
+        for (ssize_t pos = 0; pos < len; )
+        {
+            const auto *event =
+                reinterpret_cast<const struct inotify_event *>(&buffer[pos]);
+            pos += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                LOG(VB_FILE, LOG_WARNING, LOC +
+                    "inotify queue overflowed, rescanning all directories");
+                for (auto &index : m_dirs)
+                    index.m_ready = false;
+                continue;
+            }
+
+            auto watch = m_watches.constFind(event->wd);
+            if (watch == m_watches.constEnd())
+                continue;
+            QString dir = *watch;
+
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+            {
+                // The directory itself is gone, list it again if it is used
+                auto it = m_dirs.find(dir);
+                if (it != m_dirs.end())
+                {
+                    RemoveWatch(*it);
+                    it->m_ready = false;
+                }
+                continue;
+            }
+
+            if (event->len == 0)
+                continue;
+
+            QString name = QString::fromLocal8Bit(event->name);
+            bool exists = (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0;
+            ApplyChange(dir, name, exists);
+        }
+    }
+#endif
+}
+
+/// \brief Must be called with m_lock held.
+void StorageGroupCache::ApplyChange(const QString &dir, const QString &name,
+                                    bool exists)
+{
+    auto it = m_dirs.find(dir);
+    if (it == m_dirs.end())
+        return;
+
+    if (it->m_scanning)
+        it->m_pending.append(qMakePair(name, exists));
+
+    if (exists)
+    {
+        it->m_files.insert(name);
+        it->m_missing.remove(name);
+    }
+    else
+    {
+        it->m_files.remove(name);
+    }
+}
+
+/// \brief Must be called with m_lock held.
+void StorageGroupCache::RemoveWatch(DirIndex &index)
+{
+#ifdef __linux__
+    if (index.m_watch >= 0)
+    {
+        // Fails harmlessly if the kernel already removed it
+        inotify_rm_watch(m_inotifyFd, index.m_watch);
+        m_watches.remove(index.m_watch);
+    }
+#endif
+    index.m_watch = -1;
+    index.m_trusted = false;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
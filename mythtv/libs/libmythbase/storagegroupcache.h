@@ -0,0 +1,95 @@
+#ifndef STORAGEGROUPCACHE_H
+#define STORAGEGROUPCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+#include "mythbaseexp.h"
+#include "mythchrono.h"
+
+/// \brief Counters of the StorageGroupCache lookups
+struct StorageGroupCacheStats
+{
+    uint64_t m_hits         {0};    ///< found in the index
+    uint64_t m_negativeHits {0};    ///< known not to exist without a stat()
+    uint64_t m_misses       {0};    ///< had to stat() the file
+    uint64_t m_rescans      {0};    ///< directory listings read
+};
+
+/** \class StorageGroupCache
+ *  \brief Index of the files in each storage group directory, so that
+ *         StorageGroup::FindFileDir() doesn't have to stat() the file in
+ *         every directory of the group.
+ *
+ *   A directory is listed in the background the first time it is looked
+ *   at, lookups stat() the file as before until the listing is done.
+ *
+ *   On Linux local directories are kept current with inotify, and the
+ *   index is the final answer.  Other directories, and those on network
+ *   file systems where changes made by other hosts aren't reported, are
+ *   listed again every few minutes.  For those a file that isn't in the
+ *   index is still looked for, and only remembered as missing for a few
+ *   seconds.
+ *
+ *   Only files directly in a directory are indexed, paths with a
+ *   subdirectory are always looked up with stat().
+ */
+class MBASE_PUBLIC StorageGroupCache
+{
+  public:
+    static StorageGroupCache *GetInstance(void);
+
+    StorageGroupCache();
+    ~StorageGroupCache();
+
+    bool FileExists(const QString &dir, const QString &filename);
+    bool IsIndexed(const QString &dir);
+
+    StorageGroupCacheStats GetStats(void) const;
+
+    friend class StorageGroupCacheScanner;
+
+  private:
+    Q_DISABLE_COPY(StorageGroupCache)
+
+    /// Index of one directory
+    struct DirIndex
+    {
+        QSet<QString> m_files;
+        QHash<QString, std::chrono::milliseconds> m_missing; ///< expiry times
+        QList<QPair<QString, bool> > m_pending;   ///< changes seen in a scan
+        std::chrono::milliseconds m_scanned {0ms};
+        int  m_watch    {-1};           ///< inotify watch descriptor
+        bool m_ready    {false};
+        bool m_scanning {false};
+        bool m_trusted  {false};        ///< watched and on a local file system
+    };
+
+    static bool Stat(const QString &path);
+    void StartScan(const QString &dir, DirIndex &index);
+    void Scan(const QString &dir);
+    void ReadEvents(void);
+    void ApplyChange(const QString &dir, const QString &name, bool exists);
+    void RemoveWatch(DirIndex &index);
+
+    mutable QMutex            m_lock;
+    QHash<QString, DirIndex>  m_dirs;           // protected by m_lock
+    QHash<int, QString>       m_watches;        // protected by m_lock
+    int                       m_inotifyFd {-1};
+
+    std::atomic<uint64_t>     m_hits         {0};
+    std::atomic<uint64_t>     m_negativeHits {0};
+    std::atomic<uint64_t>     m_misses       {0};
+    std::atomic<uint64_t>     m_rescans      {0};
+};
+
+#endif // STORAGEGROUPCACHE_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,214 @@
+/*
+ *  Class TestBinaryLog
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QTemporaryDir>
+
+#include <unistd.h>
+
+#include "binarylog.h"
+#include "logging.h"
+#include "loggingserver.h"
+#include "test_binarylog.h"
+
+static LoggingItem *makeItem(const QString &thread, const char *file,
+                             const char *function, int line,
+                             LogLevel_t level, uint64_t mask, int64_t epoch,
+                             qlonglong tid, const QString &message)
+{
+    LoggingItem *item = LoggingItem::create(file, function, line, level,
+                                            kMessage);
+    item->setThreadName(thread);
+    item->setMask(mask);
+    item->setEpoch(std::chrono::milliseconds(epoch));
+    item->setTid(tid);
+    item->setMessage(message);
+    return item;
+}
+
+static void writeItem(BinaryLogger &logger, LoggingItem *item)
+{
+    QVERIFY(logger.logmsg(item));
+    item->DecrRef();
+}
+
+// Every field of every message comes back as it was written, with strings
+// shared between messages defined only once
+void TestBinaryLog::test_fields(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = dir.filePath("fields.mlog");
+
+    QString longThread(300, 'T');
+    {
+        BinaryLogger logger(qPrintable(filename), 1024 * 1024);
+        writeItem(logger, makeItem("CoreContext", "mythcorecontext.cpp",
+                                   "Init", 123, LOG_INFO, VB_GENERAL,
+                                   1600000000123, 4242, "first"));
+        writeItem(logger, makeItem(longThread, "mythcorecontext.cpp",
+                                   "ConnectToMasterServer", 456789,
+                                   LOG_EMERG, VB_RECORD | VB_CHANNEL,
+                                   1600000000456, 0xFFFFFFF0, "second"));
+        writeItem(logger, makeItem("CoreContext", "tv_rec.cpp", "Init", 1,
+                                   LOG_DEBUG, VB_GENERAL | VB_FLUSH, 0, 0,
+                                   "third"));
+    }
+
+    BinaryLogReader reader(filename);
+    QVERIFY(reader.IsOpen());
+    QCOMPARE(reader.AppName(), QCoreApplication::applicationName());
+    QCOMPARE(reader.Pid(), static_cast<int>(getpid()));
+
+    BinaryLogEntry entry;
+    QVERIFY(reader.Next(entry));
+    QCOMPARE(entry.m_threadName, QString("CoreContext"));
+    QCOMPARE(entry.m_file, QString("mythcorecontext.cpp"));
+    QCOMPARE(entry.m_function, QString("Init"));
+    QCOMPARE(entry.m_line, 123);
+    QCOMPARE(entry.m_level, LOG_INFO);
+    QCOMPARE(entry.m_mask, static_cast<uint64_t>(VB_GENERAL));
+    QCOMPARE(entry.m_epoch, static_cast<int64_t>(1600000000123));
+    QCOMPARE(entry.m_tid, 4242U);
+    QCOMPARE(entry.m_message, QString("first"));
+    // as mythutil --decodelog prints it
+    QString line = reader.Format(entry);
+    QVERIFY2(line.endsWith(QString(" I [%1/4242] CoreContext "
+                                   "mythcorecontext.cpp:123 (Init) - first")
+                           .arg(getpid())), qPrintable(line));
+
+    QVERIFY(reader.Next(entry));
+    QCOMPARE(entry.m_threadName, longThread);
+    QCOMPARE(entry.m_file, QString("mythcorecontext.cpp"));
+    QCOMPARE(entry.m_function, QString("ConnectToMasterServer"));
+    QCOMPARE(entry.m_line, 456789);
+    QCOMPARE(entry.m_level, LOG_EMERG);
+    QCOMPARE(entry.m_mask, static_cast<uint64_t>(VB_RECORD | VB_CHANNEL));
+    QCOMPARE(entry.m_epoch, static_cast<int64_t>(1600000000456));
+    QCOMPARE(entry.m_tid, 0xFFFFFFF0U);
+    QCOMPARE(entry.m_message, QString("second"));
+
+    QVERIFY(reader.Next(entry));
+    QCOMPARE(entry.m_threadName, QString("CoreContext"));
+    QCOMPARE(entry.m_file, QString("tv_rec.cpp"));
+    QCOMPARE(entry.m_function, QString("Init"));
+    QCOMPARE(entry.m_line, 1);
+    QCOMPARE(entry.m_level, LOG_DEBUG);
+    QCOMPARE(entry.m_mask, static_cast<uint64_t>(VB_GENERAL | VB_FLUSH));
+    QCOMPARE(entry.m_epoch, static_cast<int64_t>(0));
+    QCOMPARE(entry.m_tid, 0U);
+    QCOMPARE(entry.m_message, QString("third"));
+
+    QVERIFY(!reader.Next(entry));
+
+    // 6 distinct strings, 3 messages
+    QFileInfo info(filename);
+    qint64 expected = BinaryLog::kHeaderSize + 3 * BinaryLog::kMessageHeader +
+        QString("firstsecondthird").size() + 6 * BinaryLog::kStringHeader +
+        QString("CoreContextmythcorecontext.cppInitConnectToMasterServer"
+                "tv_rec.cpp").size() + longThread.size();
+    QCOMPARE(info.size(), expected);
+}
+
+void TestBinaryLog::test_message_data(void)
+{
+    QTest::addColumn<QString>("message");
+    QTest::addColumn<QString>("expected");
+
+    int longest = BinaryLog::kMaxRecordSize - BinaryLog::kMessageHeader;
+    QTest::newRow("empty")   << QString() << QString();
+    QTest::newRow("unicode") << QString::fromUtf8("Ünïcødé – ✓")
+                             << QString::fromUtf8("Ünïcødé – ✓");
+    QTest::newRow("long")    << QString(5000, 'x') << QString(5000, 'x');
+    QTest::newRow("longest") << QString(longest, 'y')
+                             << QString(longest, 'y');
+    QTest::newRow("too long") << QString(70000, 'z')
+                              << QString(longest, 'z');
+}
+
+// Messages come back whole up to the largest a record can hold, and are cut
+// off there
+void TestBinaryLog::test_message(void)
+{
+    QFETCH(QString, message);
+    QFETCH(QString, expected);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = dir.filePath("message.mlog");
+    {
+        BinaryLogger logger(qPrintable(filename), 1024 * 1024);
+        writeItem(logger, makeItem("Message", __FILE__, __FUNCTION__,
+                                   __LINE__, LOG_INFO, VB_GENERAL, 1, 1,
+                                   message));
+    }
+
+    BinaryLogReader reader(filename);
+    QVERIFY(reader.IsOpen());
+    BinaryLogEntry entry;
+    QVERIFY(reader.Next(entry));
+    QCOMPARE(entry.m_message, expected);
+    QCOMPARE(entry.m_threadName, QString("Message"));
+    QCOMPARE(entry.m_function, QString(__FUNCTION__));
+    QVERIFY(!reader.Next(entry));
+}
+
+// Once the log fills half the space it moves to <name>.1.  The two files
+// together hold the newest messages in order, and each defines the strings
+// it needs.
+void TestBinaryLog::test_rotate(void)
+{
+    static constexpr int kMessages { 1000 };
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString filename = dir.filePath("rotate.mlog");
+    {
+        // two 64k files, for roughly 300 messages each
+        BinaryLogger logger(qPrintable(filename), 128 * 1024);
+        for (int i = 0; i < kMessages; ++i)
+        {
+            writeItem(logger, makeItem("Rotate", __FILE__, __FUNCTION__,
+                                       i, LOG_INFO, VB_GENERAL, i, 1,
+                                       QString("%1 ").arg(i, 4) +
+                                       QString(200, '.')));
+        }
+    }
+    QVERIFY(QFileInfo(filename).size() <= 64 * 1024);
+
+    int last = -1;
+    for (const QString &name : { filename + ".1", filename })
+    {
+        BinaryLogReader reader(name);
+        QVERIFY(reader.IsOpen());
+        BinaryLogEntry entry;
+        while (reader.Next(entry))
+        {
+            int number = entry.m_message.left(4).trimmed().toInt();
+            if (last >= 0)
+                QCOMPARE(number, last + 1);
+            QCOMPARE(entry.m_line, number);
+            QCOMPARE(entry.m_epoch, static_cast<int64_t>(number));
+            QCOMPARE(entry.m_threadName, QString("Rotate"));
+            QCOMPARE(entry.m_file, QString(__FILE__));
+            QCOMPARE(entry.m_function, QString(__FUNCTION__));
+            last = number;
+        }
+    }
+    QCOMPARE(last, kMessages - 1);
+}
+
+QTEST_GUILESS_MAIN(TestBinaryLog)
@@ -0,0 +1,20 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += xml sql network testlib
+
+TEMPLATE = app
+TARGET = test_binarylog
+DEPENDPATH += . ../.. ../../logging
+INCLUDEPATH += . ../.. ../../logging
+LIBS += -L../.. -lmythbase-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_binarylog.h
+SOURCES += test_binarylog.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -345,4 +345,66 @@ void TestLogging::test_logPropagateCalc (void)
 
 // logPropagateCalc
 
-QTEST_APPLESS_MAIN(TestLogging)
+// A LOG() call below the current log level must cost next to nothing, and
+// must not evaluate its message.
+void TestLogging::test_logDisabledCost (void)
+{
+    resetLogging();
+    logLevel = LOG_INFO;
+
+    int evaluated = 0;
+    QBENCHMARK
+    {
+        LOG(VB_GENERAL, LOG_DEBUG,
+            QString("Not logged %1").arg(++evaluated));
+    }
+    QCOMPARE(evaluated, 0);
+}
+
+void TestLogging::test_logContention_data (void)
+{
+    QTest::addColumn<int>("threads");
+
+    QTest::newRow("1 thread")  << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+// Time per LOG() call with several threads logging at once, with the
+// logging thread running, but nothing written to the console or a file.
+void TestLogging::test_logContention (void)
+{
+    QFETCH(int, threads);
+    static constexpr int kMessages { 20000 };
+
+    resetLogging();
+    logStart("", false, 1, -1, LOG_INFO, false, false, false);
+
+    std::atomic<bool> start { false };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back([&start]() {
+            while (!start)
+                std::this_thread::yield();
+            for (int j = 0; j < kMessages; ++j)
+                LOG(VB_GENERAL, LOG_INFO, QString("Benchmark message %1").arg(j));
+        });
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    start = true;
+    for (auto & worker : workers)
+        worker.join();
+    qint64 elapsed = timer.nsecsElapsed();
+
+    logStop();
+
+    QTest::setBenchmarkResult(static_cast<qreal>(elapsed) / (threads * kMessages),
+                              QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(TestLogging)
@@ -19,8 +19,11 @@
  */
 
 #include <QtTest/QtTest>
+#include <atomic>
 #include <iostream>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "mythsyslog.h"
 #include "exitcodes.h"
@@ -48,4 +51,7 @@ private slots:
     static void test_verboseArgParse_level(void);
     static void test_logPropagateCalc_data(void);
     static void test_logPropagateCalc(void);
+    static void test_logDisabledCost(void);
+    static void test_logContention_data(void);
+    static void test_logContention(void);
 };
@@ -0,0 +1,187 @@
+/*
+ *  Class TestMythDBCon
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <memory>
+
+#include "test_mythdbcon.h"
+
+// MSqlQuery only ever sees QSqlDatabase, so an in memory SQLite database
+// stands in for MySQL here.
+MSqlDatabase *TestMythDBCon::openDatabase(const QString &name)
+{
+    auto *db = new MSqlDatabase(name, "QSQLITE");
+    db->m_db.setDatabaseName(":memory:");
+    if (!db->m_db.open())
+    {
+        delete db;
+        return nullptr;
+    }
+    return db;
+}
+
+MSqlQueryInfo TestMythDBCon::queryInfo(MSqlDatabase *db)
+{
+    MSqlQueryInfo qi;
+    qi.db = db;
+    qi.qsqldb = db->db();
+    qi.returnConnection = false;
+    return qi;
+}
+
+void TestMythDBCon::initTestCase(void)
+{
+    if (!QSqlDatabase::isDriverAvailable("QSQLITE"))
+        QSKIP("The Qt SQLite driver is not installed");
+}
+
+// A statement is prepared once per connection, and lent to one query at
+// a time
+void TestMythDBCon::test_statementReuse(void)
+{
+    std::unique_ptr<MSqlDatabase> db(openDatabase("reuse"));
+    QVERIFY(db);
+
+    for (int value = 1; value <= 3; value++)
+    {
+        MSqlQuery query(queryInfo(db.get()));
+        QVERIFY(query.prepare("SELECT :VALUE"));
+        QCOMPARE(db->m_statements.size(), size_t{1});
+        QVERIFY(db->m_statements.front().m_inUse);
+
+        query.bindValue(":VALUE", value);
+        QVERIFY(query.exec());
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0).toInt(), value);
+    }
+    QVERIFY(!db->m_statements.front().m_inUse);
+
+    // Statements without placeholders are not kept
+    MSqlQuery query(queryInfo(db.get()));
+    QVERIFY(query.prepare("SELECT 1"));
+    QVERIFY(query.exec());
+    QCOMPARE(db->m_statements.size(), size_t{1});
+    QVERIFY(!db->m_statements.front().m_inUse);
+}
+
+// A query run while another one still reads the results of the same
+// statement gets its own
+void TestMythDBCon::test_nestedQueries(void)
+{
+    std::unique_ptr<MSqlDatabase> db(openDatabase("nested"));
+    QVERIFY(db);
+
+    MSqlQuery outer(queryInfo(db.get()));
+    QVERIFY(outer.prepare("SELECT :VALUE"));
+    outer.bindValue(":VALUE", 1);
+    QVERIFY(outer.exec());
+
+    MSqlQuery inner(queryInfo(db.get()));
+    QVERIFY(inner.prepare("SELECT :VALUE"));
+    inner.bindValue(":VALUE", 2);
+    QVERIFY(inner.exec());
+
+    QVERIFY(outer.next());
+    QCOMPARE(outer.value(0).toInt(), 1);
+    QVERIFY(inner.next());
+    QCOMPARE(inner.value(0).toInt(), 2);
+    QCOMPARE(db->m_statements.size(), size_t{1});
+}
+
+// Values bound by the last user of a statement don't carry over
+void TestMythDBCon::test_rebinding(void)
+{
+    std::unique_ptr<MSqlDatabase> db(openDatabase("rebinding"));
+    QVERIFY(db);
+
+    MSqlQuery query(queryInfo(db.get()));
+    QVERIFY(query.exec("CREATE TABLE rebind (a INTEGER, b INTEGER)"));
+
+    const QString insert { "INSERT INTO rebind (a, b) VALUES (:A, :B)" };
+    {
+        MSqlQuery first(queryInfo(db.get()));
+        QVERIFY(first.prepare(insert));
+        first.bindValue(":A", 1);
+        first.bindValue(":B", 2);
+        QVERIFY(first.exec());
+    }
+    {
+        MSqlQuery second(queryInfo(db.get()));
+        QVERIFY(second.prepare(insert));
+        second.bindValue(":A", 3);
+        QVERIFY(second.exec());
+    }
+
+    QVERIFY(query.prepare("SELECT b FROM rebind WHERE a = :A"));
+    query.bindValue(":A", 1);
+    QVERIFY(query.exec());
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 2);
+
+    query.bindValue(":A", 3);
+    QVERIFY(query.exec());
+    QVERIFY(query.next());
+    QVERIFY(query.value(0).isNull());
+}
+
+// Statistics are kept per statement, by its text before binding
+void TestMythDBCon::test_queryStats(void)
+{
+    std::unique_ptr<MSqlDatabase> db(openDatabase("stats"));
+    QVERIFY(db);
+
+    MSqlQuery::ResetQueryStats();
+    for (int value = 1; value <= 2; value++)
+    {
+        MSqlQuery query(queryInfo(db.get()));
+        QVERIFY(query.prepare("SELECT :VALUE"));
+        query.bindValue(":VALUE", value);
+        QVERIFY(query.exec());
+    }
+    MSqlQuery query(queryInfo(db.get()));
+    QVERIFY(query.exec("SELECT 2"));
+
+    QList<MSqlQueryStats> stats = MSqlQuery::GetQueryStats();
+    QCOMPARE(stats.size(), 2);
+    for (const auto &entry : qAsConst(stats))
+    {
+        QVERIFY(!entry.m_query.isEmpty());
+        QCOMPARE(entry.m_count,
+                 static_cast<uint64_t>(entry.m_query == "SELECT :VALUE" ? 2 : 1));
+    }
+}
+
+// Only the most recently used idle connections are kept
+void TestMythDBCon::test_poolTrimming(void)
+{
+    MDBManager manager;
+    QList<MSqlDatabase*> connections;
+    for (int i = 0; i < 6; i++)
+    {
+        auto *db = new MSqlDatabase(QString("pool%1").arg(i), "QSQLITE");
+        manager.m_connCount++;
+        manager.pushConnection(db);
+        connections.push_back(db);
+    }
+
+    const QList<MSqlDatabase*> &pool = manager.m_pool[QThread::currentThread()];
+    QCOMPARE(pool.size(), 4);
+    QCOMPARE(manager.m_connCount, 4);
+    QCOMPARE(pool, (QList<MSqlDatabase*> { connections[5], connections[4],
+                                           connections[3], connections[2] }));
+}
+
+QTEST_GUILESS_MAIN(TestMythDBCon)
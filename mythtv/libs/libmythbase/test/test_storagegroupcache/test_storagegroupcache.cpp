@@ -0,0 +1,119 @@
+/*
+ *  Class TestStorageGroupCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include "test_storagegroupcache.h"
+
+bool TestStorageGroupCache::createFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write("x");
+    return true;
+}
+
+// Lookups work while the directory is still being listed
+void TestStorageGroupCache::test_beforeIndexed(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createFile(dir.filePath("one.ts")));
+
+    StorageGroupCache cache;
+    QVERIFY(cache.FileExists(dir.path(), "one.ts"));
+    QVERIFY(!cache.FileExists(dir.path(), "two.ts"));
+    QTRY_VERIFY(cache.IsIndexed(dir.path()));
+}
+
+void TestStorageGroupCache::test_indexed(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createFile(dir.filePath("one.ts")));
+
+    StorageGroupCache cache;
+    cache.FileExists(dir.path(), "one.ts");
+    QTRY_VERIFY(cache.IsIndexed(dir.path()));
+
+    StorageGroupCacheStats before = cache.GetStats();
+    QCOMPARE(before.m_rescans, static_cast<uint64_t>(1));
+    QVERIFY(cache.FileExists(dir.path(), "one.ts"));
+    QVERIFY(!cache.FileExists(dir.path(), "two.ts"));
+    QVERIFY(!cache.FileExists(dir.path(), "two.ts"));
+
+    StorageGroupCacheStats after = cache.GetStats();
+    QCOMPARE(after.m_hits, before.m_hits + 1);
+    QCOMPARE(after.m_negativeHits + after.m_misses,
+             before.m_negativeHits + before.m_misses + 2);
+    QVERIFY(after.m_negativeHits > before.m_negativeHits);
+}
+
+// Files created or removed after the listing are seen right away
+void TestStorageGroupCache::test_changes(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(createFile(dir.filePath("one.ts")));
+
+    StorageGroupCache cache;
+    cache.FileExists(dir.path(), "one.ts");
+    QTRY_VERIFY(cache.IsIndexed(dir.path()));
+
+    QVERIFY(!cache.FileExists(dir.path(), "two.ts"));
+    QVERIFY(createFile(dir.filePath("two.ts")));
+    QVERIFY(cache.FileExists(dir.path(), "two.ts"));
+
+    QVERIFY(QFile::remove(dir.filePath("one.ts")));
+    QVERIFY(!cache.FileExists(dir.path(), "one.ts"));
+
+    QVERIFY(QFile::rename(dir.filePath("two.ts"), dir.filePath("three.ts")));
+    QVERIFY(!cache.FileExists(dir.path(), "two.ts"));
+    QVERIFY(cache.FileExists(dir.path(), "three.ts"));
+}
+
+void TestStorageGroupCache::test_subdirectory(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QVERIFY(QDir(dir.path()).mkdir("sub"));
+    QVERIFY(createFile(dir.filePath("sub/one.mkv")));
+
+    StorageGroupCache cache;
+    QVERIFY(cache.FileExists(dir.path(), "sub/one.mkv"));
+    QVERIFY(!cache.FileExists(dir.path(), "sub/two.mkv"));
+    QVERIFY(cache.FileExists(dir.path(), "sub"));
+    QTRY_VERIFY(cache.IsIndexed(dir.path()));
+}
+
+void TestStorageGroupCache::test_missingDir(void)
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString missing = dir.filePath("missing");
+
+    StorageGroupCache cache;
+    QVERIFY(!cache.FileExists(missing, "one.ts"));
+    QTRY_VERIFY(cache.IsIndexed(missing));
+    QVERIFY(!cache.FileExists(missing, "one.ts"));
+
+    // The directory is created later, unwatched directories are checked
+    QVERIFY(QDir(dir.path()).mkdir("missing"));
+    QVERIFY(createFile(dir.filePath("missing/two.ts")));
+    QVERIFY(cache.FileExists(missing, "two.ts"));
+}
+
+QTEST_GUILESS_MAIN(TestStorageGroupCache)
@@ -22,17 +22,32 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <complex>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <vector>
+
+#include "mythconfig.h"
+
 #ifdef USE_FFTW3
 #include "fftw3.h"
 #else
 extern "C" {
 #include "libavcodec/avfft.h"
-#include "libavcodec/fft.h"
+#include "libavutil/mem.h"
 }
-using FFTComplexArray = FFTSample[2];
 #endif
+extern "C" {
+#include "libavutil/cpu.h"
+}
 
+#if (HAVE_SSE2 && ARCH_X86_64)
+#include <emmintrin.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
+#elif (HAVE_INTRINSICS_NEON && ARCH_AARCH64)
+#include "libavutil/aarch64/cpu.h"
+#include <arm_neon.h>
+static const bool s_haveSIMD = have_neon(av_get_cpu_flags());
+#endif
 
 #if defined(_WIN32) && defined(USE_FFTW3)
 #pragma comment (lib,"libfftw3f-3.lib")
@@ -46,46 +61,317 @@ static const float PI = 3.141592654;
 static const float epsilon = 0.000001;
 static const float center_level = 0.5*sqrt(0.5);
 
-// private implementation of the surround decoder
-class decoder_impl {
+/*
+ The spectral decoder is written once against the float1 interface below and
+ run four bins at a time with float4 where SSE2 or AArch64 NEON is available.
+ Configure turns off the compiler's own vectorizer, so this is what keeps the
+ per-bin steering from being the bulk of the upmixer's time.
+ */
+struct float1
+{
+    static constexpr unsigned width = 1;
+    using mask = bool;
+
+    static float1 set(float x)         { return {x}; }
+    static float1 load(const float *p) { return {*p}; }
+    void store(float *p) const         { *p = v; }
+    // load/store interleaved re/im pairs
+    static void load2(const float *p, float1 &re, float1 &im) { re.v = p[0]; im.v = p[1]; }
+    static void store2(float *p, float1 re, float1 im)        { p[0] = re.v; p[1] = im.v; }
+
+    float v;
+};
+
+static inline float1 operator+(float1 a, float1 b) { return {a.v + b.v}; }
+static inline float1 operator-(float1 a, float1 b) { return {a.v - b.v}; }
+static inline float1 operator*(float1 a, float1 b) { return {a.v * b.v}; }
+static inline float1 operator/(float1 a, float1 b) { return {a.v / b.v}; }
+static inline float1 operator-(float1 a)           { return {-a.v}; }
+static inline bool   operator<(float1 a, float1 b) { return a.v < b.v; }
+static inline float1 vmin(float1 a, float1 b)      { return {a.v < b.v ? a.v : b.v}; }
+static inline float1 vmax(float1 a, float1 b)      { return {a.v > b.v ? a.v : b.v}; }
+static inline float1 vabs(float1 a)                { return {std::fabs(a.v)}; }
+static inline float1 vsqrt(float1 a)               { return {std::sqrt(a.v)}; }
+static inline float1 select(bool m, float1 a, float1 b) { return m ? a : b; }
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+struct float4
+{
+    static constexpr unsigned width = 4;
+    struct mask { __m128 v; };
+
+    static float4 set(float x)         { return {_mm_set1_ps(x)}; }
+    static float4 load(const float *p) { return {_mm_loadu_ps(p)}; }
+    void store(float *p) const         { _mm_storeu_ps(p, v); }
+    static void load2(const float *p, float4 &re, float4 &im)
+    {
+        __m128 a = _mm_loadu_ps(p);
+        __m128 b = _mm_loadu_ps(p + 4);
+        re.v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+        im.v = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+    }
+    static void store2(float *p, float4 re, float4 im)
+    {
+        _mm_storeu_ps(p,     _mm_unpacklo_ps(re.v, im.v));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(re.v, im.v));
+    }
+
+    __m128 v;
+};
+
+static inline float4 operator+(float4 a, float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+static inline float4 operator-(float4 a, float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+static inline float4 operator*(float4 a, float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+static inline float4 operator/(float4 a, float4 b) { return {_mm_div_ps(a.v, b.v)}; }
+static inline float4 operator-(float4 a)           { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.0F))}; }
+static inline float4::mask operator<(float4 a, float4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+static inline float4 vmin(float4 a, float4 b)      { return {_mm_min_ps(a.v, b.v)}; }
+static inline float4 vmax(float4 a, float4 b)      { return {_mm_max_ps(a.v, b.v)}; }
+static inline float4 vabs(float4 a)                { return {_mm_andnot_ps(_mm_set1_ps(-0.0F), a.v)}; }
+static inline float4 vsqrt(float4 a)               { return {_mm_sqrt_ps(a.v)}; }
+static inline float4 select(float4::mask m, float4 a, float4 b)
+{
+    return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))};
+}
+#elif (HAVE_INTRINSICS_NEON && ARCH_AARCH64)
+struct float4
+{
+    static constexpr unsigned width = 4;
+    struct mask { uint32x4_t v; };
+
+    static float4 set(float x)         { return {vdupq_n_f32(x)}; }
+    static float4 load(const float *p) { return {vld1q_f32(p)}; }
+    void store(float *p) const         { vst1q_f32(p, v); }
+    static void load2(const float *p, float4 &re, float4 &im)
+    {
+        float32x4x2_t t = vld2q_f32(p);
+        re.v = t.val[0];
+        im.v = t.val[1];
+    }
+    static void store2(float *p, float4 re, float4 im)
+    {
+        float32x4x2_t t { { re.v, im.v } };
+        vst2q_f32(p, t);
+    }
+
+    float32x4_t v;
+};
+
+static inline float4 operator+(float4 a, float4 b) { return {vaddq_f32(a.v, b.v)}; }
+static inline float4 operator-(float4 a, float4 b) { return {vsubq_f32(a.v, b.v)}; }
+static inline float4 operator*(float4 a, float4 b) { return {vmulq_f32(a.v, b.v)}; }
+static inline float4 operator/(float4 a, float4 b) { return {vdivq_f32(a.v, b.v)}; }
+static inline float4 operator-(float4 a)           { return {vnegq_f32(a.v)}; }
+static inline float4::mask operator<(float4 a, float4 b) { return {vcltq_f32(a.v, b.v)}; }
+static inline float4 vmin(float4 a, float4 b)      { return {vminq_f32(a.v, b.v)}; }
+static inline float4 vmax(float4 a, float4 b)      { return {vmaxq_f32(a.v, b.v)}; }
+static inline float4 vabs(float4 a)                { return {vabsq_f32(a.v)}; }
+static inline float4 vsqrt(float4 a)               { return {vsqrtq_f32(a.v)}; }
+static inline float4 select(float4::mask m, float4 a, float4 b)
+{
+    return {vbslq_f32(m.v, a.v, b.v)};
+}
+#endif
+
+// call body(V, i) for every i in [0,n), with V a float4 for as long as it fits
+template <class Body>
+static inline void simd_for(unsigned n, Body body)
+{
+    unsigned i = 0;
+#if (HAVE_SSE2 && ARCH_X86_64) || (HAVE_INTRINSICS_NEON && ARCH_AARCH64)
+    if (s_haveSIMD)
+    {
+        for (; i + float4::width <= n; i += float4::width)
+            body(float4 {}, i);
+    }
+#endif
+    for (; i < n; i++)
+        body(float1 {}, i);
+}
+
+// Polynomial versions of the trig functions the steering needs.  They are
+// good to about a float's precision over the ranges used, -1..1 for sin,
+// tan and asin and 0..1 for atan, and branch free so they vectorize.
+template <class V> static inline V fast_sin_minus_x(V x)
+{
+    // Taylor series, the next term is below 2e-10 at |x|=1
+    V x2 = x * x;
+    return x * x2 * (V::set(-1.0F/6) + x2 * (V::set(1.0F/120) +
+           x2 * (V::set(-1.0F/5040) + x2 * (V::set(1.0F/362880) + x2 * V::set(-1.0F/39916800)))));
+}
+
+template <class V> static inline V fast_sin(V x)
+{
+    return x + fast_sin_minus_x(x);
+}
+
+template <class V> static inline V fast_tan(V x)
+{
+    // [7/6] Pade approximant
+    V x2 = x * x;
+    V num = x * (V::set(135135.0F) + x2 * (V::set(-17325.0F) + x2 * (V::set(378.0F) - x2)));
+    V den = V::set(135135.0F) + x2 * (V::set(-62370.0F) + x2 * (V::set(3150.0F) + x2 * V::set(-28.0F)));
+    return num / den;
+}
+
+template <class V> static inline V fast_asin(V x)
+{
+    // as Cephes' asinf(), above 0.5 asin(x) = pi/2 - 2*asin(sqrt((1-x)/2))
+    V a = vabs(x);
+    auto big = V::set(0.5F) < a;
+    V t = select(big, vsqrt(V::set(0.5F) * (V::set(1.0F) - a)), a);
+    V z = t * t;
+    V r = t + t * z * ((((V::set(4.2163199048E-2F) * z + V::set(2.4181311049E-2F)) * z +
+                         V::set(4.5470025998E-2F)) * z + V::set(7.4953002686E-2F)) * z +
+                         V::set(1.6666752422E-1F));
+    r = select(big, V::set(PI/2) - r - r, r);
+    return select(x < V::set(0.0F), -r, r);
+}
+
+template <class V> static inline V fast_atan2(V y, V x)
+{
+    // as Cephes' atanf(), reduced to 0..1 by symmetry and then to
+    // 0..tan(pi/8) with atan(a) = pi/4 + atan((a-1)/(a+1))
+    V ax = vabs(x);
+    V ay = vabs(y);
+    V a = vmin(ax, ay) / vmax(vmax(ax, ay), V::set(1e-30F));
+    auto mid = V::set(0.4142135623730950F) < a;
+    a = select(mid, (a - V::set(1.0F)) / (a + V::set(1.0F)), a);
+    V z = a * a;
+    V r = (((V::set(8.05374449538e-2F) * z - V::set(1.38776856032E-1F)) * z +
+            V::set(1.99777106478E-1F)) * z - V::set(3.33329491539E-1F)) * z * a + a;
+    r = select(mid, r + V::set(PI/4), r);
+    r = select(ax < ay, V::set(PI/2) - r, r);
+    r = select(x < V::set(0.0F), V::set(PI) - r, r);
+    return select(y < V::set(0.0F), -r, r);
+}
+
+// The FFT plans and buffers for one block size.  Setting them up is slow,
+// FFTW measures its plans when they are created, so a decoder hands them back
+// to a pool when it is deleted and the next one of the same size reuses them.
+class fft_plans {
 public:
-    // create an instance of the decoder
-    //  blocksize is fixed over the lifetime of this object for performance reasons
-    explicit decoder_impl(unsigned blocksize=8192): m_n(blocksize), m_halfN(blocksize/2) {
+    explicit fft_plans(unsigned n): m_n(n) {
 #ifdef USE_FFTW3
-        // create FFTW buffers
         m_lt = (float*)fftwf_malloc(sizeof(float)*m_n);
         m_rt = (float*)fftwf_malloc(sizeof(float)*m_n);
         m_dst = (float*)fftwf_malloc(sizeof(float)*m_n);
-        m_dftL = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*m_n);
-        m_dftR = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*m_n);
-        m_src = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex)*m_n);
-        m_loadL = fftwf_plan_dft_r2c_1d(m_n, m_lt, m_dftL,FFTW_MEASURE);
-        m_loadR = fftwf_plan_dft_r2c_1d(m_n, m_rt, m_dftR,FFTW_MEASURE);
-        m_store = fftwf_plan_dft_c2r_1d(m_n, m_src, m_dst,FFTW_MEASURE);
+        m_dftL = (float*)fftwf_malloc(sizeof(fftwf_complex)*(m_n/2+1));
+        m_dftR = (float*)fftwf_malloc(sizeof(fftwf_complex)*(m_n/2+1));
+        m_src = (float*)fftwf_malloc(sizeof(fftwf_complex)*(m_n/2+1));
+        m_loadL = fftwf_plan_dft_r2c_1d(m_n, m_lt, (fftwf_complex*)m_dftL,FFTW_MEASURE);
+        m_loadR = fftwf_plan_dft_r2c_1d(m_n, m_rt, (fftwf_complex*)m_dftR,FFTW_MEASURE);
+        m_store = fftwf_plan_dft_c2r_1d(m_n, (fftwf_complex*)m_src, m_dst,FFTW_MEASURE);
+        m_scale = 1.0F;
+#else
+        // lavc's real transforms are done in place, and the inverse comes
+        // back at half the scale of a complex one
+        int nbits = 0;
+        while ((1U << nbits) < m_n)
+            nbits++;
+        m_lt = m_dftL = (float*)av_malloc(sizeof(FFTSample)*m_n);
+        m_rt = m_dftR = (float*)av_malloc(sizeof(FFTSample)*m_n);
+        m_src = m_dst = (float*)av_malloc(sizeof(FFTSample)*m_n);
+        m_forward = av_rdft_init(nbits, DFT_R2C);
+        m_inverse = av_rdft_init(nbits, IDFT_C2R);
+        m_scale = 2.0F;
+#endif
+    }
+
+    ~fft_plans() {
+#ifdef USE_FFTW3
+        fftwf_destroy_plan(m_store);
+        fftwf_destroy_plan(m_loadR);
+        fftwf_destroy_plan(m_loadL);
+        fftwf_free(m_src);
+        fftwf_free(m_dftR);
+        fftwf_free(m_dftL);
+        fftwf_free(m_dst);
+        fftwf_free(m_rt);
+        fftwf_free(m_lt);
+#else
+        av_rdft_end(m_inverse);
+        av_rdft_end(m_forward);
+        av_free(m_src);
+        av_free(m_rt);
+        av_free(m_lt);
+#endif
+    }
+
+    // transform m_lt and m_rt into m_dftL and m_dftR, as m_n/2 interleaved
+    // re/im pairs from DC upwards
+    void forward() {
+#ifdef USE_FFTW3
+        fftwf_execute(m_loadL);
+        fftwf_execute(m_loadR);
+#else
+        av_rdft_calc(m_forward, m_dftL);
+        av_rdft_calc(m_forward, m_dftR);
+        // the N/2 component is packed in with DC, but it is never used
+        m_dftL[1] = 0;
+        m_dftR[1] = 0;
+#endif
+    }
+
+    // transform m_n/2 bins of m_src back into m_dst, at m_n*m_scale times
+    // the level that went into forward()
+    void inverse() {
+#ifdef USE_FFTW3
+        m_src[m_n] = 0;
+        m_src[m_n+1] = 0;
+        fftwf_execute(m_store);
 #else
-        // create lavc fft buffers
-        m_lt = (float*)av_malloc(sizeof(FFTSample)*m_n);
-        m_rt = (float*)av_malloc(sizeof(FFTSample)*m_n);
-        m_dftL = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*m_n*2);
-        m_dftR = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*m_n*2);
-        m_src = (FFTComplexArray*)av_malloc(sizeof(FFTComplex)*m_n*2);
-        m_fftContextForward = (FFTContext*)av_malloc(sizeof(FFTContext));
-        memset(m_fftContextForward, 0, sizeof(FFTContext));
-        m_fftContextReverse = (FFTContext*)av_malloc(sizeof(FFTContext));
-        memset(m_fftContextReverse, 0, sizeof(FFTContext));
-        ff_fft_init(m_fftContextForward, 13, 0);
-        ff_fft_init(m_fftContextReverse, 13, 1);
+        // drop DC's imaginary part, and that's where the N/2 component goes
+        m_src[1] = 0;
+        av_rdft_calc(m_inverse, m_src);
 #endif
+    }
+
+    const unsigned m_n;
+    float *m_lt {nullptr}, *m_rt {nullptr};     // left total, right total (source arrays)
+    float *m_dftL {nullptr}, *m_dftR {nullptr}; // their spectra
+    float *m_src {nullptr}, *m_dst {nullptr};   // a filtered spectrum, and its signal
+    float m_scale {1.0F};
+private:
+#ifdef USE_FFTW3
+    fftwf_plan m_loadL,m_loadR,m_store;
+#else
+    RDFTContext *m_forward {nullptr}, *m_inverse {nullptr};
+#endif
+};
+
+static std::mutex s_planLock;
+static std::vector<std::unique_ptr<fft_plans>> s_plans;
+
+static std::unique_ptr<fft_plans> get_plans(unsigned n) {
+    std::lock_guard<std::mutex> lock(s_planLock);
+    for (auto it = s_plans.begin(); it != s_plans.end(); ++it) {
+        if ((*it)->m_n == n) {
+            std::unique_ptr<fft_plans> plans = std::move(*it);
+            s_plans.erase(it);
+            return plans;
+        }
+    }
+    return std::make_unique<fft_plans>(n);
+}
+
+static void release_plans(std::unique_ptr<fft_plans> plans) {
+    std::lock_guard<std::mutex> lock(s_planLock);
+    s_plans.push_back(std::move(plans));
+}
+
+// private implementation of the surround decoder
+class decoder_impl {
+public:
+    // create an instance of the decoder
+    //  blocksize is fixed over the lifetime of this object for performance reasons
+    explicit decoder_impl(unsigned blocksize=8192): m_n(blocksize), m_halfN(blocksize/2) {
+        m_fft = get_plans(m_n);
         // resize our own buffers
-        m_frontR.resize(m_n);
-        m_frontL.resize(m_n);
-        m_avg.resize(m_n);
-        m_surR.resize(m_n);
-        m_surL.resize(m_n);
-        m_trueavg.resize(m_n);
-        m_xFs.resize(m_n);
-        m_yFs.resize(m_n);
+        for (unsigned c=0;c<2;c++) {
+            m_frontL[c].resize(m_halfN);
+            m_frontR[c].resize(m_halfN);
+        }
         m_inbuf[0].resize(m_n);
         m_inbuf[1].resize(m_n);
         for (unsigned c=0;c<6;c++) {
@@ -94,9 +380,13 @@ public:
         }
         sample_rate(48000);
         // generate the window function (square root of hann, b/c it is applied before and after the transform)
+        // the one applied after also undoes the scale of the inverse transform
         m_wnd.resize(m_n);
-        for (unsigned k=0;k<m_n;k++)
+        m_outWnd.resize(m_n);
+        for (unsigned k=0;k<m_n;k++) {
             m_wnd[k] = sqrt(0.5*(1-std::cos(2*PI*k/m_n))/m_n);
+            m_outWnd[k] = m_wnd[k] * m_fft->m_scale;
+        }
         m_currentBuf = 0;
         m_inbufs.fill(nullptr);
         m_outbufs.fill(nullptr);
@@ -109,28 +399,7 @@ public:
 
     // destructor
     ~decoder_impl() {
-#ifdef USE_FFTW3
-        // clean up the FFTW stuff
-        fftwf_destroy_plan(m_store);
-        fftwf_destroy_plan(m_loadR);
-        fftwf_destroy_plan(m_loadL);
-        fftwf_free(m_src);
-        fftwf_free(m_dftR);
-        fftwf_free(m_dftL);
-        fftwf_free(m_dst);
-        fftwf_free(m_rt);
-        fftwf_free(m_lt);
-#else
-        ff_fft_end(m_fftContextForward);
-        ff_fft_end(m_fftContextReverse);
-        av_free(m_src);
-        av_free(m_dftR);
-        av_free(m_dftL);
-        av_free(m_rt);
-        av_free(m_lt);
-        av_free(m_fftContextForward);
-        av_free(m_fftContextReverse);
-#endif
+        release_plans(std::move(m_fft));
     }
 
     float ** getInputBuffers()
@@ -208,8 +477,8 @@ public:
     // set the phase shifting mode
     void phase_mode(unsigned mode) {
         const std::array<std::array<float,2>,4> modes {{ {0,0}, {0,PI}, {PI,0}, {-PI/2,PI/2} }};
-        m_phaseOffsetL = modes[mode][0];
-        m_phaseOffsetR = modes[mode][1];
+        m_phaseOffsetL = std::polar(1.0F, modes[mode][0]);
+        m_phaseOffsetR = std::polar(1.0F, modes[mode][1]);
     }
 
     // what steering mode should be chosen
@@ -222,15 +491,8 @@ public:
     }
 
 private:
-    // polar <-> cartesian coodinates conversion
-    static inline float amplitude(const float *cf) { return std::sqrt(cf[0]*cf[0] + cf[1]*cf[1]); }
-    static inline float phase(const float *cf) { return std::atan2(cf[1],cf[0]); }
-    static inline cfloat polar(float a, float p) { return {static_cast<float>(a*std::cos(p)),static_cast<float>(a*std::sin(p))}; }
-    static inline float sqr(float x) { return x*x; }
-    // the dreaded min/max
-    static inline float min(float a, float b) { return a<b?a:b; }
-    static inline float max(float a, float b) { return a>b?a:b; }
-    static inline float clamp(float x) { return max(-1,min(1,x)); }
+    template <class V> static inline V sqr(V x) { return x*x; }
+    template <class V> static inline V clamp(V x) { return vmax(V::set(-1),vmin(V::set(1),x)); }
 
     // handle the output buffering for overlapped calls of block_decode
     void add_output(InputBufs input1, InputBufs input2, float center_width, float dimension, float adaption_rate, bool /*result*/=false) {
@@ -245,307 +507,214 @@ private:
         // - first it improves the FFT resolution b/c boundary discontinuities (and their frequencies) get removed
         // - second it allows for smooth blending of varying filters between the blocks
         {
-            float* pWnd = &m_wnd[0];
-            float* pLt =  &m_lt[0];
-            float* pRt =  &m_rt[0];
-            float* pIn0 = input1[0];
-            float* pIn1 = input1[1];
-            for (unsigned k=0;k<m_halfN;k++) {
-                *pLt++ = *pIn0++ * *pWnd;
-                *pRt++ = *pIn1++ * *pWnd++;
-            }
-            pIn0 = input2[0];
-            pIn1 = input2[1];
-            for (unsigned k=0;k<m_halfN;k++) {
-                *pLt++ = *pIn0++ * *pWnd;
-                *pRt++ = *pIn1++ * *pWnd++;
-            }
+            const float* pWnd1 = &m_wnd[0];
+            const float* pWnd2 = &m_wnd[m_halfN];
+            float* pLt = m_fft->m_lt;
+            float* pRt = m_fft->m_rt;
+            simd_for(m_halfN, [&](auto v, unsigned k) {
+                using V = decltype(v);
+                (V::load(&input1[0][k]) * V::load(&pWnd1[k])).store(&pLt[k]);
+                (V::load(&input1[1][k]) * V::load(&pWnd1[k])).store(&pRt[k]);
+                (V::load(&input2[0][k]) * V::load(&pWnd2[k])).store(&pLt[m_halfN+k]);
+                (V::load(&input2[1][k]) * V::load(&pWnd2[k])).store(&pRt[m_halfN+k]);
+            });
         }
 
-#ifdef USE_FFTW3
         // ... and tranform it into the frequency domain
-        fftwf_execute(m_loadL);
-        fftwf_execute(m_loadR);
-#else
-        ff_fft_permuteRC(m_fftContextForward, m_lt, (FFTComplex*)&m_dftL[0]);
-        av_fft_calc(m_fftContextForward, (FFTComplex*)&m_dftL[0]);
-
-        ff_fft_permuteRC(m_fftContextForward, m_rt, (FFTComplex*)&m_dftR[0]);
-        av_fft_calc(m_fftContextForward, (FFTComplex*)&m_dftR[0]);
-#endif
+        m_fft->forward();
 
         // 2. compare amplitude and phase of each DFT bin and produce the X/Y coordinates in the sound field
         //    but dont do DC or N/2 component
-        for (unsigned f=0;f<m_halfN;f++) {
-            // get left/right amplitudes/phases
-            float ampL = amplitude(m_dftL[f]);
-            float ampR = amplitude(m_dftR[f]);
-            float phaseL = phase(m_dftL[f]);
-            float phaseR = phase(m_dftR[f]);
-//          if (ampL+ampR < epsilon)
-//              continue;       
-
-            // calculate the amplitude/phase difference
-            float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-            float phaseDiff = phaseL - phaseR;
-            if (phaseDiff < -PI) phaseDiff += 2*PI;
-            if (phaseDiff > PI) phaseDiff -= 2*PI;
-            phaseDiff = abs(phaseDiff);
-
-            if (m_linearSteering) {
-                // --- this is the fancy new linear mode ---
-
-                // get sound field x/y position
-                m_yFs[f] = get_yfs(ampDiff,phaseDiff);
-                m_xFs[f] = get_xfs(ampDiff,m_yFs[f]);
-
-                // add dimension control
-                m_yFs[f] = clamp(m_yFs[f] - dimension);
-
-                // add crossfeed control
-                m_xFs[f] = clamp(m_xFs[f] * (m_frontSeparation*(1+m_yFs[f])/2 + m_rearSeparation*(1-m_yFs[f])/2));
-
-                // 3. generate frequency filters for each output channel
-                float left = (1-m_xFs[f])/2;
-                float right = (1+m_xFs[f])/2;
-                float front = (1+m_yFs[f])/2;
-                float back = (1-m_yFs[f])/2;
-                std::array<float,5> volume {
-                    front * (left * center_width + max(0,-m_xFs[f]) * (1-center_width)),  // left
-                    front * center_level*((1-abs(m_xFs[f])) * (1-center_width)),          // center
-                    front * (right * center_width + max(0, m_xFs[f]) * (1-center_width)), // right
-                    back * m_surroundLevel * left,                                        // left surround
-                    back * m_surroundLevel * right                                        // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    m_filter[c][f] = (1-adaption_rate)*m_filter[c][f] + adaption_rate*volume[c];
+        // 3. generate frequency filters for each output channel
+        simd_for(m_halfN, [&](auto v, unsigned f) {
+            if (m_linearSteering)
+                steer<decltype(v),true>(f,center_width,dimension,adaption_rate);
+            else
+                steer<decltype(v),false>(f,center_width,dimension,adaption_rate);
+        });
 
-            } else {
-                // --- this is the old & simple steering mode ---
-
-                // calculate the amplitude/phase difference
-                float ampDiff = clamp((ampL+ampR < epsilon) ? 0 : (ampR-ampL) / (ampR+ampL));
-                float phaseDiff = phaseL - phaseR;
-                if (phaseDiff < -PI) phaseDiff += 2*PI;
-                if (phaseDiff > PI) phaseDiff -= 2*PI;
-                phaseDiff = abs(phaseDiff);
-
-                // determine sound field x-position
-                m_xFs[f] = ampDiff;
-
-                // determine preliminary sound field y-position from phase difference
-                m_yFs[f] = 1 - (phaseDiff/PI)*2;
-
-                if (abs(m_xFs[f]) > m_surroundBalance) {
-                    // blend linearly between the surrounds and the fronts if the balance exceeds the surround encoding balance
-                    // this is necessary because the sound field is trapezoidal and will be stretched behind the listener
-                    float frontness = (abs(m_xFs[f]) - m_surroundBalance)/(1-m_surroundBalance);
-                    m_yFs[f]  = (1-frontness) * m_yFs[f] + frontness * 1;
-                }
-
-                // add dimension control
-                m_yFs[f] = clamp(m_yFs[f] - dimension);
-
-                // add crossfeed control
-                m_xFs[f] = clamp(m_xFs[f] * (m_frontSeparation*(1+m_yFs[f])/2 + m_rearSeparation*(1-m_yFs[f])/2));
-
-                // 3. generate frequency filters for each output channel, according to the signal position
-                // the sum of all channel volumes must be 1.0
-                float left = (1-m_xFs[f])/2;
-                float right = (1+m_xFs[f])/2;
-                float front = (1+m_yFs[f])/2;
-                float back = (1-m_yFs[f])/2;
-                std::array<float,5> volume {
-                    front * (left * center_width + max(0,-m_xFs[f]) * (1-center_width)),      // left
-                    front * center_level*((1-abs(m_xFs[f])) * (1-center_width)),              // center
-                    front * (right * center_width + max(0, m_xFs[f]) * (1-center_width)),     // right
-                    back * m_surroundLevel*max(0,min(1,((1-(m_xFs[f]/m_surroundBalance))/2))),// left surround
-                    back * m_surroundLevel*max(0,min(1,((1+(m_xFs[f]/m_surroundBalance))/2))) // right surround
-                };
-
-                // adapt the prior filter
-                for (unsigned c=0;c<5;c++)
-                    m_filter[c][f] = (1-adaption_rate)*m_filter[c][f] + adaption_rate*volume[c];
-            }
+        // 4. distribute the unfiltered reference signals over the channels
+        const cfloat one(1,0);
+        const cfloat zero(0,0);
+        apply_filter(one,zero,                    false,&m_filter[0][0],&output[0][0]);  // front left
+        apply_filter(one,one,                     false,&m_filter[1][0],&output[1][0]);  // front center
+        apply_filter(zero,one,                    false,&m_filter[2][0],&output[2][0]);  // front right
+        apply_filter(m_phaseOffsetL,zero,         false,&m_filter[3][0],&output[3][0]);  // surround left
+        apply_filter(zero,m_phaseOffsetR,         false,&m_filter[4][0],&output[4][0]);  // surround right
+        apply_filter(one,one,                     true, &m_filter[5][0],&output[5][0]);  // lfe
+    }
 
-            // ... and build the signal which we want to position
-            m_frontL[f] = polar(ampL+ampR,phaseL);
-            m_frontR[f] = polar(ampL+ampR,phaseR);
-            m_avg[f] = m_frontL[f] + m_frontR[f];
-            m_surL[f] = polar(ampL+ampR,phaseL+m_phaseOffsetL);
-            m_surR[f] = polar(ampL+ampR,phaseR+m_phaseOffsetR);
-            m_trueavg[f] = cfloat(m_dftL[f][0] + m_dftR[f][0], m_dftL[f][1] + m_dftR[f][1]);
+    // steer the DFT bins from f on, V::width of them
+    template <class V, bool linear>
+    inline void steer(unsigned f, float center_width, float dimension, float adaption_rate) {
+        const V zero = V::set(0);
+        const V one = V::set(1);
+        const V half = V::set(0.5F);
+
+        // get left/right amplitudes
+        V reL, imL, reR, imR;
+        V::load2(&m_fft->m_dftL[2*f], reL, imL);
+        V::load2(&m_fft->m_dftR[2*f], reR, imR);
+        V ampL = vsqrt(reL*reL + imL*imL);
+        V ampR = vsqrt(reR*reR + imR*imR);
+        V ampSum = ampL + ampR;
+
+        // calculate the amplitude/phase difference, the latter being the angle between the two
+        V ampDiff = clamp(select(ampSum < V::set(epsilon), zero, (ampR-ampL) / vmax(ampSum, V::set(epsilon))));
+        V phaseDiff = fast_atan2(vabs(imL*reR - reL*imR), reL*reR + imL*imR);
+
+        V xfs;
+        V yfs;
+        if (linear) {
+            // --- this is the fancy new linear mode ---
+
+            // get sound field x/y position
+            yfs = get_yfs(ampDiff,phaseDiff);
+            xfs = get_xfs(ampDiff,yfs);
+        } else {
+            // --- this is the old & simple steering mode ---
+
+            // determine sound field x-position
+            xfs = ampDiff;
+
+            // determine preliminary sound field y-position from phase difference
+            yfs = one - (phaseDiff/V::set(PI))*V::set(2);
+
+            // blend linearly between the surrounds and the fronts if the balance exceeds the surround encoding balance
+            // this is necessary because the sound field is trapezoidal and will be stretched behind the listener
+            V balance = V::set(m_surroundBalance);
+            V frontness = (vabs(xfs) - balance)/(one-balance);
+            yfs = select(balance < vabs(xfs), (one-frontness) * yfs + frontness, yfs);
         }
 
-        // 4. distribute the unfiltered reference signals over the channels
-        apply_filter(&m_frontL[0], &m_filter[0][0],&output[0][0]);  // front left
-        apply_filter(&m_avg[0],    &m_filter[1][0],&output[1][0]);  // front center
-        apply_filter(&m_frontR[0], &m_filter[2][0],&output[2][0]);  // front right
-        apply_filter(&m_surL[0],   &m_filter[3][0],&output[3][0]);  // surround left
-        apply_filter(&m_surR[0],   &m_filter[4][0],&output[4][0]);  // surround right
-        apply_filter(&m_trueavg[0],&m_filter[5][0],&output[5][0]);  // lfe
+        // add dimension control
+        yfs = clamp(yfs - V::set(dimension));
+
+        // add crossfeed control
+        xfs = clamp(xfs * (V::set(m_frontSeparation)*(one+yfs)*half + V::set(m_rearSeparation)*(one-yfs)*half));
+
+        // 3. generate frequency filters for each output channel
+        // the sum of all channel volumes must be 1.0
+        V left = (one-xfs)*half;
+        V right = (one+xfs)*half;
+        V front = (one+yfs)*half;
+        V back = (one-yfs)*half;
+        V width = V::set(center_width);
+        V spread = V::set(1-center_width);
+        V level = V::set(m_surroundLevel);
+        std::array<V,5> volume {
+            front * (left * width + vmax(zero,-xfs) * spread),  // left
+            front * V::set(center_level)*((one-vabs(xfs)) * spread), // center
+            front * (right * width + vmax(zero, xfs) * spread), // right
+            linear ? back * level * left                        // left surround
+                   : back * level*vmax(zero,vmin(one,((one-(xfs/V::set(m_surroundBalance)))*half))),
+            linear ? back * level * right                       // right surround
+                   : back * level*vmax(zero,vmin(one,((one+(xfs/V::set(m_surroundBalance)))*half)))
+        };
+
+        // adapt the prior filter
+        V keep = V::set(1-adaption_rate);
+        V rate = V::set(adaption_rate);
+        for (unsigned c=0;c<5;c++)
+            (keep*V::load(&m_filter[c][f]) + rate*volume[c]).store(&m_filter[c][f]);
+
+        // ... and build the signal which we want to position,
+        // with the amplitude of both channels at the phase of each
+        V scaleL = ampSum / vmax(ampL, V::set(1e-30F));
+        V scaleR = ampSum / vmax(ampR, V::set(1e-30F));
+        auto validL = V::set(1e-30F) < ampL;
+        auto validR = V::set(1e-30F) < ampR;
+        select(validL, reL*scaleL, ampSum).store(&m_frontL[0][f]);
+        select(validL, imL*scaleL, zero).store(&m_frontL[1][f]);
+        select(validR, reR*scaleR, ampSum).store(&m_frontR[0][f]);
+        select(validR, imR*scaleR, zero).store(&m_frontR[1][f]);
     }
 
-#define FASTER_CALC
     // map from amplitude difference and phase difference to yfs
-    static inline double get_yfs(double ampDiff, double phaseDiff) {
-        double x = 1-(((1-sqr(ampDiff))*phaseDiff)/PI*2);
-#ifdef FASTER_CALC
-        double tanX = tan(x);
-        return 0.16468622925824683 + 0.5009268347818189*x - 0.06462757726992101*x*x
-            + 0.09170680403453149*x*x*x + 0.2617754892323973*tanX - 0.04180413533856156*sqr(tanX);
-#else
-        return 0.16468622925824683 + 0.5009268347818189*x - 0.06462757726992101*x*x
-            + 0.09170680403453149*x*x*x + 0.2617754892323973*tan(x) - 0.04180413533856156*sqr(tan(x));
-#endif
+    template <class V> static inline V get_yfs(V ampDiff, V phaseDiff) {
+        V x = V::set(1)-(((V::set(1)-sqr(ampDiff))*phaseDiff)*V::set(2/PI));
+        V tanX = fast_tan(x);
+        return V::set(0.16468622925824683) + V::set(0.5009268347818189)*x - V::set(0.06462757726992101)*x*x
+            + V::set(0.09170680403453149)*x*x*x + V::set(0.2617754892323973)*tanX - V::set(0.04180413533856156)*sqr(tanX);
     }
 
     // map from amplitude difference and yfs to xfs
-    static inline double get_xfs(double ampDiff, double yfs) {
-        double x=ampDiff;
-        double y=yfs;
-#ifdef FASTER_CALC
-        double tanX = tan(x);
-        double tanY = tan(y);
-        double asinX = asin(x);
-        double sinX = sin(x);
-        double sinY = sin(y);
-        double x3 = x*x*x;
-        double y2 = y*y;
-        double y3 = y*y2;
-        return 2.464833559224702*x - 423.52131153259404*x*y + 
-            67.8557858606918*x3*y + 788.2429425544392*x*y2 - 
-            79.97650354902909*x3*y2 - 513.8966153850349*x*y3 + 
-            35.68117670186306*x3*y3 + 13867.406173420834*y*asinX - 
-            2075.8237075786396*y2*asinX - 908.2722068360281*y3*asinX - 
-            12934.654772878019*asinX*sinY - 13216.736529661162*y*tanX + 
-            1288.6463247741938*y2*tanX + 1384.372969378453*y3*tanX + 
-            12699.231471126128*sinY*tanX + 95.37131275594336*sinX*tanY - 
-            91.21223198407546*tanX*tanY;
-#else
-        return 2.464833559224702*x - 423.52131153259404*x*y + 
-            67.8557858606918*x*x*x*y + 788.2429425544392*x*y*y - 
-            79.97650354902909*x*x*x*y*y - 513.8966153850349*x*y*y*y + 
-            35.68117670186306*x*x*x*y*y*y + 13867.406173420834*y*asin(x) - 
-            2075.8237075786396*y*y*asin(x) - 908.2722068360281*y*y*y*asin(x) - 
-            12934.654772878019*asin(x)*sin(y) - 13216.736529661162*y*tan(x) + 
-            1288.6463247741938*y*y*tan(x) + 1384.372969378453*y*y*y*tan(x) + 
-            12699.231471126128*sin(y)*tan(x) + 95.37131275594336*sin(x)*tan(y) - 
-            91.21223198407546*tan(x)*tan(y);
-#endif
+    // the big y*asin(x), y*tan(x) and sin(y) terms nearly cancel, so they are
+    // collected with sin(y) taken as y + (sin(y)-y) to keep float's rounding
+    // from showing
+    template <class V> static inline V get_xfs(V ampDiff, V yfs) {
+        V x=ampDiff;
+        V y=yfs;
+        V tanX = fast_tan(x);
+        V tanY = fast_tan(y);
+        V asinX = fast_asin(x);
+        V sinX = fast_sin(x);
+        V sinYminusY = fast_sin_minus_x(y);
+        V x3 = x*x*x;
+        V y2 = y*y;
+        V y3 = y*y2;
+        V asinCoeff = V::set(13867.406173420834-12934.654772878019)*y - V::set(2075.8237075786396)*y2 -
+            V::set(908.2722068360281)*y3 - V::set(12934.654772878019)*sinYminusY;
+        V tanCoeff = V::set(12699.231471126128-13216.736529661162)*y + V::set(1288.6463247741938)*y2 +
+            V::set(1384.372969378453)*y3 + V::set(12699.231471126128)*sinYminusY;
+        return V::set(2.464833559224702)*x - V::set(423.52131153259404)*x*y +
+            V::set(67.8557858606918)*x3*y + V::set(788.2429425544392)*x*y2 -
+            V::set(79.97650354902909)*x3*y2 - V::set(513.8966153850349)*x*y3 +
+            V::set(35.68117670186306)*x3*y3 + asinX*asinCoeff + tanX*tanCoeff +
+            V::set(95.37131275594336)*sinX*tanY - V::set(91.21223198407546)*tanX*tanY;
     }
 
-    // filter the complex source signal and add it to target
-    void apply_filter(cfloat *signal, const float *flt, float *target) {
+    // filter a mix of the positioned left and right signals, or of the
+    // unpositioned ones if raw, and add it to target
+    void apply_filter(cfloat mixL, cfloat mixR, bool raw, const float *flt, float *target) {
         // filter the signal
-        for (unsigned f=0;f<=m_halfN;f++) {
-            m_src[f][0] = signal[f].real() * flt[f];
-            m_src[f][1] = signal[f].imag() * flt[f];
-        }
-#ifdef USE_FFTW3
-        // transform into time domain
-        fftwf_execute(m_store);
+        float* pSrc = m_fft->m_src;
+        simd_for(m_halfN, [&](auto v, unsigned f) {
+            using V = decltype(v);
+            V reL, imL, reR, imR;
+            if (raw) {
+                V::load2(&m_fft->m_dftL[2*f], reL, imL);
+                V::load2(&m_fft->m_dftR[2*f], reR, imR);
+            } else {
+                reL = V::load(&m_frontL[0][f]);
+                imL = V::load(&m_frontL[1][f]);
+                reR = V::load(&m_frontR[0][f]);
+                imR = V::load(&m_frontR[1][f]);
+            }
+            V re = V::set(mixL.real())*reL - V::set(mixL.imag())*imL +
+                   V::set(mixR.real())*reR - V::set(mixR.imag())*imR;
+            V im = V::set(mixL.real())*imL + V::set(mixL.imag())*reL +
+                   V::set(mixR.real())*imR + V::set(mixR.imag())*reR;
+            V gain = V::load(&flt[f]);
+            V::store2(&pSrc[2*f], re*gain, im*gain);
+        });
 
-        float* pT1   = &target[m_currentBuf*m_halfN];
-        float* pWnd1 = &m_wnd[0];
-        float* pDst1 = &m_dst[0];
-        float* pT2   = &target[(m_currentBuf^1)*m_halfN];
-        float* pWnd2 = &m_wnd[m_halfN];
-        float* pDst2 = &m_dst[m_halfN];
-        // add the result to target, windowed
-        for (unsigned int k=0;k<m_halfN;k++)
-        {
-            // 1st part is overlap add
-            *pT1++ += *pWnd1++ * *pDst1++;
-            // 2nd part is set as has no history
-            *pT2++  = *pWnd2++ * *pDst2++;
-        }
-#else
-        // enforce odd symmetry
-        for (unsigned f=1;f<m_halfN;f++) {
-            m_src[m_n-f][0] = m_src[f][0];
-            m_src[m_n-f][1] = -m_src[f][1];   // complex conjugate
-        }
-        av_fft_permute(m_fftContextReverse, (FFTComplex*)&m_src[0]);
-        av_fft_calc(m_fftContextReverse, (FFTComplex*)&m_src[0]);
+        // transform into time domain
+        m_fft->inverse();
 
         float* pT1   = &target[m_currentBuf*m_halfN];
-        float* pWnd1 = &m_wnd[0];
-        float* pDst1 = &m_src[0][0];
         float* pT2   = &target[(m_currentBuf^1)*m_halfN];
-        float* pWnd2 = &m_wnd[m_halfN];
-        float* pDst2 = &m_src[m_halfN][0];
+        const float* pWnd1 = &m_outWnd[0];
+        const float* pWnd2 = &m_outWnd[m_halfN];
+        const float* pDst1 = &m_fft->m_dst[0];
+        const float* pDst2 = &m_fft->m_dst[m_halfN];
         // add the result to target, windowed
-        for (unsigned int k=0;k<m_halfN;k++)
-        {
+        simd_for(m_halfN, [&](auto v, unsigned k) {
+            using V = decltype(v);
             // 1st part is overlap add
-            *pT1++ += *pWnd1++ * *pDst1; pDst1 += 2;
+            (V::load(&pT1[k]) + V::load(&pWnd1[k]) * V::load(&pDst1[k])).store(&pT1[k]);
             // 2nd part is set as has no history
-            *pT2++  = *pWnd2++ * *pDst2; pDst2 += 2;
-        }
-#endif
-    }
-
-#ifndef USE_FFTW3
-    /**
-     *  * Do the permutation needed BEFORE calling ff_fft_calc()
-     *  special for freesurround that also copies
-     *   */
-    void ff_fft_permuteRC(FFTContext *s, FFTSample *r, FFTComplex *z)
-    {
-        int j, k, np;
-        const uint16_t *revtab = s->revtab;
-
-        /* reverse */
-        np = 1 << s->nbits;
-        for(j=0;j<np;j++) {
-            k = revtab[j];
-            z[k].re = r[j];
-            z[k].im = 0.0;
-        }
+            (V::load(&pWnd2[k]) * V::load(&pDst2[k])).store(&pT2[k]);
+        });
     }
 
-    /**
-     *  * Do the permutation needed BEFORE calling ff_fft_calc()
-     *  special for freesurround that also copies and 
-     *  discards im component as it should be 0
-     *   */
-    void ff_fft_permuteCR(FFTContext *s, FFTComplex *z, FFTSample *r)
-    {
-        int j, k, np;
-        const uint16_t *revtab = s->revtab;
-
-        /* reverse */
-        np = 1 << s->nbits;
-        for(j=0;j<np;j++) {
-            k = revtab[j];
-            if (k < j) {
-                r[k] = z[j].re;
-                r[j] = z[k].re;
-            }
-        }
-    }
-#endif
-
     unsigned int m_n;                    // the block size
     unsigned int m_halfN;                // half block size precalculated
-#ifdef USE_FFTW3
-    // FFTW data structures
-    float *m_lt,*m_rt,*m_dst;              // left total, right total (source arrays), destination array
-    fftwf_complex *m_dftL,*m_dftR,*m_src;  // intermediate arrays (FFTs of lt & rt, processing source)
-    fftwf_plan m_loadL,m_loadR,m_store;    // plans for loading the data into the intermediate format and back
-#else
-    FFTContext *m_fftContextForward, *m_fftContextReverse;
-    FFTSample *m_lt,*m_rt;                 // left total, right total (source arrays), destination array
-    FFTComplexArray *m_dftL,*m_dftR,*m_src;// intermediate arrays (FFTs of lt & rt, processing source)
-#endif
+    std::unique_ptr<fft_plans> m_fft;    // FFT plans and buffers
     // buffers
-    std::vector<cfloat> m_frontL,m_frontR,m_avg,m_surL,m_surR; // the signal (phase-corrected) in the frequency domain
-    std::vector<cfloat> m_trueavg;       // for lfe generation
-    std::vector<float> m_xFs,m_yFs;      // the feature space positions for each frequency bin
+    std::array<std::vector<float>,2> m_frontL,m_frontR; // the signal (phase-corrected) in the frequency domain, re and im
     std::vector<float> m_wnd;            // the window function, precalculated
+    std::vector<float> m_outWnd;         // the window function for the output, scaled for the inverse transform
     std::array<std::vector<float>,6> m_filter;      // a frequency filter for each output channel
     std::array<std::vector<float>,2> m_inbuf;       // the sliding input buffers
     std::array<std::vector<float>,6> m_outbuf;      // the sliding output buffers
@@ -554,8 +723,8 @@ private:
     float m_surroundLow     {0.0F};      // low surround mixing coefficient (e.g. 0.8165/0.5774)
     float m_surroundBalance {0.0F};      // the xfs balance that follows from the coeffs
     float m_surroundLevel   {0.0F};      // gain for the surround channels (follows from the coeffs
-    float m_phaseOffsetL    {0.0F};      // phase shifts to be applied to the rear channels
-    float m_phaseOffsetR    {0.0F};      // phase shifts to be applied to the rear channels
+    cfloat m_phaseOffsetL   {1.0F};      // phase shifts to be applied to the rear channels
+    cfloat m_phaseOffsetR   {1.0F};      // phase shifts to be applied to the rear channels
     float m_frontSeparation {0.0F};      // front stereo separation
     float m_rearSeparation  {0.0F};      // rear stereo separation
     bool  m_linearSteering  {false};     // whether the steering should be linear or not
@@ -1,6 +1,12 @@
+#include <iterator>
 #include <map>
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
 #include <QUrl>
 
 #include "mythcorecontext.h"
@@ -9,6 +15,8 @@
 #include "remoteutil.h"
 #include "mythcontext.h"
 #include "mythlogging.h"
+#include "mythchrono.h"
+#include "mythdirs.h"
 #include "videoutils.h"
 #include "storagegroup.h"
 
@@ -42,41 +50,205 @@ namespace
         }
     };
 
-    bool scan_dir(const QString &start_path, DirectoryHandler *handler,
-                  const ext_lookup &ext_settings)
+    /// The entries of a directory, names of subdirectories end with '/'
+    struct DirListing
     {
-        QDir d(start_path);
+        qint64      m_modTime  {0};     ///< ms since the epoch
+        qint64      m_lastUsed {0};     ///< secs since the epoch
+        QStringList m_entries;
+    };
 
-        // Return a fail if directory doesn't exist.
+    /**
+     *  \brief Listings of local video directories, kept between runs so
+     *         that a rescan only reads directories that have changed.
+     *
+     *   A listing is used as long as the directory modified time is the same.
+     *   Directories changed in the last few seconds aren't cached, as a
+     *   further change within the file system's time resolution could go
+     *   unnoticed.
+     */
+    class VideoDirIndex
+    {
+      public:
+        static VideoDirIndex &GetInstance(void)
+        {
+            static VideoDirIndex s_index;
+            return s_index;
+        }
+
+        bool List(const QString &path, QStringList &entries);
+        void Save(void);
+
+      private:
+        VideoDirIndex() = default;
+        void Load(void);
+
+        static constexpr quint32 kVersion { 1 };
+        /// Unused listings are dropped after this long
+        static constexpr std::chrono::seconds kMaxUnused { 30 * 24h };
+        /// Directories changed more recently than this aren't cached
+        static constexpr std::chrono::milliseconds kRacyInterval { 2s };
+
+        QMutex                       m_lock;
+        QHash<QString, DirListing>   m_dirs;
+        bool                         m_loaded {false};
+        bool                         m_dirty  {false};
+    };
+
+    /// \return false if the directory doesn't exist
+    bool VideoDirIndex::List(const QString &path, QStringList &entries)
+    {
+        QFileInfo info(path);
+        if (!info.isDir())
+            return false;
+        qint64 modTime = info.lastModified().toMSecsSinceEpoch();
+        qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+        {
+            QMutexLocker locker(&m_lock);
+            if (!m_loaded)
+                Load();
+
+            auto it = m_dirs.find(path);
+            if (it != m_dirs.end() && it->m_modTime == modTime)
+            {
+                it->m_lastUsed = now / 1000;
+                entries = it->m_entries;
+                return true;
+            }
+        }
+
+        QDir d(path);
         if (!d.exists())
             return false;
-        
         d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
         QFileInfoList list = d.entryInfoList();
+
+        entries.clear();
+        entries.reserve(list.size());
+        for (const auto& entry : qAsConst(list))
+            entries << (entry.isDir() ? entry.fileName() + "/"
+                                      : entry.fileName());
+
+        QMutexLocker locker(&m_lock);
+        if (now - modTime < kRacyInterval.count())
+        {
+            m_dirty |= m_dirs.remove(path) > 0;
+            return true;
+        }
+        DirListing &listing = m_dirs[path];
+        listing.m_modTime  = modTime;
+        listing.m_lastUsed = now / 1000;
+        listing.m_entries  = entries;
+        m_dirty = true;
+        return true;
+    }
+
+    /// \brief Must be called with m_lock held
+    void VideoDirIndex::Load(void)
+    {
+        m_loaded = true;
+
+        QFile file(GetCacheDir() + "/videodirindex");
+        if (!file.open(QIODevice::ReadOnly))
+            return;
+
+        QDataStream stream(&file);
+        quint32 version = 0;
+        stream >> version;
+        if (version != kVersion)
+            return;
+
+        qint32 count = 0;
+        stream >> count;
+        for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+        {
+            QString path;
+            DirListing listing;
+            stream >> path >> listing.m_modTime >> listing.m_lastUsed
+                   >> listing.m_entries;
+            m_dirs.insert(path, listing);
+        }
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            LOG(VB_GENERAL, LOG_WARNING,
+                "Video directory index is corrupt, rescanning all directories");
+            m_dirs.clear();
+            return;
+        }
+
+        LOG(VB_FILE, LOG_INFO,
+            QString("Loaded %1 video directory listings").arg(m_dirs.size()));
+    }
+
+    void VideoDirIndex::Save(void)
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_dirty)
+            return;
+
+        qint64 oldest = QDateTime::currentSecsSinceEpoch() - kMaxUnused.count();
+        for (auto it = m_dirs.begin(); it != m_dirs.end(); )
+            it = (it->m_lastUsed < oldest) ? m_dirs.erase(it) : std::next(it);
+
+        QDir().mkpath(GetCacheDir());
+        QSaveFile file(GetCacheDir() + "/videodirindex");
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            LOG(VB_GENERAL, LOG_ERR, QString("Failed to write %1: %2")
+                .arg(file.fileName(), file.errorString()));
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream << kVersion << static_cast<qint32>(m_dirs.size());
+        for (auto it = m_dirs.cbegin(); it != m_dirs.cend(); ++it)
+        {
+            stream << it.key() << it->m_modTime << it->m_lastUsed
+                   << it->m_entries;
+        }
+
+        if (file.commit())
+            m_dirty = false;
+    }
+
+    bool scan_dir(const QString &start_path, DirectoryHandler *handler,
+                  const ext_lookup &ext_settings, const QStringList &list)
+    {
         // An empty directory is fine
         if (list.isEmpty())
             return true;
 
-        QDir dir_tester;
+        QDir d(start_path);
+        VideoDirIndex &index = VideoDirIndex::GetInstance();
 
         for (const auto& entry : qAsConst(list))
         {
-            if (entry.fileName() == "Thumbs.db")
+            bool isDir = entry.endsWith('/');
+            QString fileName = isDir ? entry.left(entry.size() - 1) : entry;
+            QString absoluteFilePath = d.absoluteFilePath(fileName);
+            QString suffix = QFileInfo(fileName).suffix();
+
+            if (fileName == "Thumbs.db")
                 continue;
 
-            if (!entry.isDir() &&
-                ext_settings.extension_ignored(entry.suffix())) continue;
+            if (!isDir &&
+                ext_settings.extension_ignored(suffix)) continue;
 
             bool add_as_file = true;
 
-            if (entry.isDir())
+            if (isDir)
             {
                 add_as_file = false;
 
-                dir_tester.setPath(entry.absoluteFilePath() + "/VIDEO_TS");
-                QDir bd_dir_tester;
-                bd_dir_tester.setPath(entry.absoluteFilePath() + "/BDMV");
-                if (dir_tester.exists() || bd_dir_tester.exists())
+                // Since we are dealing with a subdirectory failure is fine,
+                // so we'll just ignore the failue and continue
+                QStringList sublist;
+                bool listed = index.List(absoluteFilePath, sublist);
+
+                if (sublist.contains("VIDEO_TS/") || sublist.contains("VIDEO_TS") ||
+                    sublist.contains("BDMV/") || sublist.contains("BDMV"))
                 {
                     add_as_file = true;
                 }
@@ -84,15 +256,14 @@ namespace
                 {
 #if 0
                     LOG(VB_GENERAL, LOG_DEBUG, 
-                        QString(" -- Dir : %1").arg(entry.!absoluteFilePath()));
+                        QString(" -- Dir : %1").arg(absoluteFilePath));
 #endif
                     DirectoryHandler *dh =
-                            handler->newDir(entry.fileName(),
-                                            entry.absoluteFilePath());
+                            handler->newDir(fileName, absoluteFilePath);
 
-                    // Since we are dealing with a subdirectory failure is fine,
-                    // so we'll just ignore the failue and continue
-                    (void) scan_dir(entry.absoluteFilePath(), dh, ext_settings);
+                    if (listed)
+                        (void) scan_dir(absoluteFilePath, dh, ext_settings,
+                                        sublist);
                 }
             }
 
@@ -100,10 +271,9 @@ namespace
             {
 #if 0
                 LOG(VB_GENERAL, LOG_DEBUG,
-                    QString(" -- File : %1").arg(entry.fileName()));
+                    QString(" -- File : %1").arg(fileName));
 #endif
-                handler->handleFile(entry.fileName(), entry.absoluteFilePath(),
-                                    entry.suffix(), "");
+                handler->handleFile(fileName, absoluteFilePath, suffix, "");
             }
         }
 
@@ -237,7 +407,15 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        // Return a fail if directory doesn't exist.
+        VideoDirIndex &index = VideoDirIndex::GetInstance();
+        QStringList list;
+        bool listed = index.List(start_path, list);
+        if (listed)
+            (void) scan_dir(start_path, handler, extlookup, list);
+        index.Save();
+
+        if (!listed)
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
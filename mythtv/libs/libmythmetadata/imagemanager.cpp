@@ -2,6 +2,7 @@
 
 #include <QImageReader>
 #include <QRunnable>
+#include <QSet>
 #include <utility>
 
 #include "dbaccess.h"  // for FileAssociations
@@ -1705,9 +1706,17 @@ QStringList ImageHandler<DBFS>::HandleCreateThumbnails
     ImageList dirs;
     DBFS::GetImages(message.at(1), files, dirs);
 
+    QSet<int> shownDirs;
     for (const auto& im : qAsConst(files))
+    {
         // notify clients when done; highest priority
         m_thumbGen->CreateThumbnail(im, priority, true);
+        shownDirs.insert(im->m_parentId);
+    }
+
+    // Scanner thumbnails of the rest of the dir are likely to be viewed next
+    for (int dirId : qAsConst(shownDirs))
+        m_thumbGen->PrioritiseDir(dirId);
 
     return QStringList("OK");
 }
@@ -287,6 +287,11 @@ protected:
 PictureMetaData::PictureMetaData(const QString &filePath)
     : ImageMetaData(filePath), m_image(nullptr)
 {
+    // XMP parser setup isn't thread-safe. Do it once, before the scanner
+    // reads files in parallel
+    static const bool s_xmpReady = Exiv2::XmpParser::initialize();
+    Q_UNUSED(s_xmpReady);
+
     try
     {
         m_image = Exiv2::ImageFactory::open(filePath.toStdString());
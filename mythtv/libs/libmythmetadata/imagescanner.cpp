@@ -1,10 +1,69 @@
 #include "imagescanner.h"
 
+#include <algorithm>
+
+#include <QRunnable>
+
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for events
+#include "mythdb.h"           // for DBError
 
 #include "imagemetadata.h"
 
+//! Number of new/modified files whose metadata is read & written together
+static constexpr int kMetadataBatchSize { 64 };
+
+//! Unchanged dirs are listed again after this long
+static constexpr std::chrono::seconds kFullScanInterval { 24h };
+
+
+/*!
+  \brief Read image date, orientation, comment from metadata
+  \param[in] path Image filepath
+  \param[in] type Picture or Video
+  \param[out] comment Image comment
+  \param[out] time Time/date of image capture
+  \param[out] orientation Exif orientation code
+ */
+static void PopulateMetadata(
+    const QString &path, int type, QString &comment,
+    std::chrono::seconds &time,
+    int &orientation)
+{
+    // Set orientation, date, comment from file meta data
+    ImageMetaData *metadata = (type == kImageFile)
+            ? ImageMetaData::FromPicture(path)
+            : ImageMetaData::FromVideo(path);
+
+    orientation  = metadata->GetOrientation();
+    comment      = metadata->GetComment().simplified();
+    QDateTime dt = metadata->GetOriginalDateTime();
+    time         = (dt.isValid()) ? std::chrono::seconds(dt.toSecsSinceEpoch()) : 0s;
+
+    delete metadata;
+}
+
+
+//! Reads the metadata of one file on the scanner's thread pool
+class ImageMetadataTask : public QRunnable
+{
+public:
+    ImageMetadataTask(ImagePtr im, QString path, int &orientation)
+        : m_im(std::move(im)), m_path(std::move(path)), m_orientation(orientation) {}
+
+    void run() override // QRunnable
+    {
+        PopulateMetadata(m_path, m_im->m_type,
+                         m_im->m_comment, m_im->m_date, m_orientation);
+    }
+
+private:
+    ImagePtr m_im;
+    QString  m_path;
+    int     &m_orientation;
+};
+
+
 /*!
  \brief Constructor
  \param dbfs Database/filesystem adapter
@@ -165,15 +224,37 @@ void ImageScanThread<DBFS>::run()
 
             bool firstScan = m_dbFileMap.isEmpty();
 
-            // Pause thumb generator so that scans are fast as possible
-            m_thumb.PauseBackground(true);
+            // Files rewritten in place don't change the dir modified time,
+            // so every dir is listed once a day. Dirs that are now excluded,
+            // or no longer excluded, are only detected by listing them too.
+            bool exclusionsChanged = SetExclusions();
+            QDateTime now = QDateTime::currentDateTimeUtc();
+            m_incremental = !firstScan && !exclusionsChanged
+                    && m_lastFullScan.isValid()
+                    && m_lastFullScan.secsTo(now) < kFullScanInterval.count();
+            if (!m_incremental)
+                m_lastFullScan = now;
+
+            LOG(VB_FILE, LOG_INFO, QString("Scan is %1")
+                .arg(m_incremental ? "incremental" : "full"));
+
+            // Index the Db so that the contents of unchanged dirs are known
+            m_dbChildren.clear();
+            if (m_incremental)
+            {
+                for (const auto & im : qAsConst(m_dbDirMap))
+                    m_dbChildren.insert(im->m_parentId, im);
+                for (const auto & im : qAsConst(m_dbFileMap))
+                    m_dbChildren.insert(im->m_parentId, im);
+            }
 
             // Adapter determines list of dirs to scan
             StringMap paths = m_dbfs.GetScanDirs();
 
-            CountFiles(paths.values());
+            CountFiles(paths.values(), m_incremental);
 
-            // Now start the actual syncronization
+            // Now start the actual syncronization. Thumbnails are generated
+            // as each batch of new files reaches the Db
             m_seenFile.clear();
             m_changedImages.clear();
             StringMap::const_iterator i = paths.constBegin();
@@ -183,8 +264,8 @@ void ImageScanThread<DBFS>::run()
                 ++i;
             }
 
-            // Release thumb generator asap
-            m_thumb.PauseBackground(false);
+            // Files already found are stored, even if the scan was interrupted
+            FlushPending();
 
             // Adding or updating directories has been completed.
             // The maps now only contain old directories & files that are not
@@ -200,6 +281,7 @@ void ImageScanThread<DBFS>::run()
             m_dbFileMap.clear();
             m_dbDirMap.clear();
             m_seenDir.clear();
+            m_dbChildren.clear();
 
             m_mutexProgress.lock();
             // (count == total) signals scan end
@@ -258,7 +340,8 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
     }
 
     // Create directory node
-    int id = SyncDirectory(dirInfo, devId, base, parentId);
+    bool unchanged = false;
+    int id = SyncDirectory(dirInfo, devId, base, parentId, unchanged);
     if (id == -1)
     {
         LOG(VB_FILE, LOG_INFO,
@@ -266,6 +349,13 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
         return;
     }
 
+    // Its contents are already in the Db
+    if (unchanged && m_incremental)
+    {
+        SkipDirectory(dirInfo, id, devId, base);
+        return;
+    }
+
     // Sync its contents
     QFileInfoList entries = dir.entryInfoList();
     for (const auto & fileInfo : qAsConst(entries))
@@ -288,6 +378,8 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
 
             QMutexLocker locker(&m_mutexProgress);
             ++m_progressCount;
+            // Incremental totals are estimated from the Db
+            m_progressTotalCount = std::max(m_progressTotalCount, m_progressCount);
 
             // Throttle updates
             if (m_bcastTimer.elapsed() > 250)
@@ -309,11 +401,16 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
  \param devId Id of device containing dir
  \param base Device path
  \param parentId Db id of the dir's parent
+ \param[out] unchanged True if the dir is in the Db with the same modified time
  \return int Db id of this dir in db
 */
 template <class DBFS>
- int ImageScanThread<DBFS>::SyncDirectory(const QFileInfo &dirInfo, int devId, const QString &base, int parentId)
+ int ImageScanThread<DBFS>::SyncDirectory(const QFileInfo &dirInfo, int devId,
+                                          const QString &base, int parentId,
+                                          bool &unchanged)
 {
+    unchanged = false;
+
     QString absFilePath = dirInfo.absoluteFilePath();
 
     LOG(VB_FILE, LOG_DEBUG, QString("Syncing directory %1").arg(absFilePath));
@@ -345,6 +442,11 @@ template <class DBFS>
             // Note modified images
             m_changedImages << QString::number(dir->m_id);
         }
+        // Clones have to be listed to amalgamate their contents
+        else
+        {
+            unchanged = dbDir->m_type != kCloneDir;
+        }
 
         // Remove the entry from the dbList
         m_dbDirMap.remove(dir->m_filePath);
@@ -400,30 +502,50 @@ template <class DBFS>
 
 
 /*!
-  \brief Read image date, orientation, comment from metadata
-  \param[in] path Image filepath
-  \param[in] type Picture or Video
-  \param[out] comment Image comment
-  \param[out] time Time/date of image capture
-  \param[out] orientation Exif orientation code
- */
+ \brief Accounts for the contents of an unchanged dir without listing it
+ \details Files are assumed to be unchanged as the dir modified time changes
+ whenever one is added, removed or renamed. Subdirs are synced as normal.
+ \param dirInfo Dir info
+ \param id Db id of the dir
+ \param devId Id of device containing dir
+ \param base Device path
+*/
 template <class DBFS>
-void ImageScanThread<DBFS>::PopulateMetadata(
-    const QString &path, int type, QString &comment,
-    std::chrono::seconds &time,
-    int &orientation)
+void ImageScanThread<DBFS>::SkipDirectory(const QFileInfo &dirInfo, int id,
+                                          int devId, const QString &base)
 {
-    // Set orientation, date, comment from file meta data
-    ImageMetaData *metadata = (type == kImageFile)
-            ? ImageMetaData::FromPicture(path)
-            : ImageMetaData::FromVideo(path);
+    LOG(VB_FILE, LOG_DEBUG,
+        QString("Unchanged directory %1").arg(dirInfo.absoluteFilePath()));
 
-    orientation  = metadata->GetOrientation();
-    comment      = metadata->GetComment().simplified();
-    QDateTime dt = metadata->GetOriginalDateTime();
-    time         = (dt.isValid()) ? std::chrono::seconds(dt.toSecsSinceEpoch()) : 0s;
+    QList<ImagePtr> children = m_dbChildren.values(id);
+    for (const auto & child : qAsConst(children))
+    {
+        if (!IsScanning())
+            return;
 
-    delete metadata;
+        QString absFilePath = dirInfo.absoluteFilePath() + "/"
+                + DBFS::BaseNameOf(child->m_filePath);
+
+        if (child->IsDirectory())
+        {
+            // Only dirs still to be synced
+            if (m_dbDirMap.contains(child->m_filePath))
+                SyncSubTree(QFileInfo(absFilePath), id, devId, base);
+        }
+        else if (m_dbFileMap.remove(child->m_filePath) > 0)
+        {
+            // Detect duplicates
+            m_seenFile.insert(child->m_filePath, absFilePath);
+
+            QMutexLocker locker(&m_mutexProgress);
+            ++m_progressCount;
+            m_progressTotalCount = std::max(m_progressTotalCount, m_progressCount);
+
+            // Throttle updates
+            if (m_bcastTimer.elapsed() > 250)
+                Broadcast(m_progressCount);
+        }
+    }
 }
 
 
@@ -481,22 +603,19 @@ void ImageScanThread<DBFS>::SyncFile(const QFileInfo &fileInfo, int devId,
         im->m_id       = dbIm->m_id;
         im->m_isHidden = dbIm->m_isHidden;
 
-        // Set date, comment from file meta data
-        int fileOrient = 0;
-        PopulateMetadata(absFilePath, im->m_type,
-                         im->m_comment, im->m_date, fileOrient);
-
-        // Reset file orientation, retaining existing setting
-        int currentOrient = Orientation(dbIm->m_orientation).GetCurrent(false);
-        im->m_orientation = Orientation(currentOrient, fileOrient).Composite();
+        PendingFile file;
+        file.m_dbOrientation = dbIm->m_orientation;
+        file.m_isNew         = false;
 
         // Remove it from removed list
         m_dbFileMap.remove(im->m_filePath);
         // Note modified images
         m_changedImages << QString::number(im->m_id);
 
-        // Update db
-        m_dbfs.UpdateDbImage(*im);
+        // Db is updated once metadata has been read
+        file.m_image   = im;
+        file.m_absPath = absFilePath;
+        m_pending.append(file);
     }
     else if (m_seenFile.contains(im->m_filePath))
     {
@@ -509,26 +628,82 @@ void ImageScanThread<DBFS>::SyncFile(const QFileInfo &fileInfo, int devId,
         // New images will be assigned an id by the db AUTO-INCREMENT
         LOG(VB_FILE, LOG_INFO,  QString("New file %1").arg(absFilePath));
 
-        // Set date, comment from file meta data
-        int fileOrient = 0;
-        PopulateMetadata(absFilePath, im->m_type,
-                         im->m_comment, im->m_date, fileOrient);
-
-        // Set file orientation
-        im->m_orientation = Orientation(fileOrient, fileOrient).Composite();
-
-        // Update db (Set id for thumb generator)
-        im->m_id = m_dbfs.InsertDbImage(*im);
+        // Db is updated once metadata has been read
+        PendingFile file;
+        file.m_image   = im;
+        file.m_absPath = absFilePath;
+        m_pending.append(file);
     }
 
     // Detect duplicate filepaths in SG
     m_seenFile.insert(im->m_filePath, absFilePath);
 
-    // Populate absolute filename so that thumbgen doesn't need to locate file
-    im->m_filePath = absFilePath;
+    if (m_pending.size() >= kMetadataBatchSize)
+        FlushPending();
+}
+
+
+/*!
+ \brief Reads metadata of pending files, stores them & generates their thumbnails
+ \details Metadata is read by a thread pool, as Exif/video parsing dominates
+ scans of new images. The Db is then updated in a single transaction.
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::FlushPending()
+{
+    if (m_pending.isEmpty())
+        return;
+
+    // Set date, comment from file meta data
+    for (auto & file : m_pending)
+        m_metadataPool.start(new ImageMetadataTask(file.m_image, file.m_absPath,
+                                                   file.m_fileOrientation),
+                             "ImageMetadata");
+    m_metadataPool.waitForDone();
+
+    // The adapter's queries re-use the connection held by this query
+    MSqlQuery query(MSqlQuery::InitCon());
+    bool transaction = query.exec("START TRANSACTION");
+    if (!transaction)
+        MythDB::DBError("Image scan start transaction", query);
+
+    for (auto & file : m_pending)
+    {
+        ImagePtr im = file.m_image;
+        if (file.m_isNew)
+        {
+            // Set file orientation
+            im->m_orientation = Orientation(file.m_fileOrientation,
+                                            file.m_fileOrientation).Composite();
 
-    // Ensure thumbnail exists.
-    m_thumb.CreateThumbnail(im);
+            // Update db (Set id for thumb generator)
+            im->m_id = m_dbfs.InsertDbImage(*im);
+        }
+        else
+        {
+            // Reset file orientation, retaining existing setting
+            int currentOrient = Orientation(file.m_dbOrientation).GetCurrent(false);
+            im->m_orientation = Orientation(currentOrient,
+                                            file.m_fileOrientation).Composite();
+
+            // Update db
+            m_dbfs.UpdateDbImage(*im);
+        }
+    }
+
+    if (transaction && !query.exec("COMMIT"))
+        MythDB::DBError("Image scan commit", query);
+
+    for (auto & file : m_pending)
+    {
+        // Populate absolute filename so that thumbgen doesn't need to locate file
+        file.m_image->m_filePath = file.m_absPath;
+
+        // Ensure thumbnail exists.
+        m_thumb.CreateThumbnail(file.m_image);
+    }
+
+    m_pending.clear();
 }
 
 
@@ -562,11 +737,11 @@ void ImageScanThread<DBFS>::CountTree(QDir &dir)
 
 
 /*!
- \brief Counts images in a list of subtrees
- \param paths List of dir trees to scan
+ \brief Reads the exclusions setting
+ \return bool True if the exclusions have changed since the previous scan
 */
 template <class DBFS>
-void ImageScanThread<DBFS>::CountFiles(const QStringList &paths)
+bool ImageScanThread<DBFS>::SetExclusions()
 {
     // Get exclusions as comma-seperated list using glob chars * and ?
     QString excPattern = gCoreContext->GetSetting("GalleryIgnoreFilter", "");
@@ -578,22 +753,44 @@ void ImageScanThread<DBFS>::CountFiles(const QStringList &paths)
     excPattern.replace(",", "|");   // Convert list to OR's
 
     QString pattern = QString("^(%1)$").arg(excPattern);
-    m_exclusions = REGEXP(pattern);
 
     LOG(VB_FILE, LOG_DEBUG, QString("Exclude regexp is \"%1\"").arg(pattern));
 
+    bool changed = pattern != m_exclusions.pattern();
+    m_exclusions = REGEXP(pattern);
+    return changed;
+}
+
+
+/*!
+ \brief Counts images in a list of subtrees
+ \param paths List of dir trees to scan
+ \param incremental If true, the Db is assumed to be current rather than
+ walking the trees
+*/
+template <class DBFS>
+void ImageScanThread<DBFS>::CountFiles(const QStringList &paths, bool incremental)
+{
     // Lock counts until counting complete
     QMutexLocker locker(&m_mutexProgress);
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
 
-    // Use global image filters
-    QDir dir = m_dir;
-    for (const auto& sgDir : qAsConst(paths))
+    if (incremental)
     {
-        // Ignore missing dirs
-        if (dir.cd(sgDir))
-            CountTree(dir);
+        // Walking the trees would cost as much as the scan itself
+        m_progressTotalCount = m_dbFileMap.size();
+    }
+    else
+    {
+        // Use global image filters
+        QDir dir = m_dir;
+        for (const auto& sgDir : qAsConst(paths))
+        {
+            // Ignore missing dirs
+            if (dir.cd(sgDir))
+                CountTree(dir);
+        }
     }
     // 0 signifies a scan start
     Broadcast(0);
@@ -2,7 +2,11 @@
 //! \brief Synchronises image database to filesystem
 //! \details Detects supported pictures and videos and populates
 //! the image database with metadata for each, including directory structure.
-//! All images are passed to the associated thumbnail generator.
+//! Metadata of new & modified files is read by a thread pool and written to the
+//! database in batches, which are then passed to the associated thumbnail generator.
+//! Dirs whose modified time hasn't changed since the last scan are not listed;
+//! their files are assumed to be unchanged. A full scan is made every day, and
+//! whenever the exclusions change, to detect files that have been rewritten in place.
 //! Db images that have disappeared are notified to frontends so that they can clean up.
 //! Also clears database & removes devices (to prevent contention with running scans).
 //!
@@ -14,12 +18,16 @@
 
 #include <QFileInfo>
 #include <QDir>
+#include <QDateTime>
 #include <QElapsedTimer>
+#include <QMultiHash>
 
 #include <QRegularExpression>
 #define REGEXP QRegularExpression
 #define MATCHES(RE, SUBJECT) RE.match(SUBJECT).hasMatch()
 
+#include "mthreadpool.h"
+
 #include "imagethumbs.h"
 
 
@@ -44,17 +52,28 @@ protected:
 private:
     Q_DISABLE_COPY(ImageScanThread)
 
+    //! A new or modified file awaiting its metadata
+    struct PendingFile
+    {
+        ImagePtr m_image;
+        QString  m_absPath;
+        int      m_dbOrientation   {0};   //!< Orientation of a modified file
+        int      m_fileOrientation {0};   //!< Exif orientation, set by the pool
+        bool     m_isNew           {true};
+    };
+
     void SyncSubTree(const QFileInfo &dirInfo, int parentId, int devId,
                      const QString &base);
     int  SyncDirectory(const QFileInfo &dirInfo, int devId,
-                       const QString &base, int parentId);
-    void PopulateMetadata(const QString &path, int type, QString &comment,
-                          std::chrono::seconds &time,
-                          int &orientation);
+                       const QString &base, int parentId, bool &unchanged);
+    void SkipDirectory(const QFileInfo &dirInfo, int id, int devId,
+                       const QString &base);
     void SyncFile(const QFileInfo &fileInfo, int devId,
                   const QString &base, int parentId);
+    void FlushPending();
     void CountTree(QDir &dir);
-    void CountFiles(const QStringList &paths);
+    bool SetExclusions();
+    void CountFiles(const QStringList &paths, bool incremental);
     void Broadcast(int progress);
 
     using ClearTask = QPair<int, QString>;
@@ -76,6 +95,16 @@ private:
     NameHash    m_seenFile;
     //! Ids of dirs/files that have been updates/modified.
     QStringList m_changedImages;
+    //! Dirs & files in the Db from last scan, Map<Db parent id, Db Image>
+    QMultiHash<int, ImagePtr> m_dbChildren;
+    //! New/modified files waiting to be written to the Db
+    QList<PendingFile> m_pending;
+    //! Reads metadata of pending files
+    MThreadPool m_metadataPool {"ImageMetadata"};
+    //! Only unchanged dirs are skipped, and never during a full scan
+    bool        m_incremental {false};
+    //! Start of last full scan
+    QDateTime   m_lastFullScan;
 
     //! Elapsed time since last progress event generated
     QElapsedTimer m_bcastTimer;
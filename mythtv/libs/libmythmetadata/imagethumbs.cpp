@@ -91,6 +91,39 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
 }
 
 
+/*!
+ \brief Moves background tasks for images in a dir to the front of the queue
+ \details Used when a client is showing the dir, so that the scanner's thumbnails
+ for it are generated before those of the rest of the tree.
+ \param dirId Db id of the dir
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::PrioritiseDir(int dirId)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<TaskPtr> promoted;
+    QMutableMapIterator<int, TaskPtr> it(m_backgroundQ);
+    while (it.hasNext())
+    {
+        it.next();
+        TaskPtr task = it.value();
+        if (it.key() != kShownDirPriority && task
+                && !task->m_images.isEmpty()
+                && task->m_images.at(0)->m_parentId == dirId)
+        {
+            promoted << task;
+            it.remove();
+        }
+    }
+
+    for (const auto& task : qAsConst(promoted))
+    {
+        task->m_priority = kShownDirPriority;
+        m_backgroundQ.insert(kShownDirPriority, task);
+    }
+}
+
+
 /*!
   /brief Removes all tasks for a device from a task queue
  */
@@ -491,6 +524,20 @@ void ImageThumb<DBFS>::PauseBackground(bool pause)
 }
 
 
+/*!
+  \brief Generates the scanner's pending thumbnails of a dir first
+  \param dirId Db id of the dir being viewed
+ */
+template <class DBFS>
+void ImageThumb<DBFS>::PrioritiseDir(int dirId)
+{
+    if (m_imageThread)
+        m_imageThread->PrioritiseDir(dirId);
+    if (m_videoThread)
+        m_videoThread->PrioritiseDir(dirId);
+}
+
+
 // Must define the valid template implementations to generate code for the
 // instantiations (as they are defined in the cpp rather than header).
 // Otherwise the linker will fail with undefined references...
@@ -33,7 +33,8 @@ enum ImageThumbPriority {
     kUrgentPriority     = -10, //!< Scanner request needed to complete a scan
     kPicRequestPriority =  -7, //!< Client request to display an image thumbnail
     kDirRequestPriority =  -3, //!< Client request to display a directory thumbnail
-    kBackgroundPriority =   0  //!< Scanner background request
+    kBackgroundPriority =   0, //!< Scanner background request
+    kShownDirPriority   =   1  //!< Scanner background request for a dir being viewed
 };
 
 
@@ -100,6 +101,7 @@ public:
     void Enqueue(const TaskPtr &task);
     void AbortDevice(int devId, const QString &action);
     void PauseBackground(bool pause);
+    void PrioritiseDir(int dirId);
 
 protected:
     void run() override; // MThread
@@ -137,6 +139,7 @@ public:
                             bool notify = false);
     void    MoveThumbnail(const ImagePtrK &im);
     void    PauseBackground(bool pause);
+    void    PrioritiseDir(int dirId);
 
 private:
     Q_DISABLE_COPY(ImageThumb)
@@ -2,11 +2,15 @@
 #include "videoscan.h"
 
 #include <QApplication>
+#include <QHash>
 #include <QImageReader>
+#include <QRunnable>
 #include <QUrl>
 #include <utility>
 
 // libmythbase
+#include "mthreadpool.h"
+#include "mythdb.h"
 #include "mythevent.h"
 #include "mythlogging.h"
 #include "mythdate.h"
@@ -31,8 +35,66 @@
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
+/// Files hashed at the same time, to keep a NAS responsive during a scan
+static constexpr int kHashThreads { 4 };
+
+/// Database changes committed together
+static constexpr uint kTransactionSize { 100 };
+
 namespace
 {
+    class VideoHashTask : public QRunnable
+    {
+      public:
+        VideoHashTask(QString file_name, QString host, QString &hash) :
+            m_fileName(std::move(file_name)), m_host(std::move(host)),
+            m_hash(hash) {}
+
+        void run() override // QRunnable
+        {
+            m_hash = VideoMetadata::VideoFileHash(m_fileName, m_host);
+        }
+
+      private:
+        QString  m_fileName;
+        QString  m_host;
+        QString &m_hash;
+    };
+
+    /// Groups database changes into transactions of a bounded size
+    class TransactionBatch
+    {
+      public:
+        TransactionBatch() : m_query(MSqlQuery::InitCon()) {}
+        ~TransactionBatch() { Commit(); }
+
+        /// Call before each change
+        void Begin(void)
+        {
+            // The changes re-use the connection held by this query
+            if (m_size == 0 && !m_query.exec("START TRANSACTION"))
+                MythDB::DBError("Video scan start transaction", m_query);
+        }
+
+        /// Call after each change
+        void End(void)
+        {
+            if (++m_size >= kTransactionSize)
+                Commit();
+        }
+
+        void Commit(void)
+        {
+            if (m_size > 0 && !m_query.exec("COMMIT"))
+                MythDB::DBError("Video scan commit", m_query);
+            m_size = 0;
+        }
+
+      private:
+        MSqlQuery m_query;
+        uint      m_size {0};
+    };
+
     template <typename DirListType>
     class dirhandler : public DirectoryHandler
     {
@@ -317,16 +379,51 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
         SendProgressEvent(counter, (uint)(add.size() + remove.size()),
                           tr("Updating video database"));
 
+    // Hash the files not already in the DB, a few at a time
+    std::vector<FileCheckList::const_iterator> newFiles;
+    for (auto p = add.cbegin(); p != add.cend(); ++p)
+    {
+        if (!p->second.check)
+            newFiles.push_back(p);
+    }
+
+    std::vector<QString> hashes(newFiles.size());
+    if (!newFiles.empty())
+    {
+        MThreadPool hashPool("VideoHash");
+        hashPool.setMaxThreadCount(kHashThreads);
+        for (size_t i = 0; i < newFiles.size(); ++i)
+        {
+            hashPool.start(new VideoHashTask(newFiles[i]->first,
+                                             newFiles[i]->second.host,
+                                             hashes[i]), "VideoHash");
+        }
+        hashPool.waitForDone();
+    }
+
+    // Known hashes, so that only moved files need a DB lookup
+    QHash<QString, int> dbHashes;
+    for (const auto & file : m_dbMetadata->getList())
+    {
+        const QString &hash = file->GetHash();
+        if (hash != "NULL" && !hash.isEmpty())
+            dbHashes.insert(hash, file->GetID());
+    }
+
+    TransactionBatch batch;
+
+    size_t hashIndex = 0;
     for (auto p = add.cbegin(); p != add.cend(); ++p)
     {
         // add files not already in the DB
         if (!p->second.check)
         {
             int id = -1;
+            batch.Begin();
 
             // Are we sure this needs adding?  Let's check our Hash list.
-            QString hash = VideoMetadata::VideoFileHash(p->first, p->second.host);
-            if (hash != "NULL" && !hash.isEmpty())
+            QString hash = hashes[hashIndex++];
+            if (dbHashes.contains(hash))
             {
                 id = VideoMetadata::UpdateHashedDBRecord(hash, p->first, p->second.host);
                 if (id != -1)
@@ -367,7 +464,10 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
                 newFile.SetHost(p->second.host);
                 newFile.SaveToDatabase();
                 m_addList << newFile.GetID();
+                if (hash != "NULL" && !hash.isEmpty())
+                    dbHashes.insert(hash, newFile.GetID());
             }
+            batch.End();
             ret += 1;
         }
         if (m_hasGUI)
@@ -380,8 +480,10 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
     {
         if (!m_movList.contains(item.first))
         {
+            batch.Begin();
             removeOrphans(item.first, item.second);
             m_delList << item.first;
+            batch.End();
         }
         if (m_hasGUI)
             SendProgressEvent(++counter);
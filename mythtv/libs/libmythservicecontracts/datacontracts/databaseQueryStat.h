@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: databaseQueryStat.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATABASEQUERYSTAT_H_
+#define DATABASEQUERYSTAT_H_
+
+#include <QString>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+namespace DTC
+{
+
+class SERVICE_PUBLIC DatabaseQueryStat : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version"    , "1.0" );
+
+    // Times are in microseconds
+
+    Q_PROPERTY( QString    Query           READ Query
+                                           WRITE setQuery       )
+    Q_PROPERTY( qulonglong Count           READ Count
+                                           WRITE setCount       )
+    Q_PROPERTY( qulonglong TotalTime       READ TotalTime
+                                           WRITE setTotalTime   )
+    Q_PROPERTY( qulonglong MaxTime         READ MaxTime
+                                           WRITE setMaxTime     )
+    Q_PROPERTY( qulonglong AverageTime     READ AverageTime
+                                           WRITE setAverageTime )
+
+    PROPERTYIMP_REF( QString   , Query       )
+    PROPERTYIMP    ( qulonglong, Count       )
+    PROPERTYIMP    ( qulonglong, TotalTime   )
+    PROPERTYIMP    ( qulonglong, MaxTime     )
+    PROPERTYIMP    ( qulonglong, AverageTime );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE DatabaseQueryStat(QObject *parent = nullptr)
+            : QObject       ( parent ),
+              m_Count       ( 0      ),
+              m_TotalTime   ( 0      ),
+              m_MaxTime     ( 0      ),
+              m_AverageTime ( 0      )
+        {
+        }
+
+        void Copy( const DatabaseQueryStat *src )
+        {
+            m_Query       = src->m_Query       ;
+            m_Count       = src->m_Count       ;
+            m_TotalTime   = src->m_TotalTime   ;
+            m_MaxTime     = src->m_MaxTime     ;
+            m_AverageTime = src->m_AverageTime ;
+        }
+
+    private:
+        Q_DISABLE_COPY(DatabaseQueryStat);
+};
+
+inline void DatabaseQueryStat::InitializeCustomTypes()
+{
+    qRegisterMetaType< DatabaseQueryStat* >();
+}
+
+} // namespace DTC
+
+#endif
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: databaseQueryStatList.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATABASEQUERYSTATLIST_H_
+#define DATABASEQUERYSTATLIST_H_
+
+#include <QVariantList>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+#include "databaseQueryStat.h"
+
+namespace DTC
+{
+
+class SERVICE_PUBLIC DatabaseQueryStatList : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+
+    // Q_CLASSINFO Used to augment Metadata for properties.
+    // See datacontracthelper.h for details
+
+    Q_CLASSINFO( "DatabaseQueryStats", "type=DTC::DatabaseQueryStat");
+
+    Q_PROPERTY( QVariantList DatabaseQueryStats READ DatabaseQueryStats )
+
+    PROPERTYIMP_RO_REF( QVariantList, DatabaseQueryStats );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE DatabaseQueryStatList(QObject *parent = nullptr)
+            : QObject( parent )
+        {
+        }
+
+        void Copy( const DatabaseQueryStatList *src )
+        {
+            CopyListContents< DatabaseQueryStat >( this, m_DatabaseQueryStats,
+                                                   src->m_DatabaseQueryStats );
+        }
+
+        DatabaseQueryStat *AddNewDatabaseQueryStat()
+        {
+            // We must make sure the object added to the QVariantList has
+            // a parent of 'this'
+
+            auto *pObject = new DatabaseQueryStat( this );
+            m_DatabaseQueryStats.append( QVariant::fromValue<QObject *>( pObject ));
+
+            return pObject;
+        }
+
+    private:
+        Q_DISABLE_COPY(DatabaseQueryStatList);
+};
+
+inline void DatabaseQueryStatList::InitializeCustomTypes()
+{
+    qRegisterMetaType< DatabaseQueryStatList* >();
+
+    DatabaseQueryStat::InitializeCustomTypes();
+}
+
+} // namespace DTC
+
+#endif
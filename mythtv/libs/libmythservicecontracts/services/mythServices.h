@@ -24,6 +24,7 @@
 #include "datacontracts/logMessageList.h"
 #include <datacontracts/frontendList.h>
 #include "datacontracts/backendInfo.h"
+#include "datacontracts/databaseQueryStatList.h"
 
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -44,7 +45,7 @@
 class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
-    Q_CLASSINFO( "version"    , "5.2" );
+    Q_CLASSINFO( "version"    , "5.3" );
     Q_CLASSINFO( "AddStorageGroupDir_Method",    "POST" )
     Q_CLASSINFO( "RemoveStorageGroupDir_Method", "POST" )
     Q_CLASSINFO( "PutSetting_Method",            "POST" )
@@ -75,6 +76,7 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
             DTC::LogMessageList     ::InitializeCustomTypes();
             DTC::FrontendList       ::InitializeCustomTypes();
             DTC::BackendInfo        ::InitializeCustomTypes();
+            DTC::DatabaseQueryStatList::InitializeCustomTypes();
         }
 
     public slots:
@@ -179,6 +181,8 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
 
         virtual DTC::BackendInfo*   GetBackendInfo      ( void ) = 0;
 
+        virtual DTC::DatabaseQueryStatList* GetDatabaseQueryStats( int Count ) = 0;
+
         virtual bool                ManageDigestUser    ( const QString &Action,
                                                           const QString &UserName,
                                                           const QString &Password,
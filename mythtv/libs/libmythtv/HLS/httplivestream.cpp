@@ -25,11 +25,16 @@
 // C headers
 #include <cstdio>
 
+// C++ headers
+#include <algorithm>
+
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QMutex>
 #include <QRunnable>
+#include <QSet>
 #include <QUrl>
 #include <utility>
 
@@ -43,34 +48,65 @@
 #include "mythlogging.h"
 #include "storagegroup.h"
 #include "httplivestream.h"
+#include "httplivestreamsegmenter.h"
 
 #define LOC QString("HLS(%1): ").arg(m_sourceFile)
 #define LOC_ERR QString("HLS(%1) Error: ").arg(m_sourceFile)
 #define SLOC QString("HLS(): ")
 #define SLOC_ERR QString("HLS() Error: ")
 
+/// Streams being written by this backend, each has only one writer
+static QMutex    s_streamsLock;
+static QSet<int> s_streams;
+
+/// Whether playable sources are remuxed.  A remux has only the source's
+/// resolution, the transcoder is needed for a ladder of renditions.
+static bool remux_enabled(void)
+{
+    return gCoreContext->GetBoolSetting("HTTPLiveStreamRemux", true) &&
+        (gCoreContext->GetNumSetting("HTTPLiveStreamRenditions", 0) == 0);
+}
+
 /** \class HTTPLiveStreamThread
- *  \brief QRunnable class for running mythtranscode for HTTP Live Streams
+ *  \brief QRunnable class for writing HTTP Live Streams
  *
- *  The HTTPLiveStreamThread class runs a mythtranscode command in
+ *  The HTTPLiveStreamThread class remuxes the source in process when it is
+ *  already playable, otherwise it runs a mythtranscode command in
  *  non-blocking mode.
  */
 class HTTPLiveStreamThread : public QRunnable
 {
   public:
-    /** \fn HTTPLiveStreamThread::HTTPLiveStreamThread(int)
+    /** \fn HTTPLiveStreamThread::HTTPLiveStreamThread(int,bool)
      *  \brief Constructor for creating a SystemEventThread
      *  \param streamid The stream identifier.
+     *  \param remux    Try to segment the source without re-encoding it.
      */
-    explicit HTTPLiveStreamThread(int streamid)
-      : m_streamID(streamid) {}
+    explicit HTTPLiveStreamThread(int streamid, bool remux)
+      : m_streamID(streamid), m_remux(remux) {}
 
     /** \fn HTTPLiveStreamThread::run()
-     *  \brief Runs mythtranscode for the given HTTP Live Stream ID
+     *  \brief Writes the given HTTP Live Stream ID
      *
      *  Overrides QRunnable::run()
      */
     void run(void) override // QRunnable
+    {
+        if (!m_remux || !Remux())
+            Transcode();
+
+        QMutexLocker locker(&s_streamsLock);
+        s_streams.remove(m_streamID);
+    }
+
+  private:
+    bool Remux(void) const
+    {
+        HTTPLiveStreamSegmenter segmenter(m_streamID);
+        return segmenter.Run() != HTTPLiveStreamSegmenter::kNotCompatible;
+    }
+
+    void Transcode(void) const
     {
         uint flags = kMSDontBlockInputDevs;
 
@@ -88,8 +124,8 @@ class HTTPLiveStreamThread : public QRunnable
         }
     }
 
-  private:
-    int m_streamID;
+    int  m_streamID;
+    bool m_remux;
 };
 
 
@@ -160,6 +196,8 @@ HTTPLiveStream::~HTTPLiveStream()
         WritePlaylist(false, true);
         if (m_audioOnlyBitrate)
             WritePlaylist(true, true);
+        for (int i = 0; i < m_renditions.size(); ++i)
+            WriteRenditionPlaylist(i, true);
     }
 }
 
@@ -203,6 +241,73 @@ QString HTTPLiveStream::GetCurrentFilename(bool audioOnly, bool encoded) const
     return GetFilename(m_curSegment, false, audioOnly, encoded);
 }
 
+/// \brief The file the next AddSegment() will start
+QString HTTPLiveStream::GetNextFilename(bool audioOnly) const
+{
+    return GetFilename(static_cast<uint16_t>(m_curSegment + 1), false,
+                       audioOnly);
+}
+
+/**
+ *  \brief Add a lower resolution copy of the stream to the meta playlist
+ *
+ *  Renditions are segmented alongside the main stream and have their own
+ *  playlist.  They must be added before InitForWrite() writes the meta
+ *  playlist.  They are not stored in the database, RemoveStream() finds
+ *  their files by name.
+ */
+void HTTPLiveStream::AddRendition(uint16_t width, uint16_t height,
+                                  uint32_t bitrate)
+{
+    Rendition rendition;
+    rendition.m_width   = width;
+    rendition.m_height  = height;
+    rendition.m_bitrate = bitrate;
+    m_renditions.push_back(rendition);
+}
+
+QString HTTPLiveStream::GetRenditionBase(int rendition, bool encoded) const
+{
+    if (rendition < 0 || rendition >= m_renditions.size())
+        return QString();
+
+    const Rendition &r = m_renditions[rendition];
+    return (encoded ? m_outBaseEncoded : m_outBase) +
+        QString(".r%1x%2_%3kV").arg(r.m_width).arg(r.m_height)
+                .arg(r.m_bitrate/1000);
+}
+
+QString HTTPLiveStream::GetRenditionFilename(int rendition,
+                                             uint16_t segmentNumber,
+                                             bool fileOnly, bool encoded) const
+{
+    QString filename = GetRenditionBase(rendition, encoded);
+    if (filename.isEmpty())
+        return QString();
+
+    filename += ".%1.ts";
+
+    if (!fileOnly)
+        filename = m_outDir + "/" + filename;
+
+    if (segmentNumber)
+        return filename.arg(segmentNumber, 6, 10, QChar('0'));
+
+    return filename.arg(1, 6, 10, QChar('0'));
+}
+
+QString HTTPLiveStream::GetCurrentRenditionFilename(int rendition) const
+{
+    return GetRenditionFilename(rendition, m_curSegment);
+}
+
+/// \brief The file the next AddSegment() will start for a rendition
+QString HTTPLiveStream::GetNextRenditionFilename(int rendition) const
+{
+    return GetRenditionFilename(rendition,
+                                static_cast<uint16_t>(m_curSegment + 1));
+}
+
 int HTTPLiveStream::AddStream(void)
 {
     m_status = kHLSStatusQueued;
@@ -218,10 +323,32 @@ int HTTPLiveStream::AddStream(void)
         tmpRelURL = m_relativeURL;
     }
 
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    // A remux has the source's size and bitrates whatever was asked for, so
+    // every request for the source can share it
+    if (remux_enabled())
+    {
+        query.prepare(
+            "SELECT id FROM livestream "
+            "WHERE sourcefile = :SOURCEFILE AND segmentsize = :SEGMENTSIZE AND "
+            "statusmessage LIKE 'Remux%' AND status <= :STATUS "
+            "ORDER BY id DESC LIMIT 1");
+        query.bindValue(":SOURCEFILE", m_sourceFile);
+        query.bindValue(":SEGMENTSIZE", m_segmentSize);
+        query.bindValue(":STATUS", (int)kHLSStatusCompleted);
+
+        if (query.exec() && query.next())
+        {
+            m_streamid = query.value(0).toUInt();
+            LoadFromDB();
+            return m_streamid;
+        }
+    }
+
     // Check that this stream has not already been created.
     // We want to avoid creating multiple identical streams and transcode
     // jobs
-    MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(
         "SELECT id FROM livestream "
         "WHERE "
@@ -324,6 +451,16 @@ bool HTTPLiveStream::AddSegment(void)
             LOG(VB_GENERAL, LOG_ERR, LOC +
                 QString("Unable to delete %1.").arg(thisFile));
 
+        for (int i = 0; i < m_renditions.size(); ++i)
+        {
+            thisFile = GetRenditionFilename(i, m_startSegment);
+
+            if (!QFile::remove(thisFile))
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    QString("Unable to delete %1.").arg(thisFile));
+        }
+
+        m_segmentDurations.remove(m_startSegment);
         ++m_startSegment;
         --m_segmentCount;
     }
@@ -334,6 +471,9 @@ bool HTTPLiveStream::AddSegment(void)
     if (m_audioOnlyBitrate)
         WritePlaylist(true);
 
+    for (int i = 0; i < m_renditions.size(); ++i)
+        WriteRenditionPlaylist(i);
+
     return true;
 }
 
@@ -408,10 +548,22 @@ bool HTTPLiveStream::WriteMetaPlaylist(void)
         "#EXTM3U\n"
         "#EXT-X-VERSION:4\n"
         "#EXT-X-MEDIA:TYPE=VIDEO,GROUP-ID=\"AV\",NAME=\"Main\",DEFAULT=YES,URI=\"%2.m3u8\"\n"
-        "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1\n"
+        "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1,RESOLUTION=%3x%4\n"
         "%2.m3u8\n"
         ).arg((int)((m_bitrate + m_audioBitrate) * 1.1))
-         .arg(m_outFileEncoded).toLatin1());
+         .arg(m_outFileEncoded).arg(m_width).arg(m_height).toLatin1());
+
+    // Clients switch between these as their bandwidth changes
+    for (int i = 0; i < m_renditions.size(); ++i)
+    {
+        const Rendition &r = m_renditions[i];
+        file.write(QString(
+            "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=%1,RESOLUTION=%3x%4\n"
+            "%2.m3u8\n"
+            ).arg((int)((r.m_bitrate + m_audioBitrate) * 1.1))
+             .arg(GetRenditionBase(i, true))
+             .arg(r.m_width).arg(r.m_height).toLatin1());
+    }
 
     if (m_audioOnlyBitrate)
     {
@@ -441,12 +593,42 @@ QString HTTPLiveStream::GetPlaylistName(bool audioOnly) const
     return outFile;
 }
 
+QString HTTPLiveStream::GetRenditionPlaylistName(int rendition) const
+{
+    if (m_streamid == -1)
+        return QString();
+
+    QString base = GetRenditionBase(rendition);
+    if (base.isEmpty())
+        return QString();
+
+    return m_outDir + "/" + base + ".m3u8";
+}
+
 bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
 {
     if (m_streamid == -1)
         return false;
 
-    QString outFile = GetPlaylistName(audioOnly);
+    return WritePlaylistFile(GetPlaylistName(audioOnly), audioOnly, -1,
+                             writeEndTag);
+}
+
+bool HTTPLiveStream::WriteRenditionPlaylist(int rendition, bool writeEndTag)
+{
+    if (m_streamid == -1)
+        return false;
+
+    return WritePlaylistFile(GetRenditionPlaylistName(rendition), false,
+                             rendition, writeEndTag);
+}
+
+bool HTTPLiveStream::WritePlaylistFile(const QString &outFile, bool audioOnly,
+                                       int rendition, bool writeEndTag)
+{
+    if (outFile.isEmpty())
+        return false;
+
     QString tmpFile = outFile + ".tmp";
 
     QFile file(tmpFile);
@@ -457,33 +639,58 @@ bool HTTPLiveStream::WritePlaylist(bool audioOnly, bool writeEndTag)
         return false;
     }
 
+    // Don't write out the current segment until the end
+    unsigned int tmpSegCount = m_segmentCount - 1;
+    unsigned int segmentid = m_startSegment;
+
+    if (writeEndTag)
+        ++tmpSegCount;
+
+    // The target duration is the longest segment, rounded up
+    std::chrono::milliseconds longest = std::chrono::seconds(m_segmentSize);
+    if (!m_segmentDurations.isEmpty())
+    {
+        longest = 0ms;
+        for (unsigned int i = 0; i < tmpSegCount; ++i)
+        {
+            longest = std::max(longest, m_segmentDurations.value(
+                static_cast<uint16_t>(segmentid + i),
+                std::chrono::seconds(m_segmentSize)));
+        }
+    }
+    auto target = std::chrono::ceil<std::chrono::seconds>(longest);
+
     file.write(QString(
         "#EXTM3U\n"
         "#EXT-X-ALLOW-CACHE:YES\n"
         "#EXT-X-TARGETDURATION:%1\n"
         "#EXT-X-MEDIA-SEQUENCE:%2\n"
-        ).arg(m_segmentSize).arg(m_startSegment).toLatin1());
+        ).arg(std::max<int64_t>(target.count(), 1)).arg(m_startSegment)
+         .toLatin1());
+
+    // Decimal durations need version 3
+    if (!m_segmentDurations.isEmpty())
+        file.write("#EXT-X-VERSION:3\n");
 
     if (writeEndTag)
         file.write("#EXT-X-ENDLIST\n");
 
-    // Don't write out the current segment until the end
-    unsigned int tmpSegCount = m_segmentCount - 1;
-    unsigned int i = 0;
-    unsigned int segmentid = m_startSegment;
+    for (unsigned int i = 0; i < tmpSegCount; ++i)
+    {
+        QString segment = (rendition < 0) ?
+            GetFilename(segmentid + i, true, audioOnly, true) :
+            GetRenditionFilename(rendition, segmentid + i, true, true);
 
-    if (writeEndTag)
-        ++tmpSegCount;
+        QString duration = QString::number(m_segmentSize);
+        auto known = m_segmentDurations.constFind(
+            static_cast<uint16_t>(segmentid + i));
+        if (known != m_segmentDurations.constEnd())
+            duration = QString::number(known->count() / 1000.0, 'f', 3);
 
-    while (i < tmpSegCount)
-    {
         file.write(QString(
             "#EXTINF:%1,\n"
             "%2\n"
-            ).arg(m_segmentSize)
-             .arg(GetFilename(segmentid + i, true, audioOnly, true)).toLatin1());
-
-        ++i;
+            ).arg(duration).arg(segment).toLatin1());
     }
 
     file.close();
@@ -613,6 +820,48 @@ bool HTTPLiveStream::UpdateStatus(HTTPLiveStreamStatus status)
     return false;
 }
 
+/**
+ *  \brief Advertise the bitrates of the stream, when they aren't the ones it
+ *         was asked for.  Call before UpdateSizeInfo(), which names the
+ *         output after them.
+ */
+bool HTTPLiveStream::UpdateBitrateInfo(uint32_t bitrate, uint32_t abitrate)
+{
+    if (m_streamid == -1)
+        return false;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "UPDATE livestream "
+        "SET bitrate = :BITRATE, audiobitrate = :AUDIOBITRATE "
+        "WHERE id = :STREAMID; ");
+    query.bindValue(":BITRATE", bitrate);
+    query.bindValue(":AUDIOBITRATE", abitrate);
+    query.bindValue(":STREAMID", m_streamid);
+
+    if (!query.exec())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to update bitrate info for streamid %1")
+                    .arg(m_streamid));
+        return false;
+    }
+
+    m_bitrate = bitrate;
+    m_audioBitrate = abitrate;
+
+    return true;
+}
+
+/**
+ *  \brief Record the real length of the current segment, for its EXTINF.
+ *         Call before AddSegment() starts the next one.
+ */
+void HTTPLiveStream::SetSegmentDuration(std::chrono::milliseconds duration)
+{
+    m_segmentDurations[m_curSegment] = duration;
+}
+
 bool HTTPLiveStream::UpdateStatusMessage(const QString& message)
 {
     if (m_streamid == -1)
@@ -818,11 +1067,21 @@ DTC::LiveStreamInfo *HTTPLiveStream::StartStream(void)
     if (GetDBStatus() != kHLSStatusQueued)
         return GetLiveStreamInfo();
 
-    auto *streamThread = new HTTPLiveStreamThread(GetStreamID());
+    // Clients asking for the same stream at the same time share one writer
+    {
+        QMutexLocker locker(&s_streamsLock);
+        if (s_streams.contains(GetStreamID()))
+            return GetLiveStreamInfo();
+        s_streams.insert(GetStreamID());
+    }
+
+    auto *streamThread = new HTTPLiveStreamThread(GetStreamID(),
+                                                  remux_enabled());
     MThreadPool::globalInstance()->startReserved(streamThread,
                                                  "HTTPLiveStream");
     MythTimer statusTimer;
-    int       delay = 250000;
+    // A remux starts straight away, don't keep its client waiting
+    int       delay = 50000;
     statusTimer.start();
 
     HTTPLiveStreamStatus status = GetDBStatus();
@@ -835,6 +1094,9 @@ DTC::LiveStreamInfo *HTTPLiveStream::StartStream(void)
         status = GetDBStatus();
     }
 
+    // The writer may have changed the size, bitrates and URLs
+    LoadFromDB();
+
     return GetLiveStreamInfo();
 }
 
@@ -898,6 +1160,26 @@ bool HTTPLiveStream::RemoveStream(int id)
         LOG(VB_GENERAL, LOG_ERR, SLOC +
             QString("Unable to delete %1.").arg(thisFile));
 
+    // Renditions aren't in the database, their files share our base name
+    thisFile = hls->GetMetaPlaylistName();
+    if (!thisFile.isEmpty())
+    {
+        QFileInfo finfo(thisFile);
+        QString prefix = finfo.completeBaseName() + ".r";
+        QDir outDir(finfo.absolutePath());
+        QStringList files = outDir.entryList(QDir::Files);
+
+        for (const auto & file : qAsConst(files))
+        {
+            if (!file.startsWith(prefix))
+                continue;
+
+            if (!outDir.remove(file))
+                LOG(VB_GENERAL, LOG_ERR, SLOC +
+                    QString("Unable to delete %1.").arg(file));
+        }
+    }
+
     query.prepare(
         "DELETE FROM livestream "
         "WHERE id = :STREAMID; ");
@@ -1,7 +1,11 @@
 #ifndef HTTPLIVESTREAM_H
 #define HTTPLIVESTREAM_H
 
+#include <chrono>
+
+#include <QMap>
 #include <QString>
+#include <QVector>
 
 #include "datacontracts/liveStreamInfoList.h"
 
@@ -48,6 +52,16 @@ class MTV_PUBLIC HTTPLiveStream
                          bool audioOnly = false, bool encoded = false) const;
     QString  GetCurrentFilename(
         bool audioOnly = false, bool encoded = false) const;
+    QString  GetNextFilename(bool audioOnly = false) const;
+
+    void     AddRendition(uint16_t width, uint16_t height, uint32_t bitrate);
+    int      GetRenditionCount(void) const { return m_renditions.size(); }
+    QString  GetRenditionFilename(int rendition, uint16_t segmentNumber = 0,
+                                  bool fileOnly = false,
+                                  bool encoded = false) const;
+    QString  GetCurrentRenditionFilename(int rendition) const;
+    QString  GetNextRenditionFilename(int rendition) const;
+    QString  GetRenditionPlaylistName(int rendition) const;
 
     void SetOutputVars(void);
 
@@ -59,11 +73,14 @@ class MTV_PUBLIC HTTPLiveStream
     bool WriteHTML(void);
     bool WriteMetaPlaylist(void);
     bool WritePlaylist(bool audioOnly = false, bool writeEndTag = false);
+    bool WriteRenditionPlaylist(int rendition, bool writeEndTag = false);
 
     bool SaveSegmentInfo(void);
 
     bool UpdateSizeInfo(uint16_t width, uint16_t height,
                         uint16_t srcwidth, uint16_t srcheight);
+    bool UpdateBitrateInfo(uint32_t bitrate, uint32_t abitrate);
+    void SetSegmentDuration(std::chrono::milliseconds duration);
     bool UpdateStatus(HTTPLiveStreamStatus status);
     bool UpdateStatusMessage(const QString& message);
     bool UpdatePercentComplete(int percent);
@@ -80,6 +97,18 @@ class MTV_PUBLIC HTTPLiveStream
     static DTC::LiveStreamInfoList *GetLiveStreamInfoList( const QString &FileName = "");
 
  protected:
+    /// A lower resolution copy of the stream, encoded from the same decode
+    struct Rendition
+    {
+        uint16_t m_width   {0};
+        uint16_t m_height  {0};
+        uint32_t m_bitrate {0};
+    };
+
+    QString GetRenditionBase(int rendition, bool encoded = false) const;
+    bool    WritePlaylistFile(const QString &outFile, bool audioOnly,
+                              int rendition, bool writeEndTag);
+
     bool        m_writing          {false};
     int         m_streamid         {-1};
     QString     m_sourceFile;
@@ -106,6 +135,9 @@ class MTV_PUBLIC HTTPLiveStream
     uint32_t    m_audioBitrate     { 64000};
     uint32_t    m_audioOnlyBitrate { 32000};
     int32_t     m_sampleRate       {-1};
+    QVector<Rendition> m_renditions;
+    /// The real lengths of the segments, where the writer knows them
+    QMap<uint16_t, std::chrono::milliseconds> m_segmentDurations;
 
     QDateTime   m_created;
     QDateTime   m_lastModified;
@@ -0,0 +1,408 @@
+/*  -*- Mode: c++ -*-
+ *
+ *   Class HTTPLiveStreamSegmenter
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifdef __linux__
+// POSIX headers
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+
+#include <QFileInfo>
+#include <QVector>
+
+#include "mythchrono.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+#include "mythtimer.h"
+#include "httplivestream.h"
+#include "httplivestreamsegmenter.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define LOC QString("HLSSegmenter(%1): ").arg(m_streamid)
+
+/// Sources written to more recently than this may still be recording
+static constexpr std::chrono::seconds kGrowingFileAge { 30s };
+
+static std::chrono::milliseconds to_duration(int64_t ticks, AVRational timebase)
+{
+    return std::chrono::milliseconds(av_rescale_q(ticks, timebase,
+                                                  AVRational{1, 1000}));
+}
+
+#ifdef __linux__
+static std::chrono::milliseconds thread_cpu_time(void)
+{
+    struct rusage usage {};
+    getrusage(RUSAGE_THREAD, &usage);
+    return std::chrono::milliseconds(
+        (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000);
+}
+#endif
+
+HTTPLiveStreamSegmenter::~HTTPLiveStreamSegmenter()
+{
+    CloseSegment();
+
+    if (m_input)
+        avformat_close_input(&m_input);
+}
+
+HTTPLiveStreamSegmenter::Result HTTPLiveStreamSegmenter::Run(void)
+{
+    HTTPLiveStream hls(m_streamid);
+
+    QString sourceFile = hls.GetSourceFile();
+
+    if (!OpenInput(sourceFile) || !IsCompatible(sourceFile))
+        return kNotCompatible;
+
+    MythTimer timer;
+    timer.start();
+#ifdef __linux__
+    std::chrono::milliseconds cpuStart = thread_cpu_time();
+#endif
+
+    AVCodecParameters *video = m_input->streams[m_videoIndex]->codecpar;
+    AVCodecParameters *audio = m_input->streams[m_audioIndex]->codecpar;
+
+    // Advertise the source as it is, not the size and bitrates that were
+    // asked for.  HTTPLiveStream::AddStream() shares a remux with every
+    // request for the source.
+    uint32_t videoBitrate = hls.GetBitrate();
+    uint32_t audioBitrate = hls.GetAudioBitrate();
+    if (audio->bit_rate > 0)
+        audioBitrate = static_cast<uint32_t>(audio->bit_rate);
+    if (video->bit_rate > 0)
+        videoBitrate = static_cast<uint32_t>(video->bit_rate);
+    else if (m_input->bit_rate > std::max<int64_t>(audio->bit_rate, 0))
+        videoBitrate = static_cast<uint32_t>(
+            m_input->bit_rate - std::max<int64_t>(audio->bit_rate, 0));
+
+    hls.UpdateBitrateInfo(videoBitrate, audioBitrate);
+    hls.UpdateSizeInfo(video->width, video->height,
+                       video->width, video->height);
+
+    if (!hls.InitForWrite() || !OpenSegment(hls))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to start segmenting");
+        hls.UpdateStatus(kHLSStatusErrored);
+        hls.UpdateStatusMessage("Remux Errored");
+        return kFailed;
+    }
+
+    hls.UpdateStatus(kHLSStatusRunning);
+    hls.UpdateStatusMessage("Remuxing");
+
+    AVStream *videoStream = m_input->streams[m_videoIndex];
+    int64_t segmentLength = av_rescale_q(hls.GetSegmentSize(), AVRational{1, 1},
+                                         videoStream->time_base);
+    int64_t segmentStart = AV_NOPTS_VALUE;
+    int64_t segmentEnd   = AV_NOPTS_VALUE;
+    int64_t inputSize    = avio_size(m_input->pb);
+    int     segments     = 1;
+    Result  result       = kRemuxed;
+
+    AVPacket *pkt = av_packet_alloc();
+
+    while (av_read_frame(m_input, pkt) >= 0)
+    {
+        if (pkt->stream_index == m_videoIndex)
+        {
+            int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+
+            if (segmentStart == AV_NOPTS_VALUE)
+                segmentStart = ts;
+
+            // Each segment must start with a keyframe
+            if ((pkt->flags & AV_PKT_FLAG_KEY) && (ts != AV_NOPTS_VALUE) &&
+                (ts - segmentStart >= segmentLength))
+            {
+                hls.SetSegmentDuration(
+                    to_duration(ts - segmentStart, videoStream->time_base));
+                CloseSegment();
+
+                if (segments == 1)
+                {
+                    LOG(VB_GENERAL, LOG_INFO, LOC +
+                        QString("First segment ready after %1 ms")
+                            .arg(timer.elapsed().count()));
+                }
+
+                if (hls.CheckStop())
+                {
+                    result = kStopped;
+                    av_packet_unref(pkt);
+                    break;
+                }
+
+                if (inputSize > 0)
+                {
+                    hls.UpdatePercentComplete(
+                        (int)(avio_tell(m_input->pb) * 100 / inputSize));
+                }
+
+                if (!OpenSegment(hls))
+                {
+                    result = kFailed;
+                    av_packet_unref(pkt);
+                    break;
+                }
+
+                segmentStart = ts;
+                ++segments;
+            }
+
+            if (ts != AV_NOPTS_VALUE)
+            {
+                int64_t end = ts + std::max<int64_t>(pkt->duration, 0);
+                if (segmentEnd == AV_NOPTS_VALUE || end > segmentEnd)
+                    segmentEnd = end;
+            }
+
+            if (!WritePacket(m_output, 0, pkt))
+                LOG(VB_GENERAL, LOG_WARNING, LOC + "Unable to write video");
+        }
+        else if (pkt->stream_index == m_audioIndex)
+        {
+            if (!WritePacket(m_output, 1, pkt))
+                LOG(VB_GENERAL, LOG_WARNING, LOC + "Unable to write audio");
+
+            if (m_audioOutput && !WritePacket(m_audioOutput, 0, pkt))
+                LOG(VB_GENERAL, LOG_WARNING, LOC + "Unable to write audio");
+        }
+
+        av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+    CloseSegment();
+
+    // The last segment ends with its last frame
+    if (segmentStart != AV_NOPTS_VALUE && segmentEnd > segmentStart)
+    {
+        hls.SetSegmentDuration(
+            to_duration(segmentEnd - segmentStart, videoStream->time_base));
+    }
+
+    switch (result)
+    {
+        case kRemuxed:
+            hls.UpdateStatus(kHLSStatusCompleted);
+            hls.UpdateStatusMessage("Remux Completed");
+            hls.UpdatePercentComplete(100);
+            break;
+        case kStopped:
+            hls.UpdateStatus(kHLSStatusStopped);
+            hls.UpdateStatusMessage("Remux Stopped");
+            break;
+        default:
+            hls.UpdateStatus(kHLSStatusErrored);
+            hls.UpdateStatusMessage("Remux Errored");
+            break;
+    }
+
+#ifdef __linux__
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 segments in %2 ms, %3 ms CPU")
+            .arg(segments).arg(timer.elapsed().count())
+            .arg((thread_cpu_time() - cpuStart).count()));
+#else
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("%1 segments in %2 ms")
+            .arg(segments).arg(timer.elapsed().count()));
+#endif
+
+    return result;
+}
+
+bool HTTPLiveStreamSegmenter::OpenInput(const QString &filename)
+{
+    // Only local files, others go through mythtranscode's MythMediaBuffer
+    if (!QFileInfo::exists(filename))
+        return false;
+
+    if (avformat_open_input(&m_input, filename.toUtf8().constData(),
+                            nullptr, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to open %1")
+                .arg(filename));
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_input, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to probe %1")
+                .arg(filename));
+        return false;
+    }
+
+    m_videoIndex = av_find_best_stream(m_input, AVMEDIA_TYPE_VIDEO,
+                                       -1, -1, nullptr, 0);
+    m_audioIndex = av_find_best_stream(m_input, AVMEDIA_TYPE_AUDIO,
+                                       -1, m_videoIndex, nullptr, 0);
+
+    return (m_videoIndex >= 0) && (m_audioIndex >= 0);
+}
+
+/// \brief Can the source be played by HLS clients as it is?
+bool HTTPLiveStreamSegmenter::IsCompatible(const QString &filename) const
+{
+    QDateTime modified = QFileInfo(filename).lastModified();
+    if (modified.secsTo(MythDate::current()) < kGrowingFileAge.count())
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            "Source may still be recording, it will be transcoded");
+        return false;
+    }
+
+    const AVCodecParameters *video = m_input->streams[m_videoIndex]->codecpar;
+    const AVCodecParameters *audio = m_input->streams[m_audioIndex]->codecpar;
+
+    // 8 bit 4:2:0 H.264
+    bool videoOK = (video->codec_id == AV_CODEC_ID_H264) &&
+                   ((video->format == AV_PIX_FMT_YUV420P) ||
+                    (video->format == AV_PIX_FMT_YUVJ420P));
+
+    // HLS clients are only required to play these.  AC-3 and E-AC-3 in
+    // MPEG-TS aren't supported by most players, so those are transcoded.
+    bool audioOK = (audio->codec_id == AV_CODEC_ID_AAC) ||
+                   (audio->codec_id == AV_CODEC_ID_MP3);
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Source is %1/%2, %3")
+            .arg(avcodec_get_name(video->codec_id))
+            .arg(avcodec_get_name(audio->codec_id))
+            .arg((videoOK && audioOK) ? "remuxing" : "it will be transcoded"));
+
+    return videoOK && audioOK;
+}
+
+/// \brief Start the next segment, and the audio only one with it.
+bool HTTPLiveStreamSegmenter::OpenSegment(HTTPLiveStream &hls)
+{
+    hls.AddSegment();
+
+    m_output = OpenOutput(hls.GetCurrentFilename(), false);
+    if (!m_output)
+        return false;
+
+    if (hls.GetAudioOnlyBitrate())
+    {
+        m_audioOutput = OpenOutput(hls.GetCurrentFilename(true), true);
+        if (!m_audioOutput)
+            return false;
+    }
+
+    return true;
+}
+
+void HTTPLiveStreamSegmenter::CloseSegment(void)
+{
+    CloseOutput(m_output);
+    CloseOutput(m_audioOutput);
+}
+
+AVFormatContext *HTTPLiveStreamSegmenter::OpenOutput(const QString &filename,
+                                                     bool audioOnly)
+{
+    AVFormatContext *ctx = nullptr;
+    if (avformat_alloc_output_context2(&ctx, nullptr, "mpegts",
+                                       filename.toUtf8().constData()) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to create MPEG-TS muxer");
+        return nullptr;
+    }
+
+    QVector<int> inputs;
+    if (!audioOnly)
+        inputs.append(m_videoIndex);
+    inputs.append(m_audioIndex);
+
+    for (int index : qAsConst(inputs))
+    {
+        AVStream *in  = m_input->streams[index];
+        AVStream *out = avformat_new_stream(ctx, nullptr);
+        if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to add output stream");
+            CloseOutput(ctx);
+            return nullptr;
+        }
+        out->codecpar->codec_tag = 0;
+        out->time_base = in->time_base;
+    }
+
+    if (avio_open(&ctx->pb, filename.toUtf8().constData(), AVIO_FLAG_WRITE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to create %1")
+                .arg(filename));
+        CloseOutput(ctx);
+        return nullptr;
+    }
+
+    if (avformat_write_header(ctx, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to write header to %1")
+                .arg(filename));
+        avio_closep(&ctx->pb);
+        CloseOutput(ctx);
+        return nullptr;
+    }
+
+    return ctx;
+}
+
+void HTTPLiveStreamSegmenter::CloseOutput(AVFormatContext *&ctx)
+{
+    if (!ctx)
+        return;
+
+    if (ctx->pb)
+    {
+        av_write_trailer(ctx);
+        avio_closep(&ctx->pb);
+    }
+
+    avformat_free_context(ctx);
+    ctx = nullptr;
+}
+
+bool HTTPLiveStreamSegmenter::WritePacket(AVFormatContext *output,
+                                          int outputIndex, const AVPacket *pkt)
+{
+    // The muxer takes over the packet, the same one may go to two outputs
+    AVPacket *copy = av_packet_clone(pkt);
+    if (!copy)
+        return false;
+
+    av_packet_rescale_ts(copy, m_input->streams[pkt->stream_index]->time_base,
+                         output->streams[outputIndex]->time_base);
+    copy->stream_index = outputIndex;
+    copy->pos = -1;
+
+    int ret = av_interleaved_write_frame(output, copy);
+    av_packet_free(&copy);
+
+    return ret >= 0;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,58 @@
+#ifndef HTTPLIVESTREAMSEGMENTER_H
+#define HTTPLIVESTREAMSEGMENTER_H
+
+#include <QString>
+
+struct AVFormatContext;
+struct AVPacket;
+class HTTPLiveStream;
+
+/** \class HTTPLiveStreamSegmenter
+ *  \brief Splits a source into HTTP Live Stream segments without re-encoding
+ *
+ *  When the source already holds H.264 video and audio that HLS clients
+ *  can play, its packets are copied into MPEG-TS segments, cut at the
+ *  first keyframe after each segment's duration.  This runs in the backend
+ *  and needs far less CPU than a mythtranscode re-encode, and the first
+ *  segment is ready as soon as it has been read from disk.
+ *
+ *  Run() returns kNotCompatible, without changing the stream, when the
+ *  source has to be transcoded instead.
+ */
+class HTTPLiveStreamSegmenter
+{
+  public:
+    enum Result
+    {
+        kRemuxed,
+        kStopped,
+        kFailed,
+        kNotCompatible
+    };
+
+    explicit HTTPLiveStreamSegmenter(int streamid) : m_streamid(streamid) {}
+   ~HTTPLiveStreamSegmenter();
+
+    Result Run(void);
+
+  private:
+    bool OpenInput(const QString &filename);
+    bool IsCompatible(const QString &filename) const;
+    bool OpenSegment(HTTPLiveStream &hls);
+    void CloseSegment(void);
+    AVFormatContext *OpenOutput(const QString &filename, bool audioOnly);
+    static void CloseOutput(AVFormatContext *&ctx);
+    bool WritePacket(AVFormatContext *output, int outputIndex,
+                     const AVPacket *pkt);
+
+    int              m_streamid    {-1};
+    AVFormatContext *m_input       {nullptr};
+    AVFormatContext *m_output      {nullptr};
+    AVFormatContext *m_audioOutput {nullptr};   ///< audio only rendition
+    int              m_videoIndex  {-1};
+    int              m_audioIndex  {-1};
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -579,6 +579,34 @@ bool DecoderBase::DoRewind(long long desiredFrame, bool discardFrames)
     return true;
 }
 
+/** \brief Returns the frame number of the last keyframe in the position
+ *         map at or before desiredFrame, or -1 if there is no position map.
+ */
+long long DecoderBase::GetKeyframeAtOrBefore(long long desiredFrame)
+{
+    if (!GetPositionMapSize())
+        return -1;
+
+    int pre_idx = 0;
+    int post_idx = 0;
+    FindPosition(desiredFrame, m_hasKeyFrameAdjustTable, pre_idx, post_idx);
+
+    QMutexLocker locker(&m_positionMapLock);
+    long long key = GetKey(m_positionMap[pre_idx]);
+    return (key <= desiredFrame) ? key : 0;
+}
+
+/// \brief Returns the frame numbers of all keyframes in the position map.
+std::vector<long long> DecoderBase::GetKeyframes(void)
+{
+    QMutexLocker locker(&m_positionMapLock);
+    std::vector<long long> keys;
+    keys.reserve(m_positionMap.size());
+    for (const auto & entry : m_positionMap)
+        keys.push_back(GetKey(entry));
+    return keys;
+}
+
 long long DecoderBase::GetKey(const PosMapEntry &e) const
 {
     long long kf = (m_ringBuffer && m_ringBuffer->IsDisc()) ?
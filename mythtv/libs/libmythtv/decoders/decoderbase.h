@@ -216,6 +216,8 @@ class DecoderBase
     virtual bool FindPosition(long long desired_value, bool search_adjusted,
                               int &lower_bound, int &upper_bound);
 
+    long long GetKeyframeAtOrBefore(long long desiredFrame);
+    std::vector<long long> GetKeyframes(void);
     uint64_t SavePositionMapDelta(long long first_frame, long long last_frame);
     virtual void SeekReset(long long newkey, uint skipFrames,
                            bool doFlush, bool discardFrames);
@@ -197,14 +197,38 @@ bool MythAVFormatWriter::NextFrameIsKeyFrame(void)
            (m_bufferedVideoFrameTypes.first() == AV_PICTURE_TYPE_I);
 }
 
+/**
+ *  \brief Code the next frame passed in as an IDR frame
+ *
+ *  The regular keyframe interval restarts from that frame, so writers that
+ *  are forced at the same frames keep their keyframes in step.
+ */
+void MythAVFormatWriter::ForceKeyFrame(void)
+{
+    m_forceKeyFrame = true;
+}
+
+/// \brief The number of frames passed in, including those the encoder holds
+long long MythAVFormatWriter::GetFramesQueued(void) const
+{
+    return m_framesWritten + m_bufferedVideoFrameTimes.size();
+}
+
 int MythAVFormatWriter::WriteVideoFrame(MythVideoFrame *Frame)
 {
-    long long framesEncoded = m_framesWritten + m_bufferedVideoFrameTimes.size();
+    long long framesEncoded = GetFramesQueued();
+
+    if (m_forceKeyFrame)
+    {
+        m_keyFrameStart = framesEncoded;
+        m_forceKeyFrame = false;
+    }
 
     av_frame_unref(m_picture);
     MythAVUtil::FillAVFrame(m_picture, Frame);
     m_picture->pts = framesEncoded + 1;
-    m_picture->pict_type = ((framesEncoded % m_keyFrameDist) == 0) ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    m_picture->pict_type = (((framesEncoded - m_keyFrameStart) % m_keyFrameDist) == 0) ?
+        AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
 
     m_bufferedVideoFrameTimes.push_back(Frame->m_timecode);
     m_bufferedVideoFrameTypes.push_back(m_picture->pict_type);
@@ -501,6 +525,8 @@ AVStream* MythAVFormatWriter::AddVideoStream(void)
         // libx264 AVOptions:
         av_opt_set(context->priv_data, "preset", m_encodingPreset.toLatin1().constData(), 0);
         av_opt_set(context->priv_data, "tune", m_encodingTune.toLatin1().constData(), 0);
+        // Segments must start with a frame that can be decoded on its own
+        av_opt_set_int(context->priv_data, "forced-idr", 1, 0);
     }
 
     if(m_ctx->oformat->flags & AVFMT_GLOBALHEADER)
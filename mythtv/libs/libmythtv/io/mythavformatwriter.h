@@ -33,6 +33,8 @@ class MTV_PUBLIC MythAVFormatWriter : public MythMediaWriter
     bool SwitchToNextFile    (void) override;
 
     bool NextFrameIsKeyFrame (void);
+    void ForceKeyFrame       (void);
+    long long GetFramesQueued(void) const;
     bool ReOpen              (const QString& Filename);
 
   private:
@@ -61,6 +63,8 @@ class MTV_PUBLIC MythAVFormatWriter : public MythMediaWriter
     QList<std::chrono::milliseconds> m_bufferedVideoFrameTimes;
     QList<int>             m_bufferedVideoFrameTypes;
     QList<std::chrono::milliseconds> m_bufferedAudioFrameTimes;
+    long long              m_keyFrameStart { 0 };
+    bool                   m_forceKeyFrame { false };
 };
 
 #endif
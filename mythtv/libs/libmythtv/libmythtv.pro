@@ -367,6 +367,8 @@ LIBS += -lmythudfread-$$LIBVERSION
 #HLS stuff
 HEADERS += HLS/httplivestream.h
 SOURCES += HLS/httplivestream.cpp
+HEADERS += HLS/httplivestreamsegmenter.h
+SOURCES += HLS/httplivestreamsegmenter.cpp
 HEADERS += HLS/httplivestreambuffer.h
 SOURCES += HLS/httplivestreambuffer.cpp
 HEADERS += HLS/m3u.h
@@ -946,12 +948,14 @@ using_backend {
     HEADERS += recorders/HLS/HLSPlaylistWorker.h
     HEADERS += recorders/HLS/HLSReader.h
     HEADERS += recorders/HLS/HLSSegment.h
+    HEADERS += recorders/HLS/HLSSegmentFetcher.h
     HEADERS += recorders/HLS/HLSStream.h
     HEADERS += recorders/HLS/HLSStreamWorker.h
 
     SOURCES += recorders/HLS/HLSPlaylistWorker.cpp
     SOURCES += recorders/HLS/HLSReader.cpp
     SOURCES += recorders/HLS/HLSSegment.cpp
+    SOURCES += recorders/HLS/HLSSegmentFetcher.cpp
     SOURCES += recorders/HLS/HLSStream.cpp
     SOURCES += recorders/HLS/HLSStreamWorker.cpp
 
@@ -5,6 +5,7 @@
 #include "mthreadpool.h"
 #include "mythlogging.h"
 #include "mythcommflagplayer.h"
+#include "io/mythmediabuffer.h"
 
 // Std
 #include <unistd.h>
@@ -252,3 +253,54 @@ MythVideoFrame* MythCommFlagPlayer::GetRawVideoFrame(long long FrameNumber)
     return m_videoOutput->GetLastShownFrame();
 }
 
+
+/*! \brief Creates an independent player for the recording being flagged.
+ *
+ *   The new player has its own buffer and decoder and uses the same flags as
+ *   this player, so that several parts of a recording can be analysed
+ *   concurrently. The caller owns the returned context, which owns the new
+ *   player and buffer.
+ */
+PlayerContext* MythCommFlagPlayer::CreateWorkerContext(void)
+{
+    QString filename = m_playerCtx->m_buffer ?
+        m_playerCtx->m_buffer->GetFilename() : QString();
+    MythMediaBuffer *buffer = MythMediaBuffer::Create(filename, false);
+    if (!buffer)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to create worker buffer for %1").arg(filename));
+        return nullptr;
+    }
+
+    auto *ctx = new PlayerContext(kFlaggerInUseID);
+    auto *player = new MythCommFlagPlayer(ctx, m_playerFlags);
+    m_playerCtx->LockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetPlayingInfo(m_playerCtx->m_playingInfo);
+    m_playerCtx->UnlockPlayingInfo(__FILE__, __LINE__);
+    ctx->SetRingBuffer(buffer);
+    ctx->SetPlayer(player);
+    return ctx;
+}
+
+/*! \brief Returns the last keyframe in the position map at or before
+ *         FrameNumber, or -1 if there is no position map.
+ */
+long long MythCommFlagPlayer::GetKeyframeAtOrBefore(long long FrameNumber)
+{
+    QMutexLocker locker(&m_decoderChangeLock);
+    return m_decoder ? m_decoder->GetKeyframeAtOrBefore(FrameNumber) : -1;
+}
+
+/// \brief Returns the frame numbers of all keyframes in the position map.
+std::vector<long long> MythCommFlagPlayer::GetKeyframes(void)
+{
+    QMutexLocker locker(&m_decoderChangeLock);
+    return m_decoder ? m_decoder->GetKeyframes() : std::vector<long long>();
+}
+
+/// \brief Returns the filename or URL of the recording being flagged.
+QString MythCommFlagPlayer::GetFilename(void) const
+{
+    return m_playerCtx->m_buffer ? m_playerCtx->m_buffer->GetFilename() : QString();
+}
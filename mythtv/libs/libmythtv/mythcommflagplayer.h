@@ -28,6 +28,10 @@ class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
     explicit MythCommFlagPlayer(PlayerContext* Context, PlayerFlags Flags = kNoFlags);
     bool RebuildSeekTable(bool ShowPercentage = true, StatusCallback Callback = nullptr, void* Opaque = nullptr);
     MythVideoFrame* GetRawVideoFrame(long long FrameNumber = -1);
+    PlayerContext*  CreateWorkerContext(void);
+    long long       GetKeyframeAtOrBefore(long long FrameNumber);
+    std::vector<long long> GetKeyframes(void);
+    QString         GetFilename(void) const;
 };
 
 #endif
@@ -192,6 +192,9 @@ void MythPreviewPlayer::SeekForScreenGrab(uint64_t& Number, uint64_t FrameNum, b
         }
     }
 
+    // When only a representative frame is needed (e.g. batch regeneration)
+    // snap to the nearest keyframe from the position map rather than decoding
+    // forward to the exact frame.
     DiscardVideoFrame(m_videoOutput->GetLastDecodedFrame());
-    DoJumpToFrame(Number, kInaccuracyNone);
+    DoJumpToFrame(Number, m_keyframeSeek ? kInaccuracyFull : kInaccuracyNone);
 }
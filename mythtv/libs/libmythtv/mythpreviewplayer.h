@@ -12,9 +12,12 @@ class MythPreviewPlayer : public MythPlayer
                                int& FrameWidth, int& FrameHeight, float& AspectRatio);
     char* GetScreenGrab       (std::chrono::seconds SecondsIn, int& BufferSize, int& FrameWidth,
                                int& FrameHeight, float& AspectRatio);
+    void  SetKeyframeSeek(bool KeyframeOnly) { m_keyframeSeek = KeyframeOnly; }
 
   private:
     void  SeekForScreenGrab(uint64_t& Number, uint64_t FrameNum, bool Absolute);
+
+    bool  m_keyframeSeek { false };
 };
 
 #endif
@@ -689,12 +689,14 @@ bool PreviewGenerator::LocalPreviewRun(void)
     int sz = 0;
     auto *data = (unsigned char*) GetScreenGrab(m_programInfo, m_pathname,
                                                 captime, capframe,
-                                                sz, width, height, aspect);
-
-    QString outname = CreateAccessibleFilename(m_pathname, m_outFileName);
+                                                sz, width, height, aspect,
+                                                m_keyframeOnly);
 
     QString format = (m_outFormat.isEmpty()) ? "PNG" : m_outFormat;
 
+    QString outname = CreateAccessibleFilename(m_pathname, m_outFileName,
+                                               format);
+
     int dw = (m_outSize.width()  < 0) ? width  : m_outSize.width();
     int dh = (m_outSize.height() < 0) ? height : m_outSize.height();
 
@@ -718,9 +720,12 @@ bool PreviewGenerator::LocalPreviewRun(void)
 }
 
 QString PreviewGenerator::CreateAccessibleFilename(
-    const QString &pathname, const QString &outFileName)
+    const QString &pathname, const QString &outFileName, const QString &format)
 {
-    QString outname = pathname + ".png";
+    QString ext = format.toLower();
+    if (ext == "jpeg")
+        ext = "jpg";
+    QString outname = pathname + "." + ext;
 
     if (outFileName.isEmpty())
         return outname;
@@ -784,6 +789,8 @@ bool PreviewGenerator::IsLocal(void) const
  *  \param video_width  Returns width of frame grabbed.
  *  \param video_height Returns height of frame grabbed.
  *  \param video_aspect Returns aspect ratio of frame grabbed.
+ *  \param keyframe_only Grab the keyframe closest to the requested
+ *                      position rather than the exact frame.
  *  \return Buffer allocated with new containing frame in RGBA32 format if
  *          successful, nullptr otherwise.
  */
@@ -791,7 +798,8 @@ char *PreviewGenerator::GetScreenGrab(
     const ProgramInfo &pginfo, const QString &filename,
     std::chrono::seconds seektime, long long seekframe,
     int &bufferlen,
-    int &video_width, int &video_height, float &video_aspect)
+    int &video_width, int &video_height, float &video_aspect,
+    bool keyframe_only)
 {
     char *retbuf = nullptr;
     bufferlen = 0;
@@ -829,6 +837,7 @@ char *PreviewGenerator::GetScreenGrab(
     ctx->SetRingBuffer(buffer);
     ctx->SetPlayingInfo(&pginfo);
     ctx->SetPlayer(player);
+    player->SetKeyframeSeek(keyframe_only);
 
     if (seektime >= 0s)
     {
@@ -31,7 +31,9 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                               std::chrono::seconds previewSeconds,
                               QSize          previewSize,
                               const QString &infile,
-                              const QString &outfile);
+                              const QString &outfile,
+                              const QString &outformat,
+                              bool           keyframeOnly);
 
     Q_OBJECT
 
@@ -59,8 +61,15 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
         { SetPreviewTime(-1s, frame_number); }
     void SetOutputFilename(const QString &fileName);
     void SetOutputSize(const QSize size) { m_outSize = size; }
+    void SetOutputFormat(const QString &format) { m_outFormat = format; }
+    /// Grab the keyframe nearest the requested position instead of
+    /// decoding up to the exact frame.
+    void SetKeyframeOnly(bool keyframeOnly) { m_keyframeOnly = keyframeOnly; }
 
     QString GetToken(void) const { return m_token; }
+    static QString CreateAccessibleFilename(
+        const QString &pathname, const QString &outFileName,
+        const QString &format = "PNG");
 
     void run(void) override; // MThread
     bool Run(void);
@@ -87,7 +96,8 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                                int               &bufferlen,
                                int               &video_width,
                                int               &video_height,
-                               float             &video_aspect);
+                               float             &video_aspect,
+                               bool               keyframe_only = false);
 
     static bool SavePreview(const QString &filename,
                             const unsigned char *data,
@@ -96,9 +106,6 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                             const QString &format);
 
 
-    static QString CreateAccessibleFilename(
-        const QString &pathname, const QString &outFileName);
-
     bool event(QEvent *e) override; // QObject
     bool SaveOutFile(const QByteArray &data, const QDateTime &dt);
 
@@ -117,6 +124,7 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
     QString            m_outFileName;
     QSize              m_outSize       {0,0};
     QString            m_outFormat     {"PNG"};
+    bool               m_keyframeOnly  {false};
 
     QString            m_token;
     bool               m_gotReply      {false};
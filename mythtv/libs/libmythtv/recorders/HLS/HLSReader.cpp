@@ -1,3 +1,5 @@
+// C/C++
+#include <algorithm>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -6,6 +8,9 @@
 
 #define LOC QString("%1: ").arg(m_curstream ? m_curstream->M3U8Url() : "HLSReader")
 
+// Most segments that are downloaded at the same time
+static constexpr int kMaxFetchers { 4 };
+
 /**
  * Handles relative URLs without breaking URI encoded parameters by avoiding
  * storing the decoded URL in a QString.
@@ -118,6 +123,13 @@ bool HLSReader::Open(const QString & m3u, int bitrate_index)
 
     QMutexLocker worker_lock(&m_workerLock);
 
+    for (int i = 0; i < kMaxFetchers; ++i)
+    {
+        auto *fetcher = new HLSSegmentFetcher(this);
+        fetcher->start();
+        m_fetchers.push_back(fetcher);
+    }
+
     m_playlistWorker = new HLSPlaylistWorker(this);
     m_playlistWorker->start();
 
@@ -148,6 +160,15 @@ void HLSReader::Close(bool quiet)
     m_streamWorker = nullptr;
     delete m_playlistWorker;
     m_playlistWorker = nullptr;
+    qDeleteAll(m_fetchers);
+    m_fetchers.clear();
+
+    m_fetchLock.lock();
+    m_fetched.clear();
+    m_fetchLock.unlock();
+    m_fetchHistory.clear();
+    m_downloadTime = 0;
+    m_bandwidth = 0;
 
     LOG(VB_RECORD, (quiet ? LOG_DEBUG : LOG_INFO), LOC + "Close -- end");
 }
@@ -162,6 +183,10 @@ void HLSReader::Cancel(bool quiet)
     m_throttleCond.wakeAll();
     m_throttleLock.unlock();
 
+    m_fetchLock.lock();
+    m_fetchCond.wakeAll();
+    m_fetchLock.unlock();
+
     QMutexLocker lock(&m_workerLock);
 
     if (m_curstream)
@@ -173,6 +198,9 @@ void HLSReader::Cancel(bool quiet)
     if (m_streamWorker)
         m_streamWorker->Cancel();
 
+    for (auto *fetcher : qAsConst(m_fetchers))
+        fetcher->Cancel();
+
 #ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
     if (!m_sements.empty())
         CancelURL(m_segments.front().Url());
@@ -602,13 +630,15 @@ bool HLSReader::ParseM3U8(const QByteArray& buffer, HLSRecStream* stream)
                         "playlist size: %3, queued: %4")
                 .arg(behind).arg(behind - max_behind)
                 .arg(m_playlistSize).arg(m_segments.size()));
+            EnableDebugging();
+            Iseg = m_segments.begin() + (behind - max_behind);
+
             m_workerLock.lock();
             if (m_streamWorker)
                 m_streamWorker->CancelCurrentDownload();
+            CancelFetches((*Iseg).Sequence());
             m_workerLock.unlock();
 
-            EnableDebugging();
-            Iseg = m_segments.begin() + (behind - max_behind);
             m_segments.erase(m_segments.begin(), Iseg);
             m_bandwidthCheck = (m_bitrateIndex == 0);
         }
@@ -637,6 +667,12 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
     if (m_bandwidthCheck /* && !m_segments.empty() */)
     {
         int buffered = PercentBuffered();
+        uint64_t bandwidth = m_bandwidth;
+
+        m_seqLock.lock();
+        int playlistSize = m_playlistSize;
+        int queued       = m_segments.size();
+        m_seqLock.unlock();
 
         if (buffered < 15)
         {
@@ -645,21 +681,27 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
                 QString("Falling behind: only %1% buffered").arg(buffered));
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("playlist size %1, queued %2")
-                .arg(m_playlistSize).arg(m_segments.size()));
+                .arg(playlistSize).arg(queued));
             EnableDebugging();
             DecreaseBitrate(m_curstream->Id());
             m_bandwidthCheck = false;
         }
+        else if (bandwidth > 0)
+        {
+            // Pick the stream that the measured bandwidth can keep up with
+            SelectBitrate(m_curstream->Id(), bandwidth);
+            m_bandwidthCheck = false;
+        }
         else if (buffered > 85)
         {
             // Keeping up easily, raise the bitrate.
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("Plenty of bandwidth, downloading %1 of %2")
-                .arg(m_playlistSize - m_segments.size())
-                .arg(m_playlistSize));
+                .arg(playlistSize - queued)
+                .arg(playlistSize));
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("playlist size %1, queued %2")
-                .arg(m_playlistSize).arg(m_segments.size()));
+                .arg(playlistSize).arg(queued));
             IncreaseBitrate(m_curstream->Id());
             m_bandwidthCheck = false;
         }
@@ -766,6 +808,46 @@ void HLSReader::IncreaseBitrate(int progid)
     }
 }
 
+/**
+ * Switch to the highest bitrate stream that fits in the bandwidth,
+ * leaving some headroom.  Returns true if the stream was changed.
+ */
+bool HLSReader::SelectBitrate(int progid, uint64_t bandwidth)
+{
+    HLSRecStream *hls = nullptr;
+    HLSRecStream *lowest = nullptr;
+    uint64_t usable = bandwidth / 10 * 8;
+
+    for (auto Istream = m_streams.cbegin(); Istream != m_streams.cend(); ++Istream)
+    {
+        if ((*Istream)->Id() != progid)
+            continue;
+        if (lowest == nullptr || (*Istream)->Bitrate() < lowest->Bitrate())
+            lowest = *Istream;
+        if ((*Istream)->Bitrate() <= usable &&
+            (hls == nullptr || (*Istream)->Bitrate() > hls->Bitrate()))
+            hls = *Istream;
+    }
+
+    if (hls == nullptr)
+        hls = lowest;
+
+    if (hls == nullptr || hls == m_curstream)
+    {
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Bandwidth %1kiB/s, keeping bitrate %2")
+            .arg(bandwidth / 8192).arg(m_curstream->Bitrate()));
+        return false;
+    }
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Bandwidth %1kiB/s, switching stream bitrate %2 -> %3")
+        .arg(bandwidth / 8192).arg(m_curstream->Bitrate())
+        .arg(hls->Bitrate()));
+    m_curstream = hls;
+    return true;
+}
+
 bool HLSReader::LoadSegments(MythSingleDownload& downloader)
 {
     LOG(VB_RECORD, LOG_DEBUG, LOC + "LoadSegment -- start");
@@ -804,6 +886,7 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
                 .arg(m_playlistSize - m_segments.size() + 1)
                 .arg(m_playlistSize));
         }
+        FetchSegments();
         m_seqLock.unlock();
 
         m_streamLock.lock();
@@ -815,7 +898,20 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
             return false;
         }
 
-        long throttle = DownloadSegmentData(downloader,hls,seg,m_playlistSize);
+        FetchedSegment fetched;
+        if (!WaitForSegment(seg.Sequence(), fetched))
+            continue;
+
+        // The playlist worker may have skipped ahead while we waited
+        m_seqLock.lock();
+        bool current = (!m_segments.empty() &&
+                        m_segments.front().Sequence() == seg.Sequence());
+        m_seqLock.unlock();
+        if (!current)
+            continue;
+
+        long throttle = fetched.m_ok ?
+            DownloadSegmentData(downloader, hls, seg, fetched, m_playlistSize) : -1;
 
         m_seqLock.lock();
         if (throttle < 0)
@@ -869,20 +965,183 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
 
 uint HLSReader::PercentBuffered(void) const
 {
+    QMutexLocker lock(&m_seqLock);
     if (m_playlistSize == 0 || m_segments.size() > m_playlistSize)
         return 0;
     return (static_cast<float>(m_playlistSize - m_segments.size()) /
             static_cast<float>(m_playlistSize)) * 100.0F;
 }
 
+int HLSReader::BufferedBytes(void) const
+{
+    QMutexLocker lock(&m_bufLock);
+    return m_buffer.size();
+}
+
+/**
+ * How many segments to download at the same time.
+ *
+ * Enough of the playlist is kept in flight that a slow response to one
+ * request doesn't hold up the rest.  When each segment takes a large part
+ * of its duration to arrive, or we have fallen behind, the latency is
+ * what limits us, so all of the fetchers are used.
+ *
+ * Must be called with m_seqLock held.
+ */
+int HLSReader::PrefetchDepth(void) const
+{
+    // Only one segment at a time while pre-buffering
+    if (m_throttle)
+        return 1;
+
+    int depth = std::max(1, m_playlistSize / 3);
+
+    std::chrono::milliseconds target = TargetDuration();
+    if (target > 0ms && DownloadTime() > target / 2)
+        depth = kMaxFetchers;
+    if (m_segments.size() > m_playlistSize / 2)
+        depth = kMaxFetchers;
+
+    return std::min(depth, kMaxFetchers);
+}
+
+/**
+ * Give the segments at the front of the queue to idle fetchers.
+ *
+ * Must be called with m_seqLock held.
+ */
+void HLSReader::FetchSegments(void)
+{
+    int depth = std::min(PrefetchDepth(), m_segments.size());
+
+    QVector<int64_t> busy;
+    for (auto *fetcher : qAsConst(m_fetchers))
+    {
+        int64_t sequence = fetcher->Sequence();
+        if (sequence >= 0)
+            busy.push_back(sequence);
+    }
+
+    QMutexLocker lock(&m_fetchLock);
+    for (int i = 0; i < depth; ++i)
+    {
+        const HLSRecSegment& segment = m_segments[i];
+        if (busy.contains(segment.Sequence()) ||
+            m_fetched.contains(segment.Sequence()))
+            continue;
+
+        auto Ifetcher = std::find_if(m_fetchers.cbegin(), m_fetchers.cend(),
+                                     [&segment](HLSSegmentFetcher *fetcher)
+                                     { return fetcher->Fetch(segment); });
+        if (Ifetcher == m_fetchers.cend())
+            break;
+
+        busy.push_back(segment.Sequence());
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Fetching segment %1 (%2 in flight)")
+            .arg(segment.Sequence()).arg(busy.size()));
+    }
+}
+
+/**
+ * Cancel downloads of segments that have been dropped from the queue.
+ */
+void HLSReader::CancelFetches(int64_t before)
+{
+    for (auto *fetcher : qAsConst(m_fetchers))
+    {
+        int64_t sequence = fetcher->Sequence();
+        if (sequence >= 0 && sequence < before)
+            fetcher->CancelCurrentDownload();
+    }
+}
+
+/**
+ * Wait for the segment to be downloaded.  Returns false if it hasn't
+ * arrived within a second, so that the caller can hand out more work.
+ */
+bool HLSReader::WaitForSegment(int64_t sequence, FetchedSegment& fetched)
+{
+    QMutexLocker lock(&m_fetchLock);
+
+    if (!m_fetched.contains(sequence) && !m_cancel)
+        m_fetchCond.wait(&m_fetchLock, 1000);
+
+    auto Ifetched = m_fetched.find(sequence);
+    if (Ifetched == m_fetched.end())
+        return false;
+
+    fetched = *Ifetched;
+
+    // Anything older was skipped
+    m_fetched.erase(m_fetched.begin(), ++Ifetched);
+    return true;
+}
+
+void HLSReader::SegmentFetched(int64_t sequence, bool ok, QByteArray& data,
+                               std::chrono::milliseconds start,
+                               std::chrono::milliseconds end)
+{
+    FetchedSegment fetched;
+    fetched.m_ok    = ok;
+    fetched.m_data  = data;
+    fetched.m_size  = data.size();
+    fetched.m_start = start;
+    fetched.m_end   = end;
+
+    QMutexLocker lock(&m_fetchLock);
+    m_fetched.insert(sequence, fetched);
+    m_fetchCond.wakeAll();
+}
+
+/**
+ * Measure the bandwidth of the last few downloads.  Only the time spent
+ * downloading counts, so that waiting for a live playlist to grow doesn't
+ * lower it, and downloads that overlap are counted once.
+ */
+void HLSReader::UpdateBandwidth(const FetchedSegment& fetched)
+{
+    FetchedSegment timing;
+    timing.m_size  = fetched.m_size;
+    timing.m_start = fetched.m_start;
+    timing.m_end   = fetched.m_end;
+
+    m_fetchHistory.enqueue(timing);
+    while (m_fetchHistory.size() > 2 * kMaxFetchers)
+        m_fetchHistory.dequeue();
+
+    QVector<FetchedSegment> history = m_fetchHistory.toVector();
+    std::sort(history.begin(), history.end(),
+              [](const FetchedSegment& a, const FetchedSegment& b)
+              { return a.m_start < b.m_start; });
+
+    int64_t bytes = 0;
+    std::chrono::milliseconds busy = 0ms;
+    std::chrono::milliseconds until = 0ms;
+    for (const auto& item : qAsConst(history))
+    {
+        bytes += item.m_size;
+        std::chrono::milliseconds from = std::max(item.m_start, until);
+        if (item.m_end > from)
+            busy += item.m_end - from;
+        until = std::max(until, item.m_end);
+    }
+
+    if (busy < 1ms)
+        busy = 1ms;
+
+    m_bandwidth = bytes * 8 * 1000ULL / busy.count();
+}
+
 int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
                                    HLSRecStream* hls,
-                                   const HLSRecSegment& segment, int playlist_size)
+                                   const HLSRecSegment& segment,
+                                   FetchedSegment& fetched, int playlist_size)
 {
     uint64_t bandwidth = hls->AverageBandwidth();
 
     LOG(VB_RECORD, LOG_DEBUG, LOC +
-        QString("Downloading %1 bandwidth %2 bitrate %3")
+        QString("Appending %1 bandwidth %2 bitrate %3")
         .arg(segment.Sequence()).arg(bandwidth).arg(hls->Bitrate()));
 
     /* sanity check - can we download this segment on time? */
@@ -902,37 +1161,8 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
         }
     }
 
-    QByteArray buffer;
-    auto start = nowAsDuration<std::chrono::milliseconds>();
-
-#ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
-                                   // and can only handle six download at a time
-    if (!HLSReader::DownloadURL(segment.Url(), &buffer))
-    {
-        LOG(VB_RECORD, LOG_ERR, LOC +
-            QString("%1 failed").arg(segment.Sequence()));
-        if (estimated_time * 2 < segment.Duration())
-        {
-            if (!HLSReader::DownloadURL(segment.Url(), &buffer))
-            {
-                LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed")
-                    .arg(segment.Sequence()));
-                return -1;
-            }
-        }
-        else
-            return 0;
-    }
-#else
-    if (!downloader.DownloadURL(segment.Url(), &buffer))
-    {
-        LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
-            .arg(segment.Sequence()).arg(downloader.ErrorString()));
-        return -1;
-    }
-#endif
-
-    auto downloadduration = nowAsDuration<std::chrono::milliseconds>() - start;
+    QByteArray buffer = fetched.m_data;
+    auto downloadduration = fetched.m_end - fetched.m_start;
 
 #ifdef USING_LIBCRYPTO
     /* If the segment is encrypted, decode it */
@@ -986,6 +1216,9 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     if (downloadduration < 1ms)
         downloadduration = 1ms;
 
+    m_downloadTime = downloadduration.count();
+    UpdateBandwidth(fetched);
+
     /* bits/sec */
     bandwidth = segment_len * 8 * 1000ULL / downloadduration.count();
     hls->AverageBandwidth(bandwidth);
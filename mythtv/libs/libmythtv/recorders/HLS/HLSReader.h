@@ -1,7 +1,10 @@
 #ifndef HLS_READER_H
 #define HLS_READER_H
 
+#include <atomic>
+
 #include <QObject>
+#include <QQueue>
 #include <QString>
 #include <QUrl>
 #include <QTextStream>
@@ -29,12 +32,14 @@
 #include "HLSStream.h"
 #include "HLSStreamWorker.h"
 #include "HLSPlaylistWorker.h"
+#include "HLSSegmentFetcher.h"
 
 
 class MTV_PUBLIC  HLSReader
 {
     friend class HLSStreamWorker;
     friend class HLSPlaylistWorker;
+    friend class HLSSegmentFetcher;
 
   public:
     using StreamContainer = QMap<QString, HLSRecStream* >;
@@ -68,10 +73,16 @@ class MTV_PUBLIC  HLSReader
 
     static bool IsValidPlaylist(QTextStream & text);
 
+    // Statistics, for the signal monitor
+    uint PercentBuffered(void) const;
+    int  BufferedBytes(void) const;
+    std::chrono::milliseconds DownloadTime(void) const
+    { return std::chrono::milliseconds(m_downloadTime.load()); }
+    uint64_t Bandwidth(void) const { return m_bandwidth; }
+
   protected:
     void Cancel(bool quiet = false);
     bool LoadSegments(MythSingleDownload& downloader);
-    uint PercentBuffered(void) const;
     std::chrono::seconds TargetDuration(void) const
     { return (m_curstream ? m_curstream->TargetDuration() : 0s); }
 
@@ -85,11 +96,30 @@ class MTV_PUBLIC  HLSReader
     bool ParseM3U8(const QByteArray & buffer, HLSRecStream* stream = nullptr);
     void DecreaseBitrate(int progid);
     void IncreaseBitrate(int progid);
+    bool SelectBitrate(int progid, uint64_t bandwidth);
 
     // Downloading
+    struct FetchedSegment
+    {
+        bool                      m_ok    {false};
+        QByteArray                m_data;
+        int                       m_size  {0};
+        std::chrono::milliseconds m_start {0ms};
+        std::chrono::milliseconds m_end   {0ms};
+    };
+
     bool LoadSegments(HLSRecStream & hlsstream);
+    int  PrefetchDepth(void) const;
+    void FetchSegments(void);
+    void CancelFetches(int64_t before);
+    bool WaitForSegment(int64_t sequence, FetchedSegment& fetched);
+    void SegmentFetched(int64_t sequence, bool ok, QByteArray& data,
+                        std::chrono::milliseconds start,
+                        std::chrono::milliseconds end);
+    void UpdateBandwidth(const FetchedSegment& fetched);
     int DownloadSegmentData(MythSingleDownload& downloader, HLSRecStream* hls,
-			    const HLSRecSegment& segment, int playlist_size);
+			    const HLSRecSegment& segment,
+			    FetchedSegment& fetched, int playlist_size);
 
     // Debug
     void EnableDebugging(void);
@@ -111,11 +141,12 @@ class MTV_PUBLIC  HLSReader
 
     HLSPlaylistWorker *m_playlistWorker {nullptr};
     HLSStreamWorker   *m_streamWorker   {nullptr};
+    QVector<HLSSegmentFetcher*> m_fetchers;
 
     int                m_playlistSize   {0};
     bool               m_bandwidthCheck {false};
     uint               m_prebufferCnt   {10};
-    QMutex             m_seqLock;
+    mutable QMutex     m_seqLock;
     mutable QMutex     m_streamLock;
     mutable QMutex     m_workerLock;
     QMutex             m_throttleLock;
@@ -126,7 +157,15 @@ class MTV_PUBLIC  HLSReader
     // Downloading
     int                m_slowCnt        {0};
     QByteArray         m_buffer;
-    QMutex             m_bufLock;
+    mutable QMutex     m_bufLock;
+
+    // Segments downloaded out of order, waiting for their turn
+    QMap<int64_t, FetchedSegment> m_fetched;
+    QMutex             m_fetchLock;
+    QWaitCondition     m_fetchCond;
+    QQueue<FetchedSegment> m_fetchHistory; // sizes and times, data dropped
+    std::atomic<int64_t>  m_downloadTime {0}; // ms, for the last segment
+    std::atomic<uint64_t> m_bandwidth    {0}; // bits/sec, all fetchers
 };
 
 #endif // HLS_READER_H
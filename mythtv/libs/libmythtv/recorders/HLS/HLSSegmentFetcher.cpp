@@ -0,0 +1,125 @@
+#include "HLSReader.h"
+#include "HLSSegmentFetcher.h"
+
+#define LOC QString("%1 fetcher: ").arg(m_parent->StreamURL().isEmpty() ? "Segment" : m_parent->StreamURL())
+
+HLSSegmentFetcher::HLSSegmentFetcher(HLSReader *parent)
+    : MThread("HLSSegment"),
+      m_parent(parent)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "ctor");
+}
+
+HLSSegmentFetcher::~HLSSegmentFetcher(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "dtor");
+}
+
+/**
+ * Start downloading the segment, returns false if a download is already
+ * in progress.
+ */
+bool HLSSegmentFetcher::Fetch(const HLSRecSegment& segment)
+{
+    QMutexLocker lock(&m_lock);
+    if (m_cancel || m_sequence >= 0)
+        return false;
+
+    m_segment  = segment;
+    m_sequence = segment.Sequence();
+    m_pending  = true;
+    m_waitCond.wakeAll();
+    return true;
+}
+
+/**
+ * The sequence number of the segment being downloaded, or -1 if idle.
+ */
+int64_t HLSSegmentFetcher::Sequence(void) const
+{
+    QMutexLocker lock(&m_lock);
+    return m_sequence;
+}
+
+void HLSSegmentFetcher::Cancel(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "Cancel -- begin");
+    m_lock.lock();
+    m_cancel = true;
+    m_waitCond.wakeAll();
+    m_lock.unlock();
+    CancelCurrentDownload();
+    wait();
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "Cancel -- end");
+}
+
+void HLSSegmentFetcher::CancelCurrentDownload(void)
+{
+    QMutexLocker locker(&m_downloaderLock);
+    if (m_downloader)
+        m_downloader->Cancel();
+}
+
+void HLSSegmentFetcher::run(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "run -- begin");
+    RunProlog();
+
+    m_downloaderLock.lock();
+    m_downloader = new MythSingleDownload;
+    m_downloaderLock.unlock();
+
+    QMutexLocker lock(&m_lock);
+    while (!m_cancel)
+    {
+        if (!m_pending)
+        {
+            m_waitCond.wait(&m_lock);
+            continue;
+        }
+
+        HLSRecSegment segment = m_segment;
+        m_pending = false;
+        lock.unlock();
+
+        QByteArray buffer;
+        auto start = nowAsDuration<std::chrono::milliseconds>();
+
+#ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
+        bool ok = HLSReader::DownloadURL(segment.Url().toString(), &buffer);
+#else
+        bool ok = m_downloader->DownloadURL(segment.Url(), &buffer);
+#endif
+
+        auto end = nowAsDuration<std::chrono::milliseconds>();
+
+        if (!ok)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
+                .arg(segment.Sequence()).arg(m_downloader->ErrorString()));
+
+            // Asking QNetworkAccessManager to redownload after a
+            // failure seems to result in another failure, even if the
+            // segment is now available.  So, create a new instance.
+            m_downloaderLock.lock();
+            delete m_downloader;
+            m_downloader = new MythSingleDownload;
+            m_downloaderLock.unlock();
+        }
+
+        m_parent->SegmentFetched(segment.Sequence(), ok, buffer, start, end);
+
+        lock.relock();
+        m_sequence = -1;
+    }
+    lock.unlock();
+
+    m_downloaderLock.lock();
+    m_downloader->Cancel();
+    delete m_downloader;
+    m_downloader = nullptr;
+    m_downloaderLock.unlock();
+
+    RunEpilog();
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "run -- end");
+}
@@ -0,0 +1,48 @@
+#ifndef HLS_SEGMENT_FETCHER_H
+#define HLS_SEGMENT_FETCHER_H
+
+#include <QWaitCondition>
+#include <QMutex>
+
+#include "mthread.h"
+#include "HLSSegment.h"
+
+class HLSReader;
+class MythSingleDownload;
+
+/*
+  Downloads one segment at a time on behalf of the HLSStreamWorker.
+
+  The reader runs several of these so that, on a high latency source,
+  the next segments are already on their way while the current one is
+  downloading.  The data is handed back to the reader, which appends
+  the segments to its buffer in sequence order.
+*/
+class HLSSegmentFetcher : public MThread
+{
+  public:
+    explicit HLSSegmentFetcher(HLSReader* parent);
+    ~HLSSegmentFetcher(void) override;
+
+    bool Fetch(const HLSRecSegment& segment);
+    int64_t Sequence(void) const;
+    void Cancel(void);
+    void CancelCurrentDownload(void);
+
+  protected:
+    void run() override; // MThread
+
+  private:
+    // Class vars
+    HLSReader          *m_parent     {nullptr};
+    MythSingleDownload *m_downloader {nullptr};
+    HLSRecSegment       m_segment;
+    bool                m_pending    {false};
+    int64_t             m_sequence   {-1};
+    bool                m_cancel     {false};
+    mutable QMutex      m_lock;
+    QMutex              m_downloaderLock;
+    QWaitCondition      m_waitCond;
+};
+
+#endif // HLS_SEGMENT_FETCHER_H
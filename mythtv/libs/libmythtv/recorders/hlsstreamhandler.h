@@ -30,6 +30,8 @@ class HLSStreamHandler : public IPTVStreamHandler
     HLSStreamHandler(const HLSStreamHandler &) = delete;            // not copyable
     HLSStreamHandler &operator=(const HLSStreamHandler &) = delete; // not copyable
 
+    const HLSReader *GetReader(void) const { return m_hls; }
+
   protected:
     explicit HLSStreamHandler(const IPTVTuningData &tuning, int inputid);
     ~HLSStreamHandler(void) override;
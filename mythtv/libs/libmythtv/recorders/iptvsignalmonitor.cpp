@@ -4,6 +4,8 @@
 #include "iptvsignalmonitor.h"
 #include "mpegstreamdata.h"
 #include "iptvchannel.h"
+#include "hlsstreamhandler.h"
+#include "recorders/HLS/HLSReader.h"
 #include "mythlogging.h"
 
 #define LOC QString("IPTVSigMon[%1](%2): ") \
@@ -26,7 +28,11 @@ IPTVSignalMonitor::IPTVSignalMonitor(int db_cardnum,
                                      IPTVChannel *_channel,
                                      bool _release_stream,
                                      uint64_t _flags)
-    : DTVSignalMonitor(db_cardnum, _channel, _release_stream, _flags)
+    : DTVSignalMonitor(db_cardnum, _channel, _release_stream, _flags),
+      m_hlsBuffered    (tr("HLS Buffer"),        "hlsbuf",
+                        0,  true, 0,   100, 0ms),
+      m_hlsDownloadTime(tr("HLS Download Time"), "hlsdl",
+                        0, false, 0, 60000, 0ms)
 {
     LOG(VB_CHANNEL, LOG_INFO, LOC + "ctor");
     m_signalLock.SetValue(0);
@@ -72,6 +78,23 @@ void IPTVSignalMonitor::HandlePAT(const ProgramAssociationTable *pat)
     DTVSignalMonitor::HandlePAT(pat);
 }
 
+/** \fn IPTVSignalMonitor::GetStatusList(void) const
+ *  \brief Adds the HLS download statistics to the status list,
+ *         when the channel is an HLS stream.
+ */
+QStringList IPTVSignalMonitor::GetStatusList(void) const
+{
+    QStringList list = DTVSignalMonitor::GetStatusList();
+    m_statusLock.lock();
+    if (m_isHLS)
+    {
+        list<<m_hlsBuffered.GetName()<<m_hlsBuffered.GetStatus();
+        list<<m_hlsDownloadTime.GetName()<<m_hlsDownloadTime.GetStatus();
+    }
+    m_statusLock.unlock();
+    return list;
+}
+
 /** \fn IPTVSignalMonitor::UpdateValues(void)
  *  \brief Fills in frontend stats and emits status Qt signals.
  *
@@ -95,6 +118,25 @@ void IPTVSignalMonitor::UpdateValues(void)
         m_locked = true;
     }
 
+    auto *hsh = dynamic_cast<HLSStreamHandler*>(channel->GetStreamHandler());
+    const HLSReader *reader = hsh ? hsh->GetReader() : nullptr;
+    if (reader != nullptr)
+    {
+        uint buffered = reader->PercentBuffered();
+        std::chrono::milliseconds download = reader->DownloadTime();
+        {
+            QMutexLocker locker(&m_statusLock);
+            m_hlsBuffered.SetValue(buffered);
+            m_hlsDownloadTime.SetValue(download.count());
+            m_isHLS = true;
+        }
+        LOG(VB_CHANNEL, LOG_DEBUG, LOC +
+            QString("HLS buffered %1% (%2 bytes), last segment took %3ms, "
+                    "bandwidth %4kiB/s")
+            .arg(buffered).arg(reader->BufferedBytes())
+            .arg(download.count()).arg(reader->Bandwidth() / 8192));
+    }
+
     EmitStatus();
     if (IsAllGood())
         SendMessageAllGood();
@@ -3,6 +3,11 @@
 #ifndef IPTVSIGNALMONITOR_H
 #define IPTVSIGNALMONITOR_H
 
+// Qt headers
+#include <QStringList>
+#include <QCoreApplication>
+
+// MythTV headers
 #include "dtvsignalmonitor.h"
 
 class IPTVChannel;
@@ -10,6 +15,8 @@ class IPTVSignalMonitor;
 
 class IPTVSignalMonitor : public DTVSignalMonitor
 {
+    Q_DECLARE_TR_FUNCTIONS(IPTVSignalMonitor);
+
     friend class IPTVTableMonitorThread;
   public:
     IPTVSignalMonitor(int db_cardnum, IPTVChannel *_channel,
@@ -24,6 +31,8 @@ class IPTVSignalMonitor : public DTVSignalMonitor
     // MPEG
     void HandlePAT(const ProgramAssociationTable *pat) override; // DTVSignalMonitor
 
+    QStringList GetStatusList(void) const override; // DTVSignalMonitor
+
   protected:
     IPTVSignalMonitor(void);
     IPTVSignalMonitor(const IPTVSignalMonitor&);
@@ -34,6 +43,11 @@ class IPTVSignalMonitor : public DTVSignalMonitor
   protected:
     bool m_streamHandlerStarted {false};
     bool m_locked               {false};
+    bool m_isHLS                {false};
+
+    // HLS download statistics
+    SignalMonitorValue m_hlsBuffered;
+    SignalMonitorValue m_hlsDownloadTime;
 };
 
 #endif // IPTVSIGNALMONITOR_H
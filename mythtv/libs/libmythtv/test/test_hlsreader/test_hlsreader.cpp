@@ -0,0 +1,182 @@
+/*
+ *  Class TestHLSReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "test_hlsreader.h"
+#include "recorders/HLS/HLSReader.h"
+
+std::chrono::milliseconds HLSTestServer::TotalLatency(void)
+{
+    std::chrono::milliseconds total = 0ms;
+    for (int i = 0; i < kSegments; ++i)
+        total += Latency(i);
+    return total;
+}
+
+QString HLSTestServer::Url(void) const
+{
+    return QString("http://127.0.0.1:%1/master.m3u8").arg(serverPort());
+}
+
+void HLSTestServer::Advance(std::chrono::milliseconds Step)
+{
+    if (m_pending.isEmpty())
+        return;
+
+    m_clock += Step;
+    auto due = std::stable_partition(m_pending.begin(), m_pending.end(),
+                                     [this](const Pending &p)
+                                     { return p.m_due > m_clock; });
+    for (auto it = due; it != m_pending.end(); ++it)
+    {
+        if (it->m_socket)
+            Reply(it->m_socket, "video/mp2t", it->m_body);
+    }
+    m_pending.erase(due, m_pending.end());
+}
+
+void HLSTestServer::incomingConnection(qintptr socketDescriptor)
+{
+    auto *socket = new QTcpSocket(this);
+    socket->setSocketDescriptor(socketDescriptor);
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, socket]() { HandleRequest(socket); });
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+}
+
+void HLSTestServer::HandleRequest(QTcpSocket *socket)
+{
+    if (!socket->canReadLine())
+        return;
+
+    // GET /path HTTP/1.1
+    QList<QByteArray> request = socket->readLine().split(' ');
+    socket->readAll();
+    if (request.size() < 2)
+        return;
+    QByteArray path = request[1];
+
+    if (path == "/master.m3u8")
+    {
+        Reply(socket, "application/vnd.apple.mpegurl",
+              "#EXTM3U\n"
+              "#EXT-X-STREAM-INF:PROGRAM-ID=1,BANDWIDTH=1000000\n"
+              "stream.m3u8\n");
+        return;
+    }
+
+    if (path == "/stream.m3u8")
+    {
+        QByteArray playlist = "#EXTM3U\n"
+                              "#EXT-X-VERSION:3\n"
+                              "#EXT-X-TARGETDURATION:1\n"
+                              "#EXT-X-MEDIA-SEQUENCE:0\n";
+        for (int i = 0; i < kSegments; ++i)
+            playlist += QString("#EXTINF:1.0,\nseg%1.ts\n").arg(i).toLatin1();
+        playlist += "#EXT-X-ENDLIST\n";
+        Reply(socket, "application/vnd.apple.mpegurl", playlist);
+        return;
+    }
+
+    int segment = path.mid(4, path.indexOf(".ts") - 4).toInt();
+
+    // Every byte after the sync byte identifies the segment
+    QByteArray body;
+    for (int i = 0; i < kPackets; ++i)
+    {
+        body += '\x47';
+        body += QByteArray(kPacketSize - 1, static_cast<char>(segment));
+    }
+
+    m_pending.append({socket, m_clock + Latency(segment), body});
+    m_peak = std::max(m_peak, static_cast<int>(m_pending.size()));
+}
+
+void HLSTestServer::Reply(QTcpSocket *socket, const QByteArray &type,
+                          const QByteArray &body)
+{
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: " + type + "\r\n"
+                  "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                  "Connection: close\r\n\r\n");
+    socket->write(body);
+    socket->disconnectFromHost();
+}
+
+void TestHLSReader::initTestCase(void)
+{
+    m_server = new HLSTestServer;
+    QVERIFY(m_server->listen(QHostAddress::LocalHost));
+}
+
+void TestHLSReader::cleanupTestCase(void)
+{
+    delete m_server;
+    m_server = nullptr;
+}
+
+/**
+ * Segments that arrive out of order must be read back in playlist order,
+ * and fetching them in parallel must beat downloading them one by one.
+ */
+void TestHLSReader::ParallelFetch(void)
+{
+    HLSReader reader;
+    QElapsedTimer timer;
+    timer.start();
+
+    reader.Throttle(false);
+    QVERIFY(reader.Open(m_server->Url()));
+
+    QByteArray data;
+    std::array<uint8_t, HLSTestServer::kPacketSize * 10> buffer {};
+    while (data.size() < HLSTestServer::kSegments * HLSTestServer::kSegmentSize &&
+           timer.elapsed() < 20000)
+    {
+        int len = reader.Read(buffer.data(), buffer.size());
+        if (len > 0)
+        {
+            data.append(reinterpret_cast<char*>(buffer.data()), len);
+        }
+        else
+        {
+            QTest::qWait(20);
+            m_server->Advance(10ms);
+        }
+    }
+    auto elapsed = m_server->Now();
+    reader.Close();
+
+    QCOMPARE(data.size(), HLSTestServer::kSegments * HLSTestServer::kSegmentSize);
+    for (int i = 0; i < data.size(); i += HLSTestServer::kPacketSize)
+    {
+        QCOMPARE(data[i], '\x47');
+        QCOMPARE(static_cast<int>(data[i + 1]), i / HLSTestServer::kSegmentSize);
+    }
+
+    QVERIFY(m_server->PeakRequests() > 1);
+    QVERIFY2(elapsed < HLSTestServer::TotalLatency(),
+             qPrintable(QString("took %1ms by the server's clock, one by one "
+                                "would take %2ms")
+                        .arg(elapsed.count())
+                        .arg(HLSTestServer::TotalLatency().count())));
+}
+
+QTEST_GUILESS_MAIN(TestHLSReader)
@@ -0,0 +1,88 @@
+/*
+ *  Class TestHLSReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <chrono>
+
+#include <QtTest/QtTest>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+using namespace std::chrono_literals;
+
+/**
+ * Serves a master playlist, a media playlist and its segments over HTTP.
+ * Each segment is held back for a while before it is sent, the earlier
+ * ones for longer, so that they finish downloading out of order.
+ *
+ * The server keeps its own clock, which only moves when the test calls
+ * Advance() while a segment is being held back.  How long the segments
+ * took, by that clock, doesn't depend on how fast the machine is.
+ */
+class HLSTestServer : public QTcpServer
+{
+    Q_OBJECT
+
+  public:
+    static constexpr int kSegments    { 8 };
+    static constexpr int kPackets     { 100 };
+    static constexpr int kPacketSize  { 188 };
+    static constexpr int kSegmentSize { kPackets * kPacketSize };
+
+    static std::chrono::milliseconds Latency(int segment)
+    { return std::chrono::milliseconds(600 - (50 * segment)); }
+    static std::chrono::milliseconds TotalLatency(void);
+
+    QString Url(void) const;
+    int     PeakRequests(void) const { return m_peak; }
+
+    std::chrono::milliseconds Now(void) const { return m_clock; }
+    void Advance(std::chrono::milliseconds Step);
+
+  protected:
+    void incomingConnection(qintptr socketDescriptor) override; // QTcpServer
+
+  private:
+    void HandleRequest(QTcpSocket *socket);
+    static void Reply(QTcpSocket *socket, const QByteArray &type,
+                      const QByteArray &body);
+
+    struct Pending
+    {
+        QPointer<QTcpSocket>      m_socket;
+        std::chrono::milliseconds m_due;
+        QByteArray                m_body;
+    };
+
+    QList<Pending>            m_pending;
+    std::chrono::milliseconds m_clock  { 0ms };
+    int                       m_peak   { 0 };
+};
+
+class TestHLSReader : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase(void);
+    void ParallelFetch(void);
+    void cleanupTestCase(void);
+
+  private:
+    HLSTestServer *m_server { nullptr };
+};
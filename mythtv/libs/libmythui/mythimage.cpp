@@ -6,6 +6,7 @@
 #include <iostream>
 
 // QT headers
+#include <QBuffer>
 #include <QImageReader>
 #include <QNetworkReply>
 #include <QPainter>
@@ -293,7 +294,48 @@ bool MythImage::Load(MythImageReader *reader)
     return false;
 }
 
-bool MythImage::Load(const QString &filename)
+/**
+ * \brief Decodes an image no larger than it needs to be.
+ *
+ * Pictures more than twice as large as decodeSize are scaled down by the
+ * decoder, to no less than decodeSize so that the final resize still has the
+ * detail it needs.  For JPEG this is much faster than a full decode.  Pictures
+ * too large to be a texture of the painter are always scaled down to fit.
+ */
+QImage *MythImage::Decode(QImageReader &reader, QSize decodeSize) const
+{
+    QSize size = reader.size();
+    if (size.isValid())
+    {
+        QSize scaled = size;
+        if (decodeSize.isValid() &&
+            (size.width() > decodeSize.width() * 2 ||
+             size.height() > decodeSize.height() * 2))
+        {
+            scaled = size.scaled(decodeSize, Qt::KeepAspectRatioByExpanding);
+        }
+
+        int maxTexture = m_parent ? m_parent->GetMaxTextureSize() : 0;
+        if (maxTexture > 0 &&
+            (scaled.width() > maxTexture || scaled.height() > maxTexture))
+        {
+            scaled = scaled.scaled(maxTexture, maxTexture, Qt::KeepAspectRatio);
+        }
+
+        if (scaled != size)
+            reader.setScaledSize(scaled);
+    }
+
+    auto *im = new QImage();
+    if (!reader.read(im))
+    {
+        delete im;
+        return nullptr;
+    }
+    return im;
+}
+
+bool MythImage::Load(const QString &filename, QSize decodeSize)
 {
     if (filename.isEmpty())
         return false;
@@ -322,8 +364,9 @@ bool MythImage::Load(const QString &filename)
 
             if (ret)
             {
-                im = new QImage();
-                im->loadFromData(data);
+                QBuffer buffer(&data);
+                QImageReader reader(&buffer);
+                im = Decode(reader, decodeSize);
             }
         }
 #if 0
@@ -341,8 +384,9 @@ bool MythImage::Load(const QString &filename)
         QByteArray data;
         if (GetMythDownloadManager()->download(filename, &data))
         {
-            im = new QImage();
-            im->loadFromData(data);
+            QBuffer buffer(&data);
+            QImageReader reader(&buffer);
+            im = Decode(reader, decodeSize);
         }
     }
     else
@@ -350,7 +394,10 @@ bool MythImage::Load(const QString &filename)
         QString path = filename;
         if (path.startsWith('/') ||
             GetMythUI()->FindThemeFile(path))
-            im = new QImage(path);
+        {
+            QImageReader reader(path);
+            im = Decode(reader, decodeSize);
+        }
     }
 
     if (im && im->isNull())
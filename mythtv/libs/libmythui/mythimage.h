@@ -58,7 +58,7 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     void Assign(const QPixmap &pix);
 
     bool Load(MythImageReader *reader);
-    bool Load(const QString &filename);
+    bool Load(const QString &filename, QSize decodeSize = QSize());
 
     void Orientation(int orientation);
     void Resize(QSize newSize, bool preserveAspect = false);
@@ -103,6 +103,7 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
 
   protected:
     ~MythImage() override;
+    QImage *Decode(QImageReader &reader, QSize decodeSize) const;
     static void MakeGradient(QImage &image, const QColor &begin,
                              const QColor &end, int alpha,
                              BoundaryWanted drawBoundary = BoundaryWanted::Yes,
@@ -49,6 +49,8 @@ class MUI_PUBLIC MythPainter : public QObject
     virtual bool SupportsAlpha(void) = 0;
     virtual bool SupportsClipping(void) = 0;
     virtual void FreeResources(void) { }
+    /// Largest image width/height that can be drawn, 0 if unlimited
+    virtual int GetMaxTextureSize(void) { return 0; }
     virtual void Begin(QPaintDevice* /*Parent*/) { }
     virtual void End() { }
 
@@ -1,5 +1,6 @@
 #include "mythuibuttonlist.h"
 
+#include <algorithm>
 #include <cmath>
 #include <utility>
 
@@ -26,6 +27,10 @@
 
 #define LOC     QString("MythUIButtonList(%1): ").arg(objectName())
 
+/// Model items this far outside the visible part of the list are kept,
+/// so that scrolling a little doesn't fill them again
+static constexpr int kModelItemMargin { 20 };
+
 MythUIButtonList::MythUIButtonList(MythUIType *parent, const QString &name)
     : MythUIType(parent, name)
 {
@@ -67,6 +72,12 @@ MythUIButtonList::~MythUIButtonList()
     m_buttonToItem.clear();
     m_clearing = true;
 
+    if (m_model)
+    {
+        m_model->ClearItems();
+        m_model->m_list = nullptr;
+    }
+
     while (!m_itemList.isEmpty())
         delete m_itemList.takeFirst();
 }
@@ -115,6 +126,15 @@ void MythUIButtonList::Reset()
 {
     m_buttonToItem.clear();
 
+    if (m_model)
+    {
+        m_model->ClearItems();
+        m_model->m_list = nullptr;
+        m_model = nullptr;
+    }
+    m_searchKeys.clear();
+    m_searchOrder.clear();
+
     if (m_itemList.isEmpty())
         return;
 
@@ -206,7 +226,7 @@ MythUIGroup *MythUIButtonList::PrepareButton(int buttonIdx, int itemIdx,
                                              int &selectedIdx,
                                              int &button_shift)
 {
-    MythUIButtonListItem *buttonItem = m_itemList[itemIdx];
+    MythUIButtonListItem *buttonItem = ItemAt(itemIdx);
 
     buttonIdx += button_shift;
 
@@ -1306,8 +1326,7 @@ void MythUIButtonList::CalculateButtonPositions(void)
         }
     }
 
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin() +
-                                                 m_topPosition;
+    int curItem = m_topPosition;
 
     if (m_scrollStyle == ScrollCenter || m_scrollStyle == ScrollGroupCenter)
     {
@@ -1318,13 +1337,13 @@ void MythUIButtonList::CalculateButtonPositions(void)
             if (m_wrapStyle == WrapItems && button > 0 &&
                 m_itemCount >= m_itemsVisible)
             {
-                it = m_itemList.end() - button;
+                curItem = m_itemList.size() - button;
                 button = 0;
             }
         }
         else if ((m_itemCount - m_selPosition) < (m_itemsVisible / 2))
         {
-            it = m_itemList.begin() + m_selPosition - (m_itemsVisible / 2);
+            curItem = m_selPosition - (m_itemsVisible / 2);
         }
     }
     else if (m_drawFromBottom && m_itemCount < m_itemsVisible)
@@ -1338,15 +1357,12 @@ void MythUIButtonList::CalculateButtonPositions(void)
     MythUIStateType *realButton = nullptr;
     MythUIButtonListItem *buttonItem = nullptr;
 
-    if (it < m_itemList.begin())
-        it = m_itemList.begin();
+    curItem = std::max(curItem, 0);
 
-    int curItem = it < m_itemList.end() ? GetItemPos(*it) : 0;
-
-    while (it < m_itemList.end() && button < m_itemsVisible)
+    while (curItem < m_itemList.size() && button < m_itemsVisible)
     {
         realButton = m_buttonList[button];
-        buttonItem = *it;
+        buttonItem = ItemAt(curItem);
 
         if (!realButton || !buttonItem)
             break;
@@ -1363,15 +1379,13 @@ void MythUIButtonList::CalculateButtonPositions(void)
         buttonItem->SetToRealButton(realButton, selected);
         realButton->SetVisible(true);
 
-        if (m_wrapStyle == WrapItems && it == (m_itemList.end() - 1) &&
+        if (m_wrapStyle == WrapItems && curItem == m_itemList.size() - 1 &&
             m_itemCount >= m_itemsVisible)
         {
-            it = m_itemList.begin();
             curItem = 0;
         }
         else
         {
-            ++it;
             ++curItem;
         }
 
@@ -1422,6 +1436,7 @@ void MythUIButtonList::CalculateArrowStates()
         DistributeButtons();
 
     updateLCD();
+    ReleaseItems();
 
     m_needsUpdate = false;
 
@@ -1458,6 +1473,13 @@ void MythUIButtonList::ItemVisible(MythUIButtonListItem *item)
 
 void MythUIButtonList::InsertItem(MythUIButtonListItem *item, int listPosition)
 {
+    if (m_model)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "Cannot add a button to a list that has a model");
+        return;
+    }
+
     bool wasEmpty = m_itemList.isEmpty();
 
     if (listPosition >= 0 && listPosition <= m_itemList.count())
@@ -1490,7 +1512,7 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     if (m_clearing)
         return;
 
-    int curIndex = m_itemList.indexOf(item);
+    int curIndex = GetItemPos(item);
 
     if (curIndex == -1)
         return;
@@ -1506,6 +1528,14 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
         ++it;
     }
 
+    if (m_model)
+    {
+        // Filled again from the model when it's needed
+        m_model->m_items.remove(curIndex);
+        Update();
+        return;
+    }
+
     if (curIndex < m_topPosition &&
         m_topPosition > 0)
     {
@@ -1531,7 +1561,7 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     Update();
 
     if (m_selPosition < m_itemCount)
-        emit itemSelected(m_itemList.at(m_selPosition));
+        emit itemSelected(ItemAt(m_selPosition));
     else
         emit itemSelected(nullptr);
 
@@ -1539,16 +1569,115 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
         emit DependChanged(true);
 }
 
+/**
+ * \brief Take the items from model instead of adding them one by one.
+ *
+ * Any items already in the list are deleted.  The model isn't owned by the
+ * list, and must stay valid until the list is Reset() or deleted.
+ */
+void MythUIButtonList::SetModel(MythUIButtonListModel *model)
+{
+    Reset();
+    if (model && model->m_list)
+        model->m_list->Reset();
+    m_model = model;
+    if (m_model)
+        m_model->m_list = this;
+    ModelChanged();
+}
+
+/**
+ * \brief Call after items were added to, removed from or changed in the
+ *        model.  The selected position is kept if it is still in the list.
+ */
+void MythUIButtonList::ModelChanged(void)
+{
+    if (!m_model)
+        return;
+
+    m_buttonToItem.clear();
+    m_model->ClearItems();
+    m_searchKeys.clear();
+    m_searchOrder.clear();
+
+    m_itemCount = std::max(m_model->GetCount(), 0);
+    m_itemList.clear();
+    m_itemList.reserve(m_itemCount);
+    for (int pos = 0; pos < m_itemCount; ++pos)
+        m_itemList.append(nullptr);
+
+    if (m_selPosition >= m_itemCount)
+        m_selPosition = std::max(m_itemCount - 1, 0);
+    m_topPosition = std::min(m_topPosition, m_selPosition);
+
+    Update();
+
+    emit itemSelected(GetItemCurrent());
+    emit DependChanged(IsEmpty());
+}
+
+/**
+ * \brief The item at pos, which must be a valid position.  With a model the
+ *        item is filled by the model if it doesn't exist.
+ *
+ * \param handOut  The item is given to a caller outside the list.  A model
+ *                 item is then kept until the model changes.
+ */
+MythUIButtonListItem *MythUIButtonList::ItemAt(int pos, bool handOut) const
+{
+    if (!m_model)
+        return m_itemList.at(pos);
+
+    MythUIButtonListItem *item = m_model->Item(pos);
+    if (handOut)
+        item->m_handedOut = true;
+    return item;
+}
+
+/**
+ * \brief Delete the model items that have scrolled well out of view, so
+ *        that only a few hundred ever exist.  The selected item, the items
+ *        on the buttons and those given to callers are kept.
+ */
+void MythUIButtonList::ReleaseItems(void)
+{
+    if (!m_model ||
+        m_model->m_items.size() <= 2 * (m_itemsVisible + 2 * kModelItemMargin))
+        return;
+
+    int first = m_topPosition - kModelItemMargin;
+    int last  = m_topPosition + m_itemsVisible + kModelItemMargin;
+    QList<MythUIButtonListItem *> shown = m_buttonToItem.values();
+
+    auto &items = m_model->m_items;
+    for (auto it = items.begin(); it != items.end(); )
+    {
+        int pos = it.key();
+        MythUIButtonListItem *item = it.value();
+
+        if ((pos >= first && pos <= last) || pos == m_selPosition ||
+            item->m_handedOut || shown.contains(item))
+        {
+            ++it;
+            continue;
+        }
+
+        item->m_parent = nullptr;
+        delete item;
+        it = items.erase(it);
+    }
+}
+
 void MythUIButtonList::SetValueByData(const QVariant& data)
 {
     if (!m_initialized)
         Init();
 
-    for (auto *item : qAsConst(m_itemList))
+    for (int pos = 0; pos < m_itemList.size(); ++pos)
     {
-        if (item->GetData() == data)
+        if (ItemAt(pos)->GetData() == data)
         {
-            SetItemCurrent(item);
+            SetItemCurrent(pos);
             return;
         }
     }
@@ -1556,7 +1685,7 @@ void MythUIButtonList::SetValueByData(const QVariant& data)
 
 void MythUIButtonList::SetItemCurrent(MythUIButtonListItem *item)
 {
-    int newIndex = m_itemList.indexOf(item);
+    int newIndex = GetItemPos(item);
     SetItemCurrent(newIndex);
 }
 
@@ -1568,7 +1697,7 @@ void MythUIButtonList::SetItemCurrent(int current, int topPosition)
     if (current == -1 || current >= m_itemList.size())
         return;
 
-    if (!m_itemList.at(current)->isEnabled())
+    if (!ItemAt(current)->isEnabled())
         return;
 
     if (current == m_selPosition &&
@@ -1593,7 +1722,8 @@ MythUIButtonListItem *MythUIButtonList::GetItemCurrent() const
         m_selPosition < 0)
         return nullptr;
 
-    return m_itemList.at(m_selPosition);
+    // Kept while it is selected, without pinning every item that ever was
+    return ItemAt(m_selPosition);
 }
 
 int MythUIButtonList::GetIntValue() const
@@ -1636,7 +1766,7 @@ MythRect MythUIButtonList::GetButtonArea(void) const
 MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 {
     if (!m_itemList.empty())
-        return m_itemList[0];
+        return ItemAt(0, true);
 
     return nullptr;
 }
@@ -1644,12 +1774,12 @@ MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 MythUIButtonListItem *MythUIButtonList::GetItemNext(MythUIButtonListItem *item)
 const
 {
-    QListIterator<MythUIButtonListItem *> it(m_itemList);
+    int pos = GetItemPos(item);
 
-    if (!it.findNext(item))
+    if (pos < 0 || pos + 1 >= m_itemList.size())
         return nullptr;
 
-    return it.previous();
+    return ItemAt(pos + 1, true);
 }
 
 int MythUIButtonList::GetCount() const
@@ -1678,7 +1808,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemAt(int pos) const
     if (pos < 0 || pos >= m_itemList.size())
         return nullptr;
 
-    return m_itemList.at(pos);
+    return ItemAt(pos, true);
 }
 
 MythUIButtonListItem *MythUIButtonList::GetItemByData(const QVariant& data)
@@ -1686,10 +1816,11 @@ MythUIButtonListItem *MythUIButtonList::GetItemByData(const QVariant& data)
     if (!m_initialized)
         Init();
 
-    for (auto *item : qAsConst(m_itemList))
+    for (int pos = 0; pos < m_itemList.size(); ++pos)
     {
+        MythUIButtonListItem *item = ItemAt(pos);
         if (item->GetData() == data)
-            return item;
+            return ItemAt(pos, true);
     }
 
     return nullptr;
@@ -1700,13 +1831,16 @@ int MythUIButtonList::GetItemPos(MythUIButtonListItem *item) const
     if (!item)
         return -1;
 
+    if (m_model)
+        return (item->m_parent == this) ? item->m_modelPos : -1;
+
     return m_itemList.indexOf(item);
 }
 
 void MythUIButtonList::InitButton(int itemIdx, MythUIStateType* & realButton,
                                   MythUIButtonListItem* & buttonItem)
 {
-    buttonItem = m_itemList[itemIdx];
+    buttonItem = ItemAt(itemIdx);
 
     if (m_maxVisible == 0)
     {
@@ -2072,7 +2206,7 @@ bool MythUIButtonList::MoveUp(MovementUnit unit, uint amount)
 void MythUIButtonList::FindEnabledDown(MovementUnit unit)
 {
     if (m_selPosition < 0 || m_selPosition >= m_itemList.size() ||
-        m_itemList.at(m_selPosition)->isEnabled())
+        ItemAt(m_selPosition)->isEnabled())
         return;
 
     int step = (unit == MoveRow) ? m_columns : 1;
@@ -2082,32 +2216,32 @@ void MythUIButtonList::FindEnabledDown(MovementUnit unit)
     {
         while (m_selPosition < m_itemList.size() &&
                (m_selPosition + 1) % m_columns > 0 &&
-               !m_itemList.at(m_selPosition)->isEnabled())
+               !ItemAt(m_selPosition)->isEnabled())
             ++m_selPosition;
 
-        if (m_itemList.at(m_selPosition)->isEnabled())
+        if (ItemAt(m_selPosition)->isEnabled())
             return;
 
         if (m_wrapStyle > WrapNone)
         {
             m_selPosition = m_selPosition - (m_columns - 1);
             while ((m_selPosition + 1) % m_columns > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled())
+                   !ItemAt(m_selPosition)->isEnabled())
                 ++m_selPosition;
         }
     }
     else
     {
-        while (!m_itemList.at(m_selPosition)->isEnabled() &&
+        while (!ItemAt(m_selPosition)->isEnabled() &&
                (m_selPosition < m_itemList.size() - step))
             m_selPosition += step;
 
-        if (!m_itemList.at(m_selPosition)->isEnabled() &&
+        if (!ItemAt(m_selPosition)->isEnabled() &&
             m_wrapStyle > WrapNone)
         {
             m_selPosition = (m_selPosition + step) % m_itemList.size();
 
-            while (!m_itemList.at(m_selPosition)->isEnabled() &&
+            while (!ItemAt(m_selPosition)->isEnabled() &&
                    (m_selPosition < m_itemList.size() - step))
                 m_selPosition += step;
         }
@@ -2117,7 +2251,7 @@ void MythUIButtonList::FindEnabledDown(MovementUnit unit)
 void MythUIButtonList::FindEnabledUp(MovementUnit unit)
 {
     if (m_selPosition < 0 || m_selPosition >= m_itemList.size() ||
-        m_itemList.at(m_selPosition)->isEnabled())
+        ItemAt(m_selPosition)->isEnabled())
         return;
 
     int step = (unit == MoveRow) ? m_columns : 1;
@@ -2126,33 +2260,33 @@ void MythUIButtonList::FindEnabledUp(MovementUnit unit)
     if (unit == MoveColumn)
     {
         while (m_selPosition > 0 && (m_selPosition - 1) % m_columns > 0 &&
-               !m_itemList.at(m_selPosition)->isEnabled())
+               !ItemAt(m_selPosition)->isEnabled())
             --m_selPosition;
 
-        if (m_itemList.at(m_selPosition)->isEnabled())
+        if (ItemAt(m_selPosition)->isEnabled())
             return;
 
         if (m_wrapStyle > WrapNone)
         {
             m_selPosition = m_selPosition + (m_columns - 1);
             while ((m_selPosition - 1) % m_columns > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled())
+                   !ItemAt(m_selPosition)->isEnabled())
                 --m_selPosition;
         }
     }
     else
     {
-        while (!m_itemList.at(m_selPosition)->isEnabled() &&
+        while (!ItemAt(m_selPosition)->isEnabled() &&
                (m_selPosition - step >= 0))
             m_selPosition -= step;
 
-        if (!m_itemList.at(m_selPosition)->isEnabled() &&
+        if (!ItemAt(m_selPosition)->isEnabled() &&
             m_wrapStyle > WrapNone)
         {
             m_selPosition = m_itemList.size() - 1;
 
             while (m_selPosition > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled() &&
+                   !ItemAt(m_selPosition)->isEnabled() &&
                    (m_selPosition - step >= 0))
                 m_selPosition -= step;
         }
@@ -2289,17 +2423,15 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
     bool found_it = false;
     int selectedPosition = 0;
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin();
 
-    while (it != m_itemList.end())
+    while (selectedPosition < m_itemList.size())
     {
-        if ((*it)->GetText() == position_name)
+        if (ItemAt(selectedPosition)->GetText() == position_name)
         {
             found_it = true;
             break;
         }
 
-        ++it;
         ++selectedPosition;
     }
 
@@ -2312,7 +2444,7 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
 bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
 {
-    if (GetItemCurrent() != item)
+    if (GetItemCurrent() != item || m_model)
         return false;
 
     if (item == m_itemList.first() && up)
@@ -2358,10 +2490,22 @@ bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
 
 void MythUIButtonList::SetAllChecked(MythUIButtonListItem::CheckState state)
 {
-    QMutableListIterator<MythUIButtonListItem *> it(m_itemList);
+    if (!m_model)
+    {
+        for (auto *item : qAsConst(m_itemList))
+            item->setChecked(state);
+        return;
+    }
 
-    while (it.hasNext())
-        it.next()->setChecked(state);
+    // The model keeps the state, only the existing items need changing
+    for (int pos = 0; pos < m_itemCount; ++pos)
+    {
+        MythUIButtonListItem *item = m_model->m_items.value(pos);
+        if (item)
+            item->setChecked(state);
+        else
+            m_model->SetChecked(pos, state);
+    }
 }
 
 void MythUIButtonList::Init()
@@ -2742,7 +2886,7 @@ void MythUIButtonList::customEvent(QEvent *event)
                 if (cur > 200 && cur % loginterval == 0)
                     LOG(VB_GUI, LOG_INFO,
                         QString("Build background buttonlist item %1").arg(cur));
-                emit itemLoaded(GetItemAt(cur));
+                emit itemLoaded(ItemAt(cur));
             }
             m_nextItemLoaded = cur;
             if (cur < GetCount())
@@ -2753,6 +2897,10 @@ void MythUIButtonList::customEvent(QEvent *event)
 
 void MythUIButtonList::LoadInBackground(int start, int pageSize)
 {
+    // Model items are filled as they are needed
+    if (m_model)
+        return;
+
     m_nextItemLoaded = start;
     QCoreApplication::
         postEvent(this, new NextButtonListPageEvent(start, pageSize));
@@ -3055,7 +3203,7 @@ void MythUIButtonList::updateLCD(void)
     {
         bool selected = r == GetCurrentPos();
 
-        MythUIButtonListItem *item = GetItemAt(r);
+        MythUIButtonListItem *item = ItemAt(r);
         CHECKED_STATE state = NOTCHECKABLE;
 
         if (item->checkable())
@@ -3172,6 +3320,18 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
         }
     }
 
+    if (m_model)
+    {
+        // The start position is only tried again if it isn't skipped
+        int pos = FindInIndex(currPos, doMove ? GetCount() - 1 : GetCount(),
+                              searchForward);
+        if (pos < 0)
+            return false;
+
+        SetItemCurrent(pos);
+        return true;
+    }
+
     while (true)
     {
         found = GetItemAt(currPos)->FindText(m_searchStr, m_searchFields, m_searchStartsWith);
@@ -3204,6 +3364,134 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
     return false;
 }
 
+/**
+ * \brief Read the search texts of every model item once, so that searches
+ *        don't need to fill the items.  Read again if the search fields
+ *        change.
+ */
+void MythUIButtonList::BuildSearchIndex(void)
+{
+    if (!m_model || (m_searchKeys.size() == m_itemCount &&
+                     m_searchIndexFields == m_searchFields))
+        return;
+
+    m_searchIndexFields = m_searchFields;
+    m_searchKeys.resize(m_itemCount);
+    m_searchOrder.clear();
+    for (int pos = 0; pos < m_itemCount; ++pos)
+    {
+        QStringList keys = m_model->GetSearchTexts(pos, m_searchFields);
+        for (auto &key : keys)
+        {
+            key = key.toCaseFolded();
+            m_searchOrder.append(qMakePair(key, pos));
+        }
+        m_searchKeys[pos] = keys;
+    }
+
+    std::stable_sort(m_searchOrder.begin(), m_searchOrder.end(),
+                     [](const QPair<QString, int> &a,
+                        const QPair<QString, int> &b)
+                     { return a.first < b.first; });
+}
+
+/**
+ * \brief Find m_searchStr in the search index.
+ *
+ * \param from           The first position to look at
+ * \param count          The number of positions to look at, wrapping round
+ *                       at the end of the list
+ * \param searchForward  Look down the list from \p from, otherwise up
+ * \return The first matching position, or -1 if none match
+ */
+int MythUIButtonList::FindInIndex(int from, int count, bool searchForward)
+{
+    BuildSearchIndex();
+
+    int size = m_searchKeys.size();
+    if (size == 0)
+        return -1;
+
+    QString key = m_searchStr.toCaseFolded();
+
+    auto distance = [size, from, searchForward](int pos)
+    {
+        return searchForward ? (pos - from + size) % size
+                             : (from - pos + size) % size;
+    };
+
+    if (m_searchStartsWith)
+    {
+        // All the texts starting with key are together in the sorted index,
+        // e.g. when jumping to a letter
+        auto it = std::lower_bound(m_searchOrder.cbegin(), m_searchOrder.cend(),
+                                   key, [](const QPair<QString, int> &entry,
+                                           const QString &k)
+                                   { return entry.first < k; });
+        int best = -1;
+        int bestDistance = count;
+        for (; it != m_searchOrder.cend() && it->first.startsWith(key); ++it)
+        {
+            int dist = distance(it->second);
+            if (dist < bestDistance)
+            {
+                best = it->second;
+                bestDistance = dist;
+            }
+        }
+        return best;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        int pos = searchForward ? (from + i) % size
+                                : (from - i + size) % size;
+        for (const auto &text : qAsConst(m_searchKeys[pos]))
+        {
+            if (text.contains(key))
+                return pos;
+        }
+    }
+
+    return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Deletes the items still left.  If a list still uses the model, it is
+/// emptied.
+MythUIButtonListModel::~MythUIButtonListModel()
+{
+    if (m_list)
+        m_list->Reset();
+    ClearItems();
+}
+
+/// The item at pos, filled by FillItem() if it doesn't exist yet
+MythUIButtonListItem *MythUIButtonListModel::Item(int pos)
+{
+    MythUIButtonListItem *item = m_items.value(pos);
+    if (item)
+        return item;
+
+    item = new MythUIButtonListItem(m_list);
+    FillItem(item, pos);
+    // Only now, so the state set by FillItem() isn't handed straight back
+    item->m_modelPos = pos;
+    m_items.insert(pos, item);
+    return item;
+}
+
+void MythUIButtonListModel::ClearItems(void)
+{
+    for (auto *item : qAsConst(m_items))
+    {
+        item->m_parent = nullptr;
+        delete item;
+    }
+    m_items.clear();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype,
@@ -3550,6 +3838,10 @@ void MythUIButtonListItem::setChecked(MythUIButtonListItem::CheckState state)
 
     m_state = state;
 
+    // The item may be deleted and filled again by the model
+    if (m_parent && m_parent->m_model && m_modelPos >= 0)
+        m_parent->m_model->SetChecked(m_modelPos, state);
+
     if (m_parent && m_isVisible)
         m_parent->Update();
 }
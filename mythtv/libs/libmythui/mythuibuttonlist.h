@@ -6,8 +6,10 @@
 // Qt headers
 #include <QHash>
 #include <QList>
+#include <QPair>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 
 // MythTV headers
 #include "mythuitype.h"
@@ -135,10 +137,62 @@ class MUI_PUBLIC MythUIButtonListItem
     InfoMap m_imageFilenames;
     InfoMap m_states;
 
+  private:
+    /// An item filled from the model of lbtype, see MythUIButtonListModel
+    explicit MythUIButtonListItem(MythUIButtonList *lbtype) : m_parent(lbtype) {}
+
+    int             m_modelPos      {-1};    ///< Position in the model, if any
+    bool            m_handedOut     {false}; ///< Model item given to a caller
+
     friend class MythUIButtonList;
+    friend class MythUIButtonListModel;
     friend class MythGenericTree;
 };
 
+/**
+ * \class MythUIButtonListModel
+ *
+ * \brief Supplies the items of a MythUIButtonList as they are needed, rather
+ *        than every item being created up front.
+ *
+ * The items belong to the model.  Only those near the visible part of the
+ * list, the selected one and those returned by the MythUIButtonList::GetItem
+ * functions or passed by itemSelected() and itemClicked() exist.  The others
+ * are deleted as the list scrolls and filled again when they come back into
+ * view, so anything else changed in an item (images, texts etc.) must also
+ * be changed in the model.  Items passed by itemVisible() and itemLoaded()
+ * are only valid in the slot.  All items are deleted by
+ * MythUIButtonList::ModelChanged().
+ */
+class MUI_PUBLIC MythUIButtonListModel
+{
+  public:
+    virtual ~MythUIButtonListModel();
+
+    /// The number of items in the list
+    virtual int GetCount(void) const = 0;
+
+    /// Set the texts, images, states and data of the new item at pos
+    virtual void FillItem(MythUIButtonListItem *item, int pos) = 0;
+
+    /// The texts of the item at pos that MythUIButtonListItem::FindText()
+    /// looks at for fieldList, see MythUIButtonList::SetSearchFields()
+    virtual QStringList GetSearchTexts(int pos, const QString &fieldList) const = 0;
+
+    /// Keep the checked state of the item at pos, for FillItem() to restore
+    virtual void SetChecked(int pos, MythUIButtonListItem::CheckState state) = 0;
+
+  private:
+    MythUIButtonListItem *Item(int pos);
+    void ClearItems(void);
+
+    MythUIButtonList                  *m_list {nullptr};
+    QHash<int, MythUIButtonListItem*>  m_items; ///< The items that exist
+
+    friend class MythUIButtonList;
+    friend class TestMythUIButtonList;
+};
+
 /**
  * \class MythUIButtonList
  *
@@ -208,6 +262,10 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
 
     void RemoveItem(MythUIButtonListItem *item);
 
+    void SetModel(MythUIButtonListModel *model);
+    MythUIButtonListModel *GetModel(void) const { return m_model; }
+    void ModelChanged(void);
+
     void SetLCDTitles(const QString &title, const QString &columnList = "");
     void updateLCD(void);
 
@@ -243,6 +301,8 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     virtual void Init();
 
     void InsertItem(MythUIButtonListItem *item, int listPosition = -1);
+    MythUIButtonListItem *ItemAt(int pos, bool handOut = false) const;
+    void ReleaseItems(void);
 
     int minButtonWidth(const MythRect & area);
     int minButtonHeight(const MythRect & area);
@@ -276,6 +336,8 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     int PageDown(void);
 
     bool DoFind(bool doMove, bool searchForward);
+    void BuildSearchIndex(void);
+    int  FindInIndex(int from, int count, bool searchForward);
 
     void FindEnabledUp(MovementUnit unit);
     void FindEnabledDown(MovementUnit unit);
@@ -344,9 +406,17 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     int m_itemCount                   {0};
     bool m_keepSelAtBottom            {false};
 
+    /// With m_model, a null for each item, see ItemAt()
     QList<MythUIButtonListItem*> m_itemList;
     int m_nextItemLoaded              {0};
 
+    MythUIButtonListModel *m_model    {nullptr};
+    /// Case folded search texts of each model item, for m_searchIndexFields
+    QVector<QStringList> m_searchKeys;
+    /// Every search text with its model position, sorted by the text
+    QVector<QPair<QString, int>> m_searchOrder;
+    QString m_searchIndexFields;
+
     bool m_drawFromBottom             {false};
 
     QString     m_lcdTitle;
@@ -354,6 +424,7 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
 
     friend class MythUIButtonListItem;
     friend class MythUIButtonTree;
+    friend class TestMythUIButtonList;
 };
 
 class MUI_PUBLIC SearchButtonListDialog : public MythScreenType
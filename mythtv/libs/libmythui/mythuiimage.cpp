@@ -2,6 +2,7 @@
 #include "mythuiimage.h"
 
 // C++
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -34,6 +35,10 @@
 
 class ImageLoadThread;
 
+/// Background loads for images that are on screen are started first
+static constexpr int kVisibleLoadPriority { 0 };
+static constexpr int kHiddenLoadPriority  { 1 };
+
 #define LOC      QString("MythUIImage(0x%1): ").arg((uint64_t)this,0,16)
 
 /////////////////////////////////////////////////////
@@ -274,10 +279,23 @@ class ImageLoader
             image = painter->GetFormatImage();
             bool ok = false;
 
+            // Large pictures for a small widget are scaled down by the
+            // decoder rather than decoded in full
+            QSize decodeSize;
+            if (bResize && w > 0 && h > 0)
+            {
+                decodeSize = QSize(w, h);
+                // Exif orientations 5 to 8 turn the picture by 90 or 270
+                // degrees after decoding, so decode it the other way round
+                if (imProps.m_isOriented && imProps.m_orientation >= 5 &&
+                    imProps.m_orientation <= 8)
+                    decodeSize.transpose();
+            }
+
             if (imageReader)
                 ok = image->Load(imageReader);
             else
-                ok = image->Load(filename);
+                ok = image->Load(filename, decodeSize);
 
             if (!ok)
             {
@@ -485,49 +503,14 @@ class ImageLoadThread : public QRunnable
   public:
     ImageLoadThread(MythUIImage *parent, MythPainter *painter,
                     const ImageProperties &imProps, QString basefile,
-                    int number, ImageCacheMode mode) :
+                    int number, ImageCacheMode mode, int generation) :
         m_parent(parent), m_painter(painter), m_imageProperties(imProps),
-        m_basefile(std::move(basefile)), m_number(number), m_cacheMode(mode)
+        m_basefile(std::move(basefile)), m_number(number), m_cacheMode(mode),
+        m_generation(generation)
     {
     }
 
-    void run() override // QRunnable
-    {
-        bool aborted = false;
-        QString filename =  m_imageProperties.m_filename;
-
-        // NOTE Do NOT use MythImageReader::supportsAnimation here, it defeats
-        // the point of caching remote images
-        if (ImageLoader::SupportsAnimation(filename))
-        {
-             AnimationFrames *frames =
-                 ImageLoader::LoadAnimatedImage(m_painter,
-                                                m_imageProperties,
-                                                m_cacheMode, m_parent,
-                                                aborted);
-
-             if (frames && frames->count() > 1)
-             {
-                auto *le = new ImageLoadEvent(m_parent, frames, m_basefile,
-                                              m_imageProperties.m_filename,
-                                              aborted);
-                QCoreApplication::postEvent(m_parent, le);
-
-                return;
-             }
-             delete frames;
-        }
-
-        MythImage *image = ImageLoader::LoadImage(m_painter,
-                                                    m_imageProperties,
-                                                    m_cacheMode, m_parent,
-                                                    aborted);
-
-        auto *le = new ImageLoadEvent(m_parent, image, m_basefile,
-                                      m_imageProperties.m_filename,
-                                      m_number, aborted);
-        QCoreApplication::postEvent(m_parent, le);
-    }
+    void run() override; // QRunnable
 
 private:
     MythUIImage       *m_parent  {nullptr};
@@ -536,6 +519,7 @@ private:
     QString         m_basefile;
     int             m_number;
     ImageCacheMode  m_cacheMode;
+    int             m_generation;
 };
 
 /////////////////////////////////////////////////////////////////
@@ -549,10 +533,64 @@ public:
     MythUIImage *m_parent       {nullptr};
 
     QReadWriteLock m_updateLock {QReadWriteLock::Recursive};
+
+    /// Changed by every Load(), so that superseded background loads,
+    /// e.g. for a list item that has scrolled off screen, are skipped
+    std::atomic<int> m_loadGeneration {0};
 };
 
 /////////////////////////////////////////////////////////////////
 
+void ImageLoadThread::run()
+{
+    bool aborted = false;
+    QString filename =  m_imageProperties.m_filename;
+
+    // The widget has been given another image, or is being deleted,
+    // since this load was queued
+    if (m_parent->d->m_loadGeneration != m_generation)
+    {
+        auto *le = new ImageLoadEvent(m_parent, static_cast<MythImage*>(nullptr),
+                                      m_basefile, filename, m_number, true);
+        QCoreApplication::postEvent(m_parent, le);
+        return;
+    }
+
+    // NOTE Do NOT use MythImageReader::supportsAnimation here, it defeats
+    // the point of caching remote images
+    if (ImageLoader::SupportsAnimation(filename))
+    {
+         AnimationFrames *frames =
+             ImageLoader::LoadAnimatedImage(m_painter,
+                                            m_imageProperties,
+                                            m_cacheMode, m_parent,
+                                            aborted);
+
+         if (frames && frames->count() > 1)
+         {
+            auto *le = new ImageLoadEvent(m_parent, frames, m_basefile,
+                                          m_imageProperties.m_filename,
+                                          aborted);
+            QCoreApplication::postEvent(m_parent, le);
+
+            return;
+         }
+         delete frames;
+    }
+
+    MythImage *image = ImageLoader::LoadImage(m_painter,
+                                                m_imageProperties,
+                                                m_cacheMode, m_parent,
+                                                aborted);
+
+    auto *le = new ImageLoadEvent(m_parent, image, m_basefile,
+                                  m_imageProperties.m_filename,
+                                  m_number, aborted);
+    QCoreApplication::postEvent(m_parent, le);
+}
+
+/////////////////////////////////////////////////////////////////
+
 MythUIImage::MythUIImage(const QString &filepattern,
                          int low, int high, std::chrono::milliseconds delay,
                          MythUIType *parent, const QString &name)
@@ -603,6 +641,8 @@ MythUIImage::~MythUIImage()
     // needs it.
     if (m_runningThreads > 0)
     {
+        // Skip the loads that haven't started yet
+        ++d->m_loadGeneration;
         GetMythUI()->GetImageThreadPool()->waitForDone();
     }
 
@@ -977,6 +1017,8 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
 
     QString filename = bFilename;
 
+    int generation = ++d->m_loadGeneration;
+
     if (bFilename.isEmpty())
     {
         Clear();
@@ -1046,8 +1088,10 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
             m_runningThreads++;
             auto *bImgThread = new ImageLoadThread(this, GetPainter(),
                                     imProps, bFilename, i,
-                                    static_cast<ImageCacheMode>(cacheMode2));
-            GetMythUI()->GetImageThreadPool()->start(bImgThread, "ImageLoad");
+                                    static_cast<ImageCacheMode>(cacheMode2),
+                                    generation);
+            GetMythUI()->GetImageThreadPool()->start(bImgThread, "ImageLoad",
+                IsVisible(true) ? kVisibleLoadPriority : kHiddenLoadPriority);
         }
         else
         {
@@ -1,6 +1,7 @@
 // Qt
 #include <QDir>
 #include <QDateTime>
+#include <QMap>
 
 // MythTV
 #include "mythlogging.h"
@@ -34,15 +35,8 @@ MythUIThemeCache::~MythUIThemeCache()
     PruneCacheDir(GetRemoteCacheDir());
     PruneCacheDir(GetThumbnailDir());
 
-    QMutableMapIterator<QString, MythImage *> i(m_imageCache);
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-    m_cacheTrack.clear();
+    while (!m_imageCache.isEmpty())
+        RemoveCacheEntry(m_imageCache.begin());
 
     delete m_imageThreadPool;
 }
@@ -61,17 +55,9 @@ void MythUIThemeCache::UpdateImageCache()
 {
     QMutexLocker locker(&m_cacheLock);
 
-    QMutableMapIterator<QString, MythImage *> i(m_imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
+    while (!m_imageCache.isEmpty())
+        RemoveCacheEntry(m_imageCache.begin());
 
-    m_cacheTrack.clear();
     m_cacheSize.fetchAndStoreOrdered(0);
 
     ClearOldImageCache();
@@ -278,11 +264,12 @@ MythImage* MythUIThemeCache::LoadCacheImage(QString File, const QString& Label,
 
         QMutexLocker locker(&m_cacheLock);
 
-        if (m_imageCache.contains(Label) &&
-            m_cacheTrack[Label] + kImageCacheTimeout > now)
+        auto it = m_imageCache.find(Label);
+        if (it != m_imageCache.end() && it->m_checked + kImageCacheTimeout > now)
         {
-            m_imageCache[Label]->IncrRef();
-            return m_imageCache[Label];
+            TouchCacheEntry(*it);
+            it->m_image->IncrRef();
+            return it->m_image;
         }
     }
 
@@ -390,11 +377,13 @@ MythImage* MythUIThemeCache::GetImageFromCache(const QString& URL)
 {
     QMutexLocker locker(&m_cacheLock);
 
-    if (m_imageCache.contains(URL))
+    auto it = m_imageCache.find(URL);
+    if (it != m_imageCache.end())
     {
-        m_cacheTrack[URL] = SystemClock::now();
-        m_imageCache[URL]->IncrRef();
-        return m_imageCache[URL];
+        it->m_checked = SystemClock::now();
+        TouchCacheEntry(*it);
+        it->m_image->IncrRef();
+        return it->m_image;
     }
 
     /*
@@ -422,99 +411,92 @@ MythImage *MythUIThemeCache::CacheImage(const QString& URL, MythImage* Image, bo
         Image->save(dstfile, "PNG");
     }
 
-    // delete the oldest cached images until we fall below threshold.
+    // delete the least recently used images until we fall below threshold.
     QMutexLocker locker(&m_cacheLock);
 
-    while ((m_cacheSize.fetchAndAddOrdered(0) +
 #if QT_VERSION < QT_VERSION_CHECK(5,10,0)
-       Image->byteCount()
+    qint64 imageSize = Image->byteCount();
 #else
-       Image->sizeInBytes()
+    qint64 imageSize = Image->sizeInBytes();
 #endif
-        ) >=
-           m_maxCacheSize.fetchAndAddOrdered(0) && !m_imageCache.empty())
+
+    // Only images that nothing else holds count towards the cache size and can
+    // be freed. Those in use go back to the front, so that each is passed over
+    // once per trip through the list rather than on every eviction.
+    size_t checked = 0;
+    size_t entries = m_lruList.size();
+    while ((m_cacheSize.fetchAndAddOrdered(0) + imageSize) >=
+           m_maxCacheSize.fetchAndAddOrdered(0) && checked++ < entries)
     {
-        QMap<QString, MythImage *>::iterator it = m_imageCache.begin();
-        auto oldestTime = SystemClock::now();
-        QString oldestKey = it.key();
+        auto oldest = m_imageCache.find(m_lruList.back());
+        MythImage *oldestImage = oldest->m_image;
 
-        int count = 0;
+        bool inUse = (oldestImage == Image) || (2 != oldestImage->IncrRef());
+        if (oldestImage != Image)
+            oldestImage->DecrRef();
 
-        for (; it != m_imageCache.end(); ++it)
+        if (inUse)
         {
-            if (m_cacheTrack[it.key()] < oldestTime)
-            {
-                if ((2 == it.value()->IncrRef()) && (it.value() != Image))
-                {
-                    oldestTime = m_cacheTrack[it.key()];
-                    oldestKey = it.key();
-                    count++;
-                }
-                it.value()->DecrRef();
-            }
+            TouchCacheEntry(*oldest);
+            continue;
         }
 
-        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +QString("%1 images are eligible for expiry").arg(count));
-        if (count > 0)
-        {
-            LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("Cache too big (%1), removing :%2:")
-                .arg(m_cacheSize.fetchAndAddOrdered(0) +
-#if QT_VERSION < QT_VERSION_CHECK(5,10,0)
-             Image->byteCount()
-#else
-             Image->sizeInBytes()
-#endif
-             )
-                .arg(oldestKey));
+        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("Cache too big (%1), removing :%2:")
+            .arg(m_cacheSize.fetchAndAddOrdered(0) + imageSize)
+            .arg(oldest.key()));
 
-            m_imageCache[oldestKey]->SetIsInCache(false);
-            m_imageCache[oldestKey]->DecrRef();
-            m_imageCache.remove(oldestKey);
-            m_cacheTrack.remove(oldestKey);
-        }
-        else
-        {
-            break;
-        }
+        RemoveCacheEntry(oldest);
     }
 
-    QMap<QString, MythImage *>::iterator it = m_imageCache.find(URL);
+    auto it = m_imageCache.find(URL);
 
     if (it == m_imageCache.end())
     {
         Image->IncrRef();
-        m_imageCache[URL] = Image;
-        m_cacheTrack[URL] = SystemClock::now();
+        m_lruList.push_front(URL);
+
+        CacheEntry entry;
+        entry.m_image   = Image;
+        entry.m_checked = SystemClock::now();
+        entry.m_lru     = m_lruList.begin();
+        it = m_imageCache.insert(URL, entry);
 
         Image->SetIsInCache(true);
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
             QString("NOT IN RAM CACHE, Adding, and adding to size :%1: :%2:").arg(URL)
-#if QT_VERSION < QT_VERSION_CHECK(5,10,0)
-        .arg(Image->byteCount())
-#else
-        .arg(Image->sizeInBytes())
-#endif
-        );
+            .arg(imageSize));
     }
 
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
         .arg(m_imageCache.count()).arg(m_cacheSize.fetchAndAddRelaxed(0)));
 
-    return m_imageCache[URL];
+    return it->m_image;
+}
+
+/// \brief Marks an image as the most recently used. Must be called with
+///        m_cacheLock held.
+void MythUIThemeCache::TouchCacheEntry(CacheEntry& Entry)
+{
+    m_lruList.splice(m_lruList.begin(), m_lruList, Entry.m_lru);
+}
+
+/// \brief Drops an image from the memory cache. Must be called with
+///        m_cacheLock held.
+void MythUIThemeCache::RemoveCacheEntry(ImageCache::iterator Entry)
+{
+    Entry->m_image->SetIsInCache(false);
+    Entry->m_image->DecrRef();
+    m_lruList.erase(Entry->m_lru);
+    m_imageCache.erase(Entry);
 }
 
 void MythUIThemeCache::RemoveFromCacheByURL(const QString& URL)
 {
     QMutexLocker locker(&m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = m_imageCache.find(URL);
+    auto it = m_imageCache.find(URL);
 
     if (it != m_imageCache.end())
-    {
-        m_imageCache[URL]->SetIsInCache(false);
-        m_imageCache[URL]->DecrRef();
-        m_imageCache.remove(URL);
-        m_cacheTrack.remove(URL);
-    }
+        RemoveCacheEntry(it);
 
     QString dstfile = GetCacheDirByUrl(URL) + '/' + URL;
     LOG(VB_GUI | VB_FILE, LOG_INFO, LOC + QString("RemoveFromCacheByURL removed :%1: from cache").arg(dstfile));
@@ -2,9 +2,12 @@
 #define MYTHUICACHE_H
 
 // Qt
-#include <QMap>
+#include <QHash>
 #include <QMutex>
 
+// Std
+#include <list>
+
 // MythTV
 #include "mythchrono.h"
 #include "mythimage.h"
@@ -39,6 +42,17 @@ class MUI_PUBLIC MythUIThemeCache
     MThreadPool* GetImageThreadPool();
 
   private:
+    /// An image in the memory cache
+    struct CacheEntry
+    {
+        MythImage* m_image { nullptr };
+        SystemTime m_checked;                 ///< last check of the original
+        std::list<QString>::iterator m_lru;   ///< position in m_lruList
+    };
+    using ImageCache = QHash<QString, CacheEntry>;
+
+    void        TouchCacheEntry(CacheEntry& Entry);
+    void        RemoveCacheEntry(ImageCache::iterator Entry);
     QString     GetCacheDirByUrl(const QString& URL);
     void        RemoveFromCacheByURL(const QString& URL);
     MythImage*  GetImageFromCache(const QString& URL);
@@ -46,8 +60,10 @@ class MUI_PUBLIC MythUIThemeCache
     void        RemoveCacheDir(const QString& Dir);
     static void PruneCacheDir(const QString& Dir);
 
-    QMap<QString, MythImage *> m_imageCache;
-    QMap<QString, SystemTime> m_cacheTrack;
+    // Images are keyed by file name, size and effects (see
+    // ImageLoader::GenImageLabel) and evicted least recently used first
+    ImageCache         m_imageCache;
+    std::list<QString> m_lruList;             ///< most recently used first
     QMutex m_cacheLock                    { QMutex::Recursive };
 #if QT_VERSION < QT_VERSION_CHECK(5,10,0)
     QAtomicInt m_cacheSize                { 0 };
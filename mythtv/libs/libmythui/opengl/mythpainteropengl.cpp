@@ -35,6 +35,11 @@ MythOpenGLPainter::~MythOpenGLPainter()
         m_render->logDebugMarker("PAINTER_RELEASE_END");
 }
 
+int MythOpenGLPainter::GetMaxTextureSize(void)
+{
+    return m_render ? m_render->GetMaxTextureSize() : 0;
+}
+
 void MythOpenGLPainter::FreeResources(void)
 {
     OpenGLLocker locker(m_render);
@@ -35,6 +35,7 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainterGPU
     bool SupportsAlpha(void) override { return true; }
     bool SupportsClipping(void) override { return false; }
     void FreeResources(void) override;
+    int  GetMaxTextureSize(void) override;
     void Begin(QPaintDevice *Parent) override;
     void End() override;
     void DrawImage(QRect Dest, MythImage *Image, QRect Source, int Alpha) override;
@@ -0,0 +1,186 @@
+/*
+ *  Class TestMythUIButtonList
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include "test_mythuibuttonlist.h"
+
+/// A list of numbered items, with the checked state and the number of times
+/// each item was filled
+class TestModel : public MythUIButtonListModel
+{
+  public:
+    explicit TestModel(int count)
+      : m_checked(count, MythUIButtonListItem::NotChecked),
+        m_fills(count, 0) {}
+
+    int GetCount(void) const override { return m_checked.size(); }
+
+    void FillItem(MythUIButtonListItem *item, int pos) override
+    {
+        item->SetText(QString("item %1").arg(pos));
+        item->SetText(QString("sub %1").arg(m_checked.size() - pos), "subtitle");
+        item->setCheckable(true);
+        item->setChecked(m_checked[pos]);
+        m_fills[pos]++;
+    }
+
+    QStringList GetSearchTexts(int pos, const QString &fieldList) const override
+    {
+        if (fieldList == "subtitle")
+            return { QString("sub %1").arg(m_checked.size() - pos) };
+        return { QString("item %1").arg(pos) };
+    }
+
+    void SetChecked(int pos, MythUIButtonListItem::CheckState state) override
+    {
+        m_checked[pos] = state;
+    }
+
+    QVector<MythUIButtonListItem::CheckState> m_checked;
+    QVector<int>                              m_fills;
+};
+
+void TestMythUIButtonList::test_getItemNext(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(1000);
+    list.SetModel(&model);
+
+    MythUIButtonListItem *item = list.GetItemAt(500);
+    QVERIFY(item != nullptr);
+    QCOMPARE(list.GetItemPos(item), 500);
+
+    MythUIButtonListItem *next = list.GetItemNext(item);
+    QVERIFY(next != nullptr);
+    QCOMPARE(list.GetItemPos(next), 501);
+    QCOMPARE(next->GetText(), QString("item 501"));
+
+    QVERIFY(list.GetItemNext(list.GetItemAt(999)) == nullptr);
+}
+
+// The model keeps the state of items that were released
+void TestMythUIButtonList::test_checkedAfterRelease(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(1000);
+    list.SetModel(&model);
+    list.m_itemsVisible = 10;
+
+    // Items that exist, but weren't given out
+    for (int pos = 0; pos < 300; ++pos)
+        list.ItemAt(pos);
+    QCOMPARE(model.m_items.size(), 300);
+
+    list.SetAllChecked(MythUIButtonListItem::FullChecked);
+    list.ReleaseItems();
+    QVERIFY(model.m_items.size() < 300);
+    QVERIFY(!model.m_items.contains(200));
+
+    QCOMPARE(list.GetItemAt(200)->state(), MythUIButtonListItem::FullChecked);
+    QCOMPARE(list.GetItemAt(800)->state(), MythUIButtonListItem::FullChecked);
+    QCOMPARE(model.m_fills[200], 2);
+    QCOMPARE(model.m_fills[800], 1);
+
+    list.GetItemAt(800)->setChecked(MythUIButtonListItem::NotChecked);
+    QCOMPARE(model.m_checked[800], MythUIButtonListItem::NotChecked);
+}
+
+// Items given to callers aren't deleted while the model is unchanged
+void TestMythUIButtonList::test_handedOutKept(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(1000);
+    list.SetModel(&model);
+    list.m_itemsVisible = 10;
+
+    MythUIButtonListItem *item = list.GetItemAt(600);
+    for (int pos = 0; pos < 300; ++pos)
+        list.ItemAt(pos);
+    list.ReleaseItems();
+
+    QVERIFY(model.m_items.contains(600));
+    QCOMPARE(model.m_items.value(600), item);
+    QCOMPARE(item->GetText(), QString("item 600"));
+    QCOMPARE(model.m_fills[600], 1);
+}
+
+// Moving the selection through the list doesn't keep every item that was
+// current
+void TestMythUIButtonList::test_currentNotKept(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(1000);
+    list.SetModel(&model);
+    list.m_itemsVisible = 10;
+
+    for (int pos = 0; pos < 1000; ++pos)
+    {
+        list.m_selPosition = pos;
+        QCOMPARE(list.GetItemCurrent()->GetText(), QString("item %1").arg(pos));
+    }
+    list.ReleaseItems();
+
+    QVERIFY(model.m_items.size() < 300);
+    QVERIFY(!model.m_items.contains(500));
+    QVERIFY(model.m_items.contains(999));
+    QCOMPARE(list.GetItemCurrent(), model.m_items.value(999));
+}
+
+// Searches use the texts of the search fields, without filling the items
+void TestMythUIButtonList::test_searchFields(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(1000);
+    list.SetModel(&model);
+
+    list.m_searchStr = "item 42";
+    list.m_searchStartsWith = true;
+    QCOMPARE(list.FindInIndex(0, list.GetCount(), true), 42);
+
+    // "sub 958" is the subtitle of item 42
+    list.SetSearchFields("subtitle");
+    QCOMPARE(list.FindInIndex(0, list.GetCount(), true), -1);
+    list.m_searchStr = "sub 958";
+    QCOMPARE(list.FindInIndex(0, list.GetCount(), true), 42);
+
+    list.m_searchStartsWith = false;
+    list.m_searchStr = "b 95";
+    QCOMPARE(list.FindInIndex(0, list.GetCount(), true), 41);
+    QCOMPARE(list.FindInIndex(100, list.GetCount(), false), 50);
+
+    QCOMPARE(model.m_items.size(), 1);
+}
+
+void TestMythUIButtonList::test_modelChanged(void)
+{
+    MythUIButtonList list(nullptr, "list");
+    TestModel model(10);
+    list.SetModel(&model);
+    QCOMPARE(list.GetCount(), 10);
+    QCOMPARE(model.m_items.size(), 1);
+
+    model.m_checked.resize(5);
+    model.m_fills.resize(5);
+    list.ModelChanged();
+    QCOMPARE(list.GetCount(), 5);
+    QCOMPARE(list.GetItemAt(4)->GetText(), QString("item 4"));
+
+    list.Reset();
+    QCOMPARE(list.GetCount(), 0);
+    QVERIFY(model.m_items.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestMythUIButtonList)
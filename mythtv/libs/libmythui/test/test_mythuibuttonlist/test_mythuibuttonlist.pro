@@ -0,0 +1,22 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += xml sql network widgets testlib
+
+TEMPLATE = app
+TARGET = test_mythuibuttonlist
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../.. ../../../libmythbase
+LIBS += -L../../../libmythbase -lmythbase-$$LIBVERSION
+LIBS += -L../.. -lmythui-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../../../libmythbase
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_mythuibuttonlist.h
+SOURCES += test_mythuibuttonlist.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpconnectionmonitor.cpp
+//
+// Purpose     : Waits for requests on idle HTTP connections, so that they
+//               don't hold an HttpServer worker thread
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own header
+#include "httpconnectionmonitor.h"
+
+// POSIX headers
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// C++ headers
+#include <array>
+#include <cerrno>
+
+// MythTV headers
+#include "mythlogging.h"
+
+#define LOC QString("HttpConnectionMonitor: ")
+
+/// How often idle connections are checked for their timeout
+static constexpr std::chrono::milliseconds kExpireInterval { 250ms };
+
+HttpConnectionMonitor::HttpConnectionMonitor(ReadyCallback ready)
+  : MThread("HttpConnectionMonitor"), m_ready(std::move(ready))
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (m_epollFd < 0 || m_wakeFd < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to create epoll instance" + ENO);
+        m_running = false;
+        return;
+    }
+
+    struct epoll_event event {};
+    event.events  = EPOLLIN;
+    event.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+
+    start();
+}
+
+HttpConnectionMonitor::~HttpConnectionMonitor()
+{
+    Stop();
+    wait();
+
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+    if (m_epollFd >= 0)
+        close(m_epollFd);
+}
+
+/**
+ *  \brief Wait for the next request on socket, for at most timeout.
+ *
+ *   On success the monitor owns the socket.
+ *
+ *  \return false if the monitor isn't running, the socket isn't taken over
+ */
+bool HttpConnectionMonitor::Watch(int socket, std::chrono::milliseconds timeout)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_running)
+        return false;
+
+    Connection connection;
+    connection.m_socket  = socket;
+    connection.m_timeout = timeout;
+    m_incoming.append(connection);
+    locker.unlock();
+
+    uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0)
+        LOG(VB_HTTP, LOG_ERR, LOC + "Unable to wake monitor" + ENO);
+
+    return true;
+}
+
+/// \brief Stop watching, the idle connections are closed.
+void HttpConnectionMonitor::Stop(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_running = false;
+    locker.unlock();
+
+    uint64_t one = 1;
+    if (m_wakeFd >= 0 && write(m_wakeFd, &one, sizeof(one)) < 0)
+        LOG(VB_HTTP, LOG_ERR, LOC + "Unable to wake monitor" + ENO);
+}
+
+void HttpConnectionMonitor::run(void)
+{
+    RunProlog();
+
+    std::array<struct epoll_event, 256> events {};
+    m_nextExpire = Clock::now() + kExpireInterval;
+
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            if (!m_running)
+                break;
+        }
+
+        AddConnections();
+
+        int count = epoll_wait(m_epollFd, events.data(),
+                               static_cast<int>(events.size()),
+                               kExpireInterval.count());
+        if (count < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "epoll_wait failed" + ENO);
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_wakeFd)
+            {
+                uint64_t value = 0;
+                if (read(m_wakeFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                    LOG(VB_HTTP, LOG_ERR, LOC + "Unable to read wake event" + ENO);
+                continue;
+            }
+
+            if (!m_connections.contains(fd))
+                continue;
+
+            // A client that closes the connection makes it readable too
+            int pending = 0;
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) ||
+                ioctl(fd, FIONREAD, &pending) < 0 || pending <= 0)
+            {
+                Remove(fd);
+                close(fd);
+            }
+            else
+            {
+                Ready(fd);
+            }
+        }
+
+        if (Clock::now() >= m_nextExpire)
+            Expire();
+    }
+
+    // Nothing can be handed on once the server is going away
+    QList<Connection> pending;
+    {
+        QMutexLocker locker(&m_lock);
+        pending.swap(m_incoming);
+    }
+    pending.append(m_connections.values());
+    m_connections.clear();
+    for (const auto &connection : qAsConst(pending))
+        close(connection.m_socket);
+
+    RunEpilog();
+}
+
+/// \brief Start watching the connections handed over by Watch().
+void HttpConnectionMonitor::AddConnections(void)
+{
+    QList<Connection> incoming;
+    {
+        QMutexLocker locker(&m_lock);
+        incoming.swap(m_incoming);
+    }
+
+    Clock::time_point now = Clock::now();
+    for (auto &connection : incoming)
+    {
+        connection.m_expires = now + connection.m_timeout;
+        m_connections.insert(connection.m_socket, connection);
+
+        // Level triggered, data already waiting is reported straight away
+        struct epoll_event event {};
+        event.events  = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = connection.m_socket;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, connection.m_socket, &event) < 0)
+        {
+            LOG(VB_HTTP, LOG_ERR, LOC + "Unable to watch socket" + ENO);
+            Remove(connection.m_socket);
+            close(connection.m_socket);
+        }
+    }
+}
+
+/// \brief A request has arrived, pass the socket on.
+void HttpConnectionMonitor::Ready(int socket)
+{
+    Remove(socket);
+
+    if (m_ready)
+        m_ready(socket);
+    else
+        close(socket);
+}
+
+/// \brief Stop watching socket, it isn't closed.
+void HttpConnectionMonitor::Remove(int socket)
+{
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socket, nullptr);
+    m_connections.remove(socket);
+}
+
+/// \brief Close the connections that have been idle for too long.
+void HttpConnectionMonitor::Expire(void)
+{
+    Clock::time_point now = Clock::now();
+    m_nextExpire = now + kExpireInterval;
+
+    QList<int> expired;
+    for (const auto &connection : qAsConst(m_connections))
+    {
+        if (connection.m_expires <= now)
+            expired.append(connection.m_socket);
+    }
+
+    for (int socket : qAsConst(expired))
+    {
+        LOG(VB_HTTP, LOG_DEBUG, LOC +
+            QString("Closing idle connection %1").arg(socket));
+        Remove(socket);
+        close(socket);
+    }
+}
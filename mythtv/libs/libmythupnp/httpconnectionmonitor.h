@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpconnectionmonitor.h
+//
+// Purpose     : Waits for requests on idle HTTP connections, so that they
+//               don't hold an HttpServer worker thread
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPCONNECTIONMONITOR_H
+#define HTTPCONNECTIONMONITOR_H
+
+// C++ headers
+#include <chrono>
+#include <functional>
+
+// Qt headers
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+// MythTV headers
+#include "mthread.h"
+#include "mythchrono.h"
+
+/** \class HttpConnectionMonitor
+ *  \brief Watches idle connections from one epoll thread.
+ *
+ *   New connections, and keep-alive connections once a response has been
+ *   sent, are watched here until the client sends its next request.  The
+ *   socket is then passed to the ready callback, which starts an HttpWorker
+ *   for it.  An idle connection only costs a file descriptor.
+ *
+ *   Connections the client closes, or that stay idle for longer than their
+ *   timeout, are closed.
+ */
+class HttpConnectionMonitor : public MThread
+{
+  public:
+    /// Called on the monitor thread when a request has arrived on socket.
+    /// The callback owns the socket.
+    using ReadyCallback = std::function<void(int socket)>;
+
+    explicit HttpConnectionMonitor(ReadyCallback ready);
+    ~HttpConnectionMonitor() override;
+
+    bool   Watch(int socket, std::chrono::milliseconds timeout);
+    void   Stop(void);
+
+  protected:
+    void   run(void) override; // MThread
+
+  private:
+    Q_DISABLE_COPY(HttpConnectionMonitor)
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection
+    {
+        int                       m_socket  {-1};
+        std::chrono::milliseconds m_timeout {0ms};
+        Clock::time_point         m_expires;
+    };
+
+    void   AddConnections(void);
+    void   Ready(int socket);
+    void   Remove(int socket);
+    void   Expire(void);
+
+    int                     m_epollFd    {-1};
+    int                     m_wakeFd     {-1};
+    ReadyCallback           m_ready;
+
+    QMutex                  m_lock;
+    QList<Connection>       m_incoming;     // protected by m_lock
+    bool                    m_running    {true}; // protected by m_lock
+
+    QHash<int, Connection>  m_connections;  // monitor thread only
+    Clock::time_point       m_nextExpire;   // monitor thread only
+};
+
+#endif // HTTPCONNECTIONMONITOR_H
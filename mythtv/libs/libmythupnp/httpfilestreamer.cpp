@@ -0,0 +1,472 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpfilestreamer.cpp
+//
+// Purpose     : Sends file bodies to HTTP clients with sendfile(), without
+//               holding an HttpServer worker thread for the transfer
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own header
+#include "httpfilestreamer.h"
+
+// POSIX headers
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+
+// C++ headers
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <thread>
+
+// MythTV headers
+#include "mythchrono.h"
+#include "mythlogging.h"
+
+#define LOC QString("HttpFileStreamer: ")
+
+/// Largest sendfile() call, so one fast client doesn't hold up the others
+static constexpr qint64 kChunkSize { 1024LL * 1024 };
+
+/// A rate limited client waits until it may send at least this much
+static constexpr qint64 kMinSend { 64LL * 1024 };
+
+/// Transfers that make no progress for this long are dropped
+static constexpr std::chrono::milliseconds kStallTimeout { 60s };
+
+HttpFileStreamer::HttpFileStreamer(DoneCallback done)
+  : MThread("HttpFileStreamer"), m_done(std::move(done))
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (m_epollFd < 0 || m_wakeFd < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to create epoll instance" + ENO);
+        m_running = false;
+        return;
+    }
+
+    struct epoll_event event {};
+    event.events  = EPOLLIN;
+    event.data.fd = m_wakeFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+
+    start();
+}
+
+HttpFileStreamer::~HttpFileStreamer()
+{
+    Stop();
+    wait();
+
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+    if (m_epollFd >= 0)
+        close(m_epollFd);
+}
+
+/// \brief Limit each client address to bytesPerSec, 0 for no limit.
+void HttpFileStreamer::SetRateLimit(qint64 bytesPerSec)
+{
+    QMutexLocker locker(&m_lock);
+    m_rateLimit = std::max(bytesPerSec, 0LL);
+    m_buckets.clear();
+}
+
+/**
+ *  \brief Send the file to socket in the background.
+ *
+ *   On success the streamer owns both socket and stream.m_file, which is
+ *   set to -1.  When the transfer ends the socket is passed to the done
+ *   callback.
+ *
+ *  \return false if the streamer isn't running, nothing is taken over
+ */
+bool HttpFileStreamer::Start(int socket, HttpFileStream &stream,
+                             const QString &peer, bool keepAlive)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_running)
+        return false;
+
+    Transfer transfer;
+    transfer.m_socket    = socket;
+    transfer.m_stream    = stream;
+    transfer.m_peer      = peer;
+    transfer.m_keepAlive = keepAlive;
+    m_incoming.append(transfer);
+
+    stream.m_file = -1;
+    locker.unlock();
+
+    uint64_t one = 1;
+    if (write(m_wakeFd, &one, sizeof(one)) < 0)
+        LOG(VB_HTTP, LOG_ERR, LOC + "Unable to wake streamer" + ENO);
+
+    return true;
+}
+
+/**
+ *  \brief Send the file to socket from the calling thread, used when the
+ *         connection can't be handed over.
+ *
+ *   stream.m_file is closed.  The socket may be non-blocking.
+ */
+bool HttpFileStreamer::Send(int socket, HttpFileStream &stream,
+                            const QString &peer)
+{
+    bool ok = false;
+
+    while (true)
+    {
+        std::chrono::milliseconds wait {0ms};
+        SendResult result = SendSome(socket, stream, peer, wait);
+
+        if (result == kSendDone)
+        {
+            ok = true;
+            break;
+        }
+
+        if (result == kSendError)
+            break;
+
+        if (result == kSendBlocked)
+        {
+            if (wait > 0ms)
+            {
+                std::this_thread::sleep_for(wait);
+                continue;
+            }
+
+            struct pollfd pfd {};
+            pfd.fd     = socket;
+            pfd.events = POLLOUT;
+            int ready = poll(&pfd, 1, kStallTimeout.count());
+            if (ready < 0 && errno == EINTR)
+                continue;
+            if (ready <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+                break;
+        }
+    }
+
+    close(stream.m_file);
+    stream.m_file = -1;
+
+    return ok;
+}
+
+/// \brief Stop streaming, the sockets of unfinished transfers are closed.
+void HttpFileStreamer::Stop(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_running = false;
+    locker.unlock();
+
+    uint64_t one = 1;
+    if (m_wakeFd >= 0 && write(m_wakeFd, &one, sizeof(one)) < 0)
+        LOG(VB_HTTP, LOG_ERR, LOC + "Unable to wake streamer" + ENO);
+}
+
+void HttpFileStreamer::run(void)
+{
+    RunProlog();
+
+    std::array<struct epoll_event, 64> events {};
+
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            if (!m_running)
+                break;
+        }
+
+        AddTransfers();
+
+        // Wake in time for the transfers held back by the rate limit
+        Clock::time_point now = Clock::now();
+        std::chrono::milliseconds timeout = kStallTimeout;
+        for (const auto &transfer : qAsConst(m_transfers))
+        {
+            if (transfer.m_waiting)
+            {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    transfer.m_resume - now);
+                timeout = std::clamp(left + 1ms, 0ms, timeout);
+            }
+        }
+
+        int count = epoll_wait(m_epollFd, events.data(),
+                               static_cast<int>(events.size()),
+                               timeout.count());
+        if (count < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "epoll_wait failed" + ENO);
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = events[i].data.fd;
+            if (fd == m_wakeFd)
+            {
+                uint64_t value = 0;
+                if (read(m_wakeFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                    LOG(VB_HTTP, LOG_ERR, LOC + "Unable to read wake event" + ENO);
+                continue;
+            }
+
+            auto it = m_transfers.find(fd);
+            if (it == m_transfers.end())
+                continue;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+                Finish(*it, false);
+            else if (!it->m_waiting)
+                Pump(*it);
+        }
+
+        // Resume the rate limited transfers and drop the stalled ones
+        now = Clock::now();
+        QList<int> sockets = m_transfers.keys();
+        for (int socket : qAsConst(sockets))
+        {
+            Transfer &transfer = m_transfers[socket];
+            if (transfer.m_waiting && transfer.m_resume <= now)
+            {
+                Pump(transfer);
+            }
+            else if (!transfer.m_waiting &&
+                     now - transfer.m_progress > kStallTimeout)
+            {
+                LOG(VB_HTTP, LOG_WARNING, LOC +
+                    QString("Client %1 stopped reading, dropping it")
+                        .arg(transfer.m_peer));
+                Finish(transfer, false);
+            }
+        }
+    }
+
+    // Nothing can be handed back once the server is going away
+    QList<Transfer> pending;
+    {
+        QMutexLocker locker(&m_lock);
+        pending.swap(m_incoming);
+    }
+    pending.append(m_transfers.values());
+    m_transfers.clear();
+    for (const auto &transfer : qAsConst(pending))
+    {
+        close(transfer.m_stream.m_file);
+        close(transfer.m_socket);
+    }
+
+    RunEpilog();
+}
+
+HttpFileStreamer::SendResult HttpFileStreamer::SendSome(
+    int socket, HttpFileStream &stream, const QString &peer,
+    std::chrono::milliseconds &wait)
+{
+    qint64 allowed = Allowance(peer, wait);
+    if (allowed <= 0)
+        return kSendBlocked;
+
+    auto count = static_cast<size_t>(std::min({ stream.m_length, kChunkSize,
+                                                allowed }));
+    off_t offset = stream.m_offset;
+    ssize_t sent = sendfile(socket, stream.m_file, &offset, count);
+
+    if (sent < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return kSendBlocked;
+
+        LOG(VB_HTTP, LOG_INFO, LOC + QString("sendfile to %1 failed").arg(peer) +
+            ENO);
+        return kSendError;
+    }
+
+    if (sent == 0)
+    {
+        // The file is shorter than the Content-Length that was sent
+        LOG(VB_HTTP, LOG_WARNING, LOC +
+            QString("Unexpected end of file at %1").arg(stream.m_offset));
+        return kSendError;
+    }
+
+    Consume(peer, sent);
+    stream.m_offset += sent;
+    stream.m_length -= sent;
+
+    return (stream.m_length > 0) ? kSendMore : kSendDone;
+}
+
+/**
+ *  \brief The number of bytes peer may send now.  If it is 0, wait is how
+ *         long until it may send again.
+ *
+ *   Each client address has a bucket that fills at the rate limit, and
+ *   holds at most one second's worth.
+ */
+qint64 HttpFileStreamer::Allowance(const QString &peer,
+                                   std::chrono::milliseconds &wait)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_rateLimit <= 0)
+        return kChunkSize;
+
+    Clock::time_point now = Clock::now();
+
+    if (m_buckets.size() > 64)
+    {
+        for (auto it = m_buckets.begin(); it != m_buckets.end(); )
+        {
+            if (now - it->m_refilled > 1min)
+                it = m_buckets.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // A new bucket starts full
+    RateBucket &bucket = m_buckets[peer];
+    double elapsed = std::chrono::duration<double>(now - bucket.m_refilled).count();
+    bucket.m_tokens = std::min(static_cast<double>(m_rateLimit),
+                               bucket.m_tokens + (elapsed * m_rateLimit));
+    bucket.m_refilled = now;
+
+    qint64 minimum = std::min(kMinSend, m_rateLimit);
+    if (bucket.m_tokens < minimum)
+    {
+        double seconds = (minimum - bucket.m_tokens) / m_rateLimit;
+        wait = std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000) + 1);
+        return 0;
+    }
+
+    return static_cast<qint64>(bucket.m_tokens);
+}
+
+void HttpFileStreamer::Consume(const QString &peer, qint64 bytes)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_rateLimit > 0)
+        m_buckets[peer].m_tokens -= bytes;
+}
+
+/// \brief Start watching the transfers handed over by Start().
+void HttpFileStreamer::AddTransfers(void)
+{
+    QList<Transfer> incoming;
+    {
+        QMutexLocker locker(&m_lock);
+        incoming.swap(m_incoming);
+    }
+
+    Clock::time_point now = Clock::now();
+    for (auto &transfer : incoming)
+    {
+        transfer.m_started  = now;
+        transfer.m_progress = now;
+        Transfer &added = m_transfers[transfer.m_socket];
+        added = transfer;
+
+        struct epoll_event event {};
+        event.events  = EPOLLOUT;
+        event.data.fd = added.m_socket;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, added.m_socket, &event) < 0)
+        {
+            LOG(VB_HTTP, LOG_ERR, LOC + "Unable to watch socket" + ENO);
+            Finish(added, false);
+        }
+    }
+}
+
+/// \brief Send the next part of a transfer, the socket is writable.
+void HttpFileStreamer::Pump(Transfer &transfer)
+{
+    std::chrono::milliseconds wait {0ms};
+    qint64 before = transfer.m_stream.m_length;
+    SendResult result = SendSome(transfer.m_socket, transfer.m_stream,
+                                 transfer.m_peer, wait);
+    transfer.m_sent += before - transfer.m_stream.m_length;
+
+    switch (result)
+    {
+        case kSendDone:
+            Finish(transfer, true);
+            return;
+        case kSendError:
+            Finish(transfer, false);
+            return;
+        case kSendMore:
+            transfer.m_progress = Clock::now();
+            if (transfer.m_waiting)
+            {
+                transfer.m_waiting = false;
+                Watch(transfer, true);
+            }
+            return;
+        case kSendBlocked:
+            if (wait > 0ms)
+            {
+                // Stop polling the socket until the rate limit allows more
+                transfer.m_progress = Clock::now();
+                transfer.m_resume = transfer.m_progress + wait;
+                if (!transfer.m_waiting)
+                {
+                    transfer.m_waiting = true;
+                    Watch(transfer, false);
+                }
+            }
+            else if (transfer.m_waiting)
+            {
+                transfer.m_waiting = false;
+                Watch(transfer, true);
+            }
+            return;
+    }
+}
+
+void HttpFileStreamer::Watch(const Transfer &transfer, bool writable)
+{
+    struct epoll_event event {};
+    event.events  = writable ? EPOLLOUT : 0;
+    event.data.fd = transfer.m_socket;
+    epoll_ctl(m_epollFd, EPOLL_CTL_MOD, transfer.m_socket, &event);
+}
+
+/// \brief Stop watching the transfer and hand its socket to the callback.
+void HttpFileStreamer::Finish(Transfer &transfer, bool ok)
+{
+    int  socket    = transfer.m_socket;
+    bool keepAlive = ok && transfer.m_keepAlive;
+
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socket, nullptr);
+    close(transfer.m_stream.m_file);
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - transfer.m_started).count();
+    LOG(VB_HTTP, LOG_INFO, LOC +
+        QString("%1 %2 bytes to %3 in %4 ms (%5 kB/s)")
+            .arg(ok ? "Sent" : "Aborted after").arg(transfer.m_sent)
+            .arg(transfer.m_peer).arg(ms)
+            .arg(transfer.m_sent / std::max<int64_t>(ms, 1)));
+
+    m_transfers.remove(socket);
+
+    if (m_done)
+        m_done(socket, keepAlive);
+    else
+        close(socket);
+}
@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpfilestreamer.h
+//
+// Purpose     : Sends file bodies to HTTP clients with sendfile(), without
+//               holding an HttpServer worker thread for the transfer
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPFILESTREAMER_H
+#define HTTPFILESTREAMER_H
+
+// C++ headers
+#include <chrono>
+#include <functional>
+
+// Qt headers
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// MythTV headers
+#include "mthread.h"
+#include "httprequest.h"
+
+/** \class HttpFileStreamer
+ *  \brief Streams files to sockets from one epoll thread.
+ *
+ *   HttpWorker hands the connection over once the response header has been
+ *   written, and the kernel copies the file to the socket with sendfile().
+ *   When the body has been sent the connection is given back through the
+ *   done callback, so that the next request on a keep-alive connection is
+ *   read by a worker again.
+ *
+ *   Clients can be limited to a number of bytes per second.  The limit is
+ *   shared by all the connections from the same address.
+ */
+class HttpFileStreamer : public MThread
+{
+  public:
+    /// Called on the streamer thread with the socket once a transfer ends.
+    /// The callback owns the socket, keepAlive is false if it failed.
+    using DoneCallback = std::function<void(int socket, bool keepAlive)>;
+
+    explicit HttpFileStreamer(DoneCallback done);
+    ~HttpFileStreamer() override;
+
+    void   SetRateLimit(qint64 bytesPerSec);
+    bool   Start(int socket, HttpFileStream &stream, const QString &peer,
+                 bool keepAlive);
+    bool   Send(int socket, HttpFileStream &stream, const QString &peer);
+    void   Stop(void);
+
+  protected:
+    void   run(void) override; // MThread
+
+  private:
+    Q_DISABLE_COPY(HttpFileStreamer)
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Transfer
+    {
+        int               m_socket    {-1};
+        HttpFileStream    m_stream;
+        QString           m_peer;
+        bool              m_keepAlive {false};
+        bool              m_waiting   {false};  ///< held back by the rate limit
+        qint64            m_sent      {0};
+        Clock::time_point m_started;
+        Clock::time_point m_progress;           ///< last time data was sent
+        Clock::time_point m_resume;             ///< when the rate limit allows more
+    };
+
+    struct RateBucket
+    {
+        double            m_tokens    {0.0};
+        Clock::time_point m_refilled;
+    };
+
+    enum SendResult { kSendDone, kSendMore, kSendBlocked, kSendError };
+
+    SendResult SendSome(int socket, HttpFileStream &stream, const QString &peer,
+                        std::chrono::milliseconds &wait);
+    qint64 Allowance(const QString &peer, std::chrono::milliseconds &wait);
+    void   Consume(const QString &peer, qint64 bytes);
+    void   AddTransfers(void);
+    void   Pump(Transfer &transfer);
+    void   Finish(Transfer &transfer, bool ok);
+    void   Watch(const Transfer &transfer, bool writable);
+
+    int                     m_epollFd    {-1};
+    int                     m_wakeFd     {-1};
+    DoneCallback            m_done;
+
+    QMutex                  m_lock;
+    QList<Transfer>         m_incoming;     // protected by m_lock
+    QHash<QString, RateBucket> m_buckets;   // protected by m_lock
+    qint64                  m_rateLimit  {0}; // protected by m_lock
+    bool                    m_running    {true}; // protected by m_lock
+
+    QHash<int, Transfer>    m_transfers;    // streamer thread only
+};
+
+#endif // HTTPFILESTREAMER_H
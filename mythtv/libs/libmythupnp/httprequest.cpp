@@ -52,6 +52,7 @@
 #include "serializers/soapSerializer.h"
 #include "serializers/jsonSerializer.h"
 #include "serializers/xmlplistSerializer.h"
+#include "httpresponsestream.h"
 
 #include <unistd.h> // for gethostname
 
@@ -162,6 +163,15 @@ const char *HTTPRequest::s_szServerHeaders = "Accept-Ranges: bytes\r\n";
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    delete m_pResponseStream;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString HTTPRequest::GetLastHeader( const QString &sType ) const
 {
     QStringList values = m_mapHeaders.values( sType );
@@ -244,7 +254,9 @@ QString HTTPRequest::BuildResponseHeader( long long nSize )
             SetResponseHeader("Content-Disposition", QString("inline; filename=\"%2\"").arg(QString(filename.toLatin1())));
         }
 
-        SetResponseHeader("Content-Length", QString::number(nSize));
+        // A chunked response has no length
+        if (nSize >= 0)
+            SetResponseHeader("Content-Length", QString::number(nSize));
 
         // See DLNA  7.4.1.3.11.4.3 Tolerance to unavailable contentFeatures.dlna.org header
         //
@@ -313,6 +325,24 @@ qint64 HTTPRequest::SendResponse( void )
 {
     qint64      nBytes    = 0;
 
+    // ----------------------------------------------------------------------
+    // A large serialized response has already been sent while it was
+    // written. If it wasn't completed the connection can't be reused.
+    // ----------------------------------------------------------------------
+
+    if (m_pResponseStream && m_pResponseStream->IsStreaming())
+    {
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponse( Chunked ) :%1 -> %2: %3 bytes")
+                .arg(GetResponseStatus()) .arg(GetPeerAddress())
+                .arg(m_pResponseStream->GetBytesSent()));
+
+        if (!m_pResponseStream->IsFinished() || m_pResponseStream->HasFailed())
+            return( -1 );
+
+        return( m_pResponseStream->GetBytesSent() );
+    }
+
     switch( m_eResponseType )
     {
         // The following are all eligable for gzip compression
@@ -627,7 +657,25 @@ qint64 HTTPRequest::SendResponseFile( const QString& sFileName )
         QString("SendResponseFile : size = %1, start = %2, end = %3")
             .arg(llSize).arg(llStart).arg(llEnd));
 #endif
-    if (( m_eType != RequestTypeHead ) && (llSize != 0))
+    bool bDeferred = false;
+#ifdef __linux__
+    if (m_bStreamFiles && !m_bEncrypted && (nBytes == sHeader.length()) &&
+        ( m_eType != RequestTypeHead ) && (llSize != 0))
+    {
+        // Leave the body for the caller to send with sendfile(), the
+        // duplicate descriptor stays valid after tmpFile is closed
+        int fd = fcntl( tmpFile.handle(), F_DUPFD_CLOEXEC, 0 );
+        if (fd >= 0)
+        {
+            m_fileStream.m_file   = fd;
+            m_fileStream.m_offset = llStart;
+            m_fileStream.m_length = llSize;
+            bDeferred = true;
+        }
+    }
+#endif
+
+    if (!bDeferred && ( m_eType != RequestTypeHead ) && (llSize != 0))
     {
         long long sent = SendFile( tmpFile, llStart, llSize );
 
@@ -777,6 +825,28 @@ void HTTPRequest::FormatActionResponse( Serializer *pSer )
     pSer->AddHeaders( m_mapRespHeaders );
 
     //m_response << pFormatter->ToString();
+
+    if (m_pResponseStream == nullptr)
+        return;
+
+    if (m_pResponseStream->IsStreaming())
+    {
+        // The ETag is only known now.  It follows the body, if the client
+        // reads trailers.
+        QString sTrailer;
+        if (AcceptsTrailers())
+            sTrailer = QString( "ETag: %1\r\n" ).arg( m_mapRespHeaders[ "ETag" ] );
+        m_pResponseStream->Finish( sTrailer );
+    }
+    else
+    {
+        // Small enough to be sent as usual
+        m_response.buffer() = m_pResponseStream->TakeBuffer();
+        m_response.seek( m_response.size() );
+
+        delete m_pResponseStream;
+        m_pResponseStream = nullptr;
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1768,10 +1838,27 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 Serializer *HTTPRequest::GetSerializer()
 {
     Serializer *pSerializer = nullptr;
+    QIODevice  *pDevice     = &m_response;
+
+    // ----------------------------------------------------------------------
+    // Large responses are sent while they are serialized, rather than
+    // built up in memory first
+    // ----------------------------------------------------------------------
+
+    if (m_pResponseStream == nullptr && CanStreamResponse())
+    {
+        auto values = m_mapHeaders.values("accept-encoding");
+        bool bGzip  = std::any_of(values.cbegin(), values.cend(),
+                                  [](const auto & value)
+                                      {return value.contains( "gzip" ); });
+
+        m_pResponseStream = new HttpResponseStream( this, bGzip );
+        pDevice = m_pResponseStream;
+    }
 
     if (m_bSOAPRequest)
     {
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     }
     else
@@ -1781,19 +1868,30 @@ Serializer *HTTPRequest::GetSerializer()
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ) ||
             sAccept.contains( "text/javascript", Qt::CaseInsensitive ))
         {
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         }
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
         {
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
         }
     }
 
     // Default to XML
 
     if (pSerializer == nullptr)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
+
+    // The header may be sent before FormatActionResponse() is called
+    if (m_pResponseStream != nullptr)
+    {
+        m_eResponseType     = ResponseTypeOther;
+        m_sResponseTypeText = pSerializer->GetContentType();
+        m_nResponseStatus   = 200;
+
+        pSerializer->AddHeaders( m_mapRespHeaders );
+        m_mapRespHeaders.remove( "ETag" );
+    }
 
     return pSerializer;
 }
@@ -1802,6 +1900,56 @@ Serializer *HTTPRequest::GetSerializer()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool HTTPRequest::CanStreamResponse()
+{
+    // Chunked transfer-encoding is HTTP/1.1. The ETag isn't known until
+    // the end, so a streamed response only has one as a trailer, for clients
+    // that read them.  Conditional requests need it before the body, so
+    // those responses are buffered.
+    if ((m_nMajor < 1) || (m_nMajor == 1 && m_nMinor < 1))
+        return false;
+
+    return !m_bSOAPRequest && (m_eType != RequestTypeHead) &&
+           GetRequestHeader( "If-None-Match", "" ).isEmpty() &&
+           !qEnvironmentVariableIsSet("HTTPREQUEST_DEBUG");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPRequest::AcceptsTrailers()
+{
+    return GetRequestHeader( "TE", "" ).contains( "trailers", Qt::CaseInsensitive );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPRequest::SendStreamHeader( bool bGzip )
+{
+    SetResponseHeader( "Transfer-Encoding", "chunked", true );
+
+    if (bGzip)
+        SetResponseHeader( "Content-Encoding", "gzip", true );
+
+    if (AcceptsTrailers())
+        SetResponseHeader( "Trailer", "ETag", true );
+
+    QByteArray sHeader = BuildResponseHeader( -1 ).toUtf8();
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("Response header size: %1 bytes").arg(sHeader.length()));
+
+    qint64 nBytes = WriteBlock( sHeader.constData(), sHeader.length() );
+
+    return (nBytes == sHeader.length()) ? nBytes : -1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString HTTPRequest::Encode(const QString &sIn)
 {
     QString sStr = sIn;
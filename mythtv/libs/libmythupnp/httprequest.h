@@ -35,6 +35,8 @@
                              "<s:Body>"
 #define SOAP_ENVELOPE_END    "</s:Body>\r\n</s:Envelope>";
 
+class HttpResponseStream;
+
 
 /////////////////////////////////////////////////////////////////////////////
 // Typedefs / Defines
@@ -84,6 +86,14 @@ enum HttpResponseType
     ResponseTypeHeader   =  9
 };
 
+/// \brief A file body left for the caller to send, see HTTPRequest::m_bStreamFiles
+struct HttpFileStream
+{
+    int     m_file   {-1};  ///< file descriptor, owned by whoever sends it
+    qint64  m_offset {0};
+    qint64  m_length {0};
+};
+
 struct MIMETypes
 {
     const char *pszExtension;
@@ -159,11 +169,23 @@ class UPNP_PUBLIC HTTPRequest
         QString             m_sPrivateToken;
         MythUserSession     m_userSession;
 
+        // When set, SendResponseFile() only writes the header of a file
+        // response and leaves the body in m_fileStream for the caller
+        bool                m_bStreamFiles      {false};
+        HttpFileStream      m_fileStream;
+
     private:
 
         bool                m_bKeepAlive        {true};
         std::chrono::seconds m_nKeepAliveTimeout {0s};
 
+        // Set while a serializer writes a response that may be sent
+        // before it is complete
+        HttpResponseStream *m_pResponseStream   {nullptr};
+
+        friend class HttpResponseStream;
+        friend class TestHttpResponseStream;
+
     protected:
 
         HttpRequestType SetRequestType      ( const QString &sType  );
@@ -192,6 +214,10 @@ class UPNP_PUBLIC HTTPRequest
         qint64          SendData            ( QIODevice *pDevice, qint64 llStart, qint64 llBytes );
         qint64          SendFile            ( QFile &file, qint64 llStart, qint64 llBytes );
 
+        bool            CanStreamResponse   ( void );
+        bool            AcceptsTrailers     ( void );
+        qint64          SendStreamHeader    ( bool bGzip );
+
         bool            IsProtected         () const { return m_bProtected; }
         bool            IsEncrypted         () const { return m_bEncrypted; }
         bool            Authenticated       ();
@@ -206,7 +232,7 @@ class UPNP_PUBLIC HTTPRequest
     public:
 
                         HTTPRequest     () { m_response.open( QIODevice::ReadWrite ); }
-        virtual        ~HTTPRequest     () = default;
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
@@ -0,0 +1,180 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.cpp
+//
+// Purpose     : Sends a serialized response with chunked transfer-encoding
+//               while it is being written
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own header
+#include "httpresponsestream.h"
+
+// C++ headers
+#include <array>
+
+// MythTV headers
+#include "mythlogging.h"
+#include "httprequest.h"
+
+#define LOC QString("HttpResponseStream: ")
+
+HttpResponseStream::HttpResponseStream(HTTPRequest *pRequest, bool bGzip)
+  : m_pRequest(pRequest), m_bGzip(bGzip)
+{
+    m_buffer.reserve(kChunkSize);
+    open(QIODevice::WriteOnly);
+}
+
+HttpResponseStream::~HttpResponseStream()
+{
+    if (m_bStreaming && m_bGzip)
+        deflateEnd(&m_zstream);
+}
+
+/**
+ *  \brief Take back the whole response, it fitted in the buffer and
+ *         nothing has been sent.
+ */
+QByteArray HttpResponseStream::TakeBuffer(void)
+{
+    QByteArray data;
+    if (!m_bStreaming)
+        data.swap(m_buffer);
+    return data;
+}
+
+/**
+ *  \brief Send the rest of the body and the last chunk.
+ *  \param sTrailer header lines to send after the body, may be empty
+ */
+void HttpResponseStream::Finish(const QString &sTrailer)
+{
+    if (!m_bStreaming || m_bFinished)
+        return;
+
+    m_bFinished = true;
+
+    if (!Flush(true))
+        return;
+
+    QByteArray last = "0\r\n" + sTrailer.toUtf8() + "\r\n";
+    qint64 nBytes = m_pRequest->WriteBlock(last.constData(), last.size());
+    if (nBytes != last.size())
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC + "Unable to write last chunk");
+        m_bFailed = true;
+        return;
+    }
+    m_nBytesSent += nBytes;
+}
+
+qint64 HttpResponseStream::readData(char */*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+qint64 HttpResponseStream::writeData(const char *data, qint64 maxSize)
+{
+    if (m_bFailed || m_bFinished)
+        return -1;
+
+    m_buffer.append(data, static_cast<int>(maxSize));
+
+    if (m_buffer.size() < kChunkSize)
+        return maxSize;
+
+    if (!m_bStreaming)
+    {
+        if (m_bGzip)
+        {
+            // windowBits + 16 writes a gzip header and trailer
+            m_zstream.zalloc = Z_NULL;
+            m_zstream.zfree  = Z_NULL;
+            m_zstream.opaque = Z_NULL;
+            if (deflateInit2(&m_zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                             MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                m_bGzip = false;
+            }
+        }
+
+        if (m_pRequest->SendStreamHeader(m_bGzip) < 0)
+        {
+            LOG(VB_HTTP, LOG_ERR, LOC + "Unable to write response header");
+            if (m_bGzip)
+                deflateEnd(&m_zstream);
+            m_bGzip   = false;
+            m_bFailed = true;
+            return -1;
+        }
+
+        m_bStreaming = true;
+    }
+
+    return Flush(false) ? maxSize : -1;
+}
+
+/// \brief Send what has been buffered, compressing it first if need be.
+bool HttpResponseStream::Flush(bool bFinal)
+{
+    if (!m_bGzip)
+    {
+        bool bOK = SendChunk(m_buffer);
+        m_buffer.clear();
+        return bOK;
+    }
+
+    // Each chunk is flushed, so that the client can start to decode it
+    // while the rest of the response is being serialized
+    QByteArray compressed;
+    std::array<char, 16384> out {};
+
+    m_zstream.next_in  = reinterpret_cast<Bytef*>(m_buffer.data());
+    m_zstream.avail_in = static_cast<uInt>(m_buffer.size());
+
+    do
+    {
+        m_zstream.next_out  = reinterpret_cast<Bytef*>(out.data());
+        m_zstream.avail_out = static_cast<uInt>(out.size());
+
+        if (deflate(&m_zstream, bFinal ? Z_FINISH : Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+        {
+            LOG(VB_HTTP, LOG_ERR, LOC + "Unable to compress response");
+            m_bFailed = true;
+            return false;
+        }
+
+        compressed.append(out.data(),
+                          static_cast<int>(out.size() - m_zstream.avail_out));
+    } while (m_zstream.avail_out == 0);
+
+    m_buffer.clear();
+
+    return SendChunk(compressed);
+}
+
+bool HttpResponseStream::SendChunk(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return true;
+
+    QByteArray chunk = QByteArray::number(data.size(), 16) + "\r\n";
+    chunk.reserve(chunk.size() + data.size() + 2);
+    chunk.append(data);
+    chunk.append("\r\n");
+
+    qint64 nBytes = m_pRequest->WriteBlock(chunk.constData(), chunk.size());
+    if (nBytes != chunk.size())
+    {
+        LOG(VB_HTTP, LOG_ERR, LOC +
+            QString("Incomplete write of chunk, %1 written of %2")
+                .arg(nBytes).arg(chunk.size()));
+        m_bFailed = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+    return true;
+}
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.h
+//
+// Purpose     : Sends a serialized response with chunked transfer-encoding
+//               while it is being written
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPRESPONSESTREAM_H
+#define HTTPRESPONSESTREAM_H
+
+// Qt headers
+#include <QByteArray>
+#include <QIODevice>
+
+#include <zlib.h>
+#undef Z_NULL
+#define Z_NULL nullptr
+
+// MythTV headers
+#include "upnpexp.h"
+
+class HTTPRequest;
+
+/** \class HttpResponseStream
+ *  \brief The device a Serializer writes to when the response may be large.
+ *
+ *   Output is buffered until it reaches kChunkSize.  A response that is
+ *   finished before then is taken back with TakeBuffer() and sent as usual,
+ *   with its Content-Length and ETag.
+ *
+ *   Otherwise the response header is sent as soon as the buffer fills, and
+ *   the rest of the body follows in chunks while the serializer is still
+ *   walking the results.  Neither the whole body nor its compressed copy is
+ *   ever held in memory.  The ETag, which is only known once everything has
+ *   been serialized, is sent as a trailer to clients that accept them.
+ *   Other clients get no ETag.
+ */
+class UPNP_PUBLIC HttpResponseStream : public QIODevice
+{
+  public:
+    static constexpr qint64 kChunkSize { 64LL * 1024 };
+
+    HttpResponseStream(HTTPRequest *pRequest, bool bGzip);
+    ~HttpResponseStream() override;
+
+    bool       IsStreaming (void) const { return m_bStreaming; }
+    bool       IsFinished  (void) const { return m_bFinished;  }
+    bool       HasFailed   (void) const { return m_bFailed;    }
+    qint64     GetBytesSent(void) const { return m_nBytesSent; }
+
+    QByteArray TakeBuffer  (void);
+    void       Finish      (const QString &sTrailer);
+
+  protected:
+    qint64     readData (char *data, qint64 maxSize) override; // QIODevice
+    qint64     writeData(const char *data, qint64 maxSize) override; // QIODevice
+
+  private:
+    Q_DISABLE_COPY(HttpResponseStream)
+
+    bool       Flush    (bool bFinal);
+    bool       SendChunk(const QByteArray &data);
+
+    HTTPRequest *m_pRequest   {nullptr};
+    QByteArray   m_buffer;
+    bool         m_bGzip      {false};
+    z_stream     m_zstream    {};
+    bool         m_bStreaming {false};
+    bool         m_bFinished  {false};
+    bool         m_bFailed    {false};
+    qint64       m_nBytesSent {0};
+};
+
+#endif // HTTPRESPONSESTREAM_H
@@ -43,6 +43,13 @@
 
 #include "serviceHosts/rttiServiceHost.h"
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include "httpconnectionmonitor.h"
+#include "httpfilestreamer.h"
+#endif
+
 /**
  * \brief Handle an OPTIONS request
  */
@@ -158,6 +165,43 @@ HttpServer::HttpServer() :
     RegisterExtension( new RttiServiceHost( m_sSharePath ));
 
     LoadSSLConfig();
+
+#ifdef __linux__
+    // ----------------------------------------------------------------------
+    // Plain connections wait for their next request without a worker, only
+    // the processing of a request runs on the pool.  File bodies are sent
+    // from a single thread, so that a slow client doesn't tie up a worker
+    // for the length of the transfer.
+    // ----------------------------------------------------------------------
+
+    m_connectionMonitor = new HttpConnectionMonitor(
+        [this](int socket)
+        {
+            if (IsRunning())
+                ResumeConnection(socket);
+            else
+                close(socket);
+        });
+
+    m_fileStreamer = new HttpFileStreamer(
+        [this](int socket, bool keepAlive)
+        {
+            if (keepAlive && IsRunning())
+            {
+                auto timeout = std::chrono::seconds(
+                    gCoreContext->GetNumSetting("HTTP/KeepAliveTimeoutSecs", 10));
+                WatchConnection(socket, timeout);
+            }
+            else
+            {
+                close(socket);
+            }
+        });
+
+    // Per client, in kB/s.  0 for no limit
+    int rateLimit = gCoreContext->GetNumSetting("HTTPStreamRateLimit", 0);
+    m_fileStreamer->SetRateLimit(rateLimit * 1024LL);
+#endif
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -170,8 +214,26 @@ HttpServer::~HttpServer()
     m_running = false;
     m_rwlock.unlock();
 
+#ifdef __linux__
+    // Stop these first, so that they no longer hand connections to the
+    // pool, and refuse the ones the workers still try to give them
+    m_fileStreamer->Stop();
+    m_connectionMonitor->Stop();
+    m_fileStreamer->wait();
+    m_connectionMonitor->wait();
+#endif
+
     m_threadPool.Stop();
 
+#ifdef __linux__
+    // The workers use them until they are done
+    m_threadPool.waitForDone();
+    delete m_fileStreamer;
+    m_fileStreamer = nullptr;
+    delete m_connectionMonitor;
+    m_connectionMonitor = nullptr;
+#endif
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -302,6 +364,12 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
     if (server)
         type = server->GetServerType();
 
+#ifdef __linux__
+    // Same as the worker's timeout for the first request
+    if (type == kTCPServer && m_connectionMonitor->Watch(socket, 5s))
+        return;
+#endif
+
     m_threadPool.startReserved(
         new HttpWorker(*this, socket, type
 #ifndef QT_NO_OPENSSL
@@ -315,6 +383,44 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+#ifdef __linux__
+void HttpServer::ResumeConnection(qt_socket_fd_t socket)
+{
+    // Only plain connections are watched, and there is a request waiting,
+    // so this worker is short lived
+    m_threadPool.start(
+        new HttpWorker(*this, socket, kTCPServer
+#ifndef QT_NO_OPENSSL
+                       , m_sslConfig
+#endif
+                       ),
+        QString("HttpServer%1").arg(socket));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::WatchConnection(qt_socket_fd_t socket,
+                                 std::chrono::milliseconds timeout)
+{
+    if (m_connectionMonitor->Watch(socket, timeout))
+        return;
+
+    m_threadPool.startReserved(
+        new HttpWorker(*this, socket, kTCPServer
+#ifndef QT_NO_OPENSSL
+                       , m_sslConfig
+#endif
+                       ),
+        QString("HttpServer%1").arg(socket));
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void HttpServer::RegisterExtension( HttpServerExtension *pExtension )
 {
     if (pExtension != nullptr )
@@ -474,6 +580,7 @@ void HttpWorker::run(void)
     HTTPRequest            *pRequest   = nullptr;
     QTcpSocket             *pSocket    = nullptr;
     bool                    bEncrypted = false;
+    bool                    bHandedOff = false;
 
     if (m_connectionType == kSSLServer)
     {
@@ -556,6 +663,9 @@ void HttpWorker::run(void)
                 if (pRequest != nullptr)
                 {
                     pRequest->m_bEncrypted = bEncrypted;
+#ifdef __linux__
+                    pRequest->m_bStreamFiles = true;
+#endif
                     if ( pRequest->ParseRequest() )
                     {
                         bKeepAlive = pRequest->GetKeepAlive();
@@ -598,12 +708,39 @@ void HttpWorker::run(void)
                                 .arg(pSocket->socketDescriptor()));
                     }
 
+#ifdef __linux__
+                    // -------------------------------------------------------
+                    // Send the body of a file response, the header is queued.
+                    // A PostProcess must wait for the whole body, so the
+                    // transfer then stays with this thread.
+                    // -------------------------------------------------------
+                    if (pRequest->m_fileStream.m_file >= 0)
+                    {
+                        bHandedOff = StreamFile(pSocket, pRequest->m_fileStream,
+                                                bKeepAlive,
+                                                pRequest->m_pPostProcess == nullptr);
+                        if (bHandedOff)
+                            bKeepAlive = false;
+                    }
+#endif
+
                     // -------------------------------------------------------
                     // Check to see if a PostProcess was registered
                     // -------------------------------------------------------
                     if ( pRequest->m_pPostProcess != nullptr )
                         pRequest->m_pPostProcess->ExecutePostProcess();
 
+#ifdef __linux__
+                    // -------------------------------------------------------
+                    // Wait for the next request without holding this thread
+                    // -------------------------------------------------------
+                    if (bKeepAlive && ReleaseConnection(pSocket))
+                    {
+                        bHandedOff = true;
+                        bKeepAlive = false;
+                    }
+#endif
+
                     delete pRequest;
                     pRequest = nullptr;
                 }
@@ -679,10 +816,20 @@ void HttpWorker::run(void)
                                             .arg(pSocket->errorString()));
     }
 
-    LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
+    if (bHandedOff)
+    {
+        LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection released. "
+                                       "%2 requests were handled")
+                                        .arg(m_socket)
+                                        .arg(nRequestsHandled));
+    }
+    else
+    {
+        LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
                                         .arg(m_socket)
                                         .arg(pSocket->socketDescriptor())
                                         .arg(nRequestsHandled));
+    }
 
     pSocket->close();
     delete pSocket;
@@ -693,4 +840,91 @@ void HttpWorker::run(void)
 #endif
 }
 
+#ifdef __linux__
+/**
+ * \brief Send the file body of a response with sendfile()
+ *
+ * Plain connections with no further request waiting are handed over to the
+ * HttpFileStreamer, which passes them to the HttpConnectionMonitor when the
+ * body has been sent.  Otherwise, or if bAllowHandOff is false, the body is
+ * sent from this thread and has been sent when this returns.
+ *
+ * \return true if the connection was handed over, it must not be used again
+ */
+bool HttpWorker::StreamFile(QTcpSocket *pSocket, HttpFileStream &stream,
+                            bool &bKeepAlive, bool bAllowHandOff)
+{
+    HttpFileStreamer *pStreamer = m_httpServer.GetFileStreamer();
+    QString sPeer = pSocket->peerAddress().toString();
+
+    // The header must reach the socket before the body
+    if (!FlushSocket(pSocket))
+    {
+        close(stream.m_file);
+        stream.m_file = -1;
+        bKeepAlive = false;
+        return false;
+    }
+
+    // A pipelined request already read by Qt would be lost with the socket
+    if (bAllowHandOff && m_connectionType == kTCPServer &&
+        pSocket->bytesAvailable() == 0)
+    {
+        // The socket closes its own descriptor when it is deleted
+        int fd = fcntl(pSocket->socketDescriptor(), F_DUPFD_CLOEXEC, 0);
+        if (fd >= 0)
+        {
+            if (pStreamer->Start(fd, stream, sPeer, bKeepAlive))
+                return true;
+            close(fd);
+        }
+    }
+
+    if (!pStreamer->Send(pSocket->socketDescriptor(), stream, sPeer))
+        bKeepAlive = false;
+
+    return false;
+}
+
+/**
+ * \brief Hand an idle keep-alive connection to the HttpConnectionMonitor
+ *
+ * The monitor starts a new worker when the next request arrives.  SSL
+ * connections, and those with a pipelined request already read, stay with
+ * this worker.
+ *
+ * \return true if the connection was handed over, it must not be used again
+ */
+bool HttpWorker::ReleaseConnection(QTcpSocket *pSocket)
+{
+    if (m_connectionType != kTCPServer || pSocket->bytesAvailable() > 0 ||
+        !m_httpServer.IsRunning() || !FlushSocket(pSocket))
+        return false;
+
+    // The socket closes its own descriptor when it is deleted
+    int fd = fcntl(pSocket->socketDescriptor(), F_DUPFD_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    if (m_httpServer.GetConnectionMonitor()->Watch(fd, m_socketTimeout))
+        return true;
+
+    close(fd);
+    return false;
+}
+
+/**
+ * \brief Wait until everything written to pSocket has reached the kernel
+ */
+bool HttpWorker::FlushSocket(QTcpSocket *pSocket) const
+{
+    while (pSocket->bytesToWrite() > 0 &&
+           pSocket->waitForBytesWritten(m_socketTimeout.count()))
+        ;
+
+    return pSocket->bytesToWrite() == 0 &&
+           pSocket->state() == QAbstractSocket::ConnectedState;
+}
+#endif
+
 
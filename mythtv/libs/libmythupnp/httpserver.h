@@ -97,6 +97,11 @@ class UPNP_PUBLIC HttpServerExtension : public QObject
         virtual int GetSocketTimeout() const { return m_nSocketTimeout; }// -1 = Use config value
 };
 
+#ifdef __linux__
+class HttpConnectionMonitor;
+class HttpFileStreamer;
+#endif
+
 using HttpServerExtensionList = QList<QPointer<HttpServerExtension> >;
 
 /////////////////////////////////////////////////////////////////////////////
@@ -139,6 +144,14 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     static QString GetPlatform(void);
     static QString GetServerVersion(void);
 
+#ifdef __linux__
+    /// Waits for requests on idle connections, never nullptr
+    HttpConnectionMonitor *GetConnectionMonitor(void) const
+        { return m_connectionMonitor; }
+    /// Sends file responses in the background, never nullptr
+    HttpFileStreamer *GetFileStreamer(void) const { return m_fileStreamer; }
+#endif
+
   protected:
     mutable QReadWriteLock  m_rwlock;
     HttpServerExtensionList m_extensions;
@@ -155,6 +168,11 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     QSslConfiguration       m_sslConfig;
 #endif
 
+#ifdef __linux__
+    HttpConnectionMonitor  *m_connectionMonitor {nullptr};
+    HttpFileStreamer       *m_fileStreamer {nullptr};
+#endif
+
     const QString m_privateToken; // Private token; Used to salt digest auth nonce, changes on backend restart
 
   protected slots:
@@ -162,6 +180,11 @@ class UPNP_PUBLIC HttpServer : public ServerPool
 
   private:
     void LoadSSLConfig();
+#ifdef __linux__
+    void ResumeConnection(qt_socket_fd_t socket);
+    void WatchConnection(qt_socket_fd_t socket,
+                         std::chrono::milliseconds timeout);
+#endif
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -190,6 +213,14 @@ class HttpWorker : public QRunnable
 
     void run(void) override; // QRunnable
 
+  private:
+#ifdef __linux__
+    bool StreamFile(QTcpSocket *pSocket, HttpFileStream &stream,
+                    bool &bKeepAlive, bool bAllowHandOff);
+    bool ReleaseConnection(QTcpSocket *pSocket);
+    bool FlushSocket(QTcpSocket *pSocket) const;
+#endif
+
   protected:
     HttpServer &m_httpServer; 
     qt_socket_fd_t m_socket;
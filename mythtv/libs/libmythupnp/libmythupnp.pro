@@ -21,6 +21,7 @@ HEADERS += mmulticastsocketdevice.h     mbroadcastsocketdevice.h
 HEADERS += msocketdevice.h
 HEADERS += httprequest.h upnp.h ssdp.h taskqueue.h upnpsubscription.h
 HEADERS += upnpdevice.h upnptasknotify.h upnptasksearch.h upnputil.h
+HEADERS += upnpcdscache.h httpresponsestream.h
 HEADERS += httpserver.h upnpcds.h upnpcdsobjects.h bufferedsocketdevice.h upnpmsrr.h
 HEADERS += eventing.h upnpcmgr.h upnptaskevent.h upnptaskcache.h ssdpcache.h
 HEADERS += configuration.h
@@ -28,6 +29,7 @@ HEADERS += soapclient.h mythxmlclient.h mmembuf.h upnpexp.h
 HEADERS += upnpserviceimpl.h
 HEADERS += servicehost.h wsdl.h htmlserver.h serverSideScripting.h xsd.h
 HEADERS += upnphelpers.h websocket.h
+linux:HEADERS += httpconnectionmonitor.h httpfilestreamer.h
 
 HEADERS += services/rtti.h
 HEADERS += serviceHosts/rttiServiceHost.h
@@ -45,12 +47,14 @@ mingw | win32-msvc*:SOURCES += msocketdevice_win.cpp
 SOURCES += httprequest.cpp upnp.cpp ssdp.cpp taskqueue.cpp upnputil.cpp
 SOURCES += upnpdevice.cpp upnptasknotify.cpp upnptasksearch.cpp
 SOURCES += httpserver.cpp upnpcds.cpp upnpcdsobjects.cpp bufferedsocketdevice.cpp
+SOURCES += upnpcdscache.cpp httpresponsestream.cpp
 SOURCES += eventing.cpp upnpcmgr.cpp upnpmsrr.cpp upnptaskevent.cpp ssdpcache.cpp
 SOURCES += configuration.cpp soapclient.cpp mythxmlclient.cpp mmembuf.cpp
 SOURCES += upnpserviceimpl.cpp
 SOURCES += htmlserver.cpp serverSideScripting.cpp
 SOURCES += servicehost.cpp wsdl.cpp upnpsubscription.cpp xsd.cpp
 SOURCES += upnphelpers.cpp websocket.cpp
+linux:SOURCES += httpconnectionmonitor.cpp httpfilestreamer.cpp
 
 SOURCES += services/rtti.cpp
 
@@ -81,7 +85,7 @@ inc.path = $${PREFIX}/include/mythtv/upnp/
 
 inc.files  = httprequest.h upnp.h ssdp.h taskqueue.h bufferedsocketdevice.h
 inc.files += upnpdevice.h upnptasknotify.h upnptasksearch.h upnputil.h
-inc.files += httpserver.h httpstatus.h upnpcds.h upnpcdsobjects.h
+inc.files += httpserver.h httpstatus.h upnpcds.h upnpcdsobjects.h upnpcdscache.h
 inc.files += eventing.h upnpcmgr.h upnptaskevent.h upnptaskcache.h ssdpcache.h
 inc.files += upnpimpl.h configuration.h
 inc.files += soapclient.h mythxmlclient.h mmembuf.h upnpsubscription.h
@@ -118,3 +122,10 @@ use_hidesyms {
 include ( ../libs-targetfix.pro )
 
 LIBS += $$LATE_LIBS
+
+test_clean.commands = -cd test/ && $(MAKE) -f Makefile clean
+clean.depends = test_clean
+QMAKE_EXTRA_TARGETS += test_clean clean
+test_distclean.commands = -cd test/ && $(MAKE) -f Makefile distclean
+distclean.depends = test_distclean
+QMAKE_EXTRA_TARGETS += test_distclean distclean
@@ -12,8 +12,59 @@
 
 #include "serializer.h"
 
+#include <QHash>
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QReadWriteLock>
+
+//////////////////////////////////////////////////////////////////////////////
+// moc's tables don't change at run time, so what is needed to serialize each
+// property is worked out once per class rather than for every object.
+//////////////////////////////////////////////////////////////////////////////
+
+QVector<Serializer::PropertyInfo> Serializer::GetPropertyTable( const QObject *pObject )
+{
+    static QReadWriteLock s_lock;
+    static QHash< const QMetaObject *, QVector<PropertyInfo> > s_tables;
+
+    const QMetaObject *pMetaObject = pObject->metaObject();
+
+    {
+        QReadLocker locker( &s_lock );
+
+        auto it = s_tables.constFind( pMetaObject );
+        if (it != s_tables.constEnd())
+            return *it;
+    }
+
+    QVector<PropertyInfo> table;
+
+    int nCount = pMetaObject->propertyCount();
+
+    for (int nIdx=0; nIdx < nCount; ++nIdx )
+    {
+        QMetaProperty metaProperty = pMetaObject->property( nIdx );
+
+        PropertyInfo prop;
+        prop.m_nIndex    = nIdx;
+        prop.m_sName     = metaProperty.name();
+        prop.m_sUtf8Name = prop.m_sName.toUtf8();
+
+        if ( prop.m_sName.compare( "objectName" ) == 0)
+            continue;
+
+        prop.m_bTransient = (ReadPropertyMetadata( pObject, prop.m_sName,
+                                                   "transient" )
+                             .toLower() == "true");
+
+        table.append( prop );
+    }
+
+    QWriteLocker locker( &s_lock );
+    s_tables.insert( pMetaObject, table );
+
+    return table;
+}
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -106,38 +157,28 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
     {
         const QMetaObject *pMetaObject = pObject->metaObject();
 
-        int nCount = pMetaObject->propertyCount();
+        const QVector<PropertyInfo> table = GetPropertyTable( pObject );
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        for (const auto &prop : table)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            QMetaProperty metaProperty = pMetaObject->property( prop.m_nIndex );
 
+            // DESIGNABLE can depend on the object, e.g. SerializeDetails
             if (metaProperty.isDesignable( pObject ))
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
+                bool bHash = !prop.m_bTransient;
 
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-                
-                bool bHash = false;
-
-                if (ReadPropertyMetadata( pObject, 
-                                          sPropName,
-                                          "transient").toLower() != "true" )
-                {
-                    bHash = true;
-                    m_hash.addData( sPropName.toUtf8() );
-                }
+                if (bHash)
+                    m_hash.addData( prop.m_sUtf8Name );
 
-                QVariant value( pObject->property( pszPropName ) );
+                QVariant value( metaProperty.read( pObject ) );
 
                 if (bHash && !value.canConvert< QObject* >()) 
                 {
                     m_hash.addData( value.toString().toUtf8() );
                 }
 
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                AddProperty( prop.m_sName, value, pMetaObject, &metaProperty );
             }
         }
     }
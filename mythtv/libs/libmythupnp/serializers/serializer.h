@@ -17,6 +17,7 @@
 #include "upnputil.h"
 
 #include <QList>
+#include <QVector>
 #include <QMetaType>
 #include <QCryptographicHash>
 
@@ -54,6 +55,16 @@ class UPNP_PUBLIC Serializer
                                                  const QString&  sPropName,
                                                  const QString&  sKey );
 
+        struct PropertyInfo
+        {
+            int        m_nIndex     {-1};
+            QString    m_sName;
+            QByteArray m_sUtf8Name;
+            bool       m_bTransient {false};
+        };
+
+        static QVector<PropertyInfo> GetPropertyTable( const QObject *pObject );
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
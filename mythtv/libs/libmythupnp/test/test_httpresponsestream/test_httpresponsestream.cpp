@@ -0,0 +1,278 @@
+/*
+ *  Class TestHttpResponseStream
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <array>
+
+#include "test_httpresponsestream.h"
+
+#include "mythcorecontext.h"
+#include "serializers/serializer.h"
+
+/// A request that keeps what is written to the client
+class TestRequest : public HTTPRequest
+{
+  public:
+    TestRequest()
+    {
+        m_eType      = RequestTypeGet;
+        m_nMajor     = 1;
+        m_nMinor     = 1;
+        m_bKeepAlive = false;
+    }
+
+    QString ReadLine(std::chrono::milliseconds /*msecs*/) override
+        { return {}; }
+    qint64  ReadBlock(char */*pData*/, qint64 /*nMaxLen*/,
+                      std::chrono::milliseconds /*msecs*/ = 0ms) override
+        { return -1; }
+    qint64  WriteBlock(const char *pData, qint64 nLen) override
+    {
+        m_written.append(pData, static_cast<int>(nLen));
+        return nLen;
+    }
+    QString GetHostAddress() override { return "127.0.0.1"; }
+    quint16 GetHostPort() override { return 6544; }
+    QString GetPeerAddress() override { return "127.0.0.1"; }
+    int     getSocketHandle() override { return -1; }
+
+    QByteArray m_written;
+};
+
+// A response of size bytes, not too regular so gzip has some work to do
+static QByteArray make_body(int size)
+{
+    QByteArray body;
+    body.reserve(size);
+    for (int i = 0; body.size() < size; ++i)
+        body.append(QByteArray::number(i * 7919 % 100003)).append(',');
+    body.truncate(size);
+    return body;
+}
+
+/**
+ * Split a response into its header, the body from its chunks and the
+ * trailer, checking the chunked framing on the way.
+ */
+static bool parse_chunked(const QByteArray &response, QByteArray &header,
+                          QByteArray &body, QByteArray &trailer)
+{
+    int end = response.indexOf("\r\n\r\n");
+    if (end < 0)
+        return false;
+    header = response.left(end + 2);
+
+    int pos = end + 4;
+    while (true)
+    {
+        int eol = response.indexOf("\r\n", pos);
+        if (eol < 0)
+            return false;
+        bool ok = false;
+        int size = response.mid(pos, eol - pos).toInt(&ok, 16);
+        if (!ok)
+            return false;
+        pos = eol + 2;
+        if (size == 0)
+            break;
+        if (response.mid(pos + size, 2) != "\r\n")
+            return false;
+        body.append(response.mid(pos, size));
+        pos += size + 2;
+    }
+
+    // The trailer lines, then an empty line to end the response
+    QByteArray rest = response.mid(pos);
+    if (!rest.endsWith("\r\n") ||
+        (rest.size() > 2 && !rest.endsWith("\r\n\r\n")))
+        return false;
+    trailer = rest.left(rest.size() - 2);
+    return true;
+}
+
+static QByteArray gunzip(const QByteArray &data)
+{
+    QByteArray out;
+    z_stream zstream {};
+    if (inflateInit2(&zstream, MAX_WBITS + 16) != Z_OK)
+        return out;
+
+    std::array<char, 16384> buffer {};
+    zstream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zstream.avail_in = static_cast<uInt>(data.size());
+    int ret = Z_OK;
+    while (ret == Z_OK)
+    {
+        zstream.next_out  = reinterpret_cast<Bytef*>(buffer.data());
+        zstream.avail_out = static_cast<uInt>(buffer.size());
+        ret = inflate(&zstream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END)
+        {
+            out.clear();
+            break;
+        }
+        out.append(buffer.data(),
+                   static_cast<int>(buffer.size() - zstream.avail_out));
+    }
+    inflateEnd(&zstream);
+    return out;
+}
+
+void TestHttpResponseStream::initTestCase(void)
+{
+    gCoreContext = new MythCoreContext("test_httpresponsestream_1.0", nullptr);
+}
+
+// Conditional requests need the ETag before the body, so the response is
+// buffered.  Clients that don't read trailers still get it streamed.
+void TestHttpResponseStream::test_canStream(void)
+{
+    TestRequest request;
+    QVERIFY(request.CanStreamResponse());
+    QVERIFY(!request.AcceptsTrailers());
+
+    request.m_mapHeaders.insert("te", "trailers");
+    QVERIFY(request.CanStreamResponse());
+    QVERIFY(request.AcceptsTrailers());
+
+    request.m_mapHeaders.insert("if-none-match", "\"1234\"");
+    QVERIFY(!request.CanStreamResponse());
+
+    request.m_mapHeaders.remove("if-none-match");
+    request.m_nMinor = 0;
+    QVERIFY(!request.CanStreamResponse());
+}
+
+// A response that fits in the buffer is taken back and nothing is sent
+void TestHttpResponseStream::test_buffered(void)
+{
+    TestRequest request;
+    HttpResponseStream stream(&request, false);
+    QByteArray body = make_body(1000);
+
+    QCOMPARE(stream.write(body), qint64(body.size()));
+    QVERIFY(!stream.IsStreaming());
+    QCOMPARE(stream.TakeBuffer(), body);
+    QVERIFY(request.m_written.isEmpty());
+}
+
+void TestHttpResponseStream::test_chunked(void)
+{
+    TestRequest request;
+    request.m_mapHeaders.insert("te", "trailers");
+    HttpResponseStream stream(&request, false);
+    QByteArray body = make_body(200000);
+
+    // In pieces, as a serializer writes
+    for (int pos = 0; pos < body.size(); pos += 1000)
+        QCOMPARE(stream.write(body.mid(pos, 1000)), qint64(1000));
+    QVERIFY(stream.IsStreaming());
+    QVERIFY(stream.TakeBuffer().isEmpty());
+    stream.Finish("ETag: \"abcd\"\r\n");
+    QVERIFY(stream.IsFinished());
+    QVERIFY(!stream.HasFailed());
+    QCOMPARE(stream.GetBytesSent(),
+             qint64(request.m_written.size()) - request.m_written.indexOf("\r\n\r\n") - 4);
+
+    QByteArray header;
+    QByteArray sent;
+    QByteArray trailer;
+    QVERIFY(parse_chunked(request.m_written, header, sent, trailer));
+    QVERIFY(header.contains("Transfer-Encoding: chunked\r\n"));
+    QVERIFY(header.contains("Trailer: ETag\r\n"));
+    QVERIFY(!header.contains("Content-Length"));
+    QVERIFY(!header.contains("Content-Encoding"));
+    QCOMPARE(sent, body);
+    QCOMPARE(trailer, QByteArray("ETag: \"abcd\"\r\n"));
+}
+
+void TestHttpResponseStream::test_gzip(void)
+{
+    TestRequest request;
+    request.m_mapHeaders.insert("te", "trailers");
+    HttpResponseStream stream(&request, true);
+    QByteArray body = make_body(300000);
+
+    for (int pos = 0; pos < body.size(); pos += 4000)
+        QCOMPARE(stream.write(body.mid(pos, 4000)), qint64(4000));
+    stream.Finish("ETag: \"abcd\"\r\n");
+    QVERIFY(!stream.HasFailed());
+
+    QByteArray header;
+    QByteArray sent;
+    QByteArray trailer;
+    QVERIFY(parse_chunked(request.m_written, header, sent, trailer));
+    QVERIFY(header.contains("Transfer-Encoding: chunked\r\n"));
+    QVERIFY(header.contains("Content-Encoding: gzip\r\n"));
+    QVERIFY(sent.size() < body.size());
+    QCOMPARE(gunzip(sent), body);
+    QCOMPARE(trailer, QByteArray("ETag: \"abcd\"\r\n"));
+}
+
+void TestHttpResponseStream::test_serialized_data(void)
+{
+    QTest::addColumn<QString>("te");
+    QTest::addColumn<bool>("trailer");
+
+    QTest::newRow("no TE")    << QString()           << false;
+    QTest::newRow("trailers") << QString("trailers") << true;
+}
+
+// A large response goes through the serializer to the client in chunks,
+// with its ETag after the body only for clients that read trailers
+void TestHttpResponseStream::test_serialized(void)
+{
+    QFETCH(QString, te);
+    QFETCH(bool, trailer);
+
+    TestRequest request;
+    if (!te.isEmpty())
+        request.m_mapHeaders.insert("te", te);
+    QByteArray body = make_body(200000);
+
+    Serializer *pSer = request.GetSerializer();
+    QVERIFY(pSer != nullptr);
+    pSer->Serialize(QVariant(QString::fromLatin1(body)), "Body");
+    request.FormatActionResponse(pSer);
+    delete pSer;
+    QVERIFY(request.SendResponse() > 0);
+
+    QByteArray header;
+    QByteArray sent;
+    QByteArray sTrailer;
+    QVERIFY(parse_chunked(request.m_written, header, sent, sTrailer));
+    QVERIFY(header.startsWith("HTTP/1.1 200"));
+    QVERIFY(header.contains("Transfer-Encoding: chunked\r\n"));
+    QVERIFY(!header.contains("Content-Length"));
+    QVERIFY(!header.contains("\r\nETag:"));
+    QVERIFY(sent.contains(body));
+
+    if (trailer)
+    {
+        QByteArray etag = "\"" +
+            QCryptographicHash::hash(body, QCryptographicHash::Sha1).toHex() +
+            "\"";
+        QVERIFY(header.contains("Trailer: ETag\r\n"));
+        QCOMPARE(sTrailer, "ETag: " + etag + "\r\n");
+    }
+    else
+    {
+        QVERIFY(!header.contains("Trailer"));
+        QVERIFY(sTrailer.isEmpty());
+    }
+}
+
+QTEST_GUILESS_MAIN(TestHttpResponseStream)
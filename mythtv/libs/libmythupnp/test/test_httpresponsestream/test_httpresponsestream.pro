@@ -0,0 +1,23 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += xml sql network testlib
+
+TEMPLATE = app
+TARGET = test_httpresponsestream
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../.. ../../../libmythbase
+LIBS += -L../../../libmythbase -lmythbase-$$LIBVERSION
+LIBS += -L../.. -lmythupnp-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../../../libmythbase
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_httpresponsestream.h
+SOURCES += test_httpresponsestream.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += -lz
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
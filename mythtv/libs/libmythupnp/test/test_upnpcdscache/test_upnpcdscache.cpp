@@ -0,0 +1,121 @@
+/*
+ *  Class TestUPnpCDSCache
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include "test_upnpcdscache.h"
+
+// A result of count items, each of 100 characters (200 bytes)
+static UPnpCDSCacheEntry make_entry(int count, uint16_t updateID = 1)
+{
+    UPnpCDSCacheEntry entry;
+    for (int i = 0; i < count; ++i)
+        entry.m_items.append(QString(100, QChar('a' + (i % 26))));
+    entry.m_nTotalMatches = count;
+    entry.m_nUpdateID     = updateID;
+    return entry;
+}
+
+void TestUPnpCDSCache::test_getPut(void)
+{
+    UPnpCDSCache cache(100000);
+    UPnpCDSCacheEntry entry;
+
+    QVERIFY(!cache.Get("a", 0, entry));
+    QVERIFY(cache.Put("a", 0, make_entry(10, 7)));
+    QVERIFY(cache.Get("a", 0, entry));
+    QCOMPARE(entry.m_items.size(), 10);
+    QCOMPARE(entry.m_nTotalMatches, uint16_t(10));
+    QCOMPARE(entry.m_nUpdateID, uint16_t(7));
+
+    // Replaced, not added twice
+    QVERIFY(cache.Put("a", 0, make_entry(5)));
+    QVERIFY(cache.Get("a", 0, entry));
+    QCOMPARE(entry.m_items.size(), 5);
+
+    cache.Clear();
+    QVERIFY(!cache.Get("a", 0, entry));
+}
+
+// Results larger than half the budget are refused, and remembered as too
+// large until the content changes
+void TestUPnpCDSCache::test_sizeLimit(void)
+{
+    UPnpCDSCache cache(10000);
+    UPnpCDSCacheEntry entry;
+
+    QVERIFY(cache.IsCacheable("big", 1));
+    QVERIFY(!cache.Put("big", 1, make_entry(30)));
+    QVERIFY(!cache.Get("big", 1, entry));
+    QVERIFY(!cache.IsCacheable("big", 1));
+    QVERIFY(cache.IsCacheable("other", 1));
+
+    QVERIFY(cache.IsCacheable("big", 2));
+    QVERIFY(cache.Put("big", 2, make_entry(20)));
+    QVERIFY(cache.IsCacheable("big", 2));
+    QVERIFY(cache.Get("big", 2, entry));
+
+    cache.Put("huge", 3, make_entry(100));
+    QVERIFY(!cache.IsCacheable("huge", 3));
+    cache.Clear();
+    QVERIFY(cache.IsCacheable("huge", 3));
+}
+
+// The least recently used results make room for new ones
+void TestUPnpCDSCache::test_lruEviction(void)
+{
+    // Room for three results of 10 items
+    UPnpCDSCache cache(7000);
+    UPnpCDSCacheEntry entry;
+
+    QVERIFY(cache.Put("1", 0, make_entry(10)));
+    QVERIFY(cache.Put("2", 0, make_entry(10)));
+    QVERIFY(cache.Put("3", 0, make_entry(10)));
+    QVERIFY(cache.Get("1", 0, entry));
+
+    QVERIFY(cache.Put("4", 0, make_entry(10)));
+    QVERIFY(!cache.Get("2", 0, entry));
+    QVERIFY(cache.Get("1", 0, entry));
+    QVERIFY(cache.Get("3", 0, entry));
+    QVERIFY(cache.Get("4", 0, entry));
+
+    // Makes room for itself by evicting two
+    QVERIFY(cache.Put("5", 0, make_entry(15)));
+    QVERIFY(!cache.Get("1", 0, entry));
+    QVERIFY(!cache.Get("3", 0, entry));
+    QVERIFY(cache.Get("4", 0, entry));
+    QVERIFY(cache.Get("5", 0, entry));
+}
+
+// A result made before the content changed is dropped
+void TestUPnpCDSCache::test_invalidation(void)
+{
+    UPnpCDSCache cache(100000);
+    UPnpCDSCacheEntry entry;
+
+    QVERIFY(cache.Put("a", 4, make_entry(10)));
+    QVERIFY(cache.Put("b", 4, make_entry(10)));
+    QVERIFY(!cache.Get("a", 5, entry));
+
+    // Dropped, not just hidden from the newer version
+    QVERIFY(!cache.Get("a", 4, entry));
+    QVERIFY(cache.Get("b", 4, entry));
+
+    QVERIFY(cache.Put("a", 5, make_entry(3)));
+    QVERIFY(cache.Get("a", 5, entry));
+    QCOMPARE(entry.m_items.size(), 3);
+}
+
+QTEST_APPLESS_MAIN(TestUPnpCDSCache)
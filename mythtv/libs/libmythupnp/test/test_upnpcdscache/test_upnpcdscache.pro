@@ -0,0 +1,22 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += xml sql network testlib
+
+TEMPLATE = app
+TARGET = test_upnpcdscache
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../.. ../../../libmythbase
+LIBS += -L../../../libmythbase -lmythbase-$$LIBVERSION
+LIBS += -L../.. -lmythupnp-$$LIBVERSION
+LIBS += -Wl,$$_RPATH_$${PWD}/../../../libmythbase
+LIBS += -Wl,$$_RPATH_$${PWD}/../..
+
+# Input
+HEADERS += test_upnpcdscache.h
+SOURCES += test_upnpcdscache.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
@@ -17,6 +17,8 @@
 #include "upnp.h"
 #include "upnpcds.h"
 #include "upnputil.h"
+#include "mythcorecontext.h"
+#include "mythevent.h"
 #include "mythlogging.h"
 #include "mythversion.h"
 
@@ -113,6 +115,9 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
     m_features.AddAttribute(NameValue( "xsi:schemaLocation",
                                        "urn:schemas-upnp-org:av:avs "
                                        "http://www.upnp.org/schemas/av/avs.xsd" ));
+
+    // Changes to recordings, videos and music invalidate cached results
+    gCoreContext->addListener(this);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -121,6 +126,8 @@ UPnpCDS::UPnpCDS( UPnpDevice *pDevice, const QString &sSharePath )
 
 UPnpCDS::~UPnpCDS()
 {
+    gCoreContext->removeListener(this);
+
     while (!m_extensions.isEmpty())
     {
         delete m_extensions.takeLast();
@@ -187,6 +194,7 @@ void UPnpCDS::UnregisterExtension( UPnpCDSExtension *pExtension )
     {
         m_extensions.removeAll(pExtension);
         delete pExtension;
+        m_cache.Clear();
     }
 }
 
@@ -468,12 +476,56 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
     }
     else
     {
+        // ------------------------------------------------------------------
+        // Pages of a container are sliced from its cached listing, which
+        // is kept until the extension's content changes
+        // ------------------------------------------------------------------
+
+        UPnpCDSExtension *pCacheExt  = FindExtension(request.m_sObjectId);
+        bool              bChildren  =
+            (request.m_eBrowseFlag == CDS_BrowseDirectChildren);
+        bool              bSlice     = false;
+        bool              bFound     = false;
+        uint              nVersion   = 0;
+        uint16_t          nStart     = request.m_nStartingIndex;
+        uint16_t          nCount     = request.m_nRequestedCount;
+        QString           sCacheKey;
+        UPnpCDSCacheEntry entry;
+
+        if (pCacheExt != nullptr)
+        {
+            sCacheKey = QString("%1|%2|%3|%4").arg(request.m_eBrowseFlag)
+                            .arg(request.m_sObjectId, request.m_sFilter,
+                                 request.m_sSortCriteria);
+            nVersion  = pCacheExt->m_nContentVersion;
+            bFound    = m_cache.Get(sCacheKey, nVersion, entry);
+            bSlice    = bChildren;
+
+            if (bFound)
+            {
+                LOG(VB_UPNP, LOG_DEBUG,
+                    QString("UPnpCDS::HandleBrowse cached %1 (%2 items)")
+                        .arg(request.m_sObjectId).arg(entry.m_items.size()));
+            }
+            else if (bChildren && m_cache.IsCacheable(sCacheKey, nVersion))
+            {
+                // Load the whole container once
+                request.m_nStartingIndex  = 0;
+                request.m_nRequestedCount = UINT16_MAX;
+            }
+            else
+            {
+                // Too large to cache, the extension pages it as before
+                bSlice = false;
+            }
+        }
+
         // ------------------------------------------------------------------
         // Look for a CDS Extension that knows how to handle this ObjectID
         // ------------------------------------------------------------------
 
         UPnpCDSExtensionList::iterator it = m_extensions.begin();
-        for (; (it != m_extensions.end()) && !pResult; ++it)
+        for (; !bFound && (it != m_extensions.end()) && !pResult; ++it)
         {
             LOG(VB_UPNP, LOG_INFO,
                 QString("UPNP Browse : Searching for : %1  / ObjectID : %2")
@@ -489,23 +541,44 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
 
             if (eErrorCode == UPnPResult_Success)
             {
-                while (pResult->m_List.size() > request.m_nRequestedCount)
-                {
-                    pResult->m_List.takeLast()->DecrRef();
-                }
+                entry.m_nTotalMatches = pResult->m_nTotalMatches;
+                entry.m_nUpdateID     = pResult->m_nUpdateID;
+                entry.m_items.reserve(pResult->m_List.size());
 
-                nNumberReturned = pResult->m_List.count();
-                nTotalMatches   = pResult->m_nTotalMatches;
-                nUpdateID       = pResult->m_nUpdateID;
-                if (request.m_eBrowseFlag == CDS_BrowseMetadata)
-                    sResultXML      = pResult->GetResultXML(filter, true); // Ignore children
-                else
-                    sResultXML      = pResult->GetResultXML(filter);
+                // Metadata ignores children
+                for (auto *item : qAsConst(pResult->m_List))
+                    entry.m_items.append(item->toXml(filter, !bChildren));
+
+                // Only a whole container is cached, not a page of one that
+                // was too large.  If this one is, it is still sliced below.
+                if (pCacheExt != nullptr && (bSlice || !bChildren))
+                    m_cache.Put(sCacheKey, nVersion, entry);
+
+                bFound = true;
             }
 
             delete pResult;
             pResult = nullptr;
         }
+
+        if (bFound)
+        {
+            if (!bSlice)
+                nStart = 0; // The extension has already skipped to the start
+
+            int nFirst = std::min(static_cast<int>(nStart),
+                                  entry.m_items.size());
+            int nLast  = std::min(nFirst + static_cast<int>(nCount),
+                                  entry.m_items.size());
+
+            for (int i = nFirst; i < nLast; ++i)
+                sResultXML += entry.m_items.at(i);
+
+            eErrorCode      = UPnPResult_Success;
+            nNumberReturned = nLast - nFirst;
+            nTotalMatches   = entry.m_nTotalMatches;
+            nUpdateID       = entry.m_nUpdateID;
+        }
     }
 
     // ----------------------------------------------------------------------
@@ -536,6 +609,49 @@ void UPnpCDS::HandleBrowse( HTTPRequest *pRequest )
 //
 /////////////////////////////////////////////////////////////////////////////
 
+UPnpCDSExtension *UPnpCDS::FindExtension( const QString &sObjectId )
+{
+    for (auto *pExtension : qAsConst(m_extensions))
+    {
+        if (sObjectId.startsWith(pExtension->m_sExtensionId))
+            return pExtension;
+    }
+
+    return nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void UPnpCDS::customEvent( QEvent *event )
+{
+    if (event->type() != MythEvent::MythEventMessage)
+        return;
+
+    auto *me = dynamic_cast<MythEvent *>(event);
+    if (me == nullptr)
+        return;
+
+    QString sMessage = me->Message().section(' ', 0, 0);
+
+    for (auto *pExtension : qAsConst(m_extensions))
+    {
+        if (pExtension->m_changeEvents.contains(sMessage))
+        {
+            uint nVersion = ++pExtension->m_nContentVersion;
+            LOG(VB_UPNP, LOG_DEBUG,
+                QString("UPnpCDS: %1 changed (%2), content version %3")
+                    .arg(pExtension->m_sExtensionId, sMessage)
+                    .arg(nVersion));
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 void UPnpCDS::HandleSearch( HTTPRequest *pRequest )
 {
     UPnpCDSExtensionResults *pResult  = nullptr;
@@ -14,6 +14,7 @@
 #define UPnpCDS_H_
 
 // C++ headers
+#include <atomic>
 #include <utility>
 
 // QT headers
@@ -23,6 +24,7 @@
 #include <QString>
 
 #include "upnp.h"
+#include "upnpcdscache.h"
 #include "upnpcdsobjects.h"
 #include "eventing.h"
 #include "mythdbcon.h"
@@ -209,6 +211,11 @@ class UPNP_PUBLIC UPnpCDSExtension
 
         CDSShortCutList m_shortcuts;
 
+        // MythEvent messages that mean our content has changed, and the
+        // version that is bumped when one is seen (see UPnpCDSCache)
+        QStringList       m_changeEvents;
+        std::atomic<uint> m_nContentVersion {0};
+
     protected:
 
         static QString RemoveToken ( const QString &sToken, const QString &sStr, int num );
@@ -293,6 +300,8 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         UPnPFeatureList        m_features;
         UPnPShortcutFeature   *m_pShortCuts {nullptr};
 
+        UPnpCDSCache           m_cache      {32LL * 1024 * 1024};
+
     private:
 
         static UPnpCDSMethod       GetMethod              ( const QString &sURI  );
@@ -306,6 +315,7 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         void            HandleGetFeatureList       ( HTTPRequest *pRequest );
         void            HandleGetServiceResetToken ( HTTPRequest *pRequest );
         static void     DetermineClient            ( HTTPRequest *pRequest, UPnpCDSRequest *pCDSRequest );
+        UPnpCDSExtension *FindExtension            ( const QString &sObjectId );
 
     protected:
 
@@ -320,6 +330,8 @@ class UPNP_PUBLIC UPnpCDS : public Eventing
         QString GetServiceDescURL() override // UPnpServiceImpl
             { return m_sControlUrl.mid( 1 ) + "/GetServDesc"; }
 
+        void customEvent( QEvent *event ) override; // QObject
+
     public:
         UPnpCDS( UPnpDevice *pDevice,
                  const QString &sSharePath ); 
@@ -0,0 +1,141 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: upnpcdscache.cpp
+//
+// Purpose     : Serialized ContentDirectory Browse results, so that paging
+//               through a container doesn't query the database each time
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Own header
+#include "upnpcdscache.h"
+
+// MythTV headers
+#include "mythlogging.h"
+
+#define LOC QString("UPnpCDSCache: ")
+
+/// Entries older than this are refreshed even without a change event
+static constexpr std::chrono::milliseconds kMaxAge { 10min };
+
+/// The most results remembered as too large to cache
+static constexpr int kMaxTooLarge { 256 };
+
+static std::chrono::milliseconds steady_now(void)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+}
+
+/**
+ *  \brief Look up a Browse result made with the current content version.
+ *  \return false if there is none, or it is out of date
+ */
+bool UPnpCDSCache::Get(const QString &key, uint version,
+                       UPnpCDSCacheEntry &entry)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end())
+        return false;
+
+    if (it->m_version != version || steady_now() - it->m_created > kMaxAge)
+    {
+        Remove(it);
+        return false;
+    }
+
+    m_lruList.splice(m_lruList.begin(), m_lruList, it->m_lru);
+    entry = it->m_entry;
+    return true;
+}
+
+/**
+ *  \brief Keep a Browse result made with the given content version.
+ *  \return false if it is too large to cache.  IsCacheable() is then false
+ *          until the content version changes.
+ */
+bool UPnpCDSCache::Put(const QString &key, uint version,
+                       const UPnpCDSCacheEntry &entry)
+{
+    qint64 size = key.size();
+    for (const auto &item : qAsConst(entry.m_items))
+        size += item.size();
+    size *= static_cast<qint64>(sizeof(QChar));
+
+    QMutexLocker locker(&m_lock);
+
+    // A single container larger than the budget would evict everything else
+    if (size > m_maxBytes / 2)
+    {
+        LOG(VB_UPNP, LOG_DEBUG, LOC +
+            QString("Not caching '%1', %2 bytes").arg(key).arg(size));
+
+        if (m_tooLarge.size() >= kMaxTooLarge)
+            m_tooLarge.clear();
+        m_tooLarge.insert(key, version);
+        return false;
+    }
+
+    m_tooLarge.remove(key);
+
+    auto it = m_nodes.find(key);
+    if (it != m_nodes.end())
+        Remove(it);
+
+    while (m_size + size > m_maxBytes && !m_lruList.empty())
+        Remove(m_nodes.find(m_lruList.back()));
+
+    m_lruList.push_front(key);
+
+    Node node;
+    node.m_entry   = entry;
+    node.m_version = version;
+    node.m_size    = size;
+    node.m_created = steady_now();
+    node.m_lru     = m_lruList.begin();
+    m_nodes.insert(key, node);
+    m_size += size;
+    return true;
+}
+
+/**
+ *  \brief Whether a result for key is worth loading in full to cache it.
+ *  \return false if it was too large with the same content version
+ */
+bool UPnpCDSCache::IsCacheable(const QString &key, uint version)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_tooLarge.find(key);
+    if (it == m_tooLarge.end())
+        return true;
+
+    if (*it == version)
+        return false;
+
+    m_tooLarge.erase(it);
+    return true;
+}
+
+void UPnpCDSCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_nodes.clear();
+    m_lruList.clear();
+    m_tooLarge.clear();
+    m_size = 0;
+}
+
+/// \brief Must be called with m_lock held.
+void UPnpCDSCache::Remove(NodeHash::iterator it)
+{
+    if (it == m_nodes.end())
+        return;
+
+    m_size -= it->m_size;
+    m_lruList.erase(it->m_lru);
+    m_nodes.erase(it);
+}
@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: upnpcdscache.h
+//
+// Purpose     : Serialized ContentDirectory Browse results, so that paging
+//               through a container doesn't query the database each time
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef UPNPCDSCACHE_H
+#define UPNPCDSCACHE_H
+
+// C++ headers
+#include <cstdint>
+#include <list>
+
+// Qt headers
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// MythTV headers
+#include "mythchrono.h"
+#include "upnpexp.h"
+
+/// \brief The result of one Browse, every child already serialized
+struct UPnpCDSCacheEntry
+{
+    QStringList m_items;                ///< DIDL-Lite fragment of each object
+    uint16_t    m_nTotalMatches {0};
+    uint16_t    m_nUpdateID     {0};
+};
+
+/** \class UPnpCDSCache
+ *  \brief Browse results keyed by object id, browse flag, filter and sort
+ *         criteria.
+ *
+ *   Each entry records the content version of the extension that produced
+ *   it.  When the content changes the extension's version is bumped, and
+ *   the entries made with an older version are ignored and replaced.
+ *   Entries are also dropped after a few minutes, for the changes no event
+ *   is sent for, and the least recently used are evicted when the cache
+ *   grows larger than its budget.
+ *
+ *   A result too large to cache is remembered, so that later requests for
+ *   it are paged by the extension instead of loading the whole container
+ *   each time.
+ */
+class UPNP_PUBLIC UPnpCDSCache
+{
+  public:
+    explicit UPnpCDSCache(qint64 maxBytes) : m_maxBytes(maxBytes) {}
+
+    bool Get(const QString &key, uint version, UPnpCDSCacheEntry &entry);
+    bool Put(const QString &key, uint version, const UPnpCDSCacheEntry &entry);
+    bool IsCacheable(const QString &key, uint version);
+    void Clear(void);
+
+  private:
+    Q_DISABLE_COPY(UPnpCDSCache)
+
+    struct Node
+    {
+        UPnpCDSCacheEntry            m_entry;
+        uint                         m_version {0};
+        qint64                       m_size    {0};
+        std::chrono::milliseconds    m_created {0ms};
+        std::list<QString>::iterator m_lru;     ///< position in m_lruList
+    };
+    using NodeHash = QHash<QString, Node>;
+
+    void Remove(NodeHash::iterator it);
+
+    QMutex             m_lock;
+    NodeHash           m_nodes;
+    std::list<QString> m_lruList;               ///< most recently used first
+    QHash<QString, uint> m_tooLarge;            ///< key, content version
+    qint64             m_size     {0};
+    qint64             m_maxBytes {0};
+};
+
+#endif // UPNPCDSCACHE_H
@@ -51,6 +51,13 @@ extern AutoExpire *expirer;
  */
 #define SPACE_TOO_BIG_KB (3*1024*1024)
 
+/// Reload all expiry candidates this often, to pick up changes made to
+/// the recorded table without a recording list change event.
+static constexpr int64_t kCandidateReloadSecs { 60LL * 60 };
+
+/// Write rates are measured over at least this many seconds
+static constexpr int64_t kMinRateSampleSecs { 60 };
+
 /// \brief This calls AutoExpire::RunExpirer() from within a new thread.
 void ExpireThread::run(void)
 {
@@ -199,18 +206,17 @@ void AutoExpire::CalcParams()
                                 "from used list.").arg(cardid));
                     m_instanceLock.lock();
                     m_usedEncoders.remove(cardid);
+                    m_writeSamples.remove(cardid);
                     m_instanceLock.unlock();
                     continue;
                 }
 
-                uint64_t maxBitrate = enc->GetMaxBitrate();
-                if (maxBitrate==0)
-                    maxBitrate = 19500000LL;
-                thisKBperMin += (maxBitrate*((uint64_t)15))>>11;
-                LOG(VB_FILE, LOG_INFO, QString("    Cardid %1: max bitrate "
-                        "%2 Kb/sec, fsID %3 max is now %4 KB/min")
+                uint64_t kbPerMin = KBPerMin(cardid, enc);
+                thisKBperMin += kbPerMin;
+                LOG(VB_FILE, LOG_INFO, QString("    Cardid %1: writing "
+                        "%2 KB/min, fsID %3 max is now %4 KB/min")
                         .arg(enc->GetInputID())
-                        .arg(enc->GetMaxBitrate() >> 10)
+                        .arg(kbPerMin)
                         .arg(fsit->getFSysID())
                         .arg(thisKBperMin));
             }
@@ -255,13 +261,59 @@ void AutoExpire::CalcParams()
     m_instanceLock.unlock();
 }
 
+/**
+ *  \brief Estimates how fast a recorder fills its file system.
+ *
+ *  For local recorders this is the rate at which the recording actually
+ *  grew over the last minute or more, which is usually well below the
+ *  maximum bitrate of the recorder.  Remote recorders and recordings that
+ *  have only just started are assumed to write at the maximum bitrate.
+ *
+ *  \return KB per minute
+ */
+uint64_t AutoExpire::KBPerMin(int cardid, EncoderLink *enc)
+{
+    uint64_t maxBitrate = enc->GetMaxBitrate();
+    if (maxBitrate==0)
+        maxBitrate = 19500000LL;
+    uint64_t maxKBperMin = (maxBitrate*((uint64_t)15))>>11;
+
+    if (!enc->IsLocal())
+        return maxKBperMin;
+
+    WriteSample sample;
+    sample.m_position = enc->GetFilePosition();
+    sample.m_time = MythDate::current();
+    sample.m_kbPerMin = maxKBperMin;
+
+    QMutexLocker locker(&m_instanceLock);
+    auto last = m_writeSamples.constFind(cardid);
+    if (last == m_writeSamples.constEnd() || last->m_position < 0 ||
+        sample.m_position < last->m_position)
+    {
+        // A new recording, nothing to measure yet
+        m_writeSamples[cardid] = sample;
+        return maxKBperMin;
+    }
+
+    int64_t secs = last->m_time.secsTo(sample.m_time);
+    if (secs < kMinRateSampleSecs)
+        return last->m_kbPerMin;
+
+    uint64_t written = sample.m_position - last->m_position;
+    sample.m_kbPerMin = std::min(maxKBperMin, ((written >> 10) * 60) / secs);
+    m_writeSamples[cardid] = sample;
+    return sample.m_kbPerMin;
+}
+
 /** \brief This contains the main loop for the auto expire process.
  *
  *   Responsible for cleanup of old LiveTV programs as well as deleting as
  *   many recordings that are expirable as necessary to
  *   maintain enough free space on all directories in MythTV Storage Groups.
  *   The thread deletes short LiveTV programs every 2 minutes and long
- *   LiveTV and regular programs as needed every "desired_freq" minutes.
+ *   LiveTV and regular programs as needed every "desired_freq" minutes,
+ *   and as soon as a recorder starts a new recording.
  */
 void AutoExpire::RunExpirer(void)
 {
@@ -281,6 +333,14 @@ void AutoExpire::RunExpirer(void)
         TVRec::s_inputsLock.lockForRead();
 
         curTime = MythDate::current();
+
+        // Make room right away when a recording starts
+        if (m_expireNow.exchange(false))
+        {
+            LOG(VB_FILE, LOG_INFO, LOC + "A recording started, running now");
+            next_expire = curTime;
+        }
+
         // recalculate auto expire parameters
         if (curTime >= next_expire)
         {
@@ -346,7 +406,7 @@ void AutoExpire::Sleep(std::chrono::milliseconds sleepTime)
 
     QDateTime little_tm = MythDate::current().addMSecs(sleepTime.count());
     std::chrono::milliseconds timeleft = sleepTime;
-    while (m_expireThreadRun && (timeleft > 0ms))
+    while (m_expireThreadRun && !m_expireNow && (timeleft > 0ms))
     {
         m_instanceCond.wait(&m_instanceLock, timeleft.count());
         timeleft = MythDate::secsInFuture(little_tm);
@@ -395,10 +455,12 @@ void AutoExpire::ExpireQuickDeleted(void)
 /** \fn AutoExpire::ExpireRecordings()
  *  \brief This expires normal recordings.
  *
+ *  Candidates are taken from the heap in expiration order, and only until
+ *  enough space is free, so usually only a few of them are loaded.
  */
 void AutoExpire::ExpireRecordings(void)
 {
-    pginfolist_t expireList;
+    pginfolist_t expireList;            // candidates loaded so far
     pginfolist_t deleteList;
     QList<FileSystemInfo> fsInfos;
     QList<FileSystemInfo>::iterator fsit;
@@ -416,7 +478,9 @@ void AutoExpire::ExpireRecordings(void)
         return;
     }
 
-    FillExpireList(expireList);
+    SyncCandidates();
+    ExpireHeap heap(m_candidates,
+                    gCoreContext->GetNumSetting("AutoExpireMethod", 1));
 
     QMap <int, bool> truncateMap;
     MSqlQuery query(MSqlQuery::InitCon());
@@ -525,13 +589,18 @@ void AutoExpire::ExpireRecordings(void)
             LOG(VB_FILE, LOG_INFO,
                 "    Searching for files expirable in these directories");
             QString myHostName = gCoreContext->GetHostName();
-            auto it = expireList.begin();
-            while ((it != expireList.end()) &&
-                   (std::max((int64_t)0LL, fsit->getFreeSpace()) <
-                    m_desiredSpace[fsit->getFSysID()]))
+            size_t next = 0;
+            while (std::max((int64_t)0LL, fsit->getFreeSpace()) <
+                   m_desiredSpace[fsit->getFSysID()])
             {
-                ProgramInfo *p = *it;
-                ++it;
+                if (next == expireList.size())
+                {
+                    ProgramInfo *pginfo = NextExpirable(heap, expireList);
+                    if (!pginfo)
+                        break;
+                    expireList.push_back(pginfo);
+                }
+                ProgramInfo *p = expireList[next++];
 
                 LOG(VB_FILE, LOG_INFO, QString("        Checking %1 => %2")
                         .arg(p->toString(ProgramInfo::kRecordingKey))
@@ -769,17 +838,65 @@ void AutoExpire::FillExpireList(pginfolist_t &expireList)
 
     ClearExpireList(expireList);
 
-    FillDBOrdered(expireList, emNormalDeletedPrograms);
+    FillFromHeap(expireList, expMethod);
+}
 
-    switch(expMethod)
+/** \brief Appends all expiry candidates to expireList, deleted programs
+ *         first and then in the order of the given AutoExpireMethod.
+ */
+void AutoExpire::FillFromHeap(pginfolist_t &expireList, int expMethod)
+{
+    SyncCandidates();
+
+    ExpireHeap heap(m_candidates, expMethod);
+    while (ProgramInfo *pginfo = NextExpirable(heap, expireList))
+        expireList.push_back(pginfo);
+}
+
+/** \brief Loads the next candidate from the heap that may be expired now.
+ *  \return the program, or nullptr if there are no more candidates
+ */
+ProgramInfo *AutoExpire::NextExpirable(ExpireHeap &heap,
+                                       const pginfolist_t &expireList) const
+{
+    while (!heap.empty())
     {
-        case emOldestFirst:
-        case emLowestPriorityFirst:
-        case emWeightedTimePriority:
-                FillDBOrdered(expireList, expMethod);
-                break;
-        // default falls through so list is empty so no AutoExpire
+        ExpireCandidate candidate = heap.pop();
+        QString recording = QString("%1 at %2").arg(candidate.m_chanId)
+            .arg(candidate.m_recStartTs.toString(Qt::ISODate));
+
+        if (IsInDontExpireSet(candidate.m_chanId, candidate.m_recStartTs))
+        {
+            LOG(VB_FILE, LOG_INFO, LOC +
+                QString("    Skipping %1 because it is in Don't Expire List")
+                    .arg(recording));
+            continue;
+        }
+
+        if (IsInExpireList(expireList, candidate.m_chanId,
+                           candidate.m_recStartTs))
+        {
+            LOG(VB_FILE, LOG_INFO, LOC +
+                QString("    Skipping %1 because it is already in Expire List")
+                    .arg(recording));
+            continue;
+        }
+
+        auto *pginfo = new ProgramInfo(candidate.m_recordedId);
+        if (!pginfo->GetChanID() || pginfo->IsDeletePending())
+        {
+            LOG(VB_FILE, LOG_INFO, LOC +
+                QString("    Skipping %1 because it is no longer in the DB "
+                        "or is being deleted")
+                    .arg(recording));
+            delete pginfo;
+            continue;
+        }
+
+        LOG(VB_FILE, LOG_INFO, LOC + QString("    Adding   %1").arg(recording));
+        return pginfo;
     }
+    return nullptr;
 }
 
 /** \fn AutoExpire::PrintExpireList(QString)
@@ -833,9 +950,8 @@ void AutoExpire::GetAllExpiring(QStringList &strList)
 
     FillDBOrdered(expireList, emShortLiveTVPrograms);
     FillDBOrdered(expireList, emNormalLiveTVPrograms);
-    FillDBOrdered(expireList, emNormalDeletedPrograms);
-    FillDBOrdered(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
-                  emOldestFirst));
+    FillFromHeap(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
+                 emOldestFirst));
 
     strList << QString::number(expireList.size());
 
@@ -857,9 +973,8 @@ void AutoExpire::GetAllExpiring(pginfolist_t &list)
 
     FillDBOrdered(expireList, emShortLiveTVPrograms);
     FillDBOrdered(expireList, emNormalLiveTVPrograms);
-    FillDBOrdered(expireList, emNormalDeletedPrograms);
-    FillDBOrdered(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
-                  emOldestFirst));
+    FillFromHeap(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
+                 emOldestFirst));
 
     for (auto & info : expireList)
         list.push_back( new ProgramInfo( *info ));
@@ -1052,7 +1167,6 @@ void AutoExpire::Update(int encoder, int fsID, bool immediately)
             expirer->m_instanceLock.unlock();
         }
         expirer->CalcParams();
-        expirer->m_instanceCond.wakeAll();
     }
     else
     {
@@ -1060,6 +1174,10 @@ void AutoExpire::Update(int encoder, int fsID, bool immediately)
         expirer->m_updateQueue.append(UpdateEntry(encoder, fsID));
         expirer->m_updateLock.unlock();
     }
+
+    if (encoder > 0)
+        expirer->m_expireNow = true;
+    expirer->m_instanceCond.wakeAll();
 }
 
 void AutoExpire::UpdateDontExpireSet(void)
@@ -1116,4 +1234,201 @@ bool AutoExpire::IsInExpireList(
                                      (info->GetRecordingStartTime() == recstartts)); } );
 }
 
+/**
+ *  \brief Queues expiry candidate changes for the expirer thread.
+ *
+ *  Only the ids are noted here, SyncCandidates() reads the changed
+ *  recordings from the database when the candidates are next needed.
+ */
+void AutoExpire::customEvent(QEvent *event)
+{
+    if (event->type() != MythEvent::MythEventMessage)
+        return;
+
+    auto *me = dynamic_cast<MythEvent *>(event);
+    if (me == nullptr)
+        return;
+
+    QStringList tokens = me->Message().simplified().split(" ");
+    if (tokens.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_updateLock);
+    if (tokens[0] == "RECORDING_LIST_CHANGE")
+    {
+        if (tokens.size() == 1)
+            m_candidatesValid = false;
+        else if (tokens.size() >= 3 && tokens[1] == "ADD")
+            m_candidateUpdates[tokens[2].toUInt()] = true;
+        else if (tokens.size() >= 3 && tokens[1] == "DELETE")
+            m_candidateUpdates[tokens[2].toUInt()] = false;
+    }
+    else if (tokens[0] == "MASTER_UPDATE_REC_INFO" && tokens.size() >= 2)
+    {
+        m_candidateUpdates[tokens[1].toUInt()] = true;
+    }
+}
+
+static const QString kCandidateQuery =
+    "SELECT recordedid, chanid, starttime, lastmodified, autoexpire, "
+    "       recpriority, watched, recgroup "
+    "FROM recorded "
+    "WHERE deletepending = 0 AND (recgroup = 'Deleted' OR autoexpire > 0) ";
+
+static ExpireCandidate CandidateFromQuery(const MSqlQuery &query)
+{
+    ExpireCandidate candidate;
+    candidate.m_recordedId   = query.value(0).toUInt();
+    candidate.m_chanId       = query.value(1).toUInt();
+    candidate.m_recStartTs   = MythDate::as_utc(query.value(2).toDateTime());
+    candidate.m_lastModified = MythDate::as_utc(query.value(3).toDateTime());
+    candidate.m_autoExpire   = query.value(4).toInt();
+    candidate.m_recPriority  = query.value(5).toInt();
+    candidate.m_watched      = query.value(6).toBool();
+    candidate.m_deleted      = query.value(7).toString() == "Deleted";
+    return candidate;
+}
+
+/**
+ *  \brief Brings the expiry candidates up to date, applying the changes
+ *         queued by customEvent(). Must be called with m_instanceLock held.
+ */
+void AutoExpire::SyncCandidates(void)
+{
+    m_updateLock.lock();
+    bool valid = m_candidatesValid;
+    m_candidatesValid = true;
+    QMap<uint, bool> updates;
+    updates.swap(m_candidateUpdates);
+    m_updateLock.unlock();
+
+    if (!valid || !m_candidatesLoaded.isValid() ||
+        m_candidatesLoaded.secsTo(MythDate::current()) > kCandidateReloadSecs)
+    {
+        LoadCandidates();
+        return;
+    }
+
+    for (auto it = updates.cbegin(); it != updates.cend(); ++it)
+    {
+        if (it.value())
+            UpdateCandidate(it.key());
+        else
+            m_candidates.remove(it.key());
+    }
+}
+
+/// \brief Reads all expiry candidates from the database.
+void AutoExpire::LoadCandidates(void)
+{
+    m_candidates.clear();
+    m_candidatesLoaded = MythDate::current();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(kCandidateQuery);
+    if (!query.exec())
+    {
+        MythDB::DBError(LOC + "LoadCandidates", query);
+        m_candidatesLoaded = QDateTime();
+        return;
+    }
+
+    while (query.next())
+    {
+        ExpireCandidate candidate = CandidateFromQuery(query);
+        m_candidates.insert(candidate.m_recordedId, candidate);
+    }
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Loaded %1 expiry candidates").arg(m_candidates.size()));
+}
+
+/// \brief Re-reads one recording, which may no longer be a candidate.
+void AutoExpire::UpdateCandidate(uint recordedid)
+{
+    m_candidates.remove(recordedid);
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(kCandidateQuery + "AND recordedid = :RECORDEDID");
+    query.bindValue(":RECORDEDID", recordedid);
+    if (!query.exec())
+    {
+        MythDB::DBError(LOC + "UpdateCandidate", query);
+        return;
+    }
+
+    if (query.next())
+        m_candidates.insert(recordedid, CandidateFromQuery(query));
+}
+
+/**
+ *  \brief Builds the heap from the current candidates.
+ *
+ *  Deleted programs are always expired first.  Other programs are only
+ *  included for the expire methods that the user can choose, in the
+ *  order FillDBOrdered() would return them for that method.
+ */
+ExpireHeap::ExpireHeap(const QHash<uint, ExpireCandidate> &candidates,
+                       int expMethod)
+  : m_expMethod(expMethod),
+    m_watchedPriority(gCoreContext->GetBoolSetting("AutoExpireWatchedPriority",
+                                                   false)),
+    m_dayPriority(gCoreContext->GetNumSetting("AutoExpireDayPriority", 3))
+{
+    bool expireRecordings = (expMethod == emOldestFirst ||
+                             expMethod == emLowestPriorityFirst ||
+                             expMethod == emWeightedTimePriority);
+
+    m_heap.reserve(candidates.size());
+    for (const auto &candidate : candidates)
+    {
+        if (candidate.m_deleted || expireRecordings)
+            m_heap.push_back(candidate);
+    }
+
+    // std::make_heap puts the largest element first, so invert the order
+    std::make_heap(m_heap.begin(), m_heap.end(),
+                   [this](const ExpireCandidate &a, const ExpireCandidate &b)
+                   { return ExpiresBefore(b, a); });
+}
+
+/// \brief Removes and returns the candidate to expire next.
+ExpireCandidate ExpireHeap::pop(void)
+{
+    std::pop_heap(m_heap.begin(), m_heap.end(),
+                  [this](const ExpireCandidate &a, const ExpireCandidate &b)
+                  { return ExpiresBefore(b, a); });
+    ExpireCandidate candidate = m_heap.back();
+    m_heap.pop_back();
+    return candidate;
+}
+
+bool ExpireHeap::ExpiresBefore(const ExpireCandidate &a,
+                               const ExpireCandidate &b) const
+{
+    if (a.m_deleted != b.m_deleted)
+        return a.m_deleted;
+    if (a.m_autoExpire != b.m_autoExpire)
+        return a.m_autoExpire > b.m_autoExpire;
+    if (a.m_deleted)
+        return a.m_lastModified < b.m_lastModified;
+
+    if (m_watchedPriority && a.m_watched != b.m_watched)
+        return a.m_watched;
+
+    switch (m_expMethod)
+    {
+        case emLowestPriorityFirst:
+            if (a.m_recPriority != b.m_recPriority)
+                return a.m_recPriority < b.m_recPriority;
+            break;
+        case emWeightedTimePriority:
+            return a.m_recStartTs.addDays(m_dayPriority * a.m_recPriority) <
+                   b.m_recStartTs.addDays(m_dayPriority * b.m_recPriority);
+        default:
+            break;
+    }
+    return a.m_recStartTs < b.m_recStartTs;
+}
+
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -1,6 +1,7 @@
 #ifndef AUTOEXPIRE_H_
 #define AUTOEXPIRE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include <QQueue>
 #include <QSet>
 #include <QMap>
+#include <QHash>
 
 #include "mthread.h"
 
@@ -57,6 +59,48 @@ class UpdateEntry
     int m_fsID;
 };
 
+/// \brief A recording that may be expired, with the fields of the
+///        recorded table that decide the order of expiration.
+struct ExpireCandidate
+{
+    uint      m_recordedId  {0};
+    uint      m_chanId      {0};
+    QDateTime m_recStartTs;
+    QDateTime m_lastModified;
+    int       m_autoExpire  {0};
+    int       m_recPriority {0};
+    bool      m_watched     {false};
+    bool      m_deleted     {false};    ///< in the "Deleted" recording group
+};
+
+/// \brief Expirable recordings as a heap, so that only as many as are
+///        needed are sorted and loaded from the database.
+class ExpireHeap
+{
+  public:
+    ExpireHeap(const QHash<uint, ExpireCandidate> &candidates, int expMethod);
+
+    bool empty(void) const { return m_heap.empty(); }
+    ExpireCandidate pop(void);
+
+  private:
+    bool ExpiresBefore(const ExpireCandidate &a,
+                       const ExpireCandidate &b) const;
+
+    std::vector<ExpireCandidate> m_heap;
+    int  m_expMethod       {emOldestFirst};
+    bool m_watchedPriority {false};
+    int  m_dayPriority     {3};
+};
+
+/// \brief Bytes written by a recorder at a point in time
+struct WriteSample
+{
+    long long m_position {-1};
+    QDateTime m_time;
+    uint64_t  m_kbPerMin {0};           ///< rate up to m_time
+};
+
 class AutoExpire : public QObject
 {
     Q_OBJECT
@@ -89,6 +133,7 @@ class AutoExpire : public QObject
 
   protected:
     void RunExpirer(void);
+    void customEvent(QEvent *event) override; // QObject
 
   private:
     void ExpireLiveTV(int type);
@@ -99,6 +144,14 @@ class AutoExpire : public QObject
 
     void FillExpireList(pginfolist_t &expireList);
     void FillDBOrdered(pginfolist_t &expireList, int expMethod);
+    void FillFromHeap(pginfolist_t &expireList, int expMethod);
+    ProgramInfo *NextExpirable(ExpireHeap &heap,
+                               const pginfolist_t &expireList) const;
+
+    void SyncCandidates(void);
+    void LoadCandidates(void);
+    void UpdateCandidate(uint recordedid);
+    uint64_t KBPerMin(int cardid, EncoderLink *enc);
     static void SendDeleteMessages(pginfolist_t &deleteList);
     void Sleep(std::chrono::milliseconds sleepTime);
 
@@ -115,6 +168,12 @@ class AutoExpire : public QObject
 
     QMap<int, int64_t>  m_desiredSpace;          // protected by m_instanceLock
     QMap<int, int>      m_usedEncoders;          // protected by m_instanceLock
+    QMap<int, WriteSample> m_writeSamples;       // protected by m_instanceLock
+
+    // expiry candidates, kept up to date from recording list changes
+    QHash<uint, ExpireCandidate> m_candidates;   // protected by m_instanceLock
+    QDateTime           m_candidatesLoaded;      // protected by m_instanceLock
+    std::atomic<bool>   m_expireNow       {false};
 
     mutable QMutex m_instanceLock;
     QWaitCondition m_instanceCond;               // protected by m_instanceLock
@@ -124,6 +183,8 @@ class AutoExpire : public QObject
     // update info
     QMutex              m_updateLock;
     QQueue<UpdateEntry> m_updateQueue;           // protected by m_updateLock
+    QMap<uint, bool>    m_candidateUpdates;      // protected by m_updateLock
+    bool                m_candidatesValid {false}; // protected by m_updateLock
 };
 
 #endif
@@ -1069,6 +1069,34 @@ DTC::BackendInfo* Myth::GetBackendInfo( void )
 //
 /////////////////////////////////////////////////////////////////////////////
 
+DTC::DatabaseQueryStatList* Myth::GetDatabaseQueryStats( int nCount )
+{
+    QList<MSqlQueryStats> stats = MSqlQuery::GetQueryStats();
+
+    auto *pList = new DTC::DatabaseQueryStatList();
+
+    int count = 0;
+    for (const auto &stat : qAsConst(stats))
+    {
+        if (nCount > 0 && count++ >= nCount)
+            break;
+
+        DTC::DatabaseQueryStat *pStat = pList->AddNewDatabaseQueryStat();
+        pStat->setQuery      ( stat.m_query );
+        pStat->setCount      ( stat.m_count );
+        pStat->setTotalTime  ( stat.m_total.count() );
+        pStat->setMaxTime    ( stat.m_max.count() );
+        pStat->setAverageTime( stat.m_count ?
+                               stat.m_total.count() / stat.m_count : 0 );
+    }
+
+    return pList;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 bool Myth::ManageDigestUser( const QString &sAction,
                              const QString &sUserName,
                              const QString &sPassword,
@@ -143,6 +143,8 @@ class Myth : public MythServices
 
         DTC::BackendInfo*   GetBackendInfo      ( void ) override; // MythServices
 
+        DTC::DatabaseQueryStatList* GetDatabaseQueryStats( int Count ) override; // MythServices
+
         bool                ManageDigestUser    ( const QString &Action,
                                                   const QString &UserName,
                                                   const QString &Password,
@@ -413,6 +415,13 @@ class ScriptableMyth : public QObject
                 return m_obj.GetBackendInfo();
             )
         }
+
+        QObject* GetDatabaseQueryStats( int Count )
+        {
+            SCRIPT_CATCH_EXCEPTION( nullptr,
+                return m_obj.GetDatabaseQueryStats( Count );
+            )
+        }
         bool ManageDigestUser( const QString &Action,
                                const QString &UserName,
                                const QString &Password,
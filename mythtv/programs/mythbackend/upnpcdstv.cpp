@@ -142,6 +142,8 @@ UPnpCDSTv::UPnpCDSTv()
 
     // ShortCuts
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS_RECORDINGS, "Recordings");
+
+    m_changeEvents << "RECORDING_LIST_CHANGE" << "MASTER_UPDATE_REC_INFO";
 }
 
 void UPnpCDSTv::CreateRoot()
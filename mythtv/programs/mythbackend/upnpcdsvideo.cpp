@@ -38,6 +38,8 @@ UPnpCDSVideo::UPnpCDSVideo()
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS, "Videos");
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS_ALL, "Videos/Video");
     m_shortcuts.insert(UPnPShortcutFeature::VIDEOS_GENRES, "Videos/Genre");
+
+    m_changeEvents << "VIDEO_LIST_CHANGE";
 }
 
 void UPnpCDSVideo::CreateRoot()
@@ -13,6 +13,7 @@ extern "C" {
 #include "FrameAnalyzer.h"
 #include "TemplateFinder.h"
 #include "BorderDetector.h"
+#include "pgmkernels.h"
 
 using namespace frameAnalyzer;
 using namespace commDetector2;
@@ -248,8 +249,20 @@ found_right:
         {
             int outliers = 0;
             bool inrange = true;
+            const uchar *row = &pgm->data[0][rr * pgmwidth];
+            bool logorow = m_logo && rr >= m_logoRow &&
+                rr < m_logoRow + m_logoHeight;
             for (int cc = mincol; cc < maxcol1; cc++)
             {
+                if (!logorow)
+                {
+                    /* Skip over the pixels that keep the row in range. */
+                    cc += pgmKernels::inrange_span(&row[cc], maxcol1 - cc,
+                            &minval, &maxval, kMaxRange);
+                    if (cc == maxcol1)
+                        break;
+                }
+
                 if (m_logo && rrccinrect(rr, cc, m_logoRow, m_logoCol,
                             m_logoWidth, m_logoHeight))
                     continue;   /* Exclude logo area from analysis. */
@@ -297,8 +310,20 @@ found_top:
         {
             int outliers = 0;
             bool inrange = true;
+            const uchar *row = &pgm->data[0][rr * pgmwidth];
+            bool logorow = m_logo && rr >= m_logoRow &&
+                rr < m_logoRow + m_logoHeight;
             for (int cc = mincol; cc < maxcol1; cc++)
             {
+                if (!logorow)
+                {
+                    /* Skip over the pixels that keep the row in range. */
+                    cc += pgmKernels::inrange_span(&row[cc], maxcol1 - cc,
+                            &minval, &maxval, kMaxRange);
+                    if (cc == maxcol1)
+                        break;
+                }
+
                 if (m_logo && rrccinrect(rr, cc, m_logoRow, m_logoCol,
                             m_logoWidth, m_logoHeight))
                     continue;   /* Exclude logo area from analysis. */
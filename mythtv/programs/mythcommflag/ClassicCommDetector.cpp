@@ -3,23 +3,28 @@
 
 // C++ headers
 #include <algorithm> // for min/max
+#include <atomic>
 #include <iostream> // for cerr
 #include <thread> // for sleep_for
 
 // Qt headers
 #include <QCoreApplication>
+#include <QRunnable>
 #include <QString>
 
 // MythTV headers
 #include "mythmiscutil.h"
 #include "mythcontext.h"
+#include "mthreadpool.h"
 #include "programinfo.h"
+#include "playercontext.h"
 #include "mythcommflagplayer.h"
 
 // Commercial Flagging headers
 #include "ClassicCommDetector.h"
 #include "ClassicLogoDetector.h"
 #include "ClassicSceneChangeDetector.h"
+#include "Histogram.h"
 
 enum frameAspects {
     COMM_ASPECT_NORMAL = 0,
@@ -159,6 +164,8 @@ ClassicCommDetector::ClassicCommDetector(SkipType commDetectMethod_in,
 
     m_commDetectBlankCanHaveLogo =
         !!gCoreContext->GetBoolSetting("CommDetectBlankCanHaveLogo", true);
+
+    m_segments = gCoreContext->GetNumSetting("CommDetectSegments", 0);
 }
 
 void ClassicCommDetector::Init()
@@ -279,6 +286,291 @@ void ClassicCommDetector::deleteLater(void)
     CommDetectorBase::deleteLater();
 }
 
+/** \class ClassicCommDetectorSegment
+ *  \brief Scans one keyframe aligned segment of a recording with its own
+ *         player, for the segmented mode of ClassicCommDetector.
+ *
+ *   Every frame in [start, end) is scanned with ClassicCommDetector::ScanFrame
+ *   and the results are kept in frame order, to be replayed through the
+ *   detector once all segments are done. Scene change similarity needs the
+ *   previous frame, so all segments but the first also decode the frame
+ *   before their start. All segments but the last scan a few frames past
+ *   their end, see FrameScanSegment.
+ */
+class ClassicCommDetectorSegment : public QRunnable
+{
+  public:
+    ClassicCommDetectorSegment(const ClassicCommDetector *detector,
+                               long long start, long long end) :
+        m_detector(detector), m_result(start, end)
+    {
+        setAutoDelete(false);
+    }
+
+    void run(void) override; // QRunnable
+
+    const FrameScanSegment &Result(void) const { return m_result; }
+    long long FramesScanned(void) const { return m_framesScanned; }
+    bool IsDone(void) const { return m_done; }
+    bool IsOk(void) const { return m_ok; }
+    void Stop(void) { m_stop = true; }
+    void SetPaused(bool paused) { m_paused = paused; }
+
+  private:
+    const ClassicCommDetector *m_detector      {nullptr};
+    FrameScanSegment           m_result;
+    std::atomic<long long>     m_framesScanned {0};
+    std::atomic<bool>          m_done          {false};
+    std::atomic<bool>          m_stop          {false};
+    std::atomic<bool>          m_paused        {false};
+    bool                       m_ok            {false};
+};
+
+void ClassicCommDetectorSegment::run(void)
+{
+    const ClassicCommDetector *det = m_detector;
+    PlayerContext *ctx = det->m_player->CreateWorkerContext();
+    auto *player = ctx ? dynamic_cast<MythCommFlagPlayer*>(ctx->m_player) : nullptr;
+
+    if (player && (player->OpenFile() >= 0) && player->InitVideo())
+    {
+        player->EnableSubtitles(false);
+
+        Histogram histogram;
+        Histogram previousHistogram;
+        long long start = m_result.start;
+        long long seekTo = (start > 0) ? start - 1 : -1;
+        bool more = true;
+
+        while (more && !m_stop && player->GetEof() == kEofStateNone)
+        {
+            while (m_paused && !m_stop)
+                std::this_thread::sleep_for(1s);
+
+            // sleep a little so we don't use all cpu even if we're niced,
+            // as the serial loop does
+            if (!det->m_fullSpeed)
+                std::this_thread::sleep_for(10ms);
+
+            MythVideoFrame *frame = player->GetRawVideoFrame(seekTo);
+            seekTo = -1;
+            long long frameNumber = frame->m_frameNumber;
+
+            // Skip the same frames ProcessFrame() would refuse
+            if (!frame->m_buffer || frameNumber == -1 ||
+                frame->m_type != FMT_YV12)
+            {
+                player->DiscardVideoFrame(frame);
+                continue;
+            }
+
+            FrameScanEntry scan;
+            if (det->m_commDetectMethod & COMM_DETECT_SCENE)
+            {
+                histogram.generateFromImage(frame, det->m_width, det->m_height,
+                    det->m_commDetectBorder, det->m_width - det->m_commDetectBorder,
+                    det->m_commDetectBorder, det->m_height - det->m_commDetectBorder,
+                    det->m_horizSpacing, det->m_vertSpacing);
+                scan.sceneSimilarity =
+                    histogram.calculateSimilarityWith(previousHistogram);
+                std::swap(histogram, previousHistogram);
+            }
+
+            if (frameNumber >= start)
+            {
+                scan.frameNumber = frameNumber;
+                scan.videoAspect = frame->m_aspect;
+                det->ScanFrame(frame, scan);
+                more = m_result.Add(scan);
+                m_framesScanned++;
+            }
+
+            player->DiscardVideoFrame(frame);
+        }
+
+        m_ok = !m_stop;
+    }
+    else
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("CommDetect: Unable to open player for segment "
+                    "starting at frame %1").arg(m_result.start));
+    }
+
+    delete ctx;
+    m_done = true;
+}
+
+/** \brief Splits the recording at keyframes from the position map into
+ *         at most m_segments parts.
+ *
+ *  \return The first frame of each segment, always starting with frame 0.
+ */
+QList<long long> ClassicCommDetector::GetSegmentStarts(long long totalFrames) const
+{
+    QList<long long> starts { 0 };
+
+    if (totalFrames <= 0)
+        return starts;
+
+    // Don't bother with segments shorter than a minute
+    auto minLength = static_cast<long long>(m_fps * 60);
+    for (int i = 1; i < m_segments; i++)
+    {
+        long long key =
+            m_player->GetKeyframeAtOrBefore(totalFrames * i / m_segments);
+        if (key < 0)
+            break;
+        if (key - starts.back() >= minLength)
+            starts.push_back(key);
+    }
+
+    return starts;
+}
+
+/** \brief Flags a finished recording by scanning keyframe aligned
+ *         segments concurrently.
+ *
+ *   Each segment is scanned by its own player on a worker thread. The scan
+ *   results are then fed through the same per-frame bookkeeping as the
+ *   serial loop, in frame order, so the resulting frame info and maps are
+ *   identical to those of a serial run.
+ *
+ *  \return false, without having touched the frame info, if a worker
+ *           failed or the segments didn't join up. The caller should then
+ *           scan serially, unless m_bStop is set.
+ */
+bool ClassicCommDetector::GoSegmented(const QList<long long> &starts,
+                                      long long totalFrames, float aspect)
+{
+    LOG(VB_COMMFLAG, LOG_INFO,
+        QString("Scanning %1 segments concurrently").arg(starts.size()));
+
+    std::vector<ClassicCommDetectorSegment*> segments;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        long long end = (i + 1 < starts.size()) ? starts[i + 1] : -1;
+        segments.push_back(new ClassicCommDetectorSegment(this, starts[i], end));
+    }
+
+    MThreadPool pool("CommDetectSegments");
+    pool.setMaxThreadCount(static_cast<int>(segments.size()));
+    for (auto *segment : segments)
+        pool.start(segment, "CommDetectSegment");
+
+    QElapsedTimer flagTime;
+    flagTime.start();
+    int prevpercent = -1;
+
+    auto running = [&segments]()
+    {
+        return std::any_of(segments.cbegin(), segments.cend(),
+            [](const ClassicCommDetectorSegment *seg) { return !seg->IsDone(); });
+    };
+
+    while (running())
+    {
+        emit breathe();
+        for (auto *segment : segments)
+        {
+            if (m_bStop)
+                segment->Stop();
+            segment->SetPaused(m_bPaused);
+        }
+
+        long long scanned = 0;
+        for (auto *segment : segments)
+            scanned += segment->FramesScanned();
+
+        float elapsed = flagTime.elapsed() / 1000.0;
+        float flagFPS = (elapsed != 0.0F) ? scanned / elapsed : 0.0F;
+        int percentage = (totalFrames) ?
+            std::min(static_cast<int>(scanned * 100 / totalFrames), 100) : 0;
+
+        if (m_showProgress)
+        {
+            QString tmp = QString("\r%1%/%2fps  \r")
+                .arg(percentage, 3).arg((int)flagFPS, 4);
+            std::cerr << qPrintable(tmp) << std::flush;
+        }
+
+        emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+            "%1% Completed @ %2 fps.").arg(percentage).arg(flagFPS));
+
+        if (percentage % 10 == 0 && prevpercent != percentage)
+        {
+            prevpercent = percentage;
+            LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
+                .arg(percentage) .arg(flagFPS));
+        }
+
+        std::this_thread::sleep_for(500ms);
+    }
+    pool.waitForDone();
+
+    bool ok = !m_bStop && std::all_of(segments.cbegin(), segments.cend(),
+        [](const ClassicCommDetectorSegment *seg) { return seg->IsOk(); });
+
+    FrameScanList scans;
+    if (ok)
+    {
+        std::vector<const FrameScanSegment*> results;
+        results.reserve(segments.size());
+        for (auto *segment : segments)
+            results.push_back(&segment->Result());
+
+        long long badFrame = -1;
+        ok = MergeFrameScans(results, scans, badFrame);
+        if (!ok)
+        {
+            LOG(VB_GENERAL, LOG_WARNING,
+                QString("CommDetect: Segments disagree about frame %1, "
+                        "the decoder numbered frames differently after "
+                        "seeking").arg(badFrame));
+        }
+    }
+
+    for (auto *segment : segments)
+        delete segment;
+
+    if (ok)
+    {
+        // Replay the scans in frame order, exactly as the serial loop and
+        // ClassicSceneChangeDetector would have seen them.
+        bool previousWasSceneChange = false;
+        unsigned int sceneFrameNumber = 0;
+        for (const auto &scan : scans)
+        {
+            if (scan.videoAspect != aspect)
+            {
+                SetVideoParams(aspect);
+                aspect = scan.videoAspect;
+            }
+
+            StartFrame(scan.frameNumber);
+
+            if (m_commDetectMethod & COMM_DETECT_SCENE)
+            {
+                bool sceneChange = ClassicSceneChangeDetector::isSceneChange(
+                    scan.sceneSimilarity, previousWasSceneChange);
+                sceneChangeDetectorHasNewInformation(
+                    sceneFrameNumber++, sceneChange, scan.sceneSimilarity);
+                previousWasSceneChange = sceneChange;
+            }
+
+            ApplyFrameScan(scan);
+        }
+    }
+
+    if (m_showProgress)
+    {
+        std::cerr << "\b\b\b\b\b\b      \b\b\b\b\b\b";
+        std::cerr.flush();
+    }
+
+    return ok;
+}
+
 bool ClassicCommDetector::go()
 {
     int secsSince = 0;
@@ -354,26 +646,7 @@ bool ClassicCommDetector::go()
     m_player->EnableSubtitles(false);
 
     if (m_commDetectMethod & COMM_DETECT_LOGO)
-    {
-        emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
-            "Searching for Logo"));
-
-        if (m_showProgress)
-        {
-            std::cerr << "Finding Logo";
-            std::cerr.flush();
-        }
-        LOG(VB_GENERAL, LOG_INFO, "Finding Logo");
-
-        m_logoInfoAvailable = m_logoDetector->searchForLogo(m_player);
-
-        if (m_showProgress)
-        {
-            std::cerr << "\b\b\b\b\b\b\b\b\b\b\b\b            "
-                         "\b\b\b\b\b\b\b\b\b\b\b\b";
-            std::cerr.flush();
-        }
-    }
+        SearchForLogo();
 
     emit breathe();
     if (m_bStop)
@@ -408,6 +681,30 @@ bool ClassicCommDetector::go()
 
     m_player->ResetTotalDuration();
 
+    if ((m_segments > 1) && !m_stillRecording)
+    {
+        QList<long long> starts = GetSegmentStarts(myTotalFrames);
+        if (starts.size() <= 1)
+        {
+            LOG(VB_COMMFLAG, LOG_INFO,
+                "Recording too short or no position map, scanning serially");
+        }
+        else if (GoSegmented(starts, myTotalFrames, aspect))
+        {
+            return true;
+        }
+        else if (m_bStop)
+        {
+            return false;
+        }
+        else
+        {
+            LOG(VB_GENERAL, LOG_WARNING,
+                "CommDetect: Segmented scan failed, scanning serially");
+            flagTime.restart();
+        }
+    }
+
     while (m_player->GetEof() == kEofStateNone)
     {
         std::chrono::microseconds startTime {0us};
@@ -598,6 +895,39 @@ bool ClassicCommDetector::go()
     return true;
 }
 
+/** \brief Searches the recording for a station logo, creating the logo
+ *         detector first if necessary.
+ */
+void ClassicCommDetector::SearchForLogo(void)
+{
+    if (!m_logoDetector)
+    {
+        int logoDetectBorder =
+            gCoreContext->GetNumSetting("CommDetectLogoBorder", 16);
+        m_logoDetector = new ClassicLogoDetector(this, m_width, m_height,
+            logoDetectBorder);
+    }
+
+    emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+        "Searching for Logo"));
+
+    if (m_showProgress)
+    {
+        std::cerr << "Finding Logo";
+        std::cerr.flush();
+    }
+    LOG(VB_GENERAL, LOG_INFO, "Finding Logo");
+
+    m_logoInfoAvailable = m_logoDetector->searchForLogo(m_player);
+
+    if (m_showProgress)
+    {
+        std::cerr << "\b\b\b\b\b\b\b\b\b\b\b\b            "
+                     "\b\b\b\b\b\b\b\b\b\b\b\b";
+        std::cerr.flush();
+    }
+}
+
 void ClassicCommDetector::sceneChangeDetectorHasNewInformation(
     unsigned int framenum,bool isSceneChange,float debugValue)
 {
@@ -741,27 +1071,11 @@ void ClassicCommDetector::SetVideoParams(float aspect)
 void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
                                        long long frame_number)
 {
-    int max = 0;
-    int min = 255;
-    int blankPixelsChecked = 0;
-    long long totBrightness = 0;
-    auto *rowMax = new unsigned char[m_height];
-    auto *colMax = new unsigned char[m_width];
-    memset(rowMax, 0, sizeof(*rowMax)*m_height);
-    memset(colMax, 0, sizeof(*colMax)*m_width);
-    int topDarkRow = m_commDetectBorder;
-    int bottomDarkRow = m_height - m_commDetectBorder - 1;
-    int leftDarkCol = m_commDetectBorder;
-    int rightDarkCol = m_width - m_commDetectBorder - 1;
-    FrameInfoEntry fInfo {};
-
     if (!frame || !(frame->m_buffer) || frame_number == -1 ||
         frame->m_type != FMT_YV12)
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Invalid video frame or codec, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
         return;
     }
 
@@ -769,14 +1083,36 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     {
         LOG(VB_COMMFLAG, LOG_ERR, "CommDetect: Width or Height is 0, "
                                   "unable to process frame.");
-        delete[] rowMax;
-        delete[] colMax;
         return;
     }
 
+    StartFrame(frame_number);
+
+    if (m_commDetectMethod & COMM_DETECT_SCENE)
+    {
+        m_sceneChangeDetector->processFrame(frame);
+    }
+
+    FrameScanEntry scan;
+    scan.frameNumber = frame_number;
+    scan.videoAspect = frame->m_aspect;
+    ScanFrame(frame, scan);
+    ApplyFrameScan(scan);
+
+#ifdef SHOW_DEBUG_WIN
+    comm_debug_show(frame->buf);
+    getchar();
+#endif
+}
+
+/** \brief Adds the frame info record for frame_number, along with dummy
+ *         records for any frames the decoder skipped since the last one.
+ */
+void ClassicCommDetector::StartFrame(long long frame_number)
+{
+    FrameInfoEntry fInfo {};
+
     m_curFrameNumber = frame_number;
-    unsigned char* framePtr = frame->m_buffer;
-    int bytesPerLine = frame->m_pitches[0];
 
     fInfo.minBrightness = -1;
     fInfo.maxBrightness = -1;
@@ -786,8 +1122,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     fInfo.format = COMM_FORMAT_NORMAL;
     fInfo.flagMask = 0;
 
-    int& flagMask = m_frameInfo[m_curFrameNumber].flagMask;
-
     // Fill in dummy info records for skipped frames.
     if (m_lastFrameNumber != (m_curFrameNumber - 1))
     {
@@ -807,52 +1141,65 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     m_lastFrameNumber = m_curFrameNumber;
 
     m_frameInfo[m_curFrameNumber] = fInfo;
+}
 
-    if (m_commDetectMethod & COMM_DETECT_BLANKS)
-        m_frameIsBlank = false;
-
-    if (m_commDetectMethod & COMM_DETECT_SCENE)
-    {
-        m_sceneChangeDetector->processFrame(frame);
-    }
+/** \brief Takes the brightness, format and logo measurements of a frame.
+ *
+ *   This only reads settings and the (already found) logo, so it may be
+ *   called concurrently for different frames.
+ */
+void ClassicCommDetector::ScanFrame(MythVideoFrame *frame,
+                                    FrameScanEntry &scan) const
+{
+    int max = 0;
+    int min = 255;
+    int blankPixelsChecked = 0;
+    long long totBrightness = 0;
+    std::vector<unsigned char> rowMax(m_height, 0);
+    std::vector<unsigned char> colMax(m_width, 0);
+    int topDarkRow = m_commDetectBorder;
+    int bottomDarkRow = m_height - m_commDetectBorder - 1;
+    int leftDarkCol = m_commDetectBorder;
+    int rightDarkCol = m_width - m_commDetectBorder - 1;
 
-    m_stationLogoPresent = false;
+    unsigned char* framePtr = frame->m_buffer;
+    int bytesPerLine = frame->m_pitches[0];
 
-    for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
-            y += m_vertSpacing)
+    if (m_commDetectMethod & COMM_DETECT_BLANKS)
     {
-        for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
-                x += m_horizSpacing)
+        for(int y = m_commDetectBorder; y < (m_height - m_commDetectBorder);
+                y += m_vertSpacing)
         {
-            uchar pixel = framePtr[y * bytesPerLine + x];
-
-            if (m_commDetectMethod & COMM_DETECT_BLANKS)
+            for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
+                    x += m_horizSpacing)
             {
-                 bool checkPixel = false;
-                 if (!m_commDetectBlankCanHaveLogo)
-                     checkPixel = true;
+                uchar pixel = framePtr[y * bytesPerLine + x];
+
+                bool checkPixel = false;
+                if (!m_commDetectBlankCanHaveLogo)
+                    checkPixel = true;
 
-                 if (!m_logoInfoAvailable ||
-                     !m_logoDetector->pixelInsideLogo(x,y))
-                     checkPixel=true;
+                if (!m_logoInfoAvailable ||
+                    !m_logoDetector->pixelInsideLogo(x,y))
+                    checkPixel=true;
 
-                 if (checkPixel)
-                 {
-                     blankPixelsChecked++;
-                     totBrightness += pixel;
+                if (checkPixel)
+                {
+                    blankPixelsChecked++;
+                    totBrightness += pixel;
 
-                     if (pixel < min)
-                          min = pixel;
+                    if (pixel < min)
+                         min = pixel;
 
-                     if (pixel > max)
-                          max = pixel;
+                    if (pixel > max)
+                         max = pixel;
 
-                     if (pixel > rowMax[y])
-                         rowMax[y] = pixel;
+                    if (pixel > rowMax[y])
+                        rowMax[y] = pixel;
 
-                     if (pixel > colMax[x])
-                         colMax[x] = pixel;
-                 }
+                    if (pixel > colMax[x])
+                        colMax[x] = pixel;
+                }
             }
         }
     }
@@ -872,9 +1219,6 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             if (rowMax[y] >= m_commDetectBoxBrightness)
                 bottomDarkRow = y;
 
-        delete[] rowMax;
-        rowMax = nullptr;
-
         for(int x = m_commDetectBorder; x < (m_width - m_commDetectBorder);
                 x += m_horizSpacing)
         {
@@ -888,75 +1232,97 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
             if (colMax[x] >= m_commDetectBoxBrightness)
                 rightDarkCol = x;
 
-        delete[] colMax;
-        colMax = nullptr;
-
-        m_frameInfo[m_curFrameNumber].format = COMM_FORMAT_NORMAL;
+        scan.format = COMM_FORMAT_NORMAL;
         if ((topDarkRow > m_commDetectBorder) &&
             (topDarkRow < (m_height * .20)) &&
             (bottomDarkRow < (m_height - m_commDetectBorder)) &&
             (bottomDarkRow > (m_height * .80)))
         {
-            m_frameInfo[m_curFrameNumber].format |= COMM_FORMAT_LETTERBOX;
+            scan.format |= COMM_FORMAT_LETTERBOX;
         }
         if ((leftDarkCol > m_commDetectBorder) &&
                  (leftDarkCol < (m_width * .20)) &&
                  (rightDarkCol < (m_width - m_commDetectBorder)) &&
                  (rightDarkCol > (m_width * .80)))
         {
-            m_frameInfo[m_curFrameNumber].format |= COMM_FORMAT_PILLARBOX;
+            scan.format |= COMM_FORMAT_PILLARBOX;
         }
 
         int avg = totBrightness / blankPixelsChecked;
 
-        m_frameInfo[m_curFrameNumber].minBrightness = min;
-        m_frameInfo[m_curFrameNumber].maxBrightness = max;
-        m_frameInfo[m_curFrameNumber].avgBrightness = avg;
+        scan.blankScanned = true;
+        scan.minBrightness = min;
+        scan.maxBrightness = max;
+        scan.avgBrightness = avg;
 
-        m_totalMinBrightness += min;
-        m_commDetectDimAverage = min + 10;
+        int dimAverage = min + 10;
 
         // Is the frame really dark
         if (((max - min) <= m_commDetectBlankFrameMaxDiff) &&
             (max < m_commDetectDimBrightness))
-            m_frameIsBlank = true;
+            scan.isBlank = true;
 
         // Are we non-strict and the frame is blank
         if ((!m_aggressiveDetection) &&
             ((max - min) <= m_commDetectBlankFrameMaxDiff))
-            m_frameIsBlank = true;
+            scan.isBlank = true;
 
         // Are we non-strict and the frame is dark
         //                   OR the frame is dim and has a low avg brightness
         if ((!m_aggressiveDetection) &&
             ((max < m_commDetectDarkBrightness) ||
-             ((max < m_commDetectDimBrightness) && (avg < m_commDetectDimAverage))))
-            m_frameIsBlank = true;
+             ((max < m_commDetectDimBrightness) && (avg < dimAverage))))
+            scan.isBlank = true;
     }
 
     if ((m_logoInfoAvailable) && (m_commDetectMethod & COMM_DETECT_LOGO))
     {
-        m_stationLogoPresent =
+        scan.logoPresent =
             m_logoDetector->doesThisFrameContainTheFoundLogo(frame);
     }
+}
+
+/** \brief Records the measurements of the current frame, which must have
+ *         been started with StartFrame().
+ */
+void ClassicCommDetector::ApplyFrameScan(const FrameScanEntry &scan)
+{
+    FrameInfoEntry &fInfo = m_frameInfo[m_curFrameNumber];
+
+    if (m_commDetectMethod & COMM_DETECT_BLANKS)
+        m_frameIsBlank = false;
+
+    if (scan.blankScanned)
+    {
+        fInfo.format = scan.format;
+        fInfo.minBrightness = scan.minBrightness;
+        fInfo.maxBrightness = scan.maxBrightness;
+        fInfo.avgBrightness = scan.avgBrightness;
+
+        m_totalMinBrightness += scan.minBrightness;
+        m_commDetectDimAverage = scan.minBrightness + 10;
+        m_frameIsBlank = scan.isBlank;
+    }
+
+    m_stationLogoPresent = scan.logoPresent;
 
 #if 0
     if ((m_commDetectMethod == COMM_DETECT_ALL) &&
         (CheckRatingSymbol()))
     {
-        flagMask |= COMM_FRAME_RATING_SYMBOL;
+        fInfo.flagMask |= COMM_FRAME_RATING_SYMBOL;
     }
 #endif
 
     if (m_frameIsBlank)
     {
         m_blankFrameMap[m_curFrameNumber] = MARK_BLANK_FRAME;
-        flagMask |= COMM_FRAME_BLANK;
+        fInfo.flagMask |= COMM_FRAME_BLANK;
         m_blankFrameCount++;
     }
 
     if (m_stationLogoPresent)
-        flagMask |= COMM_FRAME_LOGO_PRESENT;
+        fInfo.flagMask |= COMM_FRAME_LOGO_PRESENT;
 
     //TODO: move this debugging code out of the perframe loop, and do it after
     // we've processed all frames. this is because a scenechangedetector can
@@ -970,23 +1336,16 @@ void ClassicCommDetector::ProcessFrame(MythVideoFrame *frame,
     {
         LOG(VB_COMMFLAG, LOG_DEBUG, QString("Frame: %1 -> %2 %3 %4 %5 %6 %7 %8")
             .arg(m_curFrameNumber, 6)
-            .arg(m_frameInfo[m_curFrameNumber].minBrightness, 3)
-            .arg(m_frameInfo[m_curFrameNumber].maxBrightness, 3)
-            .arg(m_frameInfo[m_curFrameNumber].avgBrightness, 3)
-            .arg(m_frameInfo[m_curFrameNumber].sceneChangePercent, 3)
-            .arg(m_frameInfo[m_curFrameNumber].format, 1)
-            .arg(m_frameInfo[m_curFrameNumber].aspect, 1)
-            .arg(m_frameInfo[m_curFrameNumber].flagMask, 4, 16, QChar('0')));
+            .arg(fInfo.minBrightness, 3)
+            .arg(fInfo.maxBrightness, 3)
+            .arg(fInfo.avgBrightness, 3)
+            .arg(fInfo.sceneChangePercent, 3)
+            .arg(fInfo.format, 1)
+            .arg(fInfo.aspect, 1)
+            .arg(fInfo.flagMask, 4, 16, QChar('0')));
     }
 
-#ifdef SHOW_DEBUG_WIN
-    comm_debug_show(frame->buf);
-    getchar();
-#endif
-
     m_framesProcessed++;
-    delete[] rowMax;
-    delete[] colMax;
 }
 
 void ClassicCommDetector::ClearAllMaps(void)
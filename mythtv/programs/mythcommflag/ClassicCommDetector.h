@@ -15,10 +15,12 @@
 
 // Commercial Flagging headers
 #include "CommDetectorBase.h"
+#include "FrameScan.h"
 
 class MythCommFlagPlayer;
 class LogoDetectorBase;
 class SceneChangeDetectorBase;
+class ClassicCommDetectorSegment;
 
 enum frameMaskValues {
     COMM_FRAME_SKIPPED       = 0x0001,
@@ -68,6 +70,8 @@ class ClassicCommDetector : public CommDetectorBase
         void logoDetectorBreathe();
 
         friend class ClassicLogoDetector;
+        friend class ClassicCommDetectorSegment;
+        friend class KeyframeCommDetector;
 
     protected:
         ~ClassicCommDetector() override = default;
@@ -110,6 +114,9 @@ class ClassicCommDetector : public CommDetectorBase
             frm_dir_map_t &out, const show_map_t &in);
         void CleanupFrameInfo(void);
         void GetLogoCommBreakMap(show_map_t &map);
+        QList<long long> GetSegmentStarts(long long totalFrames) const;
+        bool GoSegmented(const QList<long long> &starts,
+                         long long totalFrames, float aspect);
 
         SkipType m_commDetectMethod;
         frm_dir_map_t m_lastSentCommBreakMap;
@@ -162,6 +169,10 @@ class ClassicCommDetector : public CommDetectorBase
 
         SceneChangeDetectorBase* m_sceneChangeDetector {nullptr};
 
+        /// Number of keyframe aligned segments to scan concurrently when
+        /// flagging a finished recording. 0 or 1 scans the file serially.
+        int m_segments                     {0};
+
 protected:
         MythCommFlagPlayer *m_player       {nullptr};
         QDateTime m_startedAt;
@@ -179,8 +190,12 @@ protected:
 
 
         void Init();
+        void SearchForLogo(void);
         void SetVideoParams(float aspect);
         void ProcessFrame(MythVideoFrame *frame, long long frame_number);
+        void StartFrame(long long frame_number);
+        void ScanFrame(MythVideoFrame *frame, FrameScanEntry &scan) const;
+        void ApplyFrameScan(const FrameScanEntry &scan);
         QMap<long long, FrameInfoEntry> m_frameInfo;
 
 public slots:
@@ -33,10 +33,10 @@ void ClassicSceneChangeDetector::processFrame(MythVideoFrame* frame)
                                  m_height-m_commdetectborder, m_xspacing, m_yspacing);
     float similar = m_histogram->calculateSimilarityWith(*m_previousHistogram);
 
-    bool isSceneChange = (similar < .85F && !m_previousFrameWasSceneChange);
+    bool sceneChange = isSceneChange(similar, m_previousFrameWasSceneChange);
 
-    emit haveNewInformation(m_frameNumber,isSceneChange,similar);
-    m_previousFrameWasSceneChange = isSceneChange;
+    emit haveNewInformation(m_frameNumber,sceneChange,similar);
+    m_previousFrameWasSceneChange = sceneChange;
 
     std::swap(m_histogram,m_previousHistogram);
     m_frameNumber++;
@@ -15,6 +15,9 @@ class ClassicSceneChangeDetector : public SceneChangeDetectorBase
 
     void processFrame(MythVideoFrame* frame) override; // SceneChangeDetectorBase
 
+    static bool isSceneChange(float similar, bool previousFrameWasSceneChange)
+        { return similar < .85F && !previousFrameWasSceneChange; }
+
   private:
     ~ClassicSceneChangeDetector() override;
 
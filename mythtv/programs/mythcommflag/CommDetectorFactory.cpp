@@ -2,6 +2,7 @@
 #include "ClassicCommDetector.h"
 #include "CommDetector2.h"
 #include "PrePostRollFlagger.h"
+#include "KeyframeCommDetector.h"
 
 class MythCommFlagPlayer;
 class RemoteEncoder;
@@ -33,6 +34,13 @@ CommDetectorFactory::makeCommDetector(
             recordingStartedAt, recordingStopsAt, useDB);
     }
 
+    if ((commDetectMethod & COMM_DETECT_KEYFRAME))
+    {
+        return new KeyframeCommDetector(commDetectMethod, showProgress,
+            fullSpeed, player, startedAt, stopsAt,
+            recordingStartedAt, recordingStopsAt);
+    }
+
     return new ClassicCommDetector(commDetectMethod, showProgress, fullSpeed,
             player, startedAt, stopsAt, recordingStartedAt, recordingStopsAt);
 }
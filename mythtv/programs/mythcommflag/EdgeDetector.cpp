@@ -18,6 +18,7 @@ extern "C" {
 // Commercial Flagging headers
 #include "FrameAnalyzer.h"
 #include "EdgeDetector.h"
+#include "pgmkernels.h"
 
 namespace edgeDetector {
 
@@ -41,18 +42,21 @@ sgm_init_exclude(unsigned int *sgm, const AVFrame *src, int srcheight,
     int cc2 = srcwidth - 1;
     for (int rr = 0; rr < rr2; rr++)
     {
-        for (int cc = 0; cc < cc2; cc++)
+        const uchar *rr0 = &src->data[0][rr * srcwidth];
+        const uchar *rr1 = &src->data[0][(rr + 1) * srcwidth];
+        unsigned int *sgmrow = &sgm[rr * srcwidth];
+
+        /* Columns [cc0, cc1) of this row are excluded (and left as zero). */
+        int cc0 = cc2;
+        int cc1 = cc2;
+        if (rr >= excluderow && rr < excluderow + excludeheight)
         {
-            if (!rrccinrect(rr, cc, excluderow, excludecol,
-                        excludewidth, excludeheight))
-            {
-                uchar *rr0 = &src->data[0][rr * srcwidth + cc];
-                uchar *rr1 = &src->data[0][(rr + 1) * srcwidth + cc];
-                int dx = rr1[1] - rr0[0];   /* southeast - northwest */
-                int dy = rr1[0] - rr0[1];   /* southwest - northeast */
-                sgm[rr * srcwidth + cc] = dx * dx + dy * dy;
-            }
+            cc0 = std::clamp(excludecol, 0, cc2);
+            cc1 = std::clamp(excludecol + excludewidth, cc0, cc2);
         }
+
+        pgmKernels::sgm_row(sgmrow, rr0, rr1, cc0);
+        pgmKernels::sgm_row(&sgmrow[cc1], &rr0[cc1], &rr1[cc1], cc2 - cc1);
     }
     return sgm;
 }
@@ -0,0 +1,94 @@
+#include "FrameScan.h"
+
+bool FrameScanEntry::operator==(const FrameScanEntry &other) const
+{
+    return frameNumber     == other.frameNumber     &&
+           videoAspect     == other.videoAspect     &&
+           minBrightness   == other.minBrightness   &&
+           maxBrightness   == other.maxBrightness   &&
+           avgBrightness   == other.avgBrightness   &&
+           format          == other.format          &&
+           blankScanned    == other.blankScanned    &&
+           isBlank         == other.isBlank         &&
+           logoPresent     == other.logoPresent     &&
+           sceneSimilarity == other.sceneSimilarity;
+}
+
+/** \brief Keeps a scanned frame.
+ *
+ *  \return false once the segment and its overlap with the next one are
+ *          complete, and the worker can stop.
+ */
+bool FrameScanSegment::Add(const FrameScanEntry &scan)
+{
+    if (scan.frameNumber < start)
+        return true;
+
+    if ((end < 0) || (scan.frameNumber < end))
+    {
+        scans.push_back(scan);
+        return true;
+    }
+
+    overlap.push_back(scan);
+    return overlap.size() < kOverlapFrames;
+}
+
+/** \brief Joins the scans of consecutive segments into what a serial scan
+ *         would have produced.
+ *
+ *   Fails, setting badFrame to the first frame in question, if the
+ *   segments overlap, a frame lies outside its segment, or the frames a
+ *   segment scanned past its end don't match the start of the next
+ *   segment.
+ */
+bool MergeFrameScans(const std::vector<const FrameScanSegment*> &segments,
+                     FrameScanList &merged, long long &badFrame)
+{
+    merged.clear();
+    badFrame = -1;
+    long long last = -1;
+
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const FrameScanSegment *segment = segments[i];
+
+        for (const auto &scan : segment->scans)
+        {
+            if ((scan.frameNumber <= last) ||
+                (scan.frameNumber < segment->start) ||
+                ((segment->end >= 0) && (scan.frameNumber >= segment->end)))
+            {
+                badFrame = scan.frameNumber;
+                return false;
+            }
+            last = scan.frameNumber;
+        }
+
+        if (i + 1 < segments.size())
+        {
+            const FrameScanSegment *next = segments[i + 1];
+            if (segment->overlap.empty() ||
+                (next->scans.size() < segment->overlap.size()))
+            {
+                badFrame = next->start;
+                return false;
+            }
+            for (size_t j = 0; j < segment->overlap.size(); j++)
+            {
+                if (segment->overlap[j] != next->scans[j])
+                {
+                    badFrame = next->scans[j].frameNumber;
+                    return false;
+                }
+            }
+        }
+
+        merged.insert(merged.end(), segment->scans.cbegin(),
+                      segment->scans.cend());
+    }
+
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
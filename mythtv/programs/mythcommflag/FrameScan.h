@@ -0,0 +1,61 @@
+#ifndef FRAMESCAN_H
+#define FRAMESCAN_H
+
+// C++ headers
+#include <cstddef>
+#include <vector>
+
+/// The measurements taken from a single frame.  These only depend on the
+/// frame itself, so they can be taken on any thread and in any order.
+class FrameScanEntry
+{
+  public:
+    long long frameNumber     {-1};
+    float     videoAspect     {0.0F};
+    int       minBrightness   {-1};
+    int       maxBrightness   {-1};
+    int       avgBrightness   {-1};
+    int       format          {0};
+    bool      blankScanned    {false};
+    bool      isBlank         {false};
+    bool      logoPresent     {false};
+    float     sceneSimilarity {0.0F};
+
+    bool operator==(const FrameScanEntry &other) const;
+    bool operator!=(const FrameScanEntry &other) const
+        { return !(*this == other); }
+};
+using FrameScanList = std::vector<FrameScanEntry>;
+
+/** \class FrameScanSegment
+ *  \brief The frames one worker scanned in the segmented mode of
+ *         ClassicCommDetector.
+ *
+ *   A worker keeps the frames in [start, end) and then scans on into the
+ *   next segment for kOverlapFrames more. Those must match the first frames
+ *   the next worker scanned, measurements and frame numbers both, or the
+ *   two workers numbered the frames differently after seeking and their
+ *   results can't be joined.
+ */
+class FrameScanSegment
+{
+  public:
+    static constexpr size_t kOverlapFrames { 30 };
+
+    FrameScanSegment(long long Start, long long End) :
+        start(Start), end(End) {}
+
+    bool Add(const FrameScanEntry &scan);
+
+    long long     start   {0};
+    long long     end     {-1}; ///< -1 for end of file
+    FrameScanList scans;        ///< frames [start, end)
+    FrameScanList overlap;      ///< the first frames from end on
+};
+
+bool MergeFrameScans(const std::vector<const FrameScanSegment*> &segments,
+                     FrameScanList &merged, long long &badFrame);
+
+#endif // FRAMESCAN_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include "mythframe.h"
+#include "pgmkernels.h"
 
 void Histogram::generateFromImage(MythVideoFrame* frame, unsigned int frameWidth,
          unsigned int frameHeight, unsigned int minScanX, unsigned int maxScanX,
@@ -21,14 +22,9 @@ void Histogram::generateFromImage(MythVideoFrame* frame, unsigned int frameWidth
 
     unsigned char* framePtr = frame->m_buffer;
     int bytesPerLine = frame->m_pitches[0];
-    for(unsigned int y = minScanY; y < maxScanY; y += YSpacing)
-    {
-        for(unsigned int x = minScanX; x < maxScanX; x += XSpacing)
-        {
-            m_data[framePtr[y * bytesPerLine + x]]++;
-            m_numberOfSamples++;
-        }
-    }
+    m_numberOfSamples = pgmKernels::histogram_add(m_data.data(), framePtr,
+        bytesPerLine, minScanX, maxScanX, XSpacing,
+        minScanY, maxScanY, YSpacing);
 }
 
 unsigned int Histogram::getAverageIntensity(void) const
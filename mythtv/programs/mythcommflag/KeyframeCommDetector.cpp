@@ -0,0 +1,511 @@
+// ANSI C headers
+#include <cmath>
+
+// C++ headers
+#include <algorithm>
+#include <iostream> // for cerr
+#include <thread> // for sleep_for
+#include <vector>
+
+// Qt headers
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+// MythTV headers
+#include "mythchrono.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythcommflagplayer.h"
+
+// Commercial Flagging headers
+#include "KeyframeCommDetector.h"
+#include "ClassicSceneChangeDetector.h"
+#include "Histogram.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+}
+
+#define LOC QString("KeyframeCommDetector: ")
+
+// Length of the intervals audio levels are measured over, in ms
+static constexpr int kAudioBucket { 100 };
+
+// Level reported for digital silence
+static constexpr float kAudioFloor { -120.0F };
+
+// Audio decoded ahead of an interval checked for silence, in seconds
+static constexpr double kAudioPreroll { 0.5 };
+
+/// \brief Without any of blank frame, scene change or logo detection the
+///        keyframe method would find nothing, so use all of them.
+static SkipType keyframe_method(SkipType method)
+{
+    if (!(method & COMM_DETECT_ALL))
+        return static_cast<SkipType>(method | COMM_DETECT_KEYFRAME_ALL);
+    return method;
+}
+
+/// \brief Returns sample "index" of "channel" of an audio frame, scaled to
+///        [-1.0, 1.0].
+static double get_sample(const AVFrame *frame, int channel, int index)
+{
+    auto format = static_cast<AVSampleFormat>(frame->format);
+    const uint8_t *data = frame->extended_data[0];
+    if (av_sample_fmt_is_planar(format))
+        data = frame->extended_data[channel];
+    else
+        index = (index * frame->channels) + channel;
+
+    switch (av_get_packed_sample_fmt(format))
+    {
+        case AV_SAMPLE_FMT_U8:
+            return (data[index] - 128) / 128.0;
+        case AV_SAMPLE_FMT_S16:
+            return reinterpret_cast<const int16_t*>(data)[index] / 32768.0;
+        case AV_SAMPLE_FMT_S32:
+            return reinterpret_cast<const int32_t*>(data)[index] / 2147483648.0;
+        case AV_SAMPLE_FMT_FLT:
+            return reinterpret_cast<const float*>(data)[index];
+        case AV_SAMPLE_FMT_DBL:
+            return reinterpret_cast<const double*>(data)[index];
+        default:
+            return 0.0;
+    }
+}
+
+KeyframeCommDetector::KeyframeCommDetector(SkipType commDetectMethod,
+                            bool showProgress, bool fullSpeed,
+                            MythCommFlagPlayer *player,
+                            const QDateTime& startedAt_in,
+                            const QDateTime& stopsAt_in,
+                            const QDateTime& recordingStartedAt_in,
+                            const QDateTime& recordingStopsAt_in):
+    ClassicCommDetector( keyframe_method(commDetectMethod),
+        showProgress,    fullSpeed,         player,
+        startedAt_in,    stopsAt_in,
+        recordingStartedAt_in,              recordingStopsAt_in)
+{
+}
+
+KeyframeCommDetector::~KeyframeCommDetector()
+{
+    CloseAudio();
+}
+
+bool KeyframeCommDetector::go()
+{
+    if (m_stillRecording)
+    {
+        LOG(VB_COMMFLAG, LOG_INFO, LOC +
+            "Recording in progress, decoding every frame instead");
+        return ClassicCommDetector::go();
+    }
+
+    if (m_player->OpenFile() < 0)
+        return false;
+
+    std::vector<long long> keyframes = m_player->GetKeyframes();
+    if (keyframes.empty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The recording has no seek table, "
+            "run mythcommflag --rebuild first.");
+        return false;
+    }
+
+    Init();
+
+    m_aggressiveDetection =
+        gCoreContext->GetBoolSetting("AggressiveCommDetect", true);
+    m_silenceLevel = gCoreContext->GetNumSetting("CommDetectSilenceLevel", -60);
+
+    if (!m_player->InitVideo())
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            "NVP: Unable to initialize video for FlagCommercials.");
+        return false;
+    }
+    m_player->EnableSubtitles(false);
+
+    if (m_commDetectMethod & COMM_DETECT_LOGO)
+        SearchForLogo();
+
+    emit breathe();
+    if (m_bStop)
+        return false;
+
+    QElapsedTimer flagTime;
+    flagTime.start();
+
+    if (m_commDetectMethod & COMM_DETECT_BLANKS)
+        OpenAudio(m_player->GetFilename());
+
+    long long myTotalFrames = m_player->GetTotalFrameCount();
+    float flagFPS = 0.0;
+    float aspect = m_player->GetVideoAspect();
+    int prevpercent = -1;
+
+    SetVideoParams(aspect);
+
+    emit breathe();
+
+    m_player->ResetTotalDuration();
+
+    if (m_showProgress)
+        std::cerr << "\r  0%/          \r" << std::flush;
+
+    Histogram histogram;
+    Histogram previousHistogram;
+    bool previousWasSceneChange = false;
+    long long previousFrame = -1;
+    long long keyframesDecoded = 0;
+    int silentBreaks = 0;
+
+    for (size_t i = 0; i < keyframes.size(); i++)
+    {
+        // The position map may list a keyframe more than once
+        if (keyframes[i] <= previousFrame)
+            continue;
+
+        MythVideoFrame* currentFrame = m_player->GetRawVideoFrame(keyframes[i]);
+        if (m_player->GetEof() != kEofStateNone)
+        {
+            m_player->DiscardVideoFrame(currentFrame);
+            break;
+        }
+
+        long long currentFrameNumber = currentFrame->m_frameNumber;
+        if (!currentFrame->m_buffer || currentFrameNumber <= previousFrame ||
+            currentFrame->m_type != FMT_YV12)
+        {
+            m_player->DiscardVideoFrame(currentFrame);
+            continue;
+        }
+
+        float newAspect = currentFrame->m_aspect;
+        if (newAspect != aspect)
+        {
+            SetVideoParams(aspect);
+            aspect = newAspect;
+        }
+
+        if ((i % 50) == 0)
+        {
+            emit breathe();
+            if (m_bStop)
+            {
+                m_player->DiscardVideoFrame(currentFrame);
+                return false;
+            }
+
+            float elapsed = flagTime.elapsed() / 1000.0;
+            flagFPS = (elapsed != 0.0F) ? currentFrameNumber / elapsed : 0.0F;
+
+            int percentage = 0;
+            if (myTotalFrames)
+                percentage = static_cast<int>(std::min(currentFrameNumber * 100 / myTotalFrames, 100LL));
+
+            if (m_showProgress)
+            {
+                QString tmp = QString("\r%1%/%2fps  \r")
+                    .arg(percentage, 3).arg((int)flagFPS, 4);
+                std::cerr << qPrintable(tmp) << std::flush;
+            }
+
+            emit statusUpdate(QCoreApplication::translate("(mythcommflag)",
+                "%1% Completed @ %2 fps.").arg(percentage).arg(flagFPS));
+
+            if (percentage % 10 == 0 && prevpercent != percentage)
+            {
+                prevpercent = percentage;
+                LOG(VB_GENERAL, LOG_INFO, QString("%1%% Completed @ %2 fps.")
+                    .arg(percentage) .arg(flagFPS));
+            }
+        }
+
+        while (m_bPaused)
+        {
+            emit breathe();
+            std::this_thread::sleep_for(1s);
+        }
+
+        // sleep a little so we don't use all cpu even if we're niced
+        if (!m_fullSpeed)
+            std::this_thread::sleep_for(10ms);
+
+        StartFrame(currentFrameNumber);
+
+        histogram.generateFromImage(currentFrame, m_width, m_height,
+            m_commDetectBorder, m_width - m_commDetectBorder,
+            m_commDetectBorder, m_height - m_commDetectBorder,
+            m_horizSpacing, m_vertSpacing);
+        float similarity = histogram.calculateSimilarityWith(previousHistogram);
+        std::swap(histogram, previousHistogram);
+
+        bool sceneChange = (previousFrame >= 0) &&
+            ClassicSceneChangeDetector::isSceneChange(similarity,
+                                                      previousWasSceneChange);
+        previousWasSceneChange = sceneChange;
+        if (m_commDetectMethod & COMM_DETECT_SCENE)
+        {
+            sceneChangeDetectorHasNewInformation(currentFrameNumber,
+                                                 sceneChange, similarity);
+        }
+
+        FrameScanEntry scan;
+        scan.frameNumber = currentFrameNumber;
+        scan.videoAspect = currentFrame->m_aspect;
+        ScanFrame(currentFrame, scan);
+
+        // A cut into silence is most likely a break the black frames of
+        // which fell between two keyframes.
+        if (scan.blankScanned && !scan.isBlank && sceneChange &&
+            IsSilent(previousFrame, currentFrameNumber))
+        {
+            scan.isBlank = true;
+            silentBreaks++;
+        }
+
+        ApplyFrameScan(scan);
+
+        if (previousFrame >= 0)
+            FillGap(previousFrame, currentFrameNumber);
+
+        m_player->DiscardVideoFrame(currentFrame);
+        previousFrame = currentFrameNumber;
+        keyframesDecoded++;
+    }
+
+    if (previousFrame < 0)
+        return false;
+
+    // Let the last keyframe stand in for the rest of the recording
+    if (myTotalFrames > previousFrame + 1)
+    {
+        StartFrame(myTotalFrames - 1);
+        FillGap(previousFrame, myTotalFrames);
+        previousFrame = myTotalFrames - 1;
+    }
+    m_framesProcessed = previousFrame + 1;
+
+    CloseAudio();
+
+    float elapsed = flagTime.elapsed() / 1000.0;
+    LOG(VB_COMMFLAG, LOG_INFO, LOC +
+        QString("Decoded %1 keyframes for %2 frames in %3s (%4 fps), "
+                "%5 blank frames, %6 of them from audio silence, "
+                "%7s of audio decoded")
+            .arg(keyframesDecoded).arg(m_framesProcessed)
+            .arg(elapsed, 0, 'f', 1)
+            .arg((elapsed != 0.0F) ? m_framesProcessed / elapsed : 0.0F, 0, 'f', 0)
+            .arg(m_blankFrameCount).arg(silentBreaks)
+            .arg(m_audioDecoded, 0, 'f', 1));
+
+    if (m_showProgress)
+    {
+        std::cerr << "\b\b\b\b\b\b      \b\b\b\b\b\b";
+        std::cerr.flush();
+    }
+
+    return true;
+}
+
+/** \brief Opens the audio track of the recording for IsSilent().
+ *
+ *   The audio is decoded straight from the file, the player used for
+ *   flagging does not decode audio at all. If the audio can't be read only
+ *   the video is used.
+ */
+bool KeyframeCommDetector::OpenAudio(const QString &filename)
+{
+    CloseAudio();
+
+    if (avformat_open_input(&m_audioFormat, filename.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+            QString("Unable to open %1 for audio, using video only")
+                .arg(filename));
+        return false;
+    }
+
+    AVCodec *codec = nullptr;
+    if (avformat_find_stream_info(m_audioFormat, nullptr) >= 0)
+    {
+        m_audioIndex = av_find_best_stream(m_audioFormat, AVMEDIA_TYPE_AUDIO,
+                                           -1, -1, &codec, 0);
+    }
+    if (m_audioIndex >= 0 && codec)
+    {
+        m_audioCodec = avcodec_alloc_context3(codec);
+        if (m_audioCodec &&
+            ((avcodec_parameters_to_context(
+                  m_audioCodec, m_audioFormat->streams[m_audioIndex]->codecpar) < 0) ||
+             (avcodec_open2(m_audioCodec, codec, nullptr) < 0)))
+        {
+            avcodec_free_context(&m_audioCodec);
+        }
+    }
+    if (!m_audioCodec)
+    {
+        LOG(VB_COMMFLAG, LOG_WARNING, LOC +
+            "No usable audio stream, using video only");
+        CloseAudio();
+        return false;
+    }
+
+    m_audioOrigin = 0.0;
+    int videoIndex = av_find_best_stream(m_audioFormat, AVMEDIA_TYPE_VIDEO,
+                                         -1, -1, nullptr, 0);
+    if (videoIndex >= 0 &&
+        m_audioFormat->streams[videoIndex]->start_time != AV_NOPTS_VALUE)
+    {
+        m_audioOrigin = m_audioFormat->streams[videoIndex]->start_time *
+            av_q2d(m_audioFormat->streams[videoIndex]->time_base);
+    }
+    else if (m_audioFormat->start_time != AV_NOPTS_VALUE)
+    {
+        m_audioOrigin = static_cast<double>(m_audioFormat->start_time) /
+            AV_TIME_BASE;
+    }
+
+    for (uint i = 0; i < m_audioFormat->nb_streams; i++)
+    {
+        if (static_cast<int>(i) != m_audioIndex)
+            m_audioFormat->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    m_audioPacket = av_packet_alloc();
+    m_audioFrame = av_frame_alloc();
+    m_audioDecoded = 0.0;
+    return true;
+}
+
+void KeyframeCommDetector::CloseAudio(void)
+{
+    av_frame_free(&m_audioFrame);
+    av_packet_free(&m_audioPacket);
+    avcodec_free_context(&m_audioCodec);
+    avformat_close_input(&m_audioFormat);
+    m_audioIndex = -1;
+}
+
+/** \brief Returns true if there is a kAudioBucket long silent interval
+ *         between the two frames.
+ *
+ *   Seeks the audio track to the first frame and decodes only up to the
+ *   second one.
+ */
+bool KeyframeCommDetector::IsSilent(long long fromFrame, long long toFrame)
+{
+    if (!m_audioCodec || m_fps <= 0.0 || fromFrame < 0 || toFrame <= fromFrame)
+        return false;
+
+    double from = fromFrame / m_fps;
+    double to = toFrame / m_fps;
+    double bucketLength = kAudioBucket / 1000.0;
+    auto buckets = static_cast<size_t>(std::ceil((to - from) / bucketLength));
+    std::vector<double> power(buckets, 0.0);
+    std::vector<int> samples(buckets, 0);
+
+    // Start a little early, the decoder may need a frame or two to settle
+    double timebase = av_q2d(m_audioFormat->streams[m_audioIndex]->time_base);
+    auto seekTo = static_cast<int64_t>(
+        (std::max(from - kAudioPreroll, 0.0) + m_audioOrigin) / timebase);
+    if (av_seek_frame(m_audioFormat, m_audioIndex, seekTo,
+                      AVSEEK_FLAG_BACKWARD) < 0)
+    {
+        return false;
+    }
+    avcodec_flush_buffers(m_audioCodec);
+
+    bool done = false;
+    double nextTime = -1.0;
+    auto add_frame = [&](const AVFrame *frame)
+    {
+        if (frame->sample_rate <= 0 || frame->channels <= 0)
+            return;
+
+        double start = nextTime;
+        if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+            start = (frame->best_effort_timestamp * timebase) - m_audioOrigin;
+        if (start < 0.0 && nextTime < 0.0)
+            return;
+        nextTime = start + (static_cast<double>(frame->nb_samples) /
+                            frame->sample_rate);
+        m_audioDecoded += static_cast<double>(frame->nb_samples) /
+            frame->sample_rate;
+
+        for (int s = 0; s < frame->nb_samples; s++)
+        {
+            double time = start + (static_cast<double>(s) / frame->sample_rate);
+            if (time < from)
+                continue;
+            auto bucket = static_cast<size_t>((time - from) / bucketLength);
+            if (time >= to || bucket >= buckets)
+            {
+                done = true;
+                return;
+            }
+
+            double square = 0.0;
+            for (int c = 0; c < frame->channels; c++)
+            {
+                double value = get_sample(frame, c, s);
+                square += value * value;
+            }
+            power[bucket] += square / frame->channels;
+            samples[bucket]++;
+        }
+    };
+
+    while (!done && !m_bStop && av_read_frame(m_audioFormat, m_audioPacket) >= 0)
+    {
+        if (m_audioPacket->stream_index == m_audioIndex &&
+            avcodec_send_packet(m_audioCodec, m_audioPacket) >= 0)
+        {
+            while (avcodec_receive_frame(m_audioCodec, m_audioFrame) == 0)
+            {
+                if (!done)
+                    add_frame(m_audioFrame);
+                av_frame_unref(m_audioFrame);
+            }
+        }
+        av_packet_unref(m_audioPacket);
+    }
+
+    for (size_t i = 0; i < buckets; i++)
+    {
+        // Intervals without any audio must not look like silence
+        if (samples[i] == 0)
+            continue;
+        double meanSquare = power[i] / samples[i];
+        float level = (meanSquare > 0.0) ?
+            std::max(static_cast<float>(10.0 * log10(meanSquare)), kAudioFloor) :
+            kAudioFloor;
+        if (level < m_silenceLevel)
+            return true;
+    }
+    return false;
+}
+
+/** \brief Gives the frames between two decoded keyframes the measurements
+ *         of the first one.
+ *
+ *   Events that belong to a single frame, like blank frames and scene
+ *   changes, are not copied.
+ */
+void KeyframeCommDetector::FillGap(long long fromFrame, long long toFrame)
+{
+    FrameInfoEntry fill = m_frameInfo[fromFrame];
+    fill.flagMask &= ~(COMM_FRAME_BLANK | COMM_FRAME_SCENE_CHANGE |
+                       COMM_FRAME_ASPECT_CHANGE);
+    fill.flagMask |= COMM_FRAME_SKIPPED;
+    fill.sceneChangePercent = -1;
+
+    for (long long frame = fromFrame + 1; frame < toFrame; frame++)
+        m_frameInfo[frame] = fill;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,67 @@
+#ifndef KEYFRAMECOMMDETECTOR_H
+#define KEYFRAMECOMMDETECTOR_H
+
+// Commercial Flagging headers
+#include "ClassicCommDetector.h"
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+
+/** \class KeyframeCommDetector
+ *  \brief A fast variant of ClassicCommDetector that only decodes keyframes.
+ *
+ *   The recording is stepped through keyframe by keyframe using the position
+ *   map, so the frames in between are neither read nor decoded. Each
+ *   keyframe's measurements stand in for the frames up to the next keyframe.
+ *   Since short runs of black frames between keyframes are missed, the audio
+ *   between two keyframes is checked for silence when the second one is a
+ *   scene change: a scene change that follows a silent stretch is treated
+ *   like a blank frame. Only the audio around those keyframes is decoded.
+ *
+ *   This needs a finished recording with a position map. While the
+ *   recording is still in progress it falls back to the classic, frame by
+ *   frame, detector.
+ *
+ *   Given only COMM_DETECT_KEYFRAME it uses all of blank frame, scene change
+ *   and logo detection, as COMM_DETECT_KEYFRAME_ALL does.
+ */
+class KeyframeCommDetector : public ClassicCommDetector
+{
+  public:
+    KeyframeCommDetector(SkipType commDetectMethod, bool showProgress,
+                         bool fullSpeed, MythCommFlagPlayer* player,
+                         const QDateTime& startedAt_in,
+                         const QDateTime& stopsAt_in,
+                         const QDateTime& recordingStartedAt_in,
+                         const QDateTime& recordingStopsAt_in);
+
+    bool go() override; // ClassicCommDetector
+
+  protected:
+    ~KeyframeCommDetector() override;
+
+  private:
+    bool OpenAudio(const QString &filename);
+    void CloseAudio(void);
+    bool IsSilent(long long fromFrame, long long toFrame);
+    void FillGap(long long fromFrame, long long toFrame);
+
+    AVFormatContext *m_audioFormat  {nullptr};
+    AVCodecContext  *m_audioCodec   {nullptr};
+    AVPacket        *m_audioPacket  {nullptr};
+    AVFrame         *m_audioFrame   {nullptr};
+    int              m_audioIndex   {-1};
+    /// Time of the first video frame in seconds, audio time is measured
+    /// from there as frame numbers are.
+    double           m_audioOrigin  {0.0};
+    /// Seconds of audio decoded, for comparing with the length of the
+    /// recording.
+    double           m_audioDecoded {0.0};
+    float            m_silenceLevel {-60.0F};
+};
+
+#endif // KEYFRAMECOMMDETECTOR_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -19,6 +19,7 @@
 #include "CommDetector2.h"
 #include "FrameAnalyzer.h"
 #include "pgm.h"
+#include "pgmkernels.h"
 #include "PGMConverter.h"
 #include "EdgeDetector.h"
 #include "BlankFrameDetector.h"
@@ -39,11 +40,7 @@ int pgm_set(const AVFrame *pict, int height)
     const int   width = pict->linesize[0];
     const int   size = height * width;
 
-    int score = 0;
-    for (int ii = 0; ii < size; ii++)
-        if (pict->data[0][ii])
-            score++;
-    return score;
+    return pgmKernels::count_set(pict->data[0], size);
 }
 
 int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
@@ -60,6 +57,14 @@ int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
         return -1;
     }
 
+    if (radius == 0)
+    {
+        /* Exact matches only: pixel-for-pixel comparison. */
+        *pscore = pgmKernels::count_match(tmpl->data[0], test->data[0],
+                height * width);
+        return 0;
+    }
+
     int score = 0;
     for (int rr = 0; rr < height; rr++)
     {
@@ -69,10 +74,10 @@ int pgm_match(const AVFrame *tmpl, const AVFrame *test, int height,
                 continue;
 
             int r2min = std::max(0, rr - radius);
-            int r2max = std::min(height, rr + radius);
+            int r2max = std::min(height - 1, rr + radius);
 
             int c2min = std::max(0, cc - radius);
-            int c2max = std::min(width, cc + radius);
+            int c2max = std::min(width - 1, cc + radius);
 
             for (int r2 = r2min; r2 <= r2max; r2++)
             {
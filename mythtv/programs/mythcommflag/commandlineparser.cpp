@@ -59,7 +59,7 @@ void MythCommFlagCommandLineParser::LoadArguments(void)
     add("--method", "commmethod", "",
         "Commercial flagging method[s] to employ:\n"
         "off, blank, scene, blankscene, logo, all, "
-        "d2, d2_logo, d2_blank, d2_scene, d2_all", "")
+        "d2, d2_logo, d2_blank, d2_scene, d2_all, keyframe, kf_all", "")
             ->SetGroup("Commflagging");
     add("--outputmethod", "outputmethod", "",
         "Format of output written to outputfile, essentials, full.", "")
@@ -104,6 +104,8 @@ static QMap<QString,SkipType> *init_skip_types(void)
     (*tmp)["d2_blank"]    = COMM_DETECT_2_BLANK;
     (*tmp)["d2_scene"]    = COMM_DETECT_2_SCENE;
     (*tmp)["d2_all"]      = COMM_DETECT_2_ALL;
+    (*tmp)["keyframe"]    = COMM_DETECT_KEYFRAME;
+    (*tmp)["kf_all"]      = COMM_DETECT_KEYFRAME_ALL;
     return tmp;
 }
 
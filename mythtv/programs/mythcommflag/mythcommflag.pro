@@ -11,15 +11,19 @@ INSTALLS = target
 
 QMAKE_CLEAN += $(TARGET)
 
+# The SIMD kernels in pgmkernels.cpp must round exactly like their scalar
+# reference versions; keep the compiler from fusing multiplies and adds.
+!win32-msvc*:QMAKE_CXXFLAGS += -ffp-contract=off
+
 # Input
 HEADERS += CommDetectorFactory.h CommDetectorBase.h
 HEADERS += ClassicLogoDetector.h
 HEADERS += ClassicSceneChangeDetector.h
-HEADERS += ClassicCommDetector.h
+HEADERS += ClassicCommDetector.h FrameScan.h
 HEADERS += Histogram.h
 HEADERS += quickselect.h
 HEADERS += CommDetector2.h
-HEADERS += pgm.h
+HEADERS += pgm.h pgmkernels.h
 HEADERS += EdgeDetector.h CannyEdgeDetector.h
 HEADERS += PGMConverter.h BorderDetector.h
 HEADERS += FrameAnalyzer.h
@@ -28,6 +32,7 @@ HEADERS += HistogramAnalyzer.h
 HEADERS += BlankFrameDetector.h
 HEADERS += SceneChangeDetector.h
 HEADERS += PrePostRollFlagger.h
+HEADERS += KeyframeCommDetector.h
 
 HEADERS += LogoDetectorBase.h SceneChangeDetectorBase.h
 HEADERS += SlotRelayer.h CustomEventRelayer.h
@@ -36,11 +41,11 @@ HEADERS += commandlineparser.h
 SOURCES += CommDetectorFactory.cpp CommDetectorBase.cpp
 SOURCES += ClassicLogoDetector.cpp
 SOURCES += ClassicSceneChangeDetector.cpp
-SOURCES += ClassicCommDetector.cpp
+SOURCES += ClassicCommDetector.cpp FrameScan.cpp
 SOURCES += Histogram.cpp
 SOURCES += quickselect.cpp
 SOURCES += CommDetector2.cpp
-SOURCES += pgm.cpp
+SOURCES += pgm.cpp pgmkernels.cpp
 SOURCES += EdgeDetector.cpp CannyEdgeDetector.cpp
 SOURCES += PGMConverter.cpp BorderDetector.cpp
 SOURCES += FrameAnalyzer.cpp
@@ -49,6 +54,7 @@ SOURCES += HistogramAnalyzer.cpp
 SOURCES += BlankFrameDetector.cpp
 SOURCES += SceneChangeDetector.cpp
 SOURCES += PrePostRollFlagger.cpp
+SOURCES += KeyframeCommDetector.cpp
 
 SOURCES += main.cpp commandlineparser.cpp
 
@@ -9,6 +9,7 @@ extern "C" {
 #include "mythframe.h"
 #include "mythlogging.h"
 #include "pgm.h"
+#include "pgmkernels.h"
 
 // TODO: verify this
 /*
@@ -257,34 +258,19 @@ int pgm_convolve_radial(AVFrame *dst, AVFrame *s1, AVFrame *s2,
 
     /* "s1" convolve with column vector => "s2" */
     int rr2 = mask_radius + srcheight;
-    int cc2 = mask_radius + srcwidth;
     for (int rr = mask_radius; rr < rr2; rr++)
     {
-        for (int cc = mask_radius; cc < cc2; cc++)
-        {
-            double sum = 0;
-            for (int ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s1->data[0][(rr + ii) * newwidth + cc];
-            }
-            s2->data[0][rr * newwidth + cc] = lround(sum);
-        }
+        pgmKernels::convolve_col(&s2->data[0][rr * newwidth + mask_radius],
+                &s1->data[0][(rr - mask_radius) * newwidth + mask_radius],
+                newwidth, srcwidth, mask, mask_radius);
     }
 
     /* "s2" convolve with row vector => "dst" */
     for (int rr = mask_radius; rr < rr2; rr++)
     {
-        for (int cc = mask_radius; cc < cc2; cc++)
-        {
-            double sum = 0;
-            for (int ii = -mask_radius; ii <= mask_radius; ii++)
-            {
-                sum += mask[ii + mask_radius] *
-                    s2->data[0][rr * newwidth + cc + ii];
-            }
-            dst->data[0][rr * newwidth + cc] = lround(sum);
-        }
+        pgmKernels::convolve_row(&dst->data[0][rr * newwidth + mask_radius],
+                &s2->data[0][rr * newwidth + mask_radius],
+                srcwidth, mask, mask_radius);
     }
 
     return 0;
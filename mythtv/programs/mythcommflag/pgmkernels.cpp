@@ -0,0 +1,502 @@
+// ANSI C headers
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// C++ headers
+#include <algorithm>
+#include <array>
+
+#include "mythconfig.h"
+
+// Commercial Flagging headers
+#include "pgmkernels.h"
+
+/*
+ * The convolution kernels accumulate in double precision, exactly like the
+ * reference implementations, so that the vectorized versions stay
+ * bit-identical. This requires 2-wide double vectors, which NEON only has on
+ * AArch64.
+ */
+#if (HAVE_SSE2 && ARCH_X86_64)
+extern "C" {
+#include "libavutil/x86/cpu.h"
+}
+#include <emmintrin.h>
+static const bool s_haveSIMD = av_get_cpu_flags() & AV_CPU_FLAG_SSE2;
+#define PGMK_SIMD_DOUBLE 1
+#elif HAVE_INTRINSICS_NEON
+extern "C" {
+#if ARCH_AARCH64
+#include "libavutil/aarch64/cpu.h"
+#elif ARCH_ARM
+#include "libavutil/arm/cpu.h"
+#endif
+}
+#include <arm_neon.h>
+static const bool s_haveSIMD = have_neon(av_get_cpu_flags());
+#define PGMK_SIMD_DOUBLE ARCH_AARCH64
+#else
+static const bool s_haveSIMD = false;
+#define PGMK_SIMD_DOUBLE 0
+#endif
+
+namespace pgmKernels {
+
+bool
+have_simd(void)
+{
+    return s_haveSIMD;
+}
+
+/* Convolution. */
+
+void
+convolve_col_c(unsigned char *dst, const unsigned char *src, int stride,
+        int width, const double *mask, int radius)
+{
+    const int masksize = 2 * radius + 1;
+    for (int cc = 0; cc < width; cc++)
+    {
+        double sum = 0;
+        for (int ii = 0; ii < masksize; ii++)
+            sum += mask[ii] * src[ii * stride + cc];
+        dst[cc] = static_cast<unsigned char>(lround(sum));
+    }
+}
+
+void
+convolve_row_c(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius)
+{
+    const int masksize = 2 * radius + 1;
+    for (int cc = 0; cc < width; cc++)
+    {
+        double sum = 0;
+        for (int ii = 0; ii < masksize; ii++)
+            sum += mask[ii] * src[cc + ii - radius];
+        dst[cc] = static_cast<unsigned char>(lround(sum));
+    }
+}
+
+#if PGMK_SIMD_DOUBLE
+/*
+ * Eight pixels per pass, one double-precision accumulator per pixel. The
+ * multiply and add are kept as separate operations in the same order as the
+ * scalar loop (no fused multiply-add), and the final rounding is done with
+ * lround(), so the results match convolve_col_c/convolve_row_c exactly.
+ */
+static inline void
+convolve8(unsigned char *dst, const unsigned char *src, int step,
+        const double *mask, int masksize)
+{
+    std::array<double,8> sums {};
+#if (HAVE_SSE2 && ARCH_X86_64)
+    const __m128i zero = _mm_setzero_si128();
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+    for (int ii = 0; ii < masksize; ii++)
+    {
+        const __m128d mm = _mm_set1_pd(mask[ii]);
+        __m128i px = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                reinterpret_cast<const __m128i*>(&src[ii * step])), zero);
+        __m128i lo = _mm_unpacklo_epi16(px, zero);
+        __m128i hi = _mm_unpackhi_epi16(px, zero);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(mm, _mm_cvtepi32_pd(lo)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(mm,
+                _mm_cvtepi32_pd(_mm_srli_si128(lo, 8))));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(mm, _mm_cvtepi32_pd(hi)));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(mm,
+                _mm_cvtepi32_pd(_mm_srli_si128(hi, 8))));
+    }
+    _mm_storeu_pd(&sums[0], acc0);
+    _mm_storeu_pd(&sums[2], acc1);
+    _mm_storeu_pd(&sums[4], acc2);
+    _mm_storeu_pd(&sums[6], acc3);
+#else
+    float64x2_t acc0 = vdupq_n_f64(0);
+    float64x2_t acc1 = vdupq_n_f64(0);
+    float64x2_t acc2 = vdupq_n_f64(0);
+    float64x2_t acc3 = vdupq_n_f64(0);
+    for (int ii = 0; ii < masksize; ii++)
+    {
+        const float64x2_t mm = vdupq_n_f64(mask[ii]);
+        uint16x8_t px = vmovl_u8(vld1_u8(&src[ii * step]));
+        uint32x4_t lo = vmovl_u16(vget_low_u16(px));
+        uint32x4_t hi = vmovl_u16(vget_high_u16(px));
+        acc0 = vaddq_f64(acc0, vmulq_f64(mm,
+                vcvtq_f64_u64(vmovl_u32(vget_low_u32(lo)))));
+        acc1 = vaddq_f64(acc1, vmulq_f64(mm,
+                vcvtq_f64_u64(vmovl_u32(vget_high_u32(lo)))));
+        acc2 = vaddq_f64(acc2, vmulq_f64(mm,
+                vcvtq_f64_u64(vmovl_u32(vget_low_u32(hi)))));
+        acc3 = vaddq_f64(acc3, vmulq_f64(mm,
+                vcvtq_f64_u64(vmovl_u32(vget_high_u32(hi)))));
+    }
+    vst1q_f64(&sums[0], acc0);
+    vst1q_f64(&sums[2], acc1);
+    vst1q_f64(&sums[4], acc2);
+    vst1q_f64(&sums[6], acc3);
+#endif
+    for (size_t kk = 0; kk < sums.size(); kk++)
+        dst[kk] = static_cast<unsigned char>(lround(sums[kk]));
+}
+#endif /* PGMK_SIMD_DOUBLE */
+
+void
+convolve_col(unsigned char *dst, const unsigned char *src, int stride,
+        int width, const double *mask, int radius)
+{
+    int cc = 0;
+#if PGMK_SIMD_DOUBLE
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 8 <= width; cc += 8)
+            convolve8(&dst[cc], &src[cc], stride, mask, 2 * radius + 1);
+    }
+#endif
+    convolve_col_c(&dst[cc], &src[cc], stride, width - cc, mask, radius);
+}
+
+void
+convolve_row(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius)
+{
+    int cc = 0;
+#if PGMK_SIMD_DOUBLE
+    /*
+     * Walking the row vector over eight adjacent output pixels is the same
+     * as walking a column vector with a stride of one.
+     */
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 8 <= width; cc += 8)
+            convolve8(&dst[cc], &src[cc - radius], 1, mask, 2 * radius + 1);
+    }
+#endif
+    convolve_row_c(&dst[cc], &src[cc], width - cc, mask, radius);
+}
+
+/* Squared Gradient Magnitude. */
+
+void
+sgm_row_c(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int width)
+{
+    for (int cc = 0; cc < width; cc++)
+    {
+        int dx = rr1[cc + 1] - rr0[cc];     /* southeast - northwest */
+        int dy = rr1[cc] - rr0[cc + 1];     /* southwest - northeast */
+        sgm[cc] = dx * dx + dy * dy;
+    }
+}
+
+void
+sgm_row(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int width)
+{
+    int cc = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (s_haveSIMD)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for ( ; cc + 8 <= width; cc += 8)
+        {
+            __m128i nw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(&rr0[cc])), zero);
+            __m128i ne = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(&rr0[cc + 1])), zero);
+            __m128i sw = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(&rr1[cc])), zero);
+            __m128i se = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(&rr1[cc + 1])), zero);
+            __m128i dx = _mm_sub_epi16(se, nw);
+            __m128i dy = _mm_sub_epi16(sw, ne);
+            /* Interleave (dx, dy) pairs so that madd yields dx^2 + dy^2. */
+            __m128i lo = _mm_unpacklo_epi16(dx, dy);
+            __m128i hi = _mm_unpackhi_epi16(dx, dy);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&sgm[cc]),
+                    _mm_madd_epi16(lo, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&sgm[cc + 4]),
+                    _mm_madd_epi16(hi, hi));
+        }
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        for ( ; cc + 8 <= width; cc += 8)
+        {
+            int16x8_t dx = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(&rr1[cc + 1]), vld1_u8(&rr0[cc])));
+            int16x8_t dy = vreinterpretq_s16_u16(
+                    vsubl_u8(vld1_u8(&rr1[cc]), vld1_u8(&rr0[cc + 1])));
+            int32x4_t lo = vmlal_s16(
+                    vmull_s16(vget_low_s16(dx), vget_low_s16(dx)),
+                    vget_low_s16(dy), vget_low_s16(dy));
+            int32x4_t hi = vmlal_s16(
+                    vmull_s16(vget_high_s16(dx), vget_high_s16(dx)),
+                    vget_high_s16(dy), vget_high_s16(dy));
+            vst1q_u32(&sgm[cc], vreinterpretq_u32_s32(lo));
+            vst1q_u32(&sgm[cc + 4], vreinterpretq_u32_s32(hi));
+        }
+    }
+#endif
+    sgm_row_c(&sgm[cc], &rr0[cc], &rr1[cc], width - cc);
+}
+
+/* Pixel counting. */
+
+int
+count_set_c(const unsigned char *buf, int size)
+{
+    int score = 0;
+    for (int ii = 0; ii < size; ii++)
+        if (buf[ii])
+            score++;
+    return score;
+}
+
+int
+count_match_c(const unsigned char *aa, const unsigned char *bb, int size)
+{
+    int score = 0;
+    for (int ii = 0; ii < size; ii++)
+        if (aa[ii] && bb[ii])
+            score++;
+    return score;
+}
+
+#if (HAVE_SSE2 && ARCH_X86_64)
+/* Sum the bytes (each zero or one) of "ones" into the 64-bit lanes of "acc". */
+static inline __m128i
+accumulate_ones(__m128i acc, __m128i ones)
+{
+    return _mm_add_epi64(acc, _mm_sad_epu8(ones, _mm_setzero_si128()));
+}
+
+static inline int
+horizontal_sum(__m128i acc)
+{
+    return _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+}
+#elif HAVE_INTRINSICS_NEON
+static inline uint32x4_t
+accumulate_ones(uint32x4_t acc, uint8x16_t ones)
+{
+    return vpadalq_u16(acc, vpaddlq_u8(ones));
+}
+
+static inline int
+horizontal_sum(uint32x4_t acc)
+{
+    return vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) +
+        vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+}
+#endif
+
+int
+count_set(const unsigned char *buf, int size)
+{
+    int ii = 0;
+    int score = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (s_haveSIMD)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i acc = _mm_setzero_si128();
+        for ( ; ii + 16 <= size; ii += 16)
+        {
+            __m128i px = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(&buf[ii]));
+            acc = accumulate_ones(acc,
+                    _mm_andnot_si128(_mm_cmpeq_epi8(px, zero), one));
+        }
+        score = horizontal_sum(acc);
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        uint32x4_t acc = vdupq_n_u32(0);
+        for ( ; ii + 16 <= size; ii += 16)
+        {
+            uint8x16_t px = vld1q_u8(&buf[ii]);
+            acc = accumulate_ones(acc, vshrq_n_u8(vtstq_u8(px, px), 7));
+        }
+        score = horizontal_sum(acc);
+    }
+#endif
+    return score + count_set_c(&buf[ii], size - ii);
+}
+
+int
+count_match(const unsigned char *aa, const unsigned char *bb, int size)
+{
+    int ii = 0;
+    int score = 0;
+#if (HAVE_SSE2 && ARCH_X86_64)
+    if (s_haveSIMD)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        __m128i acc = _mm_setzero_si128();
+        for ( ; ii + 16 <= size; ii += 16)
+        {
+            __m128i pa = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(&aa[ii]));
+            __m128i pb = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(&bb[ii]));
+            __m128i unset = _mm_or_si128(_mm_cmpeq_epi8(pa, zero),
+                    _mm_cmpeq_epi8(pb, zero));
+            acc = accumulate_ones(acc, _mm_andnot_si128(unset, one));
+        }
+        score = horizontal_sum(acc);
+    }
+#elif HAVE_INTRINSICS_NEON
+    if (s_haveSIMD)
+    {
+        uint32x4_t acc = vdupq_n_u32(0);
+        for ( ; ii + 16 <= size; ii += 16)
+        {
+            uint8x16_t pa = vld1q_u8(&aa[ii]);
+            uint8x16_t pb = vld1q_u8(&bb[ii]);
+            uint8x16_t set = vandq_u8(vtstq_u8(pa, pa), vtstq_u8(pb, pb));
+            acc = accumulate_ones(acc, vshrq_n_u8(set, 7));
+        }
+        score = horizontal_sum(acc);
+    }
+#endif
+    return score + count_match_c(&aa[ii], &bb[ii], size - ii);
+}
+
+/* Border scanning. */
+
+int
+inrange_span_c(const unsigned char *buf, int size,
+        unsigned char *minval, unsigned char *maxval, int maxrange)
+{
+    unsigned char lo = *minval;
+    unsigned char hi = *maxval;
+    int ii = 0;
+    for ( ; ii < size; ii++)
+    {
+        unsigned char val = buf[ii];
+        if (std::max(hi, val) - std::min(lo, val) + 1 > maxrange)
+            break;
+        lo = std::min(lo, val);
+        hi = std::max(hi, val);
+    }
+    *minval = lo;
+    *maxval = hi;
+    return ii;
+}
+
+int
+inrange_span(const unsigned char *buf, int size,
+        unsigned char *minval, unsigned char *maxval, int maxrange)
+{
+    int ii = 0;
+#if (HAVE_SSE2 && ARCH_X86_64) || HAVE_INTRINSICS_NEON
+    /*
+     * The running range only ever grows, so if a whole block of 16 pixels
+     * fits in the range, each of them would have been accepted one at a
+     * time too. The first block that does not fit is handed to the scalar
+     * loop to find the exact pixel that breaks the range.
+     */
+    if (s_haveSIMD)
+    {
+        for ( ; ii + 16 <= size; ii += 16)
+        {
+#if (HAVE_SSE2 && ARCH_X86_64)
+            __m128i px = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(&buf[ii]));
+            __m128i vmin = _mm_min_epu8(px, _mm_srli_si128(px, 8));
+            __m128i vmax = _mm_max_epu8(px, _mm_srli_si128(px, 8));
+            vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 4));
+            vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+            vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 2));
+            vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+            vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 1));
+            vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+            auto blockmin = static_cast<unsigned char>(_mm_cvtsi128_si32(vmin));
+            auto blockmax = static_cast<unsigned char>(_mm_cvtsi128_si32(vmax));
+#else
+            uint8x16_t px = vld1q_u8(&buf[ii]);
+            uint8x8_t vmin = vmin_u8(vget_low_u8(px), vget_high_u8(px));
+            uint8x8_t vmax = vmax_u8(vget_low_u8(px), vget_high_u8(px));
+            vmin = vpmin_u8(vmin, vmin);
+            vmax = vpmax_u8(vmax, vmax);
+            vmin = vpmin_u8(vmin, vmin);
+            vmax = vpmax_u8(vmax, vmax);
+            vmin = vpmin_u8(vmin, vmin);
+            vmax = vpmax_u8(vmax, vmax);
+            unsigned char blockmin = vget_lane_u8(vmin, 0);
+            unsigned char blockmax = vget_lane_u8(vmax, 0);
+#endif
+            unsigned char lo = std::min(*minval, blockmin);
+            unsigned char hi = std::max(*maxval, blockmax);
+            if (hi - lo + 1 > maxrange)
+                break;
+            *minval = lo;
+            *maxval = hi;
+        }
+    }
+#endif
+    return ii + inrange_span_c(&buf[ii], size - ii, minval, maxval, maxrange);
+}
+
+/* Histograms. */
+
+int
+histogram_add_c(int *counts, const unsigned char *buf, int stride,
+        int x0, int x1, int xstep, int y0, int y1, int ystep)
+{
+    int nn = 0;
+    for (int yy = y0; yy < y1; yy += ystep)
+    {
+        for (int xx = x0; xx < x1; xx += xstep)
+        {
+            counts[buf[yy * stride + xx]]++;
+            nn++;
+        }
+    }
+    return nn;
+}
+
+int
+histogram_add(int *counts, const unsigned char *buf, int stride,
+        int x0, int x1, int xstep, int y0, int y1, int ystep)
+{
+    /*
+     * A histogram update is a scatter, which SSE2 and NEON can not do.
+     * Instead, count into four independent tables so that runs of
+     * identical pixels (dark frames, letterbox bars) do not serialize on
+     * the same counter, and merge the tables at the end.
+     */
+    std::array<std::array<int,256>,4> banks {};
+    int nn = 0;
+    for (int yy = y0; yy < y1; yy += ystep)
+    {
+        const unsigned char *row = &buf[yy * stride];
+        int xx = x0;
+        for ( ; xx + 3 * xstep < x1; xx += 4 * xstep, nn += 4)
+        {
+            banks[0][row[xx]]++;
+            banks[1][row[xx + xstep]]++;
+            banks[2][row[xx + 2 * xstep]]++;
+            banks[3][row[xx + 3 * xstep]]++;
+        }
+        for ( ; xx < x1; xx += xstep, nn++)
+            banks[0][row[xx]]++;
+    }
+    for (size_t val = 0; val < banks[0].size(); val++)
+        counts[val] += banks[0][val] + banks[1][val] + banks[2][val] +
+            banks[3][val];
+    return nn;
+}
+
+};  /* namespace */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,84 @@
+/*
+ * pgmkernels.h
+ *
+ * Inner loops of the commercial flagging frame analyzers.
+ *
+ * Each kernel has a plain C reference implementation (the "_c" variant) and a
+ * dispatching variant that uses SSE2 or NEON where the CPU supports it. The
+ * vectorized code paths are required to produce results bit-identical to the
+ * reference implementations; the unit tests in test/test_pgmkernels enforce
+ * this.
+ */
+
+#ifndef PGMKERNELS_H
+#define PGMKERNELS_H
+
+namespace pgmKernels {
+
+/* True if the dispatching kernels will use a SIMD code path. */
+bool have_simd(void);
+
+/*
+ * Convolve "width" pixels with a column vector of 2 * radius + 1 entries.
+ * "src" points at the top of the mask window (mask[0] is applied to src[0]),
+ * and successive mask entries are applied "stride" bytes apart.
+ */
+void convolve_col_c(unsigned char *dst, const unsigned char *src, int stride,
+        int width, const double *mask, int radius);
+void convolve_col(unsigned char *dst, const unsigned char *src, int stride,
+        int width, const double *mask, int radius);
+
+/*
+ * Convolve "width" pixels with a row vector of 2 * radius + 1 entries,
+ * centered on each pixel. "src" must have "radius" readable pixels on either
+ * side.
+ */
+void convolve_row_c(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius);
+void convolve_row(unsigned char *dst, const unsigned char *src, int width,
+        const double *mask, int radius);
+
+/*
+ * Squared Gradient Magnitude of "width" pixels of row "rr0", using the
+ * 45-degree rotated axes formed with the row below it ("rr1"). Both rows must
+ * have width + 1 readable pixels.
+ */
+void sgm_row_c(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int width);
+void sgm_row(unsigned int *sgm, const unsigned char *rr0,
+        const unsigned char *rr1, int width);
+
+/* Number of non-zero pixels. */
+int count_set_c(const unsigned char *buf, int size);
+int count_set(const unsigned char *buf, int size);
+
+/* Number of pixels that are non-zero in both "aa" and "bb". */
+int count_match_c(const unsigned char *aa, const unsigned char *bb, int size);
+int count_match(const unsigned char *aa, const unsigned char *bb, int size);
+
+/*
+ * Number of leading pixels of "buf" that can be folded into the running
+ * [*minval, *maxval] range one at a time without the range spanning more
+ * than "maxrange" values. "*minval" and "*maxval" are updated to include the
+ * accepted pixels.
+ */
+int inrange_span_c(const unsigned char *buf, int size,
+        unsigned char *minval, unsigned char *maxval, int maxrange);
+int inrange_span(const unsigned char *buf, int size,
+        unsigned char *minval, unsigned char *maxval, int maxrange);
+
+/*
+ * Add every "xstep"th pixel of every "ystep"th row of the area
+ * [x0, x1) x [y0, y1) of "buf" to the 256-entry histogram "counts". Returns
+ * the number of pixels added.
+ */
+int histogram_add_c(int *counts, const unsigned char *buf, int stride,
+        int x0, int x1, int xstep, int y0, int y1, int ystep);
+int histogram_add(int *counts, const unsigned char *buf, int stride,
+        int x0, int x1, int xstep, int y0, int y1, int ystep);
+
+};  /* namespace */
+
+#endif  /* !PGMKERNELS_H */
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,189 @@
+/*
+ *  Class TestFrameScan
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "FrameScan.h"
+#include "test_framescan.h"
+
+/*
+ * A pretend recording, "decoded" the way the segmented mode of
+ * ClassicCommDetector decodes it: each worker starts on the frame before
+ * its segment, so that the scene similarity of its first frame is taken
+ * against the same previous frame as in a serial scan.
+ */
+
+static constexpr long long kFrames { 3000 };
+
+// Picture content, in scenes of 97 frames with black frames between them
+static int content(long long frame)
+{
+    if (frame % 97 < 3)
+        return 2;
+    return static_cast<int>(((frame / 97) * 37 + (frame % 5)) % 200) + 20;
+}
+
+// Frames the decoder never returns, serially or after a seek
+static bool dropped(long long frame)
+{
+    return frame == 1000 || frame == 2222;
+}
+
+static FrameScanEntry scan_frame(long long number, int value, bool havePrevious,
+                                 int previous)
+{
+    FrameScanEntry scan;
+    scan.frameNumber     = number;
+    scan.videoAspect     = 1.78F;
+    scan.blankScanned    = true;
+    scan.minBrightness   = value / 2;
+    scan.maxBrightness   = value;
+    scan.avgBrightness   = (value * 3) / 4;
+    scan.isBlank         = value < 10;
+    scan.logoPresent     = !scan.isBlank && (number / 300) % 2 == 0;
+    scan.sceneSimilarity = havePrevious ?
+        1.0F - (static_cast<float>(std::abs(value - previous)) / 255.0F) : 0.0F;
+    return scan;
+}
+
+// One worker; offset renumbers the frames it decodes after its seek
+static FrameScanSegment scan_segment(long long start, long long end,
+                                     long long offset = 0)
+{
+    FrameScanSegment segment(start, end);
+    bool havePrevious = false;
+    int previous = 0;
+
+    for (long long frame = std::max(start - 1, 0LL); frame < kFrames; frame++)
+    {
+        if (dropped(frame))
+            continue;
+        long long number = (frame >= start) ? frame + offset : frame;
+        FrameScanEntry scan = scan_frame(number, content(frame),
+                                         havePrevious, previous);
+        havePrevious = true;
+        previous = content(frame);
+        if (!segment.Add(scan))
+            break;
+    }
+
+    return segment;
+}
+
+static bool merge(const std::vector<FrameScanSegment> &segments,
+                  FrameScanList &merged, long long &badFrame)
+{
+    std::vector<const FrameScanSegment*> results;
+    results.reserve(segments.size());
+    for (const auto &segment : segments)
+        results.push_back(&segment);
+    return MergeFrameScans(results, merged, badFrame);
+}
+
+void TestFrameScan::test_serial_equivalence_data(void)
+{
+    QTest::addColumn<QList<long long>>("starts");
+    QTest::newRow("one") << QList<long long> { 0 };
+    QTest::newRow("two") << QList<long long> { 0, 1500 };
+    QTest::newRow("four") << QList<long long> { 0, 744, 1500, 2244 };
+    QTest::newRow("at a dropped frame") << QList<long long> { 0, 1000, 2000 };
+}
+
+// The joined segments are exactly what a serial scan gives
+void TestFrameScan::test_serial_equivalence(void)
+{
+    QFETCH(QList<long long>, starts);
+
+    FrameScanList serial = scan_segment(0, -1).scans;
+    QCOMPARE(static_cast<long long>(serial.size()), kFrames - 2);
+
+    std::vector<FrameScanSegment> segments;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        long long end = (i + 1 < starts.size()) ? starts[i + 1] : -1;
+        segments.push_back(scan_segment(starts[i], end));
+    }
+
+    FrameScanList merged;
+    long long badFrame = 0;
+    QVERIFY(merge(segments, merged, badFrame));
+    QCOMPARE(badFrame, -1LL);
+    QCOMPARE(merged.size(), serial.size());
+    for (size_t i = 0; i < serial.size(); i++)
+    {
+        QVERIFY2(merged[i] == serial[i],
+                 qPrintable(QString("frame %1").arg(serial[i].frameNumber)));
+    }
+}
+
+// A worker whose decoder numbered the frames differently after its seek
+void TestFrameScan::test_renumbered_segment(void)
+{
+    std::vector<FrameScanSegment> segments;
+    segments.push_back(scan_segment(0, 1500));
+    segments.push_back(scan_segment(1500, -1, 1));
+
+    FrameScanList merged;
+    long long badFrame = -1;
+    QVERIFY(!merge(segments, merged, badFrame));
+    QCOMPARE(badFrame, 1501LL);
+}
+
+// A worker that seeks to a frame the decoder never returns has no previous
+// frame for the scene similarity of its first frame
+void TestFrameScan::test_seek_to_dropped_frame(void)
+{
+    std::vector<FrameScanSegment> segments;
+    segments.push_back(scan_segment(0, 1001));
+    segments.push_back(scan_segment(1001, -1));
+
+    FrameScanList merged;
+    long long badFrame = -1;
+    QVERIFY(!merge(segments, merged, badFrame));
+    QCOMPARE(badFrame, 1001LL);
+}
+
+// Segments must not scan the same frames twice
+void TestFrameScan::test_overlapping_segments(void)
+{
+    std::vector<FrameScanSegment> segments;
+    segments.push_back(scan_segment(0, 1500));
+    segments.push_back(scan_segment(1400, -1));
+
+    FrameScanList merged;
+    long long badFrame = -1;
+    QVERIFY(!merge(segments, merged, badFrame));
+    QCOMPARE(badFrame, 1400LL);
+}
+
+// A segment that ends at the end of the file can't be checked against
+// the next one
+void TestFrameScan::test_short_segment(void)
+{
+    std::vector<FrameScanSegment> segments;
+    segments.push_back(scan_segment(0, kFrames + 100));
+    segments.push_back(scan_segment(kFrames + 100, -1));
+
+    FrameScanList merged;
+    long long badFrame = -1;
+    QVERIFY(!merge(segments, merged, badFrame));
+    QCOMPARE(badFrame, kFrames + 100);
+}
+
+QTEST_APPLESS_MAIN(TestFrameScan)
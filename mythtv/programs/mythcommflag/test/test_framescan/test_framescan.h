@@ -0,0 +1,32 @@
+/*
+ *  Class TestFrameScan
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+class TestFrameScan : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void test_serial_equivalence_data(void);
+    static void test_serial_equivalence(void);
+    static void test_renumbered_segment(void);
+    static void test_seek_to_dropped_frame(void);
+    static void test_overlapping_segments(void);
+    static void test_short_segment(void);
+};
@@ -0,0 +1,25 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += testlib
+
+TEMPLATE = app
+TARGET = test_framescan
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../..
+
+# Input
+HEADERS += test_framescan.h
+SOURCES += test_framescan.cpp
+
+# The merge code is part of mythcommflag, not a library.
+HEADERS += ../../FrameScan.h
+SOURCES += ../../FrameScan.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
+
+# Fix runtime linking on Ubuntu 17.10.
+linux:QMAKE_LFLAGS += -Wl,--disable-new-dtags
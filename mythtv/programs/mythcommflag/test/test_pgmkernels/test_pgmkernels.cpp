@@ -0,0 +1,269 @@
+/*
+ *  Class TestPGMKernels
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "pgmkernels.h"
+#include "test_pgmkernels.h"
+
+using namespace pgmKernels;
+
+/*
+ * Every test compares a dispatching kernel against its "_c" reference
+ * implementation. The results must be identical, not merely close.
+ */
+
+static std::vector<unsigned char> random_image(int size, unsigned int seed,
+                                               int lo = 0, int hi = 255)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(lo, hi);
+    std::vector<unsigned char> buf(size);
+    for (auto & px : buf)
+        px = static_cast<unsigned char>(dist(gen));
+    return buf;
+}
+
+/* Sparse 0/255 image, like the output of the edge detector. */
+static std::vector<unsigned char> random_edges(int size, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution dist(0.1);
+    std::vector<unsigned char> buf(size);
+    for (auto & px : buf)
+        px = dist(gen) ? UCHAR_MAX : 0;
+    return buf;
+}
+
+/* Same construction as CannyEdgeDetector's Gaussian smoothing mask. */
+static std::vector<double> gaussian_mask(int radius, double sigma)
+{
+    std::vector<double> mask(2 * radius + 1);
+    double sum = 0;
+    for (int ii = -radius; ii <= radius; ii++)
+    {
+        mask[ii + radius] = exp(-(ii * ii) / (2 * sigma * sigma));
+        sum += mask[ii + radius];
+    }
+    for (auto & val : mask)
+        val /= sum;
+    return mask;
+}
+
+void TestPGMKernels::initTestCase(void)
+{
+    qInfo() << "SIMD kernels" << (have_simd() ? "enabled" : "not available");
+}
+
+void TestPGMKernels::test_convolve_data(void)
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("narrow")     << 7   << 1;
+    QTest::newRow("one block")  << 8   << 2;
+    QTest::newRow("tail")       << 37  << 2;
+    QTest::newRow("sd")         << 720 << 2;
+    QTest::newRow("wide mask")  << 101 << 5;
+}
+
+void TestPGMKernels::test_convolve(void)
+{
+    QFETCH(int, width);
+    QFETCH(int, radius);
+
+    const int stride = width + 2 * radius;
+    const int rows = 2 * radius + 1;
+    std::vector<unsigned char> src = random_image(stride * rows, width);
+    std::vector<double> mask = gaussian_mask(radius, 0.5 + radius / 2.0);
+
+    std::vector<unsigned char> expected(width);
+    std::vector<unsigned char> actual(width);
+
+    convolve_col_c(expected.data(), &src[radius], stride, width,
+                   mask.data(), radius);
+    convolve_col(actual.data(), &src[radius], stride, width,
+                 mask.data(), radius);
+    QCOMPARE(actual, expected);
+
+    const unsigned char *row = &src[radius * stride + radius];
+    convolve_row_c(expected.data(), row, width, mask.data(), radius);
+    convolve_row(actual.data(), row, width, mask.data(), radius);
+    QCOMPARE(actual, expected);
+
+    /* Uniform images hit the exact .5 rounding cases. */
+    std::vector<unsigned char> flat(stride * rows, 0x81);
+    std::vector<double> box(2 * radius + 1, 0.5 / radius);
+    convolve_col_c(expected.data(), &flat[radius], stride, width,
+                   box.data(), radius);
+    convolve_col(actual.data(), &flat[radius], stride, width,
+                 box.data(), radius);
+    QCOMPARE(actual, expected);
+}
+
+void TestPGMKernels::test_sgm_data(void)
+{
+    QTest::addColumn<int>("width");
+
+    QTest::newRow("short")  << 5;
+    QTest::newRow("block")  << 8;
+    QTest::newRow("tail")   << 45;
+    QTest::newRow("sd")     << 719;
+}
+
+void TestPGMKernels::test_sgm(void)
+{
+    QFETCH(int, width);
+
+    /* Full-range data to exercise the extremes of dx^2 + dy^2. */
+    std::vector<unsigned char> src = random_image(2 * (width + 1), width);
+    src[0] = 0;
+    src[width + 2] = UCHAR_MAX;
+
+    std::vector<unsigned int> expected(width);
+    std::vector<unsigned int> actual(width);
+    sgm_row_c(expected.data(), src.data(), &src[width + 1], width);
+    sgm_row(actual.data(), src.data(), &src[width + 1], width);
+    QCOMPARE(actual, expected);
+}
+
+void TestPGMKernels::test_count(void)
+{
+    for (int size : { 0, 15, 16, 17, 1000, 720 * 480 + 3 })
+    {
+        std::vector<unsigned char> aa = random_edges(size, size);
+        std::vector<unsigned char> bb = random_edges(size, size + 1);
+        QCOMPARE(count_set(aa.data(), size), count_set_c(aa.data(), size));
+        QCOMPARE(count_match(aa.data(), bb.data(), size),
+                 count_match_c(aa.data(), bb.data(), size));
+
+        /* Any non-zero value counts, not just UCHAR_MAX. */
+        std::vector<unsigned char> cc = random_image(size, size, 0, 3);
+        QCOMPARE(count_set(cc.data(), size), count_set_c(cc.data(), size));
+        QCOMPARE(count_match(cc.data(), aa.data(), size),
+                 count_match_c(cc.data(), aa.data(), size));
+    }
+}
+
+void TestPGMKernels::test_inrange_span_data(void)
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("lo");
+    QTest::addColumn<int>("hi");
+    QTest::addColumn<int>("minval");
+    QTest::addColumn<int>("maxval");
+
+    /* kMaxRange is 32 in BorderDetector. */
+    QTest::newRow("all in range")   << 500 << 16 << 40 << 255 << 0;
+    QTest::newRow("noisy")          << 500 << 16 << 50 << 255 << 0;
+    QTest::newRow("seeded range")   << 500 << 16 << 48 << 20  << 40;
+    QTest::newRow("out of range")   << 500 << 0  << 255 << 255 << 0;
+    QTest::newRow("short")          << 9   << 16 << 40 << 255 << 0;
+}
+
+void TestPGMKernels::test_inrange_span(void)
+{
+    QFETCH(int, size);
+    QFETCH(int, lo);
+    QFETCH(int, hi);
+    QFETCH(int, minval);
+    QFETCH(int, maxval);
+
+    std::vector<unsigned char> buf = random_image(size, size + lo, lo, hi);
+
+    /* Walk the whole row the way BorderDetector does. */
+    unsigned char emin = minval;
+    unsigned char emax = maxval;
+    unsigned char amin = minval;
+    unsigned char amax = maxval;
+    int ee = 0;
+    int aa = 0;
+    while (ee < size || aa < size)
+    {
+        ee += inrange_span_c(&buf[ee], size - ee, &emin, &emax, 32);
+        aa += inrange_span(&buf[aa], size - aa, &amin, &amax, 32);
+        QCOMPARE(aa, ee);
+        QCOMPARE(amin, emin);
+        QCOMPARE(amax, emax);
+        ee++;
+        aa++;
+    }
+}
+
+void TestPGMKernels::test_histogram(void)
+{
+    const int width = 720;
+    const int height = 480;
+    std::vector<unsigned char> buf = random_image(width * height, 42);
+
+    /* Long runs of one value, like a black frame. */
+    std::fill(buf.begin(), buf.begin() + width * 60, 16);
+
+    for (int step : { 1, 2, 3, 4, 7 })
+    {
+        std::array<int,256> expected {};
+        std::array<int,256> actual {};
+        int nexpected = histogram_add_c(expected.data(), buf.data(), width,
+                                        10, width - 11, step, 5, height - 1,
+                                        step);
+        int nactual = histogram_add(actual.data(), buf.data(), width,
+                                    10, width - 11, step, 5, height - 1,
+                                    step);
+        QCOMPARE(nactual, nexpected);
+        QCOMPARE(actual, expected);
+    }
+}
+
+void TestPGMKernels::bench_convolve_data(void)
+{
+    QTest::addColumn<bool>("reference");
+
+    QTest::newRow("reference") << true;
+    QTest::newRow("dispatch")  << false;
+}
+
+void TestPGMKernels::bench_convolve(void)
+{
+    QFETCH(bool, reference);
+
+    const int width = 720;
+    const int height = 480;
+    const int radius = 2;
+    const int stride = width + 2 * radius;
+    std::vector<unsigned char> src =
+        random_image(stride * (height + 2 * radius), 7);
+    std::vector<unsigned char> dst(stride * height);
+    std::vector<double> mask = gaussian_mask(radius, 1.5);
+
+    QBENCHMARK
+    {
+        for (int rr = 0; rr < height; rr++)
+        {
+            if (reference)
+                convolve_col_c(&dst[rr * stride], &src[rr * stride + radius],
+                               stride, width, mask.data(), radius);
+            else
+                convolve_col(&dst[rr * stride], &src[rr * stride + radius],
+                             stride, width, mask.data(), radius);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestPGMKernels)
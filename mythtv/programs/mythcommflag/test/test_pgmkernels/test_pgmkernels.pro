@@ -0,0 +1,32 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += testlib
+
+TEMPLATE = app
+TARGET = test_pgmkernels
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../.. ../../../../libs/libmythbase
+INCLUDEPATH += ../../../.. ../../../../external/FFmpeg
+
+LIBS += -L../../../../external/FFmpeg/libavutil -lmythavutil
+QMAKE_LFLAGS += -Wl,$$_RPATH_$(PWD)/../../../../external/FFmpeg/libavutil
+
+# Must match the flags mythcommflag builds the kernels with.
+!win32-msvc*:QMAKE_CXXFLAGS += -ffp-contract=off
+
+# Input
+HEADERS += test_pgmkernels.h
+SOURCES += test_pgmkernels.cpp
+
+# The kernels themselves are part of mythcommflag, not a library.
+HEADERS += ../../pgmkernels.h
+SOURCES += ../../pgmkernels.cpp
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
+
+# Fix runtime linking on Ubuntu 17.10.
+linux:QMAKE_LFLAGS += -Wl,--disable-new-dtags
@@ -162,6 +162,9 @@ AudioConfigSettings::AudioConfigSettings()
     advancedSettings->addChild(HBRPassthrough());
 
     advancedSettings->addChild(m_mpcm = MPCM());
+#if USING_ALSA || USING_PULSEOUTPUT
+    advancedSettings->addChild(AudioCallbackMode());
+#endif
 
     addChild(m_audioTest = new AudioTest());
 
@@ -1265,6 +1268,22 @@ HostCheckBoxSetting *AudioConfigSettings::SPDIFRateOverride()
     return gc;
 }
 
+HostCheckBoxSetting *AudioConfigSettings::AudioCallbackMode()
+{
+    auto *gc = new HostCheckBoxSetting("AudioCallbackMode");
+
+    gc->setLabel(tr("Low latency audio output"));
+
+    gc->setValue(false);
+
+    gc->setHelpText(tr("ALSA and PulseAudio only. Write audio whenever the "
+                       "device asks for it, with a short device buffer, "
+                       "rather than a fragment at a time. Passthrough and "
+                       "AC-3 encoding are not affected. (default is not "
+                       "checked)"));
+    return gc;
+}
+
 HostCheckBoxSetting *AudioConfigSettings::HBRPassthrough()
 {
     auto *gc = new HostCheckBoxSetting("HBRPassthru");
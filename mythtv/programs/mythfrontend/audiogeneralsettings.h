@@ -85,6 +85,7 @@ class AudioConfigSettings : public GroupSetting
     static HostComboBoxSetting *PassThroughOutputDevice();
     static HostCheckBoxSetting *SPDIFRateOverride();
     static HostCheckBoxSetting *HBRPassthrough();
+    static HostCheckBoxSetting *AudioCallbackMode();
 
     bool                CheckPassthrough();
 
@@ -349,6 +349,44 @@ static GlobalCheckBoxSetting *AggressiveCommDetect()
     return bc;
 }
 
+static GlobalSpinBoxSetting *CommDetectSegments()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommDetectSegments", 0, 16, 1);
+
+    gs->setLabel(GeneralSettings::tr("Commercial detection threads"));
+
+    gs->setHelpText(GeneralSettings::tr("If greater than one, finished "
+                                        "recordings are flagged by this many "
+                                        "threads, each scanning a part of the "
+                                        "recording. Only used by the Blank, "
+                                        "Scene and Logo detection methods. "
+                                        "Zero or one scans the recording with "
+                                        "a single thread."));
+
+    gs->setValue(0);
+
+    return gs;
+}
+
+static GlobalSpinBoxSetting *CommDetectSilenceLevel()
+{
+    auto *gs = new GlobalSpinBoxSetting("CommDetectSilenceLevel", -90, -20, 1);
+
+    gs->setLabel(GeneralSettings::tr("Keyframe detection silence level (dB)"));
+
+    gs->setHelpText(GeneralSettings::tr("Used by the \"Keyframes Only\" "
+                                        "detection methods, which only look "
+                                        "at some of the frames. A scene "
+                                        "change into audio quieter than this "
+                                        "counts as a blank frame. Raise it if "
+                                        "breaks are missed, lower it if quiet "
+                                        "scenes are flagged."));
+
+    gs->setValue(-60);
+
+    return gs;
+}
+
 static HostSpinBoxSetting *CommRewindAmount()
 {
     auto *gs = new HostSpinBoxSetting("CommRewindAmount", 0, 10, 1);
@@ -4493,6 +4531,8 @@ GeneralSettings::GeneralSettings()
     jobs->addChild(CommercialSkipMethod());
     jobs->addChild(CommFlagFast());
     jobs->addChild(AggressiveCommDetect());
+    jobs->addChild(CommDetectSegments());
+    jobs->addChild(CommDetectSilenceLevel());
     jobs->addChild(DeferAutoTranscodeDays());
 
     addChild(jobs);
@@ -343,6 +343,28 @@ public:
     QVector<bool> m_unavailables;
 };
 
+// Loads the programs of the channels around the ones shown, so that
+// scrolling to them doesn't have to wait for the database.
+class GuidePrefetch : public GuideUpdaterBase
+{
+public:
+    GuidePrefetch(GuideGrid *guide, uint startChan, QDateTime startTime)
+        : GuideUpdaterBase(guide), m_currentStartChannel(startChan),
+          m_currentStartTime(std::move(startTime)) {}
+    bool ExecuteNonUI(void) override // GuideUpdaterBase
+    {
+        if (m_currentStartChannel == m_guide->GetCurrentStartChannel() &&
+            m_currentStartTime == m_guide->GetCurrentStartTime())
+        {
+            m_guide->prefetchProgramLists();
+        }
+        return false;
+    }
+    void ExecuteUI(void) override {} // GuideUpdaterBase
+    uint m_currentStartChannel;
+    QDateTime m_currentStartTime;
+};
+
 class UpdateGuideEvent : public QEvent
 {
 public:
@@ -411,6 +433,123 @@ QMutex                 GuideHelper::s_lock;
 QWaitCondition         GuideHelper::s_wait;
 QHash<GuideGrid*,uint> GuideHelper::s_loading;
 
+/** \class GuideDataCache
+ *  \brief The programs of the channels in and near the guide window.
+ *
+ *  Each channel has the programs of one time range, sorted by start time,
+ *  so any window inside that range is answered without a query.  Programs
+ *  are loaded a page of channels at a time with a single query.
+ */
+class GuideDataCache
+{
+  public:
+    ProgramList *Get(uint chanid, const QDateTime &start,
+                     const QDateTime &end);
+    bool Has(uint chanid, const QDateTime &start, const QDateTime &end);
+    void Load(const QVector<uint> &chanids, const QDateTime &start,
+              const QDateTime &end, const ProgramList &schedList);
+    void Clear(void);
+
+  private:
+    struct ChannelPrograms
+    {
+        QDateTime m_start;
+        QDateTime m_end;
+        std::vector<ProgramInfo> m_programs;
+    };
+
+    QMutex                          m_lock;
+    QHash<uint, ChannelPrograms>    m_channels;
+};
+
+/// \brief Returns the programs of chanid that a query for the window from
+///        start to end would, or nullptr if they aren't loaded.
+ProgramList *GuideDataCache::Get(uint chanid, const QDateTime &start,
+                                 const QDateTime &end)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_channels.constFind(chanid);
+    if (it == m_channels.constEnd() || it->m_start > start || it->m_end < end)
+        return nullptr;
+
+    // Same conditions as the query in GuideGrid::getProgramListFromProgram()
+    QDateTime limit = start.addDays(-1);
+    auto pi = std::lower_bound(it->m_programs.cbegin(), it->m_programs.cend(),
+                               limit, [](const ProgramInfo &p, const QDateTime &t)
+                               { return p.GetScheduledStartTime() < t; });
+
+    auto *proglist = new ProgramList();
+    for (; pi != it->m_programs.cend() && pi->GetScheduledStartTime() <= end; ++pi)
+    {
+        if (pi->GetScheduledEndTime() >= start)
+            proglist->push_back(new ProgramInfo(*pi));
+    }
+    return proglist;
+}
+
+bool GuideDataCache::Has(uint chanid, const QDateTime &start,
+                         const QDateTime &end)
+{
+    QMutexLocker locker(&m_lock);
+
+    auto it = m_channels.constFind(chanid);
+    return it != m_channels.constEnd() &&
+           it->m_start <= start && it->m_end >= end;
+}
+
+/// \brief Replaces the programs of chanids with those from start to end.
+void GuideDataCache::Load(const QVector<uint> &chanids, const QDateTime &start,
+                          const QDateTime &end, const ProgramList &schedList)
+{
+    if (chanids.isEmpty())
+        return;
+
+    QStringList ids;
+    for (uint chanid : chanids)
+        ids << QString::number(chanid);
+
+    MSqlBindings bindings;
+    QString where = QString("program.chanid IN (%1) "
+                            "  AND program.endtime >= :STARTTS "
+                            "  AND program.starttime <= :ENDTS "
+                            "  AND program.starttime >= :STARTLIMITTS "
+                            "  AND program.manualid = 0 ").arg(ids.join(","));
+    bindings[":STARTTS"] = start;
+    bindings[":STARTLIMITTS"] = start.addDays(-1);
+    bindings[":ENDTS"] = end;
+
+    // Group by chanid so channels that share a callsign aren't merged
+    ProgramList proglist;
+    if (!LoadFromProgram(proglist, where,
+                         "program.chanid, program.starttime, program.title",
+                         "program.starttime", bindings, schedList))
+        return;
+
+    QHash<uint, ChannelPrograms> loaded;
+    for (uint chanid : chanids)
+    {
+        ChannelPrograms &channel = loaded[chanid];
+        channel.m_start = start;
+        channel.m_end = end;
+    }
+    for (auto *pi : proglist)
+        loaded[pi->GetChanID()].m_programs.push_back(*pi);
+
+    LOG(VB_GUI, LOG_DEBUG, LOC + QString("Loaded %1 programs on %2 channels")
+        .arg(proglist.size()).arg(chanids.size()));
+
+    QMutexLocker locker(&m_lock);
+    for (auto it = loaded.begin(); it != loaded.end(); ++it)
+        m_channels[it.key()] = std::move(*it);
+}
+
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_channels.clear();
+}
+
 void GuideGrid::RunProgramGuide(uint chanid, const QString &channum,
                                 const QDateTime &startTime,
                                 TV *player, bool embedVideo,
@@ -482,6 +621,7 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
   : ScheduleCommon(parent, "guidegrid"),
     m_selectRecThreshold(gCoreContext->GetDurSetting<std::chrono::minutes>("SelChangeRecThreshold", 16min)),
     m_allowFinder(allowFinder),
+    m_dataCache(new GuideDataCache()),
     m_startChanID(chanid),
     m_startChanNum(std::move(channum)),
     m_sortReverse(gCoreContext->GetBoolSetting("EPGSortReverse", false)),
@@ -627,6 +767,7 @@ GuideGrid::~GuideGrid()
     m_updateTimer = nullptr;
 
     GuideHelper::Wait(this);
+    delete m_dataCache;
 
     gCoreContext->removeListener(this);
 
@@ -1516,28 +1657,74 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
     fillProgramRowInfos(-1, useExistingData);
 }
 
+/// \brief Returns the chanids of a page of channels, 0 being the page
+///        shown, -1 the one above it and 1 the one below.
+QVector<uint> GuideGrid::GetPageChanIds(int page)
+{
+    QVector<uint> chanids;
+    int count = GetChannelCount();
+    if (!count)
+        return chanids;
+
+    int first = (int)m_currentStartChannel + (page * m_channelCount);
+    for (int row = 0; row < m_channelCount && row < count; ++row)
+    {
+        int chanNum = (((first + row) % count) + count) % count;
+        const ChannelInfo *chinfo = GetChannelInfo(chanNum);
+        if (chinfo && !chanids.contains(chinfo->m_chanId))
+            chanids.push_back(chinfo->m_chanId);
+    }
+    return chanids;
+}
+
 ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 {
-    auto *proglist = new ProgramList();
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    uint chanid = GetChannelInfo(chanNum)->m_chanId;
 
-    if (proglist)
+    ProgramList *proglist = m_dataCache->Get(chanid, starttime, endtime);
+    if (!proglist)
     {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
-        QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->m_chanId;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+        // Load every row shown with one query, along with a page of time
+        // either side, rather than a query for each row
+        qint64 span = starttime.secsTo(endtime);
+        QVector<uint> chanids = GetPageChanIds(0);
+        if (!chanids.contains(chanid))
+            chanids.push_back(chanid);
+        m_dataCache->Load(chanids, starttime.addSecs(-span),
+                          endtime.addSecs(span), m_recList);
+        proglist = m_dataCache->Get(chanid, starttime, endtime);
+    }
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
+    return proglist ? proglist : new ProgramList();
+}
+
+/// \brief Loads the programs of the pages of channels above and below the
+///        one shown, and more time either side, if they aren't loaded.
+void GuideGrid::prefetchProgramLists(void)
+{
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+    qint64 span = starttime.secsTo(endtime);
+
+    // Reload once less than half a page of time is left either side
+    QDateTime needStart = starttime.addSecs(-span / 2);
+    QDateTime needEnd = endtime.addSecs(span / 2);
+
+    QVector<uint> missing;
+    for (int page : { 0, 1, -1 })
+    {
+        for (uint chanid : GetPageChanIds(page))
+        {
+            if (!missing.contains(chanid) &&
+                !m_dataCache->Has(chanid, needStart, needEnd))
+                missing.push_back(chanid);
+        }
     }
 
-    return proglist;
+    m_dataCache->Load(missing, starttime.addSecs(-span),
+                      endtime.addSecs(span), m_recList);
 }
 
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
@@ -1604,6 +1791,13 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
                    m_verticalLayout, m_firstTime, m_lastTime);
     auto *updater = new GuideUpdateProgramRow(this, gs, proglists);
     m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+    {
+        auto *prefetch = new GuidePrefetch(this, m_currentStartChannel,
+                                           m_currentStartTime);
+        m_threadPool.start(new GuideHelper(this, prefetch), "GuidePrefetch");
+    }
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row,
@@ -1854,6 +2048,7 @@ void GuideGrid::customEvent(QEvent *event)
         {
             GuideHelper::Wait(this);
             LoadFromScheduler(m_recList);
+            m_dataCache->Clear();
             fillProgramInfos();
         }
     }
@@ -2231,7 +2426,9 @@ void GuideGrid::generateListings()
     maxchannel = std::max((int)GetChannelCount() - 1, 0);
     m_channelCount = std::min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
+    GuideHelper::Wait(this);
     LoadFromScheduler(m_recList);
+    m_dataCache->Clear();
     fillProgramInfos();
 }
 
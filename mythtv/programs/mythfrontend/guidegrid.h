@@ -26,6 +26,7 @@
 #include "schedulecommon.h"
 
 class ProgramInfo;
+class GuideDataCache;
 class QTimer;
 class MythUIButtonList;
 class MythUIGuideGrid;
@@ -215,6 +216,7 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 public:
     // These need to be public so that the helper classes can operate.
     ProgramList *getProgramListFromProgram(int chanNum);
+    void prefetchProgramLists(void);
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -234,6 +236,7 @@ private:
     int                  GetStartChannelOffset(int row = -1) const;
 
     ProgramList GetProgramList(uint chanid) const;
+    QVector<uint> GetPageChanIds(int page);
     uint GetAlternateChannelIndex(uint chan_idx, bool with_same_channum) const;
     void updateDateText(void);
 
@@ -247,6 +250,7 @@ private:
     std::vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos {};
     ProgramList  m_recList;
+    GuideDataCache *m_dataCache {nullptr};
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -115,12 +115,6 @@ bool ProgLister::Create()
     connect(m_progList, &MythUIButtonList::itemSelected,
             this,       &ProgLister::HandleSelected);
 
-    connect(m_progList, &MythUIButtonList::itemVisible,
-            this,       &ProgLister::HandleVisible);
-
-    connect(m_progList, &MythUIButtonList::itemLoaded,
-            this,       &ProgLister::HandleVisible);
-
     if (m_type == plPreviouslyRecorded)
     {
         connect(m_progList, &MythUIButtonList::itemClicked,
@@ -1517,44 +1511,83 @@ void ProgLister::RestoreSelection(const ProgramInfo *selected,
     m_progList->SetItemCurrent(i + 1, i + 1 - selectedOffset);
 }
 
-void ProgLister::HandleVisible(MythUIButtonListItem *item)
+int ProgLister::GetCount(void) const
+{
+    return m_shownList.size();
+}
+
+void ProgLister::FillItem(MythUIButtonListItem *item, int pos)
 {
-    auto *pginfo = item->GetData().value<ProgramInfo*>();
+    ProgramInfo *pginfo = m_shownList[pos];
+    item->SetData(QVariant::fromValue(pginfo));
 
-    if (item->GetText("is_item_initialized").isNull())
+    InfoMap infoMap;
+    pginfo->ToMap(infoMap);
+
+    QString state = RecStatus::toUIState(pginfo->GetRecordingStatus());
+    if ((state == "warning") && (plPreviouslyRecorded == m_type))
+        state = "disabled";
+
+    item->SetTextFromMap(infoMap, state);
+
+    if (m_type == plTitle)
     {
-        InfoMap infoMap;
-        pginfo->ToMap(infoMap);
+        QString tempSubTitle = pginfo->GetSubtitle();
+        if (tempSubTitle.trimmed().isEmpty())
+            tempSubTitle = pginfo->GetTitle();
+        item->SetText(tempSubTitle, "titlesubtitle", state);
+    }
 
-        QString state = RecStatus::toUIState(pginfo->GetRecordingStatus());
-        if ((state == "warning") && (plPreviouslyRecorded == m_type))
-            state = "disabled";
+    item->DisplayState(QString::number(pginfo->GetStars(10)),
+                       "ratingstate");
 
-        item->SetTextFromMap(infoMap, state);
+    item->DisplayState(state, "status");
+}
 
-        if (m_type == plTitle)
-        {
-            QString tempSubTitle = pginfo->GetSubtitle();
-            if (tempSubTitle.trimmed().isEmpty())
-                tempSubTitle = pginfo->GetTitle();
-            item->SetText(tempSubTitle, "titlesubtitle", state);
-        }
+QStringList ProgLister::GetSearchTexts(int pos, const QString &fieldList) const
+{
+    // The item's own text is never set
+    if (fieldList.isEmpty())
+        return {};
+
+    const ProgramInfo *pginfo = m_shownList[pos];
+    InfoMap infoMap;
+    pginfo->ToMap(infoMap);
 
-        item->DisplayState(QString::number(pginfo->GetStars(10)),
-                           "ratingstate");
+    if (m_type == plTitle)
+    {
+        QString tempSubTitle = pginfo->GetSubtitle();
+        if (tempSubTitle.trimmed().isEmpty())
+            tempSubTitle = pginfo->GetTitle();
+        infoMap["titlesubtitle"] = tempSubTitle;
+    }
 
-        item->DisplayState(state, "status");
+    if (fieldList == "**ALL**")
+        return infoMap.values();
 
-        // Mark this button list item as initialized.
-        item->SetText("yes", "is_item_initialized");
+    QStringList texts;
+#if QT_VERSION < QT_VERSION_CHECK(5,14,0)
+    QStringList fields = fieldList.split(',', QString::SkipEmptyParts);
+#else
+    QStringList fields = fieldList.split(',', Qt::SkipEmptyParts);
+#endif
+    for (const auto &field : qAsConst(fields))
+    {
+        if (infoMap.contains(field.trimmed()))
+            texts << infoMap[field.trimmed()];
     }
+    return texts;
 }
 
 void ProgLister::UpdateButtonList(void)
 {
+    // Items are only filled as they come into view, which makes a
+    // difference for lists with thousands of programs
+    m_shownList.clear();
+    m_shownList.reserve(m_itemList.size());
     for (auto *it : m_itemList)
-        new MythUIButtonListItem(m_progList, "", QVariant::fromValue(it));
-    m_progList->LoadInBackground();
+        m_shownList.append(it);
+    m_progList->SetModel(this);
 
     if (m_positionText)
     {
@@ -4,11 +4,13 @@
 // Qt headers
 #include <QDateTime>
 #include <QString>
+#include <QVector>
 
 // MythTV headers
 #include "programinfo.h" // for ProgramList
 #include "schedulecommon.h"
 #include "proglist_helpers.h"
+#include "mythuibuttonlist.h"
 
 enum ProgListType {
     plUnknown = 0,
@@ -28,7 +30,7 @@ enum ProgListType {
     plPreviouslyRecorded
 };
 
-class ProgLister : public ScheduleCommon
+class ProgLister : public ScheduleCommon, public MythUIButtonListModel
 {
     friend class PhrasePopup;
     friend class TimePopup;
@@ -49,9 +51,13 @@ class ProgLister : public ScheduleCommon
     bool keyPressEvent(QKeyEvent *event) override; // MythScreenType
     void customEvent(QEvent *event) override; // ScheduleCommon
 
+    int GetCount(void) const override; // MythUIButtonListModel
+    void FillItem(MythUIButtonListItem *item, int pos) override; // MythUIButtonListModel
+    QStringList GetSearchTexts(int pos, const QString &fieldList) const override; // MythUIButtonListModel
+    void SetChecked(int /*pos*/, MythUIButtonListItem::CheckState /*state*/) override {} // MythUIButtonListModel
+
   protected slots:
     void HandleSelected(MythUIButtonListItem *item);
-    void HandleVisible(MythUIButtonListItem *item);
 
     void DeleteOldEpisode(bool ok);
     void DeleteOldSeries(bool ok);
@@ -111,6 +117,9 @@ class ProgLister : public ScheduleCommon
 
     ProgramList       m_itemList;
     ProgramList       m_itemListSave;
+    /// The programs in m_progList.  m_itemList may be refilled by Load()
+    /// while they are still shown.
+    QVector<ProgramInfo*> m_shownList;
     ProgramList       m_schedList;
 
     QStringList       m_typeList;
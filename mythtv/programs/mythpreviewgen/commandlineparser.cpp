@@ -19,6 +19,41 @@ void MythPreviewGeneratorCommandLineParser::LoadArguments(void)
     add("--size", "size", QSize(0,0), "Dimensions of preview image.", "");
     add("--infile", "inputfile", "", "Input video for preview generation.", "");
     add("--outfile", "outputfile", "", "Optional output file for preview generation.", "");
+    add("--format", "format", "", "Image format of the preview (PNG or JPG).",
+            "Image format of the preview (PNG or JPG). Defaults to the "
+            "extension of --outfile, or PNG. Ignored with --batch, which "
+            "always writes PNG since that is where the backend and "
+            "frontend look for previews.");
+    add("--keyframe", "keyframe", false,
+            "Grab the keyframe closest to the requested position.",
+            "Grab the keyframe closest to the requested position instead "
+            "of decoding up to the exact frame. Much faster, but the image "
+            "may come from a few seconds earlier.");
+
+    add("--batch", "batch", false,
+            "Regenerate previews for all recordings on this host.",
+            "Regenerate the preview images for every recording stored on "
+            "this host from within a single process, using a pool of "
+            "worker threads. Implies --keyframe.")
+        ->SetGroup("Batch")
+        ->SetBlocks(QStringList() << "chanid" << "starttime" << "inputfile"
+                                  << "outputfile");
+    add("--threads", "threads", 0U,
+            "Number of concurrent preview workers in batch mode.",
+            "Number of concurrent preview workers in batch mode. Defaults "
+            "to the number of CPU cores.")
+        ->SetGroup("Batch")
+        ->SetChildOf("batch");
+    add("--rate", "rate", 0.0,
+            "Maximum previews started per second in batch mode.",
+            "Maximum number of previews started per second in batch mode. "
+            "Zero means unlimited.")
+        ->SetGroup("Batch")
+        ->SetChildOf("batch");
+    add("--force", "force", false,
+            "Regenerate previews that are already up to date.", "")
+        ->SetGroup("Batch")
+        ->SetChildOf("batch");
 }
 
 
@@ -4,6 +4,7 @@
 #endif
 
 // C++ headers
+#include <algorithm>
 #include <cerrno>
 #include <csignal>
 #include <cstdlib>
@@ -22,16 +23,22 @@
 #include <QApplication>
 #endif
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QMap>
 #include <QRegExp>
+#include <QRunnable>
+#include <QThread>
 
 #include "mythcontext.h"
 #include "mythcorecontext.h"
 #include "mythversion.h"
 #include "mythdb.h"
+#include "mythdate.h"
+#include "mthreadpool.h"
 #include "exitcodes.h"
 #include "compat.h"
 #include "storagegroup.h"
@@ -69,7 +76,8 @@ namespace
 int preview_helper(uint chanid, QDateTime starttime,
                    long long previewFrameNumber, std::chrono::seconds previewSeconds,
                    const QSize previewSize,
-                   const QString &infile, const QString &outfile)
+                   const QString &infile, const QString &outfile,
+                   const QString &outformat, bool keyframeOnly)
 {
     // Lower scheduling priority, to avoid problems with recordings.
     if (setpriority(PRIO_PROCESS, 0, 9))
@@ -122,14 +130,156 @@ int preview_helper(uint chanid, QDateTime starttime,
 
     previewgen->SetOutputSize(previewSize);
     previewgen->SetOutputFilename(outfile);
+    previewgen->SetOutputFormat(outformat);
+    previewgen->SetKeyframeOnly(keyframeOnly);
     bool ok = previewgen->RunReal();
-    previewgen->deleteLater();
+    // batch workers have no event loop to run a deleteLater()
+    delete previewgen;
 
     delete pginfo;
 
     return (ok) ? GENERIC_EXIT_OK : GENERIC_EXIT_NOT_OK;
 }
 
+/**
+ *  \brief Choose the image format: the one asked for, else the one the
+ *         output file name implies, else PNG.
+ */
+static QString preview_format(const QString &format, const QString &outfile)
+{
+    if (!format.isEmpty())
+        return format.toUpper();
+    QString suffix = QFileInfo(outfile).suffix().toUpper();
+    return suffix.isEmpty() ? "PNG" : suffix;
+}
+
+/** \class PreviewBatchTask
+ *  \brief Generates the preview for a single recording as part of a
+ *         --batch run.
+ */
+class PreviewBatchTask : public QRunnable
+{
+  public:
+    PreviewBatchTask(uint chanid, QDateTime starttime, QSize size,
+                     QString outfile, QString format, QAtomicInt &failed) :
+        m_chanid(chanid), m_starttime(std::move(starttime)), m_size(size),
+        m_outfile(std::move(outfile)), m_format(std::move(format)),
+        m_failed(failed) {}
+
+    void run(void) override // QRunnable
+    {
+        int ret = preview_helper(m_chanid, m_starttime, 0, 0s, m_size,
+                                 QString(), m_outfile, m_format, true);
+        if (ret != GENERIC_EXIT_OK)
+            m_failed.fetchAndAddRelaxed(1);
+    }
+
+  private:
+    uint        m_chanid;
+    QDateTime   m_starttime;
+    QSize       m_size;
+    QString     m_outfile;
+    QString     m_format;
+    QAtomicInt &m_failed;
+};
+
+/**
+ *  \brief Regenerate the previews of every recording stored on this host.
+ *
+ *  All the work happens in this process on a pool of worker threads, which
+ *  avoids paying the process start up and database connection cost for
+ *  each preview.  Every worker only decodes the keyframe nearest to the
+ *  preview position.  The previews are always PNG, since the backend and
+ *  the frontend only look for "<recording>.png".
+ *
+ *  \param threads Number of concurrent workers, 0 for one per CPU core.
+ *  \param rate    Maximum number of previews started per second, 0 for
+ *                 no limit.
+ *  \param size    Dimensions of the preview images.
+ *  \param force   Regenerate previews that are newer than the recording.
+ */
+static int preview_batch(uint threads, double rate, QSize size, bool force)
+{
+    const QString format("PNG");
+
+    if (setpriority(PRIO_PROCESS, 0, 9))
+        LOG(VB_GENERAL, LOG_ERR, "Setting priority failed." + ENO);
+
+    if (threads == 0)
+        threads = std::max(QThread::idealThreadCount(), 1);
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT chanid, starttime "
+                  "FROM recorded "
+                  "WHERE hostname = :HOSTNAME AND deletepending = 0 "
+                  "ORDER BY starttime DESC");
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+    if (!query.exec())
+    {
+        MythDB::DBError("preview_batch", query);
+        return GENERIC_EXIT_DB_ERROR;
+    }
+
+    MThreadPool pool("PreviewBatch");
+    pool.setMaxThreadCount(static_cast<int>(threads));
+
+    QAtomicInt failed(0);
+    uint queued = 0;
+    uint skipped = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    while (query.next())
+    {
+        uint chanid = query.value(0).toUInt();
+        QDateTime starttime = MythDate::as_utc(query.value(1).toDateTime());
+
+        ProgramInfo pginfo(chanid, starttime);
+        if (!pginfo.GetChanID())
+            continue;
+
+        QString pathname = pginfo.GetPlaybackURL(false, true);
+        QString previewname =
+            PreviewGenerator::CreateAccessibleFilename(pathname, QString(),
+                                                       format);
+
+        if (!force)
+        {
+            QFileInfo recfi(pathname);
+            QFileInfo prevfi(previewname);
+            if (recfi.exists() && prevfi.exists() &&
+                (prevfi.lastModified() >= recfi.lastModified()))
+            {
+                skipped++;
+                continue;
+            }
+        }
+
+        if (rate > 0.0)
+        {
+            auto due = static_cast<qint64>((queued * 1000) / rate);
+            qint64 wait = due - timer.elapsed();
+            if (wait > 0)
+                QThread::msleep(static_cast<unsigned long>(wait));
+        }
+
+        pool.start(new PreviewBatchTask(chanid, starttime, size, QString(),
+                                        format, failed),
+                   "PreviewBatchTask");
+        queued++;
+    }
+
+    pool.waitForDone();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Batch generated %1 previews (%2 failed, %3 up to date) "
+                "in %4 seconds using %5 threads")
+        .arg(queued - failed.loadAcquire()).arg(failed.loadAcquire())
+        .arg(skipped).arg(timer.elapsed() * 0.001).arg(threads));
+
+    return (failed.loadAcquire() == 0) ? GENERIC_EXIT_OK : GENERIC_EXIT_NOT_OK;
+}
+
 int main(int argc, char **argv)
 {
     MythPreviewGeneratorCommandLineParser cmdline;
@@ -166,7 +316,8 @@ int main(int argc, char **argv)
     if (retval != GENERIC_EXIT_OK)
         return retval;
 
-    if ((!cmdline.toBool("chanid") || !cmdline.toBool("starttime")) &&
+    if (!cmdline.toBool("batch") &&
+        (!cmdline.toBool("chanid") || !cmdline.toBool("starttime")) &&
         !cmdline.toBool("inputfile"))
     {
         std::cerr << "--generate-preview must be accompanied by either " <<std::endl
@@ -204,11 +355,27 @@ int main(int argc, char **argv)
         return GENERIC_EXIT_NO_MYTHCONTEXT;
     }
 
+    if (cmdline.toBool("batch"))
+    {
+        if (preview_format(cmdline.toString("format"), QString()) != "PNG")
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                "--format is ignored with --batch, previews are saved as PNG");
+        }
+        return preview_batch(cmdline.toUInt("threads"),
+                             cmdline.toDouble("rate"),
+                             cmdline.toSize("size"),
+                             cmdline.toBool("force"));
+    }
+
     int ret = preview_helper(
         cmdline.toUInt("chanid"), cmdline.toDateTime("starttime"),
         cmdline.toLongLong("frame"), std::chrono::seconds(cmdline.toLongLong("seconds")),
         cmdline.toSize("size"),
-        cmdline.toString("inputfile"), cmdline.toString("outputfile"));
+        cmdline.toString("inputfile"), cmdline.toString("outputfile"),
+        preview_format(cmdline.toString("format"),
+                       cmdline.toString("outputfile")),
+        cmdline.toBool("keyframe"));
     return ret;
 }
 
@@ -34,7 +34,8 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
         "Keep all audio tracks including those marked with 0 channels.", "")
         ->SetGroup("Encoding");
     add(QStringList{"-m", "--mpeg2"}, "mpeg2", false,
-            "Specifies that a lossless transcode should be used.", "")
+            "Specifies that a lossless transcode should be used. "
+            "Works for MPEG-2, H.264 and HEVC recordings.", "")
         ->SetGroup("Encoding");
     add(QStringList{"-e", "--ostream"}, "ostream", "",
             "Output stream type: ps, dvd, ts (Default: ps)", "")
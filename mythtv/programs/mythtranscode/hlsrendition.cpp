@@ -0,0 +1,253 @@
+// MythTV
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythavutil.h"
+#include "io/mythavformatwriter.h"
+#include "hlsrendition.h"
+
+extern "C" {
+#include "libswscale/swscale.h"
+}
+
+#define LOC QString("HLSRendition(%1x%2): ").arg(m_width).arg(m_height)
+
+HLSRendition::HLSRendition(int Width, int Height, int Bitrate)
+  : MThread("HLSRendition"),
+    m_width(Width), m_height(Height), m_bitrate(Bitrate)
+{
+}
+
+HLSRendition::~HLSRendition()
+{
+    Finish();
+    sws_freeContext(m_scaler);
+}
+
+/**
+ *  \brief Open the first segment and start the encoder thread
+ *
+ *  The writer is set up like the main stream's, with the same keyframe
+ *  distance so that both can be cut at the same frame.  It runs a single
+ *  encoder thread, the renditions already run in parallel with each other.
+ */
+bool HLSRendition::Init(float Aspect, double FrameRate, int AudioBitrate,
+                        int AudioChannels, int AudioRate,
+                        const QString &Filename)
+{
+    m_writer = std::make_unique<MythAVFormatWriter>();
+    m_writer->SetContainer("mpegts");
+    m_writer->SetVideoCodec("libx264");
+    m_writer->SetAudioCodec("aac");
+    m_writer->SetVideoBitrate(m_bitrate);
+    m_writer->SetWidth(m_width);
+    m_writer->SetHeight(m_height);
+    m_writer->SetAspect(Aspect);
+    m_writer->SetFramerate(FrameRate);
+    m_writer->SetKeyFrameDist(30);
+    m_writer->SetAudioBitrate(AudioBitrate);
+    m_writer->SetAudioChannels(AudioChannels);
+    m_writer->SetAudioFrameRate(AudioRate);
+    m_writer->SetAudioFormat(FORMAT_S16);
+    m_writer->SetThreadCount(1);
+    m_writer->SetEncodingPreset(
+        gCoreContext->GetSetting("HTTPLiveStreamPreset", "veryfast"));
+    m_writer->SetEncodingTune(
+        gCoreContext->GetSetting("HTTPLiveStreamTune", "film"));
+    m_writer->SetFilename(Filename);
+
+    if (!m_writer->Init())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Init() failed");
+        return false;
+    }
+
+    if (!m_writer->OpenFile())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "OpenFile() failed");
+        return false;
+    }
+
+    for (auto & frame : m_frames)
+    {
+        frame.Init(FMT_YV12, m_width, m_height);
+        m_freeFrames.append(&frame);
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Encoding at %1 kbps")
+        .arg(m_bitrate / 1000));
+
+    start();
+    return true;
+}
+
+/**
+ *  \brief Scale a frame the main stream has written and queue it
+ *
+ *  Blocks while all of this rendition's frames are waiting to be encoded,
+ *  so that the decoder can't run ahead of the slowest encoder.
+ */
+void HLSRendition::WriteVideo(const MythVideoFrame *Frame,
+                              std::chrono::milliseconds Timecode,
+                              std::chrono::milliseconds Offset)
+{
+    MythVideoFrame *frame = nullptr;
+
+    m_lock.lock();
+    while (m_freeFrames.isEmpty() && !m_finished)
+        m_wait.wait(&m_lock);
+    if (!m_freeFrames.isEmpty())
+        frame = m_freeFrames.takeFirst();
+    m_lock.unlock();
+
+    if (!frame)
+        return;
+
+    AVFrame imageIn {};
+    AVFrame imageOut {};
+    MythAVUtil::FillAVFrame(&imageIn, Frame);
+    MythAVUtil::FillAVFrame(&imageOut, frame);
+
+    int bottomBand = (Frame->m_height == 1088) ? 8 : 0;
+    m_scaler = sws_getCachedContext(m_scaler,
+                   Frame->m_width, Frame->m_height, MythAVUtil::FrameTypeToPixelFormat(Frame->m_type),
+                   frame->m_width, frame->m_height, MythAVUtil::FrameTypeToPixelFormat(frame->m_type),
+                   SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+    sws_scale(m_scaler, imageIn.data, imageIn.linesize, 0,
+              Frame->m_height - bottomBand,
+              imageOut.data, imageOut.linesize);
+
+    Item item;
+    item.m_type     = kVideo;
+    item.m_frame    = frame;
+    item.m_timecode = Timecode;
+    item.m_offset   = Offset;
+    Queue(item);
+}
+
+void HLSRendition::WriteAudio(const unsigned char *Buffer, int Size,
+                              std::chrono::milliseconds Timecode,
+                              std::chrono::milliseconds Offset)
+{
+    Item item;
+    item.m_type     = kAudio;
+    item.m_audio    = QByteArray(reinterpret_cast<const char*>(Buffer), Size);
+    item.m_timecode = Timecode;
+    item.m_offset   = Offset;
+    Queue(item);
+}
+
+/**
+ *  \brief Start a new segment at input frame Frame
+ *
+ *  Called when the main stream decides to cut, before it passes that
+ *  frame on, with the index the main stream's writer gave the frame.
+ */
+void HLSRendition::NewSegment(const QString &Filename, long long Frame)
+{
+    Item item;
+    item.m_type     = kSegment;
+    item.m_filename = Filename;
+    item.m_cutFrame = Frame;
+
+    QMutexLocker locker(&m_lock);
+    m_cutsQueued++;
+    m_queue.append(item);
+    m_wait.wakeAll();
+}
+
+/**
+ *  \brief Whether the writer has switched to the segment the last
+ *         NewSegment() started, so that the segment before it is complete
+ *
+ *  A rendition whose encoder holds more frames than the main stream's only
+ *  gets there after the main stream has passed it some more.
+ */
+bool HLSRendition::IsSegmentCut(void)
+{
+    QMutexLocker locker(&m_lock);
+    return m_cutsMade >= m_cutsQueued;
+}
+
+/// \brief Encode what is left in the queue, close the file and stop.
+void HLSRendition::Finish(void)
+{
+    m_lock.lock();
+    m_finished = true;
+    m_wait.wakeAll();
+    m_lock.unlock();
+
+    wait();
+}
+
+void HLSRendition::Queue(const Item &Entry)
+{
+    QMutexLocker locker(&m_lock);
+    m_queue.append(Entry);
+    m_wait.wakeAll();
+}
+
+void HLSRendition::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+    while (!m_queue.isEmpty() || !m_finished)
+    {
+        if (m_queue.isEmpty())
+        {
+            m_wait.wait(locker.mutex());
+            continue;
+        }
+
+        Item item = m_queue.takeFirst();
+        locker.unlock();
+
+        bool cut = ProcessItem(item);
+
+        locker.relock();
+        if (cut)
+            m_cutsMade++;
+        if (item.m_frame)
+            m_freeFrames.append(item.m_frame);
+        m_wait.wakeAll();
+    }
+    locker.unlock();
+
+    m_writer->CloseFile();
+
+    RunEpilog();
+}
+
+/// \return true if the rendition switched to a new segment
+bool HLSRendition::ProcessItem(Item &Entry)
+{
+    if (Entry.m_type == kSegment)
+    {
+        m_cut.Schedule(Entry.m_cutFrame, Entry.m_filename);
+        return false;
+    }
+
+    // Use the main stream's starting timecode, so that the renditions'
+    // timestamps line up with it
+    if ((Entry.m_offset != -1ms) && (m_writer->GetTimecodeOffset() == -1ms))
+        m_writer->SetTimecodeOffset(Entry.m_offset);
+
+    if (Entry.m_type == kAudio)
+    {
+        auto *buf = reinterpret_cast<unsigned char *>(Entry.m_audio.data());
+        m_writer->WriteAudioFrame(buf, m_audioFrame++, Entry.m_timecode);
+        return false;
+    }
+
+    bool opened = true;
+    bool cut = m_cut.BeforeFrame(*m_writer, &opened);
+    if (!opened)
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to open the next segment");
+
+    Entry.m_frame->m_timecode = Entry.m_timecode;
+    m_writer->WriteVideoFrame(Entry.m_frame);
+    return cut;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
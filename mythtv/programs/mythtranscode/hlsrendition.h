@@ -0,0 +1,109 @@
+#ifndef HLSRENDITION_H
+#define HLSRENDITION_H
+
+// C++
+#include <array>
+#include <memory>
+
+// Qt
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV
+#include "mthread.h"
+#include "mythframe.h"
+#include "hlssegmentcut.h"
+
+class MythAVFormatWriter;
+
+/** \class HLSRendition
+ *  \brief Encodes one lower resolution rendition of an HTTP Live Stream
+ *
+ *  The transcoder decodes the source once and hands every frame it writes
+ *  to each rendition, scaled down into one of the rendition's own frames.
+ *  The audio it writes is copied as well.  Each rendition has its own
+ *  encoder running in its own thread, so a ladder of bitrates costs one
+ *  decode and one encode per core rather than a whole transcode each.
+ *
+ *  Segments are cut at the same input frame as the main stream, which
+ *  NewSegment() passes on before that frame is queued.  The rendition's
+ *  writer codes it as an IDR frame and switches files just before its
+ *  encoder returns it (see HLSSegmentCut).  That can be a few frames after
+ *  the main stream has cut, so IsSegmentCut() tells when the segment before
+ *  it is complete and can go into the playlist.
+ */
+class HLSRendition : public MThread
+{
+  public:
+    HLSRendition(int Width, int Height, int Bitrate);
+   ~HLSRendition() override;
+
+    bool Init(float Aspect, double FrameRate, int AudioBitrate,
+              int AudioChannels, int AudioRate, const QString &Filename);
+
+    int  GetWidth(void) const  { return m_width;  }
+    int  GetHeight(void) const { return m_height; }
+
+    void WriteVideo(const MythVideoFrame *Frame,
+                    std::chrono::milliseconds Timecode,
+                    std::chrono::milliseconds Offset);
+    void WriteAudio(const unsigned char *Buffer, int Size,
+                    std::chrono::milliseconds Timecode,
+                    std::chrono::milliseconds Offset);
+    void NewSegment(const QString &Filename, long long Frame);
+    bool IsSegmentCut(void);
+    void Finish(void);
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    Q_DISABLE_COPY(HLSRendition)
+
+    enum ItemType
+    {
+        kVideo,
+        kAudio,
+        kSegment
+    };
+
+    struct Item
+    {
+        ItemType                  m_type   { kVideo };
+        MythVideoFrame           *m_frame  { nullptr };
+        QByteArray                m_audio;
+        QString                   m_filename;
+        long long                 m_cutFrame { -1 };
+        std::chrono::milliseconds m_timecode { 0ms };
+        std::chrono::milliseconds m_offset   { -1ms };
+    };
+
+    void Queue(const Item &Entry);
+    bool ProcessItem(Item &Entry);
+
+    static constexpr int kFrameCount { 4 };
+
+    int const                           m_width;
+    int const                           m_height;
+    int const                           m_bitrate;
+    std::unique_ptr<MythAVFormatWriter> m_writer;
+    struct SwsContext                  *m_scaler      { nullptr };
+    std::array<MythVideoFrame,kFrameCount> m_frames;
+    HLSSegmentCut                       m_cut;
+    int                                 m_audioFrame  { 0 };
+
+    QMutex                              m_lock; // Guards the following...
+    QWaitCondition                      m_wait;
+    QList<MythVideoFrame*>              m_freeFrames;
+    QList<Item>                         m_queue;
+    int                                 m_cutsQueued  { 0 };
+    int                                 m_cutsMade    { 0 };
+    bool                                m_finished    { false };
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,83 @@
+#ifndef HLSSEGMENTCUT_H
+#define HLSSEGMENTCUT_H
+
+// Qt headers
+#include <QString>
+
+/** \class HLSSegmentCut
+ *  \brief Where the next HTTP Live Stream segment starts
+ *
+ *  A cut is decided on the input side, as the frame that starts the new
+ *  segment goes into the encoders, and is given by that frame's index.
+ *  Every writer is forced to code that frame as an IDR frame and switches
+ *  files just before its encoder returns it.  The encoders may hold back
+ *  different numbers of frames, but each cuts at the same frame, so the
+ *  main stream and all of its renditions have the same segment boundaries.
+ */
+class HLSSegmentCut
+{
+  public:
+    /// Start a new segment, written to Filename, at input frame Frame
+    void Schedule(long long Frame, const QString &Filename = QString())
+    {
+        m_frame = Frame;
+        m_filename = Filename;
+    }
+
+    bool IsPending(void) const { return m_frame >= 0; }
+
+    /// Whether the frame about to go into the encoder must be a keyframe
+    bool IsCutFrame(long long FrameIn) const
+    {
+        return IsPending() && (FrameIn == m_frame);
+    }
+
+    /// Whether the encoder is about to return the first frame of the segment
+    bool IsDue(long long FrameOut) const
+    {
+        return IsPending() && (FrameOut >= m_frame);
+    }
+
+    /// Clear the cut once it is made, returning the new segment's file
+    QString Take(void)
+    {
+        m_frame = -1;
+        QString filename = m_filename;
+        m_filename.clear();
+        return filename;
+    }
+
+    /**
+     *  \brief Cut Out, if it is time to, as the next video frame goes in
+     *
+     *  Forces the frame that starts the segment to be a keyframe, and
+     *  switches Out to the new segment's file just before its encoder
+     *  returns that frame.
+     *
+     *  \param  Out     A MythAVFormatWriter, or a stand in for one
+     *  \param  Opened  Set to whether the new file could be opened, if cut
+     *  \return true if Out switched files
+     */
+    template <class Writer>
+    bool BeforeFrame(Writer &Out, bool *Opened = nullptr)
+    {
+        if (IsCutFrame(Out.GetFramesQueued()))
+            Out.ForceKeyFrame();
+
+        if (!IsDue(Out.GetFramesWritten()))
+            return false;
+
+        bool opened = Out.ReOpen(Take());
+        if (Opened)
+            *Opened = opened;
+        return true;
+    }
+
+  private:
+    long long m_frame    { -1 };
+    QString   m_filename;
+};
+
+#endif // HLSSEGMENTCUT_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,1083 @@
+// C++ headers
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThread>
+
+// MythTV headers
+#include "exitcodes.h"
+#include "mythlogging.h"
+#include "mthreadpool.h"
+#include "transcodedefs.h"
+#include "losslesscutter.h"
+
+extern "C" {
+#include "libavutil/opt.h"
+}
+
+#define LOC QString("LosslessCutter: ")
+
+// Number of groups of pictures that may wait to be written before reading
+// stops until the oldest one has been re-encoded.
+static constexpr size_t kMaxQueuedBatches { 64 };
+
+// Number of audio and subtitle packets that may wait for the video time
+// line to catch up with them.
+static constexpr size_t kMaxPendingPackets { 4096 };
+
+/// \brief Calls func with the type, data and size of each NAL unit of an
+///        Annex B H.264 or HEVC packet. The units include their start codes.
+template <typename F>
+static void for_each_nal(AVCodecID codec, const uint8_t *data, int size,
+                         F func)
+{
+    int unit = -1;
+    int type = -1;
+    for (int i = 0; i + 3 <= size; i++)
+    {
+        if ((data[i] != 0) || (data[i + 1] != 0) || (data[i + 2] != 1))
+            continue;
+        int begin = ((i > 0) && (data[i - 1] == 0)) ? i - 1 : i;
+        if (unit >= 0)
+            func(type, data + unit, begin - unit);
+        unit = begin;
+        type = -1;
+        if (i + 3 < size)
+        {
+            type = (codec == AV_CODEC_ID_HEVC) ?
+                (data[i + 3] >> 1) & 0x3f : data[i + 3] & 0x1f;
+        }
+        i += 2;
+    }
+    if (unit >= 0)
+        func(type, data + unit, size - unit);
+}
+
+static bool is_param_set(AVCodecID codec, int type)
+{
+    if (codec == AV_CODEC_ID_HEVC)
+        return (type >= 32) && (type <= 34); // VPS, SPS, PPS
+    return (type == 7) || (type == 8);       // SPS, PPS
+}
+
+static bool is_idr(AVCodecID codec, int type)
+{
+    if (codec == AV_CODEC_ID_HEVC)
+        return (type == 19) || (type == 20); // IDR_W_RADL, IDR_N_LP
+    return type == 5;
+}
+
+/// \brief Returns the parameter sets in data, with their start codes.
+static QByteArray get_param_sets(AVCodecID codec, const uint8_t *data,
+                                 int size)
+{
+    QByteArray sets;
+    for_each_nal(codec, data, size,
+        [codec, &sets](int type, const uint8_t *nal, int len)
+        {
+            if (is_param_set(codec, type))
+                sets.append(reinterpret_cast<const char*>(nal), len);
+        });
+    return sets;
+}
+
+/// \brief Inserts parameter sets into an Annex B packet, after its access
+///        unit delimiter if it starts with one.
+static bool insert_param_sets(AVCodecID codec, AVPacket *pkt,
+                              const QByteArray &sets)
+{
+    int offset = 0;
+    bool first = true;
+    for_each_nal(codec, pkt->data, pkt->size,
+        [codec, pkt, &offset, &first](int type, const uint8_t *nal, int len)
+        {
+            bool aud = (codec == AV_CODEC_ID_HEVC) ? (type == 35) : (type == 9);
+            if (first && aud)
+                offset = static_cast<int>(nal - pkt->data) + len;
+            first = false;
+        });
+
+    AVPacket *tmp = av_packet_alloc();
+    if (!tmp || (av_new_packet(tmp, sets.size() + pkt->size) < 0) ||
+        (av_packet_copy_props(tmp, pkt) < 0))
+    {
+        av_packet_free(&tmp);
+        return false;
+    }
+    memcpy(tmp->data, pkt->data, offset);
+    memcpy(tmp->data + offset, sets.constData(), sets.size());
+    memcpy(tmp->data + offset + sets.size(), pkt->data + offset,
+           pkt->size - offset);
+    av_packet_unref(pkt);
+    av_packet_move_ref(pkt, tmp);
+    av_packet_free(&tmp);
+    return true;
+}
+
+/// One group of pictures, along with the other packets that go with it.
+class LosslessCutterBatch
+{
+  public:
+    enum Action
+    {
+        kCopy,
+        kDrop,
+        kReencode,
+    };
+
+    ~LosslessCutterBatch()
+    {
+        for (auto *list : { &m_video, &m_warmup, &m_other, &m_encoded })
+        {
+            for (auto *pkt : *list)
+                av_packet_free(&pkt);
+        }
+    }
+
+    int64_t                m_firstFrame {0};
+    Action                 m_action     {kCopy};
+    QByteArray             m_paramSets; ///< to insert before the keyframe
+    std::vector<AVPacket*> m_video;     ///< in decode order
+    std::vector<AVPacket*> m_warmup;    ///< the previous group of pictures
+    std::vector<AVPacket*> m_other;
+    std::vector<AVPacket*> m_encoded;
+    std::vector<int64_t>   m_keepPts;   ///< sorted
+    std::vector<int64_t>   m_keepDts;   ///< decode time stamp for each
+
+    // Guarded by LosslessCutter::m_readyLock
+    bool                   m_ready      {true};
+    bool                   m_ok         {true};
+};
+
+/// Re-encodes the kept frames of a group of pictures that a cut point
+/// falls into.
+class LosslessCutterJob : public QRunnable
+{
+  public:
+    LosslessCutterJob(LosslessCutter *cutter, LosslessCutterBatch *batch)
+      : m_cutter(cutter), m_batch(batch) {}
+
+    ~LosslessCutterJob() override
+    {
+        av_frame_free(&m_frame);
+        avcodec_free_context(&m_dec);
+        avcodec_free_context(&m_enc);
+    }
+
+    void run(void) override
+    {
+        bool ok = Reencode();
+        QMutexLocker locker(&m_cutter->m_readyLock);
+        m_batch->m_ok = ok;
+        m_batch->m_ready = true;
+        m_cutter->m_readyWait.wakeAll();
+    }
+
+  private:
+    bool Reencode(void);
+    bool ReceiveFrames(void);
+    bool OpenEncoder(const AVFrame *frame);
+    bool Encode(AVFrame *frame);
+
+    LosslessCutter      *m_cutter  {nullptr};
+    LosslessCutterBatch *m_batch   {nullptr};
+    AVStream            *m_stream  {nullptr};
+    AVCodecContext      *m_dec     {nullptr};
+    AVCodecContext      *m_enc     {nullptr};
+    AVFrame             *m_frame   {nullptr};
+};
+
+bool LosslessCutterJob::Reencode(void)
+{
+    m_stream = m_cutter->m_inputFC->streams[m_cutter->m_vidId];
+
+    const AVCodec *decoder = avcodec_find_decoder(m_stream->codecpar->codec_id);
+    if (!decoder)
+        return false;
+
+    m_dec = avcodec_alloc_context3(decoder);
+    m_frame = av_frame_alloc();
+    if (!m_dec || !m_frame ||
+        avcodec_parameters_to_context(m_dec, m_stream->codecpar) < 0)
+        return false;
+
+    m_dec->pkt_timebase = m_stream->time_base;
+    m_dec->thread_count = 1;
+    if (avcodec_open2(m_dec, decoder, nullptr) < 0)
+        return false;
+
+    // Decode the previous group of pictures too, any leading frames of
+    // an open group of pictures refer to it.
+    for (auto *list : { &m_batch->m_warmup, &m_batch->m_video })
+    {
+        for (auto *pkt : *list)
+        {
+            // Broken packets only cost the frames that depend on them
+            avcodec_send_packet(m_dec, pkt);
+            if (!ReceiveFrames())
+                return false;
+        }
+    }
+    avcodec_send_packet(m_dec, nullptr);
+    if (!ReceiveFrames())
+        return false;
+
+    if (!m_enc)
+        return false;
+
+    if (!Encode(nullptr))
+        return false;
+
+    if (m_batch->m_encoded.size() < m_batch->m_keepPts.size())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Lost %1 undecodable frames at frame %2")
+                .arg(m_batch->m_keepPts.size() - m_batch->m_encoded.size())
+                .arg(m_batch->m_firstFrame));
+    }
+    return true;
+}
+
+bool LosslessCutterJob::ReceiveFrames(void)
+{
+    while (avcodec_receive_frame(m_dec, m_frame) == 0)
+    {
+        int64_t pts = m_frame->best_effort_timestamp;
+        if (std::binary_search(m_batch->m_keepPts.cbegin(),
+                               m_batch->m_keepPts.cend(), pts))
+        {
+            m_frame->pts = pts;
+            m_frame->pict_type = AV_PICTURE_TYPE_NONE;
+            if ((!m_enc && !OpenEncoder(m_frame)) || !Encode(m_frame))
+            {
+                av_frame_unref(m_frame);
+                return false;
+            }
+        }
+        av_frame_unref(m_frame);
+    }
+    return true;
+}
+
+bool LosslessCutterJob::OpenEncoder(const AVFrame *frame)
+{
+    const AVCodec *encoder = m_cutter->m_encoder;
+    const AVCodecParameters *par = m_stream->codecpar;
+
+    m_enc = avcodec_alloc_context3(encoder);
+    if (!m_enc)
+        return false;
+
+    m_enc->width = frame->width;
+    m_enc->height = frame->height;
+    m_enc->pix_fmt = static_cast<AVPixelFormat>(frame->format);
+    m_enc->sample_aspect_ratio = frame->sample_aspect_ratio.num ?
+        frame->sample_aspect_ratio : par->sample_aspect_ratio;
+    m_enc->time_base = m_stream->time_base;
+    m_enc->framerate = m_stream->avg_frame_rate.num ?
+        m_stream->avg_frame_rate : m_stream->r_frame_rate;
+    m_enc->color_range = par->color_range;
+    m_enc->color_primaries = par->color_primaries;
+    m_enc->color_trc = par->color_trc;
+    m_enc->colorspace = par->color_space;
+    m_enc->chroma_sample_location = par->chroma_location;
+    m_enc->field_order = par->field_order;
+    if (frame->interlaced_frame)
+        m_enc->flags |= AV_CODEC_FLAG_INTERLACED_DCT | AV_CODEC_FLAG_INTERLACED_ME;
+
+    // A single keyframe and no reordering keeps the time stamps of the
+    // frames around it valid.
+    m_enc->gop_size = static_cast<int>(m_batch->m_keepPts.size()) + 1;
+    m_enc->max_b_frames = 0;
+    m_enc->thread_count = 1;
+    av_opt_set(m_enc->priv_data, "crf", "16", 0);
+
+    if (avcodec_open2(m_enc, encoder, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to open the %1 encoder").arg(encoder->name));
+        return false;
+    }
+    return true;
+}
+
+bool LosslessCutterJob::Encode(AVFrame *frame)
+{
+    if (avcodec_send_frame(m_enc, frame) < 0)
+        return false;
+
+    while (true)
+    {
+        AVPacket *pkt = av_packet_alloc();
+        int ret = avcodec_receive_packet(m_enc, pkt);
+        if (ret < 0)
+        {
+            av_packet_free(&pkt);
+            return (ret == AVERROR(EAGAIN)) || (ret == AVERROR_EOF);
+        }
+        m_batch->m_encoded.push_back(pkt);
+    }
+}
+
+LosslessCutter::LosslessCutter(QString inFile, QString outFile,
+                               const frm_dir_map_t &deleteMap,
+                               bool showProgress,
+                               void (*update_func)(float),
+                               int (*check_func)())
+  : m_inFile(std::move(inFile)), m_outFile(std::move(outFile)),
+    m_showProgress(showProgress), m_updateStatus(update_func),
+    m_checkAbort(check_func)
+{
+    // Frames [start, end) of each cut are removed
+    int64_t start = -1;
+    for (auto it = deleteMap.cbegin(); it != deleteMap.cend(); ++it)
+    {
+        auto frame = static_cast<int64_t>(it.key());
+        if (*it == MARK_CUT_START)
+        {
+            if (start < 0)
+                start = frame;
+        }
+        else if (*it == MARK_CUT_END)
+        {
+            if (start >= 0)
+                m_cuts.push_back({start, frame});
+            else if (m_cuts.empty())
+                m_cuts.push_back({0, frame});
+            start = -1;
+        }
+    }
+    if (start >= 0)
+        m_cuts.push_back({start, INT64_MAX});
+}
+
+LosslessCutter::~LosslessCutter()
+{
+    Close();
+}
+
+/// \brief Returns the codec of the video of inFile, or AV_CODEC_ID_NONE if
+///        it can't be read.
+AVCodecID LosslessCutter::VideoCodec(const QString &inFile)
+{
+    AVFormatContext *ic = nullptr;
+    if (avformat_open_input(&ic, inFile.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+        return AV_CODEC_ID_NONE;
+
+    AVCodecID codec = AV_CODEC_ID_NONE;
+    if (avformat_find_stream_info(ic, nullptr) >= 0)
+    {
+        int index = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                        nullptr, 0);
+        if (index >= 0)
+            codec = ic->streams[index]->codecpar->codec_id;
+    }
+    avformat_close_input(&ic);
+    return codec;
+}
+
+/// \brief Returns true if video of the given codec can be cut by
+///        LosslessCutter.
+bool LosslessCutter::CanCut(AVCodecID codec)
+{
+    return (codec == AV_CODEC_ID_H264) || (codec == AV_CODEC_ID_HEVC);
+}
+
+int LosslessCutter::BuildKeyframeIndex(const QString &file,
+                                       frm_pos_map_t &posMap,
+                                       frm_pos_map_t &durMap)
+{
+    LOG(VB_GENERAL, LOG_INFO, "Generating Keyframe Index");
+
+    AVFormatContext *ic = nullptr;
+    if (avformat_open_input(&ic, file.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+        return GENERIC_EXIT_NOT_OK;
+
+    int vidId = -1;
+    if (avformat_find_stream_info(ic, nullptr) >= 0)
+        vidId = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (vidId < 0)
+    {
+        avformat_close_input(&ic);
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    for (uint i = 0; i < ic->nb_streams; i++)
+    {
+        if (static_cast<int>(i) != vidId)
+            ic->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    AVPacket *pkt = av_packet_alloc();
+    int count = 0;
+    uint64_t totalDuration = 0;
+    while (av_read_frame(ic, pkt) >= 0)
+    {
+        if (pkt->stream_index == vidId)
+        {
+            if (pkt->flags & AV_PKT_FLAG_KEY)
+            {
+                posMap[count] = pkt->pos;
+                durMap[count] = totalDuration;
+            }
+
+            totalDuration +=
+                av_q2d(ic->streams[vidId]->time_base) *
+                pkt->duration * 1000; // msec
+            count++;
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    avformat_close_input(&ic);
+
+    return REENCODE_OK;
+}
+
+int LosslessCutter::Start(void)
+{
+    if (!OpenInput() || !OpenOutput())
+    {
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    m_pool = new MThreadPool("LosslessCutter");
+    m_pool->setMaxThreadCount(std::max(QThread::idealThreadCount() - 1, 1));
+
+    QElapsedTimer flagTime;
+    flagTime.start();
+    QElapsedTimer statusTime;
+    statusTime.start();
+    int statusInterval = m_updateStatus ? 20000 : 5000;
+    if (m_updateStatus)
+        m_updateStatus(0);
+
+    int result = REENCODE_OK;
+    AVPacket *pkt = av_packet_alloc();
+    LosslessCutterBatch *batch = nullptr;
+    int64_t frame = 0;
+
+    while (m_ok && av_read_frame(m_inputFC, pkt) >= 0)
+    {
+        int index = pkt->stream_index;
+        if ((index >= static_cast<int>(m_streamMap.size())) ||
+            (m_streamMap[index] < 0))
+        {
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        if (index == m_vidId)
+        {
+            if (pkt->flags & AV_PKT_FLAG_KEY)
+            {
+                if (batch)
+                    Dispatch(batch);
+                batch = new LosslessCutterBatch;
+                batch->m_firstFrame = frame;
+            }
+
+            // Frames before the first keyframe can't be decoded, and
+            // aren't counted by the player either.
+            if (batch)
+            {
+                batch->m_video.push_back(av_packet_clone(pkt));
+                frame++;
+            }
+        }
+        else
+        {
+            m_otherPackets.push_back(av_packet_clone(pkt));
+        }
+        av_packet_unref(pkt);
+
+        if (statusTime.elapsed() > statusInterval)
+        {
+            statusTime.restart();
+            UpdateProgress();
+            if (m_checkAbort && m_checkAbort())
+            {
+                result = REENCODE_STOPPED;
+                break;
+            }
+        }
+    }
+    av_packet_free(&pkt);
+
+    if (result == REENCODE_OK && m_ok)
+    {
+        if (batch)
+            Dispatch(batch);
+        batch = new LosslessCutterBatch;
+        ReleaseOtherPackets(batch, true);
+        m_batches.push_back(batch);
+        batch = nullptr;
+        Drain(0);
+    }
+    delete batch;
+
+    m_pool->waitForDone();
+    delete m_pool;
+    m_pool = nullptr;
+
+    for (auto *queued : m_batches)
+        delete queued;
+    m_batches.clear();
+
+    if (result == REENCODE_OK && !m_ok)
+        result = REENCODE_ERROR;
+
+    if (result == REENCODE_OK && av_write_trailer(m_outputFC) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to finish %1").arg(m_outFile));
+        result = REENCODE_ERROR;
+    }
+
+    Close();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Copied %1, dropped %2 and re-encoded %3 groups of pictures "
+                "in %4 seconds")
+            .arg(m_gopsCopied).arg(m_gopsDropped).arg(m_gopsReencoded)
+            .arg(flagTime.elapsed() / 1000.0, 0, 'f', 1));
+
+    return result;
+}
+
+bool LosslessCutter::OpenInput(void)
+{
+    if (avformat_open_input(&m_inputFC, m_inFile.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to open %1").arg(m_inFile));
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_inputFC, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to find stream info in %1").arg(m_inFile));
+        return false;
+    }
+
+    m_vidId = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO, -1, -1,
+                                  nullptr, 0);
+    if (m_vidId < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No video stream in %1").arg(m_inFile));
+        return false;
+    }
+
+    AVStream *st = m_inputFC->streams[m_vidId];
+    m_vidTimeBase = st->time_base;
+    m_codec = st->codecpar->codec_id;
+    AVRational rate = st->avg_frame_rate.num ?
+        st->avg_frame_rate : st->r_frame_rate;
+    if (rate.num && rate.den)
+        m_frameDuration = av_rescale_q(1, av_inv_q(rate), m_vidTimeBase);
+
+    return true;
+}
+
+bool LosslessCutter::OpenOutput(void)
+{
+    // The output uses the container of the recording
+    QByteArray format =
+        QString(m_inputFC->iformat->name).section(',', 0, 0).toLatin1();
+    QByteArray filename = m_outFile.toLocal8Bit();
+    if (avformat_alloc_output_context2(&m_outputFC, nullptr,
+                                       format.constData(),
+                                       filename.constData()) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to create a %1 output").arg(format.constData()));
+        return false;
+    }
+
+    m_streamMap.assign(m_inputFC->nb_streams, -1);
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream *in = m_inputFC->streams[i];
+        AVMediaType type = in->codecpar->codec_type;
+        bool wanted = (static_cast<int>(i) == m_vidId) ||
+            ((type == AVMEDIA_TYPE_AUDIO) && (in->codecpar->channels > 0)) ||
+            (type == AVMEDIA_TYPE_SUBTITLE);
+        if (!wanted)
+        {
+            in->discard = AVDISCARD_ALL;
+            continue;
+        }
+
+        AVStream *out = avformat_new_stream(m_outputFC, nullptr);
+        if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0)
+            return false;
+        out->codecpar->codec_tag = 0;
+        out->time_base = in->time_base;
+        out->disposition = in->disposition;
+        av_dict_copy(&out->metadata, in->metadata, 0);
+        m_streamMap[i] = out->index;
+    }
+    m_lastDts.assign(m_outputFC->nb_streams, AV_NOPTS_VALUE);
+
+    if (!(m_outputFC->oformat->flags & AVFMT_NOFILE) &&
+        (avio_open(&m_outputFC->pb, filename.constData(), AVIO_FLAG_WRITE) < 0))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to create %1").arg(m_outFile));
+        return false;
+    }
+
+    if (avformat_write_header(m_outputFC, nullptr) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to write the header of %1").arg(m_outFile));
+        return false;
+    }
+
+    // Re-encoded frames carry their parameter sets in band, which doesn't
+    // work for containers that store them once in the header.
+    m_annexB = !(m_outputFC->oformat->flags & AVFMT_GLOBALHEADER);
+    if (m_annexB)
+    {
+        if (m_codec == AV_CODEC_ID_H264)
+            m_encoder = avcodec_find_encoder_by_name("libx264");
+        else if (m_codec == AV_CODEC_ID_HEVC)
+            m_encoder = avcodec_find_encoder_by_name("libx265");
+
+        const AVCodecParameters *par = m_inputFC->streams[m_vidId]->codecpar;
+        if (par->extradata)
+        {
+            m_paramSets = get_param_sets(m_codec, par->extradata,
+                                         par->extradata_size);
+        }
+    }
+    if (!m_encoder)
+    {
+        LOG(VB_GENERAL, LOG_NOTICE, LOC +
+            "No encoder for the video, cutting at keyframes");
+    }
+
+    return true;
+}
+
+void LosslessCutter::Close(void)
+{
+    for (auto *pkt : m_lastGop)
+        av_packet_free(&pkt);
+    m_lastGop.clear();
+    for (auto *pkt : m_otherPackets)
+        av_packet_free(&pkt);
+    m_otherPackets.clear();
+
+    if (m_inputFC)
+        avformat_close_input(&m_inputFC);
+
+    if (m_outputFC)
+    {
+        if (!(m_outputFC->oformat->flags & AVFMT_NOFILE))
+            avio_closep(&m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+        m_outputFC = nullptr;
+    }
+}
+
+bool LosslessCutter::IsCut(int64_t frame) const
+{
+    return std::any_of(m_cuts.cbegin(), m_cuts.cend(),
+        [frame](const CutRange &cut)
+            { return (frame >= cut.m_start) && (frame < cut.m_end); });
+}
+
+/** \brief Notes the state of the frame at pts, in display order.
+ *
+ *   The time stamps after a cut are moved back by the length of all cuts
+ *   so far, so that the kept parts are contiguous.
+ */
+void LosslessCutter::AddTimelineEntry(int64_t pts, bool keep)
+{
+    if (!m_timeline.empty() && (m_timeline.back().m_keep == keep))
+        return;
+
+    if (!keep)
+    {
+        m_cutStart = pts;
+    }
+    else if (m_cutStart != AV_NOPTS_VALUE)
+    {
+        m_removed += pts - m_cutStart;
+        m_cutStart = AV_NOPTS_VALUE;
+    }
+    m_timeline.push_back({pts, keep, m_removed});
+}
+
+/** \brief Looks up a time stamp in the video time line.
+ *
+ *  \param pts    Time stamp in the video stream's time base
+ *  \param offset Set to the amount to move kept time stamps back by
+ *  \return true if the time stamp is in a kept part
+ */
+bool LosslessCutter::FindTimelineEntry(int64_t pts, int64_t &offset) const
+{
+    offset = 0;
+    if (m_timeline.empty())
+        return true;
+
+    auto it = std::upper_bound(m_timeline.cbegin(), m_timeline.cend(), pts,
+        [](int64_t value, const TimelineEntry &entry)
+            { return value < entry.m_start; });
+    if (it == m_timeline.cbegin())
+        return it->m_keep;
+
+    --it;
+    offset = it->m_offset;
+    return it->m_keep;
+}
+
+/** \brief Decides what to do with a complete group of pictures, queues it
+ *         for writing, and writes whatever is ready.
+ */
+void LosslessCutter::Dispatch(LosslessCutterBatch *batch)
+{
+    // Number the frames in display order, as the player does
+    std::vector<int64_t> pts;
+    std::vector<int64_t> dts;
+    for (const auto *pkt : batch->m_video)
+    {
+        int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+        if (ts != AV_NOPTS_VALUE)
+        {
+            pts.push_back(ts);
+            dts.push_back((pkt->dts != AV_NOPTS_VALUE) ? pkt->dts : ts);
+        }
+    }
+    if (pts.empty())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Dropping untimed video at frame %1")
+                .arg(batch->m_firstFrame));
+        delete batch;
+        return;
+    }
+    std::sort(pts.begin(), pts.end());
+    std::sort(dts.begin(), dts.end());
+
+    // Note the parameter sets in force at the keyframe, and any that
+    // follow it
+    bool idr = false;
+    bool keyHasParamSets = false;
+    QByteArray paramSets = m_paramSets;
+    if (m_annexB)
+    {
+        for (size_t i = 0; i < batch->m_video.size(); i++)
+        {
+            const AVPacket *pkt = batch->m_video[i];
+            QByteArray sets;
+            for_each_nal(m_codec, pkt->data, pkt->size,
+                [this, i, &idr, &sets](int type, const uint8_t *nal, int len)
+                {
+                    if (is_param_set(m_codec, type))
+                        sets.append(reinterpret_cast<const char*>(nal), len);
+                    else if ((i == 0) && is_idr(m_codec, type))
+                        idr = true;
+                });
+            if (sets.isEmpty())
+                continue;
+            keyHasParamSets = keyHasParamSets || (i == 0);
+            m_paramSets = sets;
+        }
+    }
+
+    std::vector<bool> keep(pts.size());
+    size_t kept = 0;
+    for (size_t i = 0; i < pts.size(); i++)
+    {
+        keep[i] = !IsCut(batch->m_firstFrame + static_cast<int64_t>(i));
+        kept += keep[i] ? 1 : 0;
+    }
+
+    if (kept == pts.size())
+    {
+        batch->m_action = LosslessCutterBatch::kCopy;
+    }
+    else if (kept == 0)
+    {
+        batch->m_action = LosslessCutterBatch::kDrop;
+    }
+    else if (m_encoder)
+    {
+        batch->m_action = LosslessCutterBatch::kReencode;
+    }
+    else
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Keeping all of the group of pictures at frame %1")
+                .arg(batch->m_firstFrame));
+        keep.assign(keep.size(), true);
+        batch->m_action = LosslessCutterBatch::kCopy;
+    }
+
+    // The leading frames of an open group of pictures refer to frames of
+    // the previous one, which is no longer in the output as it was.
+    int64_t keyPts = batch->m_video.front()->pts;
+    size_t leading = 0;
+    if ((batch->m_action == LosslessCutterBatch::kCopy) && !m_lastGopIntact &&
+        !idr && (keyPts != AV_NOPTS_VALUE))
+    {
+        for (size_t i = 0; i < pts.size() && pts[i] < keyPts; i++)
+        {
+            leading += keep[i] ? 1 : 0;
+            keep[i] = false;
+        }
+        if (leading > 0)
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Dropping %1 leading frames of the group of pictures "
+                        "at frame %2").arg(leading).arg(batch->m_firstFrame));
+        }
+    }
+
+    // Its keyframe may rely on parameter sets sent before the cut
+    if ((batch->m_action == LosslessCutterBatch::kCopy) && !m_lastGopIntact &&
+        !keyHasParamSets)
+    {
+        batch->m_paramSets = paramSets;
+    }
+
+    for (size_t i = 0; i < pts.size(); i++)
+        AddTimelineEntry(pts[i], keep[i]);
+
+    int64_t until = pts.back() + m_frameDuration;
+    if ((m_resolvedUntil == AV_NOPTS_VALUE) || (until > m_resolvedUntil))
+        m_resolvedUntil = until;
+
+    // Keep the packets around, the next group of pictures may need them
+    // to decode its leading frames.
+    std::vector<AVPacket*> previousGop;
+    previousGop.swap(m_lastGop);
+
+    switch (batch->m_action)
+    {
+        case LosslessCutterBatch::kCopy:
+            m_gopsCopied++;
+            for (const auto *pkt : batch->m_video)
+                m_lastGop.push_back(av_packet_clone(pkt));
+            break;
+        case LosslessCutterBatch::kDrop:
+            m_gopsDropped++;
+            m_lastGop.swap(batch->m_video);
+            break;
+        case LosslessCutterBatch::kReencode:
+            m_gopsReencoded++;
+            // The n-th frame shown is always decoded by the n-th decode
+            // time stamp, so that gives the kept frames valid ones that
+            // fit in with the groups of pictures around them.
+            for (size_t i = 0; i < pts.size(); i++)
+            {
+                if (keep[i])
+                {
+                    batch->m_keepPts.push_back(pts[i]);
+                    batch->m_keepDts.push_back(dts[i]);
+                }
+            }
+            batch->m_warmup.swap(previousGop);
+            for (const auto *pkt : batch->m_video)
+                m_lastGop.push_back(av_packet_clone(pkt));
+            batch->m_ready = false;
+            break;
+    }
+    for (auto *pkt : previousGop)
+        av_packet_free(&pkt);
+    m_lastGopIntact = (batch->m_action == LosslessCutterBatch::kCopy);
+
+    if (leading > 0)
+    {
+        auto is_leading = [keyPts](AVPacket *pkt)
+        {
+            if ((pkt->pts == AV_NOPTS_VALUE) || (pkt->pts >= keyPts))
+                return false;
+            av_packet_free(&pkt);
+            return true;
+        };
+        batch->m_video.erase(std::remove_if(batch->m_video.begin(),
+                                            batch->m_video.end(), is_leading),
+                             batch->m_video.end());
+    }
+
+    ReleaseOtherPackets(batch, false);
+    m_batches.push_back(batch);
+
+    if (batch->m_action == LosslessCutterBatch::kReencode)
+        m_pool->start(new LosslessCutterJob(this, batch), "LosslessCutterJob");
+
+    Drain(kMaxQueuedBatches);
+}
+
+/** \brief Moves the audio and subtitle packets the video time line has
+ *         caught up with to batch, dropping those in cut parts.
+ */
+void LosslessCutter::ReleaseOtherPackets(LosslessCutterBatch *batch, bool all)
+{
+    while (!m_otherPackets.empty())
+    {
+        AVPacket *pkt = m_otherPackets.front();
+        AVStream *st = m_inputFC->streams[pkt->stream_index];
+        int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+        int64_t vts = AV_NOPTS_VALUE;
+        if (ts != AV_NOPTS_VALUE)
+            vts = av_rescale_q(ts, st->time_base, m_vidTimeBase);
+
+        bool force = all || (m_otherPackets.size() > kMaxPendingPackets);
+        if (!force && (vts != AV_NOPTS_VALUE) &&
+            ((m_resolvedUntil == AV_NOPTS_VALUE) || (vts >= m_resolvedUntil)))
+            break;
+        m_otherPackets.pop_front();
+
+        int64_t offset = 0;
+        bool keep = (vts != AV_NOPTS_VALUE) ? FindTimelineEntry(vts, offset) :
+            (m_timeline.empty() || m_timeline.back().m_keep);
+        if (keep)
+            batch->m_other.push_back(pkt);
+        else
+            av_packet_free(&pkt);
+    }
+}
+
+/** \brief Writes the queued batches in order, until one is still being
+ *         re-encoded and no more than maxQueued batches are queued.
+ */
+bool LosslessCutter::Drain(size_t maxQueued)
+{
+    while (m_ok && !m_batches.empty())
+    {
+        LosslessCutterBatch *batch = m_batches.front();
+        {
+            QMutexLocker locker(&m_readyLock);
+            while (!batch->m_ready)
+            {
+                if (m_batches.size() <= maxQueued)
+                    return true;
+                m_readyWait.wait(&m_readyLock);
+            }
+        }
+
+        if (!batch->m_ok)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Unable to re-encode the frames at frame %1")
+                    .arg(batch->m_firstFrame));
+            m_ok = false;
+            break;
+        }
+
+        if (batch->m_action == LosslessCutterBatch::kCopy)
+        {
+            if (!batch->m_paramSets.isEmpty() && !batch->m_video.empty() &&
+                !insert_param_sets(m_codec, batch->m_video.front(),
+                                   batch->m_paramSets))
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC + "Out of memory");
+                m_ok = false;
+                break;
+            }
+            for (auto *pkt : batch->m_video)
+                m_ok = m_ok && Write(pkt);
+        }
+        else if (batch->m_action == LosslessCutterBatch::kReencode)
+        {
+            for (auto *pkt : batch->m_encoded)
+            {
+                pkt->stream_index = m_vidId;
+                auto it = std::lower_bound(batch->m_keepPts.cbegin(),
+                                           batch->m_keepPts.cend(), pkt->pts);
+                if ((it != batch->m_keepPts.cend()) && (*it == pkt->pts))
+                    pkt->dts = batch->m_keepDts[it - batch->m_keepPts.cbegin()];
+                m_ok = m_ok && Write(pkt);
+            }
+        }
+        for (auto *pkt : batch->m_other)
+            m_ok = m_ok && Write(pkt);
+
+        m_batches.pop_front();
+        delete batch;
+    }
+    return m_ok;
+}
+
+/// \brief Moves the time stamps of an input packet into place and writes it.
+bool LosslessCutter::Write(AVPacket *pkt)
+{
+    int index = pkt->stream_index;
+    AVStream *in = m_inputFC->streams[index];
+    int out = m_streamMap[index];
+
+    int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+    if (ts != AV_NOPTS_VALUE)
+    {
+        int64_t offset = 0;
+        FindTimelineEntry(av_rescale_q(ts, in->time_base, m_vidTimeBase), offset);
+        offset = av_rescale_q(offset, m_vidTimeBase, in->time_base);
+        if (pkt->pts != AV_NOPTS_VALUE)
+            pkt->pts -= offset;
+        if (pkt->dts != AV_NOPTS_VALUE)
+            pkt->dts -= offset;
+    }
+
+    // Frames next to a cut may have been reordered by the encoder that
+    // originally produced them; keep the decode time stamps increasing.
+    // The presentation time stamp only moves along if the frame would
+    // otherwise be shown before it is decoded, and then keeps its original
+    // distance to the decode time stamp.
+    if (pkt->dts != AV_NOPTS_VALUE)
+    {
+        if ((m_lastDts[out] != AV_NOPTS_VALUE) && (pkt->dts <= m_lastDts[out]))
+        {
+            int64_t shift = m_lastDts[out] + 1 - pkt->dts;
+            int64_t delay = (pkt->pts != AV_NOPTS_VALUE) ?
+                pkt->pts - pkt->dts : 0;
+            pkt->dts += shift;
+            if ((pkt->pts != AV_NOPTS_VALUE) && (pkt->pts < pkt->dts))
+                pkt->pts = pkt->dts + std::max(delay, int64_t(0));
+        }
+        m_lastDts[out] = pkt->dts;
+    }
+
+    av_packet_rescale_ts(pkt, in->time_base, m_outputFC->streams[out]->time_base);
+    pkt->stream_index = out;
+    pkt->pos = -1;
+
+    if (av_interleaved_write_frame(m_outputFC, pkt) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to write to %1").arg(m_outFile));
+        return false;
+    }
+    return true;
+}
+
+void LosslessCutter::UpdateProgress(void)
+{
+    int64_t size = avio_size(m_inputFC->pb);
+    if (size <= 0)
+        return;
+
+    float percent_done = 100.0F * avio_tell(m_inputFC->pb) / size;
+    if (m_updateStatus)
+        m_updateStatus(percent_done);
+    if (m_showProgress)
+    {
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                .arg(percent_done, 0, 'f', 1));
+    }
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
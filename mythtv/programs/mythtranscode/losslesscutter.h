@@ -0,0 +1,138 @@
+#ifndef LOSSLESSCUTTER_H
+#define LOSSLESSCUTTER_H
+
+// C++ headers
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Qt headers
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+// MythTV headers
+#include "programtypes.h"               // for frm_dir_map_t, frm_pos_map_t
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+class MThreadPool;
+class LosslessCutterBatch;
+
+/** \class LosslessCutter
+ *  \brief Removes the cut list from an H.264 or HEVC recording without
+ *         transcoding it.
+ *
+ *   The recording is remuxed into the same container in a single streaming
+ *   pass. Groups of pictures that are entirely kept are copied packet by
+ *   packet, and groups that are entirely cut are dropped. Only the groups
+ *   of pictures a cut point falls into are decoded, and their kept frames
+ *   re-encoded. This is done on a thread pool while the copying continues,
+ *   so memory use stays at a few groups of pictures regardless of the
+ *   length of the recording.
+ *
+ *   Without a suitable encoder, cut points are moved out to the enclosing
+ *   keyframes so that no kept frame is lost.
+ *
+ *   The leading frames of an open group of pictures refer to the group
+ *   before it. When that group was dropped or re-encoded they can't be
+ *   decoded correctly, so they are dropped as well. The first group of
+ *   pictures copied after a cut gets the parameter sets in force at its
+ *   keyframe, in case they were only sent before the cut.
+ */
+class LosslessCutter
+{
+  public:
+    LosslessCutter(QString inFile, QString outFile,
+                   const frm_dir_map_t &deleteMap, bool showProgress,
+                   void (*update_func)(float) = nullptr,
+                   int (*check_func)() = nullptr);
+    ~LosslessCutter();
+
+    static AVCodecID VideoCodec(const QString &inFile);
+    static bool CanCut(AVCodecID codec);
+    static int BuildKeyframeIndex(const QString &file, frm_pos_map_t &posMap,
+                                  frm_pos_map_t &durMap);
+
+    int Start(void);
+
+    friend class LosslessCutterJob;
+
+  private:
+    struct CutRange
+    {
+        int64_t m_start;                // first cut frame
+        int64_t m_end;                  // first kept frame after the cut
+    };
+
+    /// A point in the video stream's time line from which on frames are
+    /// either all kept or all cut.
+    struct TimelineEntry
+    {
+        int64_t m_start;                // in video stream time base
+        bool    m_keep;
+        int64_t m_offset;               // removed before m_start
+    };
+
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    void Close(void);
+    bool IsCut(int64_t frame) const;
+    void AddTimelineEntry(int64_t pts, bool keep);
+    bool FindTimelineEntry(int64_t pts, int64_t &offset) const;
+    void Dispatch(LosslessCutterBatch *batch);
+    void ReleaseOtherPackets(LosslessCutterBatch *batch, bool all);
+    bool Drain(size_t maxQueued);
+    bool Write(AVPacket *pkt);
+    void UpdateProgress(void);
+
+    QString              m_inFile;
+    QString              m_outFile;
+    std::vector<CutRange> m_cuts;
+    bool                 m_showProgress {false};
+    void               (*m_updateStatus)(float) {nullptr};
+    int                (*m_checkAbort)() {nullptr};
+
+    AVFormatContext     *m_inputFC      {nullptr};
+    AVFormatContext     *m_outputFC     {nullptr};
+    std::vector<int>     m_streamMap;
+    int                  m_vidId        {-1};
+    AVRational           m_vidTimeBase  {1, 90000};
+    int64_t              m_frameDuration {0};
+    const AVCodec       *m_encoder      {nullptr};
+    AVCodecID            m_codec        {AV_CODEC_ID_NONE};
+    /// The packets are in Annex B format, with start codes
+    bool                 m_annexB       {false};
+    /// The last parameter sets seen, with start codes
+    QByteArray           m_paramSets;
+    /// The last group of pictures was copied, so the leading frames of the
+    /// next one can be decoded
+    bool                 m_lastGopIntact {false};
+
+    std::vector<TimelineEntry> m_timeline;
+    int64_t              m_removed      {0};
+    int64_t              m_cutStart     {AV_NOPTS_VALUE};
+    int64_t              m_resolvedUntil {AV_NOPTS_VALUE};
+
+    std::vector<AVPacket*> m_lastGop;
+    std::deque<AVPacket*>  m_otherPackets;
+    std::deque<LosslessCutterBatch*> m_batches;
+    std::vector<int64_t>   m_lastDts;
+
+    MThreadPool         *m_pool         {nullptr};
+    QMutex               m_readyLock;
+    QWaitCondition       m_readyWait;
+
+    int                  m_gopsCopied    {0};
+    int                  m_gopsDropped   {0};
+    int                  m_gopsReencoded {0};
+    bool                 m_ok            {true};
+};
+
+#endif // LOSSLESSCUTTER_H
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
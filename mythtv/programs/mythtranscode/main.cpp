@@ -20,6 +20,7 @@
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "losslesscutter.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "loggingserver.h"
@@ -639,7 +640,68 @@ int main(int argc, char *argv[])
     }
 
     int exitcode = GENERIC_EXIT_OK;
-    if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
+    AVCodecID losslessCodec = AV_CODEC_ID_NONE;
+    if (((result == REENCODE_MPEG2TRANS) || mpeg2) && !build_index)
+        losslessCodec = LosslessCutter::VideoCodec(infile);
+
+    if (LosslessCutter::CanCut(losslessCodec))
+    {
+        void (*update_func)(float) = nullptr;
+        int (*check_func)() = nullptr;
+        if (useCutlist)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while transcoding");
+            if (deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
+        }
+        if (jobID >= 0)
+        {
+           glbl_jobID = jobID;
+           update_func = &UpdateJobQueue;
+           check_func = &CheckJobQueue;
+        }
+
+        LosslessCutter cutter(infile, outfile, deleteMap, showprogress,
+                              update_func, check_func);
+        result = cutter.Start();
+        if (result == REENCODE_OK)
+        {
+            if (jobID >= 0)
+                JobQueue::ChangeJobComment(jobID,
+                                           QObject::tr("Generating Keyframe Index"));
+            result = LosslessCutter::BuildKeyframeIndex(outfile, posMap, durMap);
+            if (result == REENCODE_OK)
+            {
+                if (jobID >= 0)
+                    JobQueue::ChangeJobComment(jobID,
+                                               QObject::tr("Transcode Completed"));
+                if (update_index)
+                    UpdatePositionMap(posMap, durMap, nullptr, pginfo);
+                else
+                    UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                      pginfo);
+            }
+        }
+    }
+    else if (((result == REENCODE_MPEG2TRANS) || mpeg2) && !build_index &&
+             (losslessCodec != AV_CODEC_ID_MPEG1VIDEO) &&
+             (losslessCodec != AV_CODEC_ID_MPEG2VIDEO))
+    {
+        // MPEG2fixup would only choke on it
+        if (losslessCodec == AV_CODEC_ID_NONE)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Unable to read the video of %1").arg(infile));
+        }
+        else
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Lossless transcoding of %1 video is not supported")
+                    .arg(avcodec_get_name(losslessCodec)));
+        }
+        result = REENCODE_ERROR;
+    }
+    else if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
     {
         void (*update_func)(float) = nullptr;
         int (*check_func)() = nullptr;
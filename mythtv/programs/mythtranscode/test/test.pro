@@ -0,0 +1,5 @@
+include (../../../settings.pro)
+
+TEMPLATE = subdirs
+
+SUBDIRS += $$files(test_*)
@@ -0,0 +1,286 @@
+/*
+ *  Class TestHLSSegmentCut
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "hlssegmentcut.h"
+#include "test_hlssegmentcut.h"
+
+/*
+ * A stand in for MythAVFormatWriter that numbers and keys its frames the
+ * same way, with an encoder that holds back a given number of frames.  The
+ * main stream and the renditions are cut with HLSSegmentCut::BeforeFrame(),
+ * as the transcoder and HLSRendition do.
+ */
+
+static constexpr int kKeyFrameDist { 30 };
+static constexpr long long kFrames { 1000 };
+
+struct OutFrame
+{
+    long long m_frame;
+    bool      m_key;
+};
+using Segment = std::vector<OutFrame>;
+
+class StubWriter
+{
+  public:
+    explicit StubWriter(size_t Latency) : m_latency(Latency) {}
+
+    long long GetFramesWritten(void) const { return m_written; }
+    long long GetFramesQueued(void) const
+        { return m_written + static_cast<long long>(m_buffered.size()); }
+    void ForceKeyFrame(void) { m_force = true; }
+    bool ReOpen(const QString &Filename)
+    {
+        m_filenames.push_back(Filename);
+        m_segments.emplace_back();
+        return m_canOpen;
+    }
+
+    void WriteVideoFrame(void)
+    {
+        long long frame = GetFramesQueued();
+        if (m_force)
+        {
+            m_keyFrameStart = frame;
+            m_force = false;
+        }
+        m_buffered.push_back({frame, ((frame - m_keyFrameStart) % kKeyFrameDist) == 0});
+        if (m_buffered.size() > m_latency)
+            Output();
+    }
+
+    void Flush(void)
+    {
+        while (!m_buffered.empty())
+            Output();
+    }
+
+    std::vector<Segment> m_segments { Segment() };
+    QStringList          m_filenames;
+    bool                 m_canOpen { true };
+
+  private:
+    void Output(void)
+    {
+        m_segments.back().push_back(m_buffered.front());
+        m_buffered.pop_front();
+        m_written++;
+    }
+
+    size_t               m_latency;
+    std::deque<OutFrame> m_buffered;
+    long long            m_written       { 0 };
+    long long            m_keyFrameStart { 0 };
+    bool                 m_force         { false };
+};
+
+struct Writer
+{
+    explicit Writer(size_t Latency) : m_writer(Latency) {}
+
+    StubWriter    m_writer;
+    HLSSegmentCut m_cut;
+    /// Size of each segment when it went into the playlist
+    std::vector<size_t> m_published;
+};
+
+/*
+ * Cut and publish segments the way the transcoder does.  writers[0] is the
+ * main stream.  A segment is only published once every writer has cut it,
+ * and no new cut is decided on until then.
+ */
+static void transcode(std::vector<Writer> &Writers, int SegmentSize)
+{
+    Writer &main = Writers.front();
+    int segmentFrames = 0;
+    bool segmentDone = false;
+    auto allCut = [&Writers]()
+    {
+        return std::none_of(Writers.cbegin(), Writers.cend(),
+                            [](const Writer &writer)
+                            { return writer.m_cut.IsPending(); });
+    };
+    auto publish = [&Writers]()
+    {
+        for (auto & writer : Writers)
+        {
+            size_t segment = writer.m_published.size();
+            writer.m_published.push_back(writer.m_writer.m_segments[segment].size());
+        }
+    };
+
+    for (long long i = 0; i < kFrames; i++)
+    {
+        if (segmentDone && allCut())
+        {
+            publish();
+            segmentDone = false;
+        }
+
+        if (!main.m_cut.IsPending() && !segmentDone &&
+            (segmentFrames >= SegmentSize))
+        {
+            long long cutFrame = main.m_writer.GetFramesQueued();
+            for (auto & writer : Writers)
+                writer.m_cut.Schedule(cutFrame, QString("%1.ts").arg(cutFrame));
+            segmentFrames = 0;
+        }
+
+        if (main.m_cut.BeforeFrame(main.m_writer))
+            segmentDone = true;
+        main.m_writer.WriteVideoFrame();
+
+        for (size_t w = 1; w < Writers.size(); w++)
+        {
+            Writers[w].m_cut.BeforeFrame(Writers[w].m_writer);
+            Writers[w].m_writer.WriteVideoFrame();
+        }
+        segmentFrames++;
+    }
+
+    for (auto & writer : Writers)
+        writer.m_writer.Flush();
+}
+
+void TestHLSSegmentCut::test_same_boundaries_data(void)
+{
+    QTest::addColumn<int>("mainLatency");
+    QTest::addColumn<int>("segmentSize");
+    QTest::newRow("no delay") << 0 << 60;
+    QTest::newRow("main delayed") << 4 << 60;
+    QTest::newRow("segment not a whole GOP") << 4 << 75;
+    QTest::newRow("main delayed most") << 12 << 50;
+}
+
+// Every rendition's segments hold the same frames as the main stream's
+// and start with a keyframe, whatever the encoders hold back.  Segments are
+// only published once all of the writers are done with them, including
+// renditions that cut after the main stream.
+void TestHLSSegmentCut::test_same_boundaries(void)
+{
+    QFETCH(int, mainLatency);
+    QFETCH(int, segmentSize);
+
+    std::vector<Writer> writers;
+    writers.emplace_back(static_cast<size_t>(mainLatency));
+    for (size_t latency : { 0, 2, 9 })
+        writers.emplace_back(latency);
+
+    transcode(writers, segmentSize);
+
+    const std::vector<Segment> &main = writers.front().m_writer.m_segments;
+    QCOMPARE(main.size(), static_cast<size_t>((kFrames + segmentSize - 1) / segmentSize));
+    for (size_t s = 0; s < main.size(); s++)
+    {
+        QVERIFY(!main[s].empty());
+        QVERIFY2(main[s].front().m_key, qPrintable(QString("segment %1").arg(s)));
+        QCOMPARE(main[s].front().m_frame, static_cast<long long>(s) * segmentSize);
+        if (s > 0)
+        {
+            QCOMPARE(writers.front().m_writer.m_filenames[s - 1],
+                     QString("%1.ts").arg(main[s].front().m_frame));
+        }
+    }
+
+    for (const auto & writer : writers)
+    {
+        const std::vector<Segment> &segments = writer.m_writer.m_segments;
+        QCOMPARE(segments.size(), main.size());
+        for (size_t s = 0; s < main.size(); s++)
+        {
+            QCOMPARE(segments[s].size(), main[s].size());
+            for (size_t f = 0; f < main[s].size(); f++)
+            {
+                QCOMPARE(segments[s][f].m_frame, main[s][f].m_frame);
+                QCOMPARE(segments[s][f].m_key, main[s][f].m_key);
+            }
+        }
+
+        // All but the last, which is still being written at the end
+        QCOMPARE(writer.m_published.size(), main.size() - 1);
+        for (size_t s = 0; s < writer.m_published.size(); s++)
+            QCOMPARE(writer.m_published[s], segments[s].size());
+    }
+}
+
+// The writer switches files only once its encoder is about to return the
+// first frame of the new segment
+void TestHLSSegmentCut::test_before_frame(void)
+{
+    StubWriter writer(3);
+    HLSSegmentCut cut;
+
+    for (int i = 0; i < 10; i++)
+    {
+        QVERIFY(!cut.BeforeFrame(writer));
+        writer.WriteVideoFrame();
+    }
+
+    cut.Schedule(10, "next.ts");
+    int cuts = 0;
+    for (int i = 10; i < 20; i++)
+    {
+        bool opened = false;
+        if (cut.BeforeFrame(writer, &opened))
+        {
+            QCOMPARE(writer.GetFramesWritten(), 10LL);
+            QVERIFY(opened);
+            cuts++;
+        }
+        writer.WriteVideoFrame();
+    }
+    writer.Flush();
+
+    QCOMPARE(cuts, 1);
+    QCOMPARE(writer.m_filenames, QStringList("next.ts"));
+    QCOMPARE(writer.m_segments.size(), static_cast<size_t>(2));
+    QCOMPARE(writer.m_segments[1].front().m_frame, 10LL);
+    QVERIFY(writer.m_segments[1].front().m_key);
+
+    // A file that can't be opened still counts as the cut
+    writer.m_canOpen = false;
+    cut.Schedule(writer.GetFramesQueued(), "bad.ts");
+    bool opened = true;
+    QVERIFY(cut.BeforeFrame(writer, &opened));
+    QVERIFY(!opened);
+    QVERIFY(!cut.IsPending());
+}
+
+void TestHLSSegmentCut::test_cut_on_frame(void)
+{
+    HLSSegmentCut cut;
+    QVERIFY(!cut.IsPending());
+    QVERIFY(!cut.IsCutFrame(0));
+    QVERIFY(!cut.IsDue(0));
+
+    cut.Schedule(100, "next.ts");
+    QVERIFY(cut.IsPending());
+    QVERIFY(!cut.IsCutFrame(99));
+    QVERIFY(cut.IsCutFrame(100));
+    QVERIFY(!cut.IsDue(99));
+    QVERIFY(cut.IsDue(100));
+    QCOMPARE(cut.Take(), QString("next.ts"));
+    QVERIFY(!cut.IsPending());
+    QVERIFY(!cut.IsDue(100));
+}
+
+QTEST_APPLESS_MAIN(TestHLSSegmentCut)
@@ -0,0 +1,24 @@
+include ( ../../../../settings.pro )
+include ( ../../../../test.pro )
+
+QT += testlib
+
+TEMPLATE = app
+TARGET = test_hlssegmentcut
+DEPENDPATH += . ../..
+INCLUDEPATH += . ../..
+
+# Input
+HEADERS += test_hlssegmentcut.h
+SOURCES += test_hlssegmentcut.cpp
+
+# The cut is part of mythtranscode, not a library.
+HEADERS += ../../hlssegmentcut.h
+
+QMAKE_CLEAN += $(TARGET)
+QMAKE_CLEAN += ; ( cd $(OBJECTS_DIR) && rm -f *.gcov *.gcda *.gcno )
+
+LIBS += $$EXTRA_LIBS $$LATE_LIBS
+
+# Fix runtime linking on Ubuntu 17.10.
+linux:QMAKE_LFLAGS += -Wl,--disable-new-dtags
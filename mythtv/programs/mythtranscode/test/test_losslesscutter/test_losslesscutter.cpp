@@ -0,0 +1,365 @@
+/*
+ *  Class TestLosslessCutter
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "transcodedefs.h"
+#include "losslesscutter.h"
+#include "test_losslesscutter.h"
+
+extern "C" {
+#include "libavutil/opt.h"
+}
+
+/*
+ * The test streams are flat pictures that carry the number of the frame
+ * in their brightness: frame % 16 on the left, frame / 16 on the right.
+ * That survives lossy coding, and a frame decoded from the wrong reference
+ * pictures shows up as the wrong number.
+ */
+
+static constexpr int kWidth  { 128 };
+static constexpr int kHeight { 96 };
+static constexpr int kFrames { 250 };
+static constexpr int kGop    { 25 };
+static constexpr int kStep   { 12 };
+static constexpr int64_t kFrameDuration { 90000 / 25 };
+
+static void fill_frame(AVFrame *frame, int index)
+{
+    int left = 16 + ((index % 16) * kStep);
+    int right = 16 + ((index / 16) * kStep);
+    for (int y = 0; y < kHeight; y++)
+    {
+        uint8_t *line = frame->data[0] + (y * frame->linesize[0]);
+        memset(line, left, kWidth / 2);
+        memset(line + (kWidth / 2), right, kWidth / 2);
+    }
+    for (int plane = 1; plane < 3; plane++)
+    {
+        for (int y = 0; y < kHeight / 2; y++)
+            memset(frame->data[plane] + (y * frame->linesize[plane]), 128,
+                   kWidth / 2);
+    }
+}
+
+/// Returns the number of the frame, or -1 if it isn't a test picture
+static int frame_index(const AVFrame *frame)
+{
+    auto level = [frame](int x0, int x1)
+    {
+        int low = 255;
+        int high = 0;
+        long sum = 0;
+        for (int y = 4; y < kHeight - 4; y++)
+        {
+            const uint8_t *line = frame->data[0] + (y * frame->linesize[0]);
+            for (int x = x0; x < x1; x++)
+            {
+                low = std::min<int>(low, line[x]);
+                high = std::max<int>(high, line[x]);
+                sum += line[x];
+            }
+        }
+        if (high - low > kStep / 2)
+            return -1;
+        double mean = static_cast<double>(sum) / ((kHeight - 8) * (x1 - x0));
+        return static_cast<int>(std::lround((mean - 16) / kStep));
+    };
+
+    int left = level(4, (kWidth / 2) - 4);
+    int right = level((kWidth / 2) + 4, kWidth - 4);
+    if (left < 0 || left > 15 || right < 0)
+        return -1;
+    return (right * 16) + left;
+}
+
+/// Encodes the test pictures with the named encoder into an MPEG-TS file.
+static bool write_stream(const QString &filename, const char *encoderName)
+{
+    const AVCodec *encoder = avcodec_find_encoder_by_name(encoderName);
+    if (!encoder)
+        return false;
+
+    QByteArray name = filename.toLocal8Bit();
+    AVFormatContext *oc = nullptr;
+    if (avformat_alloc_output_context2(&oc, nullptr, "mpegts",
+                                       name.constData()) < 0)
+        return false;
+
+    AVStream *st = avformat_new_stream(oc, nullptr);
+    AVCodecContext *enc = avcodec_alloc_context3(encoder);
+    enc->width = kWidth;
+    enc->height = kHeight;
+    enc->pix_fmt = AV_PIX_FMT_YUV420P;
+    enc->time_base = { 1, 25 };
+    enc->framerate = { 25, 1 };
+    enc->gop_size = kGop;
+    enc->max_b_frames = 2;
+    enc->thread_count = 1;
+    if (encoder->id == AV_CODEC_ID_H264)
+    {
+        // Open groups of pictures, and parameter sets only at the start
+        av_opt_set(enc->priv_data, "crf", "16", 0);
+        av_opt_set(enc->priv_data, "x264-params",
+                   "open-gop=1:keyint=25:min-keyint=25:scenecut=0:"
+                   "bframes=2:b-adapt=0:repeat-headers=0", 0);
+    }
+    else
+    {
+        // Groups of pictures are open unless AV_CODEC_FLAG_CLOSED_GOP
+        enc->flags |= AV_CODEC_FLAG_QSCALE;
+        enc->global_quality = FF_QP2LAMBDA * 2;
+        av_opt_set_int(enc, "sc_threshold", 1000000000, 0);
+    }
+
+    bool ok = (avcodec_open2(enc, encoder, nullptr) >= 0) &&
+        (avcodec_parameters_from_context(st->codecpar, enc) >= 0);
+    st->time_base = enc->time_base;
+    ok = ok && (avio_open(&oc->pb, name.constData(), AVIO_FLAG_WRITE) >= 0) &&
+        (avformat_write_header(oc, nullptr) >= 0);
+
+    AVFrame *frame = av_frame_alloc();
+    AVPacket *pkt = av_packet_alloc();
+    frame->width = kWidth;
+    frame->height = kHeight;
+    frame->format = AV_PIX_FMT_YUV420P;
+    ok = ok && (av_frame_get_buffer(frame, 32) >= 0);
+
+    for (int i = 0; ok && i <= kFrames; i++)
+    {
+        if (i < kFrames)
+        {
+            fill_frame(frame, i);
+            frame->pts = i;
+        }
+        ok = avcodec_send_frame(enc, (i < kFrames) ? frame : nullptr) >= 0;
+        while (ok && avcodec_receive_packet(enc, pkt) == 0)
+        {
+            av_packet_rescale_ts(pkt, enc->time_base, st->time_base);
+            pkt->stream_index = st->index;
+            ok = av_interleaved_write_frame(oc, pkt) >= 0;
+        }
+    }
+    ok = ok && (av_write_trailer(oc) >= 0);
+
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    avio_closep(&oc->pb);
+    avformat_free_context(oc);
+    return ok;
+}
+
+/// The groups of pictures of a stream, as LosslessCutter numbers frames
+struct Gop
+{
+    int m_start   {0};  ///< first frame in display order
+    int m_leading {0};  ///< frames shown before the keyframe
+};
+
+static std::vector<Gop> read_gops(const QString &filename)
+{
+    std::vector<Gop> gops;
+    AVFormatContext *ic = nullptr;
+    if (avformat_open_input(&ic, filename.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+        return gops;
+    avformat_find_stream_info(ic, nullptr);
+
+    AVPacket *pkt = av_packet_alloc();
+    int frame = 0;
+    int64_t keyPts = AV_NOPTS_VALUE;
+    while (av_read_frame(ic, pkt) >= 0)
+    {
+        if (ic->streams[pkt->stream_index]->codecpar->codec_type ==
+            AVMEDIA_TYPE_VIDEO)
+        {
+            if (pkt->flags & AV_PKT_FLAG_KEY)
+            {
+                gops.push_back({frame, 0});
+                keyPts = pkt->pts;
+            }
+            else if (!gops.empty() && pkt->pts < keyPts)
+            {
+                gops.back().m_leading++;
+            }
+            frame++;
+        }
+        av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    avformat_close_input(&ic);
+    return gops;
+}
+
+/// Decodes a stream, giving the number of each frame in display order and
+/// the time stamps of the packets in decode order.
+static bool read_frames(const QString &filename, std::vector<int> &frames,
+                        std::vector<std::pair<int64_t,int64_t>> &stamps)
+{
+    AVFormatContext *ic = nullptr;
+    if (avformat_open_input(&ic, filename.toLocal8Bit().constData(),
+                            nullptr, nullptr) < 0)
+        return false;
+
+    AVCodec *decoder = nullptr;
+    int index = -1;
+    if (avformat_find_stream_info(ic, nullptr) >= 0)
+        index = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+    AVCodecContext *dec = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+    bool ok = dec &&
+        (avcodec_parameters_to_context(dec, ic->streams[index]->codecpar) >= 0) &&
+        (avcodec_open2(dec, decoder, nullptr) >= 0);
+
+    AVPacket *pkt = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    auto receive = [&]()
+    {
+        while (avcodec_receive_frame(dec, frame) == 0)
+        {
+            frames.push_back(frame->decode_error_flags ? -1 : frame_index(frame));
+            av_frame_unref(frame);
+        }
+    };
+    while (ok && av_read_frame(ic, pkt) >= 0)
+    {
+        if (pkt->stream_index == index)
+        {
+            stamps.emplace_back(pkt->pts, pkt->dts);
+            avcodec_send_packet(dec, pkt);
+            receive();
+        }
+        av_packet_unref(pkt);
+    }
+    if (ok)
+    {
+        avcodec_send_packet(dec, nullptr);
+        receive();
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&dec);
+    avformat_close_input(&ic);
+    return ok;
+}
+
+void TestLosslessCutter::initTestCase(void)
+{
+    QVERIFY(m_dir.isValid());
+}
+
+// Cut an H.264 stream made of open groups of pictures, once at the start
+// and once across two groups of pictures.
+void TestLosslessCutter::test_h264_open_gop(void)
+{
+    QString source = m_dir.filePath("h264.ts");
+    QString cut = m_dir.filePath("h264-cut.ts");
+    if (!avcodec_find_encoder_by_name("libx264"))
+        QSKIP("libx264 is not available");
+    QVERIFY(write_stream(source, "libx264"));
+    QCOMPARE(LosslessCutter::VideoCodec(source), AV_CODEC_ID_H264);
+    QVERIFY(LosslessCutter::CanCut(AV_CODEC_ID_H264));
+
+    std::vector<Gop> gops = read_gops(source);
+    QVERIFY(gops.size() >= 7);
+    QVERIFY2(gops[1].m_leading > 0, "the stream has no open groups of pictures");
+
+    // The first group of pictures is dropped, along with the only
+    // parameter sets. The second cut leaves parts of two groups of
+    // pictures to be re-encoded.
+    int cut1 = gops[1].m_start;
+    int cut2Start = gops[3].m_start + 5;
+    int cut2End = gops[4].m_start + 10;
+    frm_dir_map_t deleteMap;
+    deleteMap[0] = MARK_CUT_START;
+    deleteMap[cut1] = MARK_CUT_END;
+    deleteMap[cut2Start] = MARK_CUT_START;
+    deleteMap[cut2End] = MARK_CUT_END;
+
+    LosslessCutter cutter(source, cut, deleteMap, false);
+    QCOMPARE(cutter.Start(), REENCODE_OK);
+
+    // The leading frames of the groups of pictures after a dropped or
+    // re-encoded one go, everything else outside the cuts stays.
+    std::vector<int> expected;
+    for (int i = 0; i < kFrames; i++)
+    {
+        if ((i < cut1 + gops[1].m_leading) ||
+            ((i >= cut2Start) && (i < cut2End)) ||
+            ((i >= gops[5].m_start) && (i < gops[5].m_start + gops[5].m_leading)))
+            continue;
+        expected.push_back(i);
+    }
+
+    std::vector<int> frames;
+    std::vector<std::pair<int64_t,int64_t>> stamps;
+    QVERIFY(read_frames(cut, frames, stamps));
+    QCOMPARE(frames.size(), expected.size());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        QVERIFY2(frames[i] == expected[i],
+                 qPrintable(QString("got frame %1 instead of %2")
+                            .arg(frames[i]).arg(expected[i])));
+    }
+
+    // Time stamps are contiguous, and each frame is still presented no
+    // earlier than it is decoded.
+    std::vector<int64_t> pts;
+    int64_t lastDts = AV_NOPTS_VALUE;
+    for (const auto &stamp : stamps)
+    {
+        QVERIFY(stamp.first >= stamp.second);
+        QVERIFY(lastDts == AV_NOPTS_VALUE || stamp.second > lastDts);
+        lastDts = stamp.second;
+        pts.push_back(stamp.first);
+    }
+    std::sort(pts.begin(), pts.end());
+    for (size_t i = 1; i < pts.size(); i++)
+        QCOMPARE(pts[i] - pts[i - 1], kFrameDuration);
+}
+
+// MPEG-2 recordings are left to MPEG2fixup, which cuts at the same group
+// of pictures boundaries the keyframe index lists.
+void TestLosslessCutter::test_mpeg2(void)
+{
+    QString source = m_dir.filePath("mpeg2.ts");
+    QVERIFY(write_stream(source, "mpeg2video"));
+    AVCodecID codec = LosslessCutter::VideoCodec(source);
+    QCOMPARE(codec, AV_CODEC_ID_MPEG2VIDEO);
+    QVERIFY(!LosslessCutter::CanCut(codec));
+    QVERIFY(!LosslessCutter::CanCut(AV_CODEC_ID_NONE));
+
+    std::vector<Gop> gops = read_gops(source);
+    QCOMPARE(static_cast<int>(gops.size()), (kFrames + kGop - 1) / kGop);
+    QVERIFY2(gops[1].m_leading > 0, "the stream has no open groups of pictures");
+
+    frm_pos_map_t posMap;
+    frm_pos_map_t durMap;
+    QCOMPARE(LosslessCutter::BuildKeyframeIndex(source, posMap, durMap),
+             REENCODE_OK);
+    QCOMPARE(static_cast<size_t>(posMap.size()), gops.size());
+    int i = 0;
+    for (auto it = posMap.cbegin(); it != posMap.cend(); ++it, ++i)
+        QCOMPARE(static_cast<int>(it.key()), gops[i].m_start);
+}
+
+QTEST_GUILESS_MAIN(TestLosslessCutter)
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <cmath>
 #include <fcntl.h>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include <QStringList>
 #include <QMap>
@@ -34,6 +36,8 @@
 #include "HLS/httplivestream.h"
 
 #include "videodecodebuffer.h"
+#include "hlsrendition.h"
+#include "hlssegmentcut.h"
 #include "cutter.h"
 #include "audioreencodebuffer.h"
 
@@ -207,8 +211,17 @@ int Transcode::TranscodeFile(const QString &inputname,
     std::unique_ptr<MythAVFormatWriter> avfw = nullptr;
     std::unique_ptr<MythAVFormatWriter> avfw2 = nullptr;
     std::unique_ptr<HTTPLiveStream> hls = nullptr;
+    std::vector<std::unique_ptr<HLSRendition>> renditions;
     int hlsSegmentSize = 0;
     int hlsSegmentFrames = 0;
+    HLSSegmentCut hlsCut;
+    bool hlsSegmentDone = false;
+    auto hlsRenditionsCut = [&renditions]()
+    {
+        return std::all_of(renditions.cbegin(), renditions.cend(),
+                           [](const auto &rendition)
+                           { return rendition->IsSegmentCut(); });
+    };
 
 #if !CONFIG_LIBMP3LAME
     (void)profileName;
@@ -492,6 +505,30 @@ int Transcode::TranscodeFile(const QString &inputname,
             hls->UpdateStatusMessage("Transcoding Starting");
             hls->UpdateSizeInfo(newWidth, newHeight, video_width, video_height);
 
+            // Lower resolution renditions are scaled from the same decode
+            // and encoded in their own threads.  Each one halves the size
+            // and bitrate of the one above it.
+            int renditionCount =
+                gCoreContext->GetNumSetting("HTTPLiveStreamRenditions", 0);
+            int renditionWidth = newWidth;
+            int renditionHeight = newHeight;
+            int renditionBitrate = m_cmdBitrate;
+
+            for (int i = 0; i < renditionCount; ++i)
+            {
+                renditionWidth   = ((renditionWidth / 2) + 15) & ~0xF;
+                renditionHeight  = ((renditionHeight / 2) + 15) & ~0xF;
+                renditionBitrate = renditionBitrate / 2;
+
+                if (renditionHeight < 144 || renditionBitrate < 100000)
+                    break;
+
+                hls->AddRendition(renditionWidth, renditionHeight,
+                                  renditionBitrate);
+                renditions.push_back(std::make_unique<HLSRendition>(
+                    renditionWidth, renditionHeight, renditionBitrate));
+            }
+
             if (!hls->InitForWrite())
             {
                 LOG(VB_GENERAL, LOG_ERR, "hls->InitForWrite() failed");
@@ -581,6 +618,26 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_ERROR;
         }
 
+        for (size_t i = 0; i < renditions.size(); ++i)
+        {
+            if (!renditions[i]->Init(video_aspect,
+                    halfFramerate ? video_frame_rate / 2 : video_frame_rate,
+                    m_cmdAudioBitrate, arb->m_channels, arb->m_eff_audiorate,
+                    hls->GetCurrentRenditionFilename(static_cast<int>(i))))
+            {
+                LOG(VB_GENERAL, LOG_ERR, "HLS rendition Init() failed");
+                SetPlayerContext(nullptr);
+                return REENCODE_ERROR;
+            }
+        }
+
+        if (!renditions.empty())
+        {
+            LOG(VB_GENERAL, LOG_NOTICE,
+                QString("HLS: Encoding %1 additional renditions")
+                    .arg(renditions.size()));
+        }
+
         arb->m_audioFrameSize = avfw->GetAudioFrameSize() * arb->m_channels * 2;
     }
 #if CONFIG_LIBMP3LAME 
@@ -623,6 +680,14 @@ int Transcode::TranscodeFile(const QString &inputname,
         audsetting = get_str_option(m_recProfile, "audiocodec");
         vidfilters = get_str_option(m_recProfile, "transcodefilters");
 
+        if ((encodingType == "H.264" || encodingType == "HEVC") &&
+            get_bool_option(m_recProfile, "transcodelossless"))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, "Switching to lossless cutter.");
+            SetPlayerContext(nullptr);
+            return REENCODE_MPEG2TRANS;
+        }
+
         if (encodingType == "MPEG-2" &&
             get_bool_option(m_recProfile, "transcodelossless"))
         {
@@ -1364,6 +1429,13 @@ int Transcode::TranscodeFile(const QString &inputname,
                             avfw2->WriteAudioFrame(buf, audioFrame, tc);
                         }
 
+                        for (auto & rendition : renditions)
+                        {
+                            rendition->WriteAudio(buf, ab->size(),
+                                                  ab->m_time - timecodeOffset,
+                                                  avfw->GetTimecodeOffset());
+                        }
+
                         ++audioFrame;
                     }
                 }
@@ -1413,27 +1485,67 @@ int Transcode::TranscodeFile(const QString &inputname,
                 {
                     skippedLastFrame = false;
 
-                    if ((hls) &&
-                        (avfw->GetFramesWritten()) &&
-                        (hlsSegmentFrames > hlsSegmentSize) &&
-                        (avfw->NextFrameIsKeyFrame()))
+                    // A segment goes into the playlists once every writer
+                    // has moved on from it.  Renditions whose encoders hold
+                    // more frames than the main stream's cut a little later.
+                    if (hlsSegmentDone && hlsRenditionsCut())
                     {
                         hls->AddSegment();
-                        avfw->ReOpen(hls->GetCurrentFilename());
+                        hlsSegmentDone = false;
+                    }
 
-                        if (avfw2)
-                            avfw2->ReOpen(hls->GetCurrentFilename(true));
+                    // Decide on a cut as its first frame goes in, and make
+                    // every writer start its segment with that same frame
+                    if ((hls) && (!hlsCut.IsPending()) && (!hlsSegmentDone) &&
+                        (hlsSegmentFrames >= hlsSegmentSize))
+                    {
+                        long long cutFrame = avfw->GetFramesQueued();
+                        hlsCut.Schedule(cutFrame, hls->GetNextFilename());
+
+                        for (size_t i = 0; i < renditions.size(); ++i)
+                        {
+                            renditions[i]->NewSegment(
+                                hls->GetNextRenditionFilename(static_cast<int>(i)),
+                                cutFrame);
+                        }
 
                         hlsSegmentFrames = 0;
                     }
 
-                    if (avfw->WriteVideoFrame(rescale ? &frame : lastDecode) > 0)
+                    bool opened = true;
+                    if ((hls) && (hlsCut.BeforeFrame(*avfw, &opened)))
                     {
-                        lastWrittenTime = frame.m_timecode + timecodeOffset;
-                        if (hls)
-                            ++hlsSegmentFrames;
+                        if (!opened)
+                        {
+                            LOG(VB_GENERAL, LOG_ERR,
+                                "HLS: Unable to open the next segment");
+                        }
+
+                        if (avfw2)
+                            avfw2->ReOpen(hls->GetNextFilename(true));
+
+                        hlsSegmentDone = true;
+                    }
+
+                    MythVideoFrame *written = rescale ? &frame : lastDecode;
+                    std::chrono::milliseconds writtenTime = written->m_timecode;
+                    int ret = avfw->WriteVideoFrame(written);
+
+                    // Every frame given to the encoder, even those it is
+                    // still holding, so that the renditions number the
+                    // frames the same way as the main stream's writer
+                    for (auto & rendition : renditions)
+                    {
+                        rendition->WriteVideo(written, writtenTime,
+                                              avfw->GetTimecodeOffset());
                     }
 
+                    if (hls)
+                        ++hlsSegmentFrames;
+
+                    if (ret > 0)
+                        lastWrittenTime = frame.m_timecode + timecodeOffset;
+
                 }
             }
 #if CONFIG_LIBMP3LAME
@@ -1543,6 +1655,14 @@ int Transcode::TranscodeFile(const QString &inputname,
         if (avfw2)
             avfw2->CloseFile();
 
+        for (auto & rendition : renditions)
+            rendition->Finish();
+
+        // The renditions have encoded everything they were given, so they
+        // have made the last cut if they ever will
+        if (hlsSegmentDone && hlsRenditionsCut())
+            hls->AddSegment();
+
         if (!m_avfMode && m_proginfo)
         {
             m_proginfo->ClearPositionMap(MARK_KEYFRAME);
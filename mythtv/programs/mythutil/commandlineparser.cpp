@@ -23,6 +23,13 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 ->SetGroup("File")
                 ->SetRequiredChild(QStringList("infile") << "outfile")
 
+        // logutils.cpp
+        << add("--decodelog", "decodelog", false,
+                "Decode a binary log written with --binlog", "")
+                ->SetGroup("Logs")
+                ->SetRequiredChild("infile")
+                ->SetChild("outfile")
+
         // mpegutils.cpp
         << add("--pidcounter", "pidcounter", false,
                 "Count pids in a MythTV Storage Group file", "")
@@ -197,6 +204,23 @@ void MythUtilCommandLineParser::LoadArguments(void)
     add("--xml", "xml", false, "Enables XML output of PSIP", "")
         ->SetChildOf("pidprinter");
 
+    // logutils.cpp
+    add("--logmask", "logmask", "",
+        "(optional) Only decode messages of these verbose levels, e.g. "
+        "'record,channel'", "")
+        ->SetChildOf("decodelog");
+    add("--logthread", "logthread", "",
+        "(optional) Only decode messages of this thread, by name or id", "")
+        ->SetChildOf("decodelog");
+    add("--logfrom", "logfrom", "",
+        "(optional) Only decode messages from this time on "
+        "(YYYY-MM-DDThh:mm:ss, local time)", "")
+        ->SetChildOf("decodelog");
+    add("--logto", "logto", "",
+        "(optional) Only decode messages up to this time "
+        "(YYYY-MM-DDThh:mm:ss, local time)", "")
+        ->SetChildOf("decodelog");
+
     // messageutils.cpp
     add("--message_text", "message_text", "message", "(optional) message to send", "")
         ->SetChildOf("message")
@@ -0,0 +1,147 @@
+// C++ includes
+#include <algorithm>
+
+// Qt headers
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+// libmyth* includes
+#include "binarylog.h"
+#include "exitcodes.h"
+#include "mythlogging.h"
+
+// Local includes
+#include "logutils.h"
+
+struct LogFilter
+{
+    uint64_t m_mask      {0};
+    QString  m_thread;
+    int64_t  m_from      {INT64_MIN};
+    int64_t  m_to        {INT64_MAX};
+};
+
+static bool ParseMask(const QString &arg, uint64_t &mask)
+{
+    // verboseArgParse works on the globals, so borrow them
+    uint64_t savedMask = verboseMask;
+    QString savedString = verboseString;
+    bool ok = (verboseArgParse("none," + arg) == GENERIC_EXIT_OK);
+    mask = verboseMask & ~(VB_STDIO | VB_FLUSH);
+    verboseMask = savedMask;
+    verboseString = savedString;
+    return ok;
+}
+
+static bool ParseTime(const QString &arg, int64_t &time)
+{
+    QDateTime dt = QDateTime::fromString(arg, Qt::ISODate);
+    if (!dt.isValid())
+        return false;
+    time = dt.toMSecsSinceEpoch();
+    return true;
+}
+
+static bool Matches(const LogFilter &filter, const BinaryLogEntry &entry)
+{
+    if (entry.m_epoch < filter.m_from || entry.m_epoch > filter.m_to)
+        return false;
+
+    if (filter.m_mask)
+    {
+        uint64_t mask = entry.m_mask & ~(VB_STDIO | VB_FLUSH);
+        if ((filter.m_mask & mask) != mask)
+            return false;
+    }
+
+    if (!filter.m_thread.isEmpty() &&
+        filter.m_thread != entry.m_threadName &&
+        filter.m_thread != QString::number(entry.m_tid))
+        return false;
+
+    return true;
+}
+
+static int DecodeFile(const QString &filename, const LogFilter &filter,
+                      QTextStream &out)
+{
+    BinaryLogReader reader(filename);
+    if (!reader.IsOpen())
+        return -1;
+
+    int count = 0;
+    BinaryLogEntry entry;
+    while (reader.Next(entry))
+    {
+        if (!Matches(filter, entry))
+            continue;
+        out << reader.Format(entry) << "\n";
+        count++;
+    }
+    return count;
+}
+
+int DecodeLog(const MythUtilCommandLineParser &cmdline)
+{
+    LogFilter filter;
+
+    if (!cmdline.toString("logmask").isEmpty() &&
+        !ParseMask(cmdline.toString("logmask"), filter.m_mask))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Invalid --logmask option");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+    filter.m_thread = cmdline.toString("logthread");
+    if (!cmdline.toString("logfrom").isEmpty() &&
+        !ParseTime(cmdline.toString("logfrom"), filter.m_from))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Invalid --logfrom option");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+    if (!cmdline.toString("logto").isEmpty() &&
+        !ParseTime(cmdline.toString("logto"), filter.m_to))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Invalid --logto option");
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
+
+    QFile outfile;
+    QString outname = cmdline.toString("outfile");
+    if (outname.isEmpty())
+    {
+        outfile.open(stdout, QIODevice::WriteOnly);
+    }
+    else
+    {
+        outfile.setFileName(outname);
+        if (!outfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Unable to open %1 for writing").arg(outname));
+            return GENERIC_EXIT_PERMISSIONS_ERROR;
+        }
+    }
+    QTextStream out(&outfile);
+
+    // The older half of the log, if there is one, comes first
+    QString infile = cmdline.toString("infile");
+    int count = 0;
+    if (QFileInfo::exists(infile + ".1"))
+        count = std::max(DecodeFile(infile + ".1", filter, out), 0);
+
+    int current = DecodeFile(infile, filter, out);
+    if (current < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Unable to decode %1").arg(infile));
+        return GENERIC_EXIT_NOT_OK;
+    }
+    count += current;
+
+    out.flush();
+    LOG(VB_GENERAL, LOG_INFO, QString("Decoded %1 messages").arg(count));
+    return GENERIC_EXIT_OK;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
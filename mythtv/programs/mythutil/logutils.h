@@ -0,0 +1,3 @@
+#include "mythutil.h"
+
+int DecodeLog(const MythUtilCommandLineParser &cmdline);
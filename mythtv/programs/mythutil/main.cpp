@@ -21,6 +21,7 @@
 #include "fileutils.h"
 #include "mpegutils.h"
 #include "jobutils.h"
+#include "logutils.h"
 #include "markuputils.h"
 #include "messageutils.h"
 #include "musicmetautils.h"
@@ -92,6 +93,14 @@ int main(int argc, char *argv[])
     SignalHandler::SetHandler(SIGHUP, logSigHup);
 #endif
 
+    // Decoding a log needs neither the database nor a backend
+    if (cmdline.toBool("decodelog"))
+    {
+        int result = DecodeLog(cmdline);
+        SignalHandler::Done();
+        return result;
+    }
+
     gContext = new MythContext(MYTH_BINARY_VERSION);
     if (!gContext->Init(false))
     {
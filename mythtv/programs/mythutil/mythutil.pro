@@ -17,11 +17,12 @@ QMAKE_CLEAN += $(TARGET)
 
 # Input
 HEADERS += mythutil.h commandlineparser.h
-HEADERS += backendutils.h fileutils.h jobutils.h markuputils.h
+HEADERS += backendutils.h fileutils.h jobutils.h logutils.h markuputils.h
 HEADERS += messageutils.h mpegutils.h musicmetautils.h
 HEADERS += recordingutils.h
 SOURCES += main.cpp mythutil.cpp commandlineparser.cpp
-SOURCES += backendutils.cpp fileutils.cpp jobutils.cpp markuputils.cpp
+SOURCES += backendutils.cpp fileutils.cpp jobutils.cpp logutils.cpp
+SOURCES += markuputils.cpp
 SOURCES += messageutils.cpp mpegutils.cpp musicmetautils.cpp eitutils.cpp
 SOURCES += recordingutils.cpp
 
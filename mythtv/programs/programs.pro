@@ -22,3 +22,25 @@ using_backend {
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
+
+# unit tests mythcommflag
+using_frontend {
+    mythcommflag-test.depends = sub-mythcommflag
+    mythcommflag-test.target = buildtestmythcommflag
+    mythcommflag-test.commands = cd mythcommflag/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythcommflag-test
+    unittest.depends += mythcommflag-test
+}
+
+# unit tests mythtranscode
+using_mythtranscode {
+    mythtranscode-test.depends = sub-mythtranscode
+    mythtranscode-test.target = buildtestmythtranscode
+    mythtranscode-test.commands = cd mythtranscode/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythtranscode-test
+    unittest.depends += mythtranscode-test
+}
+
+unittest.target = test
+unittest.commands = scripts/unittests.sh
+unix:QMAKE_EXTRA_TARGETS += unittest